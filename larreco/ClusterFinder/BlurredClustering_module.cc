@@ -167,7 +167,7 @@ void cluster::BlurredClustering::produce(art::Event& evt)
     if (hits.size() >= fBlurredClusteringAlg.GetMinSize()) {
 
       // Convert hit map to TH2 histogram and blur it
-      auto const image = fBlurredClusteringAlg.ConvertRecobHitsToVector(hits, readoutWindowSize);
+      auto const image = fBlurredClusteringAlg.ConvertRecobHitsToImage(hits, readoutWindowSize);
       auto const blurred = fBlurredClusteringAlg.GaussianBlur(image);
 
       // Find clusters in histogram
@@ -178,7 +178,7 @@ void cluster::BlurredClustering::produce(art::Event& evt)
 
       // Create output clusters from the vector of clusters made in FindClusters
       std::vector<art::PtrVector<recob::Hit>> planeClusters;
-      fBlurredClusteringAlg.ConvertBinsToClusters(image, allClusterBins, planeClusters);
+      fBlurredClusteringAlg.ConvertBinsToClusters(allClusterBins, planeClusters);
 
       // Use the cluster merging algorithm
       if (fMergeClusters) {
@@ -29,6 +29,7 @@
  *          Configuration parameters:
  *          HitFinderModuleLabel:         the producer module responsible for making the recob:Hits to use
  *          EnableMonitoring:             if true then basic monitoring of the module performed
+ *          ConcurrentPathFinding:        if true the path finding runs the clusters as concurrent tasks
  *          ClusterAlg:                   Parameter block required by the 3D clustering algorithm
  *          PrincipalComponentsAlg:       Parameter block required by the Principal Components Analysis Algorithm
  *          SkeletonAlg:                  Parameter block required by the 3D skeletonization algorithm
@@ -51,7 +52,6 @@
 #include "art/Persistency/Common/PtrMaker.h"
 #include "art/Utilities/make_tool.h"
 #include "art_root_io/TFileService.h"
-#include "cetlib/cpu_timer.h"
 
 // LArSoft includes
 #include "larcore/CoreUtils/ServiceUtil.h"
@@ -69,6 +69,7 @@
 #include "lardataobj/RecoBase/SpacePoint.h"
 
 #include "larreco/ClusterFinder/ClusterCreator.h"
+#include "larreco/Monitoring/StageMonitorService.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/HoughSeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterAlg.h"
@@ -87,10 +88,15 @@
 #include "TTree.h"
 #include "TVector3.h"
 
+// TBB includes
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+
 // std includes
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -467,11 +473,24 @@ namespace lar_cluster3d {
      */
     size_t countUltimateDaughters(reco::ClusterParameters& clusterParameters) const;
 
+    /**
+     *  @brief Run a cluster modification algorithm on each top level cluster as a concurrent task,
+     *         see the concurrency contract of IClusterModAlg
+     *
+     *  @param clusterModAlg         The algorithm, which must have independent clusters
+     *  @param clusterParametersList The clusters to modify
+     *  @param eventArena            The arena of the event, shared with the tasks
+     */
+    void ModifyClustersConcurrently(const IClusterModAlg& clusterModAlg,
+                                    reco::ClusterParametersList& clusterParametersList,
+                                    reco::EventArena& eventArena) const;
+
     /**
      *   Algorithm parameters
      */
     bool m_onlyMakSpacePoints;    ///< If true we don't do the full cluster 3D processing
     bool m_enableMonitoring;      ///< Turn on monitoring of this algorithm
+    bool m_concurrentPathFinding; ///< Run the path finding of the clusters as concurrent tasks
     float m_parallelHitsCosAng;   ///< Cut for PCA 3rd axis angle to X axis
     float m_parallelHitsTransWid; ///< Cut on transverse width of cluster (PCA 2nd eigenvalue)
 
@@ -488,13 +507,25 @@ namespace lar_cluster3d {
     float m_makeHitsTime;          ///< Keeps track of time to build 3D hits
     float m_buildNeighborhoodTime; ///< Keeps track of time to build epsilon neighborhood
     float m_dbscanTime;            ///< Keeps track of time to run DBScan
+    float m_neighborSearchTime;    ///< Keeps track of time spent in neighborhood searches
     float m_clusterMergeTime;      ///< Keeps track of the time to merge clusters
     float m_pathFindingTime;       ///< Keeps track of the path finding time
     float m_finishTime;            ///< Keeps track of time to run output module
+    int m_arenaBlocks;             ///< Number of heap blocks taken by the event arena
+    int m_arenaBytes;              ///< Number of bytes taken by the event arena
     std::string m_pathInstance;    ///< Special instance for path points
     std::string m_vertexInstance;  ///< Special instance name for vertex points
     std::string m_extremeInstance; ///< Instance name for the extreme points
 
+    // Time spent in each stage, if the StageMonitorService is configured
+    lar::StageMonitor* m_stageMonitor;
+    lar::StageMonitor::StageID m_eventStage{0};
+    lar::StageMonitor::StageID m_hit3DStage{0};
+    lar::StageMonitor::StageID m_clusteringStage{0};
+    lar::StageMonitor::StageID m_mergeStage{0};
+    lar::StageMonitor::StageID m_pathFindingStage{0};
+    lar::StageMonitor::StageID m_finishStage{0};
+
     // Algorithms
     std::unique_ptr<lar_cluster3d::IHit3DBuilder>
       m_hit3DBuilderAlg; ///<  Builds the 3D hits to operate on
@@ -530,8 +561,20 @@ namespace lar_cluster3d {
     , m_pcaSeedFinderAlg(pset.get<fhicl::ParameterSet>("PCASeedFinderAlg"))
     , m_parallelHitsAlg(pset.get<fhicl::ParameterSet>("ParallelHitsAlg"))
   {
+    m_stageMonitor = lar::stageMonitorIfConfigured();
+    if (m_stageMonitor) {
+      const std::string label = pset.get<std::string>("module_label");
+      m_eventStage = m_stageMonitor->Stage(label);
+      m_hit3DStage = m_stageMonitor->Stage(label + "/Hit3DBuilding");
+      m_clusteringStage = m_stageMonitor->Stage(label + "/Clustering");
+      m_mergeStage = m_stageMonitor->Stage(label + "/Merging");
+      m_pathFindingStage = m_stageMonitor->Stage(label + "/PathFinding");
+      m_finishStage = m_stageMonitor->Stage(label + "/Output");
+    }
+
     m_onlyMakSpacePoints = pset.get<bool>("MakeSpacePointsOnly", false);
     m_enableMonitoring = pset.get<bool>("EnableMonitoring", false);
+    m_concurrentPathFinding = pset.get<bool>("ConcurrentPathFinding", false);
     m_parallelHitsCosAng = pset.get<float>("ParallelHitsCosAng", 0.999);
     m_parallelHitsTransWid = pset.get<float>("ParallelHitsTransWid", 25.0);
     m_pathInstance = pset.get<std::string>("PathPointsName", "Path");
@@ -602,16 +645,17 @@ namespace lar_cluster3d {
                              << ", Event=" << evt.id().event() << "] Starting Now! *** "
                              << std::endl;
 
-    // Set up for monitoring the timing... at some point this should be removed in favor of
-    // external profilers
-    cet::cpu_timer theClockTotal;
-    cet::cpu_timer theClockFinish;
-
-    if (m_enableMonitoring) theClockTotal.start();
+    // The stages are timed for the StageMonitorService, if configured, and for the monitoring tree
+    lar::StageTimer totalTimer(m_stageMonitor, m_eventStage);
 
     // This really only does anything if we are monitoring since it clears our tree variables
     this->PrepareEvent(evt);
 
+    // All the working containers made below take their memory from this arena, which releases it
+    // in one go at the end of the event. It must outlive them so declare it first.
+    reco::EventArena eventArena;
+    reco::EventArena::Scope eventArenaScope(eventArena);
+
     // Get instances of the primary data structures needed
     reco::ClusterParametersList clusterParametersList;
     IHit3DBuilder::RecobHitToPtrMap clusterHitToArtPtrMap;
@@ -619,21 +663,40 @@ namespace lar_cluster3d {
       new reco::HitPairList); // Potentially lots of hits, use heap instead of stack
 
     // Call the algorithm that builds 3D hits and stores the hit collection
+    lar::StageTimer hit3DTimer(m_stageMonitor, m_hit3DStage);
     m_hit3DBuilderAlg->Hit3DBuilder(evt, *hitPairList, clusterHitToArtPtrMap);
+    hit3DTimer.AddItems(hitPairList->size());
+    hit3DTimer.Stop();
+
+    double clusterMergeTime(0.);
+    double pathFindingTime(0.);
 
     // Only do the rest if we are not in the mode of only building space points (requested by ML folks)
     if (!m_onlyMakSpacePoints) {
       // Call the main workhorse algorithm for building the local version of candidate 3D clusters
+      lar::StageTimer clusteringTimer(m_stageMonitor, m_clusteringStage);
       m_clusterAlg->Cluster3DHits(*hitPairList, clusterParametersList);
+      clusteringTimer.AddItems(clusterParametersList.size());
+      clusteringTimer.Stop();
 
       // Try merging clusters
+      lar::StageTimer mergeTimer(m_stageMonitor, m_mergeStage);
       m_clusterMergeAlg->ModifyClusters(clusterParametersList);
+      clusterMergeTime = mergeTimer.Stop();
 
       // Run the path finding
-      m_clusterPathAlg->ModifyClusters(clusterParametersList);
+      lar::StageTimer pathFindingTimer(m_stageMonitor, m_pathFindingStage);
+      pathFindingTimer.AddItems(clusterParametersList.size());
+
+      if (m_concurrentPathFinding && m_clusterPathAlg->clustersAreIndependent())
+        ModifyClustersConcurrently(*m_clusterPathAlg, clusterParametersList, eventArena);
+      else
+        m_clusterPathAlg->ModifyClusters(clusterParametersList);
+
+      pathFindingTime = pathFindingTimer.Stop();
     }
 
-    if (m_enableMonitoring) theClockFinish.start();
+    lar::StageTimer finishTimer(m_stageMonitor, m_finishStage);
 
     // Get the art ouput object
     ArtOutputHandler output(evt, m_pathInstance, m_vertexInstance, m_extremeInstance);
@@ -649,33 +712,39 @@ namespace lar_cluster3d {
     // Output to art
     output.outputObjects();
 
+    double const finishTime = finishTimer.Stop();
+    totalTimer.AddItems(clusterHitToArtPtrMap.size());
+    double const totalTime = totalTimer.Stop();
+
     // If monitoring then deal with the fallout
     if (m_enableMonitoring) {
-      theClockFinish.stop();
-      theClockTotal.stop();
-
       m_run = evt.run();
       m_event = evt.id().event();
-      m_totalTime = theClockTotal.accumulated_real_time();
+      m_totalTime = totalTime;
       m_artHitsTime = m_hit3DBuilderAlg->getTimeToExecute(IHit3DBuilder::COLLECTARTHITS);
       m_makeHitsTime = m_hit3DBuilderAlg->getTimeToExecute(IHit3DBuilder::BUILDTHREEDHITS);
       m_buildNeighborhoodTime = m_clusterAlg->getTimeToExecute(IClusterAlg::BUILDHITTOHITMAP);
       m_dbscanTime = m_clusterAlg->getTimeToExecute(IClusterAlg::RUNDBSCAN) +
                      m_clusterAlg->getTimeToExecute(IClusterAlg::BUILDCLUSTERINFO);
-      m_clusterMergeTime = m_clusterMergeAlg->getTimeToExecute();
-      m_pathFindingTime = m_clusterPathAlg->getTimeToExecute();
-      m_finishTime = theClockFinish.accumulated_real_time();
+      m_neighborSearchTime = m_clusterAlg->getTimeToExecute(IClusterAlg::NEIGHBORSEARCH);
+      m_clusterMergeTime = clusterMergeTime;
+      m_pathFindingTime = pathFindingTime;
+      m_finishTime = finishTime;
       m_hits = static_cast<int>(clusterHitToArtPtrMap.size());
       m_hits3D = static_cast<int>(hitPairList->size());
+      m_arenaBlocks = static_cast<int>(eventArena.getNumHeapBlocks());
+      m_arenaBytes = static_cast<int>(eventArena.getNumHeapBytes());
       m_pRecoTree->Fill();
 
       mf::LogDebug("Cluster3D") << "*** Cluster3D total time: " << m_totalTime
                                 << ", art: " << m_artHitsTime << ", make: " << m_makeHitsTime
                                 << ", build: " << m_buildNeighborhoodTime
                                 << ", clustering: " << m_dbscanTime
+                                << " (searches: " << m_neighborSearchTime << ")"
                                 << ", merge: " << m_clusterMergeTime
                                 << ", path: " << m_pathFindingTime << ", finish: " << m_finishTime
-                                << std::endl;
+                                << ", arena: " << m_arenaBytes << " bytes in " << m_arenaBlocks
+                                << " blocks" << std::endl;
     }
 
     // Will we ever get here? ;-)
@@ -697,9 +766,12 @@ namespace lar_cluster3d {
     m_pRecoTree->Branch("makeHitsTime", &m_makeHitsTime, "time/F");
     m_pRecoTree->Branch("buildneigborhoodTime", &m_buildNeighborhoodTime, "time/F");
     m_pRecoTree->Branch("dbscanTime", &m_dbscanTime, "time/F");
+    m_pRecoTree->Branch("neighborSearchTime", &m_neighborSearchTime, "time/F");
     m_pRecoTree->Branch("clusterMergeTime", &m_clusterMergeTime, "time/F");
     m_pRecoTree->Branch("pathfindingtime", &m_pathFindingTime, "time/F");
     m_pRecoTree->Branch("finishTime", &m_finishTime, "time/F");
+    m_pRecoTree->Branch("arenaBlocks", &m_arenaBlocks, "arenaBlocks/I");
+    m_pRecoTree->Branch("arenaBytes", &m_arenaBytes, "arenaBytes/I");
 
     m_clusterPathAlg->initializeHistograms(*tfs.get());
   }
@@ -717,8 +789,11 @@ namespace lar_cluster3d {
     m_makeHitsTime = 0.f;
     m_buildNeighborhoodTime = 0.f;
     m_dbscanTime = 0.f;
+    m_neighborSearchTime = 0.f;
     m_pathFindingTime = 0.f;
     m_finishTime = 0.f;
+    m_arenaBlocks = 0;
+    m_arenaBytes = 0;
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1380,6 +1455,38 @@ namespace lar_cluster3d {
     return localCount;
   }
 
+  void Cluster3D::ModifyClustersConcurrently(const IClusterModAlg& clusterModAlg,
+                                             reco::ClusterParametersList& clusterParametersList,
+                                             reco::EventArena& eventArena) const
+  {
+    // Each task modifies one cluster and only adds to its daughter list, so the result is in the
+    // same order as when the tool runs the list itself
+    std::vector<reco::ClusterParameters*> clusters;
+
+    clusters.reserve(clusterParametersList.size());
+
+    for (auto& clusterParameters : clusterParametersList)
+      clusters.push_back(&clusterParameters);
+
+    tbb::enumerable_thread_specific<IClusterModAlg::WorkspacePtr> workspaces(
+      [&clusterModAlg]() { return clusterModAlg.makeWorkspace(); });
+
+    {
+      reco::EventArena::SharedScope sharedArena(eventArena);
+
+      tbb::parallel_for(size_t(0), clusters.size(), [&](size_t clusterIdx) {
+        reco::EventArena::Scope taskArenaScope(sharedArena.taskArena());
+
+        clusterModAlg.ModifyCluster(*clusters[clusterIdx], *workspaces.local());
+      });
+    }
+
+    for (auto& workspace : workspaces)
+      clusterModAlg.mergeWorkspace(*workspace);
+
+    return;
+  }
+
   size_t Cluster3D::FindAndStoreDaughters(util::GeometryUtilities const& gser,
                                           ArtOutputHandler& output,
                                           reco::ClusterParameters& clusterParameters,
@@ -27,9 +27,10 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/Slice.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
+#include "larreco/Monitoring/StageMonitorService.h"
 #include "larreco/RecoAlg/TCAlg/DataStructs.h"
-#include "larreco/RecoAlg/TCAlg/DebugStruct.h"
 #include "larreco/RecoAlg/TCAlg/PFPUtils.h"
+#include "larreco/RecoAlg/TCAlg/TCContext.h"
 #include "larreco/RecoAlg/TCAlg/TCHist.h"
 #include "larreco/RecoAlg/TCAlg/Utils.h"
 #include "larreco/RecoAlg/TrajClusterAlg.h"
@@ -83,6 +84,14 @@ namespace cluster {
     bool fDoWireAssns;
     bool fDoRawDigitAssns;
     bool fSaveAll2DVertices;
+
+    // time spent in each stage, if the StageMonitorService is configured
+    lar::StageMonitor* fStageMonitor;
+    lar::StageMonitor::StageID fEventStage{0};
+    lar::StageMonitor::StageID fSlicingStage{0};
+    lar::StageMonitor::StageID fReconstructionStage{0};
+    lar::StageMonitor::StageID fFinishStage{0};
+    lar::StageMonitor::StageID fOutputStage{0};
   }; // class TrajCluster
 
 } // namespace cluster
@@ -133,8 +142,18 @@ namespace cluster {
 
   //----------------------------------------------------------------------------
   TrajCluster::TrajCluster(fhicl::ParameterSet const& pset)
-    : EDProducer{pset}, fTCAlg{pset.get<fhicl::ParameterSet>("TrajClusterAlg")}
+    : EDProducer{pset}
+    , fTCAlg{pset.get<fhicl::ParameterSet>("TrajClusterAlg")}
+    , fStageMonitor{lar::stageMonitorIfConfigured()}
   {
+    if (fStageMonitor) {
+      const std::string label = pset.get<std::string>("module_label");
+      fEventStage = fStageMonitor->Stage(label);
+      fSlicingStage = fStageMonitor->Stage(label + "/Slicing");
+      fReconstructionStage = fStageMonitor->Stage(label + "/Reconstruction");
+      fFinishStage = fStageMonitor->Stage(label + "/FinishEvent");
+      fOutputStage = fStageMonitor->Stage(label + "/Output");
+    }
     fHitModuleLabel = "NA";
     if (pset.has_key("HitModuleLabel")) fHitModuleLabel = pset.get<art::InputTag>("HitModuleLabel");
     fSliceModuleLabel = "NA";
@@ -228,6 +247,12 @@ namespace cluster {
     // collection of hits with the additional requirement that all hits in a slice reside in
     // one TPC
 
+    // bind the state of fTCAlg to this thread so that the tca:: functions and variables
+    // used below refer to it
+    tca::TCContextScope tcScope(fTCAlg.GetContext());
+
+    lar::StageTimer eventTimer(fStageMonitor, fEventStage);
+
     // pointers to the slices in the event
     std::vector<art::Ptr<recob::Slice>> slices;
     std::vector<int> slcIDs;
@@ -239,6 +264,7 @@ namespace cluster {
       throw cet::exception("TrajClusterModule")
         << "Failed to get a handle to hit collection '" << fHitModuleLabel.label() << "'\n";
     nInputHits = (*inputHits).size();
+    eventTimer.AddItems(nInputHits);
     if (!fTCAlg.SetInputHits(*inputHits, evt.run(), evt.event()))
       throw cet::exception("TrajClusterModule")
         << "Failed to process hits from '" << fHitModuleLabel.label() << "'\n";
@@ -293,6 +319,11 @@ namespace cluster {
       auto const detProp =
         art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(evt, clockData);
       auto const* geom = lar::providerFrom<geo::Geometry>();
+      lar::StageTimer slicingTimer(fStageMonitor, fSlicingStage);
+      // the hits in each slice in each TPC, and the slice IDs, in the order in which
+      // they are reconstructed
+      std::vector<std::vector<unsigned int>> allSlcHits;
+      std::vector<int> allSlcIDs;
       for (const auto& tpcid : geom->Iterate<geo::TPCID>()) {
         // ignore protoDUNE dummy TPCs
         if (geom->TPC(tpcid).DriftDistance() < 25.0) continue;
@@ -331,36 +362,26 @@ namespace cluster {
           std::vector tmp = tpcHits;
           for (unsigned int ii = 0; ii < tpcHits.size(); ++ii)
             tpcHits[ii] = tmp[sortVec[ii].index];
-          // clear the temp vector
-          tmp.resize(0);
-          sortVec.resize(0);
-          // look for a debug hit
-          if (tca::tcc.dbgStp) {
-            tca::debug.Hit = UINT_MAX;
-            for (unsigned short indx = 0; indx < tpcHits.size(); ++indx) {
-              auto& hit = (*inputHits)[tpcHits[indx]];
-              if ((int)hit.WireID().TPC == tca::debug.TPC &&
-                  (int)hit.WireID().Plane == tca::debug.Plane &&
-                  (int)hit.WireID().Wire == tca::debug.Wire &&
-                  hit.PeakTime() > tca::debug.Tick - 10 && hit.PeakTime() < tca::debug.Tick + 10) {
-                std::cout << "Debug hit " << tpcHits[indx] << " found in slice ID " << slcIDs[isl];
-                std::cout << " RMS " << hit.RMS();
-                std::cout << " Multiplicity " << hit.Multiplicity();
-                std::cout << " GoodnessOfFit " << hit.GoodnessOfFit();
-                std::cout << "\n";
-                tca::debug.Hit = tpcHits[indx];
-                break;
-              } // Look for debug hit
-            }   // iht
-          }     // tca::tcc.dbgStp
-          fTCAlg.RunTrajClusterAlg(clockData, detProp, tpcHits, slcIDs[isl]);
+          allSlcHits.push_back(std::move(tpcHits));
+          allSlcIDs.push_back(slcIDs[isl]);
         } // isl
       }   // TPC
+      slicingTimer.AddItems(allSlcHits.size());
+      slicingTimer.Stop();
+      // reconstruct the slices, concurrently if ParallelSlices is set
+      lar::StageTimer reconstructionTimer(fStageMonitor, fReconstructionStage);
+      reconstructionTimer.AddItems(allSlcHits.size());
+      fTCAlg.RunTrajClusterAlg(clockData, detProp, allSlcHits, allSlcIDs);
+      reconstructionTimer.Stop();
       // stitch PFParticles between TPCs, create PFP start vertices, etc
+      lar::StageTimer finishTimer(fStageMonitor, fFinishStage);
       fTCAlg.FinishEvent();
+      finishTimer.Stop();
       if (tca::tcc.dbgSummary) tca::PrintAll(detProp, "TCM");
     } // nInputHits > 0
 
+    lar::StageTimer outputTimer(fStageMonitor, fOutputStage);
+
     // Vectors to hold all data products that will go into the event
     std::vector<recob::Hit> hitCol; // output hit collection
     std::vector<recob::Cluster> clsCol;
@@ -828,6 +849,8 @@ namespace cluster {
     // clear the alg data structures
     fTCAlg.ClearResults();
 
+    outputTimer.AddItems(clsCol.size());
+
     // convert vectors to unique_ptrs
     std::unique_ptr<std::vector<recob::Hit>> hcol(new std::vector<recob::Hit>(std::move(hitCol)));
     std::unique_ptr<std::vector<recob::Cluster>> ccol(
@@ -218,11 +218,10 @@ recob::Track ems::EMShower3D::ConvertFrom(detinfo::DetectorClocksData const& clo
   std::vector<TVector3> xyz, dircos;
 
   for (size_t i = 0; i < src.size(); i++) {
-    xyz.push_back(src[i]->Point3D());
+    xyz.push_back(pma::ToTVector3(src[i]->Point3D()));
 
     if (i < src.size() - 1) {
-      TVector3 dc(src[i + 1]->Point3D());
-      dc -= src[i]->Point3D();
+      TVector3 dc(pma::ToTVector3(src[i + 1]->Point3D() - src[i]->Point3D()));
       dc *= 1.0 / dc.Mag();
       dircos.push_back(dc);
     }
@@ -281,11 +280,10 @@ recob::Track ems::EMShower3D::ConvertFrom2(detinfo::DetectorClocksData const& cl
   std::vector<TVector3> xyz, dircos;
 
   for (size_t i = 0; i < src.size(); i++) {
-    xyz.push_back(src[i]->Point3D());
+    xyz.push_back(pma::ToTVector3(src[i]->Point3D()));
 
     if (i < src.size() - 1) {
-      TVector3 dc(src[i + 1]->Point3D());
-      dc -= src[i]->Point3D();
+      TVector3 dc(pma::ToTVector3(src[i + 1]->Point3D() - src[i]->Point3D()));
       dc *= 1.0 / dc.Mag();
       dircos.push_back(dc);
     }
@@ -513,8 +511,8 @@ void ems::EMShower3D::Reoptimize(detinfo::DetectorPropertiesData const& detProp)
         continue;
       }
 
-      TVector3 p1 = fSeltracks[ta].track->front()->Point3D();
-      TVector3 p2 = fSeltracks[tb].track->front()->Point3D();
+      auto const& p1 = fSeltracks[ta].track->front()->Point3D();
+      auto const& p2 = fSeltracks[tb].track->front()->Point3D();
       float dist = std::sqrt(pma::Dist2(p1, p2));
 
       if (dist < min_dist)
@@ -847,9 +845,9 @@ bool ems::EMShower3D::Validate(detinfo::DetectorPropertiesData const& detProp,
     std::vector<Hit2D*> hits2dcl = input[i]->GetHits2D();
     for (size_t h = 0; h < hits2dcl.size(); ++h) {
       TVector2 pfront = pma::GetProjectionToPlane(
-        track->front()->Point3D(), plane3, track->FrontTPC(), track->FrontCryo());
+        pma::ToTVector3(track->front()->Point3D()), plane3, track->FrontTPC(), track->FrontCryo());
       TVector2 pback = pma::GetProjectionToPlane(
-        track->back()->Point3D(), plane3, track->BackTPC(), track->BackCryo());
+        pma::ToTVector3(track->back()->Point3D()), plane3, track->BackTPC(), track->BackCryo());
       if ((pma::Dist2(hits2dcl[h]->GetPointCm(), pfront) < 1.0F) &&
           (pma::Dist2(hits2dcl[h]->GetPointCm(), pback) < 1.0F)) {
         result = true;
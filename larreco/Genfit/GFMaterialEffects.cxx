@@ -22,19 +22,15 @@
 #include <math.h>
 
 #include "larreco/Genfit/GFException.h"
+#include "larreco/Genfit/GFMaterialMap.h"
 
 #include "TDatabasePDG.h"
 #include "TGeoManager.h"
 #include "TGeoMaterial.h"
 #include "TGeoMedium.h"
 #include "TGeoVolume.h"
-#include "TMatrixT.h"
-#include "TMatrixTBase.h"
-#include "TMatrixTUtils.h"
 #include "TParticlePDG.h"
 
-genf::GFMaterialEffects* genf::GFMaterialEffects::finstance = NULL;
-
 genf::GFMaterialEffects::~GFMaterialEffects()
 {
   //  for(unsigned int i=0;i<fEnergyLoss.size();++i) delete fEnergyLoss.at(i);
@@ -58,7 +54,7 @@ genf::GFMaterialEffects::GFMaterialEffects()
   , fNoiseCoulomb(true)
   , fEnergyLossBrems(true)
   , fNoiseBrems(true)
-  , me(0.510998910E-3)
+  , fMaterialMap(NULL)
   , fstep(0)
   , fbeta(0)
   , fdedx(0)
@@ -69,23 +65,16 @@ genf::GFMaterialEffects::GFMaterialEffects()
   , fmatA(0)
   , fradiationLength(0)
   , fmEE(0)
+  , fParticleSet(false)
   , fpdg(0)
   , fcharge(0)
   , fmass(0)
 {}
 
-genf::GFMaterialEffects* genf::GFMaterialEffects::getInstance()
-{
-  if (finstance == NULL) finstance = new GFMaterialEffects();
-  return finstance;
-}
-
-void genf::GFMaterialEffects::destruct()
+std::mutex& genf::GFMaterialEffects::geometryMutex()
 {
-  if (finstance != NULL) {
-    delete finstance;
-    finstance = NULL;
-  }
+  static std::mutex mutex;
+  return mutex;
 }
 
 double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
@@ -93,21 +82,18 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
                                         const double& mom,
                                         const int& pdg,
                                         const bool& doNoise,
-                                        TMatrixT<Double_t>* noise,
-                                        const TMatrixT<Double_t>* jacobian,
+                                        GFMatrix7* noise,
+                                        const GFMatrix7* jacobian,
                                         const TVector3* directionBefore,
                                         const TVector3* directionAfter)
 {
 
   //assert(points.size()==pointPaths.size());
-  fpdg = pdg;
+  setParticle(pdg);
 
   double momLoss = 0.;
 
   for (unsigned int i = 1; i < points.size(); ++i) {
-    //    TVector3 p1=points.at(i-1);
-    //TVector3 p2=points.at(i);
-    //TVector3 dir=p2-p1;
     TVector3 dir = points.at(i) - points.at(i - 1);
     double dist = dir.Mag();
     double realPath = pointPaths.at(i);
@@ -115,11 +101,26 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
     if (dist > 1.E-8) { // do material effects only if distance is not too small
       dir *= 1. / dist; //normalize dir
 
+      // inside a single volume, navigation would make one step of the whole distance
+      const TGeoVolume* volume =
+        fMaterialMap ? fMaterialMap->uniformVolume(points.at(i - 1), dir, dist) : NULL;
+      if (volume) {
+        getParameters(volume);
+        fstep = dist;
+        stepEffects(momLoss,
+                    realPath / dist,
+                    mom,
+                    doNoise,
+                    noise,
+                    jacobian,
+                    directionBefore,
+                    directionAfter);
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lock(geometryMutex());
+
       double X(0.);
-      /*
-      double matDensity, matZ, matA, radiationLength, mEE;
-      double step;
-      */
 
       gGeoManager->InitTrack(points.at(i - 1).X(),
                              points.at(i - 1).Y(),
@@ -130,44 +131,19 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
 
       while (X < dist) {
 
-        getParameters();
-        //        geoMatManager->getMaterialParameters(matDensity, matZ, matA, radiationLength, mEE);
+        getParameters(gGeoManager->GetCurrentVolume());
 
-        //        step = geoMatManager->stepOrNextBoundary(dist-X);
         gGeoManager->FindNextBoundaryAndStep(dist - X);
         fstep = gGeoManager->GetStep();
 
-        // Loop over EnergyLoss classes
-        if (fmatZ > 1.E-3) {
-          /*
-          for(unsigned int j=0;j<fEnergyLoss.size();++j){
-            momLoss += realPath/dist*fEnergyLoss.at(j)->energyLoss(step,
-                                                                   mom,
-                                                                   pdg,
-                                                                   matDensity,
-                                                                   matZ,
-                                                                   matA,
-                                                                   radiationLength,
-                                                                   mEE,
-                                                                   doNoise,
-                                                                   noise,
-                                                                   jacobian,
-                                                                   directionBefore,
-                                                                   directionAfter);
-								   }
-	  */
-          calcBeta(mom);
-
-          if (fEnergyLossBetheBloch) momLoss += realPath / dist * this->energyLossBetheBloch(mom);
-          if (doNoise && fEnergyLossBetheBloch && fNoiseBetheBloch)
-            this->noiseBetheBloch(mom, noise);
-
-          if (/*doNoise &&*/ fNoiseCoulomb) // Force it
-            this->noiseCoulomb(mom, noise, jacobian, directionBefore, directionAfter);
-
-          if (fEnergyLossBrems) momLoss += realPath / dist * this->energyLossBrems(mom);
-          if (doNoise && fEnergyLossBrems && fNoiseBrems) this->noiseBrems(mom, noise);
-        }
+        stepEffects(momLoss,
+                    realPath / dist,
+                    mom,
+                    doNoise,
+                    noise,
+                    jacobian,
+                    directionBefore,
+                    directionAfter);
 
         X += fstep;
       }
@@ -177,6 +153,29 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
   return momLoss;
 }
 
+void genf::GFMaterialEffects::stepEffects(double& momLoss,
+                                          double pathScale,
+                                          const double& mom,
+                                          bool doNoise,
+                                          GFMatrix7* noise,
+                                          const GFMatrix7* jacobian,
+                                          const TVector3* directionBefore,
+                                          const TVector3* directionAfter)
+{
+  if (fmatZ > 1.E-3) {
+    calcBeta(mom);
+
+    if (fEnergyLossBetheBloch) momLoss += pathScale * this->energyLossBetheBloch(mom);
+    if (doNoise && fEnergyLossBetheBloch && fNoiseBetheBloch) this->noiseBetheBloch(mom, noise);
+
+    if (/*doNoise &&*/ fNoiseCoulomb) // Force it
+      this->noiseCoulomb(mom, noise, jacobian, directionBefore, directionAfter);
+
+    if (fEnergyLossBrems) momLoss += pathScale * this->energyLossBrems(mom);
+    if (doNoise && fEnergyLossBrems && fNoiseBrems) this->noiseBrems(mom, noise);
+  }
+}
+
 double genf::GFMaterialEffects::stepper(const double& maxDist,
                                         const double& posx,
                                         const double& posy,
@@ -185,45 +184,20 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
                                         const double& diry,
                                         const double& dirz,
                                         const double& mom,
-                                        const int& /* pdg */)
+                                        const int& pdg)
 {
 
   static const double maxPloss = .005; // maximum relative momentum loss allowed
 
-  gGeoManager->InitTrack(posx, posy, posz, dirx, diry, dirz);
+  setParticle(pdg);
 
   double X(0.);
   double dP = 0.;
   double momLoss = 0.;
-  /*
-  double matDensity, matZ, matA, radiationLength, mEE;
-  double step;
-  */
-
-  while (X < maxDist) {
-
-    getParameters();
-
-    gGeoManager->FindNextBoundaryAndStep(maxDist - X);
-    fstep = gGeoManager->GetStep();
-    //
-    //    step = geoMatManager->stepOrNextBoundary(maxDist-X);
-
-    // Loop over EnergyLoss classes
 
+  // adds the step of length fstep in the current material; true if the maximum loss is reached
+  auto addStep = [&]() {
     if (fmatZ > 1.E-3) {
-      /*
-      for(unsigned int j=0;j<fEnergyLoss.size();++j){
-        momLoss += fEnergyLoss.at(j)->energyLoss(step,
-                                                 mom,
-                                                 pdg,
-                                                 matDensity,
-                                                 matZ,
-                                                 matA,
-                                                 radiationLength,
-                                                 mEE);
-						 }
-    */
       calcBeta(mom);
 
       if (fEnergyLossBetheBloch) momLoss += this->energyLossBetheBloch(mom);
@@ -238,21 +212,45 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
           .setFatal();
       dP += fraction * momLoss;
       X += fraction * fstep;
-      break;
+      return true;
     }
 
     dP += momLoss;
     X += fstep;
+    return false;
+  };
+
+  const TVector3 pos(posx, posy, posz), dir(dirx, diry, dirz);
+  const TGeoVolume* volume = fMaterialMap ? fMaterialMap->uniformVolume(pos, dir, maxDist) : NULL;
+  if (volume) {
+    getParameters(volume);
+    fstep = maxDist;
+    addStep();
+    return X;
+  }
+
+  std::lock_guard<std::mutex> lock(geometryMutex());
+
+  gGeoManager->InitTrack(posx, posy, posz, dirx, diry, dirz);
+
+  while (X < maxDist) {
+
+    getParameters(gGeoManager->GetCurrentVolume());
+
+    gGeoManager->FindNextBoundaryAndStep(maxDist - X);
+    fstep = gGeoManager->GetStep();
+
+    if (addStep()) break;
   }
 
   return X;
 }
 
-void genf::GFMaterialEffects::getParameters()
+void genf::GFMaterialEffects::getParameters(const TGeoVolume* volume)
 {
-  if (!gGeoManager->GetCurrentVolume()->GetMedium())
+  if (!volume->GetMedium())
     throw GFException(std::string(__func__) + ": no medium", __LINE__, __FILE__).setFatal();
-  TGeoMaterial* mat = gGeoManager->GetCurrentVolume()->GetMedium()->GetMaterial();
+  TGeoMaterial* mat = volume->GetMedium()->GetMaterial();
   fmatDensity = mat->GetDensity();
   fmatZ = mat->GetZ();
   fmatA = mat->GetA();
@@ -266,10 +264,23 @@ void genf::GFMaterialEffects::getParameters()
   fmatA = 39.95;
   fradiationLength = 13.947;
   fmEE = 188.0;
+}
 
-  TParticlePDG* part = TDatabasePDG::Instance()->GetParticle(fpdg);
+void genf::GFMaterialEffects::setParticle(int pdg)
+{
+  if (fParticleSet && pdg == fpdg) return;
+
+  TParticlePDG* part = NULL;
+  {
+    // the particle database is filled on first use
+    static std::mutex databaseMutex;
+    std::lock_guard<std::mutex> lock(databaseMutex);
+    part = TDatabasePDG::Instance()->GetParticle(pdg);
+  }
+  fpdg = pdg;
   fcharge = part->Charge() / (3.);
   fmass = part->Mass();
+  fParticleSet = true;
 }
 
 void genf::GFMaterialEffects::calcBeta(double mom)
@@ -326,7 +337,7 @@ double genf::GFMaterialEffects::energyLossBetheBloch(const double& mom)
   return momLoss;
 }
 
-void genf::GFMaterialEffects::noiseBetheBloch(const double& mom, TMatrixT<double>* noise) const
+void genf::GFMaterialEffects::noiseBetheBloch(const double& mom, GFMatrix7* noise) const
 {
 
   // ENERGY LOSS FLUCTUATIONS; calculate sigma^2(E);
@@ -388,12 +399,12 @@ void genf::GFMaterialEffects::noiseBetheBloch(const double& mom, TMatrixT<double
   sigma2E *= 1.E-18; // eV -> GeV
 
   // update noise matrix
-  (*noise)[6][6] += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
+  (*noise)(6, 6) += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
 }
 
 void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
-                                           TMatrixT<double>* noise,
-                                           const TMatrixT<double>* jacobian,
+                                           GFMatrix7* noise,
+                                           const GFMatrix7* jacobian,
                                            const TVector3* directionBefore,
                                            const TVector3* directionAfter) const
 {
@@ -410,7 +421,7 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
         -0.5)); // sigma^2 = 225E-6/mom^2 * XX0/fbeta^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
 
   // noiseBefore
-  TMatrixT<double> noiseBefore(7, 7);
+  GFMatrix7 noiseBefore; // zero everywhere by default
 
   // calculate euler angles theta, psi (so that directionBefore' points in z' direction)
   double psi = 0;
@@ -439,27 +450,25 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
   double noiseBefore35 = -sigma2 * costheta * sinpsi * sintheta;
   double noiseBefore45 = sigma2 * costheta * cospsi * sintheta;
 
-  noiseBefore[3][3] =
+  noiseBefore(3, 3) =
     sigma2 * (cospsi * cospsi + costheta * costheta - costheta * costheta * cospsi * cospsi);
-  noiseBefore[4][3] = noiseBefore34;
-  noiseBefore[5][3] = noiseBefore35;
-
-  noiseBefore[3][4] = noiseBefore34;
-  noiseBefore[4][4] = sigma2 * (sinpsi * sinpsi + costheta * costheta * cospsi * cospsi);
-  noiseBefore[5][4] = noiseBefore45;
+  noiseBefore(4, 3) = noiseBefore34;
+  noiseBefore(5, 3) = noiseBefore35;
 
-  noiseBefore[3][5] = noiseBefore35;
-  noiseBefore[4][5] = noiseBefore45;
-  noiseBefore[5][5] = sigma2 * sintheta * sintheta;
+  noiseBefore(3, 4) = noiseBefore34;
+  noiseBefore(4, 4) = sigma2 * (sinpsi * sinpsi + costheta * costheta * cospsi * cospsi);
+  noiseBefore(5, 4) = noiseBefore45;
 
-  TMatrixT<double> jacobianT(7, 7);
-  jacobianT = (*jacobian);
-  jacobianT.T();
+  noiseBefore(3, 5) = noiseBefore35;
+  noiseBefore(4, 5) = noiseBefore45;
+  noiseBefore(5, 5) = sigma2 * sintheta * sintheta;
 
-  noiseBefore = jacobianT * noiseBefore * (*jacobian); //propagate
+  const GFMatrix7 jacobianT = ROOT::Math::Transpose(*jacobian);
+  const GFMatrix7 jacobianTNoise = jacobianT * noiseBefore;
+  noiseBefore = jacobianTNoise * (*jacobian); //propagate
 
   // noiseAfter
-  TMatrixT<double> noiseAfter(7, 7);
+  GFMatrix7 noiseAfter;
 
   // calculate euler angles theta, psi (so that A' points in z' direction)
   psi = 0;
@@ -488,18 +497,18 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
   double noiseAfter35 = -sigma2 * costheta * sinpsi * sintheta;
   double noiseAfter45 = sigma2 * costheta * cospsi * sintheta;
 
-  noiseAfter[3][3] =
+  noiseAfter(3, 3) =
     sigma2 * (cospsi * cospsi + costheta * costheta - costheta * costheta * cospsi * cospsi);
-  noiseAfter[4][3] = noiseAfter34;
-  noiseAfter[5][3] = noiseAfter35;
+  noiseAfter(4, 3) = noiseAfter34;
+  noiseAfter(5, 3) = noiseAfter35;
 
-  noiseAfter[3][4] = noiseAfter34;
-  noiseAfter[4][4] = sigma2 * (sinpsi * sinpsi + costheta * costheta * cospsi * cospsi);
-  noiseAfter[5][4] = noiseAfter45;
+  noiseAfter(3, 4) = noiseAfter34;
+  noiseAfter(4, 4) = sigma2 * (sinpsi * sinpsi + costheta * costheta * cospsi * cospsi);
+  noiseAfter(5, 4) = noiseAfter45;
 
-  noiseAfter[3][5] = noiseAfter35;
-  noiseAfter[4][5] = noiseAfter45;
-  noiseAfter[5][5] = sigma2 * sintheta * sintheta;
+  noiseAfter(3, 5) = noiseAfter35;
+  noiseAfter(4, 5) = noiseAfter45;
+  noiseAfter(5, 5) = sigma2 * sintheta * sintheta;
 
   //calculate mean of noiseBefore and noiseAfter and update noise
   (*noise) += 0.5 * noiseBefore + 0.5 * noiseAfter;
@@ -714,7 +723,7 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
   return momLoss;
 }
 
-void genf::GFMaterialEffects::noiseBrems(const double& mom, TMatrixT<double>* noise) const
+void genf::GFMaterialEffects::noiseBrems(const double& mom, GFMatrix7* noise) const
 {
 
   if (fabs(fpdg) != 11) return; // only for electrons and positrons
@@ -726,7 +735,7 @@ void genf::GFMaterialEffects::noiseBrems(const double& mom, TMatrixT<double>* no
   double sigma2E = DEDXB * DEDXB; //eV^2
   sigma2E *= 1.E-18;              // eV -> GeV
 
-  (*noise)[6][6] += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
+  (*noise)(6, 6) += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
 }
 
 /*
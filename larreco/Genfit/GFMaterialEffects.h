@@ -24,11 +24,14 @@
 #ifndef GFMATERIALEFFECTS_H
 #define GFMATERIALEFFECTS_H
 
+#include "Math/SMatrix.h"
 #include "TObject.h"
 #include "TVector3.h"
+#include <mutex>
 #include <vector>
 
 class TGeoMaterial;
+class TGeoVolume;
 
 /** @brief  Handles energy loss classes. Contains stepper and energy loss/noise matrix calculation
  *
@@ -42,20 +45,29 @@ class TGeoMaterial;
  *  exceed a specified maximum momentum loss. After propagation, the energy loss
  *  for the given length and (optionally) the noise matrix can be calculated.
  *
+ *  Each track representation owns its own instance, so that fits can run in parallel.
+ *  Segments which a GFMaterialMap shows to be inside a single volume are handled without
+ *  navigation; the others are navigated in gGeoManager, one thread at a time.
  *
  */
 
 namespace genf {
 
+  class GFMaterialMap;
+
+  //! Covariance, jacobian and noise matrices of the 7 dimensional state of the propagation
+  typedef ROOT::Math::SMatrix<double, 7, 7> GFMatrix7;
+
   class GFMaterialEffects : public TObject {
-  private:
+  public:
     GFMaterialEffects();
     virtual ~GFMaterialEffects();
-    static GFMaterialEffects* finstance;
 
-  public:
-    static GFMaterialEffects* getInstance();
-    static void destruct();
+    //! Serializes the use of the navigator of gGeoManager
+    static std::mutex& geometryMutex();
+
+    //! Map used to skip navigation where possible (NULL: always navigate); not owned
+    void setMaterialMap(const GFMaterialMap* map) { fMaterialMap = map; }
 
     void setEnergyLossBetheBloch(bool opt = true) { fEnergyLossBetheBloch = opt; }
     void setNoiseBetheBloch(bool opt = true) { fNoiseBetheBloch = opt; }
@@ -69,8 +81,8 @@ namespace genf {
                    const double& mom,
                    const int& pdg,
                    const bool& doNoise = false,
-                   TMatrixT<Double_t>* noise = NULL,
-                   const TMatrixT<Double_t>* jacobian = NULL,
+                   GFMatrix7* noise = NULL,
+                   const GFMatrix7* jacobian = NULL,
                    const TVector3* directionBefore = NULL,
                    const TVector3* directionAfter = NULL);
 
@@ -100,7 +112,20 @@ namespace genf {
     //  std::vector<GFAbsEnergyLoss*> fEnergyLoss;
     //! interface to material and geometry
     //GFGeoMatManager *geoMatManager;
-    void getParameters();
+    void getParameters(const TGeoVolume* volume);
+
+    //! sets fpdg, fcharge, fmass
+    void setParticle(int pdg);
+
+    //! energy loss and noise of a step of length fstep in the current material
+    void stepEffects(double& momLoss,
+                     double pathScale,
+                     const double& mom,
+                     bool doNoise,
+                     GFMatrix7* noise,
+                     const GFMatrix7* jacobian,
+                     const TVector3* directionBefore,
+                     const TVector3* directionAfter);
 
     //! sets fbeta, fgamma, fgammasquare; must only be used after calling getParameters()
     void calcBeta(double mom);
@@ -122,7 +147,7 @@ namespace genf {
     *
     *  Needs fdedx, which is calculated in energyLossBetheBloch, so it has to be calles afterwards!
     */
-    void noiseBetheBloch(const double& mom, TMatrixT<double>* noise) const;
+    void noiseBetheBloch(const double& mom, GFMatrix7* noise) const;
 
     //! calculation of multiple scattering
     /**  With the calculated multiple scattering angle, two noise matrices are calculated:
@@ -315,8 +340,8 @@ namespace genf {
     * \n
     */
     void noiseCoulomb(const double& mom,
-                      TMatrixT<double>* noise,
-                      const TMatrixT<double>* jacobian,
+                      GFMatrix7* noise,
+                      const GFMatrix7* jacobian,
                       const TVector3* directionBefore,
                       const TVector3* directionAfter) const;
 
@@ -331,17 +356,19 @@ namespace genf {
     /** Can be called with any pdg, but only calculates straggeling for electrons and positrons.
    *
    */
-    void noiseBrems(const double& mom, TMatrixT<double>* noise) const;
+    void noiseBrems(const double& mom, GFMatrix7* noise) const;
     double MeanExcEnergy_get(int Z);
     double MeanExcEnergy_get(TGeoMaterial*);
 
+    const GFMaterialMap* fMaterialMap;
+
     bool fEnergyLossBetheBloch;
     bool fNoiseBetheBloch;
     bool fNoiseCoulomb;
     bool fEnergyLossBrems;
     bool fNoiseBrems;
 
-    const double me; // electron mass (GeV)
+    static constexpr double me = 0.510998910E-3; // electron mass (GeV)
 
     double fstep; // stepsize
 
@@ -357,6 +384,7 @@ namespace genf {
     double fradiationLength;
     double fmEE; // mean excitation energy
 
+    bool fParticleSet;
     int fpdg;
     double fcharge;
     double fmass;
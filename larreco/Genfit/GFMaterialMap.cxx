@@ -0,0 +1,125 @@
+#include "larreco/Genfit/GFMaterialMap.h"
+
+#include "larreco/Genfit/GFException.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
+
+#include "TGeoManager.h"
+#include "TGeoNode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+
+genf::GFMaterialMap::GFMaterialMap(const TVector3& lower,
+                                   const TVector3& upper,
+                                   double voxelSize,
+                                   std::size_t maxVoxels)
+  : fLower(lower), fVoxelSize(voxelSize), fNx(0), fNy(0), fNz(0)
+{
+  if (!gGeoManager)
+    throw GFException(std::string(__func__) + ": no geometry", __LINE__, __FILE__).setFatal();
+  if (!(voxelSize > 0.) || maxVoxels == 0)
+    throw GFException(std::string(__func__) + ": invalid voxel size", __LINE__, __FILE__)
+      .setFatal();
+
+  TVector3 const size = upper - lower;
+  auto const nVoxels = [&size](double side) {
+    return std::max(1., std::ceil(size.X() / side)) * std::max(1., std::ceil(size.Y() / side)) *
+           std::max(1., std::ceil(size.Z() / side));
+  };
+  while (nVoxels(fVoxelSize) > maxVoxels)
+    fVoxelSize *= 1.25;
+
+  fNx = std::max(1, int(std::ceil(size.X() / fVoxelSize)));
+  fNy = std::max(1, int(std::ceil(size.Y() / fVoxelSize)));
+  fNz = std::max(1, int(std::ceil(size.Z() / fVoxelSize)));
+  fVoxelNodes.assign(std::size_t(fNx) * fNy * fNz, -1);
+
+  // a voxel lies within the safety sphere around its centre if the radius reaches its corners
+  double const halfDiagonal = 0.5 * std::sqrt(3.) * fVoxelSize;
+
+  std::lock_guard<std::mutex> lock(GFMaterialEffects::geometryMutex());
+
+  std::map<std::vector<const TGeoNode*>, int> nodeIndex;
+  std::vector<const TGeoNode*> branch;
+  std::size_t iVoxel = 0;
+  for (int iz = 0; iz < fNz; ++iz) {
+    for (int iy = 0; iy < fNy; ++iy) {
+      for (int ix = 0; ix < fNx; ++ix, ++iVoxel) {
+        if (!gGeoManager->FindNode(fLower.X() + (ix + 0.5) * fVoxelSize,
+                                   fLower.Y() + (iy + 0.5) * fVoxelSize,
+                                   fLower.Z() + (iz + 0.5) * fVoxelSize))
+          continue;
+        if (!(gGeoManager->Safety() > halfDiagonal)) continue;
+
+        // the physical node is identified by the whole branch from the top volume
+        branch.clear();
+        for (int up = gGeoManager->GetLevel(); up >= 0; --up)
+          branch.push_back(gGeoManager->GetMother(up));
+
+        auto const inserted = nodeIndex.emplace(branch, int(fNodeVolumes.size()));
+        if (inserted.second) fNodeVolumes.push_back(gGeoManager->GetCurrentVolume());
+        fVoxelNodes[iVoxel] = inserted.first->second;
+      }
+    }
+  }
+}
+
+std::size_t genf::GFMaterialMap::nMappedVoxels() const
+{
+  return fVoxelNodes.size() - std::count(fVoxelNodes.begin(), fVoxelNodes.end(), -1);
+}
+
+const TGeoVolume* genf::GFMaterialMap::uniformVolume(const TVector3& start,
+                                                     const TVector3& dir,
+                                                     double length) const
+{
+  // walk the voxels crossed by the segment, in units of voxels from the lower corner
+  // (Amanatides & Woo)
+  int const nCells[3] = {fNx, fNy, fNz};
+  int cell[3], lastCell[3], cellStep[3];
+  double tNext[3], tDelta[3];
+  for (int i = 0; i < 3; ++i) {
+    double const begin = (start[i] - fLower[i]) / fVoxelSize;
+    double const delta = dir[i] * length / fVoxelSize;
+    double const end = begin + delta;
+    if (!(begin >= 0. && end >= 0. && begin < nCells[i] && end < nCells[i])) return NULL;
+
+    cell[i] = int(begin);
+    lastCell[i] = int(end);
+    if (delta > 0.) {
+      cellStep[i] = 1;
+      tNext[i] = (cell[i] + 1 - begin) / delta;
+      tDelta[i] = 1. / delta;
+    }
+    else if (delta < 0.) {
+      cellStep[i] = -1;
+      tNext[i] = (cell[i] - begin) / delta;
+      tDelta[i] = -1. / delta;
+    }
+    else {
+      cellStep[i] = 0;
+      tNext[i] = tDelta[i] = std::numeric_limits<double>::infinity();
+    }
+  }
+
+  int const node = voxelNode(cell[0], cell[1], cell[2]);
+  if (node < 0) return NULL;
+
+  while (cell[0] != lastCell[0] || cell[1] != lastCell[1] || cell[2] != lastCell[2]) {
+    int const axis = (tNext[0] < tNext[1]) ? (tNext[0] < tNext[2] ? 0 : 2) :
+                                             (tNext[1] < tNext[2] ? 1 : 2);
+    if (tNext[axis] > 1.) break; // rounding; the last cell is checked below
+    cell[axis] += cellStep[axis];
+    if (cell[axis] < 0 || cell[axis] >= nCells[axis]) return NULL;
+    tNext[axis] += tDelta[axis];
+    if (voxelNode(cell[0], cell[1], cell[2]) != node) return NULL;
+  }
+
+  // the last cell may have been missed to rounding at a voxel corner
+  if (voxelNode(lastCell[0], lastCell[1], lastCell[2]) != node) return NULL;
+
+  return fNodeVolumes[node];
+}
@@ -0,0 +1,67 @@
+/** @addtogroup RKTrackRep
+ * @{
+ */
+
+#ifndef GFMATERIALMAP_H
+#define GFMATERIALMAP_H
+
+#include "TVector3.h"
+
+#include <cstddef>
+#include <vector>
+
+class TGeoVolume;
+
+/** @brief  Voxel map of the geometry, to look up materials without TGeo navigation
+ *
+ *  The map covers a box (typically the cryostats) with cubic voxels. A voxel is assigned to a
+ *  physical node of gGeoManager only if the TGeo safety distance at its centre shows that the
+ *  whole voxel lies inside that node and outside all of its daughters; the other voxels are
+ *  left to navigation. Distinct placements of the same volume are distinct nodes, so a segment
+ *  is reported as uniform exactly when TGeo would cover it in a single step.
+ *
+ *  The map is filled on construction and never changed afterwards, so one map can be shared
+ *  by the track representations of all the threads.
+ */
+
+namespace genf {
+
+  class GFMaterialMap {
+  public:
+    //! Maps the box between the two corners; the voxel side is increased as needed to keep
+    //! the number of voxels within maxVoxels
+    GFMaterialMap(const TVector3& lower,
+                  const TVector3& upper,
+                  double voxelSize,
+                  std::size_t maxVoxels = 1 << 22);
+
+    //! The volume containing the whole segment, or NULL if that is not known
+    /** Returns NULL when the segment may cross a boundary, when it leaves the mapped box, or when
+     *  it runs through a voxel too close to a boundary to be mapped.
+     */
+    const TGeoVolume* uniformVolume(const TVector3& start,
+                                    const TVector3& dir,
+                                    double length) const;
+
+    double voxelSize() const { return fVoxelSize; }
+    std::size_t nVoxels() const { return fVoxelNodes.size(); }
+    std::size_t nMappedVoxels() const;
+
+  private:
+    int voxelNode(int ix, int iy, int iz) const { return fVoxelNodes[(iz * fNy + iy) * fNx + ix]; }
+
+    TVector3 fLower;
+    double fVoxelSize;
+    int fNx, fNy, fNz;
+
+    //! index in fNodeVolumes of the node containing each voxel, -1 for unmapped voxels
+    std::vector<int> fVoxelNodes;
+    //! volume of each physical node
+    std::vector<const TGeoVolume*> fNodeVolumes;
+  };
+
+} // end namespace
+
+#endif
+
+/** @} */
@@ -75,7 +75,6 @@ const TMatrixT<double>* genf::RKTrackRep::getAuxInfo(const GFDetPlane& pl)
 genf::RKTrackRep::~RKTrackRep()
 {
   // delete fEffect;
-  //GFMaterialEffects is now a Singleton
 }
 
 genf::RKTrackRep::RKTrackRep()
@@ -804,23 +803,16 @@ bool genf::RKTrackRep::RKutta(const GFDetPlane& plane,
     // call stepper and reduce stepsize
     double stepperLen;
     //std::cout<< "RKTrackRep: About to enter fEffect->stepper()" << std::endl;
-    /*
-    stepperLen = fEffect->stepper(fabs(S),
-                                  R[0],R[1],R[2],
-                                  Ssign*A[0],Ssign*A[1],Ssign*A[2],
-                                  fabs(fCharge/P[6]),
-                                  fPdg);
-    */
     // From Genfit svn, 27-Sep-2011.
-    stepperLen = GFMaterialEffects::getInstance()->stepper(fabs(S),
-                                                           R[0],
-                                                           R[1],
-                                                           R[2],
-                                                           Ssign * A[0],
-                                                           Ssign * A[1],
-                                                           Ssign * A[2],
-                                                           fabs(fCharge / P[6]),
-                                                           fPdg);
+    stepperLen = fEffect.stepper(fabs(S),
+                                 R[0],
+                                 R[1],
+                                 R[2],
+                                 Ssign * A[0],
+                                 Ssign * A[1],
+                                 Ssign * A[2],
+                                 fabs(fCharge / P[6]),
+                                 fPdg);
 
     //std::cout<< "RKTrackRep: S,R[0],R[1],R[2], A[0],A[1],A[2], stepperLen is " << S <<", "<< R[0] <<", "<< R[1]<<", " << R[2] <<", "<< A[0]<<", " << A[1]<<", " << A[2]<<", " << stepperLen << std::endl;
     if (stepperLen < MINSTEP)
@@ -1149,10 +1141,10 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
     P[i] = (*state)[i][0];
   }
 
-  TMatrixT<Double_t> jac(7, 7);
-  TMatrixT<Double_t> jacT(7, 7);
-  TMatrixT<Double_t> oldCov(7, 7);
-  if (calcCov) oldCov = (*cov);
+  // fixed size matrices on the stack; *cov is updated after every iteration
+  GFMatrix7 jac;
+  GFMatrix7 propCov;
+  if (calcCov) propCov.SetElements(cov->GetMatrixArray(), cov->GetMatrixArray() + 49);
   double coveredDistance(0.);
   double sumDistance(0.);
 
@@ -1249,48 +1241,36 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
       for (int i = 0; i < 7; ++i) {
         for (int j = 0; j < 7; ++j) {
           if (i < 6)
-            jac[i][j] = P[(i + 1) * 7 + j];
+            jac(i, j) = P[(i + 1) * 7 + j];
           else
-            jac[i][j] = P[(i + 1) * 7 + j] / P[6];
+            jac(i, j) = P[(i + 1) * 7 + j] / P[6];
         }
       }
-      jacT = jac;
-      jacT.T();
     }
 
-    TMatrixT<Double_t> noise(7, 7); // zero everywhere by default
+    GFMatrix7 noise; // zero everywhere by default
 
     // call MatEffects
     double momLoss; // momLoss has a sign - negative loss means momentum gain
 
-    /*
-    momLoss = fEffect->effects(pointsFilt,
-                               pointPathsFilt,
-                               fabs(fCharge/P[6]), // momentum
-                               fPdg,
-                               calcCov,
-                               &noise,
-                               &jac,
-                               &directionBefore,
-                               &directionAfter);
-    */
-    momLoss = GFMaterialEffects::getInstance()->effects(pointsFilt,
-                                                        pointPathsFilt,
-                                                        fabs(fCharge / P[6]), // momentum
-                                                        fPdg,
-                                                        calcCov,
-                                                        &noise,
-                                                        &jac,
-                                                        &directionBefore,
-                                                        &directionAfter);
+    momLoss = fEffect.effects(pointsFilt,
+                              pointPathsFilt,
+                              fabs(fCharge / P[6]), // momentum
+                              fPdg,
+                              calcCov,
+                              &noise,
+                              &jac,
+                              &directionBefore,
+                              &directionAfter);
 
     if (fabs(P[6]) > 1.E-10) { // do momLoss only for defined 1/momentum .ne.0
       P[6] = fCharge / (fabs(fCharge / P[6]) - momLoss);
     }
 
     if (calcCov) { //propagate cov and add noise
-      oldCov = *cov;
-      *cov = jacT * ((oldCov)*jac) + noise;
+      const GFMatrix7 covJac = propCov * jac;
+      propCov = ROOT::Math::Transpose(jac) * covJac + noise;
+      std::copy(propCov.begin(), propCov.end(), cov->GetMatrixArray());
     }
 
     //we arrived at the destination plane, if we point to the active area
@@ -29,6 +29,7 @@
 
 #include "larreco/Genfit/GFAbsTrackRep.h"
 #include "larreco/Genfit/GFDetPlane.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
 #include <TMatrixT.h>
 #include <stdexcept> // std::logic_error
 
@@ -36,8 +37,6 @@ namespace genf {
   class GFTrackCand;
 }
 
-//#include "GFMaterialEffects.h"
-
 /** @brief Track Representation module based on a Runge-Kutta algorithm including a full material model
  *
  *  @author Christian H&ouml;ppner (Technische Universit&auml;t M&uuml;nchen, original author)
@@ -136,6 +135,8 @@ namespace genf {
     //! Set PDG particle code
     void setPDG(int);
     int getPDG();
+    //! Set the map used to skip geometry navigation in the material effects (not owned)
+    void setMaterialMap(const GFMaterialMap* map) { fEffect.setMaterialMap(map); }
     void rescaleCovOffDiags();
 
     //! Sets state, plane and (optionally) covariance
@@ -163,7 +164,7 @@ namespace genf {
     TMatrixT<double> fAuxInfo;
 
     RKTrackRep& operator=(const RKTrackRep* /* rhs */) { return *this; }
-    RKTrackRep(const RKTrackRep& /* rhs */) : GFAbsTrackRep() {}
+    RKTrackRep(const RKTrackRep& rhs) : GFAbsTrackRep(), fEffect(rhs.fEffect) {}
     bool fDirection;
 
     //! PDG particle code
@@ -172,8 +173,8 @@ namespace genf {
     double fMass;
     //! Charge
     double fCharge;
-    //! Contains all material effects
-    //GFMaterialEffects *fEffect;
+    //! Contains all material effects; holds the state of the calculation, hence mutable
+    mutable GFMaterialEffects fEffect;
 
     //! Propagates the particle through the magnetic field.
     /** If the propagation is successfull and the plane is reached, the function returns true.
@@ -27,17 +27,24 @@
 // If Chi2/NDF is still bad or if #peaks > MaxMultiHit or width > MaxGroupLength:
 // 6. Split pulse into equally long hits.
 //
+// The wires are independent and are processed in parallel (in order when LogLevel > 0);
+// the hits are put into the event in wire order.
+//
 // The parameters of the fit are saved in a feature vector by using MVAWriter to
 // draw the fitted function in the event display.
 //
 ////////////////////////////////////////////////////////////////////////
 
 // C/C++ standard library
-#include <algorithm> // std::accumulate()
+#include <algorithm> // std::max()
+#include <array>
 #include <cmath>
-#include <memory> // std::unique_ptr()
+#include <limits>
+#include <memory>  // std::unique_ptr()
+#include <numeric> // std::accumulate()
 #include <string>
 #include <utility> // std::move()
+#include <vector>
 
 // Framework includes
 #include "art/Framework/Core/EDProducer.h"
@@ -58,12 +65,16 @@
 #include "lardata/ArtDataHelper/MVAWriter.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/Wire.h"
+#include "larreco/HitFinder/MultiExpFitter.h"
+#include "larreco/Monitoring/StageMonitorService.h"
 
 // ROOT Includes
-#include "TF1.h"
 #include "TH1F.h"
 #include "TMath.h"
 
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+
 namespace hit {
   class DPRawHitFinder : public art::EDProducer {
 
@@ -91,39 +102,54 @@ namespace hit {
                             float& PeakMin,
                             int firstTick) const;
 
-    int EstimateFluctuations(const std::vector<float> fsignalVec,
+    /// Fitter parameters and scratch memory used by a single thread
+    struct FitWorkspace {
+      MultiExpFitter::FitParams params;
+      MultiExpFitter::Workspace fit;
+    };
+
+    /// Hits found on one wire, with their fit parameters and the chi2 of its fits
+    struct WireHits {
+      std::vector<recob::Hit> hits;
+      std::vector<std::array<float, 4>> fitParams;
+      std::vector<double> firstChi2;
+      std::vector<double> chi2;
+    };
+
+    int EstimateFluctuations(const std::vector<float>& fsignalVec,
                              int peakStart,
                              int peakMean,
-                             int peakEnd);
+                             int peakEnd) const;
 
-    void mergeCandidatePeaks(const std::vector<float> signalVec, TimeValsVec, MergedTimeWidVec&);
+    void mergeCandidatePeaks(const std::vector<float>& signalVec,
+                             const TimeValsVec&,
+                             MergedTimeWidVec&) const;
 
-    // ### This function will fit N-Exponentials to a TH1D where N is set ###
-    // ###            by the number of peaks found in the pulse         ###
+    // ### This function will fit N-Exponentials to a waveform where N is set ###
+    // ###            by the number of peaks found in the pulse              ###
 
-    void FitExponentials(const std::vector<float> fSignalVector,
-                         const PeakTimeWidVec fPeakVals,
+    void FitExponentials(const std::vector<float>& fSignalVector,
+                         const PeakTimeWidVec& fPeakVals,
                          int fStartTime,
                          int fEndTime,
                          ParameterVec& fparamVec,
                          double& fchi2PerNDF,
                          int& fNDF,
-                         bool fSameShape);
+                         bool fSameShape,
+                         FitWorkspace& workspace) const;
 
-    void FindPeakWithMaxDeviation(const std::vector<float> fSignalVector,
+    void FindPeakWithMaxDeviation(const std::vector<float>& fSignalVector,
                                   int fNPeaks,
-                                  int fStartTime,
-                                  int fEndTime,
                                   bool fSameShape,
-                                  ParameterVec fparamVec,
-                                  PeakTimeWidVec fpeakVals,
-                                  PeakDevVec& fPeakDev);
-
-    std::string CreateFitFunction(int fNPeaks, bool fSameShape);
+                                  const ParameterVec& fparamVec,
+                                  const PeakTimeWidVec& fpeakVals,
+                                  PeakDevVec& fPeakDev) const;
 
-    void AddPeak(std::tuple<double, int, int, int> fPeakDevCand, PeakTimeWidVec& fpeakValsTemp);
+    void AddPeak(std::tuple<double, int, int, int> fPeakDevCand,
+                 PeakTimeWidVec& fpeakValsTemp) const;
 
-    void SplitPeak(std::tuple<double, int, int, int> fPeakDevCand, PeakTimeWidVec& fpeakValsTemp);
+    void SplitPeak(std::tuple<double, int, int, int> fPeakDevCand,
+                   PeakTimeWidVec& fpeakValsTemp) const;
 
     double WidthFunc(double fPeakMean,
                      double fPeakAmp,
@@ -131,14 +157,14 @@ namespace hit {
                      double fPeakTau2,
                      double fStartTime,
                      double fEndTime,
-                     double fPeakMeanTrue);
+                     double fPeakMeanTrue) const;
 
     double ChargeFunc(double fPeakMean,
                       double fPeakAmp,
                       double fPeakTau1,
                       double fPeakTau2,
                       double fChargeNormFactor,
-                      double fPeakMeanTrue);
+                      double fPeakMeanTrue) const;
 
     void FillOutHitParameterVector(const std::vector<double>& input, std::vector<double>& output);
 
@@ -197,6 +223,17 @@ namespace hit {
       fNewHitsTag; // tag of hits produced by this module, need to have it for fit parameter data products
     anab::FVectorWriter<4> fHitParamWriter; // helper for saving hit fit parameters in data products
 
+    MultiExpFitter fFitter;
+    /// Created on first use by each thread; the fits do not spawn tasks, so a
+    /// thread never reenters its workspace while using it
+    tbb::enumerable_thread_specific<FitWorkspace> fFitWorkspaces;
+
+    // Time spent in each phase, if the StageMonitorService is configured
+    lar::StageMonitor* fStageMonitor;
+    lar::StageMonitor::StageID fEventStage{0};
+    lar::StageMonitor::StageID fHitFindingStage{0};
+    lar::StageMonitor::StageID fCollectionStage{0};
+
     TH1F* fFirstChi2;
     TH1F* fChi2;
 
@@ -210,6 +247,7 @@ namespace hit {
                   "",
                   art::ServiceHandle<art::TriggerNamesService const>()->getProcessName())
     , fHitParamWriter(producesCollector())
+    , fStageMonitor(lar::stageMonitorIfConfigured())
   {
     fLogLevel = pset.get<int>("LogLevel");
     fCalDataModuleLabel = pset.get<std::string>("CalDataModuleLabel");
@@ -253,6 +291,12 @@ namespace hit {
     // hits is going to be produced
     fHitParamWriter.produces_using<recob::Hit>();
 
+    if (fStageMonitor) {
+      fEventStage = fStageMonitor->Stage(fNewHitsTag.label());
+      fHitFindingStage = fStageMonitor->Stage(fNewHitsTag.label() + "/HitFinding");
+      fCollectionStage = fStageMonitor->Stage(fNewHitsTag.label() + "/Collection");
+    }
+
   } // DPRawHitFinder::DPRawHitFinder()
 
   //-------------------------------------------------
@@ -292,6 +336,7 @@ namespace hit {
   //-------------------------------------------------
   void DPRawHitFinder::produce(art::Event& evt)
   {
+    lar::StageTimer eventTimer(fStageMonitor, fEventStage);
     //==================================================================================================
     TH1::AddDirectory(kFALSE);
 
@@ -325,20 +370,23 @@ namespace hit {
     // ### Reading in the RawDigit associated with these wires, too  ###
     // #################################################################
     art::FindOneP<raw::RawDigit> RawDigits(wireVecHandle, evt, fCalDataModuleLabel);
-    // Channel Number
-    raw::ChannelID_t channel = raw::InvalidChannelID;
+
+    // hits found on each wire, handed over to the event in wire order at the end
+    std::vector<WireHits> wireHits(wireVecHandle->size());
 
     //##############################
     //### Looping over the wires ###
     //##############################
-    for (size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++) {
+    auto findHitsOnWire = [&](size_t wireIter) {
+      FitWorkspace& workspace = fFitWorkspaces.local();
+      WireHits& hitsOnWire = wireHits[wireIter];
+
       // ####################################
       // ### Getting this particular wire ###
       // ####################################
       art::Ptr<recob::Wire> wire(wireVecHandle, wireIter);
-      art::Ptr<raw::RawDigit> rawdigits = RawDigits.at(wireIter);
       // --- Setting Channel Number and Signal type ---
-      channel = wire->Channel();
+      raw::ChannelID_t channel = wire->Channel();
       // get the WireID for this hit
       std::vector<geo::WireID> wids = geom->ChannelToWire(channel);
       // for now, just take the first option returned from ChannelToWire
@@ -523,7 +571,8 @@ namespace hit {
             // ### Calling the function for fitting Exponentials ###
             // #####################################################
             paramVec.clear();
-            FitExponentials(signal, peakVals, startT, endT, paramVec, chi2PerNDF, NDF, fSameShape);
+            FitExponentials(
+              signal, peakVals, startT, endT, paramVec, chi2PerNDF, NDF, fSameShape, workspace);
 
             if (fLogLevel >= 4) {
               std::cout << std::endl;
@@ -566,7 +615,7 @@ namespace hit {
             // If the chi2 is infinite then there is a real problem so we bail
             if (!(chi2PerNDF < std::numeric_limits<double>::infinity())) continue;
 
-            fFirstChi2->Fill(chi2PerNDF);
+            hitsOnWire.firstChi2.push_back(chi2PerNDF);
 
             // ########################################################
             // ### Trying extra Exponentials for an initial bad fit ###
@@ -592,8 +641,6 @@ namespace hit {
                 PeakDevVec PeakDev;
                 FindPeakWithMaxDeviation(signal,
                                          nExponentialsForFit,
-                                         startT,
-                                         endT,
                                          fSameShape,
                                          paramVec,
                                          peakVals,
@@ -614,7 +661,8 @@ namespace hit {
                                   paramVecRefit,
                                   chi2PerNDF2,
                                   NDF2,
-                                  fSameShape);
+                                  fSameShape,
+                                  workspace);
 
                   if (chi2PerNDF2 < chi2PerNDF) {
                     paramVec = paramVecRefit;
@@ -644,7 +692,8 @@ namespace hit {
                                     paramVecRefit,
                                     chi2PerNDF2,
                                     NDF2,
-                                    fSameShape);
+                                    fSameShape,
+                                    workspace);
 
                     if (chi2PerNDF2 < chi2PerNDF) {
                       paramVec = paramVecRefit;
@@ -746,16 +795,8 @@ namespace hit {
               double peakAmpErr = 1.;
 
               //Determine peak position of fitted function (= peakMeanTrue)
-              TF1 Exponentials("Exponentials",
-                               "( [0] * exp(0.4*(x-[1])/[2]) / ( 1 + exp(0.4*(x-[1])/[3]) ) )",
-                               startT,
-                               endT);
-              Exponentials.SetParameter(0, peakAmp);
-              Exponentials.SetParameter(1, peakMean);
-              Exponentials.SetParameter(2, peakTau1);
-              Exponentials.SetParameter(3, peakTau2);
-              double peakMeanTrue = Exponentials.GetMaximumX(startT, endT);
-              Exponentials.Delete();
+              double peakMeanTrue =
+                MultiExpFitter::PulseMaximumX(peakMean, peakTau1, peakTau2, startT, endT);
 
               //Calculate width (=FWHM)
               double peakWidth =
@@ -877,16 +918,14 @@ namespace hit {
                 std::cout << "HitNDF: " << NDF << std::endl;
               }
 
-              const recob::Hit hit(hitcreator.move());
-
-              hcol.emplace_back(std::move(hit), wire, rawdigits);
+              hitsOnWire.hits.push_back(hitcreator.move());
               // add fit parameters associated to the hit just pushed to the collection
               std::array<float, 4> fitParams;
               fitParams[0] = peakMean + roiFirstBinTick;
               fitParams[1] = peakTau1;
               fitParams[2] = peakTau2;
               fitParams[3] = peakAmp;
-              fHitParamWriter.addVector(hitID, fitParams);
+              hitsOnWire.fitParams.push_back(fitParams);
               numHits++;
             } // <---End loop over Exponentials
               //            } // <---End if chi2 <= chi2Max
@@ -901,17 +940,19 @@ namespace hit {
           if (NumberOfPeaksBeforeFit > fMaxMultiHit || (width > fMaxGroupLength) ||
               NFluctuations > fMaxFluctuations) {
 
-            int nHitsInThisGroup = (endT - startT + 1) / fLongPulseWidth;
+            // the width is only widened for this group
+            int longPulseWidth = fLongPulseWidth;
+            int nHitsInThisGroup = (endT - startT + 1) / longPulseWidth;
 
             if (nHitsInThisGroup > fLongMaxHits) {
               nHitsInThisGroup = fLongMaxHits;
-              fLongPulseWidth = (endT - startT + 1) / nHitsInThisGroup;
+              longPulseWidth = (endT - startT + 1) / nHitsInThisGroup;
             }
 
-            if (nHitsInThisGroup * fLongPulseWidth < (endT - startT + 1)) nHitsInThisGroup++;
+            if (nHitsInThisGroup * longPulseWidth < (endT - startT + 1)) nHitsInThisGroup++;
 
             int firstTick = startT;
-            int lastTick = std::min(endT, firstTick + fLongPulseWidth - 1);
+            int lastTick = std::min(endT, firstTick + longPulseWidth - 1);
 
             if (fLogLevel >= 1) {
               if (NumberOfPeaksBeforeFit > fMaxMultiHit) {
@@ -951,8 +992,8 @@ namespace hit {
               std::cout << "---> Group goes from tick " << roiFirstBinTick + startT << " to "
                         << roiFirstBinTick + endT << ". Split group into ("
                         << roiFirstBinTick + endT << " - " << roiFirstBinTick + startT << ")/"
-                        << fLongPulseWidth << " = " << (endT - startT) << "/" << fLongPulseWidth
-                        << " = " << nHitsInThisGroup << " peaks (" << fLongPulseWidth
+                        << longPulseWidth << " = " << (endT - startT) << "/" << longPulseWidth
+                        << " = " << nHitsInThisGroup << " peaks (" << longPulseWidth
                         << " = LongPulseWidth), or maximum LongMaxHits = " << fLongMaxHits
                         << " peaks." << std::endl;
             }
@@ -1027,26 +1068,62 @@ namespace hit {
                 std::cout << "Hitchi2/ndf: " << chi2PerNDF << std::endl;
                 std::cout << "HitNDF: " << NDF << std::endl;
               }
-              const recob::Hit hit(hitcreator.move());
-              hcol.emplace_back(std::move(hit), wire, rawdigits);
+              hitsOnWire.hits.push_back(hitcreator.move());
 
               std::array<float, 4> fitParams;
               fitParams[0] = peakMean + roiFirstBinTick;
               fitParams[1] = peakTau1;
               fitParams[2] = peakTau2;
               fitParams[3] = peakAmp;
-              fHitParamWriter.addVector(hitID, fitParams);
+              hitsOnWire.fitParams.push_back(fitParams);
 
               // set for next loop
               firstTick = lastTick + 1;
-              lastTick = std::min(firstTick + fLongPulseWidth - 1, endT);
+              lastTick = std::min(firstTick + longPulseWidth - 1, endT);
 
             } //<---Hits in this group
           }   //<---End if #peaks > MaxMultiHit
-          fChi2->Fill(chi2PerNDF);
+          hitsOnWire.chi2.push_back(chi2PerNDF);
         } //<---End loop over merged candidate hits
       }   //<---End looping over ROI's
-    }     //<---End looping over all the wires
+    };    //<---End looping over all the wires
+
+    lar::StageTimer hitFindingTimer(fStageMonitor, fHitFindingStage);
+    hitFindingTimer.AddItems(wireVecHandle->size());
+
+    // The wires are independent. With debugging output they are processed in
+    // order, so that the printout of each wire stays in one piece
+    if (fLogLevel > 0) {
+      for (size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++)
+        findHitsOnWire(wireIter);
+    }
+    else {
+      tbb::parallel_for(size_t(0), wireVecHandle->size(), findHitsOnWire);
+    }
+
+    hitFindingTimer.Stop();
+    lar::StageTimer collectionTimer(fStageMonitor, fCollectionStage);
+    size_t nHits = 0;
+
+    // ##########################################################
+    // ### Collecting the hits in wire order, as found above  ###
+    // ##########################################################
+    for (size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++) {
+      art::Ptr<recob::Wire> wire(wireVecHandle, wireIter);
+      art::Ptr<raw::RawDigit> rawdigits = RawDigits.at(wireIter);
+      WireHits& hitsOnWire = wireHits[wireIter];
+
+      nHits += hitsOnWire.hits.size();
+      for (size_t hitIdx = 0; hitIdx < hitsOnWire.hits.size(); hitIdx++) {
+        hcol.emplace_back(std::move(hitsOnWire.hits[hitIdx]), wire, rawdigits);
+        fHitParamWriter.addVector(hitID, hitsOnWire.fitParams[hitIdx]);
+      }
+
+      for (double chi2PerNDF : hitsOnWire.firstChi2)
+        fFirstChi2->Fill(chi2PerNDF);
+      for (double chi2PerNDF : hitsOnWire.chi2)
+        fChi2->Fill(chi2PerNDF);
+    }
 
     //==================================================================================================
     // End of the event
@@ -1057,6 +1134,9 @@ namespace hit {
     // and put hit fit parameters together with metadata into the event
     fHitParamWriter.saveOutputs(evt);
 
+    collectionTimer.AddItems(nHits);
+    eventTimer.AddItems(nHits);
+
   } // End of produce()
 
   // --------------------------------------------------------------------------------------------
@@ -1138,9 +1218,9 @@ namespace hit {
   // Merging of nearby candidate peaks
   // --------------------------------------------------------------------------------------------
 
-  void hit::DPRawHitFinder::mergeCandidatePeaks(const std::vector<float> signalVec,
-                                                TimeValsVec timeValsVec,
-                                                MergedTimeWidVec& mergedVec)
+  void hit::DPRawHitFinder::mergeCandidatePeaks(const std::vector<float>& signalVec,
+                                                const TimeValsVec& timeValsVec,
+                                                MergedTimeWidVec& mergedVec) const
   {
     // ################################################################
     // ### Lets loop over the candidate pulses we found in this ROI ###
@@ -1152,7 +1232,7 @@ namespace hit {
       PeakTimeWidVec peakVals;
 
       // Setting the start, peak, and end time of the pulse
-      auto& timeVal = *timeValsVecItr++;
+      auto timeVal = *timeValsVecItr++;
       int startT = std::get<0>(timeVal);
       int maxT = std::get<1>(timeVal);
       int endT = std::get<2>(timeVal);
@@ -1265,10 +1345,10 @@ namespace hit {
   // ----------------------------------------------------------------------------------------------
   // Estimate fluctuations for a group of peaks to identify hits from particles in drift direction
   // ----------------------------------------------------------------------------------------------
-  int hit::DPRawHitFinder::EstimateFluctuations(const std::vector<float> fsignalVec,
+  int hit::DPRawHitFinder::EstimateFluctuations(const std::vector<float>& fsignalVec,
                                                 int peakStart,
                                                 int peakMean,
-                                                int peakEnd)
+                                                int peakEnd) const
   {
     int NFluctuations = 0;
 
@@ -1292,45 +1372,20 @@ namespace hit {
   // --------------------------------------------------------------------------------------------
   // Fit Exponentials
   // --------------------------------------------------------------------------------------------
-  void hit::DPRawHitFinder::FitExponentials(const std::vector<float> fSignalVector,
-                                            const PeakTimeWidVec fPeakVals,
+  void hit::DPRawHitFinder::FitExponentials(const std::vector<float>& fSignalVector,
+                                            const PeakTimeWidVec& fPeakVals,
                                             int fStartTime,
                                             int fEndTime,
                                             ParameterVec& fparamVec,
                                             double& fchi2PerNDF,
                                             int& fNDF,
-                                            bool fSameShape)
+                                            bool fSameShape,
+                                            FitWorkspace& workspace) const
   {
-    int size = fEndTime - fStartTime + 1;
     int NPeaks = fPeakVals.size();
 
-    // #############################################
-    // ### If size < 0 then set the size to zero ###
-    // #############################################
-    if (fEndTime - fStartTime < 0) { size = 0; }
-
-    // --- TH1D HitSignal ---
-    TH1F hitSignal("hitSignal", "", std::max(size, 1), fStartTime, fEndTime + 1);
-    hitSignal.Sumw2();
-
-    // #############################
-    // ### Filling the histogram ###
-    // #############################
-    for (int i = fStartTime; i < fEndTime + 1; i++) {
-      hitSignal.Fill(i, fSignalVector[i]);
-      hitSignal.SetBinError(i, 0.288675); //1/sqrt(12)
-    }
-
-    // ################################################
-    // ### Building TFormula for basic Exponentials ###
-    // ################################################
-    std::string eqn = CreateFitFunction(NPeaks, fSameShape);
-
-    // -------------------------------------
-    // --- TF1 function for Exponentials ---
-    // -------------------------------------
-
-    TF1 Exponentials("Exponentials", eqn.c_str(), fStartTime, fEndTime + 1);
+    MultiExpFitter::FitParams& params = workspace.params;
+    params.resize(NPeaks, fSameShape);
 
     if (fLogLevel >= 4) {
       std::cout << std::endl;
@@ -1338,199 +1393,102 @@ namespace hit {
       std::cout << "--- Lower limits, seed, upper limit:" << std::endl;
     }
 
-    if (fSameShape) {
-      Exponentials.SetParameter(0, 0.5);
-      Exponentials.SetParameter(1, 0.5);
-      Exponentials.SetParLimits(0, fMinTau, fMaxTau);
-      Exponentials.SetParLimits(1, fMinTau, fMaxTau);
-      double amplitude = 0;
-      double peakMean = 0;
-
-      double peakMeanShift = 2;
-      double peakMeanSeed = 0;
-      double peakMeanRangeLow = 0;
-      double peakMeanRangeHi = 0;
-      double peakStart = 0;
-      double peakEnd = 0;
-
-      for (int i = 0; i < NPeaks; i++) {
-        peakMean = std::get<0>(fPeakVals.at(i));
-        peakStart = std::get<2>(fPeakVals.at(i));
-        peakEnd = std::get<3>(fPeakVals.at(i));
-        peakMeanSeed = peakMean - peakMeanShift;
-        peakMeanRangeLow = std::max(peakStart - peakMeanShift, peakMeanSeed - fFitPeakMeanRange);
-        peakMeanRangeHi = std::min(peakEnd, peakMeanSeed + fFitPeakMeanRange);
-        amplitude = fSignalVector[peakMean];
-
-        Exponentials.SetParameter(2 * (i + 1), 1.65 * amplitude);
-        Exponentials.SetParLimits(2 * (i + 1), 0.3 * 1.65 * amplitude, 2 * 1.65 * amplitude);
-        Exponentials.SetParameter(2 * (i + 1) + 1, peakMeanSeed);
-
-        if (NPeaks == 1) {
-          Exponentials.SetParLimits(2 * (i + 1) + 1, peakMeanRangeLow, peakMeanRangeHi);
-        }
-        else if (NPeaks >= 2 && i == 0) {
-          double HalfDistanceToNextMean = 0.5 * (std::get<0>(fPeakVals.at(i + 1)) - peakMean);
-          Exponentials.SetParLimits(
-            2 * (i + 1) + 1,
-            peakMeanRangeLow,
-            std::min(peakMeanRangeHi, peakMeanSeed + HalfDistanceToNextMean));
-        }
-        else if (NPeaks >= 2 && i == NPeaks - 1) {
-          double HalfDistanceToPrevMean = 0.5 * (peakMean - std::get<0>(fPeakVals.at(i - 1)));
-          Exponentials.SetParLimits(
-            2 * (i + 1) + 1,
-            std::max(peakMeanRangeLow, peakMeanSeed - HalfDistanceToPrevMean),
-            peakMeanRangeHi);
-        }
-        else {
-          double HalfDistanceToNextMean = 0.5 * (std::get<0>(fPeakVals.at(i + 1)) - peakMean);
-          double HalfDistanceToPrevMean = 0.5 * (peakMean - std::get<0>(fPeakVals.at(i - 1)));
-          Exponentials.SetParLimits(
-            2 * (i + 1) + 1,
-            std::max(peakMeanRangeLow, peakMeanSeed - HalfDistanceToPrevMean),
-            std::min(peakMeanRangeHi, peakMeanSeed + HalfDistanceToNextMean));
-        }
+    double amplitude = 0;
+    double peakMean = 0;
+
+    double peakMeanShift = 2;
+    double peakMeanSeed = 0;
+    double peakMeanRangeLow = 0;
+    double peakMeanRangeHi = 0;
+    double peakStart = 0;
+    double peakEnd = 0;
+
+    for (int i = 0; i < NPeaks; i++) {
+      // with the same shape all peaks share (and set) the same time constants
+      for (size_t tauIdx : {MultiExpFitter::Tau1Index(i, fSameShape),
+                            MultiExpFitter::Tau2Index(i, fSameShape)}) {
+        params.value[tauIdx] = 0.5;
+        params.lower[tauIdx] = fMinTau;
+        params.upper[tauIdx] = fMaxTau;
+      }
 
-        if (fLogLevel >= 4) {
-          double t0low, t0high;
-          Exponentials.GetParLimits(2 * (i + 1) + 1, t0low, t0high);
-          std::cout << "Peak #" << i << ": A [ADC] = " << 0.3 * 1.65 * amplitude << "  ,  "
-                    << 1.65 * amplitude << "  ,  " << 2 * 1.65 * amplitude << std::endl;
-          std::cout << "Peak #" << i << ": t0 [ticks] = " << t0low << "  ,  " << peakMeanSeed
-                    << "  ,  " << t0high << std::endl;
-        }
+      peakMean = std::get<0>(fPeakVals.at(i));
+      peakStart = std::get<2>(fPeakVals.at(i));
+      peakEnd = std::get<3>(fPeakVals.at(i));
+      peakMeanSeed = peakMean - peakMeanShift;
+      peakMeanRangeLow = std::max(peakStart - peakMeanShift, peakMeanSeed - fFitPeakMeanRange);
+      peakMeanRangeHi = std::min(peakEnd, peakMeanSeed + fFitPeakMeanRange);
+      amplitude = fSignalVector[peakMean];
+
+      size_t const ampIdx = MultiExpFitter::AmplitudeIndex(i, fSameShape);
+      params.value[ampIdx] = 1.65 * amplitude;
+      params.lower[ampIdx] = 0.3 * 1.65 * amplitude;
+      params.upper[ampIdx] = 2 * 1.65 * amplitude;
+
+      // the mean may not move past half the distance to the neighbouring peaks
+      size_t const meanIdx = MultiExpFitter::PeakTimeIndex(i, fSameShape);
+      params.value[meanIdx] = peakMeanSeed;
+      params.lower[meanIdx] = peakMeanRangeLow;
+      params.upper[meanIdx] = peakMeanRangeHi;
+      if (i > 0) {
+        double HalfDistanceToPrevMean = 0.5 * (peakMean - std::get<0>(fPeakVals.at(i - 1)));
+        params.lower[meanIdx] =
+          std::max(peakMeanRangeLow, peakMeanSeed - HalfDistanceToPrevMean);
+      }
+      if (i < NPeaks - 1) {
+        double HalfDistanceToNextMean = 0.5 * (std::get<0>(fPeakVals.at(i + 1)) - peakMean);
+        params.upper[meanIdx] = std::min(peakMeanRangeHi, peakMeanSeed + HalfDistanceToNextMean);
       }
-    }
-    else {
-      double amplitude = 0;
-      double peakMean = 0;
-
-      double peakMeanShift = 2;
-      double peakMeanSeed = 0;
-      double peakMeanRangeLow = 0;
-      double peakMeanRangeHi = 0;
-      double peakStart = 0;
-      double peakEnd = 0;
-
-      for (int i = 0; i < NPeaks; i++) {
-        Exponentials.SetParameter(4 * i, 0.5);
-        Exponentials.SetParameter(4 * i + 1, 0.5);
-        Exponentials.SetParLimits(4 * i, fMinTau, fMaxTau);
-        Exponentials.SetParLimits(4 * i + 1, fMinTau, fMaxTau);
-
-        peakMean = std::get<0>(fPeakVals.at(i));
-        peakStart = std::get<2>(fPeakVals.at(i));
-        peakEnd = std::get<3>(fPeakVals.at(i));
-        peakMeanSeed = peakMean - peakMeanShift;
-        peakMeanRangeLow = std::max(peakStart - peakMeanShift, peakMeanSeed - fFitPeakMeanRange);
-        peakMeanRangeHi = std::min(peakEnd, peakMeanSeed + fFitPeakMeanRange);
-        amplitude = fSignalVector[peakMean];
-
-        Exponentials.SetParameter(4 * i + 2, 1.65 * amplitude);
-        Exponentials.SetParLimits(4 * i + 2, 0.3 * 1.65 * amplitude, 2 * 1.65 * amplitude);
-        Exponentials.SetParameter(4 * i + 3, peakMeanSeed);
-
-        if (NPeaks == 1) {
-          Exponentials.SetParLimits(4 * i + 3, peakMeanRangeLow, peakMeanRangeHi);
-        }
-        else if (NPeaks >= 2 && i == 0) {
-          double HalfDistanceToNextMean = 0.5 * (std::get<0>(fPeakVals.at(i + 1)) - peakMean);
-          Exponentials.SetParLimits(
-            4 * i + 3,
-            peakMeanRangeLow,
-            std::min(peakMeanRangeHi, peakMeanSeed + HalfDistanceToNextMean));
-        }
-        else if (NPeaks >= 2 && i == NPeaks - 1) {
-          double HalfDistanceToPrevMean = 0.5 * (peakMean - std::get<0>(fPeakVals.at(i - 1)));
-          Exponentials.SetParLimits(
-            4 * i + 3,
-            std::max(peakMeanRangeLow, peakMeanSeed - HalfDistanceToPrevMean),
-            peakMeanRangeHi);
-        }
-        else {
-          double HalfDistanceToNextMean = 0.5 * (std::get<0>(fPeakVals.at(i + 1)) - peakMean);
-          double HalfDistanceToPrevMean = 0.5 * (peakMean - std::get<0>(fPeakVals.at(i - 1)));
-          Exponentials.SetParLimits(
-            4 * i + 3,
-            std::max(peakMeanRangeLow, peakMeanSeed - HalfDistanceToPrevMean),
-            std::min(peakMeanRangeHi, peakMeanSeed + HalfDistanceToNextMean));
-        }
 
-        if (fLogLevel >= 4) {
-          double t0low, t0high;
-          Exponentials.GetParLimits(4 * i + 3, t0low, t0high);
-          std::cout << "Peak #" << i << ": A [ADC] = " << 0.3 * 1.65 * amplitude << "  ,  "
-                    << 1.65 * amplitude << "  ,  " << 2 * 1.65 * amplitude << std::endl;
-          std::cout << "Peak #" << i << ": t0 [ticks] = " << t0low << "  ,  " << peakMeanSeed
-                    << "  ,  " << t0high << std::endl;
-        }
+      if (fLogLevel >= 4) {
+        std::cout << "Peak #" << i << ": A [ADC] = " << 0.3 * 1.65 * amplitude << "  ,  "
+                  << 1.65 * amplitude << "  ,  " << 2 * 1.65 * amplitude << std::endl;
+        std::cout << "Peak #" << i << ": t0 [ticks] = " << params.lower[meanIdx] << "  ,  "
+                  << peakMeanSeed << "  ,  " << params.upper[meanIdx] << std::endl;
       }
     }
 
     // ###########################################
     // ### PERFORMING THE TOTAL FIT OF THE HIT ###
     // ###########################################
-    try {
-      hitSignal.Fit(&Exponentials, "QNRWM", "", fStartTime, fEndTime + 1);
-    }
-    catch (...) {
-      mf::LogWarning("DPRawHitFinder") << "Fitter failed finding a hit";
-    }
+    bool const fitSuccess =
+      fFitter.Fit(fSignalVector.data(), fStartTime, fEndTime, params, workspace.fit);
+
+    if (!fitSuccess && fLogLevel >= 4) std::cout << "--- Fit failed ---" << std::endl;
 
     // ##################################################
     // ### Getting the fitted parameters from the fit ###
     // ##################################################
-    fchi2PerNDF = (Exponentials.GetChisquare() / Exponentials.GetNDF());
-    fNDF = Exponentials.GetNDF();
-
-    if (fSameShape) {
-      fparamVec.emplace_back(Exponentials.GetParameter(0), Exponentials.GetParError(0));
-      fparamVec.emplace_back(Exponentials.GetParameter(1), Exponentials.GetParError(1));
-
-      for (int i = 0; i < NPeaks; i++) {
-        fparamVec.emplace_back(Exponentials.GetParameter(2 * (i + 1)),
-                               Exponentials.GetParError(2 * (i + 1)));
-        fparamVec.emplace_back(Exponentials.GetParameter(2 * (i + 1) + 1),
-                               Exponentials.GetParError(2 * (i + 1) + 1));
-      }
-    }
-    else {
-      for (int i = 0; i < NPeaks; i++) {
-        fparamVec.emplace_back(Exponentials.GetParameter(4 * i), Exponentials.GetParError(4 * i));
-        fparamVec.emplace_back(Exponentials.GetParameter(4 * i + 1),
-                               Exponentials.GetParError(4 * i + 1));
-        fparamVec.emplace_back(Exponentials.GetParameter(4 * i + 2),
-                               Exponentials.GetParError(4 * i + 2));
-        fparamVec.emplace_back(Exponentials.GetParameter(4 * i + 3),
-                               Exponentials.GetParError(4 * i + 3));
-      }
-    }
-    Exponentials.Delete();
-    hitSignal.Delete();
+    // a failed fit has an infinite chi2, which makes the caller drop it
+    fchi2PerNDF =
+      fitSuccess ? params.chi2 / params.ndf : std::numeric_limits<double>::infinity();
+    fNDF = fitSuccess ? params.ndf : 0;
+
+    // the fitter layout is the one of the parameter vector
+    for (size_t parIdx = 0; parIdx < MultiExpFitter::NParams(NPeaks, fSameShape); parIdx++)
+      fparamVec.emplace_back(params.value[parIdx], params.error[parIdx]);
   } //<----End FitExponentials
 
   //---------------------------------------------------------------------------------------------
-  void hit::DPRawHitFinder::FindPeakWithMaxDeviation(const std::vector<float> fSignalVector,
+  void hit::DPRawHitFinder::FindPeakWithMaxDeviation(const std::vector<float>& fSignalVector,
                                                      int fNPeaks,
-                                                     int fStartTime,
-                                                     int fEndTime,
                                                      bool fSameShape,
-                                                     ParameterVec fparamVec,
-                                                     PeakTimeWidVec fpeakVals,
-                                                     PeakDevVec& fPeakDev)
+                                                     const ParameterVec& fparamVec,
+                                                     const PeakTimeWidVec& fpeakVals,
+                                                     PeakDevVec& fPeakDev) const
   {
-    //   int size = fEndTime - fStartTime + 1;
-    //    if(fEndTime - fStartTime < 0){size = 0;}
-
-    std::string eqn =
-      CreateFitFunction(fNPeaks, fSameShape); // string for equation of Exponentials fit
-
-    TF1 Exponentials("Exponentials", eqn.c_str(), fStartTime, fEndTime + 1);
-
-    for (size_t i = 0; i < fparamVec.size(); i++) {
-      Exponentials.SetParameter(i, fparamVec[i].first);
-    }
+    // sum of the fitted exponentials
+    auto Exponentials = [&](double x) {
+      double value = 0.;
+      for (int i = 0; i < fNPeaks; i++) {
+        double const amplitude = fparamVec[MultiExpFitter::AmplitudeIndex(i, fSameShape)].first;
+        double const mean = fparamVec[MultiExpFitter::PeakTimeIndex(i, fSameShape)].first;
+        double const tau1 = fparamVec[MultiExpFitter::Tau1Index(i, fSameShape)].first;
+        double const tau2 = fparamVec[MultiExpFitter::Tau2Index(i, fSameShape)].first;
+        value += MultiExpFitter::Pulse(x, amplitude, mean, tau1, tau2);
+      }
+      return value;
+    };
 
     // ##########################################################################
     // ### Finding the peak with the max chi2 fit and signal ###
@@ -1548,18 +1506,16 @@ namespace hit {
       BinMaxNegDeviation = 0;
 
       for (int j = std::get<2>(fpeakVals.at(i)); j < std::get<3>(fpeakVals.at(i)) + 1; j++) {
-        if ((Exponentials(j + 0.5) - fSignalVector[j]) > MaxPosDeviation &&
-            j != std::get<0>(fpeakVals.at(i))) {
-          MaxPosDeviation = Exponentials(j + 0.5) - fSignalVector[j];
+        double const Deviation = Exponentials(j + 0.5) - fSignalVector[j];
+        if (Deviation > MaxPosDeviation && j != std::get<0>(fpeakVals.at(i))) {
+          MaxPosDeviation = Deviation;
           BinMaxPosDeviation = j;
         }
-        if ((Exponentials(j + 0.5) - fSignalVector[j]) < MaxNegDeviation &&
-            j != std::get<0>(fpeakVals.at(i))) {
-          MaxNegDeviation = Exponentials(j + 0.5) - fSignalVector[j];
+        if (Deviation < MaxNegDeviation && j != std::get<0>(fpeakVals.at(i))) {
+          MaxNegDeviation = Deviation;
           BinMaxNegDeviation = j;
         }
-        Chi2PerNDFPeak +=
-          pow((Exponentials(j + 0.5) - fSignalVector[j]) / sqrt(fSignalVector[j]), 2);
+        Chi2PerNDFPeak += pow(Deviation / sqrt(fSignalVector[j]), 2);
       }
 
       if (BinMaxNegDeviation != 0) {
@@ -1575,71 +1531,11 @@ namespace hit {
       [](std::tuple<double, int, int, int> const& t1, std::tuple<double, int, int, int> const& t2) {
         return std::get<0>(t1) > std::get<0>(t2);
       });
-    Exponentials.Delete();
-  }
-
-  //---------------------------------------------------------------------------------------------
-  std::string hit::DPRawHitFinder::CreateFitFunction(int fNPeaks, bool fSameShape)
-  {
-    std::string feqn = ""; // string holding fit formula
-    std::stringstream numConv;
-
-    if (fSameShape) {
-      for (int i = 0; i < fNPeaks; i++) {
-        feqn.append("+( [");
-        numConv.str("");
-        numConv << 2 * (i + 1);
-        feqn.append(numConv.str());
-        feqn.append("] * exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2 * (i + 1) + 1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 0;
-        feqn.append(numConv.str());
-        feqn.append("]) / ( 1 + exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2 * (i + 1) + 1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 1;
-        feqn.append(numConv.str());
-        feqn.append("]) ) )");
-      }
-    }
-    else {
-      for (int i = 0; i < fNPeaks; i++) {
-        feqn.append("+( [");
-        numConv.str("");
-        numConv << 4 * i + 2;
-        feqn.append(numConv.str());
-        feqn.append("] * exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 4 * i + 3;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 4 * i;
-        feqn.append(numConv.str());
-        feqn.append("]) / ( 1 + exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2 * (i + 1) + 1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 4 * i + 1;
-        feqn.append(numConv.str());
-        feqn.append("]) ) )");
-      }
-    }
-    return feqn;
   }
 
   //---------------------------------------------------------------------------------------------
   void hit::DPRawHitFinder::AddPeak(std::tuple<double, int, int, int> fPeakDevCand,
-                                    PeakTimeWidVec& fpeakValsTemp)
+                                    PeakTimeWidVec& fpeakValsTemp) const
   {
     int PeakNumberWithNewPeak = std::get<1>(fPeakDevCand);
     int NewPeakMax = std::get<2>(fPeakDevCand);
@@ -1688,7 +1584,7 @@ namespace hit {
 
   //---------------------------------------------------------------------------------------------
   void hit::DPRawHitFinder::SplitPeak(std::tuple<double, int, int, int> fPeakDevCand,
-                                      PeakTimeWidVec& fpeakValsTemp)
+                                      PeakTimeWidVec& fpeakValsTemp) const
   {
     int PeakNumberWithNewPeak = std::get<1>(fPeakDevCand);
     int OldPeakOldStart = std::get<2>(fpeakValsTemp.at(PeakNumberWithNewPeak));
@@ -1736,7 +1632,7 @@ namespace hit {
                                         double fPeakTau2,
                                         double fStartTime,
                                         double fEndTime,
-                                        double fPeakMeanTrue)
+                                        double fPeakMeanTrue) const
   {
     double MaxValue = (fPeakAmp * exp(0.4 * (fPeakMeanTrue - fPeakMean) / fPeakTau1)) /
                       (1 + exp(0.4 * (fPeakMeanTrue - fPeakMean) / fPeakTau2));
@@ -1811,8 +1707,7 @@ namespace hit {
                                          double fPeakTau1,
                                          double fPeakTau2,
                                          double fChargeNormFactor,
-                                         double fPeakMeanTrue)
-
+                                         double fPeakMeanTrue) const
   {
     double ChargeSum = 0.;
     double Charge = 0.;
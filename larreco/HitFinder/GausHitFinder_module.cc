@@ -26,6 +26,7 @@
 #include <algorithm> // std::accumulate()
 #include <atomic>
 #include <memory> // std::unique_ptr()
+#include <numeric> // std::iota()
 #include <string>
 #include <utility> // std::move()
 
@@ -34,11 +35,11 @@
 #include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
-#include "art/Utilities/Globals.h"
 #include "art/Utilities/make_tool.h"
 #include "art_root_io/TFileService.h"
 #include "canvas/Persistency/Common/FindOneP.h"
 #include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 // LArSoft Includes
 #include "larcore/Geometry/Geometry.h"
@@ -50,6 +51,8 @@
 
 #include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
 #include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/HitFinder/HitFinderTools/WorkspaceHistograms.h"
+#include "larreco/Monitoring/StageMonitorService.h"
 
 // ROOT Includes
 #include "TH1F.h"
@@ -57,6 +60,7 @@
 
 #include "tbb/concurrent_vector.h"
 #include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
 
 namespace hit {
   class GausHitFinder : public art::SharedProducer {
@@ -66,11 +70,22 @@ namespace hit {
   private:
     void produce(art::Event& evt, art::ProcessingFrame const&) override;
     void beginJob(art::ProcessingFrame const&) override;
+    void endJob(art::ProcessingFrame const&) override;
 
     std::vector<double> FillOutHitParameterVector(const std::vector<double>& input);
 
+    /// Workspaces of the tools and histogram copies used by a single thread
+    struct ThreadWorkspace {
+      std::vector<reco_tool::ICandidateHitFinder::WorkspacePtr> hitFinderWorkspaces; ///< by plane
+      reco_tool::IPeakFitter::WorkspacePtr peakFitterWorkspace;
+      reco_tool::WorkspaceHistograms chi2Hists; ///< copies of fFirstChi2 and fChi2
+    };
+
+    ThreadWorkspace makeThreadWorkspace() const;
+
     const bool fFilterHits;
     const bool fFillHists;
+    const bool fDeterministicHitOrder; ///< Emit hits in (channel, ROI, peak time) order
 
     const std::string fCalDataModuleLabel;
     const std::string fAllHitsInstanceName;
@@ -90,15 +105,27 @@ namespace hit {
 
     std::atomic<size_t> fEventCount{0};
 
-    //only Standard and Morphological implementation is threadsafe.
+    // Time spent in each phase, if the StageMonitorService is configured
+    lar::StageMonitor* fStageMonitor;
+    lar::StageMonitor::StageID fEventStage{0};
+    lar::StageMonitor::StageID fCandidateFindingStage{0};
+    lar::StageMonitor::StageID fPeakFittingStage{0};
+    lar::StageMonitor::StageID fStitchingStage{0};
+
+    // the tools keep all their mutable state in the per-thread workspaces below
     std::vector<std::unique_ptr<reco_tool::ICandidateHitFinder>>
       fHitFinderToolVec; ///< For finding candidate hits
-    // only Marqdt implementation is threadsafe.
     std::unique_ptr<reco_tool::IPeakFitter> fPeakFitterTool; ///< Perform fit to candidate peaks
     //HitFilterAlg implementation is threadsafe.
     std::unique_ptr<HitFilterAlg> fHitFilterAlg; ///< algorithm used to filter out noise hits
 
-    //only used when fFillHists is true and in single threaded mode.
+    /// One per thread of the task arena, indexed by the thread index. They own
+    /// ROOT objects, so they are all made at beginJob, flushed after each event
+    /// and merged at endJob. The tools do not spawn tasks, so a thread never
+    /// reenters its workspace while using it.
+    std::vector<ThreadWorkspace> fThreadWorkspaces;
+
+    //only used when fFillHists is true, filled through the per-thread copies.
     TH1F* fFirstChi2;
     TH1F* fChi2;
 
@@ -110,6 +137,7 @@ namespace hit {
     : SharedProducer{pset}
     , fFilterHits(pset.get<bool>("FilterHits", false))
     , fFillHists(pset.get<bool>("FillHists", false))
+    , fDeterministicHitOrder(pset.get<bool>("DeterministicHitOrder", false))
     , fCalDataModuleLabel(pset.get<std::string>("CalDataModuleLabel"))
     , fAllHitsInstanceName(pset.get<std::string>("AllHitsInstanceName", ""))
     , fLongMaxHitsVec(pset.get<std::vector<int>>("LongMaxHits", std::vector<int>() = {25, 25, 25}))
@@ -125,13 +153,16 @@ namespace hit {
         pset.get<std::vector<float>>("PulseWidthCuts", std::vector<float>() = {2.0, 1.5, 1.0}))
     , fPulseRatioCuts(
         pset.get<std::vector<float>>("PulseRatioCuts", std::vector<float>() = {0.35, 0.40, 0.20}))
+    , fStageMonitor(lar::stageMonitorIfConfigured())
   {
-    if (fFillHists && art::Globals::instance()->nthreads() > 1u) {
-      throw art::Exception(art::errors::Configuration)
-        << "Cannot fill histograms when multiple threads configured, please set fFillHists to "
-           "false or change number of threads to 1\n";
+    if (fStageMonitor) {
+      const std::string label = pset.get<std::string>("module_label");
+      fEventStage = fStageMonitor->Stage(label);
+      fCandidateFindingStage = fStageMonitor->Stage(label + "/CandidateFinding");
+      fPeakFittingStage = fStageMonitor->Stage(label + "/PeakFitting");
+      fStitchingStage = fStageMonitor->Stage(label + "/Stitching");
     }
-    async<art::InEvent>();
+
     if (fFilterHits) {
       fHitFilterAlg = std::make_unique<HitFilterAlg>(pset.get<fhicl::ParameterSet>("HitFilterAlg"));
     }
@@ -155,6 +186,20 @@ namespace hit {
     fPeakFitterTool =
       art::make_tool<reco_tool::IPeakFitter>(pset.get<fhicl::ParameterSet>("PeakFitter"));
 
+    // The per-ROI output of the tools is written to TFileService after each event. Its
+    // directories (and gDirectory) are shared by all its users, so in that case the events
+    // are processed one at a time with respect to every module using TFileService; the
+    // workspaces still let the ROIs of each event be processed in parallel.
+    bool const writesEventOutput =
+      std::any_of(fHitFinderToolVec.begin(), fHitFinderToolVec.end(), [](const auto& tool) {
+        return tool && tool->writesEventOutput();
+      });
+
+    if (writesEventOutput)
+      serialize<art::InEvent>(art::TFileService::resource_name());
+    else
+      async<art::InEvent>();
+
     // let HitCollectionCreator declare that we are going to produce
     // hits and associations with wires and raw digits
     // We want the option to output two hit collections, one filtered
@@ -194,6 +239,22 @@ namespace hit {
     return output;
   }
 
+  //-------------------------------------------------
+  //-------------------------------------------------
+  GausHitFinder::ThreadWorkspace GausHitFinder::makeThreadWorkspace() const
+  {
+    ThreadWorkspace workspace;
+
+    for (const auto& hitFinderTool : fHitFinderToolVec)
+      workspace.hitFinderWorkspaces.push_back(hitFinderTool->makeWorkspace());
+
+    workspace.peakFitterWorkspace = fPeakFitterTool->makeWorkspace();
+
+    if (fFillHists) workspace.chi2Hists = reco_tool::WorkspaceHistograms({fFirstChi2, fChi2});
+
+    return workspace;
+  }
+
   //-------------------------------------------------
   //-------------------------------------------------
   void GausHitFinder::beginJob(art::ProcessingFrame const&)
@@ -207,6 +268,29 @@ namespace hit {
       fFirstChi2 = tfs->make<TH1F>("fFirstChi2", "#chi^{2}", 10000, 0, 5000);
       fChi2 = tfs->make<TH1F>("fChi2", "#chi^{2}", 10000, 0, 5000);
     }
+
+    // Make the workspaces of all the threads up front, as they create ROOT objects
+    TH1::AddDirectory(kFALSE);
+
+    int const nThreads = tbb::this_task_arena::max_concurrency();
+    fThreadWorkspaces.reserve(nThreads);
+    for (int thread = 0; thread < nThreads; thread++)
+      fThreadWorkspaces.push_back(makeThreadWorkspace());
+  }
+
+  //-------------------------------------------------
+  //-------------------------------------------------
+  void GausHitFinder::endJob(art::ProcessingFrame const&)
+  {
+    // Collect the diagnostics from all the threads
+    for (auto& workspace : fThreadWorkspaces) {
+      for (size_t planeIdx = 0; planeIdx < fHitFinderToolVec.size(); planeIdx++)
+        fHitFinderToolVec[planeIdx]->mergeWorkspace(*workspace.hitFinderWorkspaces[planeIdx]);
+
+      fPeakFitterTool->mergeWorkspace(*workspace.peakFitterWorkspace);
+
+      if (fFillHists) workspace.chi2Hists.mergeInto({fFirstChi2, fChi2});
+    }
   }
 
   //  This algorithm uses the fact that deconvolved signals are very smooth
@@ -216,6 +300,7 @@ namespace hit {
   void GausHitFinder::produce(art::Event& evt, art::ProcessingFrame const&)
   {
     unsigned int count = fEventCount.fetch_add(1);
+    lar::StageTimer eventTimer(fStageMonitor, fEventStage);
     //==================================================================================================
 
     TH1::AddDirectory(kFALSE);
@@ -251,6 +336,13 @@ namespace hit {
     tbb::concurrent_vector<hitstruct> hitstruct_vec;
     tbb::concurrent_vector<hitstruct> filthitstruct_vec;
 
+    // In deterministic mode each ROI owns an output slot, written only by the
+    // task processing it, and the slots are stitched in order at the end
+    struct roihits {
+      std::vector<hitstruct> all;
+      std::vector<hitstruct> filtered;
+    };
+
     //    if (fAllHitsInstanceName != "") filteredHitCol = &hcol;
 
     // ##########################################
@@ -259,6 +351,9 @@ namespace hit {
     art::Handle<std::vector<recob::Wire>> wireVecHandle;
     evt.getByLabel(fCalDataModuleLabel, wireVecHandle);
 
+    std::vector<std::vector<roihits>> wireSlots;
+    if (fDeterministicHitOrder) wireSlots.resize(wireVecHandle->size());
+
     //#################################################
     //###    Set the charge determination method    ###
     //### Default is to compute the normalized area ###
@@ -315,6 +410,8 @@ namespace hit {
         // #################################################
         const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
 
+        if (fDeterministicHitOrder) wireSlots[wireIter].resize(signalROI.n_ranges());
+
         // for (const auto& range : signalROI.get_ranges()) {
         tbb::parallel_for(
           static_cast<std::size_t>(0),
@@ -328,14 +425,27 @@ namespace hit {
             // ### Scan the waveform and find candidate peaks + merge  ###
             // ###########################################################
 
+            lar::StageTimer candidateTimer(fStageMonitor, fCandidateFindingStage);
+
+            ThreadWorkspace& workspace =
+              fThreadWorkspaces.at(tbb::this_task_arena::current_thread_index());
+
             reco_tool::ICandidateHitFinder::HitCandidateVec hitCandidateVec;
             reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
 
             fHitFinderToolVec.at(plane)->findHitCandidates(
-              range, 0, channel, count, hitCandidateVec);
+              *workspace.hitFinderWorkspaces.at(plane), range, 0, channel, count, hitCandidateVec);
             fHitFinderToolVec.at(plane)->MergeHitCandidates(
               range, hitCandidateVec, mergedCandidateHitVec);
 
+            candidateTimer.AddItems(mergedCandidateHitVec.size());
+            candidateTimer.Stop();
+
+            lar::StageTimer fittingTimer(fStageMonitor, fPeakFittingStage);
+
+            // hits from this ROI, handed over to the output as a block at the end
+            roihits roiHits;
+
             // #######################################################
             // ### Lets loop over the pulses we found on this wire ###
             // #######################################################
@@ -370,8 +480,12 @@ namespace hit {
               // ### If # requested Gaussians is too large then punt ###
               // #######################################################
               if (mergedCands.size() <= fMaxMultiHit) {
-                fPeakFitterTool->findPeakParameters(
-                  range.data(), mergedCands, peakParamsVec, chi2PerNDF, NDF);
+                fPeakFitterTool->findPeakParameters(*workspace.peakFitterWorkspace,
+                                                    range.data(),
+                                                    mergedCands,
+                                                    peakParamsVec,
+                                                    chi2PerNDF,
+                                                    NDF);
 
                 // If the chi2 is infinite then there is a real problem so we bail
                 if (!(chi2PerNDF < std::numeric_limits<double>::infinity())) {
@@ -379,7 +493,7 @@ namespace hit {
                   NDF = 2;
                 }
 
-                if (fFillHists) fFirstChi2->Fill(chi2PerNDF);
+                if (fFillHists) workspace.chi2Hists[0].Fill(chi2PerNDF);
               }
 
               // #######################################################
@@ -499,8 +613,7 @@ namespace hit {
                 const recob::Hit hit(hitcreator.move());
 
                 // This loop will store ALL hits
-                hitstruct tmp{std::move(hit), wire};
-                hitstruct_vec.push_back(std::move(tmp));
+                roiHits.all.push_back(hitstruct{std::move(hit), wire});
 
                 numHits++;
               } // <---End loop over gaussians
@@ -557,25 +670,84 @@ namespace hit {
                 // Copy the hits we want to keep to the filtered hit collection
                 for (const auto& filteredHit : filteredHitVec)
                   if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit)) {
-                    hitstruct tmp{std::move(filteredHit), wire};
-                    filthitstruct_vec.push_back(std::move(tmp));
+                    roiHits.filtered.push_back(hitstruct{std::move(filteredHit), wire});
                   }
 
-                if (fFillHists) fChi2->Fill(chi2PerNDF);
+                if (fFillHists) workspace.chi2Hists[1].Fill(chi2PerNDF);
               }
             } //<---End loop over merged candidate hits
+
+            fittingTimer.AddItems(roiHits.all.size());
+
+            if (fDeterministicHitOrder) {
+              // canonical order within the ROI is by peak time
+              auto byPeakTime = [](const hitstruct& left, const hitstruct& right) {
+                return left.hit_tbb.PeakTime() < right.hit_tbb.PeakTime();
+              };
+              std::stable_sort(roiHits.all.begin(), roiHits.all.end(), byPeakTime);
+              std::stable_sort(roiHits.filtered.begin(), roiHits.filtered.end(), byPeakTime);
+
+              wireSlots[wireIter][rangeIter] = std::move(roiHits);
+            }
+            else {
+              std::move(roiHits.all.begin(),
+                        roiHits.all.end(),
+                        hitstruct_vec.grow_by(roiHits.all.size()));
+              std::move(roiHits.filtered.begin(),
+                        roiHits.filtered.end(),
+                        filthitstruct_vec.grow_by(roiHits.filtered.size()));
+            }
           }   //<---End looping over ROI's
         );    //end tbb parallel for
       }       //<---End looping over all the wires
     );        //end tbb parallel for
 
-    for (size_t i = 0; i < hitstruct_vec.size(); i++) {
-      allHitCol.emplace_back(hitstruct_vec[i].hit_tbb, hitstruct_vec[i].wire_tbb);
+    // Write out the per-ROI output of the tools, so that it does not pile up until endJob
+    for (auto& workspace : fThreadWorkspaces) {
+      for (size_t planeIdx = 0; planeIdx < fHitFinderToolVec.size(); planeIdx++)
+        fHitFinderToolVec[planeIdx]->flushWorkspace(*workspace.hitFinderWorkspaces[planeIdx]);
     }
 
-    for (size_t j = 0; j < filthitstruct_vec.size(); j++) {
-      filteredHitCol->emplace_back(filthitstruct_vec[j].hit_tbb, filthitstruct_vec[j].wire_tbb);
+    lar::StageTimer stitchTimer(fStageMonitor, fStitchingStage);
+    size_t nHits = 0;
+
+    if (fDeterministicHitOrder) {
+      // Stitch the per-ROI slots together in channel order; the wires are
+      // usually already sorted by channel, but do not rely on it
+      std::vector<size_t> wireOrder(wireVecHandle->size());
+      std::iota(wireOrder.begin(), wireOrder.end(), 0);
+      std::stable_sort(
+        wireOrder.begin(), wireOrder.end(), [&wireVecHandle](size_t left, size_t right) {
+          return (*wireVecHandle)[left].Channel() < (*wireVecHandle)[right].Channel();
+        });
+
+      for (size_t wireIter : wireOrder) {
+        for (const auto& roiHits : wireSlots[wireIter]) {
+          nHits += roiHits.all.size();
+          for (const auto& hitStruct : roiHits.all)
+            allHitCol.emplace_back(hitStruct.hit_tbb, hitStruct.wire_tbb);
+
+          if (filteredHitCol) {
+            for (const auto& hitStruct : roiHits.filtered)
+              filteredHitCol->emplace_back(hitStruct.hit_tbb, hitStruct.wire_tbb);
+          }
+        }
+      }
     }
+    else {
+      nHits = hitstruct_vec.size();
+      for (size_t i = 0; i < hitstruct_vec.size(); i++) {
+        allHitCol.emplace_back(hitstruct_vec[i].hit_tbb, hitstruct_vec[i].wire_tbb);
+      }
+
+      for (size_t j = 0; j < filthitstruct_vec.size(); j++) {
+        filteredHitCol->emplace_back(filthitstruct_vec[j].hit_tbb, filthitstruct_vec[j].wire_tbb);
+      }
+    }
+
+    stitchTimer.AddItems(nHits);
+    stitchTimer.Stop();
+    eventTimer.AddItems(nHits);
 
     //==================================================================================================
     // End of the event -- move the hit collection and the associations into the event
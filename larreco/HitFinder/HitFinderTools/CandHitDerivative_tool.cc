@@ -1,12 +1,13 @@
 ////////////////////////////////////////////////////////////////////////
 /// \file   CandHitDerivative.cc
 /// \author T. Usher
-//note for MT: this implementation is not thread-safe
+//note for MT: all per-call state, including diagnostics, lives in the workspace
 ////////////////////////////////////////////////////////////////////////
 
 #include "larcore/CoreUtils/ServiceUtil.h"
 #include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
 #include "larreco/HitFinder/HitFinderTools/IWaveformTool.h"
+#include "larreco/HitFinder/HitFinderTools/WorkspaceHistograms.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art/Utilities/ToolMacros.h"
@@ -18,6 +19,7 @@
 #include "TProfile.h"
 
 #include <cmath>
+#include <mutex>
 
 namespace reco_tool {
 
@@ -25,7 +27,10 @@ namespace reco_tool {
   public:
     explicit CandHitDerivative(const fhicl::ParameterSet& pset);
 
-    void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
+    WorkspacePtr makeWorkspace() const override;
+
+    void findHitCandidates(Workspace&,
+                           const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            const size_t,
                            const size_t,
                            const size_t,
@@ -35,7 +40,19 @@ namespace reco_tool {
                             const HitCandidateVec&,
                             MergeHitCandidateVec&) const override;
 
+    void flushWorkspace(Workspace&) const override;
+
+    bool writesEventOutput() const override { return fOutputHistograms; }
+
+    void mergeWorkspace(Workspace&) const override;
+
   private:
+    // Per-thread copies of the diagnostic histograms
+    struct DerivativeWorkspace : Workspace {
+      WorkspaceHistograms summaryHists;
+      WorkspaceProfiles waveformHists;
+    };
+
     // Internal functions
     void findHitCandidates(Waveform::const_iterator,
                            Waveform::const_iterator,
@@ -66,12 +83,11 @@ namespace reco_tool {
 
     art::TFileDirectory* fHistDirectory;
 
-    // Global histograms
-    TH1F* fDStopStartHist;
-    TH1F* fDMaxTickMinTickHist;
-    TH1F* fDMaxDerivMinDerivHist;
+    // Global histograms, filled through the workspace copies
+    enum SummaryHist { kDStopStart, kDMaxTickMinTick, kDMaxDerivMinDeriv };
+    std::vector<TH1*> fSummaryHists;
 
-    mutable std::map<size_t, int> fChannelCntMap;
+    mutable std::mutex fMergeMutex; ///< Serializes writing workspace output to file
 
     // Member variables from the fhicl file
     std::unique_ptr<reco_tool::IWaveformTool> fWaveformTool;
@@ -106,18 +122,47 @@ namespace reco_tool {
       // Make a directory for these histograms
       art::TFileDirectory dir = fHistDirectory->mkdir(Form("HitPlane_%1zu", fPlane));
 
-      fDStopStartHist =
-        dir.make<TH1F>(Form("DStopStart_%1zu", fPlane), ";Delta Stop/Start;", 200, 0., 200.);
-      fDMaxTickMinTickHist =
-        dir.make<TH1F>(Form("DMaxTMinT_%1zu", fPlane), ";Delta Max/Min Tick;", 200, 0., 200.);
-      fDMaxDerivMinDerivHist =
-        dir.make<TH1F>(Form("DMaxDMinD_%1zu", fPlane), ";Delta Max/Min Deriv;", 200, 0., 200.);
+      fSummaryHists = {
+        dir.make<TH1F>(Form("DStopStart_%1zu", fPlane), ";Delta Stop/Start;", 200, 0., 200.),
+        dir.make<TH1F>(Form("DMaxTMinT_%1zu", fPlane), ";Delta Max/Min Tick;", 200, 0., 200.),
+        dir.make<TH1F>(Form("DMaxDMinD_%1zu", fPlane), ";Delta Max/Min Deriv;", 200, 0., 200.)};
     }
 
     return;
   }
 
+  ICandidateHitFinder::WorkspacePtr CandHitDerivative::makeWorkspace() const
+  {
+    auto workspace = std::make_unique<DerivativeWorkspace>();
+
+    if (fOutputHistograms) workspace->summaryHists = WorkspaceHistograms(fSummaryHists);
+
+    return workspace;
+  }
+
+  void CandHitDerivative::mergeWorkspace(Workspace& workspace) const
+  {
+    if (!fOutputHistograms) return;
+
+    auto& derivWorkspace = static_cast<DerivativeWorkspace&>(workspace);
+
+    std::lock_guard<std::mutex> lock(fMergeMutex);
+
+    derivWorkspace.summaryHists.mergeInto(fSummaryHists);
+    derivWorkspace.waveformHists.writeTo(*fHistDirectory);
+  }
+
+  void CandHitDerivative::flushWorkspace(Workspace& workspace) const
+  {
+    if (!fOutputHistograms) return;
+
+    std::lock_guard<std::mutex> lock(fMergeMutex);
+
+    static_cast<DerivativeWorkspace&>(workspace).waveformHists.writeTo(*fHistDirectory);
+  }
+
   void CandHitDerivative::findHitCandidates(
+    Workspace& workspace,
     const recob::Wire::RegionsOfInterest_t::datarange_t& dataRange,
     const size_t roiStartTick,
     const size_t channel,
@@ -175,42 +220,55 @@ namespace reco_tool {
       //        size_t                   tpc   = wids[0].TPC;
       //        size_t                   wire  = wids[0].Wire;
 
-      size_t channelCnt = fChannelCntMap[channel]++;
+      auto& derivWorkspace = static_cast<DerivativeWorkspace&>(workspace);
 
-      // Make a directory for these histograms
-      art::TFileDirectory dir = fHistDirectory->mkdir(
-        Form("HitPlane_%1zu/ev%04zu/c%1zut%1zuwire_%05zu", plane, eventCount, cryo, tpc, wire));
+      // The ROI start tick identifies this waveform whichever thread handles it
+      size_t roiStart = dataRange.begin_index();
+
+      // Directory for these histograms, created when the workspace is flushed
+      std::string dir =
+        Form("HitPlane_%1zu/ev%04zu/c%1zut%1zuwire_%05zu", plane, eventCount, cryo, tpc, wire);
 
       size_t waveformSize = waveform.size();
       int waveStart = roiStartTick;
       int waveStop = waveStart + waveformSize;
 
-      TProfile* waveHist = dir.make<TProfile>(
-        Form("HWfm_%03zu_ctw%01zu-%01zu-%01zu-%05zu", channelCnt, cryo, tpc, plane, wire),
+      WorkspaceHistograms& hists = derivWorkspace.summaryHists;
+
+      // Reserved, so the references below stay valid
+      std::vector<ProfileData> profiles;
+      profiles.reserve(4);
+
+      ProfileData& waveHist = profiles.emplace_back(
+        dir,
+        Form("HWfm_%05zu_ctw%01zu-%01zu-%01zu-%05zu", roiStart, cryo, tpc, plane, wire),
         "Waveform",
         waveformSize,
         waveStart,
         waveStop,
         -500.,
         500.);
-      TProfile* derivHist = dir.make<TProfile>(
-        Form("HDer_%03zu_ctw%01zu-%01zu-%01zu-%05zu", channelCnt, cryo, tpc, plane, wire),
+      ProfileData& derivHist = profiles.emplace_back(
+        dir,
+        Form("HDer_%05zu_ctw%01zu-%01zu-%01zu-%05zu", roiStart, cryo, tpc, plane, wire),
         "Derivative",
         waveformSize,
         waveStart,
         waveStop,
         -500.,
         500.);
-      TProfile* candHitHist = dir.make<TProfile>(
-        Form("HCan_%03zu_ctw%01zu-%01zu-%01zu-%05zu", channelCnt, cryo, tpc, plane, wire),
+      ProfileData& candHitHist = profiles.emplace_back(
+        dir,
+        Form("HCan_%05zu_ctw%01zu-%01zu-%01zu-%05zu", roiStart, cryo, tpc, plane, wire),
         "Cand Hits",
         waveformSize,
         waveStart,
         waveStop,
         -500.,
         500.);
-      TProfile* maxDerivHist = dir.make<TProfile>(
-        Form("HMax_%03zu_ctw%01zu-%01zu-%01zu-%05zu", channelCnt, cryo, tpc, plane, wire),
+      ProfileData& maxDerivHist = profiles.emplace_back(
+        dir,
+        Form("HMax_%05zu_ctw%01zu-%01zu-%01zu-%05zu", roiStart, cryo, tpc, plane, wire),
         "Maxima",
         waveformSize,
         waveStart,
@@ -220,20 +278,23 @@ namespace reco_tool {
 
       // Fill wave/derivative
       for (size_t idx = 0; idx < waveform.size(); idx++) {
-        waveHist->Fill(roiStartTick + idx, waveform.at(idx));
-        derivHist->Fill(roiStartTick + idx, derivativeVec.at(idx));
+        waveHist.Fill(roiStartTick + idx, waveform.at(idx));
+        derivHist.Fill(roiStartTick + idx, derivativeVec.at(idx));
       }
 
       // Fill hits
       for (const auto& hitCandidate : hitCandidateVec) {
-        candHitHist->Fill(hitCandidate.hitCenter, hitCandidate.hitHeight);
-        maxDerivHist->Fill(hitCandidate.maxTick, hitCandidate.maxDerivative);
-        maxDerivHist->Fill(hitCandidate.minTick, hitCandidate.minDerivative);
-
-        fDStopStartHist->Fill(hitCandidate.stopTick - hitCandidate.startTick, 1.);
-        fDMaxTickMinTickHist->Fill(hitCandidate.minTick - hitCandidate.maxTick, 1.);
-        fDMaxDerivMinDerivHist->Fill(hitCandidate.maxDerivative - hitCandidate.minDerivative, 1.);
+        candHitHist.Fill(hitCandidate.hitCenter, hitCandidate.hitHeight);
+        maxDerivHist.Fill(hitCandidate.maxTick, hitCandidate.maxDerivative);
+        maxDerivHist.Fill(hitCandidate.minTick, hitCandidate.minDerivative);
+
+        hists[kDStopStart].Fill(hitCandidate.stopTick - hitCandidate.startTick, 1.);
+        hists[kDMaxTickMinTick].Fill(hitCandidate.minTick - hitCandidate.maxTick, 1.);
+        hists[kDMaxDerivMinDeriv].Fill(hitCandidate.maxDerivative - hitCandidate.minDerivative,
+                                       1.);
       }
+
+      derivWorkspace.waveformHists.add(std::move(profiles));
     }
 
     return;
@@ -1,15 +1,15 @@
 ////////////////////////////////////////////////////////////////////////
 /// \file   CandHitMorphological.cc
 /// \author T. Usher
-// MT note: This implementation is not thread-safe.
+// MT note: all per-call state, including diagnostics, lives in the workspace
 ////////////////////////////////////////////////////////////////////////
 
 #include "larcore/CoreUtils/ServiceUtil.h"
 #include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
 #include "larreco/HitFinder/HitFinderTools/IWaveformTool.h"
+#include "larreco/HitFinder/HitFinderTools/WorkspaceHistograms.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
-#include "art/Utilities/Globals.h"
 #include "art/Utilities/ToolMacros.h"
 #include "art/Utilities/make_tool.h"
 #include "art_root_io/TFileService.h"
@@ -19,6 +19,7 @@
 #include "TProfile.h"
 
 #include <cmath>
+#include <mutex>
 
 namespace reco_tool {
 
@@ -26,7 +27,10 @@ namespace reco_tool {
   public:
     explicit CandHitMorphological(const fhicl::ParameterSet& pset);
 
-    void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
+    WorkspacePtr makeWorkspace() const override;
+
+    void findHitCandidates(Workspace&,
+                           const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            const size_t,
                            const size_t,
                            const size_t,
@@ -36,7 +40,19 @@ namespace reco_tool {
                             const HitCandidateVec&,
                             MergeHitCandidateVec&) const override;
 
+    void flushWorkspace(Workspace&) const override;
+
+    bool writesEventOutput() const override { return fOutputWaveforms; }
+
+    void mergeWorkspace(Workspace&) const override;
+
   private:
+    // Per-thread copies of the diagnostic histograms
+    struct MorphologicalWorkspace : Workspace {
+      WorkspaceHistograms summaryHists;
+      WorkspaceProfiles waveformHists;
+    };
+
     // Internal functions
     //< Top level hit finding using erosion/dilation vectors
     void findHitCandidates(Waveform::const_iterator,
@@ -100,20 +116,18 @@ namespace reco_tool {
 
     art::TFileDirectory* fHistDirectory;
 
-    // Global histograms
-    TH1F* fDStopStartHist;        //< Basically keeps track of the length of hit regions
-    TH1F* fDMaxTickMinTickHist;   //< This will be a measure of the width of candidate hits
-    TH1F* fDMaxDerivMinDerivHist; //< This is the difference peak to peak of derivative for cand hit
-    TH1F* fMaxErosionHist;        //< Keep track of the maximum erosion
-    TH1F* fMaxDilationHist;       //< Keep track of the maximum dilation
-    TH1F* fMaxDilEroRatHist;      //< Ratio of the maxima of the two
-
-    //MT note: The mutable data members are only used in the histogram filling functions
-    //and histogram filling can only be done in single-threaded mode.
-    //Will need to consider design changes if this behavior changes.
-    mutable size_t
-      fLastChannel; //< Kludge to keep track of last channel when histogramming in effect
-    mutable size_t fChannelCnt; //< Counts the number of times a channel is used (assumed in order)
+    // Global histograms, filled through the workspace copies
+    enum SummaryHist {
+      kDStopStart,        //< Basically keeps track of the length of hit regions
+      kDMaxTickMinTick,   //< This will be a measure of the width of candidate hits
+      kDMaxDerivMinDeriv, //< This is the difference peak to peak of derivative for cand hit
+      kMaxErosion,        //< Keep track of the maximum erosion
+      kMaxDilation,       //< Keep track of the maximum dilation
+      kMaxDilEroRat       //< Ratio of the maxima of the two
+    };
+    std::vector<TH1*> fSummaryHists;
+
+    mutable std::mutex fMergeMutex; //< Serializes writing workspace output to file
 
     //< All of the real work is done in the waveform tool
     std::unique_ptr<reco_tool::IWaveformTool> fWaveformTool;
@@ -138,56 +152,67 @@ namespace reco_tool {
     , fFitNSigmaFromCenter(pset.get<float>("FitNSigmaFromCenter", 5.))
   {
 
-    if (art::Globals::instance()->nthreads() > 1u) {
-      if (fOutputHistograms) {
-        throw art::Exception(art::errors::Configuration)
-          << "Cannot fill histograms when multiple threads configured, please set "
-             "fOutputHistograms to false or change number of threads to 1\n";
-      }
-
-      if (fOutputWaveforms) {
-        throw art::Exception(art::errors::Configuration)
-          << "Cannot write output waveforms when multiple threads configured, please set "
-             "fOutputHistograms to false or change number of threads to 1\n";
-      }
-    }
     // Recover the baseline tool
     fWaveformTool =
       art::make_tool<reco_tool::IWaveformTool>(pset.get<fhicl::ParameterSet>("WaveformAlgs"));
 
-    // Set the last channel to some nonsensical value
-    fLastChannel = std::numeric_limits<size_t>::max();
-    fChannelCnt = 0;
-
-    // If asked, define the global histograms
-    if (fOutputHistograms) {
-      // Access ART's TFileService, which will handle creating and writing
-      // histograms and n-tuples for us.
+    // The waveform histograms are written in the top directory
+    if (fOutputHistograms || fOutputWaveforms) {
       art::ServiceHandle<art::TFileService> tfs;
 
       fHistDirectory = tfs.get();
+    }
+
+    // If asked, define the global histograms
+    if (fOutputHistograms) {
 
       // Make a directory for these histograms
       art::TFileDirectory dir = fHistDirectory->mkdir(Form("HitPlane_%1zu", fPlane));
 
-      fDStopStartHist =
-        dir.make<TH1F>(Form("DStopStart_%1zu", fPlane), ";Delta Stop/Start;", 100, 0., 100.);
-      fDMaxTickMinTickHist =
-        dir.make<TH1F>(Form("DMaxTMinT_%1zu", fPlane), ";Delta Max/Min Tick;", 100, 0., 100.);
-      fDMaxDerivMinDerivHist =
-        dir.make<TH1F>(Form("DMaxDMinD_%1zu", fPlane), ";Delta Max/Min Deriv;", 200, 0., 100.);
-      fMaxErosionHist =
-        dir.make<TH1F>(Form("MaxErosion_%1zu", fPlane), ";Max Erosion;", 200, -50., 150.);
-      fMaxDilationHist =
-        dir.make<TH1F>(Form("MaxDilation_%1zu", fPlane), ";Max Dilation;", 200, -50., 150.);
-      fMaxDilEroRatHist =
-        dir.make<TH1F>(Form("MaxDilEroRat_%1zu", fPlane), ";Max Dil/Ero;", 200, -1., 1.);
+      fSummaryHists = {
+        dir.make<TH1F>(Form("DStopStart_%1zu", fPlane), ";Delta Stop/Start;", 100, 0., 100.),
+        dir.make<TH1F>(Form("DMaxTMinT_%1zu", fPlane), ";Delta Max/Min Tick;", 100, 0., 100.),
+        dir.make<TH1F>(Form("DMaxDMinD_%1zu", fPlane), ";Delta Max/Min Deriv;", 200, 0., 100.),
+        dir.make<TH1F>(Form("MaxErosion_%1zu", fPlane), ";Max Erosion;", 200, -50., 150.),
+        dir.make<TH1F>(Form("MaxDilation_%1zu", fPlane), ";Max Dilation;", 200, -50., 150.),
+        dir.make<TH1F>(Form("MaxDilEroRat_%1zu", fPlane), ";Max Dil/Ero;", 200, -1., 1.)};
     }
 
     return;
   }
 
+  ICandidateHitFinder::WorkspacePtr CandHitMorphological::makeWorkspace() const
+  {
+    auto workspace = std::make_unique<MorphologicalWorkspace>();
+
+    if (fOutputHistograms) workspace->summaryHists = WorkspaceHistograms(fSummaryHists);
+
+    return workspace;
+  }
+
+  void CandHitMorphological::mergeWorkspace(Workspace& workspace) const
+  {
+    if (!fOutputHistograms && !fOutputWaveforms) return;
+
+    auto& morphWorkspace = static_cast<MorphologicalWorkspace&>(workspace);
+
+    std::lock_guard<std::mutex> lock(fMergeMutex);
+
+    if (fOutputHistograms) morphWorkspace.summaryHists.mergeInto(fSummaryHists);
+    if (fOutputWaveforms) morphWorkspace.waveformHists.writeTo(*fHistDirectory);
+  }
+
+  void CandHitMorphological::flushWorkspace(Workspace& workspace) const
+  {
+    if (!fOutputWaveforms) return;
+
+    std::lock_guard<std::mutex> lock(fMergeMutex);
+
+    static_cast<MorphologicalWorkspace&>(workspace).waveformHists.writeTo(*fHistDirectory);
+  }
+
   void CandHitMorphological::findHitCandidates(
+    Workspace& workspace,
     const recob::Wire::RegionsOfInterest_t::datarange_t& dataRange,
     const size_t roiStartTick,
     const size_t channel,
@@ -250,6 +275,8 @@ namespace reco_tool {
       hitCandidate.hitHeight = waveform.at(centerIdx);
     }
 
+    auto& morphWorkspace = static_cast<MorphologicalWorkspace&>(workspace);
+
     // Keep track of histograms if requested
     if (fOutputWaveforms) {
       // Recover the details...
@@ -259,99 +286,110 @@ namespace reco_tool {
       size_t tpc = wids[0].TPC;
       size_t wire = wids[0].Wire;
 
-      if (channel != fLastChannel) fChannelCnt = 0;
-
-      // Make a directory for these histograms
-      art::TFileDirectory dir = fHistDirectory->mkdir(
-        Form("Event%04zu/c%1zuT%1zuP%1zu/Wire_%05zu", eventCount, cryo, tpc, plane, wire));
+      // Directory for these histograms, created when the workspace is flushed
+      std::string dir =
+        Form("Event%04zu/c%1zuT%1zuP%1zu/Wire_%05zu", eventCount, cryo, tpc, plane, wire);
 
       size_t waveformSize = waveform.size();
       size_t waveStart = dataRange.begin_index();
 
-      TProfile* waveHist =
-        dir.make<TProfile>(Form("HWfm_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Waveform",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* derivHist =
-        dir.make<TProfile>(Form("HDer_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Derivative",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* erosionHist =
-        dir.make<TProfile>(Form("HEro_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Erosion",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* dilationHist =
-        dir.make<TProfile>(Form("HDil_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Dilation",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* candHitHist =
-        dir.make<TProfile>(Form("HCan_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Cand Hits",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* maxDerivHist =
-        dir.make<TProfile>(Form("HMax_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Maxima",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
-      TProfile* strtStopHist =
-        dir.make<TProfile>(Form("HSSS_%03zu_roiStart-%05zu", fChannelCnt, waveStart),
-                           "Start/Stop",
-                           waveformSize,
-                           0,
-                           waveformSize,
-                           -500.,
-                           500.);
+      // Reserved, so the references below stay valid
+      std::vector<ProfileData> profiles;
+      profiles.reserve(7);
+
+      ProfileData& waveHist =
+        profiles.emplace_back(dir,
+                              Form("HWfm_roiStart-%05zu", waveStart),
+                              "Waveform",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& derivHist =
+        profiles.emplace_back(dir,
+                              Form("HDer_roiStart-%05zu", waveStart),
+                              "Derivative",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& erosionHist =
+        profiles.emplace_back(dir,
+                              Form("HEro_roiStart-%05zu", waveStart),
+                              "Erosion",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& dilationHist =
+        profiles.emplace_back(dir,
+                              Form("HDil_roiStart-%05zu", waveStart),
+                              "Dilation",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& candHitHist =
+        profiles.emplace_back(dir,
+                              Form("HCan_roiStart-%05zu", waveStart),
+                              "Cand Hits",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& maxDerivHist =
+        profiles.emplace_back(dir,
+                              Form("HMax_roiStart-%05zu", waveStart),
+                              "Maxima",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
+      ProfileData& strtStopHist =
+        profiles.emplace_back(dir,
+                              Form("HSSS_roiStart-%05zu", waveStart),
+                              "Start/Stop",
+                              waveformSize,
+                              0,
+                              waveformSize,
+                              -500.,
+                              500.);
 
       // Fill wave/derivative
       for (size_t idx = 0; idx < waveform.size(); idx++) {
-        waveHist->Fill(roiStartTick + idx, waveform.at(idx));
-        derivHist->Fill(roiStartTick + idx, derivativeVec.at(idx));
-        erosionHist->Fill(roiStartTick + idx, erosionVec.at(idx));
-        dilationHist->Fill(roiStartTick + idx, dilationVec.at(idx));
+        waveHist.Fill(roiStartTick + idx, waveform.at(idx));
+        derivHist.Fill(roiStartTick + idx, derivativeVec.at(idx));
+        erosionHist.Fill(roiStartTick + idx, erosionVec.at(idx));
+        dilationHist.Fill(roiStartTick + idx, dilationVec.at(idx));
       }
 
       // Fill hits
       for (const auto& hitCandidate : hitCandidateVec) {
-        candHitHist->Fill(hitCandidate.hitCenter, hitCandidate.hitHeight);
-        maxDerivHist->Fill(hitCandidate.maxTick, hitCandidate.maxDerivative);
-        maxDerivHist->Fill(hitCandidate.minTick, hitCandidate.minDerivative);
-        strtStopHist->Fill(hitCandidate.startTick, waveform.at(hitCandidate.startTick));
-        strtStopHist->Fill(hitCandidate.stopTick, waveform.at(hitCandidate.stopTick));
+        candHitHist.Fill(hitCandidate.hitCenter, hitCandidate.hitHeight);
+        maxDerivHist.Fill(hitCandidate.maxTick, hitCandidate.maxDerivative);
+        maxDerivHist.Fill(hitCandidate.minTick, hitCandidate.minDerivative);
+        strtStopHist.Fill(hitCandidate.startTick, waveform.at(hitCandidate.startTick));
+        strtStopHist.Fill(hitCandidate.stopTick, waveform.at(hitCandidate.stopTick));
       }
 
-      fLastChannel = channel;
-      fChannelCnt++;
+      morphWorkspace.waveformHists.add(std::move(profiles));
     }
 
     if (fOutputHistograms) {
+      WorkspaceHistograms& hists = morphWorkspace.summaryHists;
+
       // Fill hits
       for (const auto& hitCandidate : hitCandidateVec) {
-        fDStopStartHist->Fill(hitCandidate.stopTick - hitCandidate.startTick, 1.);
-        fDMaxTickMinTickHist->Fill(hitCandidate.minTick - hitCandidate.maxTick, 1.);
-        fDMaxDerivMinDerivHist->Fill(hitCandidate.maxDerivative - hitCandidate.minDerivative, 1.);
+        hists[kDStopStart].Fill(hitCandidate.stopTick - hitCandidate.startTick, 1.);
+        hists[kDMaxTickMinTick].Fill(hitCandidate.minTick - hitCandidate.maxTick, 1.);
+        hists[kDMaxDerivMinDeriv].Fill(hitCandidate.maxDerivative - hitCandidate.minDerivative,
+                                       1.);
       }
 
       // Get the max dilation/erosion
@@ -364,9 +402,9 @@ namespace reco_tool {
 
       if (std::abs(*maxDilationItr) > 0.) dilEroRat = *maxErosionItr / *maxDilationItr;
 
-      fMaxErosionHist->Fill(*maxErosionItr, 1.);
-      fMaxDilationHist->Fill(*maxDilationItr, 1.);
-      fMaxDilEroRatHist->Fill(dilEroRat, 1.);
+      hists[kMaxErosion].Fill(*maxErosionItr, 1.);
+      hists[kMaxDilation].Fill(*maxDilationItr, 1.);
+      hists[kMaxDilEroRat].Fill(dilEroRat, 1.);
     }
 
     return;
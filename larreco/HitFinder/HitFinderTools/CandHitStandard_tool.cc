@@ -17,7 +17,10 @@ namespace reco_tool {
   public:
     explicit CandHitStandard(const fhicl::ParameterSet& pset);
 
-    void findHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
+    WorkspacePtr makeWorkspace() const override { return std::make_unique<Workspace>(); }
+
+    void findHitCandidates(Workspace&,
+                           const recob::Wire::RegionsOfInterest_t::datarange_t&,
                            const size_t,
                            const size_t,
                            const size_t,
@@ -47,6 +50,7 @@ namespace reco_tool {
   {}
 
   void CandHitStandard::findHitCandidates(
+    Workspace&,
     const recob::Wire::RegionsOfInterest_t::datarange_t& dataRange,
     const size_t roiStartTick,
     const size_t channel,
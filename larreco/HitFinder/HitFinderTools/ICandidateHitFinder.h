@@ -14,6 +14,7 @@
 
 #include "lardataobj/RecoBase/Wire.h"
 
+#include <memory>
 #include <vector>
 
 namespace reco_tool {
@@ -21,6 +22,23 @@ namespace reco_tool {
   public:
     virtual ~ICandidateHitFinder() noexcept = default;
 
+    /// Per-thread scratch space and diagnostics of a tool.
+    ///
+    /// A workspace is obtained from `makeWorkspace()` of the tool which will
+    /// use it, and must never be used by two threads at the same time; the tool
+    /// itself is only accessed through const methods and may be shared freely.
+    /// Workspaces may own ROOT objects, so they should all be made before any
+    /// task runs (e.g. at beginJob). The per-ROI output collected in a workspace
+    /// is written by `flushWorkspace()` (e.g. at the end of each event), the
+    /// summary diagnostics by `mergeWorkspace()`, which callers should invoke
+    /// serially (e.g. at endJob).
+    class Workspace {
+    public:
+      virtual ~Workspace() noexcept = default;
+    };
+
+    using WorkspacePtr = std::unique_ptr<Workspace>;
+
     // Define a structure to contain hits
     struct HitCandidate {
       size_t startTick;
@@ -39,8 +57,12 @@ namespace reco_tool {
 
     using Waveform = std::vector<float>;
 
+    // Create the per-thread workspace to be passed to findHitCandidates
+    virtual WorkspacePtr makeWorkspace() const = 0;
+
     // Search for candidate hits on the input waveform
     virtual void findHitCandidates(
+      Workspace&,                                           // Per-thread workspace
       const recob::Wire::RegionsOfInterest_t::datarange_t&, // Waveform (with range info) to analyze
       const size_t,                                         // waveform start tick
       const size_t,                                         // channel #
@@ -50,6 +72,17 @@ namespace reco_tool {
     virtual void MergeHitCandidates(const recob::Wire::RegionsOfInterest_t::datarange_t&,
                                     const HitCandidateVec&,
                                     MergeHitCandidateVec&) const = 0;
+
+    // Write the per-ROI output collected in a workspace so far (the owning thread may keep
+    // using the workspace meanwhile)
+    virtual void flushWorkspace(Workspace&) const {}
+
+    // True if flushWorkspace writes to TFileService, in which case the caller must not flush
+    // concurrently with any other user of TFileService
+    virtual bool writesEventOutput() const { return false; }
+
+    // Collect the diagnostics accumulated in a workspace (not thread safe)
+    virtual void mergeWorkspace(Workspace&) const {}
   };
 }
 
@@ -14,6 +14,7 @@
 
 #include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
 
+#include <memory>
 #include <vector>
 
 namespace reco_tool {
@@ -32,13 +33,31 @@ namespace reco_tool {
     };
 
     using PeakParamsVec = std::vector<PeakFitParams_t>;
+
+    /// Per-thread fit state and diagnostics, with the same contract as
+    /// `ICandidateHitFinder::Workspace`.
+    class Workspace {
+    public:
+      virtual ~Workspace() noexcept = default;
+    };
+
+    using WorkspacePtr = std::unique_ptr<Workspace>;
+
     virtual ~IPeakFitter() = default;
+
+    // Create the per-thread workspace to be passed to findPeakParameters
+    virtual WorkspacePtr makeWorkspace() const = 0;
+
     // Get parameters for input candidate peaks
-    virtual void findPeakParameters(const std::vector<float>&,
+    virtual void findPeakParameters(Workspace&,
+                                    const std::vector<float>&,
                                     const ICandidateHitFinder::HitCandidateVec&,
                                     PeakParamsVec&,
                                     double&,
                                     int&) const = 0;
+
+    // Collect the diagnostics accumulated in a workspace (not thread safe)
+    virtual void mergeWorkspace(Workspace&) const {}
   };
 }
 
@@ -16,7 +16,10 @@ namespace reco_tool {
   public:
     explicit PeakFitterGaussElimination(const fhicl::ParameterSet& pset);
 
-    void findPeakParameters(const std::vector<float>&,
+    WorkspacePtr makeWorkspace() const override { return std::make_unique<Workspace>(); }
+
+    void findPeakParameters(Workspace&,
+                            const std::vector<float>&,
                             const ICandidateHitFinder::HitCandidateVec&,
                             PeakParamsVec&,
                             double&,
@@ -45,6 +48,7 @@ namespace reco_tool {
 
   // --------------------------------------------------------------------------------------------
   void PeakFitterGaussElimination::findPeakParameters(
+    Workspace&,
     const std::vector<float>& roiSignalVec,
     const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
     PeakParamsVec& peakParamsVec,
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////
+/// \file   PeakFitterGaussLM.cc
+///
+/// \brief  Multi-Gaussian peak fitter using the ROOT-free Levenberg-Marquardt
+///         fitter in hit::MultiGausFitter. The seeds and parameter limits are
+///         the same as in PeakFitterGaussian, so that the two tools agree; this
+///         one owns no mutable state and may be shared by concurrent threads.
+///
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/HitFinder/MultiGausFitter.h"
+
+#include "art/Utilities/ToolMacros.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace reco_tool {
+
+  class PeakFitterGaussLM : IPeakFitter {
+  public:
+    explicit PeakFitterGaussLM(const fhicl::ParameterSet& pset);
+
+    WorkspacePtr makeWorkspace() const override { return std::make_unique<Workspace>(); }
+
+    void findPeakParameters(Workspace&,
+                            const std::vector<float>&,
+                            const ICandidateHitFinder::HitCandidateVec&,
+                            PeakParamsVec&,
+                            double&,
+                            int&) const override;
+
+  private:
+    // Member variables from the fhicl file
+    const double fMinWidth;     ///< minimum initial width for gaussian fit
+    const double fMaxWidthMult; ///< multiplier for max width for gaussian fit
+    const double fPeakRange;    ///< set range limits for peak center
+    const double fAmpRange;     ///< set range limit for peak amplitude
+    const bool fFloatBaseline;  ///< Allow baseline to "float" away from zero
+
+    hit::MultiGausFitter fFitter; ///< Stateless fitter, shared by all the calls
+  };
+
+  //----------------------------------------------------------------------
+  // Constructor.
+  PeakFitterGaussLM::PeakFitterGaussLM(const fhicl::ParameterSet& pset)
+    : fMinWidth(pset.get<double>("MinWidth", 0.5))
+    , fMaxWidthMult(pset.get<double>("MaxWidthMult", 3.))
+    , fPeakRange(pset.get<double>("PeakRangeFact", 2.))
+    , fAmpRange(pset.get<double>("PeakAmpRange", 2.))
+    , fFloatBaseline(pset.get<bool>("FloatBaseline", false))
+  {
+    hit::MultiGausFitter::Config config;
+
+    config.maxIterations = pset.get<unsigned int>("MaxIterations", config.maxIterations);
+    config.chi2Tolerance = pset.get<double>("Chi2Tolerance", config.chi2Tolerance);
+
+    fFitter = hit::MultiGausFitter(config);
+
+    return;
+  }
+
+  // --------------------------------------------------------------------------------------------
+  void PeakFitterGaussLM::findPeakParameters(
+    Workspace&,
+    const std::vector<float>& roiSignalVec,
+    const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+    PeakParamsVec& peakParamsVec,
+    double& chi2PerNDF,
+    int& NDF) const
+  {
+    // *** NOTE: this algorithm assumes the reference time for input hit candidates is to
+    //           the first tick of the input waveform (ie 0)
+    //
+    if (hitCandidateVec.empty()) return;
+
+    // in case of a fit failure, set the chi-square to infinity
+    chi2PerNDF = std::numeric_limits<double>::infinity();
+
+    // Too many peaks for the fixed size work space, the caller will fall back on
+    // its long pulse treatment
+    if (hitCandidateVec.size() > hit::MultiGausFitter::kMaxGaussians) {
+      mf::LogDebug("PeakFitterGaussLM")
+        << "Asked to fit " << hitCandidateVec.size() << " peaks, at most "
+        << hit::MultiGausFitter::kMaxGaussians << " are supported";
+      return;
+    }
+
+    int startTime = hitCandidateVec.front().startTick;
+    int endTime = hitCandidateVec.back().stopTick;
+    int roiSize = endTime - startTime;
+
+    size_t const nGaus = hitCandidateVec.size();
+
+    hit::MultiGausFitter::FitParams fitParams;
+
+    fitParams.nGaus = nGaus;
+    fitParams.floatBaseline = fFloatBaseline;
+
+    // Set the baseline if so desired
+    float baseline(0.);
+
+    if (fFloatBaseline) baseline = roiSignalVec[startTime];
+
+    fitParams.value[3 * nGaus] = baseline;
+    fitParams.lower[3 * nGaus] = baseline - 12.;
+    fitParams.upper[3 * nGaus] = baseline + 12.;
+
+    // ### Setting the parameters for the Gaussian Fit ###
+    int parIdx{0};
+    for (auto const& candidateHit : hitCandidateVec) {
+      double const peakMean = candidateHit.hitCenter - float(startTime);
+      double const peakWidth = candidateHit.hitSigma;
+      double const amplitude = candidateHit.hitHeight - baseline;
+      double const meanLowLim = std::max(peakMean - fPeakRange * peakWidth, 0.);
+      double const meanHiLim = std::min(peakMean + fPeakRange * peakWidth, double(roiSize));
+
+      fitParams.value[parIdx] = amplitude;
+      fitParams.value[parIdx + 1] = peakMean;
+      fitParams.value[parIdx + 2] = peakWidth;
+      fitParams.lower[parIdx] = 0.1 * amplitude;
+      fitParams.upper[parIdx] = fAmpRange * amplitude;
+      fitParams.lower[parIdx + 1] = meanLowLim;
+      fitParams.upper[parIdx + 1] = meanHiLim;
+      fitParams.lower[parIdx + 2] = std::max(fMinWidth, 0.1 * peakWidth);
+      fitParams.upper[parIdx + 2] = fMaxWidthMult * peakWidth;
+
+      parIdx += 3;
+    }
+
+    if (!fFitter.Fit(roiSignalVec.data() + startTime, roiSize, fitParams)) return;
+
+    chi2PerNDF = fitParams.chi2 / fitParams.ndf;
+    NDF = fitParams.ndf;
+
+    parIdx = 0;
+    for (size_t idx = 0; idx < nGaus; idx++) {
+      PeakFitParams_t peakParams;
+
+      peakParams.peakAmplitude = fitParams.value[parIdx];
+      peakParams.peakAmplitudeError = fitParams.error[parIdx];
+      peakParams.peakCenter = fitParams.value[parIdx + 1] + float(startTime);
+      peakParams.peakCenterError = fitParams.error[parIdx + 1];
+      peakParams.peakSigma = fitParams.value[parIdx + 2];
+      peakParams.peakSigmaError = fitParams.error[parIdx + 2];
+
+      peakParamsVec.emplace_back(peakParams);
+
+      parIdx += 3;
+    }
+
+    return;
+  }
+
+  DEFINE_ART_CLASS_TOOL(PeakFitterGaussLM)
+}
@@ -6,6 +6,7 @@
 #include "larcore/CoreUtils/ServiceUtil.h"
 #include "larcore/Geometry/Geometry.h"
 #include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/HitFinder/HitFinderTools/WorkspaceHistograms.h"
 #include "larreco/RecoAlg/GausFitCache.h" // hit::GausFitCache
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -13,8 +14,10 @@
 #include "art_root_io/TFileService.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <atomic>
 #include <cassert>
 #include <fstream>
+#include <mutex>
 
 #include "TF1.h"
 #include "TH1F.h"
@@ -57,13 +60,48 @@ namespace reco_tool {
   public:
     explicit PeakFitterGaussian(const fhicl::ParameterSet& pset);
 
-    void findPeakParameters(const std::vector<float>&,
+    WorkspacePtr makeWorkspace() const override;
+
+    void findPeakParameters(Workspace&,
+                            const std::vector<float>&,
                             const ICandidateHitFinder::HitCandidateVec&,
                             PeakParamsVec&,
                             double&,
                             int&) const override;
 
+    void mergeWorkspace(Workspace&) const override;
+
   private:
+    /// The ROOT fit objects are modified by each fit, so each thread has its own
+    /// (with unique names, since ROOT keeps track of functions by name). They are
+    /// all made with the workspace, before any task runs; fits needing more
+    /// Gaussians or a longer histogram create them under fROOTMutex.
+    struct GaussianWorkspace : Workspace {
+      const std::string name;
+      BaselinedGausFitCache fitCache; ///< Preallocated ROOT functions for the fits.
+      TH1F histogram;
+      WorkspaceHistograms summaryHists;
+
+      explicit GaussianWorkspace(size_t id)
+        : name("PeakFitter_" + std::to_string(id))
+        , fitCache("BaselinedGausFitCache_" + name)
+        , histogram(("HitSignal_" + name).c_str(), "", 500, 0., 500.)
+      {
+        histogram.SetDirectory(nullptr);
+        histogram.Sumw2();
+
+        for (size_t nGaus = 1; nGaus <= kPreparedGaussians; nGaus++)
+          fitCache.Get(nGaus);
+      }
+    };
+
+    /// Number of Gaussians up to which the fit functions are made with the workspace
+    /// (the largest MaxMultiHit of the standard configurations)
+    static constexpr size_t kPreparedGaussians = 10;
+
+    /// Serializes the creation of ROOT objects while fitting
+    static std::mutex fROOTMutex;
+
     // Member variables from the fhicl file
     const double fMinWidth;       ///< minimum initial width for gaussian fit
     const double fMaxWidthMult;   ///< multiplier for max width for gaussian fit
@@ -72,24 +110,29 @@ namespace reco_tool {
     const bool fFloatBaseline;    ///< Allow baseline to "float" away from zero
     const bool fOutputHistograms; ///< If true will generate summary style histograms
 
-    TH1F* fNumCandHitsHist;
-    TH1F* fROISizeHist;
-    TH1F* fCandPeakPositionHist;
-    TH1F* fCandPeakWidHist;
-    TH1F* fCandPeakAmpitudeHist;
-    TH1F* fCandBaselineHist;
-    TH1F* fFitPeakPositionHist;
-    TH1F* fFitPeakWidHist;
-    TH1F* fFitPeakAmpitudeHist;
-    TH1F* fFitBaselineHist;
-
-    mutable BaselinedGausFitCache fFitCache; ///< Preallocated ROOT functions for the fits.
-
-    mutable TH1F fHistogram;
+    // Summary histograms, filled through the workspace copies
+    enum SummaryHist {
+      kNumCandHits,
+      kROISize,
+      kCandPeakPosition,
+      kCandPeakWid,
+      kCandPeakAmpitude,
+      kCandBaseline,
+      kFitPeakPosition,
+      kFitPeakWid,
+      kFitPeakAmpitude,
+      kFitBaseline
+    };
+    std::vector<TH1*> fSummaryHists;
+
+    mutable std::mutex fMergeMutex; ///< Serializes merging of workspace histograms
+    mutable std::atomic<size_t> fNumWorkspaces{0}; ///< Used to give unique names to workspaces
 
     const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
   };
 
+  std::mutex PeakFitterGaussian::fROOTMutex;
+
   //----------------------------------------------------------------------
   // Constructor.
   PeakFitterGaussian::PeakFitterGaussian(const fhicl::ParameterSet& pset)
@@ -100,12 +143,6 @@ namespace reco_tool {
     , fFloatBaseline(pset.get<bool>("FloatBaseline", false))
     , fOutputHistograms(pset.get<bool>("OutputHistograms", false))
   {
-    fHistogram = TH1F("PeakFitterHitSignal", "", 500, 0., 500.);
-
-    fHistogram.Sumw2();
-
-    std::string function = "Gaus(0)";
-
     // If asked, define the global histograms
     if (fOutputHistograms) {
       // Access ART's TFileService, which will handle creating and writing
@@ -115,23 +152,45 @@ namespace reco_tool {
       // Make a directory for these histograms
       art::TFileDirectory dir = tfs->mkdir("PeakFit");
 
-      fNumCandHitsHist = dir.make<TH1F>("NumCandHits", "# Candidate Hits", 100, 0., 100.);
-      fROISizeHist = dir.make<TH1F>("ROISize", "ROI Size", 400, 0., 400.);
-      fCandPeakPositionHist = dir.make<TH1F>("CPeakPosition", "Peak Position", 200, 0., 400.);
-      fCandPeakWidHist = dir.make<TH1F>("CPeadWidth", "Peak Width", 100, 0., 25.);
-      fCandPeakAmpitudeHist = dir.make<TH1F>("CPeakAmplitude", "Peak Amplitude", 100, 0., 200.);
-      fCandBaselineHist = dir.make<TH1F>("CBaseline", "Baseline", 200, -25., 25.);
-      fFitPeakPositionHist = dir.make<TH1F>("FPeakPosition", "Peak Position", 200, 0., 400.);
-      fFitPeakWidHist = dir.make<TH1F>("FPeadWidth", "Peak Width", 100, 0., 25.);
-      fFitPeakAmpitudeHist = dir.make<TH1F>("FPeakAmplitude", "Peak Amplitude", 100, 0., 200.);
-      fFitBaselineHist = dir.make<TH1F>("FBaseline", "Baseline", 200, -25., 25.);
+      fSummaryHists = {
+        dir.make<TH1F>("NumCandHits", "# Candidate Hits", 100, 0., 100.),
+        dir.make<TH1F>("ROISize", "ROI Size", 400, 0., 400.),
+        dir.make<TH1F>("CPeakPosition", "Peak Position", 200, 0., 400.),
+        dir.make<TH1F>("CPeadWidth", "Peak Width", 100, 0., 25.),
+        dir.make<TH1F>("CPeakAmplitude", "Peak Amplitude", 100, 0., 200.),
+        dir.make<TH1F>("CBaseline", "Baseline", 200, -25., 25.),
+        dir.make<TH1F>("FPeakPosition", "Peak Position", 200, 0., 400.),
+        dir.make<TH1F>("FPeadWidth", "Peak Width", 100, 0., 25.),
+        dir.make<TH1F>("FPeakAmplitude", "Peak Amplitude", 100, 0., 200.),
+        dir.make<TH1F>("FBaseline", "Baseline", 200, -25., 25.)};
     }
 
     return;
   }
 
+  // --------------------------------------------------------------------------------------------
+  IPeakFitter::WorkspacePtr PeakFitterGaussian::makeWorkspace() const
+  {
+    auto workspace = std::make_unique<GaussianWorkspace>(fNumWorkspaces++);
+
+    if (fOutputHistograms) workspace->summaryHists = WorkspaceHistograms(fSummaryHists);
+
+    return workspace;
+  }
+
+  // --------------------------------------------------------------------------------------------
+  void PeakFitterGaussian::mergeWorkspace(Workspace& workspace) const
+  {
+    if (!fOutputHistograms) return;
+
+    std::lock_guard<std::mutex> lock(fMergeMutex);
+
+    static_cast<GaussianWorkspace&>(workspace).summaryHists.mergeInto(fSummaryHists);
+  }
+
   // --------------------------------------------------------------------------------------------
   void PeakFitterGaussian::findPeakParameters(
+    Workspace& workspace,
     const std::vector<float>& roiSignalVec,
     const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
     PeakParamsVec& peakParamsVec,
@@ -146,6 +205,10 @@ namespace reco_tool {
     //
     if (hitCandidateVec.empty()) return;
 
+    auto& gausWorkspace = static_cast<GaussianWorkspace&>(workspace);
+    TH1F& fitHistogram = gausWorkspace.histogram;
+    WorkspaceHistograms& hists = gausWorkspace.summaryHists;
+
     // in case of a fit failure, set the chi-square to infinity
     chi2PerNDF = std::numeric_limits<double>::infinity();
 
@@ -154,14 +217,17 @@ namespace reco_tool {
     int roiSize = endTime - startTime;
 
     // Check to see if we need a bigger histogram for fitting
-    if (roiSize > fHistogram.GetNbinsX()) {
-      std::string histName = "PeakFitterHitSignal_" + std::to_string(roiSize);
-      fHistogram = TH1F(histName.c_str(), "", roiSize, 0., roiSize);
-      fHistogram.Sumw2();
+    if (roiSize > fitHistogram.GetNbinsX()) {
+      std::lock_guard<std::mutex> lock(fROOTMutex);
+      TH1::AddDirectory(kFALSE);
+      std::string histName = "HitSignal_" + gausWorkspace.name + "_" + std::to_string(roiSize);
+      fitHistogram = TH1F(histName.c_str(), "", roiSize, 0., roiSize);
+      fitHistogram.SetDirectory(nullptr);
+      fitHistogram.Sumw2();
     }
 
     for (int idx = 0; idx < roiSize; idx++)
-      fHistogram.SetBinContent(idx + 1, roiSignalVec[startTime + idx]);
+      fitHistogram.SetBinContent(idx + 1, roiSignalVec[startTime + idx]);
 
       // Build the string to describe the fit formula
 #if 0
@@ -183,8 +249,15 @@ namespace reco_tool {
     TF1 Gaus("Gaus",equation.c_str(),0,roiSize,TF1::EAddToList::kNo);
 #else
     unsigned int const nGaus = hitCandidateVec.size();
-    assert(fFitCache.Get(nGaus));
-    TF1& Gaus = *(fFitCache.Get(nGaus));
+    TF1* gausFunc = nullptr;
+    if (nGaus <= kPreparedGaussians)
+      gausFunc = gausWorkspace.fitCache.Get(nGaus);
+    else {
+      std::lock_guard<std::mutex> lock(fROOTMutex);
+      gausFunc = gausWorkspace.fitCache.Get(nGaus);
+    }
+    assert(gausFunc);
+    TF1& Gaus = *gausFunc;
 
     // Set the baseline if so desired
     float baseline(0.);
@@ -200,9 +273,9 @@ namespace reco_tool {
 #endif // 0
 
     if (fOutputHistograms) {
-      fNumCandHitsHist->Fill(hitCandidateVec.size(), 1.);
-      fROISizeHist->Fill(roiSize, 1.);
-      fCandBaselineHist->Fill(baseline, 1.);
+      hists[kNumCandHits].Fill(hitCandidateVec.size(), 1.);
+      hists[kROISize].Fill(roiSize, 1.);
+      hists[kCandBaseline].Fill(baseline, 1.);
     }
 
     // ### Setting the parameters for the Gaussian Fit ###
@@ -215,9 +288,9 @@ namespace reco_tool {
       double const meanHiLim = std::min(peakMean + fPeakRange * peakWidth, double(roiSize));
 
       if (fOutputHistograms) {
-        fCandPeakPositionHist->Fill(peakMean, 1.);
-        fCandPeakWidHist->Fill(peakWidth, 1.);
-        fCandPeakAmpitudeHist->Fill(amplitude, 1.);
+        hists[kCandPeakPosition].Fill(peakMean, 1.);
+        hists[kCandPeakWid].Fill(peakWidth, 1.);
+        hists[kCandPeakAmpitude].Fill(amplitude, 1.);
       }
 
       Gaus.SetParameter(parIdx, amplitude);
@@ -234,7 +307,7 @@ namespace reco_tool {
     int fitResult{-1};
 
     try {
-      fitResult = fHistogram.Fit(&Gaus, "QNWB", "", 0., roiSize);
+      fitResult = fitHistogram.Fit(&Gaus, "QNWB", "", 0., roiSize);
     }
     catch (...) {
       mf::LogWarning("GausHitFinder") << "Fitter failed finding a hit";
@@ -260,9 +333,9 @@ namespace reco_tool {
         peakParams.peakSigmaError = Gaus.GetParError(parIdx + 2);
 
         if (fOutputHistograms) {
-          fFitPeakPositionHist->Fill(peakParams.peakCenter, 1.);
-          fFitPeakWidHist->Fill(peakParams.peakSigma, 1.);
-          fFitPeakAmpitudeHist->Fill(peakParams.peakAmplitude, 1.);
+          hists[kFitPeakPosition].Fill(peakParams.peakCenter, 1.);
+          hists[kFitPeakWid].Fill(peakParams.peakSigma, 1.);
+          hists[kFitPeakAmpitude].Fill(peakParams.peakAmplitude, 1.);
         }
 
         peakParamsVec.emplace_back(peakParams);
@@ -270,7 +343,7 @@ namespace reco_tool {
         parIdx += 3;
       }
 
-      if (fOutputHistograms) fFitBaselineHist->Fill(Gaus.GetParameter(3 * nGaus), 1.);
+      if (fOutputHistograms) hists[kFitBaseline].Fill(Gaus.GetParameter(3 * nGaus), 1.);
     }
 #if 0
     Gaus.Delete();
@@ -20,7 +20,10 @@ namespace reco_tool {
   public:
     explicit PeakFitterMrqdt(const fhicl::ParameterSet& pset);
 
-    void findPeakParameters(const std::vector<float>&,
+    WorkspacePtr makeWorkspace() const override { return std::make_unique<Workspace>(); }
+
+    void findPeakParameters(Workspace&,
+                            const std::vector<float>&,
                             const ICandidateHitFinder::HitCandidateVec&,
                             PeakParamsVec&,
                             double&,
@@ -50,7 +53,8 @@ namespace reco_tool {
 
   //------------------------
   //output parameters should be replaced with a returned value
-  void PeakFitterMrqdt::findPeakParameters(const std::vector<float>& signal,
+  void PeakFitterMrqdt::findPeakParameters(Workspace&,
+                                           const std::vector<float>& signal,
                                            const ICandidateHitFinder::HitCandidateVec& fhc_vec,
                                            PeakParamsVec& mhpp_vec,
                                            double& chi2PerNDF,
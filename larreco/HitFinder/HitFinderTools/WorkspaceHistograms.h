@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////
+///
+/// \file   WorkspaceHistograms.h
+///
+/// \brief  Helpers for hit finder tools to fill diagnostic histograms from
+///         per-thread workspaces: summary histograms are cloned into each
+///         workspace and summed back into the TFileService owned originals,
+///         per-ROI profiles are kept as plain data in the workspace until
+///         they are written into their TFileService directory.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef WorkspaceHistograms_H
+#define WorkspaceHistograms_H
+
+#include "art_root_io/TFileDirectory.h"
+
+#include "TH1.h"
+#include "TProfile.h"
+
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace reco_tool {
+
+  /// Thread local copies of a set of summary histograms.
+  class WorkspaceHistograms {
+  public:
+    WorkspaceHistograms() = default;
+
+    /// Clones (empty, detached from any directory) all the `masters`
+    explicit WorkspaceHistograms(const std::vector<TH1*>& masters)
+    {
+      fClones.reserve(masters.size());
+
+      for (const TH1* master : masters) {
+        auto clone = std::unique_ptr<TH1>(static_cast<TH1*>(master->Clone()));
+        clone->SetDirectory(nullptr);
+        clone->Reset();
+        fClones.push_back(std::move(clone));
+      }
+    }
+
+    bool empty() const { return fClones.empty(); }
+
+    TH1& operator[](size_t idx) { return *fClones[idx]; }
+
+    /// Adds the content of the clones to the `masters`, then resets the clones
+    void mergeInto(const std::vector<TH1*>& masters)
+    {
+      for (size_t idx = 0; idx < fClones.size(); idx++) {
+        masters[idx]->Add(fClones[idx].get());
+        fClones[idx]->Reset();
+      }
+    }
+
+  private:
+    std::vector<std::unique_ptr<TH1>> fClones;
+  };
+
+  /// Contents of a per-ROI profile, kept as plain data until it is written as a TProfile in
+  /// its TFileService directory, so that no ROOT object is created by the threads filling it.
+  class ProfileData {
+  public:
+    ProfileData(std::string path,
+                std::string name,
+                std::string title,
+                int nBins,
+                double xLow,
+                double xHigh,
+                double yLow,
+                double yHigh)
+      : fPath(std::move(path))
+      , fName(std::move(name))
+      , fTitle(std::move(title))
+      , fNBins(nBins)
+      , fXLow(xLow)
+      , fXHigh(xHigh)
+      , fYLow(yLow)
+      , fYHigh(yHigh)
+    {}
+
+    void Fill(double x, double y) { fEntries.emplace_back(x, y); }
+
+    /// Makes the profile under the `path` subdirectory of `topDir`
+    void writeTo(art::TFileDirectory& topDir) const
+    {
+      art::TFileDirectory dir = topDir.mkdir(fPath);
+      TProfile* profile = dir.make<TProfile>(
+        fName.c_str(), fTitle.c_str(), fNBins, fXLow, fXHigh, fYLow, fYHigh);
+      for (const auto& [x, y] : fEntries)
+        profile->Fill(x, y);
+    }
+
+  private:
+    std::string fPath;
+    std::string fName;
+    std::string fTitle;
+    int fNBins;
+    double fXLow;
+    double fXHigh;
+    double fYLow;
+    double fYHigh;
+    std::vector<std::pair<double, double>> fEntries;
+  };
+
+  /// Profiles of the ROIs handled by a workspace, waiting to be written.
+  ///
+  /// The profiles of a ROI are added once complete; the ones added so far can be written
+  /// (e.g. at the end of each event) while the owning thread keeps adding more.
+  class WorkspaceProfiles {
+  public:
+    /// Queues the complete profiles of a ROI
+    void add(std::vector<ProfileData>&& profiles)
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      std::move(profiles.begin(), profiles.end(), std::back_inserter(fProfiles));
+    }
+
+    /// Writes all the queued profiles into `topDir` and releases them
+    void writeTo(art::TFileDirectory& topDir)
+    {
+      std::vector<ProfileData> profiles;
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        profiles.swap(fProfiles);
+      }
+      for (const auto& profile : profiles)
+        profile.writeTo(topDir);
+    }
+
+  private:
+    std::mutex fMutex;
+    std::vector<ProfileData> fProfiles;
+  };
+
+}
+
+#endif
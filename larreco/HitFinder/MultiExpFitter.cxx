@@ -0,0 +1,386 @@
+/*!
+ * Title:   MultiExpFitter Class
+ *
+ * Description:
+ * Levenberg-Marquardt fit of a sum of asymmetric exponential pulses, see
+ * MultiExpFitter.h for the conventions used.
+*/
+
+#include "larreco/HitFinder/MultiExpFitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+  // beyond this (negative) exponent a pulse contributes less than ~1e-22 of
+  // its amplitude, so it (and its derivatives) is dropped from the sample
+  constexpr double kMinExponent = -50.;
+
+  constexpr double kSlope = 0.4;
+
+  /// Shape of a single pulse at one sample, written so that it cannot overflow
+  /// in the denominator: log(1 + exp(q)) and exp(q) / (1 + exp(q)) are both
+  /// computed from exp(-|q|)
+  struct PulseShape {
+    double p = 0.;        ///< 0.4 (x - t0) / tau1
+    double q = 0.;        ///< 0.4 (x - t0) / tau2
+    double exponent = 0.; ///< log of the pulse over its amplitude
+    double sigmoid = 0.;  ///< exp(q) / (1 + exp(q))
+
+    PulseShape(double x, double t0, double tau1, double tau2)
+    {
+      double const u = kSlope * (x - t0);
+      p = u / tau1;
+      q = u / tau2;
+      double const em = std::exp(-std::abs(q));
+      exponent = p - (std::max(q, 0.) + std::log1p(em));
+      sigmoid = q >= 0. ? 1. / (1. + em) : em / (1. + em);
+    }
+  };
+}
+
+//------------------------------------------------------------------------------
+void hit::MultiExpFitter::FitParams::resize(std::size_t n, bool same)
+{
+  nPeaks = n;
+  sameShape = same;
+  std::size_t const nPar = NParams(n, same);
+  value.resize(nPar);
+  lower.resize(nPar);
+  upper.resize(nPar);
+  error.resize(nPar);
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiExpFitter::Pulse(double x, double amplitude, double t0, double tau1, double tau2)
+{
+  PulseShape const shape(x, t0, tau1, tau2);
+  return amplitude * std::exp(shape.exponent);
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiExpFitter::Evaluate(FitParams const& params, double x)
+{
+  double value = 0.;
+  for (std::size_t iPeak = 0; iPeak < params.nPeaks; ++iPeak) {
+    value += Pulse(x,
+                   params.value[AmplitudeIndex(iPeak, params.sameShape)],
+                   params.value[PeakTimeIndex(iPeak, params.sameShape)],
+                   params.value[Tau1Index(iPeak, params.sameShape)],
+                   params.value[Tau2Index(iPeak, params.sameShape)]);
+  }
+  return value;
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiExpFitter::PulseMaximumX(double t0,
+                                          double tau1,
+                                          double tau2,
+                                          double xMin,
+                                          double xMax)
+{
+  // the derivative vanishes where exp(q) = tau2 / (tau1 - tau2); with a rise
+  // not faster than the fall the pulse keeps growing over the whole range
+  if (!(tau1 > tau2) || !(tau2 > 0.)) return xMax;
+  double const x = t0 + tau2 / kSlope * std::log(tau2 / (tau1 - tau2));
+  return std::min(std::max(x, xMin), xMax);
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiExpFitter::accumulate(float const* signal,
+                                       int firstTick,
+                                       int lastTick,
+                                       FitParams const& params,
+                                       std::vector<double> const& par,
+                                       Workspace& workspace) const
+{
+  std::size_t const nPar = NParams(params.nPeaks, params.sameShape);
+  bool const sameShape = params.sameShape;
+
+  std::fill(workspace.alpha.begin(), workspace.alpha.begin() + nPar * nPar, 0.);
+  std::fill(workspace.beta.begin(), workspace.beta.begin() + nPar, 0.);
+
+  // derivatives of the model for this sample, packed with their parameter
+  // index; with a common shape the two time constants always come first
+  auto& jac = workspace.jac;
+  auto& idx = workspace.idx;
+
+  double chi2 = 0.;
+
+  for (int tick = firstTick; tick <= lastTick; ++tick) {
+    double const y = signal[tick];
+    if (y == 0.) continue;
+
+    double const x = tick + 0.5;
+    double model = 0.;
+    std::size_t nActive = 0;
+
+    if (sameShape) {
+      idx[0] = 0;
+      jac[0] = 0.;
+      idx[1] = 1;
+      jac[1] = 0.;
+      nActive = 2;
+    }
+
+    for (std::size_t iPeak = 0; iPeak < params.nPeaks; ++iPeak) {
+      std::size_t const iTau1 = Tau1Index(iPeak, sameShape);
+      std::size_t const iTau2 = Tau2Index(iPeak, sameShape);
+      std::size_t const iAmp = AmplitudeIndex(iPeak, sameShape);
+      std::size_t const iT0 = PeakTimeIndex(iPeak, sameShape);
+
+      PulseShape const shape(x, par[iT0], par[iTau1], par[iTau2]);
+      if (shape.exponent < kMinExponent) continue;
+
+      double const e = std::exp(shape.exponent);
+      double const f = par[iAmp] * e;
+
+      model += f;
+
+      double const dTau1 = -f * shape.p / par[iTau1];
+      double const dTau2 = f * shape.sigmoid * shape.q / par[iTau2];
+      double const dT0 = f * kSlope * (shape.sigmoid / par[iTau2] - 1. / par[iTau1]);
+
+      if (sameShape) {
+        jac[0] += dTau1;
+        jac[1] += dTau2;
+      }
+      else {
+        idx[nActive] = iTau1;
+        jac[nActive++] = dTau1;
+        idx[nActive] = iTau2;
+        jac[nActive++] = dTau2;
+      }
+      idx[nActive] = iAmp;
+      jac[nActive++] = e;
+      idx[nActive] = iT0;
+      jac[nActive++] = dT0;
+    }
+
+    double const residual = y - model;
+
+    chi2 += residual * residual;
+
+    // indices are increasing, so (a, b <= a) always lands in the lower triangle
+    for (std::size_t a = 0; a < nActive; ++a) {
+      double const ja = jac[a];
+      double* row = workspace.alpha.data() + idx[a] * nPar;
+
+      workspace.beta[idx[a]] += ja * residual;
+
+      for (std::size_t b = 0; b <= a; ++b)
+        row[idx[b]] += ja * jac[b];
+    }
+  }
+
+  return chi2;
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiExpFitter::chiSquare(float const* signal,
+                                      int firstTick,
+                                      int lastTick,
+                                      FitParams const& params,
+                                      std::vector<double> const& par) const
+{
+  bool const sameShape = params.sameShape;
+  double chi2 = 0.;
+
+  for (int tick = firstTick; tick <= lastTick; ++tick) {
+    double const y = signal[tick];
+    if (y == 0.) continue;
+
+    double const x = tick + 0.5;
+    double model = 0.;
+
+    for (std::size_t iPeak = 0; iPeak < params.nPeaks; ++iPeak) {
+      PulseShape const shape(x,
+                             par[PeakTimeIndex(iPeak, sameShape)],
+                             par[Tau1Index(iPeak, sameShape)],
+                             par[Tau2Index(iPeak, sameShape)]);
+      if (shape.exponent >= kMinExponent)
+        model += par[AmplitudeIndex(iPeak, sameShape)] * std::exp(shape.exponent);
+    }
+
+    double const residual = y - model;
+    chi2 += residual * residual;
+  }
+
+  return chi2;
+}
+
+//------------------------------------------------------------------------------
+bool hit::MultiExpFitter::choleskyDecompose(std::vector<double>& a, std::size_t n)
+{
+  for (std::size_t j = 0; j < n; ++j) {
+    double* rowJ = a.data() + j * n;
+    double diag = rowJ[j];
+
+    for (std::size_t k = 0; k < j; ++k)
+      diag -= rowJ[k] * rowJ[k];
+
+    if (!(diag > 0.)) return false;
+
+    double const ljj = std::sqrt(diag);
+    rowJ[j] = ljj;
+
+    for (std::size_t i = j + 1; i < n; ++i) {
+      double* rowI = a.data() + i * n;
+      double sum = rowI[j];
+
+      for (std::size_t k = 0; k < j; ++k)
+        sum -= rowI[k] * rowJ[k];
+
+      rowI[j] = sum / ljj;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void hit::MultiExpFitter::choleskySolve(std::vector<double> const& l,
+                                        std::size_t n,
+                                        std::vector<double>& b)
+{
+  // forward substitution: L y = b
+  for (std::size_t i = 0; i < n; ++i) {
+    double const* rowI = l.data() + i * n;
+    double sum = b[i];
+    for (std::size_t k = 0; k < i; ++k)
+      sum -= rowI[k] * b[k];
+    b[i] = sum / rowI[i];
+  }
+
+  // back substitution: L^T x = y
+  for (std::size_t i = n; i-- > 0;) {
+    double sum = b[i];
+    for (std::size_t k = i + 1; k < n; ++k)
+      sum -= l[k * n + i] * b[k];
+    b[i] = sum / l[i * n + i];
+  }
+}
+
+//------------------------------------------------------------------------------
+bool hit::MultiExpFitter::Fit(float const* signal,
+                              int firstTick,
+                              int lastTick,
+                              FitParams& params,
+                              Workspace& workspace) const
+{
+  params.iterations = 0;
+  std::fill(params.error.begin(), params.error.end(), 0.);
+
+  if (params.nPeaks == 0) return false;
+
+  std::size_t const nPar = NParams(params.nPeaks, params.sameShape);
+  if (params.value.size() < nPar || params.lower.size() < nPar || params.upper.size() < nPar)
+    return false;
+
+  std::size_t nUsed = 0;
+  for (int tick = firstTick; tick <= lastTick; ++tick)
+    if (signal[tick] != 0.) ++nUsed;
+
+  if (nUsed <= nPar) return false;
+
+  // only grows: after the first few fits no more allocations happen here
+  if (workspace.alpha.size() < nPar * nPar) {
+    workspace.alpha.resize(nPar * nPar);
+    workspace.work.resize(nPar * nPar);
+  }
+  if (workspace.par.size() < nPar) {
+    for (auto* v : {&workspace.beta,
+                    &workspace.step,
+                    &workspace.par,
+                    &workspace.trial,
+                    &workspace.jac})
+      v->resize(nPar);
+    workspace.idx.resize(nPar);
+  }
+
+  auto& par = workspace.par;
+  auto& trial = workspace.trial;
+  auto& step = workspace.step;
+  auto& work = workspace.work;
+  auto const& alpha = workspace.alpha;
+  auto const& beta = workspace.beta;
+
+  auto clamp = [&params, nPar](std::vector<double>& p) {
+    for (std::size_t k = 0; k < nPar; ++k)
+      p[k] = std::min(std::max(p[k], params.lower[k]), params.upper[k]);
+  };
+
+  std::copy(params.value.begin(), params.value.begin() + nPar, par.begin());
+  clamp(par);
+
+  double chi2 = accumulate(signal, firstTick, lastTick, params, par, workspace);
+  double lambda = fConfig.initialLambda;
+
+  if (!std::isfinite(chi2)) return false;
+
+  while (params.iterations++ < fConfig.maxIterations) {
+    // damped normal matrix (lower triangle is all the decomposition needs)
+    for (std::size_t i = 0; i < nPar; ++i) {
+      for (std::size_t j = 0; j < i; ++j)
+        work[i * nPar + j] = alpha[i * nPar + j];
+      double const diag = alpha[i * nPar + i];
+      work[i * nPar + i] = diag * (1. + lambda) + std::numeric_limits<double>::min();
+    }
+
+    if (!choleskyDecompose(work, nPar)) {
+      lambda *= 10.;
+      if (lambda > fConfig.maxLambda) break;
+      continue;
+    }
+
+    std::copy(beta.begin(), beta.begin() + nPar, step.begin());
+    choleskySolve(work, nPar, step);
+
+    for (std::size_t k = 0; k < nPar; ++k)
+      trial[k] = par[k] + step[k];
+    clamp(trial);
+
+    double const trialChi2 = chiSquare(signal, firstTick, lastTick, params, trial);
+
+    if (std::isfinite(trialChi2) && trialChi2 < chi2) {
+      bool const converged = chi2 - trialChi2 <= fConfig.chi2Tolerance * chi2;
+
+      std::copy(trial.begin(), trial.begin() + nPar, par.begin());
+      chi2 = accumulate(signal, firstTick, lastTick, params, par, workspace);
+      lambda = std::max(0.1 * lambda, 1.e-12);
+
+      if (converged) break;
+    }
+    else {
+      // no improvement possible even with a tiny step: we are at the minimum
+      lambda *= 10.;
+      if (lambda > fConfig.maxLambda) break;
+    }
+  }
+
+  if (!std::isfinite(chi2)) return false;
+
+  int const ndf = int(nUsed) - int(nPar);
+
+  std::copy(par.begin(), par.begin() + nPar, params.value.begin());
+  params.chi2 = chi2;
+  params.ndf = ndf;
+
+  // the covariance is the inverse of the (undamped) normal matrix; since the
+  // samples carry no uncertainty, errors are normalised to chi2/ndf. A pulse
+  // pushed far out of the range leaves the matrix singular: the fit is still
+  // good, only its errors are unknown
+  std::copy(alpha.begin(), alpha.begin() + nPar * nPar, work.begin());
+  if (!choleskyDecompose(work, nPar)) return true;
+
+  double const errorScale = chi2 / ndf;
+  for (std::size_t k = 0; k < nPar; ++k) {
+    std::fill(step.begin(), step.begin() + nPar, 0.);
+    step[k] = 1.;
+    choleskySolve(work, nPar, step);
+    params.error[k] = std::sqrt(std::max(step[k] * errorScale, 0.));
+  }
+
+  return true;
+}
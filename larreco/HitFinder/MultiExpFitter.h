@@ -0,0 +1,139 @@
+#ifndef MULTIEXPFITTER_H
+#define MULTIEXPFITTER_H
+
+/*!
+ * Title:   MultiExpFitter Class
+ *
+ * Description:
+ * Self-contained Levenberg-Marquardt least squares fit of a sum of N
+ * asymmetric exponential pulses, as used by DPRawHitFinder:
+ *
+ *   f(x) = sum_i A_i * exp(0.4*(x-t_i)/tau1_i) / (1 + exp(0.4*(x-t_i)/tau2_i))
+ *
+ * The Jacobian is computed analytically. The fitter itself is stateless and
+ * can be shared by any number of threads; the work space of a fit lives in a
+ * Workspace object which the caller keeps (one per thread) and which is only
+ * resized when a fit with more parameters than ever before comes along.
+ *
+ * The parameter layout follows the one of the ROOT formula it replaces: with
+ * the same shape for all the pulses, (tau1, tau2) followed by (A, t0) for each
+ * pulse, otherwise (tau1, tau2, A, t0) for each pulse. Sample at tick i is
+ * evaluated at the bin center, x = i + 0.5, and samples with exactly zero
+ * content are skipped (as ROOT does with option "W").
+ *
+ * Input:  Signal (pointer to contiguous floats, indexed by tick), tick range,
+ *         starting parameters and limits
+ * Output: Fitted parameters, their errors, chi2 and number of degrees of freedom
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace hit {
+
+  class MultiExpFitter {
+  public:
+    struct Config {
+      unsigned int maxIterations = 200; ///< maximum number of accepted + rejected steps
+      double chi2Tolerance = 1.e-7;     ///< relative chi2 change to declare convergence
+      double initialLambda = 1.e-3;     ///< initial Marquardt damping
+      double maxLambda = 1.e10;         ///< damping at which we consider the minimum found
+    };
+
+    /// Parameters (input and output) of a fit, in the layout described above.
+    struct FitParams {
+      std::size_t nPeaks = 0;
+      bool sameShape = true;
+      std::vector<double> value;
+      std::vector<double> lower;
+      std::vector<double> upper;
+      std::vector<double> error;
+      double chi2 = 0.;
+      int ndf = 0;
+      unsigned int iterations = 0;
+
+      /// Sets the number of pulses and the layout; keeps the allocated memory.
+      void resize(std::size_t nPeaks, bool sameShape);
+    };
+
+    /// Scratch memory of a fit; grows as needed and is reused by the next fits.
+    struct Workspace {
+      std::vector<double> alpha; ///< normal matrix
+      std::vector<double> work;  ///< damped normal matrix and its decomposition
+      std::vector<double> beta;
+      std::vector<double> step;
+      std::vector<double> par;
+      std::vector<double> trial;
+      std::vector<double> jac;
+      std::vector<std::size_t> idx;
+    };
+
+    MultiExpFitter() = default;
+    explicit MultiExpFitter(Config const& config) : fConfig(config) {}
+
+    static std::size_t NParams(std::size_t nPeaks, bool sameShape)
+    {
+      return sameShape ? 2 + 2 * nPeaks : 4 * nPeaks;
+    }
+    static std::size_t Tau1Index(std::size_t iPeak, bool sameShape)
+    {
+      return sameShape ? 0 : 4 * iPeak;
+    }
+    static std::size_t Tau2Index(std::size_t iPeak, bool sameShape)
+    {
+      return sameShape ? 1 : 4 * iPeak + 1;
+    }
+    static std::size_t AmplitudeIndex(std::size_t iPeak, bool sameShape)
+    {
+      return sameShape ? 2 * iPeak + 2 : 4 * iPeak + 2;
+    }
+    static std::size_t PeakTimeIndex(std::size_t iPeak, bool sameShape)
+    {
+      return sameShape ? 2 * iPeak + 3 : 4 * iPeak + 3;
+    }
+
+    /// Fits the samples from `firstTick` to `lastTick` (included) of `signal`;
+    /// returns false on failure.
+    bool Fit(float const* signal,
+             int firstTick,
+             int lastTick,
+             FitParams& params,
+             Workspace& workspace) const;
+
+    /// Value of a single pulse at position `x`.
+    static double Pulse(double x, double amplitude, double t0, double tau1, double tau2);
+
+    /// Value of the model with parameters `params` at position `x`.
+    static double Evaluate(FitParams const& params, double x);
+
+    /// Position of the maximum of a single pulse within [xMin, xMax].
+    static double PulseMaximumX(double t0, double tau1, double tau2, double xMin, double xMax);
+
+  private:
+    /// Fills the (lower half of the) normal matrix and gradient, returns chi2.
+    double accumulate(float const* signal,
+                      int firstTick,
+                      int lastTick,
+                      FitParams const& params,
+                      std::vector<double> const& par,
+                      Workspace& workspace) const;
+
+    /// Only computes chi2 for the parameters `par`.
+    double chiSquare(float const* signal,
+                     int firstTick,
+                     int lastTick,
+                     FitParams const& params,
+                     std::vector<double> const& par) const;
+
+    /// In place Cholesky decomposition of the n x n matrix (lower triangle).
+    static bool choleskyDecompose(std::vector<double>& a, std::size_t n);
+
+    /// Solves L L^T x = b in place given the decomposed matrix.
+    static void choleskySolve(std::vector<double> const& l, std::size_t n, std::vector<double>& b);
+
+    Config fConfig;
+  };
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*!
+ * Title:   MultiGausFitter Class
+ *
+ * Description:
+ * Levenberg-Marquardt fit of a sum of Gaussians plus baseline, see
+ * MultiGausFitter.h for the conventions used.
+*/
+
+#include "larreco/HitFinder/MultiGausFitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+  // beyond this value of z^2/2 a Gaussian contributes less than ~1e-22 of its
+  // amplitude, so it (and its derivatives) is dropped from the sample
+  constexpr double kMaxHalfZ2 = 50.;
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiGausFitter::Evaluate(FitParams const& params, double x)
+{
+  double value = params.value[3 * params.nGaus];
+  for (std::size_t iGaus = 0; iGaus < params.nGaus; ++iGaus) {
+    double const z = (x - params.value[3 * iGaus + 1]) / params.value[3 * iGaus + 2];
+    value += params.value[3 * iGaus] * std::exp(-0.5 * z * z);
+  }
+  return value;
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiGausFitter::accumulate(float const* signal,
+                                        std::size_t nBins,
+                                        std::size_t nGaus,
+                                        std::size_t nFree,
+                                        Vector_t const& par,
+                                        Matrix_t& alpha,
+                                        Vector_t& beta) const
+{
+  std::fill(alpha.begin(), alpha.begin() + nFree * nFree, 0.);
+  std::fill(beta.begin(), beta.begin() + nFree, 0.);
+
+  // derivatives of the model for this sample, packed with their parameter index
+  std::array<double, kMaxParams> jac;
+  std::array<std::size_t, kMaxParams> idx;
+
+  double chi2 = 0.;
+
+  for (std::size_t bin = 0; bin < nBins; ++bin) {
+    double const y = signal[bin];
+    if (y == 0.) continue;
+
+    double const x = bin + 0.5;
+    double model = par[3 * nGaus];
+    std::size_t nActive = 0;
+
+    for (std::size_t iGaus = 0; iGaus < nGaus; ++iGaus) {
+      double const amp = par[3 * iGaus];
+      double const invSigma = 1. / par[3 * iGaus + 2];
+      double const z = (x - par[3 * iGaus + 1]) * invSigma;
+      double const halfZ2 = 0.5 * z * z;
+
+      if (halfZ2 > kMaxHalfZ2) continue;
+
+      double const e = std::exp(-halfZ2);
+      double const g = amp * e;
+
+      model += g;
+
+      idx[nActive] = 3 * iGaus;
+      jac[nActive++] = e;
+      idx[nActive] = 3 * iGaus + 1;
+      jac[nActive++] = g * z * invSigma;
+      idx[nActive] = 3 * iGaus + 2;
+      jac[nActive++] = g * z * z * invSigma;
+    }
+
+    if (nFree > 3 * nGaus) {
+      idx[nActive] = 3 * nGaus;
+      jac[nActive++] = 1.;
+    }
+
+    double const residual = y - model;
+
+    chi2 += residual * residual;
+
+    // indices are increasing, so (a, b <= a) always lands in the lower triangle
+    for (std::size_t a = 0; a < nActive; ++a) {
+      double const ja = jac[a];
+      double* row = alpha.data() + idx[a] * nFree;
+
+      beta[idx[a]] += ja * residual;
+
+      for (std::size_t b = 0; b <= a; ++b)
+        row[idx[b]] += ja * jac[b];
+    }
+  }
+
+  return chi2;
+}
+
+//------------------------------------------------------------------------------
+double hit::MultiGausFitter::chiSquare(float const* signal,
+                                       std::size_t nBins,
+                                       std::size_t nGaus,
+                                       Vector_t const& par) const
+{
+  double chi2 = 0.;
+
+  for (std::size_t bin = 0; bin < nBins; ++bin) {
+    double const y = signal[bin];
+    if (y == 0.) continue;
+
+    double const x = bin + 0.5;
+    double model = par[3 * nGaus];
+
+    for (std::size_t iGaus = 0; iGaus < nGaus; ++iGaus) {
+      double const z = (x - par[3 * iGaus + 1]) / par[3 * iGaus + 2];
+      double const halfZ2 = 0.5 * z * z;
+      if (halfZ2 <= kMaxHalfZ2) model += par[3 * iGaus] * std::exp(-halfZ2);
+    }
+
+    double const residual = y - model;
+    chi2 += residual * residual;
+  }
+
+  return chi2;
+}
+
+//------------------------------------------------------------------------------
+bool hit::MultiGausFitter::choleskyDecompose(Matrix_t& a, std::size_t n)
+{
+  for (std::size_t j = 0; j < n; ++j) {
+    double* rowJ = a.data() + j * n;
+    double diag = rowJ[j];
+
+    for (std::size_t k = 0; k < j; ++k)
+      diag -= rowJ[k] * rowJ[k];
+
+    if (!(diag > 0.)) return false;
+
+    double const ljj = std::sqrt(diag);
+    rowJ[j] = ljj;
+
+    for (std::size_t i = j + 1; i < n; ++i) {
+      double* rowI = a.data() + i * n;
+      double sum = rowI[j];
+
+      for (std::size_t k = 0; k < j; ++k)
+        sum -= rowI[k] * rowJ[k];
+
+      rowI[j] = sum / ljj;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void hit::MultiGausFitter::choleskySolve(Matrix_t const& l, std::size_t n, Vector_t& b)
+{
+  // forward substitution: L y = b
+  for (std::size_t i = 0; i < n; ++i) {
+    double const* rowI = l.data() + i * n;
+    double sum = b[i];
+    for (std::size_t k = 0; k < i; ++k)
+      sum -= rowI[k] * b[k];
+    b[i] = sum / rowI[i];
+  }
+
+  // back substitution: L^T x = y
+  for (std::size_t i = n; i-- > 0;) {
+    double sum = b[i];
+    for (std::size_t k = i + 1; k < n; ++k)
+      sum -= l[k * n + i] * b[k];
+    b[i] = sum / l[i * n + i];
+  }
+}
+
+//------------------------------------------------------------------------------
+bool hit::MultiGausFitter::Fit(float const* signal, std::size_t nBins, FitParams& params) const
+{
+  std::size_t const nGaus = params.nGaus;
+
+  params.iterations = 0;
+
+  if (nGaus == 0 || nGaus > kMaxGaussians) return false;
+
+  std::size_t const nFree = 3 * nGaus + (params.floatBaseline ? 1 : 0);
+
+  std::size_t nUsed = 0;
+  for (std::size_t bin = 0; bin < nBins; ++bin)
+    if (signal[bin] != 0.) ++nUsed;
+
+  if (nUsed <= nFree) return false;
+
+  Vector_t par;
+  std::copy(params.value.begin(), params.value.end(), par.begin());
+
+  auto clamp = [&params, nFree](Vector_t& p) {
+    for (std::size_t k = 0; k < nFree; ++k)
+      p[k] = std::min(std::max(p[k], params.lower[k]), params.upper[k]);
+  };
+
+  clamp(par);
+
+  Matrix_t alpha;
+  Matrix_t work;
+  Vector_t beta;
+  Vector_t step;
+  Vector_t trial = par;
+
+  double chi2 = accumulate(signal, nBins, nGaus, nFree, par, alpha, beta);
+  double lambda = fConfig.initialLambda;
+
+  if (!std::isfinite(chi2)) return false;
+
+  while (params.iterations++ < fConfig.maxIterations) {
+    // damped normal matrix (lower triangle is all the decomposition needs)
+    for (std::size_t i = 0; i < nFree; ++i) {
+      for (std::size_t j = 0; j < i; ++j)
+        work[i * nFree + j] = alpha[i * nFree + j];
+      double const diag = alpha[i * nFree + i];
+      work[i * nFree + i] = diag * (1. + lambda) + std::numeric_limits<double>::min();
+    }
+
+    if (!choleskyDecompose(work, nFree)) {
+      lambda *= 10.;
+      if (lambda > fConfig.maxLambda) break;
+      continue;
+    }
+
+    std::copy(beta.begin(), beta.begin() + nFree, step.begin());
+    choleskySolve(work, nFree, step);
+
+    for (std::size_t k = 0; k < nFree; ++k)
+      trial[k] = par[k] + step[k];
+    clamp(trial);
+
+    double const trialChi2 = chiSquare(signal, nBins, nGaus, trial);
+
+    if (std::isfinite(trialChi2) && trialChi2 < chi2) {
+      bool const converged = chi2 - trialChi2 <= fConfig.chi2Tolerance * chi2;
+
+      par = trial;
+      chi2 = accumulate(signal, nBins, nGaus, nFree, par, alpha, beta);
+      lambda = std::max(0.1 * lambda, 1.e-12);
+
+      if (converged) break;
+    }
+    else {
+      // no improvement possible even with a tiny step: we are at the minimum
+      lambda *= 10.;
+      if (lambda > fConfig.maxLambda) break;
+    }
+  }
+
+  if (!std::isfinite(chi2)) return false;
+
+  // the covariance is the inverse of the (undamped) normal matrix; since the
+  // samples carry no uncertainty, errors are normalised to chi2/ndf
+  std::copy(alpha.begin(), alpha.begin() + nFree * nFree, work.begin());
+  if (!choleskyDecompose(work, nFree)) return false;
+
+  int const ndf = int(nUsed) - int(nFree);
+  double const errorScale = chi2 / ndf;
+
+  params.error.fill(0.);
+  for (std::size_t k = 0; k < nFree; ++k) {
+    step.fill(0.);
+    step[k] = 1.;
+    choleskySolve(work, nFree, step);
+    params.error[k] = std::sqrt(std::max(step[k] * errorScale, 0.));
+  }
+
+  std::copy(par.begin(), par.begin() + nFree, params.value.begin());
+  params.chi2 = chi2;
+  params.ndf = ndf;
+
+  return true;
+}
@@ -0,0 +1,92 @@
+#ifndef MULTIGAUSFITTER_H
+#define MULTIGAUSFITTER_H
+
+/*!
+ * Title:   MultiGausFitter Class
+ *
+ * Description:
+ * Self-contained Levenberg-Marquardt least squares fit of a sum of N Gaussians
+ * plus a (fixed or floating) baseline to a sampled waveform. The Jacobian is
+ * computed analytically and all the work space lives on the stack, sized for
+ * at most kMaxGaussians peaks, so that a single (const) instance can be shared
+ * by any number of threads.
+ *
+ * The parameter layout follows the one of the ROOT based fit in
+ * PeakFitterGaussian: (amplitude, mean, sigma) for each Gaussian, followed by
+ * the baseline. Sample i is evaluated at the bin center, x = i + 0.5, and
+ * samples with exactly zero content are skipped (as ROOT does with option "W").
+ *
+ * Input:  Signal (pointer to contiguous floats), starting parameters and limits
+ * Output: Fitted parameters, their errors, chi2 and number of degrees of freedom
+*/
+
+#include <array>
+#include <cstddef>
+
+namespace hit {
+
+  class MultiGausFitter {
+  public:
+    static constexpr std::size_t kMaxGaussians = 16;
+    static constexpr std::size_t kMaxParams = 3 * kMaxGaussians + 1;
+
+    struct Config {
+      unsigned int maxIterations = 100; ///< maximum number of accepted + rejected steps
+      double chi2Tolerance = 1.e-6;     ///< relative chi2 change to declare convergence
+      double initialLambda = 1.e-3;     ///< initial Marquardt damping
+      double maxLambda = 1.e10;         ///< damping at which we consider the minimum found
+    };
+
+    /// Parameters (input and output) of a fit; baseline is at index 3*nGaus.
+    struct FitParams {
+      std::size_t nGaus = 0;
+      bool floatBaseline = false;
+      std::array<double, kMaxParams> value{};
+      std::array<double, kMaxParams> lower{};
+      std::array<double, kMaxParams> upper{};
+      std::array<double, kMaxParams> error{};
+      double chi2 = 0.;
+      int ndf = 0;
+      unsigned int iterations = 0;
+    };
+
+    MultiGausFitter() = default;
+    explicit MultiGausFitter(Config const& config) : fConfig(config) {}
+
+    /// Fits `nBins` samples starting at `signal`; returns false on failure.
+    bool Fit(float const* signal, std::size_t nBins, FitParams& params) const;
+
+    /// Value of the model with parameters `params` at position `x`.
+    static double Evaluate(FitParams const& params, double x);
+
+  private:
+    using Matrix_t = std::array<double, kMaxParams * kMaxParams>;
+    using Vector_t = std::array<double, kMaxParams>;
+
+    /// Fills the lower triangle of the normal matrix and the gradient, returns chi2.
+    double accumulate(float const* signal,
+                      std::size_t nBins,
+                      std::size_t nGaus,
+                      std::size_t nFree,
+                      Vector_t const& par,
+                      Matrix_t& alpha,
+                      Vector_t& beta) const;
+
+    /// Only computes chi2 for the parameters `par`.
+    double chiSquare(float const* signal,
+                     std::size_t nBins,
+                     std::size_t nGaus,
+                     Vector_t const& par) const;
+
+    /// In place Cholesky decomposition of the n x n matrix (lower triangle).
+    static bool choleskyDecompose(Matrix_t& a, std::size_t n);
+
+    /// Solves L L^T x = b in place given the decomposed matrix.
+    static void choleskySolve(Matrix_t const& l, std::size_t n, Vector_t& b);
+
+    Config fConfig;
+  };
+
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ *  @file   StageMonitor.cxx
+ *
+ *  @brief  Implementation of the stage timing and counting facility
+ *
+ */
+
+#include "larreco/Monitoring/StageMonitor.h"
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+  /// Sort key keeping each stage right after its parent and before its siblings' subtrees
+  std::string hierarchyKey(std::string path)
+  {
+    std::replace(path.begin(), path.end(), '/', '\x01');
+    return path;
+  }
+
+  std::string jsonEscaped(std::string const& text)
+  {
+    std::string escaped;
+    for (char const c : text) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  std::string csvQuoted(std::string const& text)
+  {
+    if (text.find_first_of(",\"") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (char const c : text) {
+      if (c == '"') quoted += '"';
+      quoted += c;
+    }
+    return quoted + '"';
+  }
+
+} // namespace
+
+namespace lar {
+
+  StageMonitor::StageID StageMonitor::Stage(std::string const& path)
+  {
+    std::lock_guard<std::mutex> lock(fStagesMutex);
+
+    auto const found = std::find(fStageNames.begin(), fStageNames.end(), path);
+    if (found != fStageNames.end()) return std::distance(fStageNames.begin(), found);
+
+    fStageNames.push_back(path);
+    return fStageNames.size() - 1;
+  }
+
+  void StageMonitor::Record(StageID stage, double seconds, std::uint64_t items)
+  {
+    StageStats& stats = localStats(stage);
+
+    stats.calls++;
+    stats.items += items;
+    stats.totalTime += seconds;
+    stats.maxTime = std::max(stats.maxTime, seconds);
+    stats.bins[binIndex(seconds)]++;
+  }
+
+  void StageMonitor::Count(StageID stage, std::uint64_t items) { localStats(stage).items += items; }
+
+  StageMonitor::StageStats& StageMonitor::localStats(StageID stage)
+  {
+    // Stages are registered up front, so this only grows the first few times a thread records
+    std::vector<StageStats>& threadStats = fThreadStats.local();
+    if (stage >= threadStats.size()) threadStats.resize(stage + 1);
+    return threadStats[stage];
+  }
+
+  std::size_t StageMonitor::binIndex(double seconds)
+  {
+    if (!(seconds > 0.)) return 0;
+
+    double const position = (std::log2(seconds) - kMinExponent) * kBinsPerOctave;
+    if (position < 0.) return 0;
+    return std::min(static_cast<std::size_t>(position), kNumBins - 1);
+  }
+
+  double StageMonitor::binCentre(std::size_t bin)
+  {
+    return std::exp2(kMinExponent + (bin + 0.5) / kBinsPerOctave);
+  }
+
+  std::vector<StageMonitor::StageSummary> StageMonitor::Summary() const
+  {
+    std::vector<std::string> stageNames;
+    {
+      std::lock_guard<std::mutex> lock(fStagesMutex);
+      stageNames = fStageNames;
+    }
+
+    // Merge the statistics of the threads
+    std::vector<StageStats> merged(stageNames.size());
+    for (std::vector<StageStats> const& threadStats : fThreadStats) {
+      for (std::size_t stage = 0; stage < threadStats.size(); stage++) {
+        StageStats const& stats = threadStats[stage];
+        StageStats& total = merged[stage];
+
+        total.calls += stats.calls;
+        total.items += stats.items;
+        total.totalTime += stats.totalTime;
+        total.maxTime = std::max(total.maxTime, stats.maxTime);
+        for (std::size_t bin = 0; bin < kNumBins; bin++)
+          total.bins[bin] += stats.bins[bin];
+      }
+    }
+
+    auto percentile = [](StageStats const& stats, double fraction) {
+      if (stats.calls == 0) return 0.;
+
+      auto const rank = std::max<std::uint64_t>(1, std::ceil(fraction * stats.calls));
+      std::uint64_t seen = 0;
+      for (std::size_t bin = 0; bin < kNumBins; bin++) {
+        seen += stats.bins[bin];
+        if (seen >= rank) return std::min(binCentre(bin), stats.maxTime);
+      }
+      return stats.maxTime;
+    };
+
+    std::vector<StageSummary> summary;
+    summary.reserve(stageNames.size());
+    for (std::size_t stage = 0; stage < stageNames.size(); stage++) {
+      StageStats const& stats = merged[stage];
+      StageSummary entry;
+
+      entry.name = stageNames[stage];
+      auto const lastSlash = entry.name.rfind('/');
+      if (lastSlash != std::string::npos) entry.parent = entry.name.substr(0, lastSlash);
+      entry.depth = std::count(entry.name.begin(), entry.name.end(), '/');
+      entry.calls = stats.calls;
+      entry.items = stats.items;
+      entry.totalTime = stats.totalTime;
+      entry.meanTime = stats.calls > 0 ? stats.totalTime / stats.calls : 0.;
+      entry.p50Time = percentile(stats, 0.50);
+      entry.p95Time = percentile(stats, 0.95);
+      entry.maxTime = stats.maxTime;
+
+      summary.push_back(std::move(entry));
+    }
+
+    std::sort(summary.begin(), summary.end(), [](StageSummary const& a, StageSummary const& b) {
+      return hierarchyKey(a.name) < hierarchyKey(b.name);
+    });
+
+    return summary;
+  }
+
+  void StageMonitor::WriteJSON(std::ostream& out) const
+  {
+    auto const flags = out.flags();
+    auto const precision = out.precision(9);
+
+    out << "{\n  \"stages\": [";
+    bool first = true;
+    for (StageSummary const& stage : Summary()) {
+      out << (first ? "\n" : ",\n") << "    {\"name\": \"" << jsonEscaped(stage.name) << "\""
+          << ", \"parent\": \"" << jsonEscaped(stage.parent) << "\""
+          << ", \"depth\": " << stage.depth << ", \"calls\": " << stage.calls
+          << ", \"items\": " << stage.items << ", \"total_s\": " << stage.totalTime
+          << ", \"mean_s\": " << stage.meanTime << ", \"p50_s\": " << stage.p50Time
+          << ", \"p95_s\": " << stage.p95Time << ", \"max_s\": " << stage.maxTime << "}";
+      first = false;
+    }
+    out << "\n  ]\n}\n";
+
+    out.precision(precision);
+    out.flags(flags);
+  }
+
+  void StageMonitor::WriteCSV(std::ostream& out) const
+  {
+    auto const flags = out.flags();
+    auto const precision = out.precision(9);
+
+    out << "stage,parent,depth,calls,items,total_s,mean_s,p50_s,p95_s,max_s\n";
+    for (StageSummary const& stage : Summary()) {
+      out << csvQuoted(stage.name) << ',' << csvQuoted(stage.parent) << ',' << stage.depth << ','
+          << stage.calls << ',' << stage.items << ',' << stage.totalTime << ',' << stage.meanTime
+          << ',' << stage.p50Time << ',' << stage.p95Time << ',' << stage.maxTime << '\n';
+    }
+
+    out.precision(precision);
+    out.flags(flags);
+  }
+
+  void StageMonitor::WriteTable(std::ostream& out) const
+  {
+    auto const flags = out.flags();
+    auto const precision = out.precision();
+
+    out << std::left << std::setw(40) << "Stage" << std::right << std::setw(10) << "calls"
+        << std::setw(12) << "items" << std::setw(12) << "total [s]" << std::setw(12)
+        << "p50 [ms]" << std::setw(12) << "p95 [ms]" << std::setw(12) << "max [ms]\n";
+    out << std::fixed;
+    for (StageSummary const& stage : Summary()) {
+      // Children are indented under their parent and show only the last element of the path
+      std::string const label =
+        std::string(2 * stage.depth, ' ') +
+        (stage.parent.empty() ? stage.name : stage.name.substr(stage.parent.size() + 1));
+      out << std::left << std::setw(40) << label << std::right << std::setw(10) << stage.calls
+          << std::setw(12) << stage.items << std::setprecision(3) << std::setw(12)
+          << stage.totalTime << std::setw(12) << 1000. * stage.p50Time << std::setw(12)
+          << 1000. * stage.p95Time << std::setw(11) << 1000. * stage.maxTime << '\n';
+    }
+
+    out.precision(precision);
+    out.flags(flags);
+  }
+
+} // namespace lar
@@ -0,0 +1,165 @@
+/**
+ *  @file   StageMonitor.h
+ *
+ *  @brief  Time spent in, and items processed by, the named stages of a job
+ *
+ *          Stages are named by paths such as "Cluster3D/PathFinding", the parent of a stage
+ *          being its path without the last element. A StageTimer records the time of the scope
+ *          it lives in to one stage. Each thread accumulates into its own copy of the
+ *          statistics so recording takes no lock; registering a stage does, and is meant to be
+ *          done once, when a module is constructed.
+ *
+ *          Durations are kept in a histogram with eight bins per factor of two, from which the
+ *          percentiles of the summary are read to within about 5%. Totals and maxima are exact.
+ *
+ */
+#ifndef StageMonitor_h
+#define StageMonitor_h
+
+// TBB includes
+#include "tbb/enumerable_thread_specific.h"
+
+// std includes
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lar {
+
+  class StageMonitor {
+  public:
+    using StageID = std::size_t;
+
+    /**
+     *  @brief  Statistics of one stage over the whole job, summed over the threads
+     */
+    struct StageSummary {
+      std::string name;       ///< Path of the stage
+      std::string parent;     ///< Path of the parent stage, empty at the top
+      unsigned int depth = 0; ///< Number of ancestors
+      std::uint64_t calls = 0;
+      std::uint64_t items = 0;
+      double totalTime = 0.; ///< Seconds
+      double meanTime = 0.;
+      double p50Time = 0.;
+      double p95Time = 0.;
+      double maxTime = 0.;
+    };
+
+    StageMonitor() = default;
+
+    StageMonitor(const StageMonitor&) = delete;
+    StageMonitor& operator=(const StageMonitor&) = delete;
+
+    /**
+     *  @brief  The identifier of the stage with the given path, registered on the first request
+     */
+    StageID Stage(std::string const& path);
+
+    /**
+     *  @brief  Adds one call to a stage
+     *
+     *  @param  stage    The stage
+     *  @param  seconds  Duration of the call
+     *  @param  items    Number of items processed by the call
+     */
+    void Record(StageID stage, double seconds, std::uint64_t items = 0);
+
+    /**
+     *  @brief  Adds items to a stage without counting a call
+     */
+    void Count(StageID stage, std::uint64_t items);
+
+    /**
+     *  @brief  The statistics of every stage, each parent followed by its children
+     *
+     *          Must not be called while other threads record.
+     */
+    std::vector<StageSummary> Summary() const;
+
+    /**
+     *  @brief  Write the summary as JSON, CSV, or a table for the log
+     */
+    void WriteJSON(std::ostream& out) const;
+    void WriteCSV(std::ostream& out) const;
+    void WriteTable(std::ostream& out) const;
+
+  private:
+    static constexpr int kBinsPerOctave = 8;
+    static constexpr int kMinExponent = -30; ///< Durations below 2^-30 s (1 ns) share the first bin
+    static constexpr int kMaxExponent = 12;  ///< Durations above 2^12 s share the last bin
+    static constexpr std::size_t kNumBins = (kMaxExponent - kMinExponent) * kBinsPerOctave;
+
+    struct StageStats {
+      std::uint64_t calls = 0;
+      std::uint64_t items = 0;
+      double totalTime = 0.;
+      double maxTime = 0.;
+      std::array<std::uint64_t, kNumBins> bins{};
+    };
+
+    StageStats& localStats(StageID stage);
+
+    static std::size_t binIndex(double seconds);
+    static double binCentre(std::size_t bin);
+
+    mutable std::mutex fStagesMutex;
+    std::vector<std::string> fStageNames;
+    tbb::enumerable_thread_specific<std::vector<StageStats>> fThreadStats;
+  };
+
+  /**
+   *  @brief  Times its own lifetime and records it to a stage, if there is a monitor
+   *
+   *          The time is kept without a monitor too, so a caller can still use Stop().
+   */
+  class StageTimer {
+  public:
+    StageTimer(StageMonitor* monitor, StageMonitor::StageID stage)
+      : fMonitor(monitor), fStage(stage), fStart(Clock_t::now())
+    {}
+
+    ~StageTimer() { Stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    /**
+     *  @brief  Items processed within the scope, recorded with the time
+     */
+    void AddItems(std::uint64_t items) { fItems += items; }
+
+    /**
+     *  @brief  Record now rather than at the end of the scope
+     *
+     *  @return The time elapsed since construction, in seconds
+     */
+    double Stop()
+    {
+      if (fRunning) {
+        fRunning = false;
+        fElapsed = std::chrono::duration<double>(Clock_t::now() - fStart).count();
+        if (fMonitor) fMonitor->Record(fStage, fElapsed, fItems);
+      }
+      return fElapsed;
+    }
+
+  private:
+    using Clock_t = std::chrono::steady_clock;
+
+    StageMonitor* fMonitor;
+    StageMonitor::StageID fStage;
+    Clock_t::time_point fStart;
+    std::uint64_t fItems = 0;
+    bool fRunning = true;
+    double fElapsed = 0.;
+  };
+
+} // namespace lar
+
+#endif
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////
+// \file StageMonitorService.h
+//
+// \brief Framework interface to StageMonitor: one monitor shared by all
+//        the modules of the job, summarised at the end of the job
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef STAGEMONITORSERVICE_H
+#define STAGEMONITORSERVICE_H
+
+// LArSoft Includes
+#include "larreco/Monitoring/StageMonitor.h"
+
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art/Framework/Services/Registry/ServiceRegistry.h"
+#include "art/Framework/Services/Registry/ServiceTable.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include <string>
+
+namespace lar {
+
+  class StageMonitorService {
+  public:
+    using provider_type = StageMonitor;
+
+    struct Config {
+      using Name = fhicl::Name;
+      using Comment = fhicl::Comment;
+
+      fhicl::Atom<std::string> JSONFileName{
+        Name("JSONFileName"),
+        Comment("file the summary is written to as JSON; none if empty"),
+        ""};
+      fhicl::Atom<std::string> CSVFileName{
+        Name("CSVFileName"),
+        Comment("file the summary is written to as CSV; none if empty"),
+        ""};
+      fhicl::Atom<bool> LogSummary{
+        Name("LogSummary"),
+        Comment("print the summary to the message logger at the end of the job"),
+        true};
+    };
+
+    using Parameters = art::ServiceTable<Config>;
+
+    StageMonitorService(Parameters const& config, art::ActivityRegistry& aReg);
+
+    provider_type* provider() { return &fProvider; }
+
+  private:
+    void postEndJob();
+
+    std::string fJSONFileName;
+    std::string fCSVFileName;
+    bool fLogSummary;
+
+    StageMonitor fProvider;
+  };
+
+  /// The monitor of the job, or nullptr if the service is not configured
+  inline StageMonitor* stageMonitorIfConfigured()
+  {
+    if (!art::ServiceRegistry::isAvailable<StageMonitorService>()) return nullptr;
+    return art::ServiceHandle<StageMonitorService>()->provider();
+  }
+
+}
+
+DECLARE_ART_SERVICE(lar::StageMonitorService, SHARED)
+
+#endif // STAGEMONITORSERVICE_H
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////
+// \file StageMonitorService_service.cc
+//
+// \brief Writes the summary of the stage monitor at the end of the job
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/Monitoring/StageMonitorService.h"
+
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace lar {
+
+  StageMonitorService::StageMonitorService(Parameters const& config, art::ActivityRegistry& aReg)
+    : fJSONFileName(config().JSONFileName())
+    , fCSVFileName(config().CSVFileName())
+    , fLogSummary(config().LogSummary())
+  {
+    aReg.sPostEndJob.watch(this, &StageMonitorService::postEndJob);
+  }
+
+  void StageMonitorService::postEndJob()
+  {
+    if (fLogSummary) {
+      std::ostringstream table;
+      fProvider.WriteTable(table);
+      mf::LogInfo("StageMonitorService") << "Time spent in the reconstruction stages:\n"
+                                         << table.str();
+    }
+
+    if (!fJSONFileName.empty()) {
+      std::ofstream out(fJSONFileName);
+      fProvider.WriteJSON(out);
+      if (!out)
+        mf::LogError("StageMonitorService")
+          << "Failed to write the stage summary to '" << fJSONFileName << "'";
+    }
+
+    if (!fCSVFileName.empty()) {
+      std::ofstream out(fCSVFileName);
+      fProvider.WriteCSV(out);
+      if (!out)
+        mf::LogError("StageMonitorService")
+          << "Failed to write the stage summary to '" << fCSVFileName << "'";
+    }
+  }
+
+}
+
+DEFINE_ART_SERVICE(lar::StageMonitorService)
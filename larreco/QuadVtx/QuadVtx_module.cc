@@ -1,11 +1,14 @@
 // Chris Backhouse - c.backhouse@ucl.ac.uk - Oct 2019
 
 #include "larreco/QuadVtx/HeatMap.h"
+#include "larreco/QuadVtx/RowTripleMax.h"
 
 // C/C++ standard libraries
 #include <iostream>
+#include <mutex>
 #include <random>
 #include <string>
+#include <tuple>
 
 // framework libraries
 #include "art/Framework/Core/EDProducer.h"
@@ -28,7 +31,11 @@
 #include "TGraph.h"
 #include "TH2F.h"
 #include "TMatrixD.h"
-#include "TVectorD.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+#include "tbb/parallel_reduce.h"
 
 namespace quad {
 
@@ -80,6 +87,11 @@ namespace quad {
 
     bool fSavePlots;
 
+    bool fCoarseToFine;
+    double fCoarseBinSize;
+    int fNCoarsePeaks;
+    double fRefineWindow;
+
     const geo::GeometryCore* geom;
   };
 
@@ -90,6 +102,10 @@ namespace quad {
     : EDProducer(pset)
     , fHitLabel(pset.get<std::string>("HitLabel"))
     , fSavePlots(pset.get<bool>("SavePlots"))
+    , fCoarseToFine(pset.get<bool>("CoarseToFine", false))
+    , fCoarseBinSize(pset.get<double>("CoarseBinSize", 5))
+    , fNCoarsePeaks(pset.get<int>("NCoarsePeaks", 3))
+    , fRefineWindow(pset.get<double>("RefineWindow", 10))
   {
     produces<std::vector<recob::Vertex>>();
   }
@@ -148,7 +164,7 @@ namespace quad {
 
           if (R > 0) {
             float z1, z2;
-            if (!IntersectsCircle(l.m, l.c, z0, x0, 2.5, z1, z2)) continue;
+            if (!IntersectsCircle(l.m, l.c, z0, x0, R, z1, z2)) continue;
             if (l.minz < z1 && l.minz < z2 && l.maxz > z1 && l.maxz > z2) continue;
           }
 
@@ -178,17 +194,20 @@ namespace quad {
   }
 
   // ---------------------------------------------------------------------------
-  void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm)
+  // Calls f(i, j0, jmax) for the lines i in [begin, end). [j0, jmax) are the lines
+  // after i that are not within 10 degrees of it. The window of a line doesn't
+  // depend on where the range starts, so ranges can be processed independently.
+  template <class F>
+  void ForEachPairWindow(const std::vector<Line2D>& lines,
+                         unsigned int begin,
+                         unsigned int end,
+                         F&& f)
   {
-    // This maximum is driven by runtime
-    constexpr size_t kMaxPts = 10 * 1000 * 1000;
-
     unsigned int j0 = 0;
     unsigned int jmax = 0;
 
-    long npts = 0;
-    for (unsigned int i = 0; i + 1 < lines.size(); ++i) {
-      const Line2D a = lines[i];
+    for (unsigned int i = begin; i < end && i + 1 < lines.size(); ++i) {
+      const Line2D& a = lines[i];
 
       j0 = std::max(j0, i + 1);
       while (j0 < lines.size() && CloseAngles(a.m, lines[j0].m))
@@ -197,8 +216,27 @@ namespace quad {
       while (jmax < lines.size() && !CloseAngles(a.m, lines[jmax].m))
         ++jmax;
 
-      npts += jmax - j0;
+      f(i, j0, jmax);
     }
+  }
+
+  // ---------------------------------------------------------------------------
+  void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm)
+  {
+    // This maximum is driven by runtime
+    constexpr size_t kMaxPts = 10 * 1000 * 1000;
+
+    const tbb::blocked_range<unsigned int> allLines(0, lines.size());
+
+    const long npts = tbb::parallel_reduce(
+      allLines,
+      0L,
+      [&](const tbb::blocked_range<unsigned int>& r, long n) {
+        auto count = [&n](unsigned int, unsigned int j0, unsigned int jmax) { n += jmax - j0; };
+        ForEachPairWindow(lines, r.begin(), r.end(), count);
+        return n;
+      },
+      std::plus<long>());
 
     const size_t product = (lines.size() * (lines.size() - 1)) / 2;
     const int stride = npts / kMaxPts + 1;
@@ -207,40 +245,60 @@ namespace quad {
 
     mf::LogInfo() << npts << " cf " << product << " ie " << double(npts) / product << std::endl;
 
-    j0 = 0;
-    jmax = 0;
-
-    for (unsigned int i = 0; i + 1 < lines.size(); ++i) {
-      const Line2D a = lines[i];
-
-      j0 = std::max(j0, i + 1);
-      while (j0 < lines.size() && CloseAngles(a.m, lines[j0].m))
-        ++j0;
-      jmax = std::max(jmax, j0);
-      while (jmax < lines.size() && !CloseAngles(a.m, lines[jmax].m))
-        ++jmax;
-
-      for (unsigned int j = j0; j < jmax; j += stride) {
-        const Line2D& b = lines[j];
+    // Each thread collects the bins it hits in a buffer of bounded size and adds
+    // them to the shared map a batch at a time, so the memory doesn't grow with
+    // the number of threads. The entries are integer counts, exact in float, so
+    // the sum doesn't depend on the order the batches are added in.
+    constexpr size_t kBatchSize = 16 * 1024;
+    std::mutex mapMutex;
+    auto flush = [&](std::vector<unsigned int>& bins) {
+      std::lock_guard<std::mutex> lock(mapMutex);
+      for (unsigned int bin : bins)
+        hm.map[bin] += stride;
+      bins.clear();
+    };
+
+    tbb::enumerable_thread_specific<std::vector<unsigned int>> threadBins;
+
+    tbb::parallel_for(allLines, [&](const tbb::blocked_range<unsigned int>& r) {
+      std::vector<unsigned int>& bins = threadBins.local();
+      bins.reserve(kBatchSize);
+
+      auto fill = [&](unsigned int i, unsigned int j0, unsigned int jmax) {
+        const Line2D& a = lines[i];
+
+        for (unsigned int j = j0; j < jmax; j += stride) {
+          const Line2D& b = lines[j];
+
+          // x = mA * z + cA = mB * z + cB
+          const float z = (b.c - a.c) / (a.m - b.m);
+          const float x = a.m * z + a.c;
+
+          // No solutions within a line
+          if ((z < a.minz || z > a.maxz) && (z < b.minz || z > b.maxz)) {
+            const int iz = hm.ZToBin(z);
+            const int ix = hm.XToBin(x);
+            if (iz >= 0 && iz < hm.Nz && ix >= 0 && ix < hm.Nx) {
+              bins.push_back(iz * hm.Nx + ix);
+              if (bins.size() == kBatchSize) flush(bins);
+            }
+          }
+        } // end for j
+      };
 
-        // x = mA * z + cA = mB * z + cB
-        const float z = (b.c - a.c) / (a.m - b.m);
-        const float x = a.m * z + a.c;
+      ForEachPairWindow(lines, r.begin(), r.end(), fill);
+    });
 
-        // No solutions within a line
-        if ((z < a.minz || z > a.maxz) && (z < b.minz || z > b.maxz)) {
-          const int iz = hm.ZToBin(z);
-          const int ix = hm.XToBin(x);
-          if (iz >= 0 && iz < hm.Nz && ix >= 0 && ix < hm.Nx) { hm.map[iz * hm.Nx + ix] += stride; }
-        }
-      } // end for i
-    }
+    for (std::vector<unsigned int>& bins : threadBins)
+      flush(bins);
   }
 
   // ---------------------------------------------------------------------------
   // Assumes that all three maps have the same vertical stride
+  // If score is given it is set to the summed map content at the peak.
   recob::tracking::Point_t FindPeak3D(const std::vector<HeatMap>& hs,
-                                      const std::vector<recob::tracking::Vector_t>& dirs) noexcept
+                                      const std::vector<recob::tracking::Vector_t>& dirs,
+                                      float* score = nullptr) noexcept
   {
     assert(hs.size() == 3);
     assert(dirs.size() == 3);
@@ -253,12 +311,21 @@ namespace quad {
     M(1, 0) = dirs[1].Y();
     M(1, 1) = dirs[1].Z();
 
+    if (score) *score = -1;
+
     // Singular, and stupid setup of exceptions means we can't test any other way
     if (M(0, 0) * M(1, 1) - M(1, 0) * M(0, 1) == 0) return {};
 
     M.Invert();
 
+    // r.Dot(d0) = z && r.Dot(d1) = u  =>  r = M * (z, u)
+    const double m00 = M(0, 0);
+    const double m01 = M(0, 1);
+    const double m10 = M(1, 0);
+    const double m11 = M(1, 1);
+
     float bestscore = -1;
+    int bestiz = -1, bestiu = -1, bestix = -1;
     recob::tracking::Point_t bestr;
 
     // Accumulate some statistics up front that will enable us to optimize
@@ -270,46 +337,121 @@ namespace quad {
       }
     }
 
-    for (int iz = 0; iz < hs[0].Nz; ++iz) {
-      const float z = hs[0].ZBinCenter(iz);
-      const float bonus = 1; // works badly... exp((hs[0].maxz-z)/1000.);
-
-      for (int iu = 0; iu < hs[1].Nz; ++iu) {
-        const float u = hs[1].ZBinCenter(iu);
-        // r.Dot(d0) = z && r.Dot(d1) = u
-        TVectorD p(2);
-        p(0) = z;
-        p(1) = u;
-        const TVectorD r = M * p;
-        const float v = r[0] * dirs[2].Y() + r[1] * dirs[2].Z();
-        const int iv = hs[2].ZToBin(v);
-        if (iv < 0 || iv >= hs[2].Nz) continue;
-        const double y = r(0);
-
-        // Even if the maxes were all at the same x we couldn't beat the record
-        if (colMax[0][iz] + colMax[1][iu] + colMax[2][iv] < bestscore) continue;
-
-        const float* h0 = &hs[0].map[Nx * iz];
-        const float* h1 = &hs[1].map[Nx * iu];
-        const float* h2 = &hs[2].map[Nx * iv];
-
-        int bestix = -1;
-        for (int ix = 1; ix < Nx - 1; ++ix) {
-          const float score = bonus * (h0[ix] + h1[ix] + h2[ix]);
-
-          if (score > bestscore) {
-            bestscore = score;
+    // Work through the u rows in blocks small enough to stay in L1 while all
+    // the z rows go past them. The v rows hit for one z row and a block of u
+    // rows are close together too.
+    constexpr int kTileBytes = 16 * 1024;
+    const int tile = std::max(1, kTileBytes / int(Nx * sizeof(float)));
+
+    for (int iu0 = 0; iu0 < hs[1].Nz; iu0 += tile) {
+      const int iu1 = std::min(hs[1].Nz, iu0 + tile);
+
+      for (int iz = 0; iz < hs[0].Nz; ++iz) {
+        const float z = hs[0].ZBinCenter(iz);
+        // A bonus factor exp((hs[0].maxz-z)/1000.) on the score works badly
+
+        for (int iu = iu0; iu < iu1; ++iu) {
+          const float u = hs[1].ZBinCenter(iu);
+          const double y = m00 * z + m01 * u;
+          const double r1 = m10 * z + m11 * u;
+          const float v = y * dirs[2].Y() + r1 * dirs[2].Z();
+          const int iv = hs[2].ZToBin(v);
+          if (iv < 0 || iv >= hs[2].Nz) continue;
+
+          // Even if the maxes were all at the same x we couldn't beat the record
+          if (colMax[0][iz] + colMax[1][iu] + colMax[2][iv] < bestscore) continue;
+
+          float rowscore;
+          const int ix = RowTripleMax(
+            &hs[0].map[Nx * iz], &hs[1].map[Nx * iu], &hs[2].map[Nx * iv], 1, Nx - 1, rowscore);
+          if (ix < 0) continue;
+
+          // Ties go to the first bin in (z, u, x) order, as they would in a
+          // plain loop over z, u and x
+          if (rowscore > bestscore ||
+              (rowscore == bestscore && bestiz >= 0 &&
+               std::tie(iz, iu, ix) < std::tie(bestiz, bestiu, bestix))) {
+            bestscore = rowscore;
+            bestiz = iz;
+            bestiu = iu;
             bestix = ix;
+            bestr.SetXYZ(hs[0].XBinCenter(ix), y, z);
           }
-        } // end for dx
+        } // end for u
+      }   // end for z
+    }     // end for u blocks
 
-        if (bestix != -1) { bestr.SetXYZ(hs[0].XBinCenter(bestix), y, z); }
-      } // end for u
-    }   // end for z
+    if (score) *score = bestscore;
 
     return bestr;
   }
 
+  // ---------------------------------------------------------------------------
+  // Zero the bins within R of (z0, x0)
+  void SuppressAround(HeatMap& hm, double z0, double x0, double R)
+  {
+    const int iz0 = std::max(0, hm.ZToBin(z0 - R));
+    const int iz1 = std::min(hm.Nz - 1, hm.ZToBin(z0 + R));
+    const int ix0 = std::max(0, hm.XToBin(x0 - R));
+    const int ix1 = std::min(hm.Nx - 1, hm.XToBin(x0 + R));
+    for (int iz = iz0; iz <= iz1; ++iz) {
+      for (int ix = ix0; ix <= ix1; ++ix) {
+        hm.map[iz * hm.Nx + ix] = 0;
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  // Take the nPeaks best peaks of the coarse maps in turn and make cm binned
+  // maps within R of each from the lines passing close to it. These don't need
+  // to be subsampled the way the full maps do. Returns the best refined peak.
+  bool RefineCoarsePeaks(const std::vector<std::vector<Pt2D>>& pts,
+                         std::vector<HeatMap> hms,
+                         const std::vector<recob::tracking::Vector_t>& dirs,
+                         int nPeaks,
+                         double R,
+                         recob::tracking::Point_t& vtx)
+  {
+    float bestscore = -1;
+
+    for (int peak = 0; peak < nPeaks; ++peak) {
+      float coarsescore;
+      const recob::tracking::Point_t cand = FindPeak3D(hms, dirs, &coarsescore);
+      if (coarsescore <= 0) break;
+
+      std::vector<HeatMap> hms_fine;
+      hms_fine.reserve(3);
+      for (int view = 0; view < 3; ++view) {
+        const double x0 = cand.X();
+        const double z0 = cand.Dot(dirs[view]);
+
+        std::vector<Line2D> lines;
+        LinesFromPoints(pts[view], lines, z0, x0, R);
+
+        if (lines.empty()) break;
+
+        hms_fine.emplace_back(2 * R, z0 - R, z0 + R, 2 * R, x0 - R, x0 + R);
+        MapFromLines(lines, hms_fine.back());
+      }
+
+      if (hms_fine.size() == 3) {
+        float score;
+        const recob::tracking::Point_t r = FindPeak3D(hms_fine, dirs, &score);
+        if (score > bestscore) {
+          bestscore = score;
+          vtx = r;
+        }
+      }
+
+      // Look somewhere else for the next candidate
+      for (int view = 0; view < 3; ++view) {
+        SuppressAround(hms[view], cand.Dot(dirs[view]), cand.X(), R);
+      }
+    }
+
+    return bestscore >= 0;
+  }
+
   // ---------------------------------------------------------------------------
   void GetPts2D(const detinfo::DetectorPropertiesData& detProp,
                 const std::vector<recob::Hit>& hits,
@@ -425,12 +567,23 @@ namespace quad {
 
       if (lines.empty()) return false;
 
-      // Approximately cm bins
-      hms.emplace_back(maxz[view] - minz[view], minz[view], maxz[view], maxx - minx, minx, maxx);
+      // Approximately cm bins, or coarser ones if they will be refined
+      const double binSize = fCoarseToFine ? fCoarseBinSize : 1;
+      hms.emplace_back((maxz[view] - minz[view]) / binSize,
+                       minz[view],
+                       maxz[view],
+                       (maxx - minx) / binSize,
+                       minx,
+                       maxx);
       MapFromLines(lines, hms.back());
     } // end for view
 
-    vtx = FindPeak3D(hms, dirs);
+    if (fCoarseToFine) {
+      if (!RefineCoarsePeaks(pts, hms, dirs, fNCoarsePeaks, fRefineWindow, vtx)) return false;
+    }
+    else {
+      vtx = FindPeak3D(hms, dirs);
+    }
 
     std::vector<HeatMap> hms_zoom;
     hms_zoom.reserve(3);
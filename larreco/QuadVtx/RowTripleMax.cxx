@@ -0,0 +1,222 @@
+#include "larreco/QuadVtx/RowTripleMax.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define QUADVTX_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace quad {
+  namespace {
+    // -------------------------------------------------------------------------
+    int RowTripleMaxScalar(const float* a,
+                           const float* b,
+                           const float* c,
+                           int begin,
+                           int end,
+                           float& max)
+    {
+      int best = -1;
+      for (int ix = begin; ix < end; ++ix) {
+        const float score = a[ix] + b[ix] + c[ix];
+        if (best < 0 || score > max) {
+          max = score;
+          best = ix;
+        }
+      }
+      return best;
+    }
+
+#ifdef QUADVTX_X86_SIMD
+    // The vector versions find the maximum in a first pass and then look for
+    // the first bin holding it. The rows are short enough to stay in L1 between
+    // the two passes
+
+    // -------------------------------------------------------------------------
+    int RowTripleMaxSSE2(const float* a,
+                         const float* b,
+                         const float* c,
+                         int begin,
+                         int end,
+                         float& max)
+    {
+      constexpr int W = 4;
+      if (end - begin < W) return RowTripleMaxScalar(a, b, c, begin, end, max);
+
+      const int vend = begin + (end - begin) / W * W;
+
+      __m128 vmax = _mm_set1_ps(-__builtin_inff());
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m128 s =
+          _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a + ix), _mm_loadu_ps(b + ix)), _mm_loadu_ps(c + ix));
+        vmax = _mm_max_ps(vmax, s);
+      }
+      vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+      vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+      float m = _mm_cvtss_f32(vmax);
+      for (int ix = vend; ix < end; ++ix) {
+        const float score = a[ix] + b[ix] + c[ix];
+        if (score > m) m = score;
+      }
+
+      const __m128 target = _mm_set1_ps(m);
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m128 s =
+          _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a + ix), _mm_loadu_ps(b + ix)), _mm_loadu_ps(c + ix));
+        const int mask = _mm_movemask_ps(_mm_cmpeq_ps(s, target));
+        if (mask) {
+          max = m;
+          return ix + __builtin_ctz(mask);
+        }
+      }
+      for (int ix = vend; ix < end; ++ix) {
+        if (a[ix] + b[ix] + c[ix] == m) {
+          max = m;
+          return ix;
+        }
+      }
+      return -1; // only with NaNs in the maps
+    }
+
+    // -------------------------------------------------------------------------
+    __attribute__((target("avx2"))) int RowTripleMaxAVX2(const float* a,
+                                                         const float* b,
+                                                         const float* c,
+                                                         int begin,
+                                                         int end,
+                                                         float& max)
+    {
+      constexpr int W = 8;
+      if (end - begin < W) return RowTripleMaxSSE2(a, b, c, begin, end, max);
+
+      const int vend = begin + (end - begin) / W * W;
+
+      __m256 vmax = _mm256_set1_ps(-__builtin_inff());
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m256 s = _mm256_add_ps(
+          _mm256_add_ps(_mm256_loadu_ps(a + ix), _mm256_loadu_ps(b + ix)), _mm256_loadu_ps(c + ix));
+        vmax = _mm256_max_ps(vmax, s);
+      }
+      __m128 hmax = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+      hmax = _mm_max_ps(hmax, _mm_shuffle_ps(hmax, hmax, _MM_SHUFFLE(1, 0, 3, 2)));
+      hmax = _mm_max_ps(hmax, _mm_shuffle_ps(hmax, hmax, _MM_SHUFFLE(2, 3, 0, 1)));
+      float m = _mm_cvtss_f32(hmax);
+      for (int ix = vend; ix < end; ++ix) {
+        const float score = a[ix] + b[ix] + c[ix];
+        if (score > m) m = score;
+      }
+
+      const __m256 target = _mm256_set1_ps(m);
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m256 s = _mm256_add_ps(
+          _mm256_add_ps(_mm256_loadu_ps(a + ix), _mm256_loadu_ps(b + ix)), _mm256_loadu_ps(c + ix));
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(s, target, _CMP_EQ_OQ));
+        if (mask) {
+          max = m;
+          return ix + __builtin_ctz(mask);
+        }
+      }
+      for (int ix = vend; ix < end; ++ix) {
+        if (a[ix] + b[ix] + c[ix] == m) {
+          max = m;
+          return ix;
+        }
+      }
+      return -1;
+    }
+
+    // -------------------------------------------------------------------------
+    __attribute__((target("avx512f"))) int RowTripleMaxAVX512(const float* a,
+                                                              const float* b,
+                                                              const float* c,
+                                                              int begin,
+                                                              int end,
+                                                              float& max)
+    {
+      constexpr int W = 16;
+      if (end - begin < W) return RowTripleMaxAVX2(a, b, c, begin, end, max);
+
+      const int vend = begin + (end - begin) / W * W;
+
+      __m512 vmax = _mm512_set1_ps(-__builtin_inff());
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m512 s = _mm512_add_ps(
+          _mm512_add_ps(_mm512_loadu_ps(a + ix), _mm512_loadu_ps(b + ix)), _mm512_loadu_ps(c + ix));
+        vmax = _mm512_mask_max_ps(vmax, 0xFFFF, vmax, s);
+      }
+      alignas(64) float lanes[W];
+      _mm512_store_ps(lanes, vmax);
+      float m = lanes[0];
+      for (int i = 1; i < W; ++i)
+        if (lanes[i] > m) m = lanes[i];
+      for (int ix = vend; ix < end; ++ix) {
+        const float score = a[ix] + b[ix] + c[ix];
+        if (score > m) m = score;
+      }
+
+      const __m512 target = _mm512_set1_ps(m);
+      for (int ix = begin; ix < vend; ix += W) {
+        const __m512 s = _mm512_add_ps(
+          _mm512_add_ps(_mm512_loadu_ps(a + ix), _mm512_loadu_ps(b + ix)), _mm512_loadu_ps(c + ix));
+        const unsigned int mask = _mm512_cmp_ps_mask(s, target, _CMP_EQ_OQ);
+        if (mask) {
+          max = m;
+          return ix + __builtin_ctz(mask);
+        }
+      }
+      for (int ix = vend; ix < end; ++ix) {
+        if (a[ix] + b[ix] + c[ix] == m) {
+          max = m;
+          return ix;
+        }
+      }
+      return -1;
+    }
+#endif
+
+    // -------------------------------------------------------------------------
+    SimdLevel DetectSimdLevel()
+    {
+#ifdef QUADVTX_X86_SIMD
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) return SimdLevel::kAVX512;
+      if (__builtin_cpu_supports("avx2")) return SimdLevel::kAVX2;
+      return SimdLevel::kSSE2; // part of x86-64
+#else
+      return SimdLevel::kScalar;
+#endif
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  SimdLevel BestSimdLevel()
+  {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+  }
+
+  // ---------------------------------------------------------------------------
+  int RowTripleMax(const float* a, const float* b, const float* c, int begin, int end, float& max)
+  {
+    return RowTripleMax(BestSimdLevel(), a, b, c, begin, end, max);
+  }
+
+  // ---------------------------------------------------------------------------
+  int RowTripleMax(SimdLevel level,
+                   const float* a,
+                   const float* b,
+                   const float* c,
+                   int begin,
+                   int end,
+                   float& max)
+  {
+#ifdef QUADVTX_X86_SIMD
+    switch (level) {
+    case SimdLevel::kAVX512: return RowTripleMaxAVX512(a, b, c, begin, end, max);
+    case SimdLevel::kAVX2: return RowTripleMaxAVX2(a, b, c, begin, end, max);
+    case SimdLevel::kSSE2: return RowTripleMaxSSE2(a, b, c, begin, end, max);
+    case SimdLevel::kScalar: break;
+    }
+#endif
+    return RowTripleMaxScalar(a, b, c, begin, end, max);
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef LARRECO_QUADVTX_ROWTRIPLEMAX_H
+#define LARRECO_QUADVTX_ROWTRIPLEMAX_H
+
+namespace quad {
+  /// Instruction sets RowTripleMax can be run with. The vector versions only
+  /// exist in x86-64 builds
+  enum class SimdLevel { kScalar, kSSE2, kAVX2, kAVX512 };
+
+  /// The widest instruction set supported by both this build and this CPU
+  SimdLevel BestSimdLevel();
+
+  /// Maximum over ix in [begin, end) of a[ix] + b[ix] + c[ix], summed in that
+  /// order. Returns the first ix at which it is reached, or -1 if the range is
+  /// empty. All the levels give the same answer, the default is BestSimdLevel()
+  int RowTripleMax(const float* a, const float* b, const float* c, int begin, int end, float& max);
+
+  int RowTripleMax(SimdLevel level,
+                   const float* a,
+                   const float* b,
+                   const float* c,
+                   int begin,
+                   int end,
+                   float& max);
+}
+
+#endif
@@ -98,6 +98,63 @@ namespace apa {
     fChannelRange[1] = (fLastV - fFirstV + 1) * fGeom->WirePitch(geo::kV);
   }
 
+  //----------------------------------------------------------
+  void APAGeometryAlg::FillChannelTables()
+  {
+    // The geometry answers these per call; disambiguation asks for every hit
+    // and for every pair of hits it compares, so look them all up once.
+    uint32_t const nChannels = fGeom->Nchannels();
+    fChannelWires.assign(nChannels, {});
+    fWireZChanRanges.assign(nChannels, {});
+
+    for (uint32_t chan = 0; chan < nChannels; ++chan) {
+      fChannelWires[chan] = fGeom->ChannelToWire(chan);
+      if (fGeom->View(chan) == geo::kZ) continue;
+
+      unsigned int apa(0), cryo(0);
+      this->ChannelToAPA(chan, apa, cryo);
+      auto& ranges = fWireZChanRanges[chan];
+      ranges.reserve(fChannelWires[chan].size());
+      for (geo::WireID const& wid : fChannelWires[chan]) {
+        double xyzStart[3] = {0.};
+        double xyzEnd[3] = {0.};
+        fGeom->WireEndPoints(wid, xyzStart, xyzEnd);
+        unsigned int side(wid.TPC % 2);
+
+        // get appropriate x and y with tpc center
+        unsigned int tpc =
+          2 * apa + side - wid.Cryostat * fGeom->NTPC(); // apa number does not reset per cryo
+        auto const tpcCenter = fGeom->TPC(geo::TPCID(wid.Cryostat, tpc)).GetCenter();
+
+        auto Min = tpcCenter;
+        Min.SetZ(xyzStart[2]);
+        auto Max = tpcCenter;
+        Max.SetZ(xyzEnd[2]);
+        geo::PlaneID const zPlane{wid.Cryostat, tpc, 2};
+        ranges.emplace_back(fGeom->NearestChannel(Min, zPlane), fGeom->NearestChannel(Max, zPlane));
+      }
+    }
+  }
+
+  //----------------------------------------------------------
+  std::vector<geo::WireID> const& APAGeometryAlg::ChannelWires(uint32_t chan) const
+  {
+    if (chan >= fChannelWires.size())
+      throw cet::exception("APAGeometryAlg")
+        << "No wire table for channel " << chan << " (was FillChannelTables called?)\n";
+    return fChannelWires[chan];
+  }
+
+  //----------------------------------------------------------
+  std::pair<uint32_t, uint32_t> const& APAGeometryAlg::WireZChanRange(uint32_t chan,
+                                                                      size_t iwid) const
+  {
+    if (chan >= fWireZChanRanges.size() || iwid >= fWireZChanRanges[chan].size())
+      throw cet::exception("APAGeometryAlg")
+        << "No collection channel range for wire " << iwid << " of channel " << chan << "\n";
+    return fWireZChanRanges[chan][iwid];
+  }
+
   //----------------------------------------------------------
   void APAGeometryAlg::ChannelToAPA(uint32_t chan, unsigned int& apa, unsigned int& cryo) const
   {
@@ -207,6 +264,7 @@ namespace apa {
   std::vector<geo::WireID> APAGeometryAlg::ChanSegsPerSide(uint32_t chan, unsigned int side) const
   {
 
+    if (HasChannelTables()) return this->ChanSegsPerSide(ChannelWires(chan), side);
     std::vector<geo::WireID> wids = fGeom->ChannelToWire(chan);
     return this->ChanSegsPerSide(wids, side);
   }
@@ -6,6 +6,7 @@
 #define APAGeometryALG_H
 
 #include <stdint.h>
+#include <utility>
 #include <vector>
 
 #include "TVector3.h"
@@ -39,6 +40,16 @@ namespace apa {
 
     void Init(); ///< Initialize some chanel numbers to speed up other methods
 
+    void FillChannelTables();
+    ///< Tabulate the wire segments of every channel and the collection channels they cross
+    bool HasChannelTables() const { return !fChannelWires.empty(); }
+
+    std::vector<geo::WireID> const& ChannelWires(uint32_t chan) const;
+    ///< Same as Geometry::ChannelToWire, from the table made by FillChannelTables
+    std::pair<uint32_t, uint32_t> const& WireZChanRange(uint32_t chan, size_t iwid) const;
+    ///< Collection channels nearest to the ends of ChannelWires(chan)[iwid], in the
+    ///< same APA side; only filled for induction channels
+
     bool APAChannelsIntersect(uint32_t chan1,
                               uint32_t chan2,
                               std::vector<geo::WireIDIntersection>& IntersectVector) const;
@@ -93,6 +104,10 @@ namespace apa {
 
     double fChannelRange[2]; // for each induction view: U=0, V=1
 
+    // per channel tables, empty until FillChannelTables is called
+    std::vector<std::vector<geo::WireID>> fChannelWires;
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> fWireZChanRanges;
+
   }; // class APAGeometryAlg
 
 } // namespace apa
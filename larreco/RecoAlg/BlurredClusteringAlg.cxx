@@ -50,9 +50,6 @@ cluster::BlurredClusteringAlg::BlurredClusteringAlg(fhicl::ParameterSet const& p
   , fMinSeed{pset.get<double>("MinSeed")}
   , fTimeThreshold{pset.get<double>("TimeThreshold")}
   , fChargeThreshold{pset.get<double>("ChargeThreshold")}
-  , fKernelWidth{2 * fBlurWire + 1}
-  , fKernelHeight{2 * fBlurTick * fMaxTickWidthBlur + 1}
-  , fAllKernels{MakeKernels()}
 {}
 
 cluster::BlurredClusteringAlg::~BlurredClusteringAlg()
@@ -106,14 +103,13 @@ void cluster::BlurredClusteringAlg::CreateDebugPDF(int run, int subrun, int even
 }
 
 void cluster::BlurredClusteringAlg::ConvertBinsToClusters(
-  std::vector<std::vector<double>> const& image,
   std::vector<std::vector<int>> const& allClusterBins,
   std::vector<art::PtrVector<recob::Hit>>& clusters) const
 {
   // Loop through the clusters (each a vector of bins)
   for (auto const& bins : allClusterBins) {
     // Convert the clusters (vectors of bins) to hits in a vector of recob::Hits
-    art::PtrVector<recob::Hit> clusHits = ConvertBinsToRecobHits(image, bins);
+    art::PtrVector<recob::Hit> clusHits = ConvertBinsToRecobHits(bins);
 
     mf::LogInfo("BlurredClustering") << "Cluster made from " << bins.size() << " bins, of which "
                                      << clusHits.size() << " were real hits";
@@ -130,7 +126,7 @@ void cluster::BlurredClusteringAlg::ConvertBinsToClusters(
   }
 }
 
-std::vector<std::vector<double>> cluster::BlurredClusteringAlg::ConvertRecobHitsToVector(
+cluster::BlurredImage cluster::BlurredClusteringAlg::ConvertRecobHitsToImage(
   std::vector<art::Ptr<recob::Hit>> const& hits,
   int const readoutWindowSize)
 {
@@ -150,25 +146,24 @@ std::vector<std::vector<double>> cluster::BlurredClusteringAlg::ConvertRecobHits
   fLowerWire = lowerWire - 20;
   fUpperWire = upperWire + 20;
 
-  // Use a map to keep a track of the real hits and their wire/ticks
-  fHitMap.clear();
-  fHitMap.resize(fUpperWire - fLowerWire,
-                 std::vector<art::Ptr<recob::Hit>>(fUpperTick - fLowerTick));
+  // Create the image
+  BlurredImage image(fUpperWire - fLowerWire, fUpperTick - fLowerTick);
 
-  // Create a 2D vector
-  std::vector<std::vector<double>> image(fUpperWire - fLowerWire,
-                                         std::vector<double>(fUpperTick - fLowerTick));
+  // Use a map to keep a track of the real hits and their wire/ticks
+  fHits = hits;
+  fHitMap.assign(image.NBins(), -1);
 
   // Look through the hits
-  for (auto const& hit : hits) {
-    int const wire = GlobalWire(hit->WireID());
-    auto const tick = static_cast<int>(hit->PeakTime());
+  for (unsigned int hitIt = 0; hitIt < hits.size(); ++hitIt) {
+    auto const& hit = hits[hitIt];
+    int const wire = GlobalWire(hit->WireID()) - fLowerWire;
+    int const tick = static_cast<int>(hit->PeakTime()) - fLowerTick;
     float const charge = hit->Integral();
 
     // Fill hit map and keep a note of all real hits for later
-    if (charge > image.at(wire - fLowerWire).at(tick - fLowerTick)) {
-      image.at(wire - fLowerWire).at(tick - fLowerTick) = charge;
-      fHitMap[wire - fLowerWire][tick - fLowerTick] = hit;
+    if (charge > image(wire, tick)) {
+      image(wire, tick) = charge;
+      fHitMap[image.Bin(wire, tick)] = hitIt;
     }
   }
 
@@ -184,103 +179,77 @@ std::vector<std::vector<double>> cluster::BlurredClusteringAlg::ConvertRecobHits
   return image;
 }
 
-int cluster::BlurredClusteringAlg::FindClusters(std::vector<std::vector<double>> const& blurred,
+int cluster::BlurredClusteringAlg::FindClusters(BlurredImage const& blurred,
                                                 std::vector<std::vector<int>>& allcluster) const
 {
   // Size of image in x and y
-  int const nbinsx = blurred.size();
-  int const nbinsy = blurred.at(0).size();
-  int const nbins = nbinsx * nbinsy;
+  int const nbinsx = blurred.NWires();
+  int const nbinsy = blurred.NTicks();
+  int const nbins = blurred.NBins();
+
+  // Group the bins above the charge threshold which are within the clustering distance of each
+  // other. A cluster grown from a seed takes the whole group of the seed
+  std::vector<int> groups;
+  int const ngroups = LabelComponents(
+    blurred, fChargeThreshold, fClusterWireDistance, fClusterTickDistance, groups);
+
+  // The seed of each group is its highest charge bin
+  std::vector<std::pair<float, int>> seeds(ngroups, {0.f, -1});
+  for (int bin = 0; bin < nbins; ++bin) {
+    if (groups[bin] < 0) continue;
+    seeds[groups[bin]] = std::max(seeds[groups[bin]], std::make_pair(blurred.Charge(bin), bin));
+  }
+
+  // Sort the seeds into charge order
+  std::sort(seeds.rbegin(), seeds.rend());
 
   // Vectors to hold hit information
   std::vector<bool> used(nbins);
-  std::vector<std::pair<double, int>> values;
-
-  // Place the bin number and contents as a pair in the values vector
-  for (int xbin = 0; xbin < nbinsx; ++xbin) {
-    for (int ybin = 0; ybin < nbinsy; ++ybin) {
-      int const bin = ConvertWireTickToBin(blurred, xbin, ybin);
-      values.emplace_back(ConvertBinToCharge(blurred, bin), bin);
-    }
-  }
 
-  // Sort the values into charge order
-  std::sort(values.rbegin(), values.rend());
+  // Clustering loop - considers the seeds in decreasing charge order and makes a cluster of
+  // the group of each. Its bins are ordered as they are reached from the seed through the
+  // direct neighbours
+  for (auto const& [seed_binval, seed] : seeds) {
 
-  // Count the number of iterations of the cluster forming loop (== number of clusters)
-  int niter = 0;
+    // Go no further if below seed threshold
+    if (seed_binval < fMinSeed) break;
 
-  // Clustering loops
-  // First loop - considers highest charge hits in decreasing order, and puts them in a new cluster if they aren't already clustered (makes new cluster every iteration)
-  // Second loop - looks at the direct neighbours of this seed and clusters to this if above charge/time thresholds. Runs recursively over all hits in cluster (inc. new ones)
-  while (true) {
+    // The seed may have been taken by an earlier cluster when filling its holes
+    if (used[seed]) continue;
 
-    // Start a new cluster each time loop is executed
+    // Start a new cluster
     std::vector<int> cluster;
     std::vector<double> times;
-
-    // Get the highest charge bin (go no further if below seed threshold)
-    if (double const blurred_binval = values[niter].first; blurred_binval < fMinSeed) break;
-
-    // Iterate through the bins from highest charge down
-    int const bin = values[niter++].second;
-
-    // Put this bin in used if not already there
-    if (used[bin]) continue;
-    used[bin] = true;
-
-    // Start a new cluster
-    cluster.push_back(bin);
+    used[seed] = true;
+    cluster.push_back(seed);
 
     // Get the time of this hit
-    if (double const time = GetTimeOfBin(blurred, bin); time > 0) times.push_back(time);
-
-    // Now cluster neighbouring hits to this seed
-    while (true) {
-
-      bool added_cluster{false};
-
-      for (unsigned int clusBin = 0; clusBin < cluster.size(); ++clusBin) {
-
-        // Get x and y values for bin (c++ returns a%b = a if a<b)
-        int const binx = cluster[clusBin] % nbinsx;
-        int const biny = ((cluster[clusBin] - binx) / nbinsx) % nbinsy;
+    if (double const time = GetTimeOfBin(seed); time > 0) times.push_back(time);
 
-        // Look for hits in the neighbouring x/y bins
-        for (int x = binx - fClusterWireDistance; x <= binx + fClusterWireDistance; x++) {
-          if (x >= nbinsx or x < 0) continue;
-          for (int y = biny - fClusterTickDistance; y <= biny + fClusterTickDistance; y++) {
-            if (y >= nbinsy or y < 0) continue;
-            if (x == binx and y == biny) continue;
+    // Now cluster the rest of the group to this seed
+    for (unsigned int clusBin = 0; clusBin < cluster.size(); ++clusBin) {
 
-            // Get this bin
-            auto const bin = ConvertWireTickToBin(blurred, x, y);
-            if (bin >= nbinsx * nbinsy or bin < 0) continue;
-            if (used[bin]) continue;
+      // Get x and y values for bin
+      int const binx = blurred.WireOfBin(cluster[clusBin]);
+      int const biny = blurred.TickOfBin(cluster[clusBin]);
 
-            // Get the blurred value and time for this bin
-            double const blurred_binval = ConvertBinToCharge(blurred, bin);
-            double const time =
-              GetTimeOfBin(blurred, bin); // NB for 'fake' hits, time is defaulted to -10000
+      // Look for hits in the neighbouring x/y bins
+      for (int x = binx - fClusterWireDistance; x <= binx + fClusterWireDistance; x++) {
+        if (x >= nbinsx or x < 0) continue;
+        for (int y = biny - fClusterTickDistance; y <= biny + fClusterTickDistance; y++) {
+          if (y >= nbinsy or y < 0) continue;
 
-            // Check real hits pass time cut (ignores fake hits)
-            if (time > 0 && times.size() > 0 && !PassesTimeCut(times, time)) continue;
+          // Get this bin
+          auto const bin = blurred.Bin(x, y);
+          if (used[bin] or groups[bin] != groups[seed]) continue;
 
-            // Add to cluster if bin value is above threshold
-            if (blurred_binval > fChargeThreshold) {
-              used[bin] = true;
-              cluster.push_back(bin);
-              added_cluster = true;
-              if (time > 0) { times.push_back(time); }
-            } // End of adding blurred bin to cluster
-          }
-        } // End of looking at directly neighbouring bins
-
-      } // End of looping over bins already in this cluster
-
-      if (!added_cluster) break;
+          used[bin] = true;
+          cluster.push_back(bin);
+          if (double const time = GetTimeOfBin(bin); time > 0) times.push_back(time);
+        }
+      } // End of looking at directly neighbouring bins
 
-    } // End of adding hits to this cluster
+    } // End of looping over bins already in this cluster
 
     // Check this cluster is above minimum size
     if (cluster.size() < fMinSize) {
@@ -305,11 +274,12 @@ int cluster::BlurredClusteringAlg::FindClusters(std::vector<std::vector<double>>
               neighbouringBin % nbinsx == nbinsx - 1 || neighbouringBin >= nbinsx * (nbinsy - 1))
             continue;
 
-          double const time = GetTimeOfBin(blurred, neighbouringBin);
+          // Only real hits can pass the time cut, the others being at -10000
+          if (used[neighbouringBin] || fHitMap[neighbouringBin] < 0) continue;
+          double const time = GetTimeOfBin(neighbouringBin);
 
-          // If not already clustered and passes neighbour/time thresholds, add to cluster
-          if (!used[neighbouringBin] &&
-              (NumNeighbours(nbinsx, used, neighbouringBin) > fNeighboursThreshold) &&
+          // If passes neighbour/time thresholds, add to cluster
+          if ((NumNeighbours(nbinsx, used, neighbouringBin) > fNeighboursThreshold) &&
               PassesTimeCut(times, time)) {
             used[neighbouringBin] = true;
             cluster.push_back(neighbouringBin);
@@ -414,72 +384,43 @@ int cluster::BlurredClusteringAlg::GlobalWire(const geo::WireID& wireID) const
   return std::round(globalWire);
 }
 
-std::vector<std::vector<double>> cluster::BlurredClusteringAlg::GaussianBlur(
-  std::vector<std::vector<double>> const& image) const
+cluster::BlurredImage cluster::BlurredClusteringAlg::GaussianBlur(
+  BlurredImage const& image) const
 {
   if (fSigmaWire == 0 and fSigmaTick == 0) return image;
 
   auto const [blur_wire, blur_tick, sigma_wire, sigma_tick] = FindBlurringParameters();
 
-  // Convolve the Gaussian
-  int width = 2 * blur_wire + 1;
-  int height = 2 * blur_tick + 1;
-  int nbinsx = image.size();
-  int nbinsy = image.at(0).size();
-
-  // Blurred histogram and normalisation for each bin
-  std::vector<std::vector<double>> copy(nbinsx, std::vector<double>(nbinsy, 0));
-
-  // Loop through all the bins in the histogram to blur
-  for (int x = 0; x < nbinsx; ++x) {
-    for (int y = 0; y < nbinsy; ++y) {
-
-      if (image[x][y] == 0) continue;
-
-      // Scale the tick blurring based on the width of the hit
-      int tick_scale =
-        std::sqrt(cet::square(fHitMap[x][y]->RMS()) + cet::square(sigma_tick)) / (double)sigma_tick;
-      tick_scale = std::max(std::min(tick_scale, fMaxTickWidthBlur), 1);
-      auto const& correct_kernel = fAllKernels[sigma_wire][sigma_tick * tick_scale];
-
-      // Find any dead wires in the potential blurring region
-      auto const [lower_bin_dead, upper_bin_dead] = DeadWireCount(x, width);
-
-      // Note of how many dead wires we have passed whilst blurring in the wire direction
-      // If blurring below the seed hit, need to keep a note of how many dead wires to come
-      // If blurring above, need to keep a note of how many dead wires have passed
-      auto dead_wires_passed{lower_bin_dead};
-
-      // Loop over the blurring region around this hit
-      for (int blurx = -(width / 2 + lower_bin_dead); blurx < (width + 1) / 2 + upper_bin_dead;
-           ++blurx) {
-        if (x + blurx < 0) continue;
-        for (int blury = -height / 2 * tick_scale;
-             blury < ((((height + 1) / 2) - 1) * tick_scale) + 1;
-             ++blury) {
-          if (blurx < 0 and fDeadWires[x + blurx]) dead_wires_passed -= 1;
-
-          // Smear the charge of this hit
-          double const weight = correct_kernel[fKernelWidth * (fKernelHeight / 2 + blury) +
-                                               (fKernelWidth / 2 + (blurx - dead_wires_passed))];
-          if (x + blurx >= 0 and x + blurx < nbinsx and y + blury >= 0 and y + blury < nbinsy)
-            copy[x + blurx][y + blury] += weight * image[x][y];
-
-          if (blurx > 0 and fDeadWires[x + blurx]) dead_wires_passed += 1;
-        }
-      } // blurring region
-    }
-  } // hits to blur
+  // The Gaussian is the product of one in the wire direction and one in the tick direction.
+  // The kernels in the tick direction are scaled with the width of the hits
+  std::vector<std::vector<float>> tickKernels(fMaxTickWidthBlur + 1);
+  for (int tick_scale = 1; tick_scale <= fMaxTickWidthBlur; ++tick_scale)
+    tickKernels[tick_scale] = GaussianKernel(sigma_tick * tick_scale, blur_tick * tick_scale);
+
+  // Blurred histogram, widened in the wire direction across dead wires
+  BlurredImage blurred(image.NWires(), image.NTicks());
+  BlurImage(image,
+            fDeadWires,
+            GaussianKernel(sigma_wire, blur_wire),
+            [&](int x, int y) -> std::vector<float> const& {
+              // Scale the tick blurring based on the width of the hit
+              art::Ptr<recob::Hit> const& hit = fHits[fHitMap[image.Bin(x, y)]];
+              int tick_scale =
+                std::sqrt(cet::square(hit->RMS()) + cet::square(sigma_tick)) / (double)sigma_tick;
+              tick_scale = std::max(std::min(tick_scale, fMaxTickWidthBlur), 1);
+              return tickKernels[tick_scale];
+            },
+            blurred);
 
   // HAVE REMOVED NOMALISATION CODE
   // WHEN USING DIFFERENT KERNELS, THERE'S NO EASY WAY OF DOING THIS...
   // RECONSIDER...
 
   // Return the blurred histogram
-  return copy;
+  return blurred;
 }
 
-TH2F* cluster::BlurredClusteringAlg::MakeHistogram(std::vector<std::vector<double>> const& image,
+TH2F* cluster::BlurredClusteringAlg::MakeHistogram(BlurredImage const& image,
                                                    TString const name) const
 {
   auto hist = new TH2F(name,
@@ -494,11 +435,11 @@ TH2F* cluster::BlurredClusteringAlg::MakeHistogram(std::vector<std::vector<doubl
   hist->SetYTitle("Tick number");
   hist->SetZTitle("Charge");
 
-  for (unsigned int imageWireIt = 0; imageWireIt < image.size(); ++imageWireIt) {
+  for (int imageWireIt = 0; imageWireIt < image.NWires(); ++imageWireIt) {
     int const wire = imageWireIt + fLowerWire;
-    for (unsigned int imageTickIt = 0; imageTickIt < image.at(imageWireIt).size(); ++imageTickIt) {
+    for (int imageTickIt = 0; imageTickIt < image.NTicks(); ++imageTickIt) {
       int const tick = imageTickIt + fLowerTick;
-      hist->Fill(wire, tick, image.at(imageWireIt).at(imageTickIt));
+      hist->Fill(wire, tick, image(imageWireIt, imageTickIt));
     }
   }
 
@@ -598,7 +539,6 @@ void cluster::BlurredClusteringAlg::SaveImage(TH2F* image,
 // Private member functions
 
 art::PtrVector<recob::Hit> cluster::BlurredClusteringAlg::ConvertBinsToRecobHits(
-  std::vector<std::vector<double>> const& image,
   std::vector<int> const& bins) const
 {
   // Create the vector of hits to output
@@ -607,7 +547,7 @@ art::PtrVector<recob::Hit> cluster::BlurredClusteringAlg::ConvertBinsToRecobHits
   // Look through the hits in the cluster
   for (auto const bin : bins) {
     // Take each hit and convert it to a recob::Hit
-    art::Ptr<recob::Hit> const hit = ConvertBinToRecobHit(image, bin);
+    art::Ptr<recob::Hit> const hit = ConvertBinToRecobHit(bin);
 
     // If this hit was a real hit put it in the hit selection
     if (!hit.isNull()) hits.push_back(hit);
@@ -617,70 +557,25 @@ art::PtrVector<recob::Hit> cluster::BlurredClusteringAlg::ConvertBinsToRecobHits
   return hits;
 }
 
-art::Ptr<recob::Hit> cluster::BlurredClusteringAlg::ConvertBinToRecobHit(
-  std::vector<std::vector<double>> const& image,
-  int const bin) const
+art::Ptr<recob::Hit> cluster::BlurredClusteringAlg::ConvertBinToRecobHit(int const bin) const
 {
-  int const wire = bin % image.size();
-  int const tick = bin / image.size();
-  return fHitMap[wire][tick];
-}
-
-int cluster::BlurredClusteringAlg::ConvertWireTickToBin(
-  std::vector<std::vector<double>> const& image,
-  int const xbin,
-  int const ybin) const
-{
-  return ybin * image.size() + xbin;
-}
-
-double cluster::BlurredClusteringAlg::ConvertBinToCharge(
-  std::vector<std::vector<double>> const& image,
-  int const bin) const
-{
-  int const x = bin % image.size();
-  int const y = bin / image.size();
-  return image.at(x).at(y);
-}
-
-std::pair<int, int> cluster::BlurredClusteringAlg::DeadWireCount(int const wire_bin,
-                                                                 int const width) const
-{
-  auto deadWires = std::make_pair(0, 0);
-
-  int const lower_bin = width / 2;
-  int const upper_bin = (width + 1) / 2;
-
-  auto const offset = wire_bin + fLowerWire;
-  for (int wire = std::max(offset - lower_bin, fLowerWire);
-       wire < std::min(offset + upper_bin, fUpperWire);
-       ++wire) {
-    if (!fDeadWires[wire - fLowerWire]) continue;
-
-    if (wire < offset)
-      ++deadWires.first;
-    else if (wire > offset)
-      ++deadWires.second;
-  }
-
-  return deadWires;
+  return fHitMap[bin] < 0 ? art::Ptr<recob::Hit>{} : fHits[fHitMap[bin]];
 }
 
 std::array<int, 4> cluster::BlurredClusteringAlg::FindBlurringParameters() const
 {
   // Calculate least squares slope
   double nhits{}, sumx{}, sumy{}, sumx2{}, sumxy{};
-  for (unsigned int wireIt = 0; wireIt < fHitMap.size(); ++wireIt) {
-    for (unsigned int tickIt = 0; tickIt < fHitMap.at(wireIt).size(); ++tickIt) {
-      if (fHitMap[wireIt][tickIt].isNull()) continue;
-      ++nhits;
-      int const x = wireIt + fLowerWire;
-      int const y = tickIt + fLowerTick;
-      sumx += x;
-      sumy += y;
-      sumx2 += x * x;
-      sumxy += x * y;
-    }
+  int const nwires = fUpperWire - fLowerWire;
+  for (unsigned int bin = 0; bin < fHitMap.size(); ++bin) {
+    if (fHitMap[bin] < 0) continue;
+    ++nhits;
+    int const x = bin % nwires + fLowerWire;
+    int const y = bin / nwires + fLowerTick;
+    sumx += x;
+    sumy += y;
+    sumx2 += x * x;
+    sumxy += x * y;
   }
   double const gradient = (nhits * sumxy - sumx * sumy) / (nhits * sumx2 - sumx * sumx);
 
@@ -697,50 +592,12 @@ std::array<int, 4> cluster::BlurredClusteringAlg::FindBlurringParameters() const
   return {{blur_wire, blur_tick, sigma_wire, sigma_tick}};
 }
 
-double cluster::BlurredClusteringAlg::GetTimeOfBin(std::vector<std::vector<double>> const& image,
-                                                   int const bin) const
+double cluster::BlurredClusteringAlg::GetTimeOfBin(int const bin) const
 {
-  auto const hit = ConvertBinToRecobHit(image, bin);
+  auto const hit = ConvertBinToRecobHit(bin);
   return hit.isNull() ? -10000. : hit->PeakTime();
 }
 
-std::vector<std::vector<std::vector<double>>> cluster::BlurredClusteringAlg::MakeKernels() const
-{
-  // Kernel size is the largest possible given the hit width rescaling
-  std::vector<std::vector<std::vector<double>>> allKernels(
-    fSigmaWire + 1,
-    std::vector<std::vector<double>>(fSigmaTick * fMaxTickWidthBlur + 1,
-                                     std::vector<double>(fKernelWidth * fKernelHeight)));
-
-  // Ranges of kernels to make
-  // Complete range of sigmas possible after dynamic fixing and hit width convolution
-  for (int sigma_wire = 1; sigma_wire <= fSigmaWire; ++sigma_wire) {
-    for (int sigma_tick = 1; sigma_tick <= fSigmaTick * fMaxTickWidthBlur; ++sigma_tick) {
-
-      // New kernel
-      std::vector<double> kernel(fKernelWidth * fKernelHeight, 0);
-
-      // Smear out according to the blur radii in each direction
-      for (int i = -fBlurWire; i <= fBlurWire; i++) {
-        for (int j = -fBlurTick * fMaxTickWidthBlur; j <= fBlurTick * fMaxTickWidthBlur; j++) {
-
-          // Fill kernel
-          double const sig2i = 2. * sigma_wire * sigma_wire;
-          double const sig2j = 2. * sigma_tick * sigma_tick;
-
-          int const key = (fKernelWidth * (j + fBlurTick * fMaxTickWidthBlur)) + (i + fBlurWire);
-          double const value = 1. / std::sqrt(sig2i * M_PI) * std::exp(-i * i / sig2i) * 1. /
-                               std::sqrt(sig2j * M_PI) * std::exp(-j * j / sig2j);
-          kernel.at(key) = value;
-        }
-      } // End loop over blurring region
-
-      allKernels[sigma_wire][sigma_tick] = move(kernel);
-    }
-  }
-  return allKernels;
-}
-
 unsigned int cluster::BlurredClusteringAlg::NumNeighbours(int const nbinsx,
                                                           std::vector<bool> const& used,
                                                           int const bin) const
@@ -21,6 +21,7 @@
 #include "larcore/Geometry/Geometry.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
+#include "larreco/RecoAlg/BlurredClusteringImage.h"
 namespace detinfo {
   class DetectorProperties;
 }
@@ -57,31 +58,27 @@ public:
   void CreateDebugPDF(int run, int subrun, int event);
 
   /// Takes a vector of clusters (itself a vector of hits) and turns them into clusters using the initial hit selection
-  void ConvertBinsToClusters(std::vector<std::vector<double>> const& image,
-                             std::vector<std::vector<int>> const& allClusterBins,
+  void ConvertBinsToClusters(std::vector<std::vector<int>> const& allClusterBins,
                              std::vector<art::PtrVector<recob::Hit>>& clusters) const;
 
-  /// Takes hit map and returns a 2D vector representing wire and tick, filled with the charge
-  std::vector<std::vector<double>> ConvertRecobHitsToVector(
-    std::vector<art::Ptr<recob::Hit>> const& hits,
-    int readoutWindowSize);
+  /// Takes hit map and returns an image of wire and tick, filled with the charge
+  BlurredImage ConvertRecobHitsToImage(std::vector<art::Ptr<recob::Hit>> const& hits,
+                                       int readoutWindowSize);
 
   /// Find clusters in the histogram
-  int FindClusters(std::vector<std::vector<double>> const& image,
-                   std::vector<std::vector<int>>& allcluster) const;
+  int FindClusters(BlurredImage const& image, std::vector<std::vector<int>>& allcluster) const;
 
   /// Find the global wire position
   int GlobalWire(geo::WireID const& wireID) const;
 
   /// Applies Gaussian blur to image
-  std::vector<std::vector<double>> GaussianBlur(
-    std::vector<std::vector<double>> const& image) const;
+  BlurredImage GaussianBlur(BlurredImage const& image) const;
 
   /// Minimum size of cluster to save
   unsigned int GetMinSize() const noexcept { return fMinSize; }
 
   /// Converts a 2D vector in a histogram for the debug pdf
-  TH2F* MakeHistogram(std::vector<std::vector<double>> const& image, TString name) const;
+  TH2F* MakeHistogram(BlurredImage const& image, TString name) const;
 
   /// Save the images for debugging
   /// This version takes the final clusters and overlays on the hit map
@@ -104,31 +101,16 @@ public:
 
 private:
   /// Converts a vector of bins into a hit selection - not all the hits in the bins vector are real hits
-  art::PtrVector<recob::Hit> ConvertBinsToRecobHits(std::vector<std::vector<double>> const& image,
-                                                    std::vector<int> const& bins) const;
+  art::PtrVector<recob::Hit> ConvertBinsToRecobHits(std::vector<int> const& bins) const;
 
   /// Converts a bin into a recob::Hit (not all of these bins correspond to recob::Hits - some are fake hits created by the blurring)
-  art::Ptr<recob::Hit> ConvertBinToRecobHit(std::vector<std::vector<double>> const& image,
-                                            int bin) const;
-
-  /// Converts an xbin and a ybin to a global bin number
-  int ConvertWireTickToBin(std::vector<std::vector<double>> const& image, int xbin, int ybin) const;
-
-  /// Returns the charge stored in the global bin value
-  double ConvertBinToCharge(std::vector<std::vector<double>> const& image, int bin) const;
-
-  /// Count how many dead wires there are in the blurring region for a particular hit
-  /// Returns a pair of counters representing how many dead wires there are below and above the hit respectively
-  std::pair<int, int> DeadWireCount(int wire_bin, int width) const;
+  art::Ptr<recob::Hit> ConvertBinToRecobHit(int bin) const;
 
   /// Dynamically find the blurring radii and Gaussian sigma in each dimension
   std::array<int, 4> FindBlurringParameters() const;
 
   /// Returns the hit time of a hit in a particular bin
-  double GetTimeOfBin(std::vector<std::vector<double>> const& image, int bin) const;
-
-  /// Makes all the kernels which could be required given the tuned parameters
-  std::vector<std::vector<std::vector<double>>> MakeKernels() const;
+  double GetTimeOfBin(int bin) const;
 
   /// Determines the number of clustered neighbours of a hit
   unsigned int NumNeighbours(int nx, std::vector<bool> const& used, int bin) const;
@@ -154,12 +136,9 @@ private:
   double fTimeThreshold;   // time threshold for clustering
   double fChargeThreshold; // charge threshold for clustering
 
-  // Blurring stuff
-  int fKernelWidth, fKernelHeight;
-  std::vector<std::vector<std::vector<double>>> fAllKernels;
-
   // Hit containers
-  std::vector<std::vector<art::Ptr<recob::Hit>>> fHitMap;
+  std::vector<art::Ptr<recob::Hit>> fHits;
+  std::vector<int> fHitMap; // index in fHits of the hit in each bin of the image, -1 if none
   std::vector<bool> fDeadWires;
 
   int fLowerTick, fUpperTick;
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////
+// Class: BlurredImage
+// File:  BlurredClusteringImage.cxx
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/RecoAlg/BlurredClusteringImage.h"
+
+#include <cmath>
+
+namespace {
+
+  /// Root of the set of an element, halving the path on the way
+  int FindRoot(std::vector<int>& parent, int element)
+  {
+    while (parent[element] != element) {
+      parent[element] = parent[parent[element]];
+      element = parent[element];
+    }
+    return element;
+  }
+
+  /// Joins the sets of two elements under the smaller root
+  void Join(std::vector<int>& parent, int a, int b)
+  {
+    a = FindRoot(parent, a);
+    b = FindRoot(parent, b);
+    if (a < b)
+      parent[b] = a;
+    else if (b < a)
+      parent[a] = b;
+  }
+
+} // namespace
+
+std::vector<float> cluster::GaussianKernel(double const sigma, int const halfWidth)
+{
+  std::vector<float> kernel(2 * halfWidth + 1);
+  double const sig2 = 2. * sigma * sigma;
+  for (int i = -halfWidth; i <= halfWidth; ++i)
+    kernel[i + halfWidth] = 1. / std::sqrt(sig2 * M_PI) * std::exp(-i * i / sig2);
+  return kernel;
+}
+
+void cluster::WireWeights(int const wire,
+                          std::vector<bool> const& deadWires,
+                          std::vector<float> const& kernel,
+                          std::vector<std::pair<int, float>>& weights)
+{
+  int const nWires = deadWires.size();
+  int const halfWidth = kernel.size() / 2;
+
+  weights.clear();
+  weights.emplace_back(wire, kernel[halfWidth]);
+  for (int const step : {-1, 1}) {
+    // Count the dead wires between this wire and the target
+    int nDead = 0;
+    for (int target = wire + step; target >= 0 && target < nWires; target += step) {
+      int const offset = std::abs(target - wire) - nDead;
+      if (offset > halfWidth) break;
+      weights.emplace_back(target, kernel[halfWidth + step * offset]);
+      if (deadWires[target]) ++nDead;
+    }
+  }
+}
+
+int cluster::LabelComponents(BlurredImage const& image,
+                             float const threshold,
+                             int const wireDistance,
+                             int const tickDistance,
+                             std::vector<int>& labels)
+{
+  int const nWires = image.NWires();
+  int const nTicks = image.NTicks();
+
+  // The bins above threshold, as runs of consecutive ticks [first, last) on each wire
+  struct Run {
+    int first;
+    int last;
+  };
+  std::vector<Run> runs;
+  std::vector<int> firstRun(nWires + 1, 0); // runs of a wire are firstRun[wire]..firstRun[wire+1]
+  std::vector<int> parent;
+
+  for (int wire = 0; wire < nWires; ++wire) {
+    firstRun[wire] = runs.size();
+    float const* row = image.Row(wire);
+    for (int first = 0; first < nTicks;) {
+      if (!(row[first] > threshold)) {
+        ++first;
+        continue;
+      }
+      int last = first + 1;
+      while (last < nTicks && row[last] > threshold)
+        ++last;
+      parent.push_back(runs.size());
+      runs.push_back({first, last});
+      first = last;
+    }
+    int const endRun = runs.size();
+
+    // Join with the runs within reach: the previous runs on this wire and those on the
+    // previous wires
+    for (int run = firstRun[wire] + 1; run < endRun; ++run) {
+      if (runs[run].first - (runs[run - 1].last - 1) <= tickDistance) Join(parent, run, run - 1);
+    }
+    for (int w = std::max(wire - wireDistance, 0); w < wire; ++w) {
+      // The runs of both wires are in tick order, so the first run of w within reach never
+      // moves back
+      int const endOther = firstRun[w + 1];
+      int other = firstRun[w];
+      for (int run = firstRun[wire]; run < endRun; ++run) {
+        while (other < endOther && runs[other].last - 1 + tickDistance < runs[run].first)
+          ++other;
+        for (int o = other; o < endOther && runs[o].first <= runs[run].last - 1 + tickDistance; ++o)
+          Join(parent, run, o);
+      }
+    }
+  }
+  firstRun[nWires] = runs.size();
+
+  // Number the groups in order of their roots, which are their first runs
+  int nLabels = 0;
+  std::vector<int> runLabel(runs.size());
+  labels.assign(image.NBins(), -1);
+  for (int wire = 0; wire < nWires; ++wire) {
+    for (int run = firstRun[wire]; run < firstRun[wire + 1]; ++run) {
+      int const root = FindRoot(parent, run);
+      runLabel[run] = (root == run) ? nLabels++ : runLabel[root];
+      for (int tick = runs[run].first; tick < runs[run].last; ++tick)
+        labels[image.Bin(wire, tick)] = runLabel[run];
+    }
+  }
+
+  return nLabels;
+}
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////
+// Class: BlurredImage
+// File:  BlurredClusteringImage.h
+//
+// Dense image of the hits of a plane used by BlurredClusteringAlg, with
+// the separable Gaussian blur and the connected component labelling the
+// clustering runs on it.
+//
+// The charge of a wire is contiguous in memory. The blur is separable: each
+// wire is blurred along the ticks into a row, which is then smeared across
+// the neighbouring wires, so no intermediate image is needed. Bins are
+// numbered wire + NWires() * tick, the numbering of the bins of the
+// clusters made by BlurredClusteringAlg.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef BlurredClusteringImage_h
+#define BlurredClusteringImage_h
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cluster {
+  class BlurredImage;
+}
+
+class cluster::BlurredImage {
+public:
+  BlurredImage() = default;
+  BlurredImage(int nWires, int nTicks) { Reset(nWires, nTicks); }
+
+  /// Resize to nWires x nTicks bins, all set to zero
+  void Reset(int nWires, int nTicks)
+  {
+    fNWires = nWires;
+    fNTicks = nTicks;
+    fData.assign(std::size_t(nWires) * nTicks, 0.f);
+  }
+
+  int NWires() const { return fNWires; }
+  int NTicks() const { return fNTicks; }
+  int NBins() const { return fNWires * fNTicks; }
+
+  float& operator()(int wire, int tick) { return fData[index(wire, tick)]; }
+  float operator()(int wire, int tick) const { return fData[index(wire, tick)]; }
+
+  /// The charge on a wire, NTicks() bins
+  float* Row(int wire) { return fData.data() + index(wire, 0); }
+  float const* Row(int wire) const { return fData.data() + index(wire, 0); }
+
+  int Bin(int wire, int tick) const { return tick * fNWires + wire; }
+  int WireOfBin(int bin) const { return bin % fNWires; }
+  int TickOfBin(int bin) const { return bin / fNWires; }
+  float Charge(int bin) const { return (*this)(WireOfBin(bin), TickOfBin(bin)); }
+
+private:
+  std::size_t index(int wire, int tick) const { return std::size_t(wire) * fNTicks + tick; }
+
+  int fNWires{0};
+  int fNTicks{0};
+  std::vector<float> fData;
+};
+
+namespace cluster {
+
+  /// Weights of a normalised Gaussian of the given sigma at offsets -halfWidth..halfWidth
+  std::vector<float> GaussianKernel(double sigma, int halfWidth);
+
+  /// The wires reached by the kernel from a wire, with their weights. Dead wires are bridged:
+  /// the kernel reaches the same number of live wires on each side of the wire, and a dead
+  /// wire gets the weight of the first live wire beyond it
+  void WireWeights(int wire,
+                   std::vector<bool> const& deadWires,
+                   std::vector<float> const& kernel,
+                   std::vector<std::pair<int, float>>& weights);
+
+  /// Blurs the image with the product of wireKernel and a kernel in the tick direction, and
+  /// adds the result to blurred, which must be the size of image. kernelOf(wire, tick) gives
+  /// the tick kernel of a bin with charge: an odd number of weights, centred on the bin.
+  /// The wire kernel bridges dead wires (see WireWeights)
+  template <typename KernelOf>
+  void BlurImage(BlurredImage const& image,
+                 std::vector<bool> const& deadWires,
+                 std::vector<float> const& wireKernel,
+                 KernelOf&& kernelOf,
+                 BlurredImage& blurred);
+
+  /// Labels the groups of connected bins above threshold, two bins being connected if they
+  /// are at most wireDistance wires and tickDistance ticks apart. Fills the label of each bin,
+  /// -1 for the bins at or below threshold, and returns the number of groups
+  int LabelComponents(BlurredImage const& image,
+                      float threshold,
+                      int wireDistance,
+                      int tickDistance,
+                      std::vector<int>& labels);
+
+} // namespace cluster
+
+template <typename KernelOf>
+void cluster::BlurImage(BlurredImage const& image,
+                        std::vector<bool> const& deadWires,
+                        std::vector<float> const& wireKernel,
+                        KernelOf&& kernelOf,
+                        BlurredImage& blurred)
+{
+  int const nTicks = image.NTicks();
+  std::vector<float> row(nTicks, 0.f);
+  std::vector<std::pair<int, float>> weights;
+
+  for (int wire = 0; wire < image.NWires(); ++wire) {
+
+    // Blur the charge of the wire along the ticks, keeping the range of the row it reaches
+    float const* in = image.Row(wire);
+    int rowBegin = nTicks, rowEnd = 0;
+    for (int tick = 0; tick < nTicks; ++tick) {
+      if (in[tick] == 0) continue;
+      std::vector<float> const& kernel = kernelOf(wire, tick);
+      int const halfWidth = kernel.size() / 2;
+      int const first = std::max(tick - halfWidth, 0);
+      int const last = std::min(tick + halfWidth + 1, nTicks);
+      for (int t = first; t < last; ++t)
+        row[t] += kernel[t - tick + halfWidth] * in[tick];
+      rowBegin = std::min(rowBegin, first);
+      rowEnd = std::max(rowEnd, last);
+    }
+    if (rowBegin >= rowEnd) continue;
+
+    // Smear the runs of the row with charge across the wires
+    WireWeights(wire, deadWires, wireKernel, weights);
+    for (int first = rowBegin; first < rowEnd;) {
+      if (row[first] == 0) {
+        ++first;
+        continue;
+      }
+      int last = first + 1;
+      while (last < rowEnd && row[last] != 0)
+        ++last;
+      for (auto const& [target, weight] : weights) {
+        float* out = blurred.Row(target);
+        for (int t = first; t < last; ++t)
+          out[t] += weight * row[t];
+      }
+      first = last;
+    }
+    std::fill(row.begin() + rowBegin, row.begin() + rowEnd, 0.f);
+  }
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Voronoi/DCEL.h"
 namespace recob {
   class Hit;
@@ -131,6 +132,10 @@ namespace reco {
                  const std::vector<geo::WireID>& wireIDVec);
 
     ClusterHit3D(const ClusterHit3D&);
+    ClusterHit3D(ClusterHit3D&&) = default;
+
+    ClusterHit3D& operator=(const ClusterHit3D&) = default;
+    ClusterHit3D& operator=(ClusterHit3D&&) = default;
 
     void initialize(size_t id,
                     unsigned int statusBits,
@@ -319,23 +324,36 @@ namespace reco {
 
   /**
  *  @brief export some data structure definitions
+ *
+ *         The lists and maps filled per event take their memory from the event arena (see
+ *         EventArena.h) and the 3D hits themselves live in a chunked vector so their addresses
+ *         stay valid as it grows
  */
-  using Hit2DListPtr = std::list<const reco::ClusterHit2D*>;
-  using HitPairListPtr = std::list<const reco::ClusterHit3D*>;
+  template <typename T>
+  using ArenaList = std::list<T, ArenaAllocator<T>>;
+  template <typename Key, typename Value>
+  using ArenaUnorderedMap = std::unordered_map<Key,
+                                               Value,
+                                               std::hash<Key>,
+                                               std::equal_to<Key>,
+                                               ArenaAllocator<std::pair<const Key, Value>>>;
+
+  using Hit2DListPtr = ArenaList<const reco::ClusterHit2D*>;
+  using HitPairListPtr = ArenaList<const reco::ClusterHit3D*>;
   using HitPairSetPtr = std::set<const reco::ClusterHit3D*>;
-  using HitPairListPtrList = std::list<HitPairListPtr>;
+  using HitPairListPtrList = ArenaList<HitPairListPtr>;
   using HitPairClusterMap = std::map<int, HitPairListPtr>;
-  using HitPairList = std::list<reco::ClusterHit3D>;
+  using HitPairList = ChunkedVector<reco::ClusterHit3D>;
   //using HitPairList              = std::list<std::unique_ptr<reco::ClusterHit3D>>;
 
   using PCAHitPairClusterMapPair =
     std::pair<reco::PrincipalComponents, reco::HitPairClusterMap::iterator>;
   using PlaneToClusterParamsMap = std::map<size_t, RecobClusterParameters>;
   using EdgeTuple = std::tuple<const reco::ClusterHit3D*, const reco::ClusterHit3D*, double>;
-  using EdgeList = std::list<EdgeTuple>;
+  using EdgeList = ArenaList<EdgeTuple>;
   using Hit3DToEdgePair = std::pair<const reco::ClusterHit3D*, reco::EdgeList>;
-  using Hit3DToEdgeMap = std::unordered_map<const reco::ClusterHit3D*, reco::EdgeList>;
-  using Hit2DToHit3DListMap = std::unordered_map<const reco::ClusterHit2D*, reco::HitPairListPtr>;
+  using Hit3DToEdgeMap = ArenaUnorderedMap<const reco::ClusterHit3D*, reco::EdgeList>;
+  using Hit2DToHit3DListMap = ArenaUnorderedMap<const reco::ClusterHit2D*, reco::HitPairListPtr>;
   //using VertexPoint              = Eigen::Vector3f;
   //using VertexPointList          = std::list<Eigen::Vector3f>;
 
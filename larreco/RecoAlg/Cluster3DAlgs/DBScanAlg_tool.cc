@@ -18,9 +18,10 @@
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterParamsBuilder.h"
-#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
 
 // std includes
+#include <deque>
 #include <memory>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -77,10 +78,11 @@ namespace lar_cluster3d {
     /**
      *  @brief the main routine for DBScan
      */
-    void expandCluster(const kdTree::KdTreeNode&,
-                       kdTree::CandPairList&,
+    void expandCluster(const FlatKdTree&,
+                       const FlatKdTree::CandPairVec&,
                        reco::ClusterParameters&,
-                       size_t) const;
+                       size_t,
+                       cet::cpu_timer&) const;
 
     /**
      *  @brief Data members to follow
@@ -90,8 +92,8 @@ namespace lar_cluster3d {
     mutable std::vector<float> m_timeVector; ///<
 
     std::unique_ptr<lar_cluster3d::IClusterParametersBuilder>
-      m_clusterBuilder; ///<  Common cluster builder tool
-    kdTree m_kdTree;    // For the kdTree
+      m_clusterBuilder;                 ///<  Common cluster builder tool
+    fhicl::ParameterSet m_kdTreeParams; ///<  Configuration of the kdTree built by each call
   };
 
   DBScanAlg::DBScanAlg(fhicl::ParameterSet const& pset) { this->configure(pset); }
@@ -126,7 +128,7 @@ namespace lar_cluster3d {
 
     kdTreeParams.put_or_replace<float>("RefLeafBestDist", maxBestDist);
 
-    m_kdTree = kdTree(kdTreeParams);
+    m_kdTreeParams = kdTreeParams;
   }
 
   void DBScanAlg::Cluster3DHits(reco::HitPairList& hitPairList,
@@ -143,13 +145,20 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    FlatKdTree kdTree(m_kdTreeParams);
 
-    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
+    kdTree.BuildKdTree(hitPairList);
+
+    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = kdTree.getTimeToExecute();
 
     if (m_enableMonitoring) theClockDBScan.start();
 
+    // Time spent in the neighborhood searches
+    cet::cpu_timer theClockSearch;
+
+    // The neighborhood of the current hit, reused for all hits
+    FlatKdTree::CandPairVec candPairVec;
+
     // Ok, here we go!
     // The idea is to loop through all of the input 3D hits and do the clustering
     for (const auto& hit : hitPairList) {
@@ -160,12 +169,14 @@ namespace lar_cluster3d {
       hit.setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
       // Find the neighborhood for this hit
-      kdTree::CandPairList candPairList;
       float bestDistance(std::numeric_limits<float>::max());
 
-      m_kdTree.FindNearestNeighbors(&hit, topNode, candPairList, bestDistance);
+      candPairVec.clear();
+      if (m_enableMonitoring) theClockSearch.start();
+      kdTree.FindNearestNeighbors(&hit, candPairVec, bestDistance);
+      if (m_enableMonitoring) theClockSearch.stop();
 
-      if (candPairList.size() < m_minPairPts) {
+      if (candPairVec.size() < m_minPairPts) {
         hit.setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
       }
       else {
@@ -178,7 +189,7 @@ namespace lar_cluster3d {
         curCluster.addHit3D(&hit);
 
         // expand the cluster
-        expandCluster(topNode, candPairList, curCluster, m_minPairPts);
+        expandCluster(kdTree, candPairVec, curCluster, m_minPairPts, theClockSearch);
       }
     }
 
@@ -186,6 +197,7 @@ namespace lar_cluster3d {
       theClockDBScan.stop();
 
       m_timeVector[RUNDBSCAN] = theClockDBScan.accumulated_real_time();
+      m_timeVector[NEIGHBORSEARCH] = theClockSearch.accumulated_real_time();
     }
 
     // Initial clustering is done, now trim the list and get output parameters
@@ -222,13 +234,20 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    FlatKdTree kdTree(m_kdTreeParams);
 
-    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
+    kdTree.BuildKdTree(hitPairList);
+
+    if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = kdTree.getTimeToExecute();
 
     if (m_enableMonitoring) theClockDBScan.start();
 
+    // Time spent in the neighborhood searches
+    cet::cpu_timer theClockSearch;
+
+    // The neighborhood of the current hit, reused for all hits
+    FlatKdTree::CandPairVec candPairVec;
+
     // Ok, here we go!
     // The idea is to loop through all of the input 3D hits and do the clustering
     for (const auto& hit : hitPairList) {
@@ -239,12 +258,14 @@ namespace lar_cluster3d {
       hit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
       // Find the neighborhood for this hit
-      kdTree::CandPairList candPairList;
       float bestDistance(std::numeric_limits<float>::max());
 
-      m_kdTree.FindNearestNeighbors(hit, topNode, candPairList, bestDistance);
+      candPairVec.clear();
+      if (m_enableMonitoring) theClockSearch.start();
+      kdTree.FindNearestNeighbors(hit, candPairVec, bestDistance);
+      if (m_enableMonitoring) theClockSearch.stop();
 
-      if (candPairList.size() < m_minPairPts) {
+      if (candPairVec.size() < m_minPairPts) {
         hit->setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
       }
       else {
@@ -257,7 +278,7 @@ namespace lar_cluster3d {
         curCluster.addHit3D(hit);
 
         // expand the cluster
-        expandCluster(topNode, candPairList, curCluster, m_minPairPts);
+        expandCluster(kdTree, candPairVec, curCluster, m_minPairPts, theClockSearch);
       }
     }
 
@@ -265,6 +286,7 @@ namespace lar_cluster3d {
       theClockDBScan.stop();
 
       m_timeVector[RUNDBSCAN] = theClockDBScan.accumulated_real_time();
+      m_timeVector[NEIGHBORSEARCH] = theClockSearch.accumulated_real_time();
     }
 
     // Initial clustering is done, now trim the list and get output parameters
@@ -287,12 +309,15 @@ namespace lar_cluster3d {
     return;
   }
 
-  void DBScanAlg::expandCluster(const kdTree::KdTreeNode& topNode,
-                                kdTree::CandPairList& candPairList,
+  void DBScanAlg::expandCluster(const FlatKdTree& kdTree,
+                                const FlatKdTree::CandPairVec& candPairVec,
                                 reco::ClusterParameters& cluster,
-                                size_t minPts) const
+                                size_t minPts,
+                                cet::cpu_timer& theClockSearch) const
   {
     // This is the main inside loop for the DBScan based clustering algorithm
+    std::deque<FlatKdTree::CandPair> candPairList(candPairVec.begin(), candPairVec.end());
+    FlatKdTree::CandPairVec neighborCandPairVec;
 
     // Loop over added hits until list has been exhausted
     while (!candPairList.empty()) {
@@ -305,16 +330,17 @@ namespace lar_cluster3d {
         neighborHit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
         // get the neighborhood around this point
-        kdTree::CandPairList neighborCandPairList;
         float bestDistance(std::numeric_limits<float>::max());
 
-        m_kdTree.FindNearestNeighbors(neighborHit, topNode, neighborCandPairList, bestDistance);
+        neighborCandPairVec.clear();
+        if (m_enableMonitoring) theClockSearch.start();
+        kdTree.FindNearestNeighbors(neighborHit, neighborCandPairVec, bestDistance);
+        if (m_enableMonitoring) theClockSearch.stop();
 
         // If the epsilon neighborhood of this point is large enough then add its points to our list
-        if (neighborCandPairList.size() >= minPts) {
-          std::copy(neighborCandPairList.begin(),
-                    neighborCandPairList.end(),
-                    std::back_inserter(candPairList));
+        if (neighborCandPairVec.size() >= minPts) {
+          candPairList.insert(
+            candPairList.end(), neighborCandPairVec.begin(), neighborCandPairVec.end());
         }
       }
 
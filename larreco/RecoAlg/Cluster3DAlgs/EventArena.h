@@ -0,0 +1,475 @@
+/**
+ *  @file   EventArena.h
+ *
+ *  @brief  Event scoped memory arena, and the containers built on it, for the 3D clustering
+ *
+ *          The Cluster3D module opens an EventArena::Scope at the start of each event. While
+ *          the scope is open, every container using an ArenaAllocator that is created on that
+ *          thread takes its memory from the arena, so the large number of small list and map
+ *          nodes made while building 3D hits, clusters and edges come out of a few big blocks,
+ *          all of which are returned in one step when the arena goes away. Containers created
+ *          outside of a scope simply use the heap.
+ *
+ *          Containers taking their memory from an arena must not outlive it. Tasks running
+ *          concurrently within an event open a SharedScope, see there.
+ *
+ */
+#ifndef EventArena_h
+#define EventArena_h
+
+// std includes
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace reco {
+
+  /**
+   *  @brief  Owns the memory handed out to the containers of one event
+   */
+  class EventArena {
+  public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  initialBlockSize  size of the first block requested from the heap
+     */
+    explicit EventArena(std::size_t initialBlockSize = 1 << 20)
+      : fMonotonic(initialBlockSize, &fCounter), fPool(&fMonotonic), fLocking(&fPool)
+    {}
+
+    EventArena(const EventArena&) = delete;
+    EventArena& operator=(const EventArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &fLocking; }
+
+    /**
+     *  @brief  The number of blocks and bytes the arena (and its task arenas) requested from the heap
+     */
+    std::size_t getNumHeapBlocks() const
+    {
+      std::size_t numBlocks = fCounter.fNumBlocks;
+      for (const auto& threadArena : fThreadArenas)
+        numBlocks += threadArena.second->getNumHeapBlocks();
+      return numBlocks;
+    }
+
+    std::size_t getNumHeapBytes() const
+    {
+      std::size_t numBytes = fCounter.fNumBytes;
+      for (const auto& threadArena : fThreadArenas)
+        numBytes += threadArena.second->getNumHeapBytes();
+      return numBytes;
+    }
+
+    /**
+     *  @brief  The resource for containers created now on this thread, the heap if no scope is open
+     */
+    static std::pmr::memory_resource* current()
+    {
+      return fCurrent ? fCurrent : std::pmr::new_delete_resource();
+    }
+
+    /**
+     *  @brief  Makes an arena the current one on this thread for the lifetime of the scope
+     */
+    class Scope {
+    public:
+      explicit Scope(EventArena& arena) : fPrevious(fCurrent) { fCurrent = arena.resource(); }
+      ~Scope() { fCurrent = fPrevious; }
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+    private:
+      std::pmr::memory_resource* fPrevious;
+    };
+
+    /**
+     *  @brief  Lets concurrent tasks work on the containers of the arena for the lifetime of the scope
+     *
+     *          While the scope is open the memory of the containers already in the arena is handed
+     *          out and taken back under a lock. Each task should open a Scope on taskArena() so the
+     *          containers it makes take their memory, without locking, from an arena of its own
+     *          thread. Task arenas belong to this arena and go away with it.
+     */
+    class SharedScope {
+    public:
+      explicit SharedScope(EventArena& arena) : fArena(arena) { fArena.fLocking.setShared(true); }
+      ~SharedScope() { fArena.fLocking.setShared(false); }
+
+      SharedScope(const SharedScope&) = delete;
+      SharedScope& operator=(const SharedScope&) = delete;
+
+      /**
+       *  @brief  The arena for the tasks running on the calling thread
+       */
+      EventArena& taskArena() { return fArena.threadArena(); }
+
+    private:
+      EventArena& fArena;
+    };
+
+  private:
+    static constexpr std::size_t kThreadArenaBlockSize = 1 << 16;
+
+    /**
+     *  @brief  Arena of the calling thread, made on the first request
+     */
+    EventArena& threadArena()
+    {
+      std::lock_guard<std::mutex> lock(fThreadArenasMutex);
+      std::unique_ptr<EventArena>& threadArena = fThreadArenas[std::this_thread::get_id()];
+      if (!threadArena) threadArena = std::make_unique<EventArena>(kThreadArenaBlockSize);
+      return *threadArena;
+    }
+
+    /**
+     *  @brief  Passes requests on to the pool, under a lock while the arena is shared
+     */
+    class LockingResource : public std::pmr::memory_resource {
+    public:
+      explicit LockingResource(std::pmr::memory_resource* upstream) : fUpstream(upstream) {}
+
+      void setShared(bool shared) { fShared.store(shared, std::memory_order_relaxed); }
+
+    private:
+      void* do_allocate(std::size_t bytes, std::size_t alignment) override
+      {
+        if (!fShared.load(std::memory_order_relaxed))
+          return fUpstream->allocate(bytes, alignment);
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fUpstream->allocate(bytes, alignment);
+      }
+
+      void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+      {
+        if (!fShared.load(std::memory_order_relaxed))
+          return fUpstream->deallocate(ptr, bytes, alignment);
+        std::lock_guard<std::mutex> lock(fMutex);
+        fUpstream->deallocate(ptr, bytes, alignment);
+      }
+
+      bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+      {
+        return this == &other;
+      }
+
+      std::pmr::memory_resource* fUpstream;
+      std::atomic<bool> fShared{false};
+      std::mutex fMutex;
+    };
+
+    /**
+     *  @brief  Heap resource keeping count of what the arena asks for
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+      std::size_t fNumBlocks{0};
+      std::size_t fNumBytes{0};
+
+    private:
+      void* do_allocate(std::size_t bytes, std::size_t alignment) override
+      {
+        fNumBlocks++;
+        fNumBytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+      }
+
+      void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+      {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+      }
+
+      bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+      {
+        return this == &other;
+      }
+    };
+
+    CountingResource fCounter;                     ///< Where the memory really comes from
+    std::pmr::monotonic_buffer_resource fMonotonic; ///< Hands out blocks, frees all at the end
+    std::pmr::unsynchronized_pool_resource fPool;  ///< Recycles the nodes freed during the event
+    LockingResource fLocking;                      ///< What the containers see, see SharedScope
+
+    std::mutex fThreadArenasMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<EventArena>> fThreadArenas;
+
+    static inline thread_local std::pmr::memory_resource* fCurrent = nullptr;
+  };
+
+  /**
+   *  @brief  Allocator bound to the arena current when it (or the container using it) is created
+   *
+   *          Memory is never moved between resources on assignment or swap, and a copied
+   *          container takes its memory from the arena current at the time of the copy.
+   */
+  template <typename T>
+  class ArenaAllocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAllocator() noexcept : fResource(EventArena::current()) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : fResource(other.resource())
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      return static_cast<T*>(fResource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) { fResource->deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    std::pmr::memory_resource* resource() const { return fResource; }
+
+  private:
+    std::pmr::memory_resource* fResource;
+  };
+
+  template <typename T, typename U>
+  bool operator==(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+  {
+    return left.resource() == right.resource();
+  }
+
+  template <typename T, typename U>
+  bool operator!=(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+  {
+    return !(left == right);
+  }
+
+  /**
+   *  @brief  Vector like container storing its elements in fixed size chunks
+   *
+   *          Elements never move when the container grows, so pointers to them stay valid
+   *          until the container is cleared (or sorted). Chunks come from the arena.
+   */
+  template <typename T, std::size_t ChunkBits = 10>
+  class ChunkedVector {
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static constexpr size_type kChunkSize = size_type(1) << ChunkBits;
+
+    template <bool IsConst>
+    class Iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = std::conditional_t<IsConst, const T*, T*>;
+      using reference = std::conditional_t<IsConst, const T&, T&>;
+      using Container = std::conditional_t<IsConst, const ChunkedVector, ChunkedVector>;
+
+      Iterator() = default;
+      Iterator(Container* container, size_type index) : fContainer(container), fIndex(index) {}
+
+      template <bool C = IsConst, typename = std::enable_if_t<C>>
+      Iterator(const Iterator<false>& other) : fContainer(other.fContainer), fIndex(other.fIndex)
+      {}
+
+      reference operator*() const { return (*fContainer)[fIndex]; }
+      pointer operator->() const { return &(*fContainer)[fIndex]; }
+      reference operator[](difference_type offset) const { return (*fContainer)[fIndex + offset]; }
+
+      Iterator& operator++()
+      {
+        ++fIndex;
+        return *this;
+      }
+      Iterator operator++(int)
+      {
+        Iterator previous(*this);
+        ++fIndex;
+        return previous;
+      }
+      Iterator& operator--()
+      {
+        --fIndex;
+        return *this;
+      }
+      Iterator operator--(int)
+      {
+        Iterator previous(*this);
+        --fIndex;
+        return previous;
+      }
+      Iterator& operator+=(difference_type offset)
+      {
+        fIndex += offset;
+        return *this;
+      }
+      Iterator& operator-=(difference_type offset)
+      {
+        fIndex -= offset;
+        return *this;
+      }
+      Iterator operator+(difference_type offset) const { return Iterator(fContainer, fIndex + offset); }
+      Iterator operator-(difference_type offset) const { return Iterator(fContainer, fIndex - offset); }
+      friend Iterator operator+(difference_type offset, const Iterator& itr) { return itr + offset; }
+
+      difference_type operator-(const Iterator& other) const
+      {
+        return difference_type(fIndex) - difference_type(other.fIndex);
+      }
+
+      bool operator==(const Iterator& other) const { return fIndex == other.fIndex; }
+      bool operator!=(const Iterator& other) const { return fIndex != other.fIndex; }
+      bool operator<(const Iterator& other) const { return fIndex < other.fIndex; }
+      bool operator>(const Iterator& other) const { return fIndex > other.fIndex; }
+      bool operator<=(const Iterator& other) const { return fIndex <= other.fIndex; }
+      bool operator>=(const Iterator& other) const { return fIndex >= other.fIndex; }
+
+    private:
+      friend class Iterator<!IsConst>;
+
+      Container* fContainer{nullptr};
+      size_type fIndex{0};
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ChunkedVector() = default;
+
+    ChunkedVector(const ChunkedVector&) = delete;
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+    ChunkedVector(ChunkedVector&& other) noexcept
+      : fChunks(std::move(other.fChunks)), fSize(other.fSize), fAllocator(other.fAllocator)
+    {
+      other.fChunks.clear();
+      other.fSize = 0;
+    }
+
+    ChunkedVector& operator=(ChunkedVector&& other)
+    {
+      if (this == &other) return *this;
+
+      clear();
+
+      if (fAllocator == other.fAllocator) {
+        releaseChunks();
+        std::swap(fChunks, other.fChunks);
+        std::swap(fSize, other.fSize);
+      }
+      else {
+        for (auto& element : other)
+          emplace_back(std::move(element));
+        other.clear();
+      }
+
+      return *this;
+    }
+
+    ~ChunkedVector()
+    {
+      clear();
+      releaseChunks();
+    }
+
+    size_type size() const { return fSize; }
+    bool empty() const { return fSize == 0; }
+
+    T& operator[](size_type index) { return fChunks[index >> ChunkBits][index & (kChunkSize - 1)]; }
+    const T& operator[](size_type index) const
+    {
+      return fChunks[index >> ChunkBits][index & (kChunkSize - 1)];
+    }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[fSize - 1]; }
+    const T& back() const { return (*this)[fSize - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, fSize); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, fSize); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    /**
+     *  @brief  Make sure there is room for numElements without allocating again
+     */
+    void reserve(size_type numElements)
+    {
+      while (fChunks.size() * kChunkSize < numElements)
+        fChunks.push_back(fAllocator.allocate(kChunkSize));
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      if (fSize == fChunks.size() * kChunkSize) fChunks.push_back(fAllocator.allocate(kChunkSize));
+
+      T* element = ::new (static_cast<void*>(&(*this)[fSize])) T(std::forward<Args>(args)...);
+
+      fSize++;
+
+      return *element;
+    }
+
+    void push_back(const T& element) { emplace_back(element); }
+    void push_back(T&& element) { emplace_back(std::move(element)); }
+
+    /**
+     *  @brief  Destroys the elements, the chunks are kept for reuse
+     */
+    void clear()
+    {
+      for (size_type index = 0; index < fSize; index++)
+        (*this)[index].~T();
+
+      fSize = 0;
+    }
+
+    /**
+     *  @brief  Stable sort, like std::list::sort (but the elements do move)
+     */
+    template <typename Compare>
+    void sort(Compare compare)
+    {
+      std::stable_sort(begin(), end(), compare);
+    }
+
+  private:
+    void releaseChunks()
+    {
+      for (auto& chunk : fChunks)
+        fAllocator.deallocate(chunk, kChunkSize);
+
+      fChunks.clear();
+    }
+
+    std::vector<T*, ArenaAllocator<T*>> fChunks;
+    size_type fSize{0};
+    ArenaAllocator<T> fAllocator;
+  };
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+/**
+ *  @file   FlatKdTree.cxx
+ *
+ *  @brief  Array backed kd tree for the neighborhood searches in 3D clustering
+ *
+ */
+
+// Framework Includes
+#include "cetlib/cpu_timer.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// LArSoft includes
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// implementation follows
+
+namespace lar_cluster3d {
+
+  FlatKdTree::FlatKdTree(fhicl::ParameterSet const& pset) { this->configure(pset); }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void FlatKdTree::configure(fhicl::ParameterSet const& pset)
+  {
+    fEnableMonitoring = pset.get<bool>("EnableMonitoring", true);
+    fPairSigmaPeakTime = pset.get<float>("PairSigmaPeakTime", 3.);
+    fRefLeafBestDist = pset.get<float>("RefLeafBestDist", 0.5);
+    fLeafBucketSize = std::max(pset.get<unsigned int>("LeafBucketSize", 1), 1u);
+
+    fTimeToBuild = 0;
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  void FlatKdTree::BuildKdTree(const reco::HitPairList& hitPairList)
+  {
+    cet::cpu_timer theClockBuildNeighborhood;
+
+    if (fEnableMonitoring) theClockBuildNeighborhood.start();
+
+    Hit3DVec hit3DVec;
+
+    hit3DVec.reserve(hitPairList.size());
+
+    for (const auto& hit : hitPairList)
+      hit3DVec.emplace_back(&hit);
+
+    BuildKdTree(hit3DVec);
+
+    if (fEnableMonitoring) {
+      theClockBuildNeighborhood.stop();
+      fTimeToBuild = theClockBuildNeighborhood.accumulated_real_time();
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  void FlatKdTree::BuildKdTree(const reco::HitPairListPtr& hitPairList)
+  {
+    cet::cpu_timer theClockBuildNeighborhood;
+
+    if (fEnableMonitoring) theClockBuildNeighborhood.start();
+
+    Hit3DVec hit3DVec;
+
+    hit3DVec.reserve(hitPairList.size());
+
+    for (const auto& hit3D : hitPairList) {
+      // Make sure all the bits used by the clustering stage have been cleared
+      hit3D->clearStatusBits(~(reco::ClusterHit3D::HITINVIEW0 | reco::ClusterHit3D::HITINVIEW1 |
+                               reco::ClusterHit3D::HITINVIEW2));
+      for (const auto& hit2D : hit3D->getHits())
+        if (hit2D) hit2D->clearStatusBits(0xFFFFFFFF);
+      hit3DVec.emplace_back(hit3D);
+    }
+
+    BuildKdTree(hit3DVec);
+
+    if (fEnableMonitoring) {
+      theClockBuildNeighborhood.stop();
+      fTimeToBuild = theClockBuildNeighborhood.accumulated_real_time();
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  void FlatKdTree::BuildKdTree(Hit3DVec& hit3DVec)
+  {
+    std::uint32_t const nHits = hit3DVec.size();
+
+    // Positions in input order are used while sorting the index ranges below
+    for (auto& coordinate : fPosition)
+      coordinate.resize(nHits);
+
+    for (std::uint32_t idx = 0; idx < nHits; idx++) {
+      const Eigen::Vector3f position = hit3DVec[idx]->getPosition();
+
+      for (size_t axis = 0; axis < 3; axis++)
+        fPosition[axis][idx] = position[axis];
+    }
+
+    // Build on a permutation of the input, leaves then cover contiguous ranges of it
+    fOrder.resize(nHits);
+
+    std::iota(fOrder.begin(), fOrder.end(), 0);
+
+    fNodes.clear();
+    fNodes.reserve(nHits > 0 ? 2 * (nHits / fLeafBucketSize) + 1 : 0);
+
+    if (nHits > 0) BuildNode(0, nHits);
+
+    // Now store the hit quantities in leaf order
+    std::array<std::vector<float>, 3> inputPosition;
+
+    std::swap(inputPosition, fPosition);
+
+    for (size_t axis = 0; axis < 3; axis++) {
+      fPosition[axis].resize(nHits);
+      fWire[axis].resize(nHits);
+    }
+
+    fHits.resize(nHits);
+    fPeakTime.resize(nHits);
+    fSigmaPeakTime.resize(nHits);
+    fTPCKey.resize(nHits);
+
+    for (std::uint32_t idx = 0; idx < nHits; idx++) {
+      const reco::ClusterHit3D* hit3D = hit3DVec[fOrder[idx]];
+      const std::vector<geo::WireID>& wireIDs = hit3D->getWireIDs();
+
+      fHits[idx] = hit3D;
+      fPeakTime[idx] = hit3D->getAvePeakTime();
+      fSigmaPeakTime[idx] = hit3D->getSigmaPeakTime();
+      fTPCKey[idx] = TPCKey(wireIDs[0]);
+
+      for (size_t axis = 0; axis < 3; axis++) {
+        fPosition[axis][idx] = inputPosition[axis][fOrder[idx]];
+        fWire[axis][idx] = int(wireIDs[axis].Wire);
+      }
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  std::uint32_t FlatKdTree::BuildNode(std::uint32_t first, std::uint32_t last)
+  {
+    std::uint32_t const nodeIdx = fNodes.size();
+
+    fNodes.push_back({0., kLeaf, first, last});
+
+    // Small enough to be a leaf?
+    if (last - first <= fLeafBucketSize) return nodeIdx;
+
+    std::vector<std::uint32_t>::iterator firstItr = fOrder.begin() + first;
+    std::vector<std::uint32_t>::iterator lastItr = fOrder.begin() + last;
+
+    // Find the axis with the largest range, the first one in case of ties
+    std::uint32_t maxRangeIdx = 0;
+    float maxRange = 0.;
+
+    for (std::uint32_t axis = 0; axis < 3; axis++) {
+      const std::vector<float>& coordinate = fPosition[axis];
+      auto minMaxPair =
+        std::minmax_element(firstItr, lastItr, [&coordinate](const auto& left, const auto& right) {
+          return coordinate[left] < coordinate[right];
+        });
+      float range = coordinate[*minMaxPair.second] - coordinate[*minMaxPair.first];
+
+      if (axis == 0 || range > maxRange) {
+        maxRange = range;
+        maxRangeIdx = axis;
+      }
+    }
+
+    const std::vector<float>& coordinate = fPosition[maxRangeIdx];
+
+    // Sort the range so we can do the split
+    std::sort(firstItr, lastItr, [&coordinate](const auto& left, const auto& right) {
+      return coordinate[left] < coordinate[right];
+    });
+
+    std::vector<std::uint32_t>::iterator middleItr = firstItr + (last - first) / 2;
+
+    // Take care of the special case where the value of the median may be repeated so we actually
+    // want to make sure we point at the first occurence
+    if (std::distance(firstItr, middleItr) > 1) {
+      while (middleItr != firstItr + 1) {
+        if (!(coordinate[*(middleItr - 1)] < coordinate[*middleItr]))
+          middleItr--;
+        else
+          break;
+      }
+    }
+
+    std::uint32_t const middle = std::distance(fOrder.begin(), middleItr);
+    float axisVal = 0.5 * (coordinate[*middleItr] + coordinate[*(middleItr - 1)]);
+
+    // The left child is the next node by construction, only the right one needs recording
+    BuildNode(first, middle);
+
+    std::uint32_t const rightIdx = BuildNode(middle, last);
+
+    fNodes[nodeIdx] = {axisVal, maxRangeIdx, rightIdx, 0};
+
+    return nodeIdx;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  size_t FlatKdTree::FindNearestNeighbors(const reco::ClusterHit3D* refHit,
+                                          CandPairVec& candPairVec,
+                                          float& bestDist) const
+  {
+    if (fNodes.empty()) return candPairVec.size();
+
+    const std::vector<geo::WireID>& wireIDs = refHit->getWireIDs();
+    RefHit const ref{refHit,
+                     refHit->getPosition(),
+                     refHit->getAvePeakTime(),
+                     refHit->getSigmaPeakTime(),
+                     TPCKey(wireIDs[0]),
+                     {int(wireIDs[0].Wire), int(wireIDs[1].Wire), int(wireIDs[2].Wire)}};
+
+    FindNearestNeighbors(0, ref, candPairVec, bestDist);
+
+    return candPairVec.size();
+  }
+
+  void FlatKdTree::FindNearestNeighbors(std::uint32_t nodeIdx,
+                                        const RefHit& refHit,
+                                        CandPairVec& candPairVec,
+                                        float& bestDist) const
+  {
+    const Node& node = fNodes[nodeIdx];
+
+    // If at a leaf then time to decide to add hits or not
+    if (node.axis == kLeaf) {
+      for (std::uint32_t hitIdx = node.first; hitIdx < node.last; hitIdx++) {
+        // Is this the droid we are looking for?
+        if (refHit.hit == fHits[hitIdx])
+          bestDist =
+            fRefLeafBestDist; // This distance will grab neighbors with delta wire # = 1 in all three planes
+        // This is the tight constraint on the hits
+        else if (consistentPairs(refHit, hitIdx, bestDist)) {
+          candPairVec.emplace_back(bestDist, fHits[hitIdx]);
+
+          bestDist = std::max(
+            fRefLeafBestDist,
+            bestDist); // This insures we will always consider neighbors with wire # changing in 2 planes
+        }
+      }
+    }
+    // Otherwise we need to keep searching
+    else {
+      float refPosition = refHit.position[node.axis];
+
+      if (refPosition < node.splitValue) {
+        FindNearestNeighbors(nodeIdx + 1, refHit, candPairVec, bestDist);
+
+        if (refPosition + bestDist > node.splitValue)
+          FindNearestNeighbors(node.first, refHit, candPairVec, bestDist);
+      }
+      else {
+        FindNearestNeighbors(node.first, refHit, candPairVec, bestDist);
+
+        if (refPosition - bestDist < node.splitValue)
+          FindNearestNeighbors(nodeIdx + 1, refHit, candPairVec, bestDist);
+      }
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  size_t FlatKdTree::FindWithinRadius(const Eigen::Vector3f& position,
+                                      float radius,
+                                      CandPairVec& candPairVec) const
+  {
+    if (!fNodes.empty()) FindWithinRadius(0, position, radius, candPairVec);
+
+    return candPairVec.size();
+  }
+
+  void FlatKdTree::FindWithinRadius(std::uint32_t nodeIdx,
+                                    const Eigen::Vector3f& position,
+                                    float radius,
+                                    CandPairVec& candPairVec) const
+  {
+    const Node& node = fNodes[nodeIdx];
+
+    if (node.axis == kLeaf) {
+      float const radius2 = radius * radius;
+
+      for (std::uint32_t hitIdx = node.first; hitIdx < node.last; hitIdx++) {
+        float dist2 = DistanceSquared(position, hitIdx);
+
+        if (dist2 <= radius2) candPairVec.emplace_back(std::sqrt(dist2), fHits[hitIdx]);
+      }
+    }
+    else {
+      float delta = position[node.axis] - node.splitValue;
+
+      if (delta < radius) FindWithinRadius(nodeIdx + 1, position, radius, candPairVec);
+      if (delta > -radius) FindWithinRadius(node.first, position, radius, candPairVec);
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  size_t FlatKdTree::FindKNearest(const Eigen::Vector3f& position,
+                                  size_t k,
+                                  CandPairVec& candPairVec) const
+  {
+    candPairVec.clear();
+
+    if (fNodes.empty() || k == 0) return 0;
+
+    // The candidates are kept as a max heap of squared distances while searching
+    FindKNearest(0, position, k, candPairVec);
+
+    std::sort_heap(candPairVec.begin(), candPairVec.end());
+
+    for (auto& candPair : candPairVec)
+      candPair.first = std::sqrt(candPair.first);
+
+    return candPairVec.size();
+  }
+
+  void FlatKdTree::FindKNearest(std::uint32_t nodeIdx,
+                                const Eigen::Vector3f& position,
+                                size_t k,
+                                CandPairVec& candPairVec) const
+  {
+    const Node& node = fNodes[nodeIdx];
+
+    if (node.axis == kLeaf) {
+      for (std::uint32_t hitIdx = node.first; hitIdx < node.last; hitIdx++) {
+        double dist2 = DistanceSquared(position, hitIdx);
+
+        if (candPairVec.size() < k) {
+          candPairVec.emplace_back(dist2, fHits[hitIdx]);
+          std::push_heap(candPairVec.begin(), candPairVec.end());
+        }
+        else if (dist2 < candPairVec.front().first) {
+          std::pop_heap(candPairVec.begin(), candPairVec.end());
+          candPairVec.back() = CandPair(dist2, fHits[hitIdx]);
+          std::push_heap(candPairVec.begin(), candPairVec.end());
+        }
+      }
+    }
+    else {
+      float delta = position[node.axis] - node.splitValue;
+      std::uint32_t nearIdx = delta < 0. ? nodeIdx + 1 : node.first;
+      std::uint32_t farIdx = delta < 0. ? node.first : nodeIdx + 1;
+
+      FindKNearest(nearIdx, position, k, candPairVec);
+
+      if (candPairVec.size() < k || double(delta) * delta < candPairVec.front().first)
+        FindKNearest(farIdx, position, k, candPairVec);
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  bool FlatKdTree::consistentPairs(const RefHit& refHit,
+                                   std::uint32_t hitIdx,
+                                   float& bestDist) const
+  {
+    // See kdTree::consistentPairs, this is the same selection using the stored hit quantities
+
+    if (bestDist < std::numeric_limits<float>::max() && refHit.tpcKey == fTPCKey[hitIdx]) {
+      // Loose constraint to weed out the obviously bad combinations
+      if (std::fabs(refHit.peakTime - fPeakTime[hitIdx]) <
+          fPairSigmaPeakTime * (refHit.sigmaPeakTime + fSigmaPeakTime[hitIdx])) {
+        int wireDeltas[] = {std::abs(refHit.wires[0] - fWire[0][hitIdx]),
+                            std::abs(refHit.wires[1] - fWire[1][hitIdx]),
+                            std::abs(refHit.wires[2] - fWire[2][hitIdx])};
+
+        // Requirement to be considered a nearest neighbor
+        if (*std::max_element(wireDeltas, wireDeltas + 3) < 3) {
+          float deltaY = refHit.position[1] - fPosition[1][hitIdx];
+          float deltaZ = refHit.position[2] - fPosition[2][hitIdx];
+          float hitSeparation =
+            std::max(float(0.0001), std::sqrt(deltaY * deltaY + deltaZ * deltaZ));
+
+          // Final cut...
+          if (hitSeparation < bestDist) {
+            bestDist = hitSeparation;
+            return true;
+          }
+        }
+      }
+    }
+
+    return false;
+  }
+
+  float FlatKdTree::DistanceSquared(const Eigen::Vector3f& position, std::uint32_t hitIdx) const
+  {
+    float deltaX = position[0] - fPosition[0][hitIdx];
+    float deltaY = position[1] - fPosition[1][hitIdx];
+    float deltaZ = position[2] - fPosition[2][hitIdx];
+
+    return deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+  }
+
+} // namespace lar_cluster3d
@@ -0,0 +1,180 @@
+/**
+ *  @file   FlatKdTree.h
+ *
+ *  @brief  Array backed kd tree for the neighborhood searches in 3D clustering
+ *
+ *          The nodes are kept in a single vector in depth first order so the left
+ *          child of a node is always the next node and only the index of the right
+ *          child is stored. Leaves hold buckets of up to "LeafBucketSize" hits and the
+ *          hit quantities used by the searches are stored as structure of arrays in
+ *          leaf order, so a search walks contiguous memory instead of chasing pointers
+ *          into the list of 3D hits.
+ *
+ *          With a bucket size of one the tree, and the results of FindNearestNeighbors,
+ *          are identical to those of the node based kdTree.
+ *
+ */
+#ifndef FlatKdTree_h
+#define FlatKdTree_h
+
+// Framework Includes
+namespace fhicl {
+  class ParameterSet;
+}
+
+// Algorithm includes
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+
+// std includes
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_cluster3d {
+  /**
+ *  @brief  FlatKdTree class definiton
+ */
+  class FlatKdTree {
+  public:
+    /**
+     *  @brief  Default Constructor
+     */
+    FlatKdTree() = default;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pset
+     */
+    explicit FlatKdTree(fhicl::ParameterSet const& pset);
+
+    /**
+     *  @brief Configure our kdTree...
+     *
+     *  @param ParameterSet  The input set of parameters for configuration
+     */
+    void configure(fhicl::ParameterSet const& pset);
+
+    using Hit3DVec = std::vector<const reco::ClusterHit3D*>;
+    using CandPair = std::pair<double, const reco::ClusterHit3D*>;
+    using CandPairVec = std::vector<CandPair>;
+
+    /**
+     *  @brief Given an input HitPairList, build the tree (replacing any previous contents)
+     */
+    void BuildKdTree(const reco::HitPairList&);
+
+    /**
+     *  @brief Given an input HitPairListPtr, build the tree (replacing any previous contents)
+     *         after clearing the status bits used by the clustering
+     */
+    void BuildKdTree(const reco::HitPairListPtr&);
+
+    /**
+     *  @brief Appends to candPairVec the hits consistent with refHit, see kdTree for the
+     *         meaning of bestDist (which is updated as the search proceeds)
+     */
+    size_t FindNearestNeighbors(const reco::ClusterHit3D* refHit,
+                                CandPairVec& candPairVec,
+                                float& bestDist) const;
+
+    /**
+     *  @brief Appends to candPairVec all hits within radius of position (3D distance)
+     */
+    size_t FindWithinRadius(const Eigen::Vector3f& position,
+                            float radius,
+                            CandPairVec& candPairVec) const;
+
+    /**
+     *  @brief Fills candPairVec with the (up to) k hits closest to position, sorted by distance
+     */
+    size_t FindKNearest(const Eigen::Vector3f& position, size_t k, CandPairVec& candPairVec) const;
+
+    size_t size() const { return fHits.size(); }
+    bool empty() const { return fHits.empty(); }
+
+    /**
+     *  @brief If monitoring, the time to build the tree; the searches are timed by the callers,
+     *         so that a built tree is never modified and can be searched concurrently
+     */
+    float getTimeToExecute() const { return fTimeToBuild; }
+
+  private:
+    static constexpr std::uint32_t kLeaf = 3;
+
+    /**
+     *  @brief Inner nodes split on axis at splitValue, the left child follows the node and
+     *         the right one is at index "first"; leaves cover hits [first, last)
+     */
+    struct Node {
+      float splitValue;
+      std::uint32_t axis;
+      std::uint32_t first; ///< right child node for inner nodes, first hit for leaves
+      std::uint32_t last;  ///< one past the last hit for leaves
+    };
+
+    /**
+     *  @brief The quantities of the reference hit used by consistentPairs
+     */
+    struct RefHit {
+      const reco::ClusterHit3D* hit;
+      Eigen::Vector3f position;
+      float peakTime;
+      float sigmaPeakTime;
+      std::uint64_t tpcKey;
+      std::array<int, 3> wires;
+    };
+
+    void BuildKdTree(Hit3DVec&);
+    std::uint32_t BuildNode(std::uint32_t first, std::uint32_t last);
+
+    void FindNearestNeighbors(std::uint32_t nodeIdx,
+                              const RefHit& refHit,
+                              CandPairVec& candPairVec,
+                              float& bestDist) const;
+    void FindWithinRadius(std::uint32_t nodeIdx,
+                          const Eigen::Vector3f& position,
+                          float radius,
+                          CandPairVec& candPairVec) const;
+    void FindKNearest(std::uint32_t nodeIdx,
+                      const Eigen::Vector3f& position,
+                      size_t k,
+                      CandPairVec& candPairVec) const;
+
+    /**
+     *  @brief The bigger question: are two pairs of hits consistent?
+     */
+    bool consistentPairs(const RefHit& refHit, std::uint32_t hitIdx, float& bestDist) const;
+
+    float DistanceSquared(const Eigen::Vector3f& position, std::uint32_t hitIdx) const;
+
+    static std::uint64_t TPCKey(const geo::WireID& wireID)
+    {
+      return (std::uint64_t(wireID.Cryostat) << 32) | std::uint64_t(wireID.TPC);
+    }
+
+    bool fEnableMonitoring{false};    ///<
+    float fPairSigmaPeakTime{0.};     ///< Consider hits consistent if "significance" less than this
+    float fRefLeafBestDist{0.};       ///< Set neighborhood distance to this when ref leaf found
+    std::uint32_t fLeafBucketSize{1}; ///< Maximum number of hits in a leaf
+    float fTimeToBuild{0.};           ///<
+
+    // The tree and, in leaf order, the hit quantities the searches use
+    std::vector<Node> fNodes;
+    std::vector<std::uint32_t> fOrder; ///< Input index of the hits in leaf order
+    std::vector<const reco::ClusterHit3D*> fHits;
+    std::array<std::vector<float>, 3> fPosition;
+    std::vector<float> fPeakTime;
+    std::vector<float> fSigmaPeakTime;
+    std::vector<std::uint64_t> fTPCKey;
+    std::array<std::vector<int>, 3> fWire;
+  };
+
+} // namespace lar_cluster3d
+#endif
@@ -64,6 +64,7 @@ namespace lar_cluster3d {
       RUNDBSCAN = 2,
       BUILDCLUSTERINFO = 3,
       PATHFINDING = 4,
+      NEIGHBORSEARCH = 5,
       NUMTIMEVALUES
     };
 
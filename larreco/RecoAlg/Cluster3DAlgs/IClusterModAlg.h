@@ -17,6 +17,9 @@ namespace fhicl {
 // Algorithm includes
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
 
+// std includes
+#include <memory>
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 namespace art {
   class TFileDirectory;
@@ -56,6 +59,49 @@ namespace lar_cluster3d {
      */
     virtual void ModifyClusters(reco::ClusterParametersList&) const = 0;
 
+    /**
+     *  @brief Scratch state of the clusters modified by one task, see ModifyCluster
+     */
+    class Workspace {
+    public:
+      virtual ~Workspace() = default;
+    };
+    using WorkspacePtr = std::unique_ptr<Workspace>;
+
+    /**
+     *  @brief Concurrency contract: an algorithm returning true here modifies each top level
+     *         cluster of the list on its own, adding only to its daughter list. ModifyClusters
+     *         is then the same as calling ModifyCluster for each cluster in list order with one
+     *         workspace, followed by mergeWorkspace.
+     *
+     *         A caller may instead run ModifyCluster for different clusters as concurrent tasks.
+     *         A workspace is never used by two threads at once, the containers a task makes
+     *         take their memory from its own arena (see EventArena::SharedScope), and the tool
+     *         itself is only accessed through const methods. Once all tasks are done the caller
+     *         merges every workspace, in no particular order, on a single thread.
+     */
+    virtual bool clustersAreIndependent() const { return false; }
+
+    /**
+     *  @brief Make the scratch state for one task
+     */
+    virtual WorkspacePtr makeWorkspace() const { return std::make_unique<Workspace>(); }
+
+    /**
+     *  @brief Modify a single top level cluster, only used if clustersAreIndependent
+     *
+     *  @param clusterParameters The cluster to modify
+     *  @param workspace         Scratch state of the calling task
+     */
+    virtual void ModifyCluster(reco::ClusterParameters&, Workspace&) const {}
+
+    /**
+     *  @brief Apply the part of the work of a task which touches state shared between clusters
+     *
+     *  @param workspace         Scratch state of a task which is done
+     */
+    virtual void mergeWorkspace(Workspace&) const {}
+
     /**
      *  @brief If monitoring, recover the time to execute a particular function
      */
@@ -23,7 +23,7 @@
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterParamsBuilder.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PrincipalComponentsAlg.h"
-#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
 
 // std includes
 #include <iostream>
@@ -82,7 +82,7 @@ namespace lar_cluster3d {
      *  @brief Driver for Prim's algorithm
      */
     void RunPrimsAlgorithm(reco::HitPairList&,
-                           kdTree::KdTreeNode&,
+                           const FlatKdTree&,
                            reco::ClusterParametersList&) const;
 
     /**
@@ -105,7 +105,7 @@ namespace lar_cluster3d {
     /**
      *  @brief Alternative version of FindBestPathInCluster utilizing an A* algorithm
      */
-    void FindBestPathInCluster(reco::ClusterParameters&, kdTree::KdTreeNode&) const;
+    void FindBestPathInCluster(reco::ClusterParameters&, const FlatKdTree&) const;
 
     /**
      *  @brief Algorithm to find shortest path between two 3D hits
@@ -113,7 +113,7 @@ namespace lar_cluster3d {
     void AStar(const reco::ClusterHit3D*,
                const reco::ClusterHit3D*,
                float alpha,
-               kdTree::KdTreeNode&,
+               const FlatKdTree&,
                reco::ClusterParameters&) const;
 
     using BestNodeTuple = std::tuple<const reco::ClusterHit3D*, float, float>;
@@ -151,8 +151,8 @@ namespace lar_cluster3d {
 
     geo::Geometry const* m_geometry; //< pointer to the Geometry service
 
-    PrincipalComponentsAlg m_pcaAlg; // For running Principal Components Analysis
-    kdTree m_kdTree;                 // For the kdTree
+    PrincipalComponentsAlg m_pcaAlg;    // For running Principal Components Analysis
+    fhicl::ParameterSet m_kdTreeParams; // Configuration of the kdTree built by each call
 
     std::unique_ptr<lar_cluster3d::IClusterParametersBuilder>
       m_clusterBuilder; ///<  Common cluster builder tool
@@ -160,7 +160,7 @@ namespace lar_cluster3d {
 
   MinSpanTreeAlg::MinSpanTreeAlg(fhicl::ParameterSet const& pset)
     : m_pcaAlg(pset.get<fhicl::ParameterSet>("PrincipalComponentsAlg"))
-    , m_kdTree(pset.get<fhicl::ParameterSet>("kdTree"))
+    , m_kdTreeParams(pset.get<fhicl::ParameterSet>("kdTree"))
   {
     this->configure(pset);
   }
@@ -217,13 +217,14 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // The following call does this work
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    FlatKdTree kdTree(m_kdTreeParams);
 
-    if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = m_kdTree.getTimeToExecute();
+    kdTree.BuildKdTree(hitPairList);
+
+    if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = kdTree.getTimeToExecute();
 
     // Run DBScan to get candidate clusters
-    RunPrimsAlgorithm(hitPairList, topNode, clusterParametersList);
+    RunPrimsAlgorithm(hitPairList, kdTree, clusterParametersList);
 
     // Initial clustering is done, now trim the list and get output parameters
     cet::cpu_timer theClockBuildClusters;
@@ -241,7 +242,7 @@ namespace lar_cluster3d {
 
     // Test run the path finding algorithm
     for (auto& clusterParams : clusterParametersList)
-      FindBestPathInCluster(clusterParams, topNode);
+      FindBestPathInCluster(clusterParams, kdTree);
 
     mf::LogDebug("MinSpanTreeAlg") << ">>>>> Cluster3DHits done, found "
                                    << clusterParametersList.size() << " clusters" << std::endl;
@@ -251,7 +252,7 @@ namespace lar_cluster3d {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
   void MinSpanTreeAlg::RunPrimsAlgorithm(reco::HitPairList& hitPairList,
-                                         kdTree::KdTreeNode& topNode,
+                                         const FlatKdTree& kdTree,
                                          reco::ClusterParametersList& clusterParametersList) const
   {
     // If no hits then no work
@@ -260,6 +261,9 @@ namespace lar_cluster3d {
     // Now proceed with building the clusters
     cet::cpu_timer theClockDBScan;
 
+    // Time spent in the neighborhood searches
+    cet::cpu_timer theClockSearch;
+
     // Start clocks if requested
     if (m_enableMonitoring) theClockDBScan.start();
 
@@ -269,6 +273,9 @@ namespace lar_cluster3d {
     // This will contain our list of edges
     reco::EdgeList curEdgeList;
 
+    // The neighbors of the last added hit, reused for all hits
+    FlatKdTree::CandPairVec candPairVec;
+
     // Get the first point
     reco::HitPairList::iterator freeHitItr = hitPairList.begin();
     const reco::ClusterHit3D* lastAddedHit = &(*freeHitItr++);
@@ -303,16 +310,18 @@ namespace lar_cluster3d {
       curCluster->push_back(lastAddedHit);
 
       // Set up to find the list of nearest neighbors to the last used hit...
-      kdTree::CandPairList CandPairList;
       float bestDistance(1.5); //std::numeric_limits<float>::max());
 
       // And find them... result will be an unordered list of neigbors
-      m_kdTree.FindNearestNeighbors(lastAddedHit, topNode, CandPairList, bestDistance);
+      candPairVec.clear();
+      if (m_enableMonitoring) theClockSearch.start();
+      kdTree.FindNearestNeighbors(lastAddedHit, candPairVec, bestDistance);
+      if (m_enableMonitoring) theClockSearch.stop();
 
       // Copy edges to the current list (but only for hits not already in a cluster)
-      //        for(auto& pair : CandPairList)
+      //        for(auto& pair : candPairVec)
       //            if (!(pair.second->getStatusBits() & reco::ClusterHit3D::CLUSTERATTACHED)) curEdgeList.push_back(reco::EdgeTuple(lastAddedHit,pair.second,pair.first));
-      for (auto& pair : CandPairList) {
+      for (auto& pair : candPairVec) {
         if (!(pair.second->getStatusBits() & reco::ClusterHit3D::CLUSTERATTACHED)) {
           double edgeWeight = lastAddedHit->getHitChiSquare() * pair.second->getHitChiSquare();
 
@@ -372,6 +381,7 @@ namespace lar_cluster3d {
       theClockDBScan.stop();
 
       m_timeVector[RUNDBSCAN] = theClockDBScan.accumulated_real_time();
+      m_timeVector[NEIGHBORSEARCH] = theClockSearch.accumulated_real_time();
     }
 
     return;
@@ -443,7 +453,7 @@ namespace lar_cluster3d {
   }
 
   void MinSpanTreeAlg::FindBestPathInCluster(reco::ClusterParameters& clusterParams,
-                                             kdTree::KdTreeNode& topNode) const
+                                             const FlatKdTree& kdTree) const
   {
     // Set up for timing the function
     cet::cpu_timer theClockPathFinding;
@@ -512,7 +522,7 @@ namespace lar_cluster3d {
                     << std::endl;
 
           // Call the AStar function to try to find the best path...
-          //                AStar(startHit,stopHit,alpha,topNode,clusterParams);
+          //                AStar(startHit,stopHit,alpha,kdTree,clusterParams);
 
           float cost(std::numeric_limits<float>::max());
 
@@ -541,7 +551,7 @@ namespace lar_cluster3d {
   void MinSpanTreeAlg::AStar(const reco::ClusterHit3D* startNode,
                              const reco::ClusterHit3D* goalNode,
                              float alpha,
-                             kdTree::KdTreeNode& topNode,
+                             const FlatKdTree& kdTree,
                              reco::ClusterParameters& clusterParams) const
   {
     // Recover the list of hits and edges
@@ -31,6 +31,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // implementation follows
@@ -69,12 +70,42 @@ namespace lar_cluster3d {
      */
     void ModifyClusters(reco::ClusterParametersList&) const override;
 
+    /**
+     *  @brief Each top level cluster is broken up on its own, so clusters may be handled by
+     *         concurrent tasks unless histograms are being filled
+     */
+    bool clustersAreIndependent() const override { return !fFillHistograms; }
+
+    WorkspacePtr makeWorkspace() const override { return std::make_unique<PathWorkspace>(); }
+
+    /**
+     *  @brief Build the Voronoi diagram of a single top level cluster and break it into daughters
+     *
+     *  @param clusterParameters The cluster to modify
+     *  @param workspace         Scratch state of the calling task
+     */
+    void ModifyCluster(reco::ClusterParameters&, Workspace&) const override;
+
+    /**
+     *  @brief Mark the 2D hits of the daughters made by a task as used
+     */
+    void mergeWorkspace(Workspace&) const override;
+
     /**
      *  @brief If monitoring, recover the time to execute a particular function
      */
     float getTimeToExecute() const override { return fTimeToProcess; }
 
   private:
+    /**
+     *  @brief The 2D hits of the final daughters, only marked as used in mergeWorkspace since
+     *         they may be shared with the clusters of other tasks
+     */
+    class PathWorkspace : public Workspace {
+    public:
+      std::vector<const reco::ClusterHit2D*> fUsedHits;
+    };
+
     /**
      *  @brief Use PCA to try to find path in cluster
      *
@@ -183,6 +214,7 @@ namespace lar_cluster3d {
       art::make_tool<lar_cluster3d::IClusterAlg>(pset.get<fhicl::ParameterSet>("ClusterAlg"));
 
     fTimeToProcess = 0.;
+    fFillHistograms = false;
 
     return;
   }
@@ -238,92 +270,18 @@ namespace lar_cluster3d {
 
     int countClusters(0);
 
-    // This is the loop over candidate 3D clusters
-    // Note that it might be that the list of candidate clusters is modified by splitting
-    // So we use the following construct to make sure we get all of them
-    reco::ClusterParametersList::iterator clusterParametersListItr = clusterParametersList.begin();
-
-    while (clusterParametersListItr != clusterParametersList.end()) {
-      // Dereference to get the cluster paramters
-      reco::ClusterParameters& clusterParameters = *clusterParametersListItr;
+    // This is the loop over candidate 3D clusters, the daughters of each are kept with it
+    PathWorkspace workspace;
 
+    for (auto& clusterParameters : clusterParametersList) {
       std::cout << "**> Looking at Cluster " << countClusters++
                 << ", # hits: " << clusterParameters.getHitPairListPtr().size() << std::endl;
 
-      // It turns out that computing the convex hull surrounding the points in the 2D projection onto the
-      // plane of largest spread in the PCA is a good way to break up the cluster... and we do it here since
-      // we (currently) want this to be part of the standard output
-      buildVoronoiDiagram(clusterParameters);
-
-      // Make sure our cluster has enough hits...
-      if (clusterParameters.getHitPairListPtr().size() > fMinTinyClusterSize) {
-        // Get an interim cluster list
-        reco::ClusterParametersList reclusteredParameters;
-
-        // Call the main workhorse algorithm for building the local version of candidate 3D clusters
-        //******** Remind me why we need to call this at this point when the same hits will be used? ********
-        //fClusterAlg->Cluster3DHits(clusterParameters.getHitPairListPtr(), reclusteredParameters);
-        reclusteredParameters.push_back(clusterParameters);
-
-        std::cout << ">>>>>>>>>>> Reclustered to " << reclusteredParameters.size()
-                  << " Clusters <<<<<<<<<<<<<<<" << std::endl;
-
-        // Only process non-empty results
-        if (!reclusteredParameters.empty()) {
-          // Loop over the reclustered set
-          for (auto& cluster : reclusteredParameters) {
-            std::cout << "****> Calling breakIntoTinyBits with "
-                      << cluster.getHitPairListPtr().size() << " hits" << std::endl;
-
-            // It turns out that computing the convex hull surrounding the points in the 2D projection onto the
-            // plane of largest spread in the PCA is a good way to break up the cluster... and we do it here since
-            // we (currently) want this to be part of the standard output
-            buildConvexHull(cluster, 2);
-
-            // Break our cluster into smaller elements...
-            subDivideCluster(cluster,
-                             cluster.getFullPCA(),
-                             cluster.daughterList().end(),
-                             cluster.daughterList(),
-                             4);
-
-            std::cout << "****> Broke Cluster with " << cluster.getHitPairListPtr().size()
-                      << " into " << cluster.daughterList().size() << " sub clusters";
-            for (auto& clus : cluster.daughterList())
-              std::cout << ", " << clus.getHitPairListPtr().size();
-            std::cout << std::endl;
-
-            // Add the daughters to the cluster
-            clusterParameters.daughterList().insert(clusterParameters.daughterList().end(),
-                                                    cluster);
-
-            // If filling histograms we do the main cluster here
-            if (fFillHistograms) {
-              reco::PrincipalComponents& fullPCA = cluster.getFullPCA();
-              std::vector<double> eigenValVec = {3. * std::sqrt(fullPCA.getEigenValues()[0]),
-                                                 3. * std::sqrt(fullPCA.getEigenValues()[1]),
-                                                 3. * std::sqrt(fullPCA.getEigenValues()[2])};
-              double eigen2To1Ratio = eigenValVec[0] / eigenValVec[1];
-              double eigen1To0Ratio = eigenValVec[1] / eigenValVec[2];
-              double eigen2To0Ratio = eigenValVec[0] / eigenValVec[2];
-              int num3DHits = cluster.getHitPairListPtr().size();
-              int numEdges = cluster.getBestEdgeList().size();
-
-              fTopNum3DHits->Fill(std::min(num3DHits, 199), 1.);
-              fTopNumEdges->Fill(std::min(numEdges, 199), 1.);
-              fTopEigen21Ratio->Fill(eigen2To1Ratio, 1.);
-              fTopEigen20Ratio->Fill(eigen2To0Ratio, 1.);
-              fTopEigen10Ratio->Fill(eigen1To0Ratio, 1.);
-              fTopPrimaryLength->Fill(std::min(eigenValVec[0], 199.), 1.);
-            }
-          }
-        }
-      }
-
-      // Go to next cluster parameters object
-      clusterParametersListItr++;
+      ModifyCluster(clusterParameters, workspace);
     }
 
+    mergeWorkspace(workspace);
+
     if (fEnableMonitoring) {
       theClockBuildClusters.stop();
 
@@ -335,6 +293,105 @@ namespace lar_cluster3d {
     return;
   }
 
+  void VoronoiPathFinder::ModifyCluster(reco::ClusterParameters& clusterParameters,
+                                        Workspace& workspace) const
+  {
+    PathWorkspace& pathWorkspace = static_cast<PathWorkspace&>(workspace);
+
+    // It turns out that computing the convex hull surrounding the points in the 2D projection onto the
+    // plane of largest spread in the PCA is a good way to break up the cluster... and we do it here since
+    // we (currently) want this to be part of the standard output
+    buildVoronoiDiagram(clusterParameters);
+
+    // Make sure our cluster has enough hits...
+    if (clusterParameters.getHitPairListPtr().size() > fMinTinyClusterSize) {
+      // Get an interim cluster list
+      reco::ClusterParametersList reclusteredParameters;
+
+      // Call the main workhorse algorithm for building the local version of candidate 3D clusters
+      //******** Remind me why we need to call this at this point when the same hits will be used? ********
+      //fClusterAlg->Cluster3DHits(clusterParameters.getHitPairListPtr(), reclusteredParameters);
+      reclusteredParameters.push_back(clusterParameters);
+
+      std::cout << ">>>>>>>>>>> Reclustered to " << reclusteredParameters.size()
+                << " Clusters <<<<<<<<<<<<<<<" << std::endl;
+
+      // Only process non-empty results
+      if (!reclusteredParameters.empty()) {
+        // Loop over the reclustered set
+        for (auto& cluster : reclusteredParameters) {
+          std::cout << "****> Calling breakIntoTinyBits with "
+                    << cluster.getHitPairListPtr().size() << " hits" << std::endl;
+
+          // It turns out that computing the convex hull surrounding the points in the 2D projection onto the
+          // plane of largest spread in the PCA is a good way to break up the cluster... and we do it here since
+          // we (currently) want this to be part of the standard output
+          buildConvexHull(cluster, 2);
+
+          // Break our cluster into smaller elements...
+          subDivideCluster(cluster,
+                           cluster.getFullPCA(),
+                           cluster.daughterList().end(),
+                           cluster.daughterList(),
+                           4);
+
+          // The 2D hits of the daughters are marked as used when the workspace is merged
+          for (auto& daughter : cluster.daughterList()) {
+            for (const auto& hit3D : daughter.getHitPairListPtr()) {
+              for (const auto& hit2D : hit3D->getHits()) {
+                if (hit2D) pathWorkspace.fUsedHits.push_back(hit2D);
+              }
+            }
+          }
+
+          std::cout << "****> Broke Cluster with " << cluster.getHitPairListPtr().size()
+                    << " into " << cluster.daughterList().size() << " sub clusters";
+          for (auto& clus : cluster.daughterList())
+            std::cout << ", " << clus.getHitPairListPtr().size();
+          std::cout << std::endl;
+
+          // Add the daughters to the cluster
+          clusterParameters.daughterList().insert(clusterParameters.daughterList().end(),
+                                                  cluster);
+
+          // If filling histograms we do the main cluster here
+          if (fFillHistograms) {
+            reco::PrincipalComponents& fullPCA = cluster.getFullPCA();
+            std::vector<double> eigenValVec = {3. * std::sqrt(fullPCA.getEigenValues()[0]),
+                                               3. * std::sqrt(fullPCA.getEigenValues()[1]),
+                                               3. * std::sqrt(fullPCA.getEigenValues()[2])};
+            double eigen2To1Ratio = eigenValVec[0] / eigenValVec[1];
+            double eigen1To0Ratio = eigenValVec[1] / eigenValVec[2];
+            double eigen2To0Ratio = eigenValVec[0] / eigenValVec[2];
+            int num3DHits = cluster.getHitPairListPtr().size();
+            int numEdges = cluster.getBestEdgeList().size();
+
+            fTopNum3DHits->Fill(std::min(num3DHits, 199), 1.);
+            fTopNumEdges->Fill(std::min(numEdges, 199), 1.);
+            fTopEigen21Ratio->Fill(eigen2To1Ratio, 1.);
+            fTopEigen20Ratio->Fill(eigen2To0Ratio, 1.);
+            fTopEigen10Ratio->Fill(eigen1To0Ratio, 1.);
+            fTopPrimaryLength->Fill(std::min(eigenValVec[0], 199.), 1.);
+          }
+        }
+      }
+    }
+
+    return;
+  }
+
+  void VoronoiPathFinder::mergeWorkspace(Workspace& workspace) const
+  {
+    PathWorkspace& pathWorkspace = static_cast<PathWorkspace&>(workspace);
+
+    for (const auto& hit2D : pathWorkspace.fUsedHits)
+      hit2D->setStatusBit(reco::ClusterHit2D::USED);
+
+    pathWorkspace.fUsedHits.clear();
+
+    return;
+  }
+
   reco::ClusterParametersList::iterator VoronoiPathFinder::breakIntoTinyBits(
     reco::ClusterParameters& clusterToBreak,
     reco::PrincipalComponents& lastPCA,
@@ -540,10 +597,8 @@ namespace lar_cluster3d {
       }
 
       // Now add these to the new cluster
-      for (const auto& hit2D : hitSet) {
-        hit2D->setStatusBit(reco::ClusterHit2D::USED);
+      for (const auto& hit2D : hitSet)
         clusterToBreak.UpdateParameters(hit2D);
-      }
 
       std::cout << indent << "*********>>> storing new subcluster of size "
                 << clusterToBreak.getHitPairListPtr().size() << std::endl;
@@ -765,10 +820,8 @@ namespace lar_cluster3d {
         }
 
         // Now add these to the new cluster
-        for (const auto& hit2D : hitSet) {
-          hit2D->setStatusBit(reco::ClusterHit2D::USED);
+        for (const auto& hit2D : hitSet)
           clusterParams.UpdateParameters(hit2D);
-        }
 
         std::cout << indent << "*********>>> storing new subcluster of size "
                   << clusterParams.getHitPairListPtr().size() << std::endl;
@@ -15,6 +15,9 @@
 #include <iomanip>
 #include <iostream>
 
+// TBB libraries
+#include "tbb/parallel_for.h"
+
 // framework libraries
 #include "canvas/Utilities/Exception.h"
 #include "fhiclcpp/ParameterSet.h"
@@ -72,6 +75,7 @@ namespace cluster {
     fChkClusterDS = pset.get<bool>("ChkClusterDS", false);
     fVtxClusterSplit = pset.get<bool>("VtxClusterSplit", false);
     fFindStarVertices = pset.get<bool>("FindStarVertices", false);
+    fParallelPlanes = pset.get<bool>("ParallelPlanes", false);
     if (pset.has_key("HammerCluster")) {
       mf::LogWarning("CC")
         << "fcl setting HammerCluster is replaced by FindHammerClusters. Ignoring...";
@@ -119,6 +123,18 @@ namespace cluster {
       throw art::Exception(art::errors::Configuration)
         << "ClusterCrawlerAlg: Bad input from fcl file";
 
+    // the crawlers of the planes, which only hold the hits and the context of their plane
+    if (fParallelPlanes && fDebugPlane < 0) {
+      fhicl::ParameterSet planePset = pset;
+      planePset.put_or_replace("ParallelPlanes", false);
+      std::size_t nPlanes = 0;
+      for (geo::TPCID const& tpcid : geom->Iterate<geo::TPCID>())
+        nPlanes += geom->TPC(tpcid).Nplanes();
+      fPlaneCrawlers.reserve(nPlanes);
+      for (std::size_t ipl = 0; ipl < nPlanes; ++ipl)
+        fPlaneCrawlers.emplace_back(planePset);
+    }
+
   } // reconfigure
 
   // used for sorting hits on wires
@@ -151,6 +167,8 @@ namespace cluster {
     prt = false;
     vtxprt = false;
     NClusters = 0;
+    fNumHits = 0;
+    fChannelStatus = nullptr;
     clBeginSlp = 0;
     clBeginSlpErr = 0;
     clBeginTim = 0;
@@ -163,6 +181,8 @@ namespace cluster {
     clEndWir = 0;
     clEndChg = 0;
     clEndChgNear = 0;
+    fChgNearSet = false;
+    fChgNearCarried = false;
     clChisq = 0;
     clStopCode = 0;
     clProcCode = 0;
@@ -173,6 +193,7 @@ namespace cluster {
     pass = 0;
     fScaleF = 0;
     WireHitRange.clear();
+    mergeAvailable.clear();
 
     ClearResults();
   }
@@ -222,52 +243,27 @@ namespace cluster {
       inClus[iht] = 0;
       mergeAvailable[iht] = false;
     }
-
-    // FIXME (KJK): The 'cstat', 'tpc', and 'plane' class variables should be removed.
-    for (geo::TPCID const& tpcid : geom->Iterate<geo::TPCID>()) {
-      cstat = tpcid.Cryostat;
-      tpc = tpcid.TPC;
-      for (geo::PlaneID const& planeid : geom->Iterate<geo::PlaneID>(tpcid)) {
-        plane = planeid.Plane;
-        WireHitRange.clear();
-        // define a code to ensure clusters are compared within the same plane
-        clCTP = EncodeCTP(tpcid.Cryostat, tpcid.TPC, planeid.Plane);
-        cstat = tpcid.Cryostat;
-        tpc = tpcid.TPC;
-        // fill the WireHitRange vector with first/last hit on each wire
-        // dead wires and wires with no hits are flagged < 0
-        GetHitRange(clCTP);
-
-        // sanity check
-        if (WireHitRange.empty() || (fFirstWire == fLastWire)) continue;
-        raw::ChannelID_t channel = fHits[fFirstHit].Channel();
-        // get the scale factor to convert dTick/dWire to dX/dU. This is used
-        // to make the kink and merging cuts
-        float wirePitch = geom->WirePitch(geom->View(channel));
-        float tickToDist = det_prop.DriftVelocity(det_prop.Efield(), det_prop.Temperature());
-        tickToDist *= 1.e-3 * sampling_rate(clock_data); // 1e-3 is conversion of 1/us to 1/ns
-        fScaleF = tickToDist / wirePitch;
-        // convert Large Angle Cluster crawling cut to a slope cut
-        if (fLAClusAngleCut > 0)
-          fLAClusSlopeCut = std::tan(3.142 * fLAClusAngleCut / 180.) / fScaleF;
-        fMaxTime = det_prop.NumberTimeSamples();
-        fNumWires = geom->Nwires(planeid);
-        // look for clusters
-        if (fNumPass > 0) ClusterLoop();
-      } // plane
-      if (fVertex3DCut > 0) {
-        // Match vertices in 3 planes
-        VtxMatch(clock_data, det_prop, tpcid);
-        Vtx3ClusterMatch(clock_data, det_prop, tpcid);
-        if (fFindHammerClusters) FindHammerClusters(clock_data, det_prop);
-        // split clusters using 3D vertices
-        Vtx3ClusterSplit(clock_data, det_prop, tpcid);
-      }
-      if (fDebugPlane >= 0) {
-        mf::LogVerbatim("CC") << "Clustering done in TPC ";
-        PrintClusters();
-      }
-    } // for all tpcs
+    fNumHits = fHits.size();
+    fChannelStatus = &art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
+
+    // get the scale factor to convert dTick/dWire to dX/dU. This is used
+    // to make the kink and merging cuts. The wire pitch is the one of the
+    // view of the first hit, so the factor is the same in all the planes
+    raw::ChannelID_t channel = fHits[0].Channel();
+    float wirePitch = geom->WirePitch(geom->View(channel));
+    float tickToDist = det_prop.DriftVelocity(det_prop.Efield(), det_prop.Temperature());
+    tickToDist *= 1.e-3 * sampling_rate(clock_data); // 1e-3 is conversion of 1/us to 1/ns
+    float const scaleF = tickToDist / wirePitch;
+    unsigned int const maxTime = det_prop.NumberTimeSamples();
+
+    if (!fPlaneCrawlers.empty()) { CrawlPlaneContexts(clock_data, det_prop, scaleF, maxTime); }
+    else {
+      for (geo::TPCID const& tpcid : geom->Iterate<geo::TPCID>()) {
+        for (geo::PlaneID const& planeid : geom->Iterate<geo::PlaneID>(tpcid))
+          CrawlPlane(planeid, scaleF, maxTime);
+        FinishTPC(clock_data, det_prop, tpcid);
+      } // for all tpcs
+    }
 
     // clean up
     WireHitRange.clear();
@@ -281,6 +277,194 @@ namespace cluster {
 
   } // RunCrawler
 
+  ////////////////////////////////////////////////
+  bool ClusterCrawlerAlg::CrawlPlane(geo::PlaneID const& planeid,
+                                     float scaleF,
+                                     unsigned int maxTime)
+  {
+    // Looks for clusters in one plane. Returns false if the plane has no hits
+
+    // FIXME (KJK): The 'cstat', 'tpc', and 'plane' class variables should be removed.
+    cstat = planeid.Cryostat;
+    tpc = planeid.TPC;
+    plane = planeid.Plane;
+    WireHitRange.clear();
+    // define a code to ensure clusters are compared within the same plane
+    clCTP = EncodeCTP(planeid);
+    fChgNearSet = false;
+    fChgNearCarried = false;
+    // fill the WireHitRange vector with first/last hit on each wire
+    // dead wires and wires with no hits are flagged < 0
+    GetHitRange(clCTP);
+
+    // sanity check
+    if (WireHitRange.empty() || (fFirstWire == fLastWire)) return false;
+    fScaleF = scaleF;
+    // convert Large Angle Cluster crawling cut to a slope cut
+    if (fLAClusAngleCut > 0) fLAClusSlopeCut = std::tan(3.142 * fLAClusAngleCut / 180.) / fScaleF;
+    fMaxTime = maxTime;
+    fNumWires = geom->Nwires(planeid);
+    // look for clusters
+    if (fNumPass > 0) ClusterLoop();
+    return true;
+  } // CrawlPlane
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::CrawlPlaneContexts(detinfo::DetectorClocksData const& clock_data,
+                                             detinfo::DetectorPropertiesData const& det_prop,
+                                             float scaleF,
+                                             unsigned int maxTime)
+  {
+    // Crawls each plane with its own plane crawler, which holds only the hits of that plane,
+    // then collects their results in the order of the serial crawl. A plane crawler starts
+    // from the context CrawlInit leaves, while in the serial crawl a plane starts from the
+    // context left by the previous one. Of that context, the crawl of a plane reads only
+    // the nearby charge of a cluster, and only where none was found yet in the plane; it
+    // looks only at the clusters and vertices of its own plane, and its hit indices start
+    // at 0 while in the serial crawl they start at the first hit of the plane.
+    // A plane crawler is used unless any of these makes it differ from the serial crawl:
+    //  - it stored a cluster with that nearby charge and the carried one is not the same
+    //  - the cluster IDs would reach SHRT_MAX, where the serial crawl stops storing clusters
+    //  - it made no cluster, so its context may not be set as the serial crawl leaves it
+    //    for the 3D vertex matching and the next planes
+    // Such planes are crawled again here, in turn.
+
+    // the hits of each plane are contiguous, as they are sorted by wire ID
+    std::vector<geo::PlaneID> planeIDs;
+    std::vector<unsigned int> firstHits;
+    for (geo::TPCID const& tpcid : geom->Iterate<geo::TPCID>()) {
+      for (geo::PlaneID const& planeid : geom->Iterate<geo::PlaneID>(tpcid)) {
+        auto const first = std::lower_bound(
+          fHits.begin(), fHits.end(), planeid, [](recob::Hit const& hit, geo::PlaneID const& id) {
+            return hit.WireID().asPlaneID().cmp(id) < 0;
+          });
+        auto const last = std::upper_bound(
+          first, fHits.end(), planeid, [](geo::PlaneID const& id, recob::Hit const& hit) {
+            return hit.WireID().asPlaneID().cmp(id) > 0;
+          });
+        ClusterCrawlerAlg& crawler = fPlaneCrawlers[planeIDs.size()];
+        crawler.CrawlInit();
+        crawler.fHits.assign(first, last);
+        crawler.inClus.assign(crawler.fHits.size(), 0);
+        crawler.mergeAvailable.assign(crawler.fHits.size(), false);
+        crawler.fNumHits = fNumHits;
+        crawler.fChannelStatus = fChannelStatus;
+        planeIDs.push_back(planeid);
+        firstHits.push_back(first - fHits.begin());
+      } // planeid
+    }   // tpcid
+
+    float const initBeginChgNear = fPlaneCrawlers.front().clBeginChgNear;
+    float const initEndChgNear = fPlaneCrawlers.front().clEndChgNear;
+
+    std::vector<char> crawled(planeIDs.size(), false);
+    tbb::parallel_for(std::size_t(0), planeIDs.size(), [&](std::size_t ipl) {
+      crawled[ipl] = fPlaneCrawlers[ipl].CrawlPlane(planeIDs[ipl], scaleF, maxTime);
+    });
+
+    std::size_t ipl = 0;
+    for (geo::TPCID const& tpcid : geom->Iterate<geo::TPCID>()) {
+      for (geo::PlaneID const& planeid : geom->Iterate<geo::PlaneID>(tpcid)) {
+        ClusterCrawlerAlg& crawler = fPlaneCrawlers[ipl];
+        bool useCrawler = !crawled[ipl] || (!crawler.tcl.empty() &&
+                                             NClusters + crawler.NClusters < SHRT_MAX);
+        if (useCrawler && crawler.fChgNearCarried)
+          useCrawler = (clBeginChgNear == initBeginChgNear && clEndChgNear == initEndChgNear);
+        if (useCrawler)
+          AdoptPlaneContext(crawler, firstHits[ipl], crawled[ipl]);
+        else
+          CrawlPlane(planeid, scaleF, maxTime);
+        crawler.ClearResults();
+        ++ipl;
+      } // planeid
+      FinishTPC(clock_data, det_prop, tpcid);
+    } // tpcid
+
+  } // CrawlPlaneContexts
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::AdoptPlaneContext(ClusterCrawlerAlg& crawler,
+                                            unsigned int firstHit,
+                                            bool crawled)
+  {
+    // Takes over what the serial crawl would have left after crawling the plane of the
+    // crawler. Hit, cluster and vertex indices in the crawler start at 0 and are offset
+    // here. The first hit of the plane is at index firstHit in fHits
+    ClusterCrawlerPlaneContext& context = crawler;
+
+    if (!crawled) {
+      // only the plane, which was left without looking for clusters
+      cstat = context.cstat;
+      tpc = context.tpc;
+      plane = context.plane;
+      clCTP = context.clCTP;
+      fFirstWire = context.fFirstWire;
+      fLastWire = context.fLastWire;
+      WireHitRange = std::move(context.WireHitRange);
+    }
+    else {
+      // the whole context, which the 3D vertex matching and later planes may read before
+      // setting it. Only the nearby charge may not have been set in the plane
+      float const beginChgNear = clBeginChgNear;
+      float const endChgNear = clEndChgNear;
+      static_cast<ClusterCrawlerPlaneContext&>(*this) = std::move(context);
+      if (!fChgNearSet) {
+        clBeginChgNear = beginChgNear;
+        clEndChgNear = endChgNear;
+      }
+      for (unsigned int& iht : fcl2hits)
+        iht += firstHit;
+    }
+    for (auto& range : WireHitRange) {
+      if (range.first < 0) continue;
+      range.first += firstHit;
+      range.second += firstHit;
+    }
+    if (!crawled) return;
+
+    // the clusters and vertices, with IDs continuing those of the previous planes
+    short const clOffset = NClusters;
+    short const vtxOffset = vtx.size();
+    for (ClusterStore& clstr : crawler.tcl) {
+      clstr.ID += (clstr.ID > 0) ? clOffset : -clOffset;
+      if (clstr.BeginVtx >= 0) clstr.BeginVtx += vtxOffset;
+      if (clstr.EndVtx >= 0) clstr.EndVtx += vtxOffset;
+      for (unsigned int& iht : clstr.tclhits)
+        iht += firstHit;
+      tcl.push_back(std::move(clstr));
+    }
+    NClusters += crawler.NClusters;
+    vtx.insert(vtx.end(), crawler.vtx.begin(), crawler.vtx.end());
+
+    // the hits of the plane, some of which may have been merged
+    std::move(crawler.fHits.begin(), crawler.fHits.end(), fHits.begin() + firstHit);
+    for (unsigned int iht = 0; iht < crawler.inClus.size(); ++iht) {
+      short const clID = crawler.inClus[iht];
+      inClus[firstHit + iht] = (clID > 0) ? clID + clOffset : clID;
+      mergeAvailable[firstHit + iht] = crawler.mergeAvailable[iht];
+    }
+
+  } // AdoptPlaneContext
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::FinishTPC(detinfo::DetectorClocksData const& clock_data,
+                                    detinfo::DetectorPropertiesData const& det_prop,
+                                    geo::TPCID const& tpcid)
+  {
+    if (fVertex3DCut > 0) {
+      // Match vertices in 3 planes
+      VtxMatch(clock_data, det_prop, tpcid);
+      Vtx3ClusterMatch(clock_data, det_prop, tpcid);
+      if (fFindHammerClusters) FindHammerClusters(clock_data, det_prop);
+      // split clusters using 3D vertices
+      Vtx3ClusterSplit(clock_data, det_prop, tpcid);
+    }
+    if (fDebugPlane >= 0) {
+      mf::LogVerbatim("CC") << "Clustering done in TPC ";
+      PrintClusters();
+    }
+  } // FinishTPC
+
   ////////////////////////////////////////////////
   void ClusterCrawlerAlg::ClusterLoop()
   {
@@ -445,7 +629,7 @@ namespace cluster {
               }
               ClusterAdded = true;
               nHitsUsed += fcl2hits.size();
-              AllDone = (nHitsUsed == fHits.size());
+              AllDone = (nHitsUsed == fNumHits);
               break;
             }
             else {
@@ -787,6 +971,7 @@ namespace cluster {
         clBeginTim = tcl[jcl].BeginTim;
         clBeginChg = tcl[jcl].BeginChg;
         clBeginChgNear = tcl[jcl].BeginChgNear;
+        fChgNearSet = true;
         // End info from icl
         clEndSlp = tcl[icl].EndSlp;
         clEndSlpErr = tcl[icl].EndSlpErr;
@@ -1449,7 +1634,7 @@ namespace cluster {
         // DS side
         if (vtxprt)
           mf::LogVerbatim("CC") << " Chk cluster ID " << tcl[icl].ID << " with vertex " << ivx;
-        short ihvx = -99;
+        unsigned int ihvx = UINT_MAX;
         // nSplit is the index of the hit in the cluster where we will
         // split it if all requirements are met
         unsigned short nSplit = 0;
@@ -1468,7 +1653,7 @@ namespace cluster {
           }
         } // ii
         // found the wire. Now make a rough time cut
-        if (ihvx < 0) continue;
+        if (ihvx == UINT_MAX) continue;
         if (fabs(fHits[ihvx].PeakTime() - vtx[ivx].Time) > 10) continue;
         // check the angle between the crossing cluster icl and the
         // clusters that comprise the vertex.
@@ -2290,6 +2475,7 @@ namespace cluster {
         dwje = 999;
         for (jv = 0; jv < vtx.size(); ++jv) {
           if (iv == jv) continue;
+          if (vtx[jv].CTP != clCTP) continue;
           if (std::abs(vtx[jv].Time - tcl[it].BeginTim) < 50) {
             if (std::abs(vtx[jv].Wire - tcl[it].BeginWir) < dwjb)
               dwjb = std::abs(vtx[jv].Wire - tcl[it].BeginWir);
@@ -3194,6 +3380,7 @@ namespace cluster {
       clBeginTim = cl1.BeginTim;
       clBeginChg = cl1.BeginChg;
       clBeginChgNear = cl1.BeginChgNear;
+      fChgNearSet = true;
       begVtx = cl1.BeginVtx;
       del1Vtx = cl1.EndVtx;
       // and cluster 2 End info
@@ -3217,6 +3404,7 @@ namespace cluster {
       clBeginTim = cl2.BeginTim;
       clBeginChg = cl2.BeginChg;
       clBeginChgNear = cl2.BeginChgNear;
+      fChgNearSet = true;
       begVtx = cl2.BeginVtx;
       del2Vtx = cl2.EndVtx;
       // and cluster 1 End info
@@ -3427,6 +3615,7 @@ namespace cluster {
     clBeginTim = tcl[it1].BeginTim;
     clBeginChg = tcl[it1].BeginChg;
     clBeginChgNear = tcl[it1].BeginChgNear;
+    fChgNearSet = true;
     clEndSlp = tcl[it1].EndSlp;
     clEndSlpErr = tcl[it1].EndSlpErr;
     clEndAng = tcl[it1].EndAng;
@@ -3445,7 +3634,7 @@ namespace cluster {
   {
 
     if (fcl2hits.size() < 2) return false;
-    if (fcl2hits.size() > fHits.size()) return false;
+    if (fcl2hits.size() > fNumHits) return false;
 
     if (NClusters == SHRT_MAX) return false;
 
@@ -3514,6 +3703,7 @@ namespace cluster {
     clstr.BeginTim = fHits[hit0].PeakTime();
     clstr.BeginChg = clBeginChg;
     clstr.BeginChgNear = clBeginChgNear;
+    if (!fChgNearSet) fChgNearCarried = true;
     clstr.EndSlp = clEndSlp;
     clstr.EndSlpErr = clEndSlpErr;
     clstr.EndAng = std::atan(fScaleF * clEndSlp);
@@ -4110,6 +4300,7 @@ namespace cluster {
     if (chgNear.size() > 60) cnt = 30;
     clBeginChgNear = 0;
     clEndChgNear = 0;
+    fChgNearSet = true;
     for (unsigned short ids = 0; ids < cnt; ++ids) {
       clBeginChgNear += chgNear[ids];
       clEndChgNear += chgNear[chgNear.size() - 1 - ids];
@@ -4851,6 +5042,7 @@ namespace cluster {
         hit.Multiplicity() == 2) {
       bool doMerge = true;
       for (unsigned short ivx = 0; ivx < vtx.size(); ++ivx) {
+        if (vtx[ivx].CTP != clCTP) continue;
         if (std::abs(kwire - vtx[ivx].Wire) < 10 &&
             std::abs(int(hit.PeakTime() - vtx[ivx].Time)) < 20) {
           doMerge = false;
@@ -5980,8 +6172,7 @@ namespace cluster {
       ++nHitInPlane;
     }
     // overwrite with the "dead wires" condition
-    lariov::ChannelStatusProvider const& channelStatus =
-      art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
+    lariov::ChannelStatusProvider const& channelStatus = *fChannelStatus;
 
     flag.first = -1;
     flag.second = -1;
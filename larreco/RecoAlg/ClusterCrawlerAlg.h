@@ -29,10 +29,97 @@ namespace detinfo {
   class DetectorClocksData;
   class DetectorPropertiesData;
 }
+namespace lariov {
+  class ChannelStatusProvider;
+}
 
 namespace cluster {
 
-  class ClusterCrawlerAlg {
+  /// State of ClusterCrawlerAlg while it crawls one plane: the plane, the hits on each of
+  /// its wires and the cluster under construction. The planes can be crawled concurrently,
+  /// each with its own context
+  struct ClusterCrawlerPlaneContext {
+    // these variables define the cluster used during crawling
+    float clpar[3];    ///< cluster parameters for the current fit with
+                       ///< origin at the US wire on the cluster (in clpar[2])
+    float clparerr[2]; ///< cluster parameter errors
+    float clChisq;     ///< chisq of the current fit
+    float fAveChg;     ///< average charge at leading edge of cluster
+    //  float fChgRMS;  ///< average charge RMS at leading edge of cluster
+    float fChgSlp;      ///< slope of the  charge vs wire
+    float fAveHitWidth; ///< average width (EndTick - StartTick) of hits
+
+    bool prt;
+    bool vtxprt;
+
+    float clBeginSlp; ///< begin slope (= DS end = high wire number)
+    float clBeginAng;
+    float clBeginSlpErr;
+    unsigned int clBeginWir; ///< begin wire
+    float clBeginTim;        ///< begin time
+    float clBeginChg;        ///< begin average charge
+    float clBeginChgNear;    ///< nearby charge
+    float clEndSlp;          ///< slope at the end   (= US end = low  wire number)
+    float clEndAng;
+    float clEndSlpErr;
+    unsigned int clEndWir; ///< begin wire
+    float clEndTim;        ///< begin time
+    float clEndChg;        ///< end average charge
+    float clEndChgNear;    ///< nearby charge
+    bool fChgNearSet;      ///< clBeginChgNear and clEndChgNear were set in this plane
+    bool fChgNearCarried;  ///< a cluster was stored with the nearby charge from an earlier plane
+    short clStopCode;      ///< code for the reason for stopping cluster tracking
+                           ///< 0 = no signal on the next wire
+                           ///< 1 = skipped too many occupied/dead wires
+                           ///< 2 = failed the fMinWirAfterSkip cut
+                           ///< 3 = ended on a kink. Fails fKinkChiRat
+                           ///< 4 = failed the fChiCut cut
+                           ///< 5 = cluster split by VtxClusterSplit
+                           ///< 6 = stop at a vertex
+                           ///< 7 = LA crawl stopped due to slope cut
+                           ///< 8 = SPECIAL CODE FOR STEP CRAWLING
+    short clProcCode;      ///< Processor code = pass number
+                           ///< +   10 ChkMerge
+                           ///< +   20 ChkMerge with overlapping hits
+                           ///< +  100 ChkMerge12
+                           ///< +  200 ClusterFix
+                           ///< +  300 LACrawlUS
+                           ///< +  500 MergeOverlap
+                           ///< +  666 KillGarbageClusters
+                           ///< + 1000 VtxClusterSplit
+                           ///< + 2000 failed pass N cuts but passes pass N=1 cuts
+                           ///< + 5000 ChkClusterDS
+                           ///< +10000 Vtx3ClusterSplit
+    unsigned int clCTP;    ///< Cryostat/TPC/Plane code (ClusterCrawlerAlg::CTP_t)
+    bool clLA;             ///< using Large Angle crawling code
+
+    unsigned int fFirstWire; ///< the first wire with a hit
+    unsigned int fFirstHit;  ///< first hit used
+    unsigned int fLastWire;  ///< the last wire with a hit
+    unsigned int cstat;      // the current cryostat
+    unsigned int tpc;        // the current TPC
+    unsigned int plane;      // the current plane
+    unsigned int fNumWires;  // number of wires in the current plane
+    unsigned int fMaxTime;   // number of time samples in the current plane
+    float fScaleF;           ///< scale factor from Tick/Wire to dx/du
+    float fLAClusSlopeCut;   ///< Large Angle crawling cut on the slope in the current plane
+
+    unsigned short pass;
+
+    // vector of pairs of first (.first) and last+1 (.second) hit on each wire
+    // in the range fFirstWire to fLastWire. A value of -2 indicates that there
+    // are no hits on the wire. A value of -1 indicates that the wire is dead
+    std::vector<std::pair<int, int>> WireHitRange;
+
+    std::vector<unsigned int> fcl2hits; ///< vector of hits used in the cluster
+    std::vector<float> chifits;         ///< fit chisq for monitoring kinks, etc
+    std::vector<short> hitNear;         ///< Number of nearby
+                                        ///< hits that were merged have hitnear < 0
+
+    std::vector<float> chgNear; ///< charge near a cluster on each wire
+  }; // struct ClusterCrawlerPlaneContext
+
+  class ClusterCrawlerAlg : private ClusterCrawlerPlaneContext {
   public:
     // some functions to handle the CTP_t type
     typedef unsigned int CTP_t;
@@ -110,6 +197,8 @@ namespace cluster {
 
     explicit ClusterCrawlerAlg(fhicl::ParameterSet const& pset);
 
+    /// Makes the clusters of all the planes, TPC after TPC. With ParallelPlanes set the planes
+    /// are crawled concurrently; the results are the same as crawling them in turn
     void RunCrawler(detinfo::DetectorClocksData const& clock_data,
                     detinfo::DetectorPropertiesData const& det_prop,
                     std::vector<recob::Hit> const& srchits);
@@ -176,6 +265,7 @@ namespace cluster {
     bool fVtxClusterSplit;
     bool fFindStarVertices;
     //  bool fFindTrajVertices;
+    bool fParallelPlanes; ///< crawl the planes concurrently, each with its own plane context
 
     // global cuts and parameters
     float fHitErrFac;    ///< hit time error = fHitErrFac * hit RMS used for cluster fit
@@ -184,7 +274,6 @@ namespace cluster {
     float fMinHitFrac;
     float fLAClusAngleCut;            ///< call Large Angle Clustering code if > 0
     unsigned short fLAClusMaxHitsFit; ///< max hits fitted on a Large Angle cluster
-    float fLAClusSlopeCut;
     bool fMergeAllHits;
     float fHitMergeChiCut;     ///< Merge cluster hit-multiplets if the separation chisq
                                ///< is < cut. Set < 0 for no merging
@@ -201,19 +290,11 @@ namespace cluster {
     // Wires that have been determined by some filter (e.g. NoiseFilter) to be good
     std::vector<geo::WireID> fFilteredWires;
 
-    // these variables define the cluster used during crawling
-    float clpar[3];    ///< cluster parameters for the current fit with
-                       ///< origin at the US wire on the cluster (in clpar[2])
-    float clparerr[2]; ///< cluster parameter errors
-    float clChisq;     ///< chisq of the current fit
-    float fAveChg;     ///< average charge at leading edge of cluster
-    //  float fChgRMS;  ///< average charge RMS at leading edge of cluster
-    float fChgSlp;      ///< slope of the  charge vs wire
-    float fAveHitWidth; ///< average width (EndTick - StartTick) of hits
-
-    bool prt;
-    bool vtxprt;
     unsigned short NClusters;
+    unsigned int fNumHits; ///< number of hits in the event; a plane crawler holds only some
+
+    /// fetched once per event, as plane crawlers may run outside of the module thread
+    lariov::ChannelStatusProvider const* fChannelStatus;
 
     art::ServiceHandle<geo::Geometry const> geom;
 
@@ -226,71 +307,13 @@ namespace cluster {
 
     trkf::LinFitAlg fLinFitAlg;
 
-    float clBeginSlp; ///< begin slope (= DS end = high wire number)
-    float clBeginAng;
-    float clBeginSlpErr;
-    unsigned int clBeginWir; ///< begin wire
-    float clBeginTim;        ///< begin time
-    float clBeginChg;        ///< begin average charge
-    float clBeginChgNear;    ///< nearby charge
-    float clEndSlp;          ///< slope at the end   (= US end = low  wire number)
-    float clEndAng;
-    float clEndSlpErr;
-    unsigned int clEndWir; ///< begin wire
-    float clEndTim;        ///< begin time
-    float clEndChg;        ///< end average charge
-    float clEndChgNear;    ///< nearby charge
-    short clStopCode;      ///< code for the reason for stopping cluster tracking
-                           ///< 0 = no signal on the next wire
-                           ///< 1 = skipped too many occupied/dead wires
-                           ///< 2 = failed the fMinWirAfterSkip cut
-                           ///< 3 = ended on a kink. Fails fKinkChiRat
-                           ///< 4 = failed the fChiCut cut
-                           ///< 5 = cluster split by VtxClusterSplit
-                           ///< 6 = stop at a vertex
-                           ///< 7 = LA crawl stopped due to slope cut
-                           ///< 8 = SPECIAL CODE FOR STEP CRAWLING
-    short clProcCode;      ///< Processor code = pass number
-                           ///< +   10 ChkMerge
-                           ///< +   20 ChkMerge with overlapping hits
-                           ///< +  100 ChkMerge12
-                           ///< +  200 ClusterFix
-                           ///< +  300 LACrawlUS
-                           ///< +  500 MergeOverlap
-                           ///< +  666 KillGarbageClusters
-                           ///< + 1000 VtxClusterSplit
-                           ///< + 2000 failed pass N cuts but passes pass N=1 cuts
-                           ///< + 5000 ChkClusterDS
-                           ///< +10000 Vtx3ClusterSplit
-    CTP_t clCTP;           ///< Cryostat/TPC/Plane code
-    bool clLA;             ///< using Large Angle crawling code
-
-    unsigned int fFirstWire; ///< the first wire with a hit
-    unsigned int fFirstHit;  ///< first hit used
-    unsigned int fLastWire;  ///< the last wire with a hit
-    unsigned int cstat;      // the current cryostat
-    unsigned int tpc;        // the current TPC
-    unsigned int plane;      // the current plane
-    unsigned int fNumWires;  // number of wires in the current plane
-    unsigned int fMaxTime;   // number of time samples in the current plane
-    float fScaleF;           ///< scale factor from Tick/Wire to dx/du
-
-    unsigned short pass;
-
-    // vector of pairs of first (.first) and last+1 (.second) hit on each wire
-    // in the range fFirstWire to fLastWire. A value of -2 indicates that there
-    // are no hits on the wire. A value of -1 indicates that the wire is dead
-    std::vector<std::pair<int, int>> WireHitRange;
+    float fChgNearWindow; ///< window (ticks) for finding nearby charge
+    float fChgNearCut;    ///< cut on ratio of nearby/cluster charge to
+                          ///< to define a shower-like cluster
 
-    std::vector<unsigned int> fcl2hits; ///< vector of hits used in the cluster
-    std::vector<float> chifits;         ///< fit chisq for monitoring kinks, etc
-    std::vector<short> hitNear;         ///< Number of nearby
-                                        ///< hits that were merged have hitnear < 0
-
-    std::vector<float> chgNear; ///< charge near a cluster on each wire
-    float fChgNearWindow;       ///< window (ticks) for finding nearby charge
-    float fChgNearCut;          ///< cut on ratio of nearby/cluster charge to
-                                ///< to define a shower-like cluster
+    /// With ParallelPlanes, one crawler per plane, each holding the hits and the context
+    /// of its plane; made once with the same configuration
+    std::vector<ClusterCrawlerAlg> fPlaneCrawlers;
 
     std::string fhitsModuleLabel;
     // ******** crawling routines *****************
@@ -409,6 +432,19 @@ namespace cluster {
 
     // inits everything
     void CrawlInit();
+    // crawls the hits of one plane. Returns false if the plane has no hits
+    bool CrawlPlane(geo::PlaneID const& planeid, float scaleF, unsigned int maxTime);
+    // crawls the planes concurrently, each with the plane crawler holding its hits
+    void CrawlPlaneContexts(detinfo::DetectorClocksData const& clock_data,
+                            detinfo::DetectorPropertiesData const& det_prop,
+                            float scaleF,
+                            unsigned int maxTime);
+    // takes over the clusters, vertices, hits and plane context of a plane crawler
+    void AdoptPlaneContext(ClusterCrawlerAlg& crawler, unsigned int firstHit, bool crawled);
+    // matches the 2D vertices of a TPC once all of its planes are crawled
+    void FinishTPC(detinfo::DetectorClocksData const& clock_data,
+                   detinfo::DetectorPropertiesData const& det_prop,
+                   geo::TPCID const& tpcid);
     // inits the cluster stuff
     void ClusterInit();
     // fills the wirehitrange vector for the supplied Cryostat/TPC/Plane code
@@ -26,6 +26,8 @@
 
 #include "larreco/RecoAlg/CornerFinderAlg.h"
 
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art_root_io/TFileService.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include "larcore/Geometry/Geometry.h"
@@ -33,6 +35,10 @@
 #include "larcorealg/Geometry/PlaneGeo.h"
 #include "larcorealg/Geometry/TPCGeo.h"
 
+#include "TF2.h"
+
+#include <cmath>
+
 // NOTE: In the .h file I assumed this would belong in the cluster class....if
 // we decide otherwise we will need to search and replace for this
 
@@ -59,12 +65,72 @@ corner::CornerFinderAlg::CornerFinderAlg(fhicl::ParameterSet const& pset)
   , fMaxSuppress_threshold{pset.get<int>("MaxSuppress_threshold")}
   , fIntegral_bin_threshold{pset.get<float>("Integral_bin_threshold")}
   , fIntegral_fraction_threshold{pset.get<float>("Integral_fraction_threshold")}
+  , fSaveDebugHistograms{pset.get<bool>("SaveDebugHistograms", false)}
 {
   fTrimming_buffer = std::max({fConversion_func_neighborhood,
                                fDerivative_neighborhood,
                                fDerivative_BlurNeighborhood,
                                fCornerScore_neighborhood,
                                fMaxSuppress_neighborhood});
+
+  if (fDerivative_BlurNeighborhood > 10) {
+    mf::LogWarning("CornerFinderAlg")
+      << "WARNING...BlurNeighborhoods>10 not currently allowed. Shrinking to 10.";
+    fDerivative_BlurNeighborhood = 10;
+  }
+
+  //this is just a double Gaussian, exp(-(dx*dx + dy*dy)/2), applied as two 1D passes
+  for (int k = -fDerivative_BlurNeighborhood; k <= fDerivative_BlurNeighborhood; k++)
+    fBlur_kernel.push_back(std::exp(-0.5 * k * k));
+
+  if (fConversion_algorithm.compare("function") == 0) InitializeConversionKernel();
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the conversion function once for all the offsets in the neighborhood,
+// and find out if it can be applied as two 1D convolutions
+void corner::CornerFinderAlg::InitializeConversionKernel()
+{
+  const int n = fConversion_func_neighborhood;
+  const int size = 2 * n + 1;
+
+  const TF2 fConversion_TF2("fConversion_func", fConversion_func.c_str(), -20, 20, -20, 20);
+
+  fConversion_kernel.resize(size * size);
+  int a0 = 0, b0 = 0;
+  for (int a = 0; a < size; a++) {
+    for (int b = 0; b < size; b++) {
+      double const value = fConversion_TF2.Eval(a - n, b - n);
+      fConversion_kernel[a * size + b] = value;
+      if (std::abs(value) > std::abs(fConversion_kernel[a0 * size + b0])) {
+        a0 = a;
+        b0 = b;
+      }
+    }
+  }
+
+  // a kernel k(x,y) = kx(x) * ky(y) is applied as two passes of 2n+1 steps instead of one
+  // of (2n+1)^2 steps; that does not pay off for the smallest kernels
+  fConversion_kernel_x.clear();
+  fConversion_kernel_y.clear();
+  double const pivot = fConversion_kernel[a0 * size + b0];
+  if (n < 2 || pivot == 0) return;
+
+  std::vector<double> kx(size), ky(size);
+  for (int a = 0; a < size; a++)
+    kx[a] = fConversion_kernel[a * size + b0];
+  for (int b = 0; b < size; b++)
+    ky[b] = fConversion_kernel[a0 * size + b] / pivot;
+
+  for (int a = 0; a < size; a++) {
+    for (int b = 0; b < size; b++) {
+      if (std::abs(fConversion_kernel[a * size + b] - kx[a] * ky[b]) > 1e-9 * std::abs(pivot))
+        return;
+    }
+  }
+
+  fConversion_kernel_x = std::move(kx);
+  fConversion_kernel_y = std::move(ky);
 }
 
 //-----------------------------------------------------------------------------
@@ -445,79 +511,16 @@ void corner::CornerFinderAlg::attach_feature_points(TH2F const& h_wire_data,
                                                     int startx,
                                                     int starty)
 {
+  const int converted_y_bins = h_wire_data.GetNbinsY() / fConversion_bins_per_input_y;
+  const int converted_x_bins = h_wire_data.GetNbinsX() / fConversion_bins_per_input_x;
 
-  const int x_bins = h_wire_data.GetNbinsX();
-  const float x_min = h_wire_data.GetXaxis()->GetBinLowEdge(1);
-  const float x_max = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
+  create_corner_score(h_wire_data, converted_x_bins, converted_y_bins);
 
-  const int y_bins = h_wire_data.GetNbinsY();
-  const float y_min = h_wire_data.GetYaxis()->GetBinLowEdge(1);
-  const float y_max = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
+  TH2D* h_maxSuppress = nullptr;
+  if (fSaveDebugHistograms) h_maxSuppress = save_debug_histograms(h_wire_data, view);
 
-  const int converted_y_bins = y_bins / fConversion_bins_per_input_y;
-  const int converted_x_bins = x_bins / fConversion_bins_per_input_x;
-
-  std::stringstream conversion_name;
-  conversion_name << "h_conversion_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dx_name;
-  dx_name << "h_derivative_x_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dy_name;
-  dy_name << "h_derivative_y_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream cornerScore_name;
-  cornerScore_name << "h_cornerScore_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream maxSuppress_name;
-  maxSuppress_name << "h_maxSuppress_" << view << "_" << run_number << "_" << event_number;
-
-  TH2F conversion_histo(conversion_name.str().c_str(),
-                        "Image Conversion Histogram",
-                        converted_x_bins,
-                        x_min,
-                        x_max,
-                        converted_y_bins,
-                        y_min,
-                        y_max);
-
-  TH2F derivativeX_histo(dx_name.str().c_str(),
-                         "Partial Derivatives (x)",
-                         converted_x_bins,
-                         x_min,
-                         x_max,
-                         converted_y_bins,
-                         y_min,
-                         y_max);
-
-  TH2F derivativeY_histo(dy_name.str().c_str(),
-                         "Partial Derivatives (y)",
-                         converted_x_bins,
-                         x_min,
-                         x_max,
-                         converted_y_bins,
-                         y_min,
-                         y_max);
-
-  TH2D cornerScore_histo(cornerScore_name.str().c_str(),
-                         "Corner Score",
-                         converted_x_bins,
-                         x_min,
-                         x_max,
-                         converted_y_bins,
-                         y_min,
-                         y_max);
-
-  TH2D maxSuppress_histo(maxSuppress_name.str().c_str(),
-                         "Corner Points (Maximum Suppressed)",
-                         converted_x_bins,
-                         x_min,
-                         x_max,
-                         converted_y_bins,
-                         y_min,
-                         y_max);
-
-  create_image_histo(h_wire_data, conversion_histo);
-  create_derivative_histograms(conversion_histo, derivativeX_histo, derivativeY_histo);
-  create_cornerScore_histogram(derivativeX_histo, derivativeY_histo, cornerScore_histo);
   corner_vector = perform_maximum_suppression(
-    cornerScore_histo, wireIDs, view, maxSuppress_histo, startx, starty);
+    fImage_cornerScore, wireIDs, view, h_maxSuppress, startx, starty);
 }
 
 //-----------------------------------------------------------------------------
@@ -528,145 +531,144 @@ void corner::CornerFinderAlg::attach_feature_points_LineIntegralScore(
   geo::View_t view,
   std::vector<recob::EndPoint2D>& corner_vector)
 {
-  const int x_bins = h_wire_data.GetNbinsX();
-  const float x_min = h_wire_data.GetXaxis()->GetBinLowEdge(1);
-  const float x_max = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
+  const int converted_y_bins = h_wire_data.GetNbinsY() / fConversion_bins_per_input_y;
+  const int converted_x_bins = h_wire_data.GetNbinsX() / fConversion_bins_per_input_x;
+
+  create_corner_score(h_wire_data, converted_x_bins, converted_y_bins);
+
+  TH2D* h_maxSuppress = nullptr;
+  TH2F* h_lineIntegralScore = nullptr;
+  if (fSaveDebugHistograms) {
+    h_maxSuppress = save_debug_histograms(h_wire_data, view);
+
+    const int x_bins = h_wire_data.GetNbinsX();
+    const int y_bins = h_wire_data.GetNbinsY();
+    std::stringstream LI_name;
+    LI_name << "h_lineIntegralScore_" << view << "_" << run_number << "_" << event_number;
+    art::ServiceHandle<art::TFileService const> tfs;
+    h_lineIntegralScore = tfs->make<TH2F>(LI_name.str().c_str(),
+                                          "Line Integral Score",
+                                          x_bins,
+                                          h_wire_data.GetXaxis()->GetBinLowEdge(1),
+                                          h_wire_data.GetXaxis()->GetBinUpEdge(x_bins),
+                                          y_bins,
+                                          h_wire_data.GetYaxis()->GetBinLowEdge(1),
+                                          h_wire_data.GetYaxis()->GetBinUpEdge(y_bins));
+  }
 
-  const int y_bins = h_wire_data.GetNbinsY();
-  const float y_min = h_wire_data.GetYaxis()->GetBinLowEdge(1);
-  const float y_max = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
+  auto corner_vector_tmp =
+    perform_maximum_suppression(fImage_cornerScore, wireIDs, view, h_maxSuppress);
 
-  const int converted_y_bins = y_bins / fConversion_bins_per_input_y;
-  const int converted_x_bins = x_bins / fConversion_bins_per_input_x;
-
-  std::stringstream conversion_name;
-  conversion_name << "h_conversion_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dx_name;
-  dx_name << "h_derivative_x_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dy_name;
-  dy_name << "h_derivative_y_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream cornerScore_name;
-  cornerScore_name << "h_cornerScore_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream maxSuppress_name;
-  maxSuppress_name << "h_maxSuppress_" << view << "_" << run_number << "_" << event_number;
-
-  TH2F h_conversion(conversion_name.str().c_str(),
-                    "Image Conversion Histogram",
-                    converted_x_bins,
-                    x_min,
-                    x_max,
-                    converted_y_bins,
-                    y_min,
-                    y_max);
-  TH2F h_derivative_x(dx_name.str().c_str(),
-                      "Partial Derivatives (x)",
-                      converted_x_bins,
-                      x_min,
-                      x_max,
-                      converted_y_bins,
-                      y_min,
-                      y_max);
-  TH2F h_derivative_y(dy_name.str().c_str(),
-                      "Partial Derivatives (y)",
-                      converted_x_bins,
-                      x_min,
-                      x_max,
-                      converted_y_bins,
-                      y_min,
-                      y_max);
-  TH2D h_cornerScore(cornerScore_name.str().c_str(),
-                     "Feature Point Corner Score",
-                     converted_x_bins,
-                     x_min,
-                     x_max,
-                     converted_y_bins,
-                     y_min,
-                     y_max);
-  TH2D h_maxSuppress(maxSuppress_name.str().c_str(),
-                     "Corner Points (Maximum Suppressed)",
-                     converted_x_bins,
-                     x_min,
-                     x_max,
-                     converted_y_bins,
-                     y_min,
-                     y_max);
-
-  create_image_histo(h_wire_data, h_conversion);
-  create_derivative_histograms(h_conversion, h_derivative_x, h_derivative_y);
-  create_cornerScore_histogram(h_derivative_x, h_derivative_y, h_cornerScore);
-
-  auto corner_vector_tmp = perform_maximum_suppression(h_cornerScore, wireIDs, view, h_maxSuppress);
-
-  std::stringstream LI_name;
-  LI_name << "h_lineIntegralScore_" << view << "_" << run_number << "_" << event_number;
-  TH2F h_lineIntegralScore(
-    LI_name.str().c_str(), "Line Integral Score", x_bins, x_min, x_max, y_bins, y_min, y_max);
   calculate_line_integral_score(h_wire_data, corner_vector_tmp, corner_vector, h_lineIntegralScore);
 }
 
 //-----------------------------------------------------------------------------
-// Convert to pixel
-void corner::CornerFinderAlg::create_image_histo(TH2F const& h_wire_data, TH2F& h_conversion) const
+// Run the image processing on plain buffers: conversion, derivatives (blurred) and corner score
+void corner::CornerFinderAlg::create_corner_score(TH2F const& h_wire_data,
+                                                  int converted_x_bins,
+                                                  int converted_y_bins)
 {
+  // wide enough for every neighborhood used below (the Sobel mask reaches 2 bins)
+  const int border = std::max({fConversion_func_neighborhood,
+                               fDerivative_neighborhood,
+                               fDerivative_BlurNeighborhood,
+                               fCornerScore_neighborhood,
+                               fMaxSuppress_neighborhood,
+                               2});
+
+  fImage_wireData.fill(h_wire_data, border);
+
+  fImage_conversion.reset(converted_x_bins, converted_y_bins, border);
+  fImage_derivativeX.reset(converted_x_bins, converted_y_bins, border);
+  fImage_derivativeY.reset(converted_x_bins, converted_y_bins, border);
+  fImage_st_xx.reset(converted_x_bins, converted_y_bins, border);
+  fImage_st_yy.reset(converted_x_bins, converted_y_bins, border);
+  fImage_st_xy.reset(converted_x_bins, converted_y_bins, border);
+  fImage_cornerScore.reset(converted_x_bins, converted_y_bins, border);
+
+  create_image(fImage_wireData, fImage_conversion);
+  create_derivative_images(fImage_conversion, fImage_derivativeX, fImage_derivativeY);
+  create_cornerScore_image(fImage_cornerScore);
+}
 
-  double temp_integral = 0;
-
-  const TF2 fConversion_TF2("fConversion_func", fConversion_func.c_str(), -20, 20, -20, 20);
+//-----------------------------------------------------------------------------
+// Convert to pixel
+void corner::CornerFinderAlg::create_image(Image<float> const& wire_data,
+                                           Image<float>& conversion)
+{
+  const int x_bins = conversion.NX();
+  const int y_bins = conversion.NY();
+
+  const bool is_function = (fConversion_algorithm.compare("function") == 0);
+  const bool is_separable = is_function && !fConversion_kernel_x.empty();
+  const int n = fConversion_func_neighborhood;
+  const int size = 2 * n + 1;
+
+  // first pass of the separable kernel, along x, for all the rows the second pass reads
+  if (is_separable) {
+    fImage_scratch.reset(x_bins, y_bins, n);
+    for (int jy = 1 - n; jy <= y_bins + n; jy++) {
+      for (int ix = 1; ix <= x_bins; ix++) {
+        double sum = 0;
+        for (int a = 0; a < size; a++)
+          sum += wire_data(ix - a + n, jy) * fConversion_kernel_x[a];
+        fImage_scratch(ix, jy) = sum;
+      }
+    }
+  }
 
-  for (int ix = 1; ix <= h_conversion.GetNbinsX(); ix++) {
-    for (int iy = 1; iy <= h_conversion.GetNbinsY(); iy++) {
+  for (int iy = 1; iy <= y_bins; iy++) {
+    for (int ix = 1; ix <= x_bins; ix++) {
 
-      temp_integral = h_wire_data.Integral(ix, ix, iy, iy);
+      double temp_integral = wire_data(ix, iy);
 
       if (temp_integral > fConversion_threshold) {
 
         if (fConversion_algorithm.compare("binary") == 0)
-          h_conversion.SetBinContent(ix, iy, 10 * fConversion_threshold);
+          conversion(ix, iy) = 10 * fConversion_threshold;
         else if (fConversion_algorithm.compare("standard") == 0)
-          h_conversion.SetBinContent(ix, iy, temp_integral);
+          conversion(ix, iy) = temp_integral;
 
-        else if (fConversion_algorithm.compare("function") == 0) {
+        else if (is_separable) {
+          temp_integral = 0;
+          for (int b = 0; b < size; b++)
+            temp_integral += fImage_scratch(ix, iy - b + n) * fConversion_kernel_y[b];
+          conversion(ix, iy) = temp_integral;
+        }
+        else if (is_function) {
 
           temp_integral = 0;
-          for (int jx = ix - fConversion_func_neighborhood;
-               jx <= ix + fConversion_func_neighborhood;
-               jx++) {
-            for (int jy = iy - fConversion_func_neighborhood;
-                 jy <= iy + fConversion_func_neighborhood;
-                 jy++) {
-              temp_integral +=
-                h_wire_data.GetBinContent(jx, jy) * fConversion_TF2.Eval(ix - jx, iy - jy);
+          for (int jx = ix - n; jx <= ix + n; jx++) {
+            double const* kernel = &fConversion_kernel[(ix - jx + n) * size];
+            for (int jy = iy - n; jy <= iy + n; jy++) {
+              temp_integral += wire_data(jx, jy) * kernel[iy - jy + n];
             }
           }
-          h_conversion.SetBinContent(ix, iy, temp_integral);
+          conversion(ix, iy) = temp_integral;
         }
 
         else if (fConversion_algorithm.compare("skeleton") == 0) {
 
-          if ((temp_integral > h_wire_data.GetBinContent(ix - 1, iy) &&
-               temp_integral > h_wire_data.GetBinContent(ix + 1, iy)) ||
-              (temp_integral > h_wire_data.GetBinContent(ix, iy - 1) &&
-               temp_integral > h_wire_data.GetBinContent(ix, iy + 1)))
-            h_conversion.SetBinContent(ix, iy, temp_integral);
+          if ((temp_integral > wire_data(ix - 1, iy) && temp_integral > wire_data(ix + 1, iy)) ||
+              (temp_integral > wire_data(ix, iy - 1) && temp_integral > wire_data(ix, iy + 1)))
+            conversion(ix, iy) = temp_integral;
           else
-            h_conversion.SetBinContent(ix, iy, fConversion_threshold);
+            conversion(ix, iy) = fConversion_threshold;
         }
         else if (fConversion_algorithm.compare("sk_bin") == 0) {
 
-          if ((temp_integral > h_wire_data.GetBinContent(ix - 1, iy) &&
-               temp_integral > h_wire_data.GetBinContent(ix + 1, iy)) ||
-              (temp_integral > h_wire_data.GetBinContent(ix, iy - 1) &&
-               temp_integral > h_wire_data.GetBinContent(ix, iy + 1)))
-            h_conversion.SetBinContent(ix, iy, 10 * fConversion_threshold);
+          if ((temp_integral > wire_data(ix - 1, iy) && temp_integral > wire_data(ix + 1, iy)) ||
+              (temp_integral > wire_data(ix, iy - 1) && temp_integral > wire_data(ix, iy + 1)))
+            conversion(ix, iy) = 10 * fConversion_threshold;
           else
-            h_conversion.SetBinContent(ix, iy, fConversion_threshold);
+            conversion(ix, iy) = fConversion_threshold;
         }
         else
-          h_conversion.SetBinContent(ix, iy, temp_integral);
+          conversion(ix, iy) = temp_integral;
       }
 
       else
-        h_conversion.SetBinContent(ix, iy, fConversion_threshold);
+        conversion(ix, iy) = fConversion_threshold;
     }
   }
 }
@@ -674,354 +676,208 @@ void corner::CornerFinderAlg::create_image_histo(TH2F const& h_wire_data, TH2F&
 //-----------------------------------------------------------------------------
 // Derivative
 
-void corner::CornerFinderAlg::create_derivative_histograms(TH2F const& h_conversion,
-                                                           TH2F& h_derivative_x,
-                                                           TH2F& h_derivative_y)
+namespace {
+  // One term of a derivative mask: weight * (I(+along, across) - I(-along, across)),
+  // the terms are summed in the order they are listed.
+  struct MaskTerm {
+    int along;
+    int across;
+    double weight;
+  };
+
+  const std::vector<MaskTerm> kSobel1_x{{1, 0, 0.5}, {1, 1, 0.25}, {1, -1, 0.25}};
+  const std::vector<MaskTerm> kSobel1_y{{1, 0, 0.5}, {1, -1, 0.25}, {1, 1, 0.25}};
+  const std::vector<MaskTerm> kSobel2_x{{1, 0, 12},
+                                        {1, 1, 8},
+                                        {1, -1, 8},
+                                        {1, 2, 2},
+                                        {1, -2, 2},
+                                        {2, 0, 6},
+                                        {2, 1, 4},
+                                        {2, -1, 4},
+                                        {2, 2, 1},
+                                        {2, -2, 1}};
+  const std::vector<MaskTerm> kSobel2_y{{1, 0, 12},
+                                        {1, -1, 8},
+                                        {1, 1, 8},
+                                        {1, -2, 2},
+                                        {1, 2, 2},
+                                        {2, 0, 6},
+                                        {2, -1, 4},
+                                        {2, 1, 4},
+                                        {2, -2, 1},
+                                        {2, 2, 1}};
+  const std::vector<MaskTerm> kLocal1{{1, 0, 1}};
+}
+
+void corner::CornerFinderAlg::create_derivative_images(Image<float> const& conversion,
+                                                       Image<float>& derivative_x,
+                                                       Image<float>& derivative_y)
 {
+  const int x_bins = conversion.NX();
+  const int y_bins = conversion.NY();
 
-  const int x_bins = h_conversion.GetNbinsX();
-  const int y_bins = h_conversion.GetNbinsY();
-
-  for (int iy = 1 + fDerivative_neighborhood; iy <= (y_bins - fDerivative_neighborhood); iy++) {
-    for (int ix = 1 + fDerivative_neighborhood; ix <= (x_bins - fDerivative_neighborhood); ix++) {
-
-      if (fDerivative_method.compare("Sobel") == 0) {
-
-        if (fDerivative_neighborhood == 1) {
-          h_derivative_x.SetBinContent(ix,
-                                       iy,
-                                       0.5 * (h_conversion.GetBinContent(ix + 1, iy) -
-                                              h_conversion.GetBinContent(ix - 1, iy)) +
-                                         0.25 * (h_conversion.GetBinContent(ix + 1, iy + 1) -
-                                                 h_conversion.GetBinContent(ix - 1, iy + 1)) +
-                                         0.25 * (h_conversion.GetBinContent(ix + 1, iy - 1) -
-                                                 h_conversion.GetBinContent(ix - 1, iy - 1)));
-          h_derivative_y.SetBinContent(ix,
-                                       iy,
-                                       0.5 * (h_conversion.GetBinContent(ix, iy + 1) -
-                                              h_conversion.GetBinContent(ix, iy - 1)) +
-                                         0.25 * (h_conversion.GetBinContent(ix - 1, iy + 1) -
-                                                 h_conversion.GetBinContent(ix - 1, iy - 1)) +
-                                         0.25 * (h_conversion.GetBinContent(ix + 1, iy + 1) -
-                                                 h_conversion.GetBinContent(ix + 1, iy - 1)));
-        }
-        else if (fDerivative_neighborhood == 2) {
-          h_derivative_x.SetBinContent(
-            ix,
-            iy,
-            12 * (h_conversion.GetBinContent(ix + 1, iy) - h_conversion.GetBinContent(ix - 1, iy)) +
-              8 * (h_conversion.GetBinContent(ix + 1, iy + 1) -
-                   h_conversion.GetBinContent(ix - 1, iy + 1)) +
-              8 * (h_conversion.GetBinContent(ix + 1, iy - 1) -
-                   h_conversion.GetBinContent(ix - 1, iy - 1)) +
-              2 * (h_conversion.GetBinContent(ix + 1, iy + 2) -
-                   h_conversion.GetBinContent(ix - 1, iy + 2)) +
-              2 * (h_conversion.GetBinContent(ix + 1, iy - 2) -
-                   h_conversion.GetBinContent(ix - 1, iy - 2)) +
-              6 *
-                (h_conversion.GetBinContent(ix + 2, iy) - h_conversion.GetBinContent(ix - 2, iy)) +
-              4 * (h_conversion.GetBinContent(ix + 2, iy + 1) -
-                   h_conversion.GetBinContent(ix - 2, iy + 1)) +
-              4 * (h_conversion.GetBinContent(ix + 2, iy - 1) -
-                   h_conversion.GetBinContent(ix - 2, iy - 1)) +
-              1 * (h_conversion.GetBinContent(ix + 2, iy + 2) -
-                   h_conversion.GetBinContent(ix - 2, iy + 2)) +
-              1 * (h_conversion.GetBinContent(ix + 2, iy - 2) -
-                   h_conversion.GetBinContent(ix - 2, iy - 2)));
-          h_derivative_y.SetBinContent(
-            ix,
-            iy,
-            12 * (h_conversion.GetBinContent(ix, iy + 1) - h_conversion.GetBinContent(ix, iy - 1)) +
-              8 * (h_conversion.GetBinContent(ix - 1, iy + 1) -
-                   h_conversion.GetBinContent(ix - 1, iy - 1)) +
-              8 * (h_conversion.GetBinContent(ix + 1, iy + 1) -
-                   h_conversion.GetBinContent(ix + 1, iy - 1)) +
-              2 * (h_conversion.GetBinContent(ix - 2, iy + 1) -
-                   h_conversion.GetBinContent(ix - 2, iy - 1)) +
-              2 * (h_conversion.GetBinContent(ix + 2, iy + 1) -
-                   h_conversion.GetBinContent(ix + 2, iy - 1)) +
-              6 *
-                (h_conversion.GetBinContent(ix, iy + 2) - h_conversion.GetBinContent(ix, iy - 2)) +
-              4 * (h_conversion.GetBinContent(ix - 1, iy + 2) -
-                   h_conversion.GetBinContent(ix - 1, iy - 2)) +
-              4 * (h_conversion.GetBinContent(ix + 1, iy + 2) -
-                   h_conversion.GetBinContent(ix + 1, iy - 2)) +
-              1 * (h_conversion.GetBinContent(ix - 2, iy + 2) -
-                   h_conversion.GetBinContent(ix - 2, iy - 2)) +
-              1 * (h_conversion.GetBinContent(ix + 2, iy + 2) -
-                   h_conversion.GetBinContent(ix + 2, iy - 2)));
-        }
-        else {
-          mf::LogError("CornerFinderAlg")
-            << "Sobel derivative not supported for neighborhoods > 2.";
-          return;
-        }
+  std::vector<MaskTerm> const* mask_x = nullptr;
+  std::vector<MaskTerm> const* mask_y = nullptr;
 
-      } //end if Sobel
+  if (fDerivative_method.compare("Sobel") == 0) {
+    if (fDerivative_neighborhood == 1) {
+      mask_x = &kSobel1_x;
+      mask_y = &kSobel1_y;
+    }
+    else if (fDerivative_neighborhood == 2) {
+      mask_x = &kSobel2_x;
+      mask_y = &kSobel2_y;
+    }
+    else {
+      mf::LogError("CornerFinderAlg") << "Sobel derivative not supported for neighborhoods > 2.";
+    }
+  } //end if Sobel
 
-      else if (fDerivative_method.compare("local") == 0) {
+  else if (fDerivative_method.compare("local") == 0) {
+    if (fDerivative_neighborhood == 1) {
+      mask_x = &kLocal1;
+      mask_y = &kLocal1;
+    }
+    else {
+      mf::LogError("CornerFinderAlg")
+        << "Local derivative not yet supported for neighborhoods > 1.";
+    }
+  } //end if local
 
-        if (fDerivative_neighborhood == 1) {
-          h_derivative_x.SetBinContent(
-            ix,
-            iy,
-            (h_conversion.GetBinContent(ix + 1, iy) - h_conversion.GetBinContent(ix - 1, iy)));
-          h_derivative_y.SetBinContent(
-            ix,
-            iy,
-            (h_conversion.GetBinContent(ix, iy + 1) - h_conversion.GetBinContent(ix, iy - 1)));
-        }
-        else {
-          mf::LogError("CornerFinderAlg")
-            << "Local derivative not yet supported for neighborhoods > 1.";
-          return;
-        }
-      } //end if local
+  else {
+    mf::LogError("CornerFinderAlg") << "Bad derivative algorithm! " << fDerivative_method;
+  }
 
-      else {
-        mf::LogError("CornerFinderAlg") << "Bad derivative algorithm! " << fDerivative_method;
-        return;
+  const bool blur = (fDerivative_BlurNeighborhood > 0);
+
+  if (mask_x) {
+    for (int iy = 1 + fDerivative_neighborhood; iy <= (y_bins - fDerivative_neighborhood); iy++) {
+      for (int ix = 1 + fDerivative_neighborhood; ix <= (x_bins - fDerivative_neighborhood);
+           ix++) {
+        double dx = 0, dy = 0;
+        for (auto const& t : *mask_x)
+          dx += t.weight *
+                (conversion(ix + t.along, iy + t.across) - conversion(ix - t.along, iy + t.across));
+        for (auto const& t : *mask_y)
+          dy += t.weight *
+                (conversion(ix + t.across, iy + t.along) - conversion(ix + t.across, iy - t.along));
+        derivative_x(ix, iy) = dx;
+        derivative_y(ix, iy) = dy;
+
+        // without the blur these are the final derivatives, fill the tensor in the same pass
+        if (!blur) fill_structure_tensor(ix, iy);
       }
     }
   }
 
-  //this is just a double Gaussian
-  float func_blur[11][11];
-  func_blur[0][0] = 0.000000;
-  func_blur[0][1] = 0.000000;
-  func_blur[0][2] = 0.000000;
-  func_blur[0][3] = 0.000001;
-  func_blur[0][4] = 0.000002;
-  func_blur[0][5] = 0.000004;
-  func_blur[0][6] = 0.000002;
-  func_blur[0][7] = 0.000001;
-  func_blur[0][8] = 0.000000;
-  func_blur[0][9] = 0.000000;
-  func_blur[0][10] = 0.000000;
-  func_blur[1][0] = 0.000000;
-  func_blur[1][1] = 0.000000;
-  func_blur[1][2] = 0.000004;
-  func_blur[1][3] = 0.000045;
-  func_blur[1][4] = 0.000203;
-  func_blur[1][5] = 0.000335;
-  func_blur[1][6] = 0.000203;
-  func_blur[1][7] = 0.000045;
-  func_blur[1][8] = 0.000004;
-  func_blur[1][9] = 0.000000;
-  func_blur[1][10] = 0.000000;
-  func_blur[2][0] = 0.000000;
-  func_blur[2][1] = 0.000004;
-  func_blur[2][2] = 0.000123;
-  func_blur[2][3] = 0.001503;
-  func_blur[2][4] = 0.006738;
-  func_blur[2][5] = 0.011109;
-  func_blur[2][6] = 0.006738;
-  func_blur[2][7] = 0.001503;
-  func_blur[2][8] = 0.000123;
-  func_blur[2][9] = 0.000004;
-  func_blur[2][10] = 0.000000;
-  func_blur[3][0] = 0.000001;
-  func_blur[3][1] = 0.000045;
-  func_blur[3][2] = 0.001503;
-  func_blur[3][3] = 0.018316;
-  func_blur[3][4] = 0.082085;
-  func_blur[3][5] = 0.135335;
-  func_blur[3][6] = 0.082085;
-  func_blur[3][7] = 0.018316;
-  func_blur[3][8] = 0.001503;
-  func_blur[3][9] = 0.000045;
-  func_blur[3][10] = 0.000001;
-  func_blur[4][0] = 0.000002;
-  func_blur[4][1] = 0.000203;
-  func_blur[4][2] = 0.006738;
-  func_blur[4][3] = 0.082085;
-  func_blur[4][4] = 0.367879;
-  func_blur[4][5] = 0.606531;
-  func_blur[4][6] = 0.367879;
-  func_blur[4][7] = 0.082085;
-  func_blur[4][8] = 0.006738;
-  func_blur[4][9] = 0.000203;
-  func_blur[4][10] = 0.000002;
-  func_blur[5][0] = 0.000004;
-  func_blur[5][1] = 0.000335;
-  func_blur[5][2] = 0.011109;
-  func_blur[5][3] = 0.135335;
-  func_blur[5][4] = 0.606531;
-  func_blur[5][5] = 1.000000;
-  func_blur[5][6] = 0.606531;
-  func_blur[5][7] = 0.135335;
-  func_blur[5][8] = 0.011109;
-  func_blur[5][9] = 0.000335;
-  func_blur[5][10] = 0.000004;
-  func_blur[6][0] = 0.000002;
-  func_blur[6][1] = 0.000203;
-  func_blur[6][2] = 0.006738;
-  func_blur[6][3] = 0.082085;
-  func_blur[6][4] = 0.367879;
-  func_blur[6][5] = 0.606531;
-  func_blur[6][6] = 0.367879;
-  func_blur[6][7] = 0.082085;
-  func_blur[6][8] = 0.006738;
-  func_blur[6][9] = 0.000203;
-  func_blur[6][10] = 0.000002;
-  func_blur[7][0] = 0.000001;
-  func_blur[7][1] = 0.000045;
-  func_blur[7][2] = 0.001503;
-  func_blur[7][3] = 0.018316;
-  func_blur[7][4] = 0.082085;
-  func_blur[7][5] = 0.135335;
-  func_blur[7][6] = 0.082085;
-  func_blur[7][7] = 0.018316;
-  func_blur[7][8] = 0.001503;
-  func_blur[7][9] = 0.000045;
-  func_blur[7][10] = 0.000001;
-  func_blur[8][0] = 0.000000;
-  func_blur[8][1] = 0.000004;
-  func_blur[8][2] = 0.000123;
-  func_blur[8][3] = 0.001503;
-  func_blur[8][4] = 0.006738;
-  func_blur[8][5] = 0.011109;
-  func_blur[8][6] = 0.006738;
-  func_blur[8][7] = 0.001503;
-  func_blur[8][8] = 0.000123;
-  func_blur[8][9] = 0.000004;
-  func_blur[8][10] = 0.000000;
-  func_blur[9][0] = 0.000000;
-  func_blur[9][1] = 0.000000;
-  func_blur[9][2] = 0.000004;
-  func_blur[9][3] = 0.000045;
-  func_blur[9][4] = 0.000203;
-  func_blur[9][5] = 0.000335;
-  func_blur[9][6] = 0.000203;
-  func_blur[9][7] = 0.000045;
-  func_blur[9][8] = 0.000004;
-  func_blur[9][9] = 0.000000;
-  func_blur[9][10] = 0.000000;
-  func_blur[10][0] = 0.000000;
-  func_blur[10][1] = 0.000000;
-  func_blur[10][2] = 0.000000;
-  func_blur[10][3] = 0.000001;
-  func_blur[10][4] = 0.000002;
-  func_blur[10][5] = 0.000004;
-  func_blur[10][6] = 0.000002;
-  func_blur[10][7] = 0.000001;
-  func_blur[10][8] = 0.000000;
-  func_blur[10][9] = 0.000000;
-  func_blur[10][10] = 0.000000;
-
-  double temp_integral_x = 0;
-  double temp_integral_y = 0;
-
-  if (fDerivative_BlurNeighborhood > 0) {
-
-    if (fDerivative_BlurNeighborhood > 10) {
-      mf::LogWarning("CornerFinderAlg")
-        << "WARNING...BlurNeighborhoods>10 not currently allowed. Shrinking to 10.";
-      fDerivative_BlurNeighborhood = 10;
+  if (blur) {
+    blur_derivative_image(derivative_x);
+    blur_derivative_image(derivative_y);
+    for (int iy = 1; iy <= y_bins; iy++) {
+      for (int ix = 1; ix <= x_bins; ix++) {
+        fill_structure_tensor(ix, iy);
+      }
     }
+  }
+}
 
-    TH2F* h_clone_derivative_x = (TH2F*)h_derivative_x.Clone("h_clone_derivative_x");
-    TH2F* h_clone_derivative_y = (TH2F*)h_derivative_y.Clone("h_clone_derivative_y");
-
-    temp_integral_x = 0;
-    temp_integral_y = 0;
-
-    for (int ix = 1; ix <= h_derivative_x.GetNbinsX(); ix++) {
-      for (int iy = 1; iy <= h_derivative_y.GetNbinsY(); iy++) {
-
-        temp_integral_x = 0;
-        temp_integral_y = 0;
+//-----------------------------------------------------------------------------
+// Gaussian blur of a derivative image, as a pass along x followed by a pass along y
+void corner::CornerFinderAlg::blur_derivative_image(Image<float>& derivative)
+{
+  const int x_bins = derivative.NX();
+  const int y_bins = derivative.NY();
+  const int n = fDerivative_BlurNeighborhood;
+  const int size = 2 * n + 1;
 
-        for (int jx = ix - fDerivative_BlurNeighborhood; jx <= ix + fDerivative_BlurNeighborhood;
-             jx++) {
-          for (int jy = iy - fDerivative_BlurNeighborhood; jy <= iy + fDerivative_BlurNeighborhood;
-               jy++) {
-            temp_integral_x +=
-              h_clone_derivative_x->GetBinContent(jx, jy) * func_blur[(ix - jx) + 5][(iy - jy) + 5];
-            temp_integral_y +=
-              h_clone_derivative_y->GetBinContent(jx, jy) * func_blur[(ix - jx) + 5][(iy - jy) + 5];
-          }
-        }
-        h_derivative_x.SetBinContent(ix, iy, temp_integral_x);
-        h_derivative_y.SetBinContent(ix, iy, temp_integral_y);
-      }
+  // the derivatives are zero outside of the image, and so is this first pass
+  fImage_scratch.reset(x_bins, y_bins, n);
+  for (int iy = 1; iy <= y_bins; iy++) {
+    for (int ix = 1; ix <= x_bins; ix++) {
+      double sum = 0;
+      for (int k = 0; k < size; k++)
+        sum += derivative(ix - k + n, iy) * fBlur_kernel[k];
+      fImage_scratch(ix, iy) = sum;
     }
+  }
 
-    delete h_clone_derivative_x;
-    delete h_clone_derivative_y;
+  for (int iy = 1; iy <= y_bins; iy++) {
+    for (int ix = 1; ix <= x_bins; ix++) {
+      double sum = 0;
+      for (int k = 0; k < size; k++)
+        sum += fImage_scratch(ix, iy - k + n) * fBlur_kernel[k];
+      derivative(ix, iy) = sum;
+    }
+  }
+}
 
-  } //end if blur
+//-----------------------------------------------------------------------------
+// The products of the derivatives summed up by the corner score
+void corner::CornerFinderAlg::fill_structure_tensor(int ix, int iy)
+{
+  const double dx = fImage_derivativeX(ix, iy);
+  const double dy = fImage_derivativeY(ix, iy);
+  fImage_st_xx(ix, iy) = dx * dx;
+  fImage_st_yy(ix, iy) = dy * dy;
+  fImage_st_xy(ix, iy) = dx * dy;
 }
 
 //-----------------------------------------------------------------------------
 // Corner Score
 
-void corner::CornerFinderAlg::create_cornerScore_histogram(TH2F const& h_derivative_x,
-                                                           TH2F const& h_derivative_y,
-                                                           TH2D& h_cornerScore)
+void corner::CornerFinderAlg::create_cornerScore_image(Image<double>& cornerScore) const
 {
+  const bool noble = (fCornerScore_algorithm.compare("Noble") == 0);
+  if (!noble && fCornerScore_algorithm.compare("Harris") != 0) {
+    mf::LogError("CornerFinderAlg") << "BAD CORNER ALGORITHM: " << fCornerScore_algorithm;
+    return;
+  }
 
-  const int x_bins = h_derivative_x.GetNbinsX();
-  const int y_bins = h_derivative_y.GetNbinsY();
+  const int x_bins = cornerScore.NX();
+  const int y_bins = cornerScore.NY();
+  const int n = fCornerScore_neighborhood;
 
   //the structure tensor elements
   double st_xx = 0., st_xy = 0., st_yy = 0.;
 
-  for (int iy = 1 + fCornerScore_neighborhood; iy <= (y_bins - fCornerScore_neighborhood); iy++) {
-    for (int ix = 1 + fCornerScore_neighborhood; ix <= (x_bins - fCornerScore_neighborhood); ix++) {
+  for (int iy = 1 + n; iy <= (y_bins - n); iy++) {
+    for (int ix = 1 + n; ix <= (x_bins - n); ix++) {
 
-      if (ix == 1 + fCornerScore_neighborhood) {
+      if (ix == 1 + n) {
         st_xx = 0.;
         st_xy = 0.;
         st_yy = 0.;
 
-        for (int jx = ix - fCornerScore_neighborhood; jx <= ix + fCornerScore_neighborhood; jx++) {
-          for (int jy = iy - fCornerScore_neighborhood; jy <= iy + fCornerScore_neighborhood;
-               jy++) {
-
-            st_xx += h_derivative_x.GetBinContent(jx, jy) * h_derivative_x.GetBinContent(jx, jy);
-            st_yy += h_derivative_y.GetBinContent(jx, jy) * h_derivative_y.GetBinContent(jx, jy);
-            st_xy += h_derivative_x.GetBinContent(jx, jy) * h_derivative_y.GetBinContent(jx, jy);
+        for (int jx = ix - n; jx <= ix + n; jx++) {
+          for (int jy = iy - n; jy <= iy + n; jy++) {
+            st_xx += fImage_st_xx(jx, jy);
+            st_yy += fImage_st_yy(jx, jy);
+            st_xy += fImage_st_xy(jx, jy);
           }
         }
       }
 
       // we do it this way to reduce computation time
       else {
-        for (int jy = iy - fCornerScore_neighborhood; jy <= iy + fCornerScore_neighborhood; jy++) {
-
-          st_xx -= h_derivative_x.GetBinContent(ix - fCornerScore_neighborhood - 1, jy) *
-                   h_derivative_x.GetBinContent(ix - fCornerScore_neighborhood - 1, jy);
-          st_xx += h_derivative_x.GetBinContent(ix + fCornerScore_neighborhood, jy) *
-                   h_derivative_x.GetBinContent(ix + fCornerScore_neighborhood, jy);
-
-          st_yy -= h_derivative_y.GetBinContent(ix - fCornerScore_neighborhood - 1, jy) *
-                   h_derivative_y.GetBinContent(ix - fCornerScore_neighborhood - 1, jy);
-          st_yy += h_derivative_y.GetBinContent(ix + fCornerScore_neighborhood, jy) *
-                   h_derivative_y.GetBinContent(ix + fCornerScore_neighborhood, jy);
-
-          st_xy -= h_derivative_x.GetBinContent(ix - fCornerScore_neighborhood - 1, jy) *
-                   h_derivative_y.GetBinContent(ix - fCornerScore_neighborhood - 1, jy);
-          st_xy += h_derivative_x.GetBinContent(ix + fCornerScore_neighborhood, jy) *
-                   h_derivative_y.GetBinContent(ix + fCornerScore_neighborhood, jy);
+        for (int jy = iy - n; jy <= iy + n; jy++) {
+          st_xx -= fImage_st_xx(ix - n - 1, jy);
+          st_xx += fImage_st_xx(ix + n, jy);
+
+          st_yy -= fImage_st_yy(ix - n - 1, jy);
+          st_yy += fImage_st_yy(ix + n, jy);
+
+          st_xy -= fImage_st_xy(ix - n - 1, jy);
+          st_xy += fImage_st_xy(ix + n, jy);
         }
       }
 
-      if (fCornerScore_algorithm.compare("Noble") == 0) {
-        h_cornerScore.SetBinContent(
-          ix, iy, (st_xx * st_yy - st_xy * st_xy) / (st_xx + st_yy + fCornerScore_Noble_epsilon));
-      }
-      else if (fCornerScore_algorithm.compare("Harris") == 0) {
-        h_cornerScore.SetBinContent(
-          ix,
-          iy,
-          (st_xx * st_yy - st_xy * st_xy) -
-            ((st_xx + st_yy) * (st_xx + st_yy) * fCornerScore_Harris_kappa));
-      }
-      else {
-        mf::LogError("CornerFinderAlg") << "BAD CORNER ALGORITHM: " << fCornerScore_algorithm;
-        return;
-      }
+      if (noble)
+        cornerScore(ix, iy) =
+          (st_xx * st_yy - st_xy * st_xy) / (st_xx + st_yy + fCornerScore_Noble_epsilon);
+      else
+        cornerScore(ix, iy) = (st_xx * st_yy - st_xy * st_xy) -
+                              ((st_xx + st_yy) * (st_xx + st_yy) * fCornerScore_Harris_kappa);
 
     } // end for loop over x bins
   }   // end for loop over y bins
@@ -1030,35 +886,31 @@ void corner::CornerFinderAlg::create_cornerScore_histogram(TH2F const& h_derivat
 //-----------------------------------------------------------------------------
 // Max Supress
 std::vector<recob::EndPoint2D> corner::CornerFinderAlg::perform_maximum_suppression(
-  TH2D const& h_cornerScore,
-  std::vector<geo::WireID> wireIDs,
+  Image<double> const& cornerScore,
+  std::vector<geo::WireID> const& wireIDs,
   geo::View_t view,
-  TH2D& h_maxSuppress,
+  TH2D* h_maxSuppress,
   int startx,
   int starty) const
 {
   std::vector<recob::EndPoint2D> corner_vector;
-  const int x_bins = h_cornerScore.GetNbinsX();
-  const int y_bins = h_cornerScore.GetNbinsY();
+  const int x_bins = cornerScore.NX();
+  const int y_bins = cornerScore.NY();
 
   for (int iy = 1; iy <= y_bins; iy++) {
     for (int ix = 1; ix <= x_bins; ix++) {
 
-      if (h_cornerScore.GetBinContent(ix, iy) < fMaxSuppress_threshold) continue;
+      if (cornerScore(ix, iy) < fMaxSuppress_threshold) continue;
 
       double temp_max = -1000;
-      double temp_center_bin = false;
+      bool temp_center_bin = false;
 
       for (int jx = ix - fMaxSuppress_neighborhood; jx <= ix + fMaxSuppress_neighborhood; jx++) {
         for (int jy = iy - fMaxSuppress_neighborhood; jy <= iy + fMaxSuppress_neighborhood; jy++) {
 
-          if (h_cornerScore.GetBinContent(jx, jy) > temp_max) {
-            temp_max = h_cornerScore.GetBinContent(jx, jy);
-            if (jx == ix && jy == iy)
-              temp_center_bin = true;
-            else {
-              temp_center_bin = false;
-            }
+          if (cornerScore(jx, jy) > temp_max) {
+            temp_max = cornerScore(jx, jy);
+            temp_center_bin = (jx == ix && jy == iy);
           }
         }
       }
@@ -1070,16 +922,69 @@ std::vector<recob::EndPoint2D> corner::CornerFinderAlg::perform_maximum_suppress
         double totalQ = 0;
         int id = 0;
         recob::EndPoint2D corner(
-          time_tick, wireIDs[wire_number], h_cornerScore.GetBinContent(ix, iy), id, view, totalQ);
+          time_tick, wireIDs[wire_number], cornerScore(ix, iy), id, view, totalQ);
         corner_vector.push_back(corner);
 
-        h_maxSuppress.SetBinContent(ix, iy, h_cornerScore.GetBinContent(ix, iy));
+        if (h_maxSuppress) h_maxSuppress->SetBinContent(ix, iy, cornerScore(ix, iy));
       }
     }
   }
   return corner_vector;
 }
 
+//-----------------------------------------------------------------------------
+// Save the images of the last plane processed, for debugging; returns the (still empty)
+// histogram for the points kept by the maximum suppression
+TH2D* corner::CornerFinderAlg::save_debug_histograms(TH2F const& h_wire_data,
+                                                     geo::View_t view) const
+{
+  const int x_bins = h_wire_data.GetNbinsX();
+  const float x_min = h_wire_data.GetXaxis()->GetBinLowEdge(1);
+  const float x_max = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
+
+  const int y_bins = h_wire_data.GetNbinsY();
+  const float y_min = h_wire_data.GetYaxis()->GetBinLowEdge(1);
+  const float y_max = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
+
+  const int converted_x_bins = fImage_conversion.NX();
+  const int converted_y_bins = fImage_conversion.NY();
+
+  auto name = [&](const char* what) {
+    std::stringstream ss;
+    ss << "h_" << what << "_" << view << "_" << run_number << "_" << event_number;
+    return ss.str();
+  };
+
+  art::ServiceHandle<art::TFileService const> tfs;
+  auto make_TH2F = [&](const char* what, const char* title) {
+    return tfs->make<TH2F>(name(what).c_str(),
+                           title,
+                           converted_x_bins,
+                           x_min,
+                           x_max,
+                           converted_y_bins,
+                           y_min,
+                           y_max);
+  };
+  auto make_TH2D = [&](const char* what, const char* title) {
+    return tfs->make<TH2D>(name(what).c_str(),
+                           title,
+                           converted_x_bins,
+                           x_min,
+                           x_max,
+                           converted_y_bins,
+                           y_min,
+                           y_max);
+  };
+
+  fImage_conversion.exportTo(*make_TH2F("conversion", "Image Conversion Histogram"));
+  fImage_derivativeX.exportTo(*make_TH2F("derivative_x", "Partial Derivatives (x)"));
+  fImage_derivativeY.exportTo(*make_TH2F("derivative_y", "Partial Derivatives (y)"));
+  fImage_cornerScore.exportTo(*make_TH2D("cornerScore", "Corner Score"));
+
+  return make_TH2D("maxSuppress", "Corner Points (Maximum Suppressed)");
+}
+
 /* Silly little function for doing a line integral type thing. Needs improvement. */
 float corner::CornerFinderAlg::line_integral(TH2F const& hist,
                                              int begin_x,
@@ -1146,7 +1051,7 @@ void corner::CornerFinderAlg::calculate_line_integral_score(
   TH2F const& h_wire_data,
   std::vector<recob::EndPoint2D> const& corner_vector,
   std::vector<recob::EndPoint2D>& corner_lineIntegralScore_vector,
-  TH2F& h_lineIntegralScore) const
+  TH2F* h_lineIntegralScore) const
 {
 
   for (auto const i_corner : corner_vector) {
@@ -1174,9 +1079,10 @@ void corner::CornerFinderAlg::calculate_line_integral_score(
 
     corner_lineIntegralScore_vector.push_back(corner);
 
-    h_lineIntegralScore.SetBinContent(h_wire_data.GetXaxis()->FindBin(i_corner.WireID().Wire),
-                                      h_wire_data.GetYaxis()->FindBin(i_corner.DriftTime()),
-                                      score);
+    if (h_lineIntegralScore)
+      h_lineIntegralScore->SetBinContent(h_wire_data.GetXaxis()->FindBin(i_corner.WireID().Wire),
+                                         h_wire_data.GetYaxis()->FindBin(i_corner.DriftTime()),
+                                         score);
   }
 }
 
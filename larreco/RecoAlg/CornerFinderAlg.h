@@ -15,12 +15,12 @@ namespace fhicl {
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "lardataobj/RecoBase/EndPoint2D.h"
 #include "lardataobj/RecoBase/Wire.h"
+#include "larreco/RecoAlg/CornerFinderImage.h"
 
 namespace geo {
   class Geometry;
 }
 
-#include "TF2.h"
 #include "TH1D.h"
 #include "TH2.h"
 
@@ -54,6 +54,17 @@ namespace corner { //<---Not sure if this is the right namespace
 
     TH2F const& GetWireDataHist(unsigned int) const;
 
+    // here we get the feature points of the wire data of one plane, with corner score
+    void attach_feature_points(TH2F const& h_wire_data,
+                               std::vector<geo::WireID> const& wireIDs,
+                               geo::View_t view,
+                               std::vector<recob::EndPoint2D>&,
+                               int startx = 0,
+                               int starty = 0);
+
+    // the corner score image of the last plane processed
+    Image<double> const& GetCornerScoreImage() const { return fImage_cornerScore; }
+
   private:
     void InitializeGeometry(geo::Geometry const&);
 
@@ -81,6 +92,24 @@ namespace corner { //<---Not sure if this is the right namespace
     int fMaxSuppress_threshold;
     float fIntegral_bin_threshold;
     float fIntegral_fraction_threshold;
+    bool fSaveDebugHistograms; ///< save the intermediate images with TFileService
+
+    // The conversion kernel, evaluated once. If it is separable the 1D factors are used.
+    std::vector<double> fConversion_kernel;
+    std::vector<double> fConversion_kernel_x;
+    std::vector<double> fConversion_kernel_y;
+    std::vector<double> fBlur_kernel; ///< 1D factor of the derivative blur
+
+    // Working images, kept to reuse their memory from one plane to the next
+    Image<float> fImage_wireData;
+    Image<float> fImage_conversion;
+    Image<float> fImage_derivativeX;
+    Image<float> fImage_derivativeY;
+    Image<double> fImage_scratch; ///< first pass of the separable convolutions
+    Image<double> fImage_st_xx; ///< structure tensor elements, d/dx * d/dx etc.
+    Image<double> fImage_st_yy;
+    Image<double> fImage_st_xy;
+    Image<double> fImage_cornerScore;
 
     // Making a vector of histograms
     std::vector<TH2F> WireData_histos;
@@ -92,32 +121,31 @@ namespace corner { //<---Not sure if this is the right namespace
     unsigned int event_number{};
     unsigned int run_number{};
 
-    void create_image_histo(TH2F const& h_wire_data, TH2F& h_conversion) const;
-    void create_derivative_histograms(TH2F const& h_conversion,
-                                      TH2F& h_derivative_x,
-                                      TH2F& h_derivative_y);
-    void create_cornerScore_histogram(TH2F const& h_derivative_x,
-                                      TH2F const& h_derivative_y,
-                                      TH2D& h_cornerScore);
-    std::vector<recob::EndPoint2D> perform_maximum_suppression(TH2D const& h_cornerScore,
-                                                               std::vector<geo::WireID> wireIDs,
+    void InitializeConversionKernel();
+
+    // The image processing chain, from the wire data to the corner score
+    void create_corner_score(TH2F const& h_wire_data, int converted_x_bins, int converted_y_bins);
+    void create_image(Image<float> const& wire_data, Image<float>& conversion);
+    void create_derivative_images(Image<float> const& conversion,
+                                  Image<float>& derivative_x,
+                                  Image<float>& derivative_y);
+    void blur_derivative_image(Image<float>& derivative);
+    void fill_structure_tensor(int ix, int iy);
+    void create_cornerScore_image(Image<double>& cornerScore) const;
+    std::vector<recob::EndPoint2D> perform_maximum_suppression(Image<double> const& cornerScore,
+                                                               std::vector<geo::WireID> const& wireIDs,
                                                                geo::View_t view,
-                                                               TH2D& h_maxSuppress,
+                                                               TH2D* h_maxSuppress,
                                                                int startx = 0,
                                                                int starty = 0) const;
+    TH2D* save_debug_histograms(TH2F const& h_wire_data, geo::View_t view) const;
 
     void calculate_line_integral_score(
       TH2F const& h_wire_data,
       std::vector<recob::EndPoint2D> const& corner_vector,
       std::vector<recob::EndPoint2D>& corner_lineIntegralScore_vector,
-      TH2F& h_lineIntegralScore) const;
+      TH2F* h_lineIntegralScore) const;
 
-    void attach_feature_points(TH2F const& h_wire_data,
-                               std::vector<geo::WireID> const& wireIDs,
-                               geo::View_t view,
-                               std::vector<recob::EndPoint2D>&,
-                               int startx = 0,
-                               int starty = 0);
     void attach_feature_points_LineIntegralScore(TH2F const& h_wire_data,
                                                  std::vector<geo::WireID> const& wireIDs,
                                                  geo::View_t view,
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  CornerFinderImage.h
+/// \brief plain buffer images used by CornerFinderAlg
+///
+/// The images are addressed like the bins of the TH2 they replace: bins
+/// 1..NX() and 1..NY(), with 0 and N+1 the underflow and overflow bins.
+/// A border of zeros surrounds them, wide enough for the neighborhood loops
+/// to run without bounds checks. Reading a bin of the border gives the same
+/// value TH2::GetBinContent gives beyond the overflow of a histogram whose
+/// underflow and overflow bins were never filled.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef CORNERFINDERIMAGE_H
+#define CORNERFINDERIMAGE_H
+
+#include "TH2.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace corner {
+
+  template <typename T>
+  class Image {
+  public:
+    /// Resize to nx x ny bins with a border of the given width, all set to zero.
+    /// The memory is reused if the image was already big enough.
+    void reset(int nx, int ny, int border)
+    {
+      fNX = nx;
+      fNY = ny;
+      fBorder = border;
+      fStride = nx + 2 + 2 * border;
+      fData.assign(std::size_t(fStride) * (ny + 2 + 2 * border), T(0));
+    }
+
+    /// Copy of a histogram, bins beyond the underflow/overflow are given the value of the
+    /// underflow/overflow bin, as TH2::GetBinContent does.
+    template <typename H>
+    void fill(H const& hist, int border)
+    {
+      int const nx = hist.GetNbinsX();
+      int const ny = hist.GetNbinsY();
+      reset(nx, ny, border);
+      auto const* src = hist.GetArray(); // bin (ix, iy) at ix + (nx + 2) * iy
+      for (int iy = -border; iy <= ny + 1 + border; ++iy) {
+        int const sy = std::clamp(iy, 0, ny + 1);
+        T* row = &(*this)(0, iy);
+        for (int ix = -border; ix <= nx + 1 + border; ++ix) {
+          row[ix] = src[std::clamp(ix, 0, nx + 1) + (nx + 2) * sy];
+        }
+      }
+    }
+
+    int NX() const { return fNX; }
+    int NY() const { return fNY; }
+    int Border() const { return fBorder; }
+    int Stride() const { return fStride; }
+
+    T& operator()(int ix, int iy) { return fData[index(ix, iy)]; }
+    T operator()(int ix, int iy) const { return fData[index(ix, iy)]; }
+
+    /// Copy bins 1..NX(), 1..NY() to a histogram with (at least) the same number of bins.
+    template <typename H>
+    void exportTo(H& hist) const
+    {
+      for (int iy = 1; iy <= fNY; ++iy) {
+        for (int ix = 1; ix <= fNX; ++ix) {
+          hist.SetBinContent(ix, iy, (*this)(ix, iy));
+        }
+      }
+    }
+
+  private:
+    std::size_t index(int ix, int iy) const
+    {
+      return std::size_t(iy + fBorder) * fStride + (ix + fBorder);
+    }
+
+    int fNX{0};
+    int fNY{0};
+    int fBorder{0};
+    int fStride{0};
+    std::vector<T> fData;
+  };
+
+} // namespace corner
+
+#endif // CORNERFINDERIMAGE_H
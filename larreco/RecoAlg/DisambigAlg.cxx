@@ -28,8 +28,10 @@
 #include <cmath>
 #include <cstdlib>
 #include <map>
+#include <sstream>
 
 #include "range/v3/view.hpp"
+#include "tbb/parallel_for.h"
 
 using lar::to_element;
 using ranges::views::filter;
@@ -46,6 +48,9 @@ namespace apa {
     fCloseHitsRadius = p.get<double>("CloseHitsRadius");
     fMaxEndPDegRange = p.get<double>("MaxEndPDegRange");
     fNChanJumps = p.get<unsigned int>("NChanJumps");
+    fParallelAPAs = p.get<bool>("ParallelAPAs", false);
+
+    fAPAGeo.FillChannelTables();
   }
 
   //----------------------------------------------------------
@@ -60,20 +65,12 @@ namespace apa {
     fnVSoFar.clear();
     fnDUSoFar.clear();
     fnDVSoFar.clear();
-    fChannelToHits.clear();
-    fAPAToUVHits.clear();
-    fAPAToZHits.clear();
-    fAPAToHits.clear();
-    fAPAToEndPHits.clear();
-    fAPAToDHits.clear();
+    fAPAWorkspaces.clear();
     fDisambigHits.clear();
-    fChanTimeToWid.clear();
-    fHasBeenDisambiged.clear();
 
     std::vector<art::Ptr<recob::Hit>> ChHits;
     art::fill_ptr_vector(ChHits, ChannelHits);
 
-    fHasBeenDisambiged.clear();
     unsigned int skipNoise(0);
     // Map hits by channel/APA, initialize the disambiguation status map
     for (size_t h = 0; h < ChHits.size(); h++) {
@@ -91,16 +88,18 @@ namespace apa {
       geo::View_t view = hit->View();
       unsigned int apa(0), cryo(0);
       fAPAGeo.ChannelToAPA(hit->Channel(), apa, cryo);
-      fAPAToHits[apa].push_back(hit);
+      APAWorkspace& ws = fAPAWorkspaces[apa];
+      ws.apa = apa;
+      ws.Hits.push_back(hit);
       if (view == geo::kZ) {
-        fAPAToZHits[apa].push_back(hit);
+        ws.ZHits.push_back(hit);
         continue;
       }
       else if (view == geo::kU || view == geo::kV) {
         std::pair<double, double> ChanTime(hit->Channel() * 1., hit->PeakTime() * 1.);
-        this->fHasBeenDisambiged[apa][ChanTime] = false;
-        fChannelToHits[hit->Channel()].push_back(hit);
-        fAPAToUVHits[apa].push_back(hit);
+        ws.HasBeenDisambiged[ChanTime] = false;
+        ws.ChannelToHits[hit->Channel()].push_back(hit);
+        ws.UVHits.push_back(hit);
       }
     }
 
@@ -112,87 +111,146 @@ namespace apa {
 
     mf::LogVerbatim("RunDisambig") << "\n~~~~~~~~~~~ Running Disambiguation ~~~~~~~~~~~\n";
 
-    std::map<unsigned int, std::vector<art::Ptr<recob::Hit>>>::iterator APA_it;
-    for (APA_it = fAPAToUVHits.begin(); APA_it != fAPAToUVHits.end(); APA_it++) {
-      unsigned int apa = APA_it->first;
-
-      mf::LogVerbatim("RunDisambig") << "APA " << apa << ":";
-
-      fUeffSoFar[apa] = 0.;
-      fVeffSoFar[apa] = 0.;
-      fnUSoFar[apa] = 0;
-      fnVSoFar[apa] = 0;
-      fnDUSoFar[apa] = 0;
-      fnDVSoFar[apa] = 0;
-
-      // Always run this...
-      this->TrivialDisambig(clockData, detProp, apa);
-      this->AssessDisambigSoFar(apa);
-      mf::LogVerbatim("RunDisambig")
-        << "  Trivial Disambig -->  " << fnDUSoFar[apa] << " / " << fnUSoFar[apa] << " U,  "
-        << fnDVSoFar[apa] << " / " << fnVSoFar[apa] << " V";
-
-      // ... and pick the rest with the configurations.
-      if (fCrawl) {
-        this->Crawl(apa);
-        this->AssessDisambigSoFar(apa);
-        mf::LogVerbatim("RunDisambig")
-          << "  Crawl            -->  " << fnDUSoFar[apa] << " / " << fnUSoFar[apa] << " U,  "
-          << fnDVSoFar[apa] << " / " << fnVSoFar[apa] << " V";
-      }
+    // Only APAs with ambiguous hits have anything to do
+    std::vector<APAWorkspace*> toDo;
+    for (auto& apaWs : fAPAWorkspaces)
+      if (!apaWs.second.UVHits.empty()) toDo.push_back(&apaWs.second);
 
-      if (fUseEndP) {
-        this->FindChanTimeEndPts(detProp, apa);
-        this->UseEndPts(detProp, apa); // does the crawl from inside
-        this->AssessDisambigSoFar(apa);
-        mf::LogVerbatim("RunDisambig")
-          << "  Endpoint Crawl   -->  " << fnDUSoFar[apa] << " / " << fnUSoFar[apa] << " U,  "
-          << fnDVSoFar[apa] << " / " << fnVSoFar[apa] << " V";
-      }
+    if (fParallelAPAs) {
+      tbb::parallel_for(size_t(0), toDo.size(), [&](size_t i) {
+        this->DisambigAPA(clockData, detProp, *toDo[i]);
+      });
+    }
+    else {
+      for (APAWorkspace* ws : toDo)
+        this->DisambigAPA(clockData, detProp, *ws);
+    }
 
-      if (fCompareViews) {
-        unsigned int nDisambig(1);
-        while (nDisambig > 0) {
-          nDisambig = this->CompareViews(detProp, apa);
-          this->Crawl(apa);
-        }
-        this->AssessDisambigSoFar(apa);
-        mf::LogVerbatim("RunDisambig")
-          << "  Compare Views    -->  " << fnDUSoFar[apa] << " / " << fnUSoFar[apa] << " U,  "
-          << fnDVSoFar[apa] << " / " << fnVSoFar[apa] << " V";
+    // Collect in APA order, whichever order the APAs were done in
+    for (APAWorkspace* ws : toDo) {
+      mf::LogVerbatim("RunDisambig") << ws->Summary;
+      this->PublishSoFar(*ws);
+      // For now just buld a simple list to get from the module
+      fDisambigHits.insert(fDisambigHits.end(), ws->DHits.begin(), ws->DHits.end());
+    }
+  }
+
+  //----------------------------------------------------------
+  //----------------------------------------------------------
+  void DisambigAlg::DisambigAPA(detinfo::DetectorClocksData const& clockData,
+                                detinfo::DetectorPropertiesData const& detProp,
+                                APAWorkspace& ws) const
+  {
+    std::ostringstream summary;
+    auto report = [&ws, &summary](const char* step) {
+      summary << "\n  " << step << "-->  " << ws.nDUSoFar << " / " << ws.nUSoFar << " U,  "
+              << ws.nDVSoFar << " / " << ws.nVSoFar << " V";
+    };
+    summary << "APA " << ws.apa << ":";
+
+    // Always run this...
+    this->TrivialDisambig(clockData, detProp, ws);
+    this->AssessDisambigSoFar(ws);
+    report("Trivial Disambig ");
+
+    // ... and pick the rest with the configurations.
+    if (fCrawl) {
+      this->Crawl(ws);
+      this->AssessDisambigSoFar(ws);
+      report("Crawl            ");
+    }
+
+    if (fUseEndP) {
+      this->FindChanTimeEndPts(detProp, ws);
+      this->UseEndPts(detProp, ws); // does the crawl from inside
+      this->AssessDisambigSoFar(ws);
+      report("Endpoint Crawl   ");
+    }
+
+    if (fCompareViews) {
+      unsigned int nDisambig(1);
+      while (nDisambig > 0) {
+        nDisambig = this->CompareViews(detProp, ws);
+        this->Crawl(ws);
       }
+      this->AssessDisambigSoFar(ws);
+      report("Compare Views    ");
+    }
 
-      // For now just buld a simple list to get from the module
-      for (size_t i = 0; i < fAPAToDHits[apa].size(); i++)
-        fDisambigHits.push_back(fAPAToDHits[apa][i]);
+    ws.Summary = summary.str();
+  }
+
+  //----------------------------------------------------------
+  // Per-APA entry points, working on the hits of the last RunDisambig
+  void DisambigAlg::TrivialDisambig(detinfo::DetectorClocksData const& clockData,
+                                    detinfo::DetectorPropertiesData const& detProp,
+                                    unsigned int apa)
+  {
+    this->TrivialDisambig(clockData, detProp, fAPAWorkspaces.at(apa));
+  }
 
-    } // end loop through APA
+  void DisambigAlg::Crawl(unsigned int apa) { this->Crawl(fAPAWorkspaces.at(apa)); }
+
+  unsigned int DisambigAlg::FindChanTimeEndPts(detinfo::DetectorPropertiesData const& detProp,
+                                               unsigned int apa)
+  {
+    return this->FindChanTimeEndPts(detProp, fAPAWorkspaces.at(apa));
+  }
+
+  void DisambigAlg::UseEndPts(detinfo::DetectorPropertiesData const& detProp, unsigned int apa)
+  {
+    this->UseEndPts(detProp, fAPAWorkspaces.at(apa));
+  }
+
+  unsigned int DisambigAlg::CompareViews(detinfo::DetectorPropertiesData const& detProp,
+                                         unsigned int apa)
+  {
+    return this->CompareViews(detProp, fAPAWorkspaces.at(apa));
+  }
+
+  void DisambigAlg::AssessDisambigSoFar(unsigned int apa)
+  {
+    APAWorkspace& ws = fAPAWorkspaces.at(apa);
+    this->AssessDisambigSoFar(ws);
+    this->PublishSoFar(ws);
+  }
+
+  //-------------------------------------------------
+  //-------------------------------------------------
+  void DisambigAlg::PublishSoFar(APAWorkspace const& ws)
+  {
+    fUeffSoFar[ws.apa] = ws.UeffSoFar;
+    fVeffSoFar[ws.apa] = ws.VeffSoFar;
+    fnUSoFar[ws.apa] = ws.nUSoFar;
+    fnVSoFar[ws.apa] = ws.nVSoFar;
+    fnDUSoFar[ws.apa] = ws.nDUSoFar;
+    fnDVSoFar[ws.apa] = ws.nDVSoFar;
   }
 
   //-------------------------------------------------
   //-------------------------------------------------
   void DisambigAlg::MakeDisambigHit(art::Ptr<recob::Hit> const& hit,
                                     geo::WireID wid,
-                                    unsigned int apa)
+                                    APAWorkspace& ws) const
   {
     std::pair<double, double> ChanTime(hit->Channel() * 1., hit->PeakTime() * 1.);
-    if (fHasBeenDisambiged[apa][ChanTime]) return;
+    if (ws.HasBeenDisambiged[ChanTime]) return;
 
     if (!wid.isValid) {
       mf::LogWarning("InvalidWireID") << "wid is invalid, hit not being made\n";
       return;
     }
 
-    fAPAToDHits[apa].emplace_back(hit, wid);
-    fHasBeenDisambiged[apa][ChanTime] = true;
-    fChanTimeToWid[ChanTime] = wid;
+    ws.DHits.emplace_back(hit, wid);
+    ws.HasBeenDisambiged[ChanTime] = true;
+    ws.ChanTimeToWid[ChanTime] = wid;
   }
 
   //----------------------------------------------------------
   //----------------------------------------------------------
   bool DisambigAlg::HitsOverlapInTime(detinfo::DetectorPropertiesData const& detProp,
                                       recob::Hit const& hitA,
-                                      recob::Hit const& hitB)
+                                      recob::Hit const& hitB) const
   {
     double AsT = hitA.PeakTimeMinusRMS();
     double AeT = hitA.PeakTimePlusRMS();
@@ -231,42 +289,24 @@ namespace apa {
 
   //----------------------------------------------------------
   //----------------------------------------------------------
-  void DisambigAlg::TrivialDisambig(detinfo::DetectorClocksData const& clockData,
+  void DisambigAlg::TrivialDisambig(detinfo::DetectorClocksData const&,
                                     detinfo::DetectorPropertiesData const& detProp,
-                                    unsigned int apa)
+                                    APAWorkspace& ws) const
   {
     // Loop through ambiguous hits (U/V) in this APA
-    for (auto const& hitPtr : fAPAToUVHits[apa]) {
+    for (auto const& hitPtr : ws.UVHits) {
       auto const& hit = *hitPtr;
       raw::ChannelID_t chan = hit.Channel();
       unsigned int peakT = hit.PeakTime();
 
-      std::vector<geo::WireID> hitwids = geom->ChannelToWire(chan);
+      std::vector<geo::WireID> const& hitwids = fAPAGeo.ChannelWires(chan);
       std::vector<bool> IsReasonableWid(hitwids.size(), false);
       unsigned short nPossibleWids(0);
       for (size_t w = 0; w < hitwids.size(); w++) {
-        geo::WireID wid = hitwids[w];
-
-        double xyzStart[3] = {0.};
-        double xyzEnd[3] = {0.};
-        geom->WireEndPoints(wid, xyzStart, xyzEnd);
-        unsigned int side(wid.TPC % 2), cryo(wid.Cryostat);
-        double zminPos(xyzStart[2]), zmaxPos(xyzEnd[2]);
-
-        // get appropriate x and y with tpc center
-        unsigned int tpc =
-          2 * apa + side - cryo * geom->NTPC(); // apa number does not reset per cryo
-        auto const tpcCenter = geom->TPC(geo::TPCID(cryo, tpc)).GetCenter();
+        // channel range of the collection wires under this wire segment
+        auto const [ZminChan, ZmaxChan] = fAPAGeo.WireZChanRange(chan, w);
 
-        // get channel range
-        auto Min = tpcCenter;
-        Min.SetZ(zminPos);
-        auto Max = tpcCenter;
-        Max.SetZ(zmaxPos);
-        raw::ChannelID_t ZminChan = geom->NearestChannel(Min, geo::PlaneID{cryo, tpc, 2});
-        raw::ChannelID_t ZmaxChan = geom->NearestChannel(Max, geo::PlaneID{cryo, tpc, 2});
-
-        for (auto const& zhit : fAPAToZHits[apa] | transform(to_element)) {
+        for (auto const& zhit : ws.ZHits | transform(to_element)) {
           raw::ChannelID_t chan = zhit.Channel();
           if (chan <= ZminChan || ZmaxChan <= chan) continue;
 
@@ -280,21 +320,15 @@ namespace apa {
       } // end hit chan-wid loop
 
       if (nPossibleWids == 0) {
-        std::vector<double> xyz;
-        try {
-          xyz = bt_serv->HitToXYZ(clockData, hit);
-        } // TEMPORARY
-        catch (...) {
-          continue;
-        }
+        // noise hits (no HitToXYZ) were already skipped by RunDisambig
         ///\ todo: Figure out why sometimes non-noise hits dont match any Z hits at all.
         mf::LogWarning("UniqueTimeSeg")
-          << "U/V hit inconsistent with Z info; peak time is " << peakT << " in APA " << apa
+          << "U/V hit inconsistent with Z info; peak time is " << peakT << " in APA " << ws.apa
           << " on channel " << hit.Channel();
       }
       else if (nPossibleWids == 1) {
         for (size_t d = 0; d < hitwids.size(); d++)
-          if (IsReasonableWid[d]) this->MakeDisambigHit(hitPtr, hitwids[d], apa);
+          if (IsReasonableWid[d]) this->MakeDisambigHit(hitPtr, hitwids[d], ws);
       }
       else if (nPossibleWids == 2) {
         ///\ todo: Add mechanism to at least eliminate the wids that aren't even possible, for the benefit of future methods
@@ -305,7 +339,11 @@ namespace apa {
 
   //----------------------------------------------------------
   //----------------------------------------------------------
-  unsigned int DisambigAlg::MakeCloseHits(int ext, geo::WireID Dwid, double Dmin, double Dmax)
+  unsigned int DisambigAlg::MakeCloseHits(int ext,
+                                          geo::WireID Dwid,
+                                          double Dmin,
+                                          double Dmax,
+                                          APAWorkspace& ws) const
   {
     // Function to look, on a channel *ext* channels away from a
     // disambiguated hit channel, for hits with time windows touching
@@ -327,17 +365,17 @@ namespace apa {
     raw::ChannelID_t chan = (raw::ChannelID_t)(tempchan);
 
     // There may just be no hits
-    if (fChannelToHits.count(chan) == 0) return 0;
+    auto const chanHits = ws.ChannelToHits.find(chan);
+    if (chanHits == ws.ChannelToHits.end()) return 0;
 
     // There are close channel hits, so for each
-    unsigned int apa(0), cryo(0);
-    fAPAGeo.ChannelToAPA(chan, apa, cryo);
+    // (wrapping keeps chan in the APA of Dwid)
     unsigned int MakeCount(0);
-    for (size_t i = 0; i < fChannelToHits[chan].size(); i++) {
-      art::Ptr<recob::Hit> closeHit = fChannelToHits[chan][i];
+    std::vector<geo::WireID> const& wids = fAPAGeo.ChannelWires(chan);
+    for (size_t i = 0; i < chanHits->second.size(); i++) {
+      art::Ptr<recob::Hit> closeHit = chanHits->second[i];
       double st = closeHit->PeakTimeMinusRMS();
       double et = closeHit->PeakTimePlusRMS();
-      std::vector<geo::WireID> wids = geom->ChannelToWire(chan);
 
       if (!(Dmin <= st && st <= Dmax) && !(Dmin <= et && et <= Dmax)) continue;
 
@@ -350,8 +388,8 @@ namespace apa {
         // In this case, we have a unique wireID.
         // Check to see if it has already been made - if so, do not incriment count
         std::pair<double, double> ChanTime(closeHit->Channel() * 1., closeHit->PeakTime() * 1.);
-        if (!fHasBeenDisambiged[apa][ChanTime]) {
-          this->MakeDisambigHit(closeHit, wids[w], apa);
+        if (!ws.HasBeenDisambiged[ChanTime]) {
+          this->MakeDisambigHit(closeHit, wids[w], ws);
           MakeCount++;
           //std::cout << "     Close hit found on channel " << chan << ", time " << st<<"-"<<et << "... \n";
           //std::cout << " ... giving it wireID ("<< Dwid.Cryostat <<"," << Dwid.TPC
@@ -367,10 +405,10 @@ namespace apa {
 
   //----------------------------------------------------------
   //----------------------------------------------------------
-  void DisambigAlg::Crawl(unsigned int apa)
+  void DisambigAlg::Crawl(APAWorkspace& ws) const
   {
 
-    std::vector<art::Ptr<recob::Hit>> hits = fAPAToUVHits[apa];
+    std::vector<art::Ptr<recob::Hit>> const& hits = ws.UVHits;
 
     // repeat this method until stable
     unsigned int nExtended(1);
@@ -380,11 +418,11 @@ namespace apa {
       // Look for any disambiguated hit ...
       for (size_t h = 0; h < hits.size(); h++) {
         std::pair<double, double> ChanTime(hits[h]->Channel() * 1., hits[h]->PeakTime() * 1.);
-        if (!fHasBeenDisambiged[apa][ChanTime]) continue;
+        if (!ws.HasBeenDisambiged[ChanTime]) continue;
         double stD = hits[h]->PeakTimePlusRMS(-1.);
         double etD = hits[h]->PeakTimePlusRMS(+1.);
         double hitWindow = etD - stD;
-        geo::WireID Dwid = fChanTimeToWid[ChanTime];
+        geo::WireID Dwid = ws.ChanTimeToWid[ChanTime];
 
         // ... and if any neighboring-channel hits are close enough in time,
         // extend the disambiguation to the neighboring wire.
@@ -393,8 +431,8 @@ namespace apa {
           ///\ todo: Evaluate how aggressive we can be here. How far should we jump? In what cases should we quit out?
           unsigned int N(0);
           double timeExt = hitWindow * ext;
-          N += this->MakeCloseHits((int)(-ext), Dwid, stD - 5 - timeExt, etD + 5 + timeExt);
-          N += this->MakeCloseHits((int)(ext), Dwid, stD - 5 - timeExt, etD + 5 + timeExt);
+          N += this->MakeCloseHits((int)(-ext), Dwid, stD - 5 - timeExt, etD + 5 + timeExt, ws);
+          N += this->MakeCloseHits((int)(ext), Dwid, stD - 5 - timeExt, etD + 5 + timeExt, ws);
           extensions += N;
         }
         nExtended += extensions;
@@ -409,16 +447,17 @@ namespace apa {
   //----------------------------------------------------------
   //----------------------------------------------------------
   unsigned int DisambigAlg::FindChanTimeEndPts(detinfo::DetectorPropertiesData const& detProp,
-                                               unsigned int apa)
+                                               APAWorkspace& ws) const
   {
+    unsigned int const apa = ws.apa;
     ///\ todo: Clean up and break down into two functions.
     ///\ todo: Make the conditions more robust to some spotty hits around a potential endpoint.
 
     double pi = 3.14159265;
     double fMaxEndPRadRange = fMaxEndPDegRange / 180. * (2 * pi);
 
-    for (size_t h = 0; h < fAPAToHits[apa].size(); h++) {
-      art::Ptr<recob::Hit> centhit = fAPAToHits[apa][h];
+    for (size_t h = 0; h < ws.Hits.size(); h++) {
+      art::Ptr<recob::Hit> centhit = ws.Hits[h];
       geo::View_t view = centhit->View();
       unsigned int plane = 0;
       if (view == geo::kV) { plane = 1; }
@@ -438,8 +477,8 @@ namespace apa {
       double minDist = fCloseHitsRadius + 1.;
       double ChanDistRange = fAPAGeo.ChannelsInView(view) * geom->WirePitch(view);
 
-      for (size_t c = 0; c < fAPAToHits[apa].size(); c++) {
-        art::Ptr<recob::Hit> closehit = fAPAToHits[apa][c];
+      for (size_t c = 0; c < ws.Hits.size(); c++) {
+        art::Ptr<recob::Hit> closehit = ws.Hits[c];
         if (view != closehit->View()) continue;
         if (view == geo::kZ && centhit->WireID().TPC != closehit->WireID().TPC) continue;
         unsigned int plane = 0;
@@ -503,34 +542,35 @@ namespace apa {
         }
       }
 
-      if (maxRad - minRad < fMaxEndPRadRange) fAPAToEndPHits[apa].push_back(centhit);
+      if (maxRad - minRad < fMaxEndPRadRange) ws.EndPHits.push_back(centhit);
 
     } // end UV hit loop
 
-    if (fAPAToEndPHits[apa].size() == 0) return 0;
-    mf::LogVerbatim("FindChanTimeEndPts") << "          Found " << fAPAToEndPHits[apa].size()
+    if (ws.EndPHits.size() == 0) return 0;
+    mf::LogVerbatim("FindChanTimeEndPts") << "          Found " << ws.EndPHits.size()
                                           << " endpoint hits in apa " << apa << std::endl;
-    for (size_t ep = 0; ep < fAPAToEndPHits[apa].size(); ep++) {
-      art::Ptr<recob::Hit> epHit = fAPAToEndPHits[apa][ep];
+    for (size_t ep = 0; ep < ws.EndPHits.size(); ep++) {
+      art::Ptr<recob::Hit> epHit = ws.EndPHits[ep];
       mf::LogVerbatim("FindChanTimeEndPts") << "           endP on channel " << epHit->Channel()
                                             << " at time " << epHit->PeakTime() << std::endl;
     }
 
-    return fAPAToEndPHits[apa].size();
+    return ws.EndPHits.size();
   }
 
   //----------------------------------------------------------
   //----------------------------------------------------------
-  void DisambigAlg::UseEndPts(detinfo::DetectorPropertiesData const& detProp, unsigned int apa)
+  void DisambigAlg::UseEndPts(detinfo::DetectorPropertiesData const& detProp,
+                              APAWorkspace& ws) const
   {
 
     ///\ todo: This function could be made much cleaner and more compact
 
-    if (fAPAToEndPHits[apa].size() == 0) {
-      mf::LogVerbatim("UseEndPts") << "          APA " << apa << " has no endpoints.";
+    if (ws.EndPHits.size() == 0) {
+      mf::LogVerbatim("UseEndPts") << "          APA " << ws.apa << " has no endpoints.";
       return;
     }
-    std::vector<art::Ptr<recob::Hit>> const& endPts = fAPAToEndPHits[apa];
+    std::vector<art::Ptr<recob::Hit>> const& endPts = ws.EndPHits;
 
     std::vector<std::vector<art::Ptr<recob::Hit>>> EndPMatch;
     unsigned short nZendPts(0);
@@ -570,8 +610,8 @@ namespace apa {
 
         geo::WireID Uwid = fAPAGeo.NearestWireIDOnChan(intersect, Uhit->Channel(), 0, tpc, cryo);
         geo::WireID Vwid = fAPAGeo.NearestWireIDOnChan(intersect, Vhit->Channel(), 1, tpc, cryo);
-        this->MakeDisambigHit(Uhit, Uwid, apa);
-        this->MakeDisambigHit(Vhit, Vwid, apa);
+        this->MakeDisambigHit(Uhit, Uwid, ws);
+        this->MakeDisambigHit(Vhit, Vwid, ws);
       }
       else if (Umatch == 1 && Vmatch != 1) {
 
@@ -582,7 +622,7 @@ namespace apa {
         else if (widIntersects.size() == 1) {
           double intersect[3] = {tpcCenter.X(), widIntersects[0].y, widIntersects[0].z};
           geo::WireID Uwid = fAPAGeo.NearestWireIDOnChan(intersect, Uhit->Channel(), 0, tpc, cryo);
-          this->MakeDisambigHit(Uhit, Uwid, apa);
+          this->MakeDisambigHit(Uhit, Uwid, ws);
         }
         else {
           for (size_t i = 0; i < widIntersects.size(); i++) {
@@ -599,7 +639,7 @@ namespace apa {
         else if (widIntersects.size() == 1) {
           double intersect[3] = {tpcCenter.X(), widIntersects[0].y, widIntersects[0].z};
           geo::WireID Vwid = fAPAGeo.NearestWireIDOnChan(intersect, Vhit->Channel(), 0, tpc, cryo);
-          this->MakeDisambigHit(Vhit, Vwid, apa);
+          this->MakeDisambigHit(Vhit, Vwid, ws);
         }
       }
     }
@@ -618,23 +658,23 @@ namespace apa {
         if (endPts[1]->View() == geo::kV) plane1 = 1;
         geo::WireID wid0 =
           fAPAGeo.NearestWireIDOnChan(intersect, endPts[0]->Channel(), plane0, tpc, cryo);
-        this->MakeDisambigHit(endPts[0], wid0, apa);
+        this->MakeDisambigHit(endPts[0], wid0, ws);
         geo::WireID wid1 =
           fAPAGeo.NearestWireIDOnChan(intersect, endPts[1]->Channel(), plane1, tpc, cryo);
-        this->MakeDisambigHit(endPts[1], wid1, apa);
+        this->MakeDisambigHit(endPts[1], wid1, ws);
       }
     }
 
-    this->Crawl(apa);
+    this->Crawl(ws);
   }
 
   //----------------------------------------------------------
   //----------------------------------------------------------
-  void DisambigAlg::AssessDisambigSoFar(unsigned int apa)
+  void DisambigAlg::AssessDisambigSoFar(APAWorkspace& ws) const
   {
     unsigned int nU(0), nV(0);
-    for (size_t h = 0; h < fAPAToUVHits[apa].size(); h++) {
-      art::Ptr<recob::Hit> hit = fAPAToUVHits[apa][h];
+    for (size_t h = 0; h < ws.UVHits.size(); h++) {
+      art::Ptr<recob::Hit> hit = ws.UVHits[h];
       if (hit->View() == geo::kU)
         nU++;
       else if (hit->View() == geo::kV)
@@ -642,54 +682,55 @@ namespace apa {
     }
 
     unsigned int nDU(0), nDV(0);
-    for (size_t h = 0; h < fAPAToDHits[apa].size(); h++) {
-      art::Ptr<recob::Hit> hit = fAPAToDHits[apa][h].first;
+    for (size_t h = 0; h < ws.DHits.size(); h++) {
+      art::Ptr<recob::Hit> hit = ws.DHits[h].first;
       if (hit->View() == geo::kU)
         nDU++;
       else if (hit->View() == geo::kV)
         nDV++;
     }
 
-    fUeffSoFar[apa] = (nDU * 1.) / (nU * 1.);
-    fVeffSoFar[apa] = (nDV * 1.) / (nV * 1.);
-    fnUSoFar[apa] = nU;
-    fnVSoFar[apa] = nV;
-    fnDUSoFar[apa] = nDU;
-    fnDVSoFar[apa] = nDV;
+    ws.UeffSoFar = (nDU * 1.) / (nU * 1.);
+    ws.VeffSoFar = (nDV * 1.) / (nV * 1.);
+    ws.nUSoFar = nU;
+    ws.nVSoFar = nV;
+    ws.nDUSoFar = nDU;
+    ws.nDVSoFar = nDV;
   }
 
   //----------------------------------------------------------
   //----------------------------------------------------------
   unsigned int DisambigAlg::CompareViews(detinfo::DetectorPropertiesData const& detProp,
-                                         unsigned int apa)
+                                         APAWorkspace& ws) const
   {
     unsigned int nDisambiguations(0);
 
     // loop through all hits that are still ambiguous
-    for (auto const& ambighitPtr : fAPAToUVHits[apa]) {
+    for (auto const& ambighitPtr : ws.UVHits) {
       auto const& ambighit = *ambighitPtr;
       raw::ChannelID_t ambigchan = ambighit.Channel();
       std::pair<double, double> ambigChanTime(ambigchan * 1., ambighit.PeakTime());
-      if (fHasBeenDisambiged[apa][ambigChanTime]) continue;
+      if (ws.HasBeenDisambiged[ambigChanTime]) continue;
       geo::View_t view = ambighit.View();
-      std::vector<geo::WireID> ambigwids = geom->ChannelToWire(ambigchan);
+      std::vector<geo::WireID> const& ambigwids = fAPAGeo.ChannelWires(ambigchan);
       std::vector<unsigned int> widDcounts(ambigwids.size(), 0);
       std::vector<unsigned int> widAcounts(ambigwids.size(), 0);
 
       // loop through hits in the other view which are close in time
-      for (auto const& hit : fAPAToUVHits[apa] | transform(to_element)) {
+      for (auto const& hit : ws.UVHits | transform(to_element)) {
         if (hit.View() == view || !this->HitsOverlapInTime(detProp, ambighit, hit)) continue;
 
         // An other-view-hit overlaps in time, see what
         // wids of the ambiguous hit's channels it overlaps
         raw::ChannelID_t chan = hit.Channel();
-        std::vector<geo::WireID> wids = geom->ChannelToWire(chan);
+        std::vector<geo::WireID> const& wids = fAPAGeo.ChannelWires(chan);
         std::pair<double, double> ChanTime(chan * 1., hit.PeakTime());
         geo::WireIDIntersection widIntersect; // only so we can use the function
-        if (fHasBeenDisambiged[apa][ChanTime]) {
+        if (ws.HasBeenDisambiged[ChanTime]) {
+          geo::WireID const& Dwid = ws.ChanTimeToWid[ChanTime];
           for (size_t a = 0; a < ambigwids.size(); a++)
-            if (ambigwids[a].TPC == fChanTimeToWid[ChanTime].TPC &&
-                geom->WireIDsIntersect(ambigwids[a], fChanTimeToWid[ChanTime], widIntersect))
+            if (ambigwids[a].TPC == Dwid.TPC &&
+                geom->WireIDsIntersect(ambigwids[a], Dwid, widIntersect))
               widDcounts[a]++;
         }
         else {
@@ -712,7 +753,7 @@ namespace apa {
         Acount += widAcounts[a];
       for (size_t d = 0; d < widDcounts.size(); d++) {
         if (Dcount == widDcounts[d] && Dcount > 0 && Acount == 0) {
-          this->MakeDisambigHit(ambighitPtr, ambigwids[d], apa);
+          this->MakeDisambigHit(ambighitPtr, ambigwids[d], ws);
           nDisambiguations++;
         }
       }
@@ -6,6 +6,7 @@
 #define DisambigAlg_H
 
 #include <map>
+#include <string>
 #include <utility> // std::pair<>
 #include <vector>
 
@@ -71,29 +72,60 @@ namespace apa {
     // **temporarily** here to look at performance without noise hits
     art::ServiceHandle<cheat::BackTrackerService const> bt_serv;
 
-    // Hits organization
-    std::map<raw::ChannelID_t, std::vector<art::Ptr<recob::Hit>>> fChannelToHits;
-    std::map<unsigned int, std::vector<art::Ptr<recob::Hit>>> fAPAToUVHits, fAPAToZHits;
-    std::map<unsigned int, std::vector<art::Ptr<recob::Hit>>> fAPAToHits;
-    ///\ todo: Channel/APA to hits can be done in a unified way
-    std::map<unsigned int, std::vector<art::Ptr<recob::Hit>>> fAPAToEndPHits;
-    std::map<unsigned int, std::vector<std::pair<art::Ptr<recob::Hit>, geo::WireID>>> fAPAToDHits;
-    ///< Hold the disambiguations per APA
-
-    // data/function to keep track of disambiguation along the way
-    std::map<std::pair<double, double>, geo::WireID> fChanTimeToWid;
-    ///< If a hit is disambiguated, map its chan and peak time to the chosen wireID
-    std::map<unsigned int, std::map<std::pair<double, double>, bool>> fHasBeenDisambiged;
-    ///< Convenient way to keep track of disambiguation so far
-    void MakeDisambigHit(art::Ptr<recob::Hit> const& hit, geo::WireID, unsigned int apa);
+    /// Everything the disambiguation of one APA reads and writes. Hits never
+    /// look outside their own APA, so the workspaces can be worked on at once
+    struct APAWorkspace {
+      unsigned int apa{0};
+
+      // Hits organization
+      std::map<raw::ChannelID_t, std::vector<art::Ptr<recob::Hit>>> ChannelToHits; ///< U/V only
+      std::vector<art::Ptr<recob::Hit>> UVHits, ZHits;
+      std::vector<art::Ptr<recob::Hit>> Hits;
+      std::vector<art::Ptr<recob::Hit>> EndPHits;
+      std::vector<std::pair<art::Ptr<recob::Hit>, geo::WireID>> DHits;
+      ///< Hold the disambiguations
+
+      // data to keep track of disambiguation along the way
+      std::map<std::pair<double, double>, geo::WireID> ChanTimeToWid;
+      ///< If a hit is disambiguated, map its chan and peak time to the chosen wireID
+      std::map<std::pair<double, double>, bool> HasBeenDisambiged;
+      ///< Convenient way to keep track of disambiguation so far
+
+      double UeffSoFar{0.}, VeffSoFar{0.};
+      unsigned int nUSoFar{0}, nVSoFar{0}, nDUSoFar{0}, nDVSoFar{0};
+      std::string Summary; ///< progress report, logged once the APA is done
+    };
+    std::map<unsigned int, APAWorkspace> fAPAWorkspaces;
+
+    void DisambigAPA(detinfo::DetectorClocksData const& clockData,
+                     detinfo::DetectorPropertiesData const& detProp,
+                     APAWorkspace& ws) const; ///< Run all the configured steps on one APA
+
+    void TrivialDisambig(detinfo::DetectorClocksData const& clockData,
+                         detinfo::DetectorPropertiesData const& detProp,
+                         APAWorkspace& ws) const;
+    void Crawl(APAWorkspace& ws) const;
+    unsigned int FindChanTimeEndPts(detinfo::DetectorPropertiesData const& detProp,
+                                    APAWorkspace& ws) const;
+    void UseEndPts(detinfo::DetectorPropertiesData const& detProp, APAWorkspace& ws) const;
+    unsigned int CompareViews(detinfo::DetectorPropertiesData const& detProp,
+                              APAWorkspace& ws) const;
+    void AssessDisambigSoFar(APAWorkspace& ws) const;
+    void PublishSoFar(APAWorkspace const& ws); ///< Copy the counters to the public maps
+
+    void MakeDisambigHit(art::Ptr<recob::Hit> const& hit, geo::WireID, APAWorkspace& ws) const;
     ///< Makes a disambiguated hit while keeping track of what has already been disambiguated
 
     // Functions that support disambiguation methods
-    unsigned int MakeCloseHits(int ext, geo::WireID wid, double Dmin, double Dmax);
+    unsigned int MakeCloseHits(int ext,
+                               geo::WireID wid,
+                               double Dmin,
+                               double Dmax,
+                               APAWorkspace& ws) const;
     ///< Having disambiguated a time range on a wireID, extend to neighboring channels
     bool HitsOverlapInTime(detinfo::DetectorPropertiesData const& detProp,
                            recob::Hit const& hitA,
-                           recob::Hit const& hitB);
+                           recob::Hit const& hitB) const;
     bool HitsReasonablyMatch(art::Ptr<recob::Hit> hitA, art::Ptr<recob::Hit> hitB);
     ///\ todo: Write function that compares hits more detailedly
 
@@ -107,6 +139,7 @@ namespace apa {
     double fMaxEndPDegRange;  ///< Within the close hits radius, how spread can
                               ///< the majority of the activity be around a
                               ///< possible endpoint
+    bool fParallelAPAs;       ///< Disambiguate the APAs concurrently
 
   }; // class DisambigAlg
 
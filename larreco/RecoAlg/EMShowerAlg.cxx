@@ -468,15 +468,14 @@ std::unique_ptr<recob::Track> shower::EMShowerAlg::ConstructTrack(
 
   for (unsigned int i = 0; i < pmatrack->size(); i++) {
 
-    xyz.push_back((*pmatrack)[i]->Point3D());
+    xyz.push_back(pma::ToTVector3((*pmatrack)[i]->Point3D()));
 
     if (i < pmatrack->size() - 1) {
       size_t j = i + 1;
       double mag = 0.0;
       TVector3 dc(0., 0., 0.);
       while ((mag == 0.0) and (j < pmatrack->size())) {
-        dc = (*pmatrack)[j]->Point3D();
-        dc -= (*pmatrack)[i]->Point3D();
+        dc = pma::ToTVector3((*pmatrack)[j]->Point3D() - (*pmatrack)[i]->Point3D());
         mag = dc.Mag();
         ++j;
       }
@@ -1116,7 +1115,7 @@ recob::Shower shower::EMShowerAlg::MakeShower(detinfo::DetectorClocksData const&
 
     for (size_t i = 0; i < pmatrack->size(); ++i) {
       if ((*pmatrack)[i]->IsEnabled()) {
-        TVector3 p3d = (*pmatrack)[i]->Point3D();
+        TVector3 p3d = pma::ToTVector3((*pmatrack)[i]->Point3D());
         spts.push_back(p3d);
       }
     }
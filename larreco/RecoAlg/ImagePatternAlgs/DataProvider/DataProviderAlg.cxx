@@ -29,6 +29,32 @@ namespace geo {
 #include <string>
 #include <vector>
 
+namespace {
+  // Lifetime corrected ADC samples, adc[k] * lifetime[tick0 + k], zero where the tick is
+  // beyond the lifetime table. The buffer is reused by all calls made on the same thread.
+  float const* correctedSamples(std::vector<float> const& adc,
+                                std::vector<float> const& lifetime,
+                                size_t tick0)
+  {
+    thread_local std::vector<float> corrected;
+    corrected.resize(adc.size());
+
+    size_t n = 0;
+    if (tick0 < lifetime.size()) { n = std::min(adc.size(), lifetime.size() - tick0); }
+
+    float const* a = adc.data();
+    float* c = corrected.data();
+    if (n) {
+      float const* lt = lifetime.data() + tick0;
+      for (size_t k = 0; k < n; ++k) {
+        c[k] = a[k] * lt[k];
+      }
+    }
+    std::fill(c + n, c + adc.size(), 0.0F);
+    return c;
+  }
+}
+
 img::DataProviderAlg::DataProviderAlg(const Config& config)
   : fAlgView{}
   , fDownscaleMode(img::DataProviderAlg::kMax)
@@ -125,7 +151,7 @@ img::DataProviderAlgView img::DataProviderAlg::resizeView(
 
   result.fWireChannels.resize(wires, raw::InvalidChannelID);
 
-  result.fWireDriftData.resize(wires, std::vector<float>(result.fNCachedDrifts, fAdcZero));
+  result.resetImage(fAdcZero);
 
   result.fLifetimeCorrFactors.resize(drifts);
   if (fCalibrateLifetime) {
@@ -160,7 +186,7 @@ float img::DataProviderAlg::poolMax(int wire, int drift, size_t r) const
 
   float adc, max_adc = 0;
   for (int w = w0; w <= w1; ++w) {
-    auto const* col = fAlgView.fWireDriftData[w].data();
+    auto const* col = fAlgView.wireData(w);
     for (int d = d0; d <= d1; ++d) {
       adc = col[d];
       if (adc > max_adc) { max_adc = adc; }
@@ -193,96 +219,52 @@ float img::DataProviderAlg::poolMax(int wire, int drift, size_t r) const
 //    return sum;
 //}
 // ------------------------------------------------------
-std::vector<float> img::DataProviderAlg::downscaleMax(std::size_t dst_size,
-                                                      std::vector<float> const& adc,
-                                                      size_t tick0) const
+void img::DataProviderAlg::downscaleMax(float* dst,
+                                        std::size_t dst_size,
+                                        std::vector<float> const& adc,
+                                        size_t tick0) const
 {
-  size_t kStop = dst_size;
-  std::vector<float> result(dst_size);
-  if (adc.size() < kStop) { kStop = adc.size(); }
-  for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow) {
-    size_t k1 = k0 + fDriftWindow;
-
-    float max_adc = adc[k0] * fAlgView.fLifetimeCorrFactors[k0 + tick0];
-    for (size_t k = k0 + 1; k < k1; ++k) {
-      float ak = adc[k] * fAlgView.fLifetimeCorrFactors[k + tick0];
-      if (ak > max_adc) max_adc = ak;
-    }
-    result[i] = max_adc;
-  }
-  scaleAdcSamples(result);
-  return result;
+  float const* c = correctedSamples(adc, fAlgView.fLifetimeCorrFactors, tick0);
+
+  size_t const kStop = downscaleWindowsMax(dst, dst_size, c, adc.size(), fDriftWindow);
+  std::fill(dst + kStop, dst + dst_size, 0.0F);
+  scaleAdcSamples(dst, dst_size);
 }
 
-std::vector<float> img::DataProviderAlg::downscaleMaxMean(std::size_t dst_size,
-                                                          std::vector<float> const& adc,
-                                                          size_t tick0) const
+void img::DataProviderAlg::downscaleMaxMean(float* dst,
+                                            std::size_t dst_size,
+                                            std::vector<float> const& adc,
+                                            size_t tick0) const
 {
-  size_t kStop = dst_size;
-  std::vector<float> result(dst_size);
-  if (adc.size() < kStop) { kStop = adc.size(); }
-  for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow) {
-    size_t k1 = k0 + fDriftWindow;
-    size_t max_idx = k0;
-    float max_adc = adc[k0] * fAlgView.fLifetimeCorrFactors[k0 + tick0];
-    for (size_t k = k0 + 1; k < k1; ++k) {
-      float ak = adc[k] * fAlgView.fLifetimeCorrFactors[k + tick0];
-      if (ak > max_adc) {
-        max_adc = ak;
-        max_idx = k;
-      }
-    }
+  float const* c = correctedSamples(adc, fAlgView.fLifetimeCorrFactors, tick0);
 
-    size_t n = 1;
-    if (max_idx > 0) {
-      max_adc += adc[max_idx - 1] * fAlgView.fLifetimeCorrFactors[max_idx - 1 + tick0];
-      n++;
-    }
-    if (max_idx + 1 < adc.size()) {
-      max_adc += adc[max_idx + 1] * fAlgView.fLifetimeCorrFactors[max_idx + 1 + tick0];
-      n++;
-    }
-
-    result[i] = max_adc / n;
-  }
-  scaleAdcSamples(result);
-  return result;
+  size_t const kStop = downscaleWindowsMaxMean(dst, dst_size, c, adc.size(), fDriftWindow);
+  std::fill(dst + kStop, dst + dst_size, 0.0F);
+  scaleAdcSamples(dst, dst_size);
 }
 
-std::vector<float> img::DataProviderAlg::downscaleMean(std::size_t dst_size,
-                                                       std::vector<float> const& adc,
-                                                       size_t tick0) const
+void img::DataProviderAlg::downscaleMean(float* dst,
+                                         std::size_t dst_size,
+                                         std::vector<float> const& adc,
+                                         size_t tick0) const
 {
-  size_t kStop = dst_size;
-  std::vector<float> result(dst_size);
-  if (adc.size() < kStop) { kStop = adc.size(); }
-  for (size_t i = 0, k0 = 0; i < kStop; ++i, k0 += fDriftWindow) {
-    size_t k1 = k0 + fDriftWindow;
-
-    float sum_adc = 0;
-    for (size_t k = k0; k < k1; ++k) {
-      if (k + tick0 < fAlgView.fLifetimeCorrFactors.size())
-        sum_adc += adc[k] * fAlgView.fLifetimeCorrFactors[k + tick0];
-    }
-    result[i] = sum_adc * fDriftWindowInv;
-  }
-  scaleAdcSamples(result);
-  return result;
+  float const* c = correctedSamples(adc, fAlgView.fLifetimeCorrFactors, tick0);
+
+  size_t const kStop = downscaleWindowsMean(dst, dst_size, c, adc.size(), fDriftWindow);
+  std::fill(dst + kStop, dst + dst_size, 0.0F);
+  scaleAdcSamples(dst, dst_size);
 }
 
-std::optional<std::vector<float>> img::DataProviderAlg::setWireData(std::vector<float> const& adc,
-                                                                    size_t wireIdx) const
+bool img::DataProviderAlg::setWireData(std::vector<float> const& adc, size_t wireIdx)
 {
-  if (wireIdx >= fAlgView.fWireDriftData.size()) { return std::nullopt; }
-  auto& wData = fAlgView.fWireDriftData[wireIdx];
+  if ((wireIdx >= fAlgView.fNWires) || adc.empty()) { return false; }
+  float* wData = fAlgView.wireData(wireIdx);
 
-  if (fDownscaleFullView) {
-    if (!adc.empty()) { return downscale(wData.size(), adc, 0); }
-    return std::nullopt;
+  if (fDownscaleFullView) { downscale(wData, fAlgView.fNCachedDrifts, adc, 0); }
+  else {
+    std::copy_n(adc.begin(), std::min<size_t>(adc.size(), fAlgView.fNCachedDrifts), wData);
   }
-  if (adc.empty()) { return std::nullopt; }
-  if (adc.size() <= wData.size()) { return adc; }
-  return std::vector<float>(adc.begin(), adc.begin() + wData.size());
+  return true;
 }
 // ------------------------------------------------------
 
@@ -326,12 +308,10 @@ bool img::DataProviderAlg::setWireDriftData(detinfo::DetectorClocksData const& c
           mf::LogWarning("DataProviderAlg") << "Wire ADC vector size lower than NumberTimeSamples.";
           continue; // not critical, maybe other wires are OK, so continue
         }
-        auto wire_data = setWireData(adc, w_idx);
-        if (!wire_data) {
+        if (!setWireData(adc, w_idx)) {
           mf::LogWarning("DataProviderAlg") << "Wire data not set.";
           continue; // also not critical, try to set other wires
         }
-        fAlgView.fWireDriftData[w_idx] = *wire_data;
         for (auto v : adc) {
           if (v >= fAdcSumThr) {
             fAdcSumOverThr += v;
@@ -372,42 +352,20 @@ float img::DataProviderAlg::scaleAdcSample(float val) const
            (val - fAdcMin); // shift and scale to the output range, shift to the output min
 }
 // ------------------------------------------------------
-void img::DataProviderAlg::scaleAdcSamples(std::vector<float>& values) const
+void img::DataProviderAlg::scaleAdcSamples(float* values, std::size_t size) const
 {
-  float calib = fAmplCalibConst[fPlane];
-  auto* data = values.data();
-
-  size_t k = 0, size4 = values.size() >> 2, size = values.size();
-  for (size_t i = 0; i < size4; ++i) // vectorize if you can
-  {
-    data[k] *= calib; // prescale by plane-to-plane calibration factors
-    data[k + 1] *= calib;
-    data[k + 2] *= calib;
-    data[k + 3] *= calib;
-
-    if (data[k] < fAdcMin) { data[k] = fAdcMin; } // saturate min
-    if (data[k + 1] < fAdcMin) { data[k + 1] = fAdcMin; }
-    if (data[k + 2] < fAdcMin) { data[k + 2] = fAdcMin; }
-    if (data[k + 3] < fAdcMin) { data[k + 3] = fAdcMin; }
-
-    if (data[k] > fAdcMax) { data[k] = fAdcMax; } // saturate max
-    if (data[k + 1] > fAdcMax) { data[k + 1] = fAdcMax; }
-    if (data[k + 2] > fAdcMax) { data[k + 2] = fAdcMax; }
-    if (data[k + 3] > fAdcMax) { data[k + 3] = fAdcMax; }
-
-    data[k] = fAdcOffset +
-              fAdcScale *
-                (data[k] - fAdcMin); // shift and scale to the output range, shift to the output min
-    data[k + 1] = fAdcOffset + fAdcScale * (data[k + 1] - fAdcMin);
-    data[k + 2] = fAdcOffset + fAdcScale * (data[k + 2] - fAdcMin);
-    data[k + 3] = fAdcOffset + fAdcScale * (data[k + 3] - fAdcMin);
-
-    k += 4;
+  // local copies, so the compiler knows the values written do not change them, and can
+  // vectorize the loop
+  float const calib = fAmplCalibConst[fPlane];
+  float const adcMin = fAdcMin, adcMax = fAdcMax;
+  float const offset = fAdcOffset, scale = fAdcScale;
+
+  for (size_t k = 0; k < size; ++k) {
+    float v = values[k] * calib;   // prescale by plane-to-plane calibration factors
+    v = (v < adcMin) ? adcMin : v; // saturate min
+    v = (v > adcMax) ? adcMax : v; // saturate max
+    values[k] = offset + scale * (v - adcMin); // shift and scale to the output range
   }
-  while (k < size) {
-    data[k] = scaleAdcSample(data[k]);
-    ++k;
-  } // do the tail
 }
 // ------------------------------------------------------
 
@@ -418,58 +376,49 @@ void img::DataProviderAlg::applyBlur()
   size_t margin_left = (fBlurKernel.size() - 1) >> 1,
          margin_right = fBlurKernel.size() - margin_left - 1;
 
-  std::vector<std::vector<float>> src(fAlgView.fWireDriftData.size());
-  for (size_t w = 0; w < fAlgView.fWireDriftData.size(); ++w) {
-    src[w] = fAlgView.fWireDriftData[w];
-  }
-
-  for (size_t w = margin_left; w < fAlgView.fWireDriftData.size() - margin_right; ++w) {
-    for (size_t d = 0; d < fAlgView.fWireDriftData[w].size(); ++d) {
-      float sum = 0;
-      for (size_t i = 0; i < fBlurKernel.size(); ++i) {
-        sum += fBlurKernel[i] * src[w + i - margin_left][d];
+  size_t const nWires = fAlgView.fNWires;
+  size_t const nDrifts = fAlgView.fNCachedDrifts;
+  size_t const stride = fAlgView.fDriftStride;
+  if (nWires <= margin_left + margin_right) return;
+
+  fBlurBuffer.assign(fAlgView.fWireDriftData.begin(), fAlgView.fWireDriftData.end());
+
+  // accumulate whole rows, kernel weight by kernel weight, so the inner loop runs
+  // over consecutive drift samples
+  for (size_t w = margin_left; w < nWires - margin_right; ++w) {
+    float* dst = fAlgView.wireData(w);
+    std::fill(dst, dst + nDrifts, 0.0F);
+    for (size_t i = 0; i < fBlurKernel.size(); ++i) {
+      float const k = fBlurKernel[i];
+      float const* src = fBlurBuffer.data() + (w + i - margin_left) * stride;
+      for (size_t d = 0; d < nDrifts; ++d) {
+        dst[d] += k * src[d];
       }
-      fAlgView.fWireDriftData[w][d] = sum;
     }
   }
 }
 // ------------------------------------------------------
 
-// MUST give the same result as get_patch() in scripts/utils.py
+std::optional<img::ImageView> img::DataProviderAlg::patchView(size_t wire,
+                                                              float drift,
+                                                              size_t patchSizeW,
+                                                              size_t patchSizeD) const
+{
+  if (!fDownscaleFullView) { return std::nullopt; }
+
+  size_t sd = (size_t)(drift / fDriftWindow);
+  return imagePatchView(fAlgView, wire, sd, patchSizeW, patchSizeD);
+}
+// ------------------------------------------------------
+
 bool img::DataProviderAlg::patchFromDownsampledView(size_t wire,
                                                     float drift,
                                                     size_t size_w,
                                                     size_t size_d,
-                                                    std::vector<std::vector<float>>& patch) const
+                                                    float* patch) const
 {
-  int halfSizeW = size_w / 2;
-  int halfSizeD = size_d / 2;
-
-  int w0 = wire - halfSizeW;
-  int w1 = wire + halfSizeW;
-
   size_t sd = (size_t)(drift / fDriftWindow);
-  int d0 = sd - halfSizeD;
-  int d1 = sd + halfSizeD;
-
-  int wsize = fAlgView.fWireDriftData.size();
-  for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch) {
-    auto& dst = patch[wpatch];
-    if ((w >= 0) && (w < wsize)) {
-      auto& src = fAlgView.fWireDriftData[w];
-      int dsize = src.size();
-      for (int d = d0, dpatch = 0; d < d1; ++d, ++dpatch) {
-        if ((d >= 0) && (d < dsize)) { dst[dpatch] = src[d]; }
-        else {
-          dst[dpatch] = fAdcZero;
-        }
-      }
-    }
-    else {
-      std::fill(dst.begin(), dst.end(), fAdcZero);
-    }
-  }
-
+  copyImagePatch(fAlgView, wire, sd, size_w, size_d, fAdcZero, patch);
   return true;
 }
 
@@ -477,7 +426,7 @@ bool img::DataProviderAlg::patchFromOriginalView(size_t wire,
                                                  float drift,
                                                  size_t size_w,
                                                  size_t size_d,
-                                                 std::vector<std::vector<float>>& patch) const
+                                                 float* patch) const
 {
   int dsize = fDriftWindow * size_d;
   int halfSizeW = size_w / 2;
@@ -491,23 +440,19 @@ bool img::DataProviderAlg::patchFromOriginalView(size_t wire,
 
   if (d0 < 0) d0 = 0;
 
+  std::fill(patch, patch + size_w * size_d, fAdcZero);
+
   std::vector<float> tmp(dsize);
-  int wsize = fAlgView.fWireDriftData.size();
+  int wsize = fAlgView.fNWires;
+  int src_size = fAlgView.fNCachedDrifts;
+  int db = std::min(d1, src_size);
   for (int w = w0, wpatch = 0; w < w1; ++w, ++wpatch) {
-    if ((w >= 0) && (w < wsize)) {
-      auto& src = fAlgView.fWireDriftData[w];
-      int src_size = src.size();
-      for (int d = d0, dpatch = 0; d < d1; ++d, ++dpatch) {
-        if ((d >= 0) && (d < src_size)) { tmp[dpatch] = src[d]; }
-        else {
-          tmp[dpatch] = fAdcZero;
-        }
-      }
-    }
-    else {
-      std::fill(tmp.begin(), tmp.end(), fAdcZero);
+    std::fill(tmp.begin(), tmp.end(), fAdcZero);
+    if ((w >= 0) && (w < wsize) && (d0 < db)) {
+      float const* src = fAlgView.wireData(w);
+      std::copy(src + d0, src + db, tmp.begin());
     }
-    patch[wpatch] = downscale(patch[wpatch].size(), tmp, d0);
+    downscale(patch + wpatch * size_d, size_d, tmp, d0);
   }
 
   return true;
@@ -523,9 +468,10 @@ void img::DataProviderAlg::addWhiteNoise()
 
   CLHEP::RandGauss gauss(fRndEngine);
   std::vector<double> noise(fAlgView.fNCachedDrifts);
-  for (auto& wire : fAlgView.fWireDriftData) {
+  for (size_t w = 0; w < fAlgView.fNWires; ++w) {
     gauss.fireArray(fAlgView.fNCachedDrifts, noise.data(), 0., effectiveSigma);
-    for (size_t d = 0; d < wire.size(); ++d) {
+    float* wire = fAlgView.wireData(w);
+    for (size_t d = 0; d < fAlgView.fNCachedDrifts; ++d) {
       wire[d] += noise[d];
     }
   }
@@ -540,21 +486,21 @@ void img::DataProviderAlg::addCoherentNoise()
   if (fDownscaleFullView) effectiveSigma /= fDriftWindow;
 
   CLHEP::RandGauss gauss(fRndEngine);
-  std::vector<double> amps1(fAlgView.fWireDriftData.size());
-  std::vector<double> amps2(1 + (fAlgView.fWireDriftData.size() / 32));
+  std::vector<double> amps1(fAlgView.fNWires);
+  std::vector<double> amps2(1 + (fAlgView.fNWires / 32));
   gauss.fireArray(amps1.size(), amps1.data(), 1., 0.1); // 10% wire-wire ampl. variation
   gauss.fireArray(amps2.size(), amps2.data(), 1., 0.1); // 10% group-group ampl. variation
 
   double group_amp = 1.0;
   std::vector<double> noise(fAlgView.fNCachedDrifts);
-  for (size_t w = 0; w < fAlgView.fWireDriftData.size(); ++w) {
+  for (size_t w = 0; w < fAlgView.fNWires; ++w) {
     if ((w & 31) == 0) {
       group_amp = amps2[w >> 5]; // div by 32
       gauss.fireArray(fAlgView.fNCachedDrifts, noise.data(), 0., effectiveSigma);
     } // every 32 wires
 
-    auto& wire = fAlgView.fWireDriftData[w];
-    for (size_t d = 0; d < wire.size(); ++d) {
+    float* wire = fAlgView.wireData(w);
+    for (size_t d = 0; d < fAlgView.fNCachedDrifts; ++d) {
       wire[d] += group_amp * amps1[w] * noise[d];
     }
   }
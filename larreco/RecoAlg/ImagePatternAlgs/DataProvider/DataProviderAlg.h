@@ -32,8 +32,11 @@ namespace geo {
 #include "CLHEP/Random/JamesRandom.h" // for testing on noise, not used by any reco
 
 // ROOT & C++
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <optional>
 #include <vector>
 
@@ -44,21 +47,237 @@ namespace detinfo {
 
 namespace img {
   class DataProviderAlg;
+
+  /// Allocator returning memory aligned to the cache line (and to the widest SIMD registers).
+  template <typename T, std::size_t Alignment = 64>
+  struct AlignedAllocator {
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(AlignedAllocator<U, Alignment> const&)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(AlignedAllocator<U, Alignment> const&) const
+    {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(AlignedAllocator<U, Alignment> const&) const
+    {
+      return false;
+    }
+  };
+
+  /// Non-owning view of a rectangular part of an image stored wire after wire, with
+  /// Stride() values between the starts of consecutive wires.
+  class ImageView {
+  public:
+    ImageView() = default;
+    ImageView(float const* data, std::size_t nWires, std::size_t nDrifts, std::size_t stride)
+      : fData(data), fNWires(nWires), fNDrifts(nDrifts), fStride(stride)
+    {}
+
+    std::size_t NWires() const { return fNWires; }
+    std::size_t NDrifts() const { return fNDrifts; }
+    std::size_t Stride() const { return fStride; }
+
+    /// Pointer to the NDrifts() values of the wire
+    float const* wireData(std::size_t widx) const { return fData + widx * fStride; }
+    float operator()(std::size_t widx, std::size_t didx) const
+    {
+      return fData[widx * fStride + didx];
+    }
+
+  private:
+    float const* fData = nullptr;
+    std::size_t fNWires = 0;
+    std::size_t fNDrifts = 0;
+    std::size_t fStride = 0;
+  };
+
   struct DataProviderAlgView {
+    /// Number of floats the rows of fWireDriftData are aligned to
+    static constexpr unsigned int kRowAlignment = 16;
+
     unsigned int fNWires;
     unsigned int fNDrifts;
     unsigned int fNScaledDrifts;
     unsigned int fNCachedDrifts;
+    unsigned int fDriftStride; ///< fNCachedDrifts rounded up to a multiple of kRowAlignment
     std::vector<raw::ChannelID_t> fWireChannels;
-    std::vector<std::vector<float>> fWireDriftData;
+    /// One buffer for the whole image, fNWires rows of fDriftStride values (the values
+    /// after the first fNCachedDrifts of each row are padding).
+    std::vector<float, AlignedAllocator<float>> fWireDriftData;
     std::vector<float> fLifetimeCorrFactors;
+
+    float* wireData(std::size_t widx) { return fWireDriftData.data() + widx * fDriftStride; }
+    float const* wireData(std::size_t widx) const
+    {
+      return fWireDriftData.data() + widx * fDriftStride;
+    }
+
+    /// Sizes the image for fNWires x fNCachedDrifts pixels, all set to value.
+    void resetImage(float value)
+    {
+      fDriftStride = kRowAlignment * ((fNCachedDrifts + kRowAlignment - 1) / kRowAlignment);
+      fWireDriftData.assign(std::size_t(fNWires) * fDriftStride, value);
+    }
   };
+
+  /// Fills size_w x size_d values, wire after wire, starting at patch, with the pixels of the
+  /// image around the wire and the drift index didx (in cached drifts); the pixels beyond the
+  /// image are set to zero. MUST give the same result as get_patch() in scripts/utils.py
+  inline void copyImagePatch(DataProviderAlgView const& view,
+                             std::size_t wire,
+                             std::size_t didx,
+                             std::size_t size_w,
+                             std::size_t size_d,
+                             float zero,
+                             float* patch)
+  {
+    int halfSizeW = size_w / 2;
+    int halfSizeD = size_d / 2;
+
+    int w0 = wire - halfSizeW;
+    int w1 = wire + halfSizeW;
+    int d0 = didx - halfSizeD;
+    int d1 = didx + halfSizeD;
+
+    std::fill(patch, patch + size_w * size_d, zero);
+
+    // copy the part of each wire which is inside the view, the rest stays at the zero level
+    int wsize = view.fNWires;
+    int dsize = view.fNCachedDrifts;
+    int da = std::max(d0, 0);
+    int db = std::min(d1, dsize);
+    if (da >= db) { return; }
+
+    for (int w = std::max(w0, 0); w < std::min(w1, wsize); ++w) {
+      float const* src = view.wireData(w);
+      float* dst = patch + (w - w0) * size_d;
+      std::copy(src + da, src + db, dst + (da - d0));
+    }
+  }
+
+  /// The pixels copied by copyImagePatch (all of them if the sizes are even), without
+  /// copying; nullopt if the patch extends beyond the image.
+  inline std::optional<ImageView> imagePatchView(DataProviderAlgView const& view,
+                                                 std::size_t wire,
+                                                 std::size_t didx,
+                                                 std::size_t size_w,
+                                                 std::size_t size_d)
+  {
+    int halfSizeW = size_w / 2;
+    int halfSizeD = size_d / 2;
+
+    int w0 = wire - halfSizeW;
+    int w1 = wire + halfSizeW;
+    int d0 = didx - halfSizeD;
+    int d1 = didx + halfSizeD;
+
+    if ((w0 < 0) || (d0 < 0) || (w1 > (int)view.fNWires) || (d1 > (int)view.fNCachedDrifts)) {
+      return std::nullopt;
+    }
+    return ImageView(view.wireData(w0) + d0, w1 - w0, d1 - d0, view.fDriftStride);
+  }
+
+  // Reductions of the n (lifetime corrected) samples c in windows of `window` samples, one
+  // value per complete window written to dst, at most dst_size of them; return the number
+  // of values written. The loops are written to be vectorized by the compiler.
+
+  /// Maximum of each window
+  inline std::size_t downscaleWindowsMax(float* dst,
+                                         std::size_t dst_size,
+                                         float const* c,
+                                         std::size_t n,
+                                         std::size_t window)
+  {
+    std::size_t const kStop = std::min(dst_size, n / window);
+    for (std::size_t i = 0; i < kStop; ++i) {
+      float const* w = c + i * window;
+      float max_adc = w[0];
+      for (std::size_t k = 1; k < window; ++k) {
+        max_adc = (w[k] > max_adc) ? w[k] : max_adc;
+      }
+      dst[i] = max_adc;
+    }
+    return kStop;
+  }
+
+  /// Mean of the maximum of each window and of its neighbours
+  inline std::size_t downscaleWindowsMaxMean(float* dst,
+                                             std::size_t dst_size,
+                                             float const* c,
+                                             std::size_t n,
+                                             std::size_t window)
+  {
+    std::size_t const kStop = std::min(dst_size, n / window);
+    for (std::size_t i = 0, k0 = 0; i < kStop; ++i, k0 += window) {
+      std::size_t max_idx = k0;
+      for (std::size_t k = k0 + 1; k < k0 + window; ++k) {
+        if (c[k] > c[max_idx]) { max_idx = k; }
+      }
+
+      float max_adc = c[max_idx];
+      std::size_t nSum = 1;
+      if (max_idx > 0) {
+        max_adc += c[max_idx - 1];
+        nSum++;
+      }
+      if (max_idx + 1 < n) {
+        max_adc += c[max_idx + 1];
+        nSum++;
+      }
+
+      dst[i] = max_adc / nSum;
+    }
+    return kStop;
+  }
+
+  /// Mean of each window
+  inline std::size_t downscaleWindowsMean(float* dst,
+                                          std::size_t dst_size,
+                                          float const* c,
+                                          std::size_t n,
+                                          std::size_t window)
+  {
+    float const windowInv = 1.0 / window;
+    std::size_t const kStop = std::min(dst_size, n / window);
+    for (std::size_t i = 0; i < kStop; ++i) {
+      float const* w = c + i * window;
+      float sum_adc = 0;
+      for (std::size_t k = 0; k < window; ++k) {
+        sum_adc += w[k];
+      }
+      dst[i] = sum_adc * windowInv;
+    }
+    return kStop;
+  }
 }
 
 /// Base class providing data for training / running image based classifiers. It can be used
 /// also for any other algorithms where 2D projection image is useful. Currently the image
 /// is 32-bit fp / pixel, as sson as have time will template it so e.g. byte pixels would
 /// be possible.
+///
+/// The image is kept in one aligned buffer (DataProviderAlgView::fWireDriftData, rows of
+/// fDriftStride values) instead of a vector per wire. Derived classes written for the
+/// previous layout need to be migrated: wireData() returns a pointer to the NCachedDrifts()
+/// values of the wire instead of a std::vector, the rows are reached with
+/// fAlgView.wireData(widx), and setWireData(adc, widx) fills the row of the wire in place
+/// and returns false if the wire is not valid, instead of returning the downscaled values.
 class img::DataProviderAlg {
 public:
   enum EDownscaleMode { kMax = 1, kMaxMean = 2, kMean = 3 };
@@ -114,7 +333,17 @@ public:
                         unsigned int tpc,
                         unsigned int cryo);
 
-  std::vector<float> const& wireData(size_t widx) const { return fAlgView.fWireDriftData[widx]; }
+  /// The NCachedDrifts() values of the wire.
+  float const* wireData(size_t widx) const { return fAlgView.wireData(widx); }
+
+  /// The whole image, without copying.
+  ImageView imageView() const
+  {
+    return ImageView(fAlgView.fWireDriftData.data(),
+                     fAlgView.fNWires,
+                     fAlgView.fNCachedDrifts,
+                     fAlgView.fDriftStride);
+  }
 
   /// Return patch of data centered on the wire and drift, witht the size in (downscaled) pixels givent
   /// with patchSizeW and patchSizeD.  Pad with the zero-level calue if patch extends beyond the event
@@ -124,27 +353,53 @@ public:
                                            size_t patchSizeW,
                                            size_t patchSizeD) const
   {
+    std::vector<float> flat;
+    getPatch(wire, drift, patchSizeW, patchSizeD, flat);
+
+    std::vector<std::vector<float>> patch(patchSizeW);
+    for (size_t w = 0; w < patchSizeW; ++w) {
+      patch[w].assign(flat.begin() + w * patchSizeD, flat.begin() + (w + 1) * patchSizeD);
+    }
+    return patch;
+  }
+
+  /// Same as above, but the patch is stored wire after wire in one vector, which is only
+  /// reallocated if it is too small, so it can be reused for many patches.
+  void getPatch(size_t wire,
+                float drift,
+                size_t patchSizeW,
+                size_t patchSizeD,
+                std::vector<float>& patch) const
+  {
+    patch.resize(patchSizeW * patchSizeD);
     bool ok = false;
-    std::vector<std::vector<float>> patch;
     if (fDownscaleFullView) {
-      ok = patchFromDownsampledView(wire, drift, patchSizeW, patchSizeD, patch);
+      ok = patchFromDownsampledView(wire, drift, patchSizeW, patchSizeD, patch.data());
     }
     else {
-      ok = patchFromOriginalView(wire, drift, patchSizeW, patchSizeD, patch);
+      ok = patchFromOriginalView(wire, drift, patchSizeW, patchSizeD, patch.data());
     }
 
-    if (ok) return patch;
-    throw cet::exception("img::DataProviderAlg") << "Patch filling failed." << std::endl;
+    if (!ok)
+      throw cet::exception("img::DataProviderAlg") << "Patch filling failed." << std::endl;
   }
 
+  /// View of the same pixels as getPatch (for even patch sizes), without copying. Available
+  /// only if the full view is downscaled and the patch does not extend beyond the event
+  /// projection.
+  std::optional<ImageView> patchView(size_t wire,
+                                     float drift,
+                                     size_t patchSizeW,
+                                     size_t patchSizeD) const;
+
   /// Return value from the ADC buffer, or zero if coordinates are out of the view;
   /// will scale the drift according to the downscale settings.
   float getPixelOrZero(int wire, int drift) const
   {
     size_t didx = getDriftIndex(drift), widx = (size_t)wire;
 
-    if ((widx < fAlgView.fWireDriftData.size()) && (didx < fAlgView.fNCachedDrifts)) {
-      return fAlgView.fWireDriftData[widx][didx];
+    if ((widx < fAlgView.fNWires) && (didx < fAlgView.fNCachedDrifts)) {
+      return fAlgView.wireData(widx)[didx];
     }
     return 0;
   }
@@ -186,23 +441,27 @@ protected:
   bool fDownscaleFullView;
   float fDriftWindowInv;
 
-  std::vector<float> downscaleMax(std::size_t dst_size,
-                                  std::vector<float> const& adc,
-                                  size_t tick0) const;
-  std::vector<float> downscaleMaxMean(std::size_t dst_size,
-                                      std::vector<float> const& adc,
-                                      size_t tick0) const;
-  std::vector<float> downscaleMean(std::size_t dst_size,
-                                   std::vector<float> const& adc,
-                                   size_t tick0) const;
-  std::vector<float> downscale(std::size_t dst_size,
-                               std::vector<float> const& adc,
-                               size_t tick0) const
+  // The downscale functions write dst_size values to dst. The ADC samples are corrected
+  // for the lifetime (tick0 is the tick of adc[0]) in one pass, then reduced in windows of
+  // fDriftWindow samples; both loops are written to be vectorized by the compiler.
+  void downscaleMax(float* dst,
+                    std::size_t dst_size,
+                    std::vector<float> const& adc,
+                    size_t tick0) const;
+  void downscaleMaxMean(float* dst,
+                        std::size_t dst_size,
+                        std::vector<float> const& adc,
+                        size_t tick0) const;
+  void downscaleMean(float* dst,
+                     std::size_t dst_size,
+                     std::vector<float> const& adc,
+                     size_t tick0) const;
+  void downscale(float* dst, std::size_t dst_size, std::vector<float> const& adc, size_t tick0) const
   {
     switch (fDownscaleMode) {
-    case img::DataProviderAlg::kMean: return downscaleMean(dst_size, adc, tick0);
-    case img::DataProviderAlg::kMaxMean: return downscaleMaxMean(dst_size, adc, tick0);
-    case img::DataProviderAlg::kMax: return downscaleMax(dst_size, adc, tick0);
+    case img::DataProviderAlg::kMean: return downscaleMean(dst, dst_size, adc, tick0);
+    case img::DataProviderAlg::kMaxMean: return downscaleMaxMean(dst, dst_size, adc, tick0);
+    case img::DataProviderAlg::kMax: return downscaleMax(dst, dst_size, adc, tick0);
     }
     throw cet::exception("img::DataProviderAlg") << "Downscale mode not supported." << std::endl;
   }
@@ -215,19 +474,20 @@ protected:
       return (size_t)drift;
   }
 
-  std::optional<std::vector<float>> setWireData(std::vector<float> const& adc,
-                                                size_t wireIdx) const;
+  /// Fill the row of the wire in the image, false if the wire or ADC's are not valid.
+  bool setWireData(std::vector<float> const& adc, size_t wireIdx);
 
+  // Fill size_w x size_d values, wire after wire, starting at patch
   bool patchFromDownsampledView(size_t wire,
                                 float drift,
                                 size_t size_w,
                                 size_t size_d,
-                                std::vector<std::vector<float>>& patch) const;
+                                float* patch) const;
   bool patchFromOriginalView(size_t wire,
                              float drift,
                              size_t size_w,
                              size_t size_d,
-                             std::vector<std::vector<float>>& patch) const;
+                             float* patch) const;
 
   virtual DataProviderAlgView resizeView(detinfo::DetectorClocksData const& clock_data,
                                          detinfo::DetectorPropertiesData const& det_prop,
@@ -242,7 +502,7 @@ protected:
 
 private:
   float scaleAdcSample(float val) const;
-  void scaleAdcSamples(std::vector<float>& values) const;
+  void scaleAdcSamples(float* values, std::size_t size) const;
   std::vector<float> fAmplCalibConst;
   bool fCalibrateAmpl, fCalibrateLifetime;
   unsigned int fCryo = 9999, fTPC = 9999, fPlane = 9999;
@@ -254,6 +514,7 @@ private:
 
   void applyBlur();
   std::vector<float> fBlurKernel; // blur not applied if empty
+  std::vector<float, AlignedAllocator<float>> fBlurBuffer; // copy of the image, kept between events
 
   void addWhiteNoise();
   float fNoiseSigma; // noise not added if sigma=0
@@ -212,7 +212,7 @@ double pma::Element3D::HitsRadius3D(unsigned int view) const
     return 0.0F;
   }
 
-  TVector3 mean3D(0, 0, 0);
+  pma::Vector3D mean3D(0, 0, 0);
   size_t nHits = 0;
   for (auto h : fAssignedHits)
     if (h->View2D() == view) {
@@ -18,9 +18,6 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "larreco/RecoAlg/PMAlg/Utilities.h"
 
-class TVector2;
-#include "TVector3.h"
-
 namespace pma {
   class Element3D;
   class Hit3D;
@@ -35,15 +32,16 @@ public:
   int Cryo(void) const { return fCryo; }
 
   /// Distance [cm] from the 3D point to the object 3D.
-  virtual double GetDistance2To(const TVector3& p3d) const = 0;
+  virtual double GetDistance2To(const pma::Vector3D& p3d) const = 0;
 
   /// Distance [cm] from the 2D point to the object's 2D projection in one of wire views.
-  virtual double GetDistance2To(const TVector2& p2d, unsigned int view) const = 0;
+  virtual double GetDistance2To(const pma::Vector2D& p2d, unsigned int view) const = 0;
 
   /// Get 3D direction cosines corresponding to this element.
   virtual pma::Vector3D GetDirection3D(void) const = 0;
 
-  virtual TVector3 GetUnconstrainedProj3D(const TVector2& p2d, unsigned int view) const = 0;
+  virtual pma::Vector3D GetUnconstrainedProj3D(const pma::Vector2D& p2d,
+                                               unsigned int view) const = 0;
 
   virtual void SetProjection(pma::Hit3D& h) const = 0;
 
@@ -75,9 +73,9 @@ public:
   size_t NEnabledHits(unsigned int view = geo::kUnknown) const;
   size_t NPrecalcEnabledHits(void) const { return fNThisHitsEnabledAll; }
 
-  TVector3 const& ReferencePoint(size_t index) const { return *(fAssignedPoints[index]); }
+  pma::Vector3D const& ReferencePoint(size_t index) const { return *(fAssignedPoints[index]); }
   size_t NPoints(void) const { return fAssignedPoints.size(); }
-  void AddPoint(TVector3* p) { fAssignedPoints.push_back(p); }
+  void AddPoint(pma::Vector3D* p) { fAssignedPoints.push_back(p); }
 
   /// Clear hits/points vectors of this element, optionally only
   /// those which are owned by given track.
@@ -118,7 +116,7 @@ protected:
 
   bool fFrozen;
   std::vector<pma::Hit3D*> fAssignedHits; // 2D hits
-  std::vector<TVector3*> fAssignedPoints; // 3D peculiar points reconstructed elsewhere
+  std::vector<pma::Vector3D*> fAssignedPoints; // 3D peculiar points reconstructed elsewhere
   size_t fNThisHits[3];
   size_t fNThisHitsEnabledAll;
   size_t fNHits[3];
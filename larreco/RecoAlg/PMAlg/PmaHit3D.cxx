@@ -53,7 +53,7 @@ pma::Hit3D::Hit3D(detinfo::DetectorPropertiesData const& detProp, art::Ptr<recob
   fAmpl = src->PeakAmplitude();
   fArea = src->SummedADC();
 
-  fPoint2D = pma::WireDriftToCm(detProp, fWire, fPeakTime, fPlane, fTPC, fCryo);
+  fPoint2D = pma::ToVector2D(pma::WireDriftToCm(detProp, fWire, fPeakTime, fPlane, fTPC, fCryo));
 }
 
 pma::Hit3D::Hit3D(detinfo::DetectorPropertiesData const& detProp,
@@ -83,7 +83,7 @@ pma::Hit3D::Hit3D(detinfo::DetectorPropertiesData const& detProp,
   fAmpl = ampl;
   fArea = area;
 
-  fPoint2D = pma::WireDriftToCm(detProp, fWire, fPeakTime, fPlane, fTPC, fCryo);
+  fPoint2D = pma::ToVector2D(pma::WireDriftToCm(detProp, fWire, fPeakTime, fPlane, fTPC, fCryo));
 }
 
 pma::Hit3D::Hit3D(const pma::Hit3D& src)
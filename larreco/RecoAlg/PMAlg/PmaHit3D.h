@@ -14,15 +14,13 @@
 
 #include "canvas/Persistency/Common/Ptr.h"
 #include "lardataobj/RecoBase/Hit.h"
+#include "larreco/RecoAlg/PMAlg/Utilities.h"
 namespace detinfo {
   class DetectorPropertiesData;
 }
 
 #include <cmath>
 
-#include "TVector2.h"
-#include "TVector3.h"
-
 namespace pma {
   class Hit3D;
   class Track3D;
@@ -47,13 +45,13 @@ public:
 
   art::Ptr<recob::Hit> const& Hit2DPtr() const { return fHit; }
 
-  TVector3 const& Point3D() const { return fPoint3D; }
+  pma::Vector3D const& Point3D() const { return fPoint3D; }
 
-  void SetPoint3D(const TVector3& p3d) { fPoint3D = p3d; }
+  void SetPoint3D(const pma::Vector3D& p3d) { fPoint3D = p3d; }
   void SetPoint3D(double x, double y, double z) { fPoint3D.SetXYZ(x, y, z); }
 
-  TVector2 const& Point2D() const noexcept { return fPoint2D; }
-  TVector2 const& Projection2D() const noexcept { return fProjection2D; }
+  pma::Vector2D const& Point2D() const noexcept { return fPoint2D; }
+  pma::Vector2D const& Projection2D() const noexcept { return fProjection2D; }
 
   unsigned int Cryo() const noexcept { return fCryo; }
   unsigned int TPC() const noexcept { return fTPC; }
@@ -72,14 +70,14 @@ public:
   double GetDist2ToProj() const;
 
   float GetSegFraction() const noexcept { return fSegFraction; }
-  void SetProjection(const TVector2& p, float b)
+  void SetProjection(const pma::Vector2D& p, float b)
   {
-    fProjection2D.Set(p);
+    fProjection2D = p;
     fSegFraction = b;
   }
   void SetProjection(double x, double y, float b)
   {
-    fProjection2D.Set(x, y);
+    fProjection2D.SetXY(x, y);
     fSegFraction = b;
   }
 
@@ -95,9 +93,9 @@ private:
   unsigned int fCryo, fTPC, fPlane, fWire;
   float fPeakTime, fAmpl, fArea;
 
-  TVector3 fPoint3D;      // hit position in 3D space
-  TVector2 fPoint2D;      // hit position in 2D wire view, scaled to [cm]
-  TVector2 fProjection2D; // projection to polygonal line in 2D wire view, scaled to [cm]
+  pma::Vector3D fPoint3D;      // hit position in 3D space
+  pma::Vector2D fPoint2D;      // hit position in 2D wire view, scaled to [cm]
+  pma::Vector2D fProjection2D; // projection to polygonal line in 2D wire view, scaled to [cm]
   float fSegFraction;     // segment fraction set by the projection
   float fSigmaFactor;     // impact factor on the objective function
 
@@ -39,14 +39,10 @@ pma::Node3D::Node3D()
 {
   fTPC = 0;
   fCryo = 0;
-
-  fProj2D[0].Set(0);
-  fProj2D[1].Set(0);
-  fProj2D[2].Set(0);
 }
 
 pma::Node3D::Node3D(detinfo::DetectorPropertiesData const& detProp,
-                    const TVector3& p3d,
+                    const pma::Vector3D& p3d,
                     unsigned int tpc,
                     unsigned int cryo,
                     bool vtx,
@@ -154,12 +150,12 @@ bool pma::Node3D::LimitPoint3D()
 void pma::Node3D::UpdateProj2D()
 {
   for (size_t i = 0; i < fTpcGeo.Nplanes(); ++i) {
-    fProj2D[i].Set(fTpcGeo.Plane(i).PlaneCoordinate(geo::vect::toPoint(fPoint3D)),
-                   fPoint3D.X() - fDriftOffset);
+    fProj2D[i].SetXY(fTpcGeo.Plane(i).PlaneCoordinate(geo::vect::toPoint(fPoint3D)),
+                     fPoint3D.X() - fDriftOffset);
   }
 }
 
-bool pma::Node3D::SetPoint3D(const TVector3& p3d)
+bool pma::Node3D::SetPoint3D(const pma::Vector3D& p3d)
 {
   fPoint3D = p3d;
 
@@ -169,12 +165,12 @@ bool pma::Node3D::SetPoint3D(const TVector3& p3d)
   return accepted;
 }
 
-double pma::Node3D::GetDistance2To(const TVector3& p3d) const
+double pma::Node3D::GetDistance2To(const pma::Vector3D& p3d) const
 {
   return pma::Dist2(fPoint3D, p3d);
 }
 
-double pma::Node3D::GetDistance2To(const TVector2& p2d, unsigned int view) const
+double pma::Node3D::GetDistance2To(const pma::Vector2D& p2d, unsigned int view) const
 {
   return pma::Dist2(fProj2D[view], p2d);
 }
@@ -213,8 +209,8 @@ pma::Vector3D pma::Node3D::GetDirection3D() const
 
 void pma::Node3D::SetProjection(pma::Hit3D& h) const
 {
-  TVector2 gstart;
-  TVector3 g3d;
+  pma::Vector2D gstart;
+  pma::Vector3D g3d;
   if (prev) {
     pma::Node3D* vtx = static_cast<pma::Node3D*>(prev->Prev());
     gstart = vtx->Projection2D(h.View2D());
@@ -231,34 +227,33 @@ void pma::Node3D::SetProjection(pma::Hit3D& h) const
   }
   else {
     mf::LogError("pma::Node3D") << "Isolated vertex.";
-    TVector2 p(Projection2D(h.View2D()));
-    h.SetProjection(p, 0.0F);
+    h.SetProjection(Projection2D(h.View2D()), 0.0F);
     h.SetPoint3D(fPoint3D);
     return;
   }
 
-  TVector2 v0(h.Point2D());
+  pma::Vector2D v0(h.Point2D());
   v0 -= Projection2D(h.View2D());
 
-  TVector2 v1(gstart);
+  pma::Vector2D v1(gstart);
   v1 -= Projection2D(h.View2D());
 
-  double v0Norm = v0.Mod();
-  double v1Norm = v1.Mod();
+  double v0Norm = sqrt(v0.Mag2());
+  double v1Norm = sqrt(v1.Mag2());
   double mag = v0Norm * v1Norm;
   double cosine = 0.0;
-  if (mag != 0.0) cosine = v0 * v1 / mag;
+  if (mag != 0.0) cosine = v0.Dot(v1) / mag;
 
-  TVector2 p(Projection2D(h.View2D()));
+  pma::Vector2D p(Projection2D(h.View2D()));
 
   if (prev && next) {
     pma::Node3D* vNext = static_cast<pma::Node3D*>(next->Next());
-    TVector2 vN(vNext->Projection2D(h.View2D()));
+    pma::Vector2D vN(vNext->Projection2D(h.View2D()));
     vN -= Projection2D(h.View2D());
 
-    mag = v0Norm * vN.Mod();
+    mag = v0Norm * sqrt(vN.Mag2());
     double cosineN = 0.0;
-    if (mag != 0.0) cosineN = v0 * vN / mag;
+    if (mag != 0.0) cosineN = v0.Dot(vN) / mag;
 
     // hit on the previous segment side, sorting on the -cosine(prev_seg, point)  /max.val. = 1/
     if (cosineN <= cosine) h.SetProjection(p, -(float)cosine);
@@ -558,7 +553,7 @@ double pma::Node3D::GetObjFunction(float penaltyValue, float endSegWeight) const
 double pma::Node3D::MakeGradient(float penaltyValue, float endSegWeight)
 {
   double l1 = 0.0, l2 = 0.0, minLength2 = 0.0;
-  TVector3 tmp(fPoint3D), gpoint(fPoint3D);
+  pma::Vector3D tmp(fPoint3D), gpoint(fPoint3D);
 
   pma::Segment3D* seg;
   if (prev) {
@@ -587,49 +582,49 @@ double pma::Node3D::MakeGradient(float penaltyValue, float endSegWeight)
 
   if (!fGradFixed[0]) // gradX
   {
-    gpoint[0] = tmp[0] + dxi;
+    gpoint.SetX(tmp.X() + dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
-    fGradient[0] = (g0 - gi) / dxi;
+    double const gradForward = (g0 - gi) / dxi;
 
-    gpoint[0] = tmp[0] - dxi;
+    gpoint.SetX(tmp.X() - dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
-    fGradient[0] = 0.5 * (fGradient[0] + (gi - g0) / dxi);
+    fGradient.SetX(0.5 * (gradForward + (gi - g0) / dxi));
 
-    gpoint[0] = tmp[0];
+    gpoint.SetX(tmp.X());
   }
 
   if (!fGradFixed[1]) // gradY
   {
-    gpoint[1] = tmp[1] + dxi;
+    gpoint.SetY(tmp.Y() + dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
-    fGradient[1] = (g0 - gi) / dxi;
+    double const gradForward = (g0 - gi) / dxi;
 
-    gpoint[1] = tmp[1] - dxi;
+    gpoint.SetY(tmp.Y() - dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
-    fGradient[1] = 0.5 * (fGradient[1] + (gi - g0) / dxi);
+    fGradient.SetY(0.5 * (gradForward + (gi - g0) / dxi));
 
-    gpoint[1] = tmp[1];
+    gpoint.SetY(tmp.Y());
   }
 
   if (!fGradFixed[2]) // gradZ
   {
-    gpoint[2] = tmp[2] + dxi;
+    gpoint.SetZ(tmp.Z() + dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
     //if (fQPenaltyFactor > 0.0F) gi += fQPenaltyFactor * QPenalty();
-    fGradient[2] = (gz - gi) / dxi;
+    double const gradForward = (gz - gi) / dxi;
 
-    gpoint[2] = tmp[2] - dxi;
+    gpoint.SetZ(tmp.Z() - dxi);
     SetPoint3D(gpoint);
     gi = GetObjFunction(penaltyValue, endSegWeight);
     //if (fQPenaltyFactor > 0.0F) gi += fQPenaltyFactor * QPenalty();
-    fGradient[2] = 0.5 * (fGradient[2] + (gi - gz) / dxi);
+    fGradient.SetZ(0.5 * (gradForward + (gi - gz) / dxi));
 
-    gpoint[2] = tmp[2];
+    gpoint.SetZ(tmp.Z());
   }
 
   SetPoint3D(tmp);
@@ -643,7 +638,7 @@ double pma::Node3D::StepWithGradient(float alfa, float tol, float penalty, float
   unsigned int steps = 0;
   double t, t1, t2, t3, g, g0, g1, g2, g3, p1, p2;
   double eps = 6.0E-37, zero_tol = 1.0E-15;
-  TVector3 tmp(fPoint3D), gpoint(fPoint3D);
+  pma::Vector3D tmp(fPoint3D), gpoint(fPoint3D);
 
   g = MakeGradient(penalty, weight);
   if (g < zero_tol) return 0.0;
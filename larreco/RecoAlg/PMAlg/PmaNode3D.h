@@ -18,9 +18,6 @@ namespace detinfo {
   class DetectorPropertiesData;
 }
 
-#include "TVector2.h"
-#include "TVector3.h"
-
 #include <vector>
 
 namespace geo {
@@ -35,19 +32,28 @@ class pma::Node3D final : public pma::Element3D, public pma::SortedBranchBase {
 public:
   Node3D();
   Node3D(detinfo::DetectorPropertiesData const& detProp,
-         const TVector3& p3d,
+         const pma::Vector3D& p3d,
          unsigned int tpc,
          unsigned int cryo,
          bool vtx = false,
          double xshift = 0);
+  Node3D(detinfo::DetectorPropertiesData const& detProp,
+         const TVector3& p3d,
+         unsigned int tpc,
+         unsigned int cryo,
+         bool vtx = false,
+         double xshift = 0)
+    : Node3D(detProp, pma::ToVector3D(p3d), tpc, cryo, vtx, xshift)
+  {}
 
-  TVector3 const& Point3D() const { return fPoint3D; }
+  pma::Vector3D const& Point3D() const { return fPoint3D; }
 
   /// Returns true if the new position was accepted; returns false if the new position
   /// was trimmed to fit insite TPC volume + fMargin.
-  bool SetPoint3D(const TVector3& p3d);
+  bool SetPoint3D(const pma::Vector3D& p3d);
+  bool SetPoint3D(const TVector3& p3d) { return SetPoint3D(pma::ToVector3D(p3d)); }
 
-  TVector2 const& Projection2D(unsigned int view) const { return fProj2D[view]; }
+  pma::Vector2D const& Projection2D(unsigned int view) const { return fProj2D[view]; }
 
   double GetDistToWall() const;
 
@@ -72,18 +78,19 @@ public:
   std::vector<pma::Track3D*> GetBranches() const;
 
   /// Distance [cm] from the 3D point to the point 3D.
-  double GetDistance2To(const TVector3& p3d) const override;
+  double GetDistance2To(const pma::Vector3D& p3d) const override;
 
   /// Distance [cm] from the 2D point to the object's 2D projection in one of
   /// wire views.
-  double GetDistance2To(const TVector2& p2d, unsigned int view) const override;
+  double GetDistance2To(const pma::Vector2D& p2d, unsigned int view) const override;
 
   /// Get 3D direction cosines of the next segment, or previous segment
   /// if this is the last node.
   pma::Vector3D GetDirection3D() const override;
 
   /// In case of a node it is simply 3D position of the node.
-  TVector3 GetUnconstrainedProj3D(const TVector2& p2d, unsigned int view) const override
+  pma::Vector3D GetUnconstrainedProj3D(const pma::Vector2D& p2d,
+                                       unsigned int view) const override
   {
     return fPoint3D;
   }
@@ -118,7 +125,7 @@ public:
 
   void ApplyDriftShift(double dx)
   {
-    fPoint3D[0] += dx;
+    fPoint3D.SetX(fPoint3D.X() + dx);
     fDriftOffset += dx;
   }
   double GetDriftShift() const { return fDriftOffset; }
@@ -152,12 +159,12 @@ private:
   double fMinX, fMaxX, fMinY, fMaxY, fMinZ,
     fMaxZ; // TPC boundaries to limit the node position (+margin)
 
-  TVector3 fPoint3D;   // node position in 3D space in [cm]
-  TVector2 fProj2D[3]; // node projections to 2D views, scaled to [cm], updated
-                       // on each change of 3D position
-  double fDriftOffset; // the offset due to t0
+  pma::Vector3D fPoint3D;   // node position in 3D space in [cm]
+  pma::Vector2D fProj2D[3]; // node projections to 2D views, scaled to [cm], updated
+                            // on each change of 3D position
+  double fDriftOffset;      // the offset due to t0
 
-  TVector3 fGradient;
+  pma::Vector3D fGradient;
   bool fIsVertex; // no penalty on segments angle if branching or kink detected
 
   static bool fGradFixed[3];
@@ -24,14 +24,14 @@ pma::Segment3D::Segment3D(pma::Track3D* trk, pma::Node3D* vstart, pma::Node3D* v
   if (vstart->Cryo() == vstop->Cryo()) fCryo = vstart->Cryo();
 }
 
-double pma::Segment3D::GetDistance2To(const TVector3& p3d) const
+double pma::Segment3D::GetDistance2To(const pma::Vector3D& p3d) const
 {
   pma::Node3D* v0 = static_cast<pma::Node3D*>(prev);
   pma::Node3D* v1 = static_cast<pma::Node3D*>(next);
   return GetDist2(p3d, v0->Point3D(), v1->Point3D());
 }
 
-double pma::Segment3D::GetDistance2To(const TVector2& p2d, unsigned int view) const
+double pma::Segment3D::GetDistance2To(const pma::Vector2D& p2d, unsigned int view) const
 {
   pma::Node3D* v0 = static_cast<pma::Node3D*>(prev);
   pma::Node3D* v1 = static_cast<pma::Node3D*>(next);
@@ -59,38 +59,35 @@ pma::Vector3D pma::Segment3D::GetDirection3D(void) const
 {
   pma::Node3D* v0 = static_cast<pma::Node3D*>(prev);
   pma::Node3D* v1 = static_cast<pma::Node3D*>(next);
-  pma::Vector3D dir(v1->Point3D().X() - v0->Point3D().X(),
-                    v1->Point3D().Y() - v0->Point3D().Y(),
-                    v1->Point3D().Z() - v0->Point3D().Z());
-  return dir.Unit();
+  return (v1->Point3D() - v0->Point3D()).Unit();
 }
 
-TVector3 pma::Segment3D::GetProjection(const TVector2& p, unsigned int view) const
+pma::Vector3D pma::Segment3D::GetProjection(const pma::Vector2D& p, unsigned int view) const
 {
   pma::Node3D* vStart = static_cast<pma::Node3D*>(prev);
   pma::Node3D* vStop = static_cast<pma::Node3D*>(next);
 
-  TVector2 v0(p);
+  pma::Vector2D v0(p);
   v0 -= vStart->Projection2D(view);
 
-  TVector2 v1(vStop->Projection2D(view));
+  pma::Vector2D v1(vStop->Projection2D(view));
   v1 -= vStart->Projection2D(view);
 
-  TVector3 v3d(vStop->Point3D());
+  pma::Vector3D v3d(vStop->Point3D());
   v3d -= vStart->Point3D();
 
-  TVector3 v3dStart(vStart->Point3D());
-  TVector3 v3dStop(vStop->Point3D());
+  auto const& v3dStart = vStart->Point3D();
+  auto const& v3dStop = vStop->Point3D();
 
-  double v0Norm = v0.Mod();
-  double v1Norm = v1.Mod();
+  double v0Norm = sqrt(v0.Mag2());
+  double v1Norm = sqrt(v1.Mag2());
 
-  TVector3 result(0, 0, 0);
+  pma::Vector3D result(0, 0, 0);
   if (v1Norm > 1.0E-6) // 0.01mm
   {
     double mag = v0Norm * v1Norm;
     double cosine = 0.0;
-    if (mag != 0.0) cosine = v0 * v1 / mag;
+    if (mag != 0.0) cosine = v0.Dot(v1) / mag;
     double b = v0Norm * cosine / v1Norm;
 
     if (b < 1.0) {
@@ -111,27 +108,28 @@ TVector3 pma::Segment3D::GetProjection(const TVector2& p, unsigned int view) con
   return result;
 }
 
-TVector3 pma::Segment3D::GetUnconstrainedProj3D(const TVector2& p2d, unsigned int view) const
+pma::Vector3D pma::Segment3D::GetUnconstrainedProj3D(const pma::Vector2D& p2d,
+                                                     unsigned int view) const
 {
   pma::Node3D* vStart = static_cast<pma::Node3D*>(prev);
   pma::Node3D* vStop = static_cast<pma::Node3D*>(next);
 
-  TVector2 v0(p2d);
+  pma::Vector2D v0(p2d);
   v0 -= vStart->Projection2D(view);
 
-  TVector2 v1(vStop->Projection2D(view));
+  pma::Vector2D v1(vStop->Projection2D(view));
   v1 -= vStart->Projection2D(view);
 
-  TVector3 v3d(vStop->Point3D());
+  pma::Vector3D v3d(vStop->Point3D());
   v3d -= vStart->Point3D();
 
-  double v0Norm = v0.Mod();
-  double v1Norm = v1.Mod();
+  double v0Norm = sqrt(v0.Mag2());
+  double v1Norm = sqrt(v1.Mag2());
   if (v1Norm > 1.0E-6) // 0.01mm
   {
     double mag = v0Norm * v1Norm;
     double cosine = 0.0;
-    if (mag != 0.0) cosine = v0 * v1 / mag;
+    if (mag != 0.0) cosine = v0.Dot(v1) / mag;
     double b = v0Norm * cosine / v1Norm;
 
     return vStart->Point3D() + (v3d * b);
@@ -157,12 +155,9 @@ void pma::Segment3D::SetProjection(pma::Hit3D& h) const
   auto const& projStart = vStart->Projection2D(h.View2D());
   auto const& projStop = vStop->Projection2D(h.View2D());
 
-  pma::Vector2D v0(h.Point2D().X() - projStart.X(), h.Point2D().Y() - projStart.Y());
-
-  pma::Vector2D v1(projStop.X() - projStart.X(), projStop.Y() - projStart.Y());
-
-  pma::Vector3D v3d(
-    pointStop.X() - pointStart.X(), pointStop.Y() - pointStart.Y(), pointStop.Z() - pointStart.Z());
+  pma::Vector2D v0(h.Point2D() - projStart);
+  pma::Vector2D v1(projStop - projStart);
+  pma::Vector3D v3d(pointStop - pointStart);
 
   double v0Norm = sqrt(v0.Mag2());
   double v1Norm = sqrt(v1.Mag2());
@@ -173,12 +168,8 @@ void pma::Segment3D::SetProjection(pma::Hit3D& h) const
     if (mag != 0.0) cosine = v0.Dot(v1) / mag;
     double b = v0Norm * cosine / v1Norm;
 
-    pma::Vector2D p(projStart.X(), projStart.Y());
-    p += (v1 * b);
-    v3d *= b;
-
-    h.SetProjection(p.X(), p.Y(), (float)b);
-    h.SetPoint3D(pointStart.X() + v3d.X(), pointStart.Y() + v3d.Y(), pointStart.Z() + v3d.Z());
+    h.SetProjection(projStart + v1 * b, (float)b);
+    h.SetPoint3D(pointStart + v3d * b);
   }
   else // segment 2D projection is almost a point
   {
@@ -201,11 +192,13 @@ double pma::Segment3D::Length2(void) const
   }
 }
 
-double pma::Segment3D::GetDist2(const TVector3& psrc, const TVector3& p0, const TVector3& p1)
+double pma::Segment3D::GetDist2(const pma::Vector3D& psrc,
+                                const pma::Vector3D& p0,
+                                const pma::Vector3D& p1)
 {
-  pma::Vector3D v0(psrc.X() - p0.X(), psrc.Y() - p0.Y(), psrc.Z() - p0.Z());
-  pma::Vector3D v1(p1.X() - p0.X(), p1.Y() - p0.Y(), p1.Z() - p0.Z());
-  pma::Vector3D v2(psrc.X() - p1.X(), psrc.Y() - p1.Y(), psrc.Z() - p1.Z());
+  pma::Vector3D const v0(psrc - p0);
+  pma::Vector3D const v1(p1 - p0);
+  pma::Vector3D const v2(psrc - p1);
 
   double v1Norm2 = v1.Mag2();
   if (v1Norm2 >= 1.0E-6) // >= 0.01mm
@@ -245,11 +238,13 @@ double pma::Segment3D::GetDist2(const TVector3& psrc, const TVector3& p0, const
   }
 }
 
-double pma::Segment3D::GetDist2(const TVector2& psrc, const TVector2& p0, const TVector2& p1)
+double pma::Segment3D::GetDist2(const pma::Vector2D& psrc,
+                                const pma::Vector2D& p0,
+                                const pma::Vector2D& p1)
 {
-  pma::Vector2D v0(psrc.X() - p0.X(), psrc.Y() - p0.Y());
-  pma::Vector2D v1(p1.X() - p0.X(), p1.Y() - p0.Y());
-  pma::Vector2D v2(psrc.X() - p1.X(), psrc.Y() - p1.Y());
+  pma::Vector2D const v0(psrc - p0);
+  pma::Vector2D const v1(p1 - p0);
+  pma::Vector2D const v2(psrc - p1);
 
   double v1Norm2 = v1.Mag2();
   if (v1Norm2 >= 1.0E-6) // >= 0.01mm
@@ -55,7 +55,7 @@ pma::Track3D::Track3D(const Track3D& src)
     fNodes.push_back(new pma::Node3D(*node));
 
   for (auto const* point : src.fAssignedPoints)
-    fAssignedPoints.push_back(new TVector3(*point));
+    fAssignedPoints.push_back(new pma::Vector3D(*point));
 
   RebuildSegments();
   MakeProjection();
@@ -128,7 +128,7 @@ bool pma::Track3D::InitFromHits(detinfo::DetectorPropertiesData const& detProp,
   fEndSegWeight = initEndSegW;
 
   // endpoints for the first combination:
-  TVector3 v3d_1(0., 0., 0.), v3d_2(0., 0., 0.);
+  pma::Vector3D v3d_1(0., 0., 0.), v3d_2(0., 0., 0.);
 
   assert(!fHits.empty());
 
@@ -225,7 +225,7 @@ bool pma::Track3D::InitFromRefPoints(detinfo::DetectorPropertiesData const& detP
 
   TVector3 mean(0., 0., 0.), stdev(0., 0., 0.), p(0., 0., 0.);
   for (size_t i = 0; i < fAssignedPoints.size(); i++) {
-    p = *(fAssignedPoints[i]);
+    p = pma::ToTVector3(*(fAssignedPoints[i]));
     mean += p;
     p.SetXYZ(p.X() * p.X(), p.Y() * p.Y(), p.Z() * p.Z());
     stdev += p;
@@ -258,7 +258,7 @@ bool pma::Track3D::InitFromRefPoints(detinfo::DetectorPropertiesData const& detP
   double norm2, max_norm2 = 0.0;
   std::vector<TVector3> data;
   for (size_t i = 0; i < fAssignedPoints.size(); i++) {
-    p = *(fAssignedPoints[i]);
+    p = pma::ToTVector3(*(fAssignedPoints[i]));
     p -= mean;
     p *= iscale;
     norm2 = p.Mag2();
@@ -288,7 +288,9 @@ bool pma::Track3D::InitFromRefPoints(detinfo::DetectorPropertiesData const& detP
   v1 += mean;
   v2 *= -scale;
   v2 += mean;
-  std::sort(fAssignedPoints.begin(), fAssignedPoints.end(), pma::bSegmentProjLess(v1, v2));
+  std::sort(fAssignedPoints.begin(),
+            fAssignedPoints.end(),
+            pma::bSegmentProjLess(pma::ToVector3D(v1), pma::ToVector3D(v2)));
   for (size_t i = 0; i < fAssignedPoints.size(); i++) {
     AddNode(detProp, *(fAssignedPoints[i]), tpc, cryo);
   }
@@ -314,10 +316,10 @@ void pma::Track3D::InitFromMiddle(detinfo::DetectorPropertiesData const& detProp
   double minY = tpcGeo.MinY(), maxY = tpcGeo.MaxY();
   double minZ = tpcGeo.MinZ(), maxZ = tpcGeo.MaxZ();
 
-  TVector3 v3d_1(0.5 * (minX + maxX), 0.5 * (minY + maxY), 0.5 * (minZ + maxZ));
-  TVector3 v3d_2(v3d_1);
+  pma::Vector3D v3d_1(0.5 * (minX + maxX), 0.5 * (minY + maxY), 0.5 * (minZ + maxZ));
+  pma::Vector3D v3d_2(v3d_1);
 
-  TVector3 shift(5.0, 5.0, 5.0);
+  pma::Vector3D shift(5.0, 5.0, 5.0);
   v3d_1 += shift;
   v3d_2 -= shift;
 
@@ -501,11 +503,11 @@ std::pair<TVector2, TVector2> pma::Track3D::WireDriftRange(
     if (n0 > 0) n0--;
     if (n1 == fNodes.size()) n1--;
 
-    TVector2 p0 = fNodes[n0]->Projection2D(view);
-    p0 = pma::CmToWireDrift(detProp, p0.X(), p0.Y(), view, tpc, cryo);
+    auto const& proj0 = fNodes[n0]->Projection2D(view);
+    TVector2 p0 = pma::CmToWireDrift(detProp, proj0.X(), proj0.Y(), view, tpc, cryo);
 
-    TVector2 p1 = fNodes[n1]->Projection2D(view);
-    p1 = pma::CmToWireDrift(detProp, p1.X(), p1.Y(), view, tpc, cryo);
+    auto const& proj1 = fNodes[n1]->Projection2D(view);
+    TVector2 p1 = pma::CmToWireDrift(detProp, proj1.X(), proj1.Y(), view, tpc, cryo);
 
     if (p0.X() > p1.X()) {
       double tmp = p0.X();
@@ -834,7 +836,8 @@ double pma::Track3D::TestHitsMse(const detinfo::DetectorPropertiesData& detProp,
     unsigned int wire = h->WireID().Wire;
     float drift = h->PeakTime();
 
-    mse += Dist2(pma::WireDriftToCm(detProp, wire, drift, view, tpc, cryo), view, tpc, cryo);
+    mse += Dist2(
+      pma::ToVector2D(pma::WireDriftToCm(detProp, wire, drift, view, tpc, cryo)), view, tpc, cryo);
   }
   if (normalized)
     return mse / hits.size();
@@ -851,7 +854,7 @@ unsigned int pma::Track3D::TestHits(detinfo::DetectorPropertiesData const& detPr
     return 0;
   }
 
-  TVector3 p3d;
+  pma::Vector3D p3d;
   double tst, d2 = dist * dist;
   unsigned int nhits = 0;
   for (auto const& h : hits)
@@ -1058,7 +1061,7 @@ double pma::Track3D::GetRawdEdxSequence(std::map<size_t, std::vector<double>>& d
   size_t jmax = PrevHit(size(), view, inclDisabled);
 
   std::vector<size_t> indexes;
-  TVector3 p0(0., 0., 0.), p1(0., 0., 0.);
+  pma::Vector3D p0(0., 0., 0.), p1(0., 0., 0.);
   TVector2 c0(0., 0.), c1(0., 0.);
   while (j <= jmax) {
     indexes.clear(); // prepare to collect hit indexes used for this dE/dx entry
@@ -1398,7 +1401,7 @@ bool pma::Track3D::AddNode(detinfo::DetectorPropertiesData const& detProp)
 }
 
 void pma::Track3D::InsertNode(detinfo::DetectorPropertiesData const& detProp,
-                              TVector3 const& p3d,
+                              pma::Vector3D const& p3d,
                               size_t at_idx,
                               unsigned int tpc,
                               unsigned int cryo)
@@ -1788,7 +1791,7 @@ bool pma::Track3D::IsAttachedTo(pma::Track3D const* trk) const
   return false;
 }
 
-bool pma::Track3D::HasRefPoint(TVector3* p) const
+bool pma::Track3D::HasRefPoint(pma::Vector3D* p) const
 {
   for (auto point : fAssignedPoints)
     if (point == p) return true;
@@ -2022,7 +2025,7 @@ double pma::Track3D::TuneSinglePass(bool skipFirst)
   return g + GetObjFunction();
 }
 
-pma::Track3D* pma::Track3D::GetNearestTrkInTree(const TVector3& p3d_cm,
+pma::Track3D* pma::Track3D::GetNearestTrkInTree(const pma::Vector3D& p3d_cm,
                                                 double& dist,
                                                 bool skipFirst)
 {
@@ -2060,7 +2063,7 @@ pma::Track3D* pma::Track3D::GetNearestTrkInTree(const TVector3& p3d_cm,
   return result;
 }
 
-pma::Track3D* pma::Track3D::GetNearestTrkInTree(const TVector2& p2d_cm,
+pma::Track3D* pma::Track3D::GetNearestTrkInTree(const pma::Vector2D& p2d_cm,
                                                 unsigned view,
                                                 unsigned int tpc,
                                                 unsigned int cryo,
@@ -2308,11 +2311,11 @@ void pma::Track3D::ApplyDriftShiftInTree(const detinfo::DetectorClocksData& cloc
   }
 
   for (auto h : fHits) {
-    h->fPoint3D[0] += dx;
+    h->fPoint3D.SetX(h->fPoint3D.X() + dx);
   }
 
   for (auto p : fAssignedPoints) {
-    (*p)[0] += dx;
+    p->SetX(p->X() + dx);
   }
 
   // For T0 we need to make sure we use the total shift, not just this current
@@ -2517,7 +2520,7 @@ bool pma::Track3D::ShiftEndsToHits()
   return true;
 }
 
-double pma::Track3D::Dist2(const TVector2& p2d,
+double pma::Track3D::Dist2(const pma::Vector2D& p2d,
                            unsigned int view,
                            unsigned int tpc,
                            unsigned int cryo) const
@@ -2544,14 +2547,14 @@ double pma::Track3D::Dist2(const TVector2& p2d,
   return min_dist;
 }
 
-double pma::Track3D::Dist2(const TVector3& p3d) const
+double pma::Track3D::Dist2(const pma::Vector3D& p3d) const
 {
   using namespace ranges;
   auto to_distance2 = [&p3d](auto seg) { return seg->GetDistance2To(p3d); };
   return min(fSegments | views::transform(to_distance2));
 }
 
-pma::Element3D* pma::Track3D::GetNearestElement(const TVector2& p2d,
+pma::Element3D* pma::Track3D::GetNearestElement(const pma::Vector2D& p2d,
                                                 unsigned int view,
                                                 int tpc,
                                                 bool skipFrontVtx,
@@ -2591,7 +2594,7 @@ pma::Element3D* pma::Track3D::GetNearestElement(const TVector2& p2d,
   return pe_min;
 }
 
-pma::Element3D* pma::Track3D::GetNearestElement(const TVector3& p3d) const
+pma::Element3D* pma::Track3D::GetNearestElement(const pma::Vector3D& p3d) const
 {
   pma::Element3D* pe_min = fNodes.front();
   double dist, min_dist = pe_min->GetDistance2To(p3d);
@@ -2614,15 +2617,15 @@ pma::Element3D* pma::Track3D::GetNearestElement(const TVector3& p3d) const
 
 bool pma::Track3D::GetUnconstrainedProj3D(detinfo::DetectorPropertiesData const& detProp,
                                           art::Ptr<recob::Hit> hit,
-                                          TVector3& p3d,
+                                          pma::Vector3D& p3d,
                                           double& dist2) const
 {
-  TVector2 p2d = pma::WireDriftToCm(detProp,
-                                    hit->WireID().Wire,
-                                    hit->PeakTime(),
-                                    hit->WireID().Plane,
-                                    hit->WireID().TPC,
-                                    hit->WireID().Cryostat);
+  pma::Vector2D const p2d = pma::ToVector2D(pma::WireDriftToCm(detProp,
+                                                               hit->WireID().Wire,
+                                                               hit->PeakTime(),
+                                                               hit->WireID().Plane,
+                                                               hit->WireID().TPC,
+                                                               hit->WireID().Cryostat));
 
   pma::Segment3D* seg = nullptr;
   double d2, min_d2 = 1.0e100;
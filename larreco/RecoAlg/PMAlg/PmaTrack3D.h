@@ -94,8 +94,16 @@ public:
   double Length(size_t step = 1) const { return Length(0, size() - 1, step); }
   double Length(size_t start, size_t stop, size_t step = 1) const;
 
-  double Dist2(const TVector2& p2d, unsigned int view, unsigned int tpc, unsigned int cryo) const;
-  double Dist2(const TVector3& p3d) const;
+  double Dist2(const pma::Vector2D& p2d,
+               unsigned int view,
+               unsigned int tpc,
+               unsigned int cryo) const;
+  double Dist2(const pma::Vector3D& p3d) const;
+  double Dist2(const TVector2& p2d, unsigned int view, unsigned int tpc, unsigned int cryo) const
+  {
+    return Dist2(pma::ToVector2D(p2d), view, tpc, cryo);
+  }
+  double Dist2(const TVector3& p3d) const { return Dist2(pma::ToVector3D(p3d)); }
 
   /// Get trajectory direction at given hit index.
   pma::Vector3D GetDirection3D(size_t index) const;
@@ -215,12 +223,12 @@ public:
                                               unsigned int view) const;
   size_t CompleteMissingWires(detinfo::DetectorPropertiesData const& detProp, unsigned int view);
 
-  void AddRefPoint(const TVector3& p) { fAssignedPoints.push_back(new TVector3(p)); }
+  void AddRefPoint(const TVector3& p) { AddRefPoint(p.X(), p.Y(), p.Z()); }
   void AddRefPoint(double x, double y, double z)
   {
-    fAssignedPoints.push_back(new TVector3(x, y, z));
+    fAssignedPoints.push_back(new pma::Vector3D(x, y, z));
   }
-  bool HasRefPoint(TVector3* p) const;
+  bool HasRefPoint(pma::Vector3D* p) const;
 
   /// MSE of hits weighted with hit amplidudes and wire plane coefficients.
   double GetMse(unsigned int view = geo::kUnknown) const;
@@ -277,20 +285,35 @@ public:
 
   void AddNode(pma::Node3D* node);
   void AddNode(detinfo::DetectorPropertiesData const& detProp,
-               TVector3 const& p3d,
+               pma::Vector3D const& p3d,
                unsigned int tpc,
                unsigned int cryo)
   {
     double ds = fNodes.empty() ? 0 : fNodes.back()->GetDriftShift();
     AddNode(new pma::Node3D(detProp, p3d, tpc, cryo, false, ds));
   }
+  void AddNode(detinfo::DetectorPropertiesData const& detProp,
+               TVector3 const& p3d,
+               unsigned int tpc,
+               unsigned int cryo)
+  {
+    AddNode(detProp, pma::ToVector3D(p3d), tpc, cryo);
+  }
   bool AddNode(detinfo::DetectorPropertiesData const& detProp);
 
   void InsertNode(detinfo::DetectorPropertiesData const& detProp,
-                  TVector3 const& p3d,
+                  pma::Vector3D const& p3d,
                   size_t at_idx,
                   unsigned int tpc,
                   unsigned int cryo);
+  void InsertNode(detinfo::DetectorPropertiesData const& detProp,
+                  TVector3 const& p3d,
+                  size_t at_idx,
+                  unsigned int tpc,
+                  unsigned int cryo)
+  {
+    InsertNode(detProp, pma::ToVector3D(p3d), at_idx, tpc, cryo);
+  }
   bool RemoveNode(size_t idx);
 
   pma::Track3D* Split(detinfo::DetectorPropertiesData const& detProp,
@@ -347,8 +370,10 @@ private:
   bool InitFromRefPoints(detinfo::DetectorPropertiesData const& detProp, int tpc, int cryo);
   void InitFromMiddle(detinfo::DetectorPropertiesData const& detProp, int tpc, int cryo);
 
-  pma::Track3D* GetNearestTrkInTree(const TVector3& p3d_cm, double& dist, bool skipFirst = false);
-  pma::Track3D* GetNearestTrkInTree(const TVector2& p2d_cm,
+  pma::Track3D* GetNearestTrkInTree(const pma::Vector3D& p3d_cm,
+                                    double& dist,
+                                    bool skipFirst = false);
+  pma::Track3D* GetNearestTrkInTree(const pma::Vector2D& p2d_cm,
                                     unsigned int view,
                                     unsigned int tpc,
                                     unsigned int cryo,
@@ -372,7 +397,7 @@ private:
   /// meaningful only if the function returns true.
   bool GetUnconstrainedProj3D(detinfo::DetectorPropertiesData const& detProp,
                               art::Ptr<recob::Hit> hit,
-                              TVector3& p3d,
+                              pma::Vector3D& p3d,
                               double& dist2) const;
 
   void DeleteSegments();
@@ -384,14 +409,14 @@ private:
 
   std::vector<pma::Hit3D*> fHits;
 
-  std::vector<TVector3*> fAssignedPoints;
+  std::vector<pma::Vector3D*> fAssignedPoints;
 
-  pma::Element3D* GetNearestElement(const TVector2& p2d,
+  pma::Element3D* GetNearestElement(const pma::Vector2D& p2d,
                                     unsigned int view,
                                     int tpc = -1,
                                     bool skipFrontVtx = false,
                                     bool skipBackVtx = false) const;
-  pma::Element3D* GetNearestElement(const TVector3& p3d) const;
+  pma::Element3D* GetNearestElement(const pma::Vector3D& p3d) const;
 
   std::vector<pma::Node3D*> fNodes;
   std::vector<pma::Segment3D*> fSegments;
@@ -192,10 +192,10 @@ void pma::TrkCandidateColl::flipTreesToCoordinate(detinfo::DetectorPropertiesDat
     int tid = t.TreeId();
     if (minVal.find(tid) == minVal.end()) minVal[tid] = 1.0e12;
 
-    TVector3 pFront(t.Track()->front()->Point3D());
+    TVector3 pFront(pma::ToTVector3(t.Track()->front()->Point3D()));
     pFront.SetX(-pFront.X());
     pFront.SetY(-pFront.Y());
-    TVector3 pBack(t.Track()->back()->Point3D());
+    TVector3 pBack(pma::ToTVector3(t.Track()->back()->Point3D()));
     pBack.SetX(-pBack.X());
     pBack.SetY(-pBack.Y());
 
@@ -218,10 +218,10 @@ void pma::TrkCandidateColl::flipTreesToCoordinate(detinfo::DetectorPropertiesDat
         pma::Track3D* trk = tEntry.second.back();
         tEntry.second.pop_back();
 
-        TVector3 pFront(trk->front()->Point3D());
+        TVector3 pFront(pma::ToTVector3(trk->front()->Point3D()));
         pFront.SetX(-pFront.X());
         pFront.SetY(-pFront.Y());
-        TVector3 pBack(trk->back()->Point3D());
+        TVector3 pBack(pma::ToTVector3(trk->back()->Point3D()));
         pBack.SetX(-pBack.X());
         pBack.SetY(-pBack.Y());
 
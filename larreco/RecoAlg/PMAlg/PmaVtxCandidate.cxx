@@ -253,7 +253,7 @@ double pma::VtxCandidate::MaxAngle(double minLength) const
       pma::Track3D* trk_i = fAssigned[i].first.Track();
       pma::Node3D* vtx_i0 = trk_i->Nodes()[fAssigned[i].second];
       pma::Node3D* vtx_i1 = trk_i->Nodes()[fAssigned[i].second + 1];
-      dir_i = vtx_i1->Point3D() - vtx_i0->Point3D();
+      dir_i = pma::ToTVector3(vtx_i1->Point3D() - vtx_i0->Point3D());
       dir_i *= 1.0 / dir_i.Mag();
     }
   }
@@ -264,7 +264,7 @@ double pma::VtxCandidate::MaxAngle(double minLength) const
       pma::Track3D* trk_j = fAssigned[j].first.Track();
       pma::Node3D* vtx_j0 = trk_j->Nodes()[fAssigned[j].second];
       pma::Node3D* vtx_j1 = trk_j->Nodes()[fAssigned[j].second + 1];
-      TVector3 dir_j = vtx_j1->Point3D() - vtx_j0->Point3D();
+      TVector3 dir_j = pma::ToTVector3(vtx_j1->Point3D() - vtx_j0->Point3D());
       dir_j *= 1.0 / dir_j.Mag();
       a = fabs(dir_i * dir_j);
       if (a < min) min = a;
@@ -342,7 +342,8 @@ double pma::VtxCandidate::Compute()
     if (segLength >= fSegMinLength) {
       pma::Node3D* vtx2 = static_cast<pma::Node3D*>(seg->Next(0));
 
-      std::pair<TVector3, TVector3> endpoints(vtx1->Point3D(), vtx2->Point3D());
+      std::pair<TVector3, TVector3> endpoints(pma::ToTVector3(vtx1->Point3D()),
+                                              pma::ToTVector3(vtx2->Point3D()));
       double dy = endpoints.first.Y() - endpoints.second.Y();
       double fy_norm = asin(fabs(dy) / segLength) / (0.5 * TMath::Pi());
       double w = 1.0 - pow(fy_norm - 1.0, 12);
@@ -371,7 +372,8 @@ double pma::VtxCandidate::Compute()
     pma::Node3D* vprev = static_cast<pma::Node3D*>(segments[s]->Prev());
     pma::Node3D* vnext = static_cast<pma::Node3D*>(segments[s]->Next(0));
 
-    pproj = pma::GetProjectionToSegment(result, vprev->Point3D(), vnext->Point3D());
+    pproj = pma::GetProjectionToSegment(
+      result, pma::ToTVector3(vprev->Point3D()), pma::ToTVector3(vnext->Point3D()));
 
     //dx = weights[s] * (result.X() - pproj.X());
     //dy = result.Y() - pproj.Y();
@@ -461,8 +463,8 @@ bool pma::VtxCandidate::JoinTracks(detinfo::DetectorPropertiesData const& detPro
         mf::LogError("pma::VtxCandidate") << "Root of the tree not found in tracks collection.";
     }
 
-    TVector3 p0(trk->Nodes()[idx]->Point3D());
-    TVector3 p1(trk->Nodes()[idx + 1]->Point3D());
+    TVector3 p0(pma::ToTVector3(trk->Nodes()[idx]->Point3D()));
+    TVector3 p1(pma::ToTVector3(trk->Nodes()[idx + 1]->Point3D()));
 
     int tpc0 = trk->Nodes()[idx]->TPC();
     int tpc1 = trk->Nodes()[idx + 1]->TPC();
@@ -658,7 +660,7 @@ bool pma::VtxCandidate::JoinTracks(detinfo::DetectorPropertiesData const& detPro
     bool tuneOK = true;
     if (noLoops && (nOK > 1)) {
       fAssigned.clear();
-      fCenter = vtxCenter->Point3D();
+      fCenter = pma::ToTVector3(vtxCenter->Point3D());
       fMse = 0.0;
       fMse2D = 0.0;
 
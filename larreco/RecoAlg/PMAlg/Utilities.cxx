@@ -82,7 +82,7 @@ double pma::GetHitsRadius3D(const std::vector<pma::Hit3D*>& hits, bool exact)
   using namespace ranges;
   auto to_3d_point = [](auto hit) -> decltype(auto) { return hit->Point3D(); };
   auto const mean_point =
-    accumulate(hits | views::transform(to_3d_point), TVector3{}) * (1. / hits.size());
+    accumulate(hits | views::transform(to_3d_point), pma::Vector3D{}) * (1. / hits.size());
 
   auto to_dist2_from_mean = [&mean_point](auto hit) {
     return pma::Dist2(hit->Point3D(), mean_point);
@@ -100,7 +100,7 @@ double pma::GetHitsRadius2D(const std::vector<pma::Hit3D*>& hits, bool exact)
   using namespace ranges;
   auto to_2d_point = [](auto hit) -> decltype(auto) { return hit->Point2D(); };
   auto const mean_point =
-    accumulate(hits | views::transform(to_2d_point), TVector2{}) * (1. / hits.size());
+    accumulate(hits | views::transform(to_2d_point), pma::Vector2D{}) * (1. / hits.size());
 
   auto to_dist2_from_mean = [&mean_point](auto hit) {
     return pma::Dist2(hit->Point2D(), mean_point);
@@ -331,7 +331,7 @@ bool pma::bTrack3DLonger::operator()(const pma::TrkCandidate& t1, const pma::Trk
   return false;
 }
 
-pma::bSegmentProjLess::bSegmentProjLess(const TVector3& s0, const TVector3& s1)
+pma::bSegmentProjLess::bSegmentProjLess(const pma::Vector3D& s0, const pma::Vector3D& s1)
   : segStart(s0), segStop(s1)
 {
   if (s0 == s1) mf::LogError("pma::bSegmentProjLess") << "Vectors equal!";
@@ -44,6 +44,12 @@ namespace pma {
   struct bTrajectory3DDistLess;
   struct bTrack3DLonger;
 
+  /// Conversions for the interfaces which still take or return ROOT vectors.
+  inline Vector2D ToVector2D(const TVector2& v) { return Vector2D(v.X(), v.Y()); }
+  inline Vector3D ToVector3D(const TVector3& v) { return Vector3D(v.X(), v.Y(), v.Z()); }
+  inline TVector2 ToTVector2(const Vector2D& v) { return TVector2(v.X(), v.Y()); }
+  inline TVector3 ToTVector3(const Vector3D& v) { return TVector3(v.X(), v.Y(), v.Z()); }
+
   double Dist2(const TVector2& v1, const TVector2& v2);
   double Dist2(const Vector2D& v1, const Vector2D& v2);
 
@@ -108,11 +114,12 @@ struct pma::bTrack3DLonger
   bool operator()(const pma::TrkCandidate& t1, const pma::TrkCandidate& t2);
 };
 
-class pma::bSegmentProjLess : public std::binary_function<TVector3*, TVector3*, bool> {
+class pma::bSegmentProjLess
+  : public std::binary_function<pma::Vector3D*, pma::Vector3D*, bool> {
 public:
-  bSegmentProjLess(const TVector3& s0, const TVector3& s1);
+  bSegmentProjLess(const pma::Vector3D& s0, const pma::Vector3D& s1);
 
-  bool operator()(TVector3* p1, TVector3* p2)
+  bool operator()(pma::Vector3D* p1, pma::Vector3D* p2)
   {
     if (p1 && p2) {
       double b1 = pma::GetSegmentProjVector(*p1, segStart, segStop);
@@ -124,7 +131,7 @@ public:
   }
 
 private:
-  TVector3 segStart, segStop;
+  pma::Vector3D segStart, segStop;
 };
 
 class pma::bDistCenterLess2D : public std::binary_function<TVector2, TVector2, bool> {
@@ -60,7 +60,7 @@ size_t pma::PMAlgCosmicTagger::outOfDriftWindow(pma::TrkCandidateColl& tracks) c
       auto const& tpcGeo = geom->TPC(geo::TPCID(node.Cryo(), node.TPC()));
       // DetectDriftDirection returns a short int, but switch requires an int
       int driftDir = abs(tpcGeo.DetectDriftDirection());
-      p = node.Point3D()[driftDir - 1];
+      p = pma::ToTVector3(node.Point3D())[driftDir - 1];
       switch (driftDir) {
       case 1:
         min = tpcGeo.MinX();
@@ -143,10 +143,10 @@ size_t pma::PMAlgCosmicTagger::tagTopFrontBack(pma::TrkCandidateColl& tracks) co
     auto const& node1 = *(t.Track()->Nodes()[t.Track()->Nodes().size() - 1]);
 
     // Check which end is the vertex (assume the largest height)
-    TVector3 vtx =
-      (node0.Point3D()[hIdx] > node1.Point3D()[hIdx]) ? node0.Point3D() : node1.Point3D();
-    TVector3 end =
-      (node0.Point3D()[hIdx] <= node1.Point3D()[hIdx]) ? node0.Point3D() : node1.Point3D();
+    TVector3 const p0 = pma::ToTVector3(node0.Point3D());
+    TVector3 const p1 = pma::ToTVector3(node1.Point3D());
+    TVector3 vtx = (p0[hIdx] > p1[hIdx]) ? p0 : p1;
+    TVector3 end = (p0[hIdx] <= p1[hIdx]) ? p0 : p1;
 
     // Check we have a track starting at the top of the detector
     bool top = isTopVertex(vtx, fTopFrontBackMargin, hIdx);
@@ -188,10 +188,10 @@ size_t pma::PMAlgCosmicTagger::tagApparentStopper(pma::TrkCandidateColl& tracks)
     auto const& node1 = *(t.Track()->Nodes()[t.Track()->Nodes().size() - 1]);
 
     // Check which end is the vertex (assume the largest height)
-    TVector3 vtx =
-      (node0.Point3D()[hIdx] > node1.Point3D()[hIdx]) ? node0.Point3D() : node1.Point3D();
-    TVector3 end =
-      (node0.Point3D()[hIdx] <= node1.Point3D()[hIdx]) ? node0.Point3D() : node1.Point3D();
+    TVector3 const p0 = pma::ToTVector3(node0.Point3D());
+    TVector3 const p1 = pma::ToTVector3(node1.Point3D());
+    TVector3 vtx = (p0[hIdx] > p1[hIdx]) ? p0 : p1;
+    TVector3 end = (p0[hIdx] <= p1[hIdx]) ? p0 : p1;
 
     if (fabs(vtx[hIdx] - fDimensionsMax[hIdx]) < fApparentStopperMargin) {
       // Check the other element to see if it ends away from the bottom of the detector
@@ -204,8 +204,9 @@ size_t pma::PMAlgCosmicTagger::tagApparentStopper(pma::TrkCandidateColl& tracks)
           if ((&tt) == (&t)) continue;
 
           // Compare this track with our main track
-          TVector3 trkVtx = (tt.Track()->Nodes()[0])->Point3D();
-          TVector3 trkEnd = (tt.Track()->Nodes()[tt.Track()->Nodes().size() - 1])->Point3D();
+          TVector3 trkVtx = pma::ToTVector3((tt.Track()->Nodes()[0])->Point3D());
+          TVector3 trkEnd =
+            pma::ToTVector3((tt.Track()->Nodes()[tt.Track()->Nodes().size() - 1])->Point3D());
 
           if ((end - trkVtx).Mag() < fStopperBuffer || (end - trkEnd).Mag() < fStopperBuffer) {
             foundTrack = true;
@@ -366,7 +367,8 @@ size_t pma::PMAlgCosmicTagger::fullCrossingTagger(pma::TrkCandidateColl& tracks,
     auto const& node1 = *(t.Track()->Nodes()[t.Track()->Nodes().size() - 1]);
 
     // Get the length of the track in the requested direction
-    double trkDim = fabs(node0.Point3D()[direction] - node1.Point3D()[direction]);
+    double trkDim = fabs(pma::ToTVector3(node0.Point3D())[direction] -
+                         pma::ToTVector3(node1.Point3D())[direction]);
 
     if ((detDim - trkDim) < fFullCrossingMargin) {
       ++n;
@@ -73,11 +73,14 @@ void pma::PMAlgStitching::StitchTracks(const detinfo::DetectorClocksData& clockD
     pma::Track3D* bestTrkMatch = 0x0;
 
     // Don't use the very end points of the tracks in case of scatter or distortion.
-    TVector3 trk1Front = t1->Nodes()[(fNodesFromEnd)]->Point3D();
-    TVector3 trk1Back = t1->Nodes()[t1->Nodes().size() - 1 - fNodesFromEnd]->Point3D();
-    TVector3 trk1FrontDir = (trk1Front - t1->Nodes()[(fNodesFromEnd + 1)]->Point3D()).Unit();
-    TVector3 trk1BackDir =
-      (trk1Back - t1->Nodes()[t1->Nodes().size() - 1 - (fNodesFromEnd + 1)]->Point3D()).Unit();
+    auto const& nodes1 = t1->Nodes();
+    TVector3 trk1Front = pma::ToTVector3(nodes1[fNodesFromEnd]->Point3D());
+    TVector3 trk1Back = pma::ToTVector3(nodes1[nodes1.size() - 1 - fNodesFromEnd]->Point3D());
+    TVector3 trk1FrontDir = pma::ToTVector3(
+      (nodes1[fNodesFromEnd]->Point3D() - nodes1[fNodesFromEnd + 1]->Point3D()).Unit());
+    TVector3 trk1BackDir = pma::ToTVector3((nodes1[nodes1.size() - 1 - fNodesFromEnd]->Point3D() -
+                                            nodes1[nodes1.size() - 2 - fNodesFromEnd]->Point3D())
+                                             .Unit());
 
     // For stitching, we need to consider both ends of the track.
     double offsetFront1 = GetTPCOffset(t1->FrontTPC(), t1->FrontCryo(), isCPA);
@@ -97,11 +100,14 @@ void pma::PMAlgStitching::StitchTracks(const detinfo::DetectorClocksData& clockD
       if (t2->Nodes().size() < minTrkLength) continue;
 
       // Don't use the very end points of the tracks in case of scatter or distortion.
-      TVector3 trk2Front = t2->Nodes()[(fNodesFromEnd)]->Point3D();
-      TVector3 trk2Back = t2->Nodes()[t2->Nodes().size() - 1 - fNodesFromEnd]->Point3D();
-      TVector3 trk2FrontDir = (trk2Front - t2->Nodes()[(fNodesFromEnd + 1)]->Point3D()).Unit();
-      TVector3 trk2BackDir =
-        (trk2Back - t2->Nodes()[t2->Nodes().size() - 1 - (fNodesFromEnd + 1)]->Point3D()).Unit();
+      auto const& nodes2 = t2->Nodes();
+      TVector3 trk2Front = pma::ToTVector3(nodes2[fNodesFromEnd]->Point3D());
+      TVector3 trk2Back = pma::ToTVector3(nodes2[nodes2.size() - 1 - fNodesFromEnd]->Point3D());
+      TVector3 trk2FrontDir = pma::ToTVector3(
+        (nodes2[fNodesFromEnd]->Point3D() - nodes2[fNodesFromEnd + 1]->Point3D()).Unit());
+      TVector3 trk2BackDir = pma::ToTVector3((nodes2[nodes2.size() - 1 - fNodesFromEnd]->Point3D() -
+                                              nodes2[nodes2.size() - 2 - fNodesFromEnd]->Point3D())
+                                               .Unit());
 
       // For stitching, we need to consider both ends of the track.
       double offsetFront2 = GetTPCOffset(t2->FrontTPC(), t2->FrontCryo(), isCPA);
@@ -701,15 +701,15 @@ bool pma::PMAlgTracker::areCoLinear(pma::Track3D* trk1,
 
     size_t nodeEndIdx = trk1->Nodes().size() - 1;
 
-    TVector3 endpoint1 = trk1->back()->Point3D();
-    TVector3 trk2front0 = trk2->Nodes()[0]->Point3D();
-    TVector3 trk2front1 = trk2->Nodes()[1]->Point3D();
+    TVector3 endpoint1 = pma::ToTVector3(trk1->back()->Point3D());
+    TVector3 trk2front0 = pma::ToTVector3(trk2->Nodes()[0]->Point3D());
+    TVector3 trk2front1 = pma::ToTVector3(trk2->Nodes()[1]->Point3D());
     TVector3 proj1 = pma::GetProjectionToSegment(endpoint1, trk2front0, trk2front1);
     double distProj1 = sqrt(pma::Dist2(endpoint1, proj1));
 
-    TVector3 endpoint2 = trk2->front()->Point3D();
-    TVector3 trk1back0 = trk1->Nodes()[nodeEndIdx]->Point3D();
-    TVector3 trk1back1 = trk1->Nodes()[nodeEndIdx - 1]->Point3D();
+    TVector3 endpoint2 = pma::ToTVector3(trk2->front()->Point3D());
+    TVector3 trk1back0 = pma::ToTVector3(trk1->Nodes()[nodeEndIdx]->Point3D());
+    TVector3 trk1back1 = pma::ToTVector3(trk1->Nodes()[nodeEndIdx - 1]->Point3D());
     TVector3 proj2 = pma::GetProjectionToSegment(endpoint2, trk1back1, trk1back0);
     double distProj2 = sqrt(pma::Dist2(endpoint2, proj2));
 
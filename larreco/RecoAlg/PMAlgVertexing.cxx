@@ -609,8 +609,8 @@ pma::PMAlgVertexing::getVertices(const pma::TrkCandidateColl& tracks, bool onlyB
     if (!(onlyBranching || firstNode->IsBranching())) {
       std::vector<std::pair<size_t, bool>> tidx;
       tidx.emplace_back(std::pair<size_t, bool>(t, true));
-      vsel.emplace_back(
-        std::pair<TVector3, std::vector<std::pair<size_t, bool>>>(trk->front()->Point3D(), tidx));
+      vsel.emplace_back(std::pair<TVector3, std::vector<std::pair<size_t, bool>>>(
+        pma::ToTVector3(trk->front()->Point3D()), tidx));
     }
 
     bool pri = true;
@@ -626,8 +626,8 @@ pma::PMAlgVertexing::getVertices(const pma::TrkCandidateColl& tracks, bool onlyB
         if (!found) {
           std::vector<std::pair<size_t, bool>> tidx;
           tidx.emplace_back(std::pair<size_t, bool>(t, pri));
-          vsel.emplace_back(
-            std::pair<TVector3, std::vector<std::pair<size_t, bool>>>(node->Point3D(), tidx));
+          vsel.emplace_back(std::pair<TVector3, std::vector<std::pair<size_t, bool>>>(
+            pma::ToTVector3(node->Point3D()), tidx));
           bnodes.push_back(node);
         }
         pri = false;
@@ -647,7 +647,7 @@ std::vector<std::pair<TVector3, size_t>> pma::PMAlgVertexing::getKinks(
     for (size_t n = 1; n < trk->Nodes().size() - 1; ++n) {
       pma::Node3D const* node = trk->Nodes()[n];
       if (!node->IsBranching() && node->IsVertex()) {
-        ksel.emplace_back(std::pair<TVector3, size_t>(node->Point3D(), t));
+        ksel.emplace_back(std::pair<TVector3, size_t>(pma::ToTVector3(node->Point3D()), t));
       }
     }
   }
@@ -929,7 +929,7 @@ pma::Track3D* pma::ProjectionMatchingAlg::buildSegment(
     double dback = pma::Dist2(trk->back()->Point3D(), point);
     if (dfront > dback) trk->Flip();
 
-    trk->Nodes().front()->SetPoint3D({point.X(), point.Y(), point.Z()});
+    trk->Nodes().front()->SetPoint3D(pma::Vector3D(point.X(), point.Y(), point.Z()));
     trk->Nodes().front()->SetFrozen(true);
     trk->Optimize(detProp, 0, fFineTuningEps);
 
@@ -5,13 +5,13 @@
 
 namespace tca {
 
-  TCEvent evt;
-  TCConfig tcc;
-  std::vector<TjForecast> tjfs;
-  ShowerTreeVars stv;
+  thread_local TCEvent evt;
+  thread_local TCConfig tcc;
+  thread_local std::vector<TjForecast> tjfs;
+  thread_local ShowerTreeVars stv;
   // vector of hits, tjs, etc in each slice
-  std::vector<TCSlice> slices;
-  std::vector<TrajPoint> seeds;
+  thread_local std::vector<TCSlice> slices;
+  thread_local std::vector<TrajPoint> seeds;
 
   const std::vector<std::string> AlgBitNames{"FillGaps3D",
                                              "Kink3D",
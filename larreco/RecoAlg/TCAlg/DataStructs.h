@@ -12,6 +12,7 @@
 // C/C++ standard libraries
 #include <array>
 #include <bitset>
+#include <mutex>
 #include <vector>
 
 // LArSoft libraries
@@ -570,6 +571,8 @@ namespace tca {
     calo::CalorimetryAlg* caloAlg;
     TMVA::Reader* showerParentReader;
     std::vector<float> showerParentVars;
+    float* showerParentReaderVars{nullptr}; ///< variables the reader was booked with
+    std::mutex* showerParentMutex{nullptr}; ///< the reader is shared by concurrent slices
     float hitErrFac;
     float maxWireSkipNoSignal;   ///< max number of wires to skip w/o a signal on them
     float maxWireSkipWithSignal; ///< max number of wires to skip with a signal on them
@@ -676,15 +679,17 @@ namespace tca {
     bool isValid{false};                 // set false if this slice failed reconstruction
   };
 
-  extern TCEvent evt;
-  extern TCConfig tcc;
-  extern ShowerTreeVars stv;
-  extern std::vector<TjForecast> tjfs;
+  // The state shared by all of the TCAlg functions. Each thread has its own copy, which
+  // holds the state of the TCContext bound to it by a TCContextScope (see TCContext.h)
+  extern thread_local TCEvent evt;
+  extern thread_local TCConfig tcc;
+  extern thread_local ShowerTreeVars stv;
+  extern thread_local std::vector<TjForecast> tjfs;
 
   // vector of hits, tjs, etc in each slice
-  extern std::vector<TCSlice> slices;
+  extern thread_local std::vector<TCSlice> slices;
   // vector of seed TPs
-  extern std::vector<TrajPoint> seeds;
+  extern thread_local std::vector<TrajPoint> seeds;
 
 } // namespace tca
 
@@ -1,5 +1,5 @@
 #include "larreco/RecoAlg/TCAlg/DebugStruct.h"
 
 namespace tca {
-  DebugStuff debug;
+  thread_local DebugStuff debug;
 } // namespace tca
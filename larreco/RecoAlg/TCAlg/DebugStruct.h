@@ -30,7 +30,7 @@ namespace tca {
     unsigned short MVI_Iter{USHRT_MAX}; ///< MVI iteration - see FindPFParticles
     int Slice{-1};
   };
-  extern DebugStuff debug;
+  extern thread_local DebugStuff debug;
 } // namespace tca
 
 #endif // ifndef TRAJCLUSTERALGDEBUGSTRUCT_H
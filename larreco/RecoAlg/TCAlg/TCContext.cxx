@@ -0,0 +1,47 @@
+#include "larreco/RecoAlg/TCAlg/TCContext.h"
+
+#include <utility>
+
+namespace tca {
+
+  namespace {
+    thread_local TCContext* boundContext = nullptr;
+  }
+
+  ////////////////////////////////////////////////
+  TCContextScope::TCContextScope(TCContext& context)
+  {
+    if (boundContext == &context) return;
+    fContext = &context;
+    fPrevious = boundContext;
+    SwapState();
+    boundContext = fContext;
+  } // TCContextScope
+
+  ////////////////////////////////////////////////
+  TCContextScope::~TCContextScope()
+  {
+    if (!fContext) return;
+    SwapState();
+    boundContext = fPrevious;
+  } // ~TCContextScope
+
+  ////////////////////////////////////////////////
+  bool TCContextScope::IsBound(TCContext const& context) { return boundContext == &context; }
+
+  ////////////////////////////////////////////////
+  void TCContextScope::SwapState()
+  {
+    // If another context is bound its state is parked in fContext until this
+    // scope closes and swaps it back
+    using std::swap;
+    swap(evt, fContext->evt);
+    swap(tcc, fContext->tcc);
+    swap(stv, fContext->stv);
+    swap(tjfs, fContext->tjfs);
+    swap(slices, fContext->slices);
+    swap(seeds, fContext->seeds);
+    swap(debug, fContext->debug);
+  } // SwapState
+
+} // namespace tca
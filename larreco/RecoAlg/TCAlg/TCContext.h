@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////
+//
+//
+// TCAlg context
+//
+// The TCAlg functions share their state through the thread local evt, tcc,
+// stv, tjfs, slices, seeds and debug variables. A TCContext holds one copy
+// of that state. It is owned by whoever runs the reconstruction (usually
+// TrajClusterAlg) and is bound to the calling thread with a TCContextScope,
+// so that several algorithm instances, or several slices of one event, can
+// be reconstructed at the same time on different threads.
+//
+///////////////////////////////////////////////////////////////////////
+#ifndef TRAJCLUSTERALGCONTEXT_H
+#define TRAJCLUSTERALGCONTEXT_H
+
+// C/C++ standard libraries
+#include <vector>
+
+// LArSoft libraries
+#include "larreco/RecoAlg/TCAlg/DataStructs.h"
+#include "larreco/RecoAlg/TCAlg/DebugStruct.h"
+
+namespace tca {
+
+  struct TCContext {
+    TCEvent evt;
+    TCConfig tcc;
+    ShowerTreeVars stv;
+    std::vector<TjForecast> tjfs;
+    std::vector<TCSlice> slices;
+    std::vector<TrajPoint> seeds;
+    DebugStuff debug;
+  };
+
+  /// Makes the state of a TCContext the thread local TCAlg state for the lifetime of
+  /// the scope. The state is swapped in and out, so references into evt, slices, etc
+  /// are only valid while the scope is open. Opening a scope on the context that is
+  /// already bound to this thread does nothing, so scopes may be nested freely. A context
+  /// must not be bound on two threads at once
+  class TCContextScope {
+  public:
+    explicit TCContextScope(TCContext& context);
+    ~TCContextScope();
+
+    TCContextScope(const TCContextScope&) = delete;
+    TCContextScope& operator=(const TCContextScope&) = delete;
+
+    /// True if a scope on the context is open on this thread
+    static bool IsBound(TCContext const& context);
+
+  private:
+    void SwapState();
+
+    TCContext* fContext{nullptr};  ///< nullptr if the context was already bound
+    TCContext* fPrevious{nullptr}; ///< the context bound before this scope was opened
+  };
+
+} // namespace tca
+
+#endif // ifndef TRAJCLUSTERALGCONTEXT_H
@@ -20,6 +20,7 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,15 +45,18 @@ namespace tca {
       return;
     }
     tcc.showerParentVars.resize(9);
-    tcc.showerParentReader->AddVariable("fShEnergy", &tcc.showerParentVars[0]);
-    tcc.showerParentReader->AddVariable("fPfpEnergy", &tcc.showerParentVars[1]);
-    tcc.showerParentReader->AddVariable("fMCSMom", &tcc.showerParentVars[2]);
-    tcc.showerParentReader->AddVariable("fPfpLen", &tcc.showerParentVars[3]);
-    tcc.showerParentReader->AddVariable("fSep", &tcc.showerParentVars[4]);
-    tcc.showerParentReader->AddVariable("fDang1", &tcc.showerParentVars[5]);
-    tcc.showerParentReader->AddVariable("fDang2", &tcc.showerParentVars[6]);
-    tcc.showerParentReader->AddVariable("fChgFrac", &tcc.showerParentVars[7]);
-    tcc.showerParentReader->AddVariable("fInShwrProb", &tcc.showerParentVars[8]);
+    // the reader keeps these addresses. Slices reconstructed on other threads fill their own
+    // copy of showerParentVars, which is copied here before the reader is used
+    tcc.showerParentReaderVars = tcc.showerParentVars.data();
+    tcc.showerParentReader->AddVariable("fShEnergy", &tcc.showerParentReaderVars[0]);
+    tcc.showerParentReader->AddVariable("fPfpEnergy", &tcc.showerParentReaderVars[1]);
+    tcc.showerParentReader->AddVariable("fMCSMom", &tcc.showerParentReaderVars[2]);
+    tcc.showerParentReader->AddVariable("fPfpLen", &tcc.showerParentReaderVars[3]);
+    tcc.showerParentReader->AddVariable("fSep", &tcc.showerParentReaderVars[4]);
+    tcc.showerParentReader->AddVariable("fDang1", &tcc.showerParentReaderVars[5]);
+    tcc.showerParentReader->AddVariable("fDang2", &tcc.showerParentReaderVars[6]);
+    tcc.showerParentReader->AddVariable("fChgFrac", &tcc.showerParentReaderVars[7]);
+    tcc.showerParentReader->AddVariable("fInShwrProb", &tcc.showerParentReaderVars[8]);
     tcc.showerParentReader->BookMVA("BDT", fullFileSpec);
   } // ConfigureTMVA
 
@@ -1730,7 +1734,13 @@ namespace tca {
       tcc.showerParentVars[6] = acos(costh2);
       tcc.showerParentVars[7] = chgFrac;
       tcc.showerParentVars[8] = prob;
-      float candParFOM = tcc.showerParentReader->EvaluateMVA("BDT");
+      float candParFOM = 0;
+      {
+        std::lock_guard<std::mutex> lock(*tcc.showerParentMutex);
+        for (unsigned short ii = 0; ii < tcc.showerParentVars.size(); ++ii)
+          tcc.showerParentReaderVars[ii] = tcc.showerParentVars[ii];
+        candParFOM = tcc.showerParentReader->EvaluateMVA("BDT");
+      }
 
       if (prt) {
         mf::LogVerbatim myprt("TC");
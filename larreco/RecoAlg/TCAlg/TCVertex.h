@@ -21,10 +21,10 @@ namespace detinfo {
 
 namespace tca {
 
-  extern TCEvent evt;
-  extern TCConfig tcc;
+  extern thread_local TCEvent evt;
+  extern thread_local TCConfig tcc;
   // vector of hits, tjs, etc in each slice
-  extern std::vector<TCSlice> slices;
+  extern thread_local std::vector<TCSlice> slices;
 
   void MakeJunkVertices(TCSlice& slc, const CTP_t& inCTP);
   void Find2DVertices(detinfo::DetectorPropertiesData const& detProp,
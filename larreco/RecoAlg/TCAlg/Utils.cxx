@@ -5023,10 +5023,10 @@ namespace tca {
     // Mode = 2: Accumulate and store to calculate chiDOF
     // Mode = -1: Fit and put results in outVec and chiDOF
 
-    static double sum, sumx, sumy, sumx2, sumy2, sumxy;
-    static unsigned short cnt;
-    static std::vector<Point2_t> fitPts;
-    static std::vector<double> fitWghts;
+    thread_local double sum, sumx, sumy, sumx2, sumy2, sumxy;
+    thread_local unsigned short cnt;
+    thread_local std::vector<Point2_t> fitPts;
+    thread_local std::vector<double> fitWghts;
 
     if (mode == 0) {
       // initialize
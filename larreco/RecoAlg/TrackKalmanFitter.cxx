@@ -33,6 +33,9 @@
 #include "larreco/RecoAlg/TrackCreationBookKeeper.h"
 #include "larreco/TrackFinder/TrackMaker.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 bool trkf::TrackKalmanFitter::fitTrack(detinfo::DetectorPropertiesData const& detProp,
                                        const recob::TrackTrajectory& traj,
                                        const int tkID,
@@ -133,6 +136,55 @@ bool trkf::TrackKalmanFitter::fitTrack(detinfo::DetectorPropertiesData const& de
   }
 }
 
+void trkf::TrackKalmanFitter::fitTracks(detinfo::DetectorPropertiesData const& detProp,
+                                        const std::vector<TrackSeed>& seeds,
+                                        bool initTrackFitInfos,
+                                        std::vector<char>& fitok,
+                                        std::vector<recob::Track>& outTracks,
+                                        std::vector<std::vector<art::Ptr<recob::Hit>>>& outHits,
+                                        std::vector<trkmkr::OptionalOutputs>& optionals) const
+{
+  const size_t nseeds = seeds.size();
+  fitok.assign(nseeds, 0);
+  outTracks.assign(nseeds, recob::Track());
+  outHits.assign(nseeds, std::vector<art::Ptr<recob::Hit>>());
+  optionals.clear();
+  optionals.resize(nseeds);
+
+  // art::Ptr are resolved on first access, do it here before the tasks share them
+  for (auto const& seed : seeds) {
+    for (auto const& hit : seed.hits)
+      hit.get();
+  }
+
+  auto fitRange = [&](const tbb::blocked_range<size_t>& range) {
+    TrackStatePropagator prop(*propagator);
+    TrackKalmanFitter fitter(*this);
+    fitter.propagator = &prop;
+    for (size_t i = range.begin(); i != range.end(); ++i) {
+      auto const& seed = seeds[i];
+      if (initTrackFitInfos) optionals[i].initTrackFitInfos();
+      fitok[i] = fitter.fitTrack(detProp,
+                                 *seed.traj,
+                                 seed.tkID,
+                                 seed.covVtx,
+                                 seed.covEnd,
+                                 seed.hits,
+                                 seed.pval,
+                                 seed.pdgid,
+                                 seed.flipDirection,
+                                 outTracks[i],
+                                 outHits[i],
+                                 optionals[i]);
+    }
+  };
+
+  if (dumpLevel_ > 0)
+    fitRange(tbb::blocked_range<size_t>(0, nseeds));
+  else
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nseeds), fitRange);
+}
+
 bool trkf::TrackKalmanFitter::fitTrack(detinfo::DetectorPropertiesData const& detProp,
                                        const Point_t& position,
                                        const Vector_t& direction,
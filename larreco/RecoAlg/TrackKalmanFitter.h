@@ -244,6 +244,34 @@ namespace trkf {
                   std::vector<art::Ptr<recob::Hit>>& outHits,
                   trkmkr::OptionalOutputs& optionals) const;
 
+    /// Input of fitTracks: the arguments of the TrackTrajectory version of fitTrack for one track
+    struct TrackSeed {
+      const recob::TrackTrajectory* traj;
+      int tkID;
+      SMatrixSym55 covVtx;
+      SMatrixSym55 covEnd;
+      std::vector<art::Ptr<recob::Hit>> hits;
+      double pval;
+      int pdgid;
+      bool flipDirection;
+    };
+
+    /**
+     * @brief Fit a batch of tracks concurrently, starting from their TrackTrajectory
+     *
+     * The outputs are resized to the number of seeds and filled in seed order: fitok[i] tells
+     * whether seed i was fitted successfully, the other outputs of a failed fit must be ignored.
+     * Each task fits its tracks with its own copy of the fitter and of the propagator. With
+     * dumpLevel > 0 the tracks are fitted one after the other so that the printouts stay readable.
+     */
+    void fitTracks(detinfo::DetectorPropertiesData const& detProp,
+                   const std::vector<TrackSeed>& seeds,
+                   bool initTrackFitInfos,
+                   std::vector<char>& fitok,
+                   std::vector<recob::Track>& outTracks,
+                   std::vector<std::vector<art::Ptr<recob::Hit>>>& outHits,
+                   std::vector<trkmkr::OptionalOutputs>& optionals) const;
+
     /// Function where the core of the fit is performed
     bool doFitWork(KFTrackState& trackState,
                    detinfo::DetectorPropertiesData const& detProp,
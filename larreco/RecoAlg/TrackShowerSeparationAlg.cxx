@@ -11,6 +11,7 @@
 
 #include "larreco/RecoAlg/TrackShowerSeparationAlg.h"
 #include "fhiclcpp/ParameterSet.h"
+#include "larreco/RecoAlg/TrackShowerSeparationGrid.h"
 
 #include "TMathBase.h"
 #include "TVector2.h"
@@ -86,6 +87,32 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
   // std::vector<int> showerLikeTracks, trackLikeTracks;
   // std::vector<int> showerTracks = InitialTrackLikeSegment(reconTracks);
 
+  // Index the space points and the track ends, so that the cylinder and cone
+  // tests below are only made on the points the grids cannot rule out
+  auto toPoint = [](const TVector3& v) { return PointGrid::Point{{v.X(), v.Y(), v.Z()}}; };
+  std::vector<PointGrid::Point> spacePointPositions;
+  spacePointPositions.reserve(spacePoints.size());
+  for (const art::Ptr<recob::SpacePoint>& spacePoint : spacePoints)
+    spacePointPositions.push_back(toPoint(SpacePointPos(spacePoint)));
+  const PointGrid spacePointGrid(spacePointPositions, fCylinderRadius);
+
+  // Two entries per track, vertex and end; flipping a track keeps them valid
+  std::vector<int> trackEndIDs;
+  std::vector<PointGrid::Point> trackEnds;
+  for (const auto& reconTrack : reconTracks) {
+    trackEndIDs.insert(trackEndIDs.end(), 2, reconTrack.first);
+    trackEnds.push_back(toPoint(reconTrack.second->Vertex()));
+    trackEnds.push_back(toPoint(reconTrack.second->End()));
+  }
+  const PointGrid trackEndGrid(trackEnds, fTrackVertexCut);
+  auto tracksOf = [&trackEndIDs](const std::vector<std::size_t>& ends) {
+    std::vector<int> ids;
+    for (std::size_t end : ends)
+      ids.push_back(trackEndIDs[end]);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end()); // ends come sorted
+    return ids;
+  };
+
   // Consider the space point cylinder situation
   double avCylinderSpacePoints = 0;
   for (std::map<int, std::unique_ptr<ReconTrack>>::iterator trackIt = reconTracks.begin();
@@ -108,11 +135,11 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
     //   std::cout << "Track " << trackIt->first << " ends at the supposed vertex" << std::endl;
     // std::cout << "Track " << trackIt->first << " has vertex (" << trackIt->second->Vertex().X() << ", " << trackIt->second->Vertex().Y() << ", " << trackIt->second->Vertex().Z() << ") and end (" << trackIt->second->End().X() << ", " << trackIt->second->End().Y() << ", " << trackIt->second->End().Z() << "), with vertex direction (" << trackIt->second->VertexDirection().X() << ", " << trackIt->second->VertexDirection().Y() << ", " << trackIt->second->VertexDirection().Z() << ")" << std::endl;
     // Count space points in the volume around the track
-    for (std::vector<art::Ptr<recob::SpacePoint>>::const_iterator spacePointIt =
-           spacePoints.begin();
-         spacePointIt != spacePoints.end();
-         ++spacePointIt) {
-      const std::vector<art::Ptr<recob::Track>> spTracks = fmtsp.at(spacePointIt->key());
+    for (std::size_t sp :
+         spacePointGrid.NearLine(toPoint(point), toPoint(direction), fCylinderRadius)) {
+      const std::vector<art::Ptr<recob::SpacePoint>>::const_iterator spacePointIt =
+        spacePoints.begin() + sp;
+      const std::vector<art::Ptr<recob::Track>>& spTracks = fmtsp.at(spacePointIt->key());
       if (find_if(spTracks.begin(), spTracks.end(), [&trackIt](const art::Ptr<recob::Track>& t) {
             return (int)t.key() == trackIt->first;
           }) != spTracks.end())
@@ -168,10 +195,14 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
        trackIt != reconTracks.end();
        ++trackIt) {
     if (trackIt->second->IsTrack()) continue;
-    for (std::map<int, std::unique_ptr<ReconTrack>>::const_iterator otherTrackIt =
-           reconTracks.begin();
-         otherTrackIt != reconTracks.end();
-         ++otherTrackIt) {
+    std::vector<std::size_t> closeEnds =
+      trackEndGrid.NearPoint(toPoint(trackIt->second->Vertex()), fTrackVertexCut);
+    const std::vector<std::size_t> closeToEnd =
+      trackEndGrid.NearPoint(toPoint(trackIt->second->End()), fTrackVertexCut);
+    closeEnds.insert(closeEnds.end(), closeToEnd.begin(), closeToEnd.end());
+    std::sort(closeEnds.begin(), closeEnds.end());
+    for (int otherTrackID : tracksOf(closeEnds)) {
+      const auto otherTrackIt = reconTracks.find(otherTrackID);
       if (trackIt->first == otherTrackIt->first or !otherTrackIt->second->IsTrack()) continue;
       if ((trackIt->second->Vertex() - otherTrackIt->second->Vertex()).Mag() < fTrackVertexCut or
           (trackIt->second->Vertex() - otherTrackIt->second->End()).Mag() < fTrackVertexCut or
@@ -187,17 +218,17 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
   // Consider removing false tracks by looking at their closest approach to any other track
 
   // Consider the space point cone situation
-  std::vector<art::Ptr<recob::SpacePoint>> showerSpacePoints;
+  std::vector<bool> isShowerSpacePoint(spacePoints.size(), false);
   for (std::vector<art::Ptr<recob::SpacePoint>>::const_iterator spacePointIt = spacePoints.begin();
        spacePointIt != spacePoints.end();
        ++spacePointIt) {
     bool showerSpacePoint = true;
-    const std::vector<art::Ptr<recob::Track>> spacePointTracks = fmtsp.at(spacePointIt->key());
+    const std::vector<art::Ptr<recob::Track>>& spacePointTracks = fmtsp.at(spacePointIt->key());
     for (std::vector<art::Ptr<recob::Track>>::const_iterator trackIt = spacePointTracks.begin();
          trackIt != spacePointTracks.end();
          ++trackIt)
       if (reconTracks[trackIt->key()]->IsTrack()) showerSpacePoint = false;
-    if (showerSpacePoint) showerSpacePoints.push_back(*spacePointIt);
+    isShowerSpacePoint[spacePointIt - spacePoints.begin()] = showerSpacePoint;
   }
 
   // Identify tracks which slipped through and shower tracks
@@ -206,12 +237,15 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
   for (std::map<int, std::unique_ptr<ReconTrack>>::iterator trackIt = reconTracks.begin();
        trackIt != reconTracks.end();
        ++trackIt) {
-    for (std::vector<art::Ptr<recob::SpacePoint>>::const_iterator spacePointIt =
-           showerSpacePoints.begin();
-         spacePointIt != showerSpacePoints.end();
-         ++spacePointIt) {
+    for (std::size_t sp : spacePointGrid.NearCone(toPoint(trackIt->second->Vertex()),
+                                                  toPoint(trackIt->second->Direction()),
+                                                  fConeAngle * TMath::Pi() / 180,
+                                                  true)) {
+      if (!isShowerSpacePoint[sp]) continue;
+      const std::vector<art::Ptr<recob::SpacePoint>>::const_iterator spacePointIt =
+        spacePoints.begin() + sp;
       bool associatedSpacePoint = false;
-      const std::vector<art::Ptr<recob::Track>> spTracks = fmtsp.at(spacePointIt->key());
+      const std::vector<art::Ptr<recob::Track>>& spTracks = fmtsp.at(spacePointIt->key());
       for (std::vector<art::Ptr<recob::Track>>::const_iterator spTrackIt = spTracks.begin();
            spTrackIt != spTracks.end();
            ++spTrackIt)
@@ -265,9 +299,11 @@ std::vector<art::Ptr<recob::Hit>> shower::TrackShowerSeparationAlg::SelectShower
        ++trackIt) {
     if (trackIt->second->IsShower()) {
       if (fDebug > 1) std::cout << "    Track " << trackIt->first << std::endl;
-      for (std::map<int, std::unique_ptr<ReconTrack>>::iterator otherTrackIt = reconTracks.begin();
-           otherTrackIt != reconTracks.end();
-           ++otherTrackIt) {
+      for (int otherTrackID : tracksOf(trackEndGrid.NearCone(toPoint(trackIt->second->Vertex()),
+                                                             toPoint(trackIt->second->Direction()),
+                                                             fConeAngle * TMath::Pi() / 180,
+                                                             false))) {
+        const auto otherTrackIt = reconTracks.find(otherTrackID);
         if (trackIt->first == otherTrackIt->first or !otherTrackIt->second->IsUndetermined())
           continue;
         if ((otherTrackIt->second->Vertex() - trackIt->second->Vertex())
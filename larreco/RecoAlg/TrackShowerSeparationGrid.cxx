@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////
+// Class: PointGrid
+// File:  TrackShowerSeparationGrid.cxx
+//
+// Uniform grid over the space points (or track end points) of an event,
+// see TrackShowerSeparationGrid.h
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/RecoAlg/TrackShowerSeparationGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+  // The callers test with TVector3 arithmetic, so a candidate selection has to allow for
+  // the rounding of that arithmetic (and of its own) at the edge of the volume queried
+  constexpr double kDistanceTolerance = 1e-6; // cm
+  constexpr double kAngleTolerance = 1e-6;    // radians
+
+  bool IsFinite(const shower::PointGrid::Point& p)
+  {
+    return std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]);
+  }
+
+  double Dot(const shower::PointGrid::Point& a, const shower::PointGrid::Point& b)
+  {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+}
+
+shower::PointGrid::PointGrid(const std::vector<Point>& points, double cellSize)
+  : fNumPoints(points.size())
+{
+  Point max{{0., 0., 0.}};
+  std::size_t nFinite = 0;
+  for (const Point& p : points) {
+    if (!IsFinite(p)) continue;
+    for (int k = 0; k < 3; ++k) {
+      if (nFinite == 0 || p[k] < fMin[k]) fMin[k] = p[k];
+      if (nFinite == 0 || p[k] > max[k]) max[k] = p[k];
+    }
+    ++nFinite;
+  }
+  if (nFinite == 0) return;
+
+  // Keep the number of cells of the order of the number of points
+  double const maxExtent = std::max({max[0] - fMin[0], max[1] - fMin[1], max[2] - fMin[2]});
+  fCellSize = (std::isfinite(cellSize) && cellSize > 0.) ? cellSize : maxExtent / 16.;
+  if (!(fCellSize > 0.)) fCellSize = 1.;
+  double const maxCells = std::max(4096., 4. * nFinite);
+  while (true) {
+    double nCells = 1.;
+    for (int k = 0; k < 3; ++k)
+      nCells *= std::floor((max[k] - fMin[k]) / fCellSize) + 1.;
+    if (nCells <= maxCells) break;
+    fCellSize *= 1.25;
+  }
+  for (int k = 0; k < 3; ++k)
+    fNCells[k] = int((max[k] - fMin[k]) / fCellSize) + 1;
+  fCellRadius = 0.5 * std::sqrt(3.) * fCellSize * (1. + 1e-9) + kDistanceTolerance;
+
+  // Points sorted by cell, in increasing index order within each cell
+  auto cellOf = [this](const Point& p) {
+    int i[3];
+    for (int k = 0; k < 3; ++k)
+      i[k] = std::min(int((p[k] - fMin[k]) / fCellSize), fNCells[k] - 1);
+    return CellIndex(i[0], i[1], i[2]);
+  };
+  fCellStart.assign(std::size_t(fNCells[0]) * fNCells[1] * fNCells[2] + 1, 0);
+  for (const Point& p : points)
+    if (IsFinite(p)) ++fCellStart[cellOf(p) + 1];
+  for (std::size_t c = 1; c < fCellStart.size(); ++c)
+    fCellStart[c] += fCellStart[c - 1];
+  fCellPoints.resize(nFinite);
+  std::vector<std::size_t> next(fCellStart.begin(), fCellStart.end() - 1);
+  for (std::size_t i = 0; i < points.size(); ++i)
+    if (IsFinite(points[i])) fCellPoints[next[cellOf(points[i])]++] = i;
+
+  for (int iz = 0; iz < fNCells[2]; ++iz)
+    for (int iy = 0; iy < fNCells[1]; ++iy)
+      for (int ix = 0; ix < fNCells[0]; ++ix) {
+        std::size_t const c = CellIndex(ix, iy, iz);
+        if (fCellStart[c] == fCellStart[c + 1]) continue;
+        fOccupiedCells.push_back(c);
+        fOccupiedCentres.push_back({{fMin[0] + (ix + 0.5) * fCellSize,
+                                     fMin[1] + (iy + 0.5) * fCellSize,
+                                     fMin[2] + (iz + 0.5) * fCellSize}});
+      }
+}
+
+template <typename CellTest>
+std::vector<std::size_t> shower::PointGrid::Select(CellTest cellTest) const
+{
+  std::vector<std::size_t> selected;
+  for (std::size_t i = 0; i < fOccupiedCells.size(); ++i) {
+    if (!cellTest(fOccupiedCentres[i])) continue;
+    std::size_t const c = fOccupiedCells[i];
+    selected.insert(selected.end(),
+                    fCellPoints.begin() + fCellStart[c],
+                    fCellPoints.begin() + fCellStart[c + 1]);
+  }
+  std::sort(selected.begin(), selected.end());
+  return selected;
+}
+
+template <typename CellTest>
+std::vector<std::size_t> shower::PointGrid::Walk(const Point& origin,
+                                                 const Point& unit,
+                                                 double pad,
+                                                 double slope,
+                                                 double tMin,
+                                                 CellTest cellTest) const
+{
+  // Walk along the axis k the line is closest to. In the layer of cells with centres at
+  // x_k = c, a centre at distance d <= rho(t) from the point of the line at t has
+  // |c - x_k(t)| <= d * s, with s = sqrt(1 - u_k^2); rho being Lipschitz with constant
+  // slope, t is then within delta of the crossing t0 of the layer by the line.
+  int const k = int(std::max_element(unit.begin(), unit.end(), [](double a, double b) {
+                      return std::abs(a) < std::abs(b);
+                    }) -
+                    unit.begin());
+  double const uk = unit[k];
+  double const s = std::sqrt(std::max(0., 1. - uk * uk));
+  double const denom = std::abs(uk) - slope * s;
+  if (!(denom > 0.)) return Select(cellTest); // the volume widens faster than the walk
+
+  struct Layer {
+    int i, lo[3], hi[3];
+  };
+  std::vector<Layer> layers;
+  std::size_t nCells = 0;
+  for (int i = 0; i < fNCells[k]; ++i) {
+    double const t0 = (fMin[k] + (i + 0.5) * fCellSize - origin[k]) / uk;
+    double const delta = ((pad + slope * std::abs(t0)) * s + kDistanceTolerance) / denom;
+    double const tLast = t0 + delta;
+    if (!(tLast >= tMin)) continue;
+    double const tFirst = std::max(t0 - delta, tMin);
+    double const rho =
+      pad + slope * std::max(std::abs(tFirst), std::abs(tLast)) + kDistanceTolerance;
+
+    Layer layer{i, {}, {}};
+    std::size_t n = 1;
+    for (int j = 0; j < 3; ++j) {
+      if (j == k) continue;
+      double const a = origin[j] + tFirst * unit[j];
+      double const b = origin[j] + tLast * unit[j];
+      // centres at fMin + (index + 0.5) * fCellSize
+      double const first = std::ceil((std::min(a, b) - rho - fMin[j]) / fCellSize - 0.5);
+      double const last = std::floor((std::max(a, b) + rho - fMin[j]) / fCellSize - 0.5);
+      if (last < 0. || first > fNCells[j] - 1 || first > last) {
+        n = 0;
+        break;
+      }
+      layer.lo[j] = first < 0. ? 0 : int(first);
+      layer.hi[j] = last > fNCells[j] - 1 ? fNCells[j] - 1 : int(last);
+      n *= layer.hi[j] - layer.lo[j] + 1;
+    }
+    if (n == 0) continue;
+    layer.lo[k] = layer.hi[k] = i;
+    layers.push_back(layer);
+    nCells += n;
+  }
+  if (nCells > fOccupiedCells.size()) return Select(cellTest);
+
+  std::vector<std::size_t> selected;
+  for (const Layer& layer : layers)
+    for (int iz = layer.lo[2]; iz <= layer.hi[2]; ++iz)
+      for (int iy = layer.lo[1]; iy <= layer.hi[1]; ++iy)
+        for (int ix = layer.lo[0]; ix <= layer.hi[0]; ++ix) {
+          std::size_t const c = CellIndex(ix, iy, iz);
+          if (fCellStart[c] == fCellStart[c + 1]) continue;
+          Point const centre{{fMin[0] + (ix + 0.5) * fCellSize,
+                              fMin[1] + (iy + 0.5) * fCellSize,
+                              fMin[2] + (iz + 0.5) * fCellSize}};
+          if (!cellTest(centre)) continue;
+          selected.insert(selected.end(),
+                          fCellPoints.begin() + fCellStart[c],
+                          fCellPoints.begin() + fCellStart[c + 1]);
+        }
+  std::sort(selected.begin(), selected.end());
+  return selected;
+}
+
+std::vector<std::size_t> shower::PointGrid::All() const
+{
+  std::vector<std::size_t> all(fCellPoints);
+  std::sort(all.begin(), all.end());
+  return all;
+}
+
+std::vector<std::size_t> shower::PointGrid::NearPoint(const Point& centre, double radius) const
+{
+  if (!IsFinite(centre) || !std::isfinite(radius)) return All();
+  if (fCellPoints.empty() || radius < 0.) return {};
+
+  // Only the cells overlapping the bounding box of the sphere
+  double const reach = radius + kDistanceTolerance;
+  int lo[3], hi[3];
+  for (int k = 0; k < 3; ++k) {
+    double const first = std::floor((centre[k] - reach - fMin[k]) / fCellSize);
+    double const last = std::floor((centre[k] + reach - fMin[k]) / fCellSize);
+    if (last < 0. || first > fNCells[k] - 1) return {};
+    lo[k] = first < 0. ? 0 : int(first);
+    hi[k] = last > fNCells[k] - 1 ? fNCells[k] - 1 : int(last);
+  }
+
+  std::vector<std::size_t> selected;
+  for (int iz = lo[2]; iz <= hi[2]; ++iz)
+    for (int iy = lo[1]; iy <= hi[1]; ++iy)
+      for (int ix = lo[0]; ix <= hi[0]; ++ix) {
+        std::size_t const c = CellIndex(ix, iy, iz);
+        selected.insert(selected.end(),
+                        fCellPoints.begin() + fCellStart[c],
+                        fCellPoints.begin() + fCellStart[c + 1]);
+      }
+  std::sort(selected.begin(), selected.end());
+  return selected;
+}
+
+std::vector<std::size_t> shower::PointGrid::NearLine(const Point& origin,
+                                                     const Point& direction,
+                                                     double radius) const
+{
+  if (!IsFinite(origin) || !IsFinite(direction) || !std::isfinite(radius)) return All();
+  double const norm = std::sqrt(Dot(direction, direction));
+  if (!(norm > 0.)) return NearPoint(origin, radius);
+  Point const u{{direction[0] / norm, direction[1] / norm, direction[2] / norm}};
+
+  double const reach = radius + fCellRadius;
+  double const noLimit = -std::numeric_limits<double>::infinity();
+  return Walk(origin, u, reach, 0., noLimit, [&](const Point& centre) {
+    Point const w{{centre[0] - origin[0], centre[1] - origin[1], centre[2] - origin[2]}};
+    double const t = Dot(w, u);
+    Point const d{{w[0] - t * u[0], w[1] - t * u[1], w[2] - t * u[2]}};
+    return Dot(d, d) <= reach * reach;
+  });
+}
+
+std::vector<std::size_t> shower::PointGrid::NearCone(const Point& apex,
+                                                     const Point& axis,
+                                                     double halfAngle,
+                                                     bool bothWays) const
+{
+  if (!IsFinite(apex) || !IsFinite(axis) || !std::isfinite(halfAngle)) return All();
+  double const pi = std::acos(-1.);
+  double const norm = std::sqrt(Dot(axis, axis));
+  if (!(norm > 0.) || halfAngle + kAngleTolerance >= pi / 2.) return All();
+
+  double const maxAngle = halfAngle + kAngleTolerance;
+  Point const u{{axis[0] / norm, axis[1] / norm, axis[2] / norm}};
+
+  // A cell passing the test has its centre within fCellRadius of the cone, so at most
+  // (t + fCellRadius) * tan(maxAngle) + fCellRadius from the axis, t >= -fCellRadius
+  double const tanAngle = std::tan(maxAngle);
+  double const tMin = bothWays ? -std::numeric_limits<double>::infinity() : -fCellRadius;
+  return Walk(apex, u, fCellRadius * (1. + tanAngle), tanAngle, tMin, [&](const Point& centre) {
+    Point const v{{centre[0] - apex[0], centre[1] - apex[1], centre[2] - apex[2]}};
+    double const dist = std::sqrt(Dot(v, v));
+    if (dist <= fCellRadius) return true; // the apex may be in the cell
+    double const angle = std::acos(std::clamp(Dot(v, axis) / (dist * norm), -1., 1.));
+    double const spread = std::asin(fCellRadius / dist);
+    return angle - spread < maxAngle || (bothWays && (pi - angle) - spread < maxAngle);
+  });
+}
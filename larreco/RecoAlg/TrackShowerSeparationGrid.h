@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////
+// Class: PointGrid
+// File:  TrackShowerSeparationGrid.h
+//
+// Uniform grid over the space points (or track end points) of an event,
+// used by TrackShowerSeparationAlg to answer its cylinder, sphere and cone
+// queries without looking at every point.
+//
+// The queries return candidates: every point which may satisfy the
+// condition, and usually a few which do not, as indices into the vector the
+// grid was built from, in increasing order. The exact test is left to the
+// caller, so that the selection is the same as a loop over all the points.
+// Points with non-finite coordinates never pass a distance or angle test and
+// are left out of the grid.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef TrackShowerSeparationGrid_hxx
+#define TrackShowerSeparationGrid_hxx
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace shower {
+  class PointGrid;
+}
+
+class shower::PointGrid {
+public:
+  using Point = std::array<double, 3>;
+
+  /// Grid over points, with cubic cells of (at least) the given side. The cells are
+  /// made larger if needed to keep their number of the order of the number of points
+  PointGrid(const std::vector<Point>& points, double cellSize);
+
+  std::size_t NumPoints() const { return fNumPoints; }
+  double CellSize() const { return fCellSize; }
+
+  /// Candidates within radius of centre
+  std::vector<std::size_t> NearPoint(const Point& centre, double radius) const;
+
+  /// Candidates within radius of the (infinite) line through origin along direction
+  std::vector<std::size_t> NearLine(const Point& origin,
+                                    const Point& direction,
+                                    double radius) const;
+
+  /// Candidates at less than halfAngle (radians) from axis, seen from apex; with bothWays
+  /// also those at less than halfAngle from -axis
+  std::vector<std::size_t> NearCone(const Point& apex,
+                                    const Point& axis,
+                                    double halfAngle,
+                                    bool bothWays) const;
+
+private:
+  /// All points of the cells passing cellTest(cell centre), in increasing order
+  template <typename CellTest>
+  std::vector<std::size_t> Select(CellTest cellTest) const;
+
+  /// As Select, but only looking at the cells whose centre is within
+  /// pad + slope * |t| of the point origin + t * unit of the line, for t >= tMin:
+  /// the cells are walked along the line one layer at a time
+  template <typename CellTest>
+  std::vector<std::size_t> Walk(const Point& origin,
+                                const Point& unit,
+                                double pad,
+                                double slope,
+                                double tMin,
+                                CellTest cellTest) const;
+
+  std::vector<std::size_t> All() const;
+
+  std::size_t CellIndex(int ix, int iy, int iz) const
+  {
+    return (std::size_t(iz) * fNCells[1] + iy) * fNCells[0] + ix;
+  }
+
+  std::size_t fNumPoints{0};
+  Point fMin{{0., 0., 0.}};
+  double fCellSize{1.};
+  double fCellRadius{0.}; ///< radius of the sphere around a cell, with a safety margin
+  std::array<int, 3> fNCells{{0, 0, 0}};
+
+  std::vector<std::size_t> fCellStart;     ///< first entry of each cell in fCellPoints
+  std::vector<std::size_t> fCellPoints;    ///< point indices, cell by cell
+  std::vector<std::size_t> fOccupiedCells; ///< cells with at least one point
+  std::vector<Point> fOccupiedCentres;     ///< centres of fOccupiedCells
+};
+
+#endif
@@ -24,6 +24,9 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include "tbb/parallel_for.h"
+
+#include <cstddef>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -35,7 +38,11 @@ namespace tca {
   TrajClusterAlg::TrajClusterAlg(fhicl::ParameterSet const& pset)
     : fCaloAlg(pset.get<fhicl::ParameterSet>("CaloAlg")), fMVAReader("Silent")
   {
+    TCContextScope scope(fContext);
+
     tcc.showerParentReader = &fMVAReader;
+    tcc.showerParentMutex = &fMVAMutex;
+    fParallelSlices = pset.get<bool>("ParallelSlices", false);
 
     bool badinput = false;
     // set all configurable modes false
@@ -308,6 +315,7 @@ namespace tca {
   {
     // defines the pointer to the input hit collection, analyzes them,
     // initializes global counters and refreshes service references
+    TCContextScope scope(fContext);
     ClearResults();
     evt.allHits = &inputHits;
     evt.run = run;
@@ -332,6 +340,7 @@ namespace tca {
   ////////////////////////////////////////////////
   void TrajClusterAlg::SetSourceHits(std::vector<recob::Hit> const& srcHits)
   {
+    TCContextScope scope(fContext);
     evt.srcHits = &srcHits;
     evt.tpcSrcHitRange.resize(tcc.geom->NTPC());
     for (auto& thr : evt.tpcSrcHitRange)
@@ -353,11 +362,107 @@ namespace tca {
   {
     // Reconstruct everything using the hits in a slice
 
+    TCContextScope scope(fContext);
+    if (slices.empty()) ++evt.eventsProcessed;
+    if (tcc.dbgStp) FindDebugHit(hitsInSlice, sliceID);
+    if (!ReconstructSlice(clockData, detProp, hitsInSlice, sliceID)) return;
+    CountAlgMods(slices.back());
+  } // RunTrajClusterAlg
+
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::RunTrajClusterAlg(detinfo::DetectorClocksData const& clockData,
+                                         detinfo::DetectorPropertiesData const& detProp,
+                                         std::vector<std::vector<unsigned int>>& slicesHits,
+                                         std::vector<int> const& sliceIDs)
+  {
+    // Reconstruct a set of slices. The debug modes and the diagnostic trees need the
+    // slices to be reconstructed one after the other
+
+    TCContextScope scope(fContext);
+    bool serial = !fParallelSlices || slicesHits.size() < 2 || tcc.modes[kDebug] ||
+                  tcc.modes[kSaveShowerTree] || tcc.modes[kSaveCRTree];
+    if (serial) {
+      for (std::size_t isl = 0; isl < slicesHits.size(); ++isl)
+        RunTrajClusterAlg(clockData, detProp, slicesHits[isl], sliceIDs[isl]);
+      return;
+    }
+
     if (slices.empty()) ++evt.eventsProcessed;
-    if (hitsInSlice.size() < 2) return;
-    if (tcc.recoSlice > 0 && sliceID != tcc.recoSlice) return;
 
-    if (!CreateSlice(clockData, detProp, hitsInSlice, sliceID)) return;
+    // Give each slice a copy of the event and configuration. The wire hit ranges of each
+    // TPC are filled here, once, as they would be when reconstructing the slices in turn.
+    // The unique ID counters start at 0 and are offset when the results are collected
+    std::vector<TCContext> sliceContexts(slicesHits.size());
+    for (std::size_t isl = 0; isl < slicesHits.size(); ++isl) {
+      auto const& hitsInSlice = slicesHits[isl];
+      if (hitsInSlice.size() > 1 && hitsInSlice[0] < (*evt.allHits).size())
+        FillWireHitRange((*evt.allHits)[hitsInSlice[0]].WireID().asTPCID());
+      auto& sctx = sliceContexts[isl];
+      sctx.evt = evt;
+      sctx.evt.WorkID = 0;
+      sctx.evt.globalT_UID = 0;
+      sctx.evt.global2V_UID = 0;
+      sctx.evt.global3V_UID = 0;
+      sctx.evt.globalP_UID = 0;
+      sctx.evt.global2S_UID = 0;
+      sctx.evt.global3S_UID = 0;
+      sctx.tcc = tcc;
+      sctx.debug = debug;
+    } // isl
+
+    std::vector<char> reconstructed(slicesHits.size(), false);
+    tbb::parallel_for(std::size_t(0), slicesHits.size(), [&](std::size_t isl) {
+      TCContextScope sliceScope(sliceContexts[isl]);
+      reconstructed[isl] = ReconstructSlice(clockData, detProp, slicesHits[isl], sliceIDs[isl]);
+    });
+
+    // collect the slices in order
+    for (std::size_t isl = 0; isl < slicesHits.size(); ++isl) {
+      auto& sctx = sliceContexts[isl];
+      if (sctx.slices.empty()) continue;
+      auto& slc = sctx.slices.front();
+      for (auto& tj : slc.tjs) {
+        if (tj.UID > 0) tj.UID += evt.globalT_UID;
+        if (tj.WorkID < 0) tj.WorkID += evt.WorkID;
+      } // tj
+      for (auto& vx2 : slc.vtxs)
+        if (vx2.UID > 0) vx2.UID += evt.global2V_UID;
+      for (auto& vx3 : slc.vtx3s)
+        if (vx3.UID > 0) vx3.UID += evt.global3V_UID;
+      for (auto& pfp : slc.pfps) {
+        if (pfp.UID > 0) pfp.UID += evt.globalP_UID;
+        if (pfp.ParentUID > 0) pfp.ParentUID += evt.globalP_UID;
+        for (auto& dtrUID : pfp.DtrUIDs)
+          if (dtrUID > 0) dtrUID += evt.globalP_UID;
+      } // pfp
+      for (auto& ss : slc.cots)
+        if (ss.UID > 0) ss.UID += evt.global2S_UID;
+      for (auto& ss3 : slc.showers)
+        if (ss3.UID > 0) ss3.UID += evt.global3S_UID;
+      evt.WorkID += sctx.evt.WorkID;
+      evt.globalT_UID += sctx.evt.globalT_UID;
+      evt.global2V_UID += sctx.evt.global2V_UID;
+      evt.global3V_UID += sctx.evt.global3V_UID;
+      evt.globalP_UID += sctx.evt.globalP_UID;
+      evt.global2S_UID += sctx.evt.global2S_UID;
+      evt.global3S_UID += sctx.evt.global3S_UID;
+      slices.push_back(std::move(slc));
+      if (reconstructed[isl]) CountAlgMods(slices.back());
+    } // isl
+  } // RunTrajClusterAlg
+
+  ////////////////////////////////////////////////
+  bool TrajClusterAlg::ReconstructSlice(detinfo::DetectorClocksData const& clockData,
+                                        detinfo::DetectorPropertiesData const& detProp,
+                                        std::vector<unsigned int>& hitsInSlice,
+                                        int sliceID)
+  {
+    // Create a slice and reconstruct it. Returns true if all of the steps were done
+
+    if (hitsInSlice.size() < 2) return false;
+    if (tcc.recoSlice > 0 && sliceID != tcc.recoSlice) return false;
+
+    if (!CreateSlice(clockData, detProp, hitsInSlice, sliceID)) return false;
 
     seeds.resize(0);
     // get a reference to the stored slice
@@ -365,7 +470,7 @@ namespace tca {
     // special debug mode reconstruction
     if (tcc.recoTPC > 0 && (short)slc.TPCID.TPC != tcc.recoTPC) {
       slices.pop_back();
-      return;
+      return false;
     }
 
     if (evt.aveHitRMS.size() != slc.nPlanes)
@@ -377,7 +482,7 @@ namespace tca {
     for (unsigned short plane = 0; plane < slc.nPlanes; ++plane) {
       CTP_t inCTP = EncodeCTP(slc.TPCID.Cryostat, slc.TPCID.TPC, plane);
       ReconstructAllTraj(detProp, slc, inCTP);
-      if (!slc.isValid) return;
+      if (!slc.isValid) return false;
     } // plane
     // Compare 2D vertices in each plane and try to reconcile T -> 2V attachments using
     // 2D and 3D(?) information
@@ -403,13 +508,17 @@ namespace tca {
       FindShowers3D(detProp, slc);
       if (tcc.modes[kSaveShowerTree]) {
         std::cout << "SHOWER TREE STAGE NUM SIZE: " << stv.StageNum.size() << std::endl;
+        fShTreeVars = stv;
+        fShTreeRun = evt.run;
+        fShTreeSubRun = evt.subRun;
+        fShTreeEvent = evt.event;
         showertree->Fill();
       }
     } // 3D shower code
 
     if (!slc.isValid) {
       mf::LogVerbatim("TC") << "RunTrajCluster failed in MakeAllTrajClusters";
-      return;
+      return false;
     }
 
     // dump a trajectory?
@@ -417,16 +526,41 @@ namespace tca {
 
     Finish3DShowers(slc);
 
+    // clear vectors that are not needed later
+    slc.mallTraj.resize(0);
+
+    return true;
+  } // ReconstructSlice
+
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::CountAlgMods(TCSlice const& slc)
+  {
     // count algorithm usage
     for (auto& tj : slc.tjs) {
       for (unsigned short ib = 0; ib < AlgBitNames.size(); ++ib)
         if (tj.AlgMod[ib]) ++fAlgModCount[ib];
     } // tj
+  } // CountAlgMods
 
-    // clear vectors that are not needed later
-    slc.mallTraj.resize(0);
-
-  } // RunTrajClusterAlg
+  ////////////////////////////////////////////////
+  void TrajClusterAlg::FindDebugHit(std::vector<unsigned int> const& hitsInSlice, int sliceID)
+  {
+    debug.Hit = UINT_MAX;
+    for (auto iht : hitsInSlice) {
+      auto& hit = (*evt.allHits)[iht];
+      if ((int)hit.WireID().TPC == debug.TPC && (int)hit.WireID().Plane == debug.Plane &&
+          (int)hit.WireID().Wire == debug.Wire && hit.PeakTime() > debug.Tick - 10 &&
+          hit.PeakTime() < debug.Tick + 10) {
+        std::cout << "Debug hit " << iht << " found in slice ID " << sliceID;
+        std::cout << " RMS " << hit.RMS();
+        std::cout << " Multiplicity " << hit.Multiplicity();
+        std::cout << " GoodnessOfFit " << hit.GoodnessOfFit();
+        std::cout << "\n";
+        debug.Hit = iht;
+        break;
+      } // Look for debug hit
+    }   // iht
+  }     // FindDebugHit
 
   ////////////////////////////////////////////////
   void TrajClusterAlg::ReconstructAllTraj(detinfo::DetectorPropertiesData const& detProp,
@@ -989,6 +1123,7 @@ namespace tca {
     // merge the hits indexed by tpHits into one or more hits with the requirement that the hits
     // are on different wires
 
+    TCContextScope scope(fContext);
     if (tpHits.empty()) return;
 
     // no merge required. Just put a close copy of the single hit in the output hit collection
@@ -1174,39 +1309,41 @@ namespace tca {
   {
     showertree = t;
 
-    showertree->Branch("run", &evt.run, "run/I");
-    showertree->Branch("subrun", &evt.subRun, "subrun/I");
-    showertree->Branch("event", &evt.event, "event/I");
-
-    showertree->Branch("BeginWir", &stv.BeginWir);
-    showertree->Branch("BeginTim", &stv.BeginTim);
-    showertree->Branch("BeginAng", &stv.BeginAng);
-    showertree->Branch("BeginChg", &stv.BeginChg);
-    showertree->Branch("BeginVtx", &stv.BeginVtx);
-
-    showertree->Branch("EndWir", &stv.EndWir);
-    showertree->Branch("EndTim", &stv.EndTim);
-    showertree->Branch("EndAng", &stv.EndAng);
-    showertree->Branch("EndChg", &stv.EndChg);
-    showertree->Branch("EndVtx", &stv.EndVtx);
-
-    showertree->Branch("MCSMom", &stv.MCSMom);
-
-    showertree->Branch("PlaneNum", &stv.PlaneNum);
-    showertree->Branch("TjID", &stv.TjID);
-    showertree->Branch("IsShowerTj", &stv.IsShowerTj);
-    showertree->Branch("ShowerID", &stv.ShowerID);
-    showertree->Branch("IsShowerParent", &stv.IsShowerParent);
-    showertree->Branch("StageNum", &stv.StageNum);
-    showertree->Branch("StageName", &stv.StageName);
-
-    showertree->Branch("Envelope", &stv.Envelope);
-    showertree->Branch("EnvPlane", &stv.EnvPlane);
-    showertree->Branch("EnvStage", &stv.EnvStage);
-    showertree->Branch("EnvShowerID", &stv.EnvShowerID);
-
-    showertree->Branch("nStages", &stv.nStages);
-    showertree->Branch("nPlanes", &stv.nPlanes);
+    // the branches point to copies that are filled before the tree is, so that they
+    // don't depend on which thread is running the algorithm
+    showertree->Branch("run", &fShTreeRun, "run/I");
+    showertree->Branch("subrun", &fShTreeSubRun, "subrun/I");
+    showertree->Branch("event", &fShTreeEvent, "event/I");
+
+    showertree->Branch("BeginWir", &fShTreeVars.BeginWir);
+    showertree->Branch("BeginTim", &fShTreeVars.BeginTim);
+    showertree->Branch("BeginAng", &fShTreeVars.BeginAng);
+    showertree->Branch("BeginChg", &fShTreeVars.BeginChg);
+    showertree->Branch("BeginVtx", &fShTreeVars.BeginVtx);
+
+    showertree->Branch("EndWir", &fShTreeVars.EndWir);
+    showertree->Branch("EndTim", &fShTreeVars.EndTim);
+    showertree->Branch("EndAng", &fShTreeVars.EndAng);
+    showertree->Branch("EndChg", &fShTreeVars.EndChg);
+    showertree->Branch("EndVtx", &fShTreeVars.EndVtx);
+
+    showertree->Branch("MCSMom", &fShTreeVars.MCSMom);
+
+    showertree->Branch("PlaneNum", &fShTreeVars.PlaneNum);
+    showertree->Branch("TjID", &fShTreeVars.TjID);
+    showertree->Branch("IsShowerTj", &fShTreeVars.IsShowerTj);
+    showertree->Branch("ShowerID", &fShTreeVars.ShowerID);
+    showertree->Branch("IsShowerParent", &fShTreeVars.IsShowerParent);
+    showertree->Branch("StageNum", &fShTreeVars.StageNum);
+    showertree->Branch("StageName", &fShTreeVars.StageName);
+
+    showertree->Branch("Envelope", &fShTreeVars.Envelope);
+    showertree->Branch("EnvPlane", &fShTreeVars.EnvPlane);
+    showertree->Branch("EnvStage", &fShTreeVars.EnvStage);
+    showertree->Branch("EnvShowerID", &fShTreeVars.EnvShowerID);
+
+    showertree->Branch("nStages", &fShTreeVars.nStages);
+    showertree->Branch("nPlanes", &fShTreeVars.nPlanes);
 
   } // end DefineShTree
 
@@ -1280,6 +1417,7 @@ namespace tca {
   {
     // final steps that involve correlations between slices
     // Stitch PFParticles between TPCs
+    TCContextScope scope(fContext);
 
     // define the PFP TjUIDs vector before calling StitchPFPs
     for (auto& slc : slices) {
@@ -10,6 +10,8 @@
 #define TRAJCLUSTERALG_H
 
 // C/C++ standard libraries
+#include <cassert>
+#include <mutex>
 #include <string>
 #include <utility> // std::pair<>
 #include <vector>
@@ -24,6 +26,7 @@ namespace fhicl {
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "larreco/Calorimetry/CalorimetryAlg.h"
 #include "larreco/RecoAlg/TCAlg/DataStructs.h"
+#include "larreco/RecoAlg/TCAlg/TCContext.h"
 namespace detinfo {
   class DetectorClocksData;
 }
@@ -43,24 +46,46 @@ namespace tca {
                       unsigned int event);
     void SetInputSpts(std::vector<recob::SpacePoint> const& sptHandle)
     {
+      TCContextScope scope(fContext);
       evt.sptHandle = &sptHandle;
     }
     void SetSourceHits(std::vector<recob::Hit> const& srcHits);
-    void ExpectSlicedHits() { evt.expectSlicedHits = true; }
+    void ExpectSlicedHits()
+    {
+      TCContextScope scope(fContext);
+      evt.expectSlicedHits = true;
+    }
     void RunTrajClusterAlg(detinfo::DetectorClocksData const& clockData,
                            detinfo::DetectorPropertiesData const& detProp,
                            std::vector<unsigned int>& hitsInSlice,
                            int sliceID);
-    bool CreateSlice(detinfo::DetectorClocksData const& clockData,
-                     detinfo::DetectorPropertiesData const& detProp,
-                     std::vector<unsigned int>& hitsInSlice,
-                     int sliceID);
+    /// Reconstructs a set of slices, concurrently if ParallelSlices is set. The results,
+    /// including the unique IDs, are the same as calling RunTrajClusterAlg on each slice in turn
+    void RunTrajClusterAlg(detinfo::DetectorClocksData const& clockData,
+                           detinfo::DetectorPropertiesData const& detProp,
+                           std::vector<std::vector<unsigned int>>& slicesHits,
+                           std::vector<int> const& sliceIDs);
     void FinishEvent();
 
     void DefineShTree(TTree* t);
 
-    unsigned short GetSlicesSize() const { return slices.size(); }
-    TCSlice const& GetSlice(unsigned short sliceIndex) const { return slices[sliceIndex]; }
+    /// The state of this instance. Open a TCContextScope on it to use the tca functions
+    /// and the references returned by GetSlice directly
+    TCContext& GetContext() { return fContext; }
+    TCContext const& GetContext() const { return fContext; }
+
+    unsigned short GetSlicesSize() const
+    {
+      TCContextScope scope(fContext);
+      return slices.size();
+    }
+    /// The slice lives in the context state, so the reference is only valid while a
+    /// TCContextScope on GetContext() is open on this thread
+    TCSlice const& GetSlice(unsigned short sliceIndex) const
+    {
+      assert(TCContextScope::IsBound(fContext));
+      return slices[sliceIndex];
+    }
     void MergeTPHits(std::vector<unsigned int>& tpHits,
                      std::vector<recob::Hit>& newHitCol,
                      std::vector<unsigned int>& newHitAssns) const;
@@ -71,6 +96,7 @@ namespace tca {
     /// Deletes all the results
     void ClearResults()
     {
+      TCContextScope scope(fContext);
       slices.resize(0);
       evt.sptHits.resize(0);
       evt.wireHitRange.resize(0);
@@ -79,14 +105,38 @@ namespace tca {
   private:
     recob::Hit MergeTPHitsOnWire(std::vector<unsigned int>& tpHits) const;
 
+    // the evt, tcc, slices, etc used by this instance
+    mutable TCContext fContext{};
+
     // SHOWER VARIABLE TREE
     TTree* showertree;
+    // copies of stv and the event numbers that the tree branches point to
+    ShowerTreeVars fShTreeVars;
+    unsigned int fShTreeRun{0};
+    unsigned int fShTreeSubRun{0};
+    unsigned int fShTreeEvent{0};
 
     calo::CalorimetryAlg fCaloAlg;
     TMVA::Reader fMVAReader;
+    std::mutex fMVAMutex;
+
+    bool fParallelSlices{false};
 
     std::vector<unsigned int> fAlgModCount;
 
+    // Defines a slice in the bound context
+    bool CreateSlice(detinfo::DetectorClocksData const& clockData,
+                     detinfo::DetectorPropertiesData const& detProp,
+                     std::vector<unsigned int>& hitsInSlice,
+                     int sliceID);
+    bool ReconstructSlice(detinfo::DetectorClocksData const& clockData,
+                          detinfo::DetectorPropertiesData const& detProp,
+                          std::vector<unsigned int>& hitsInSlice,
+                          int sliceID);
+    void CountAlgMods(TCSlice const& slc);
+    // Look for the debug hit in the slice
+    void FindDebugHit(std::vector<unsigned int> const& hitsInSlice, int sliceID);
+
     void ReconstructAllTraj(detinfo::DetectorPropertiesData const& detProp,
                             TCSlice& slc,
                             CTP_t inCTP);
@@ -9,6 +9,11 @@
 #include "TMatrixDSym.h"
 #include "TMatrixDSymEigen.h"
 
+#include "tbb/parallel_for.h"
+
+#include <algorithm>
+#include <cmath>
+
 using namespace std;
 using namespace trkf;
 using namespace recob::tracking;
@@ -70,6 +75,16 @@ recob::MCSFitResult TrajectoryMCSFitter::fitMcs(const recob::TrackTrajectory& tr
                              dtheta);
 }
 
+vector<recob::MCSFitResult> TrajectoryMCSFitter::fitMcs(const vector<recob::Track>& tracks,
+                                                     int pid) const
+{
+  vector<recob::MCSFitResult> results(tracks.size());
+  tbb::parallel_for(size_t(0), tracks.size(), [&](size_t i) {
+    results[i] = fitMcs(tracks[i], pid);
+  });
+  return results;
+}
+
 void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj,
                                               vector<size_t>& breakpoints,
                                               vector<float>& segradlengths,
@@ -161,25 +176,37 @@ const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(
   float pstep,
   float detAngResol) const
 {
-  int best_idx = -1;
-  float best_logL = std::numeric_limits<float>::max();
-  float best_p = -1.0;
-  std::vector<float> vlogL;
-  for (float p_test = pmin; p_test <= pmax; p_test += pstep) {
-    float logL = mcsLikelihood(p_test, detAngResol, dtheta, seg_nradlengths, cumLen, fwdFit, pid);
-    if (logL < best_logL) {
-      best_p = p_test;
-      best_logL = logL;
-      best_idx = vlogL.size();
+  //
+  // Grid of the scan, the momentum values are accumulated as in a plain loop from pmin to pmax.
+  // The likelihood is evaluated only where needed, at most once per point
+  //
+  std::vector<float> ptest;
+  for (float p_test = pmin; p_test <= pmax; p_test += pstep)
+    ptest.push_back(p_test);
+  const int npoints = ptest.size();
+  std::vector<float> vlogL(npoints);
+  std::vector<bool> evaluated(npoints, false);
+  auto logL = [&](int i) {
+    if (!evaluated[i]) {
+      vlogL[i] = mcsLikelihood(ptest[i], detAngResol, dtheta, seg_nradlengths, cumLen, fwdFit, pid);
+      evaluated[i] = true;
     }
-    vlogL.push_back(logL);
-  }
+    return vlogL[i];
+  };
+  //
+  // find the minimum without evaluating every point of the grid when it is unimodal
+  //
+  const int best_idx = likelihoodScanMinimum(npoints, logL);
+  // the likelihood is infinite (the particle stops) everywhere below the highest momentum
+  if (best_idx < 0) return ScanResult(-1.0, -1., std::numeric_limits<float>::max());
+  const float best_logL = vlogL[best_idx];
+  const float best_p = ptest[best_idx];
   //
   //uncertainty from left side scan
   float lunc = -1.;
   if (best_idx > 0) {
     for (int j = best_idx - 1; j >= 0; j--) {
-      float dLL = vlogL[j] - vlogL[best_idx];
+      float dLL = logL(j) - vlogL[best_idx];
       if (dLL >= 0.5) {
         lunc = (best_idx - j) * pstep;
         break;
@@ -188,9 +215,9 @@ const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(
   }
   //uncertainty from right side scan
   float runc = -1.;
-  if (best_idx < int(vlogL.size() - 1)) {
-    for (unsigned int j = best_idx + 1; j < vlogL.size(); j++) {
-      float dLL = vlogL[j] - vlogL[best_idx];
+  if (best_idx < npoints - 1) {
+    for (int j = best_idx + 1; j < npoints; j++) {
+      float dLL = logL(j) - vlogL[best_idx];
       if (dLL >= 0.5) {
         runc = (j - best_idx) * pstep;
         break;
@@ -414,6 +441,13 @@ double TrajectoryMCSFitter::GetE(const double initial_E,
     return (initial_E - kcal * length_travelled); //energy at this segment
   }
   //
+  if (eLossMode_ == 2) {
+    // Bethe-Bloch, from the residual range tables when the energy is covered
+    const RangeTable* table = rangeTable(m);
+    if (table && initial_E < table->eMax())
+      return GetEFromRange(*table, initial_E, length_travelled);
+  }
+  //
   // Non constant energy loss distribution
   const double step_size = length_travelled / nElossSteps_;
   //
@@ -436,3 +470,60 @@ double TrajectoryMCSFitter::GetE(const double initial_E,
   }
   return current_E;
 }
+//
+void TrajectoryMCSFitter::buildRangeTables()
+{
+  //
+  // Range as a function of the energy, integrating dE/(dE/dx) from the mass of the particle up to
+  // the energy at pMax with Simpson's rule in each bin. dE/dx is evaluated as in GetE.
+  //
+  constexpr int nbins = 5000;
+  rangeTables_.clear();
+  for (int pid : {13, 211, 321, 2212}) {
+    RangeTable table;
+    table.mass = mass(pid);
+    const double eMax = 1.01 * std::sqrt(pMax_ * pMax_ + table.mass * table.mass);
+    table.eStep = (eMax - table.mass) / nbins;
+    auto invDedx = [this, &table](const double e) {
+      constexpr double minDedx = 1.E-6;
+      return 1. / std::max(energyLossBetheBloch(table.mass, e), minDedx);
+    };
+    table.range.resize(nbins + 1);
+    table.range[0] = 0.;
+    for (int i = 0; i < nbins; ++i) {
+      const double e0 = table.mass + i * table.eStep;
+      const double e1 = e0 + table.eStep;
+      table.range[i + 1] = table.range[i] + table.eStep / 6. *
+                                              (invDedx(e0) + 4. * invDedx(0.5 * (e0 + e1)) +
+                                               invDedx(e1));
+    }
+    rangeTables_.push_back(std::move(table));
+  }
+}
+//
+const TrajectoryMCSFitter::RangeTable* TrajectoryMCSFitter::rangeTable(const double m) const
+{
+  for (auto const& table : rangeTables_) {
+    if (table.mass == m) return &table;
+  }
+  return nullptr;
+}
+//
+double TrajectoryMCSFitter::GetEFromRange(const RangeTable& table,
+                                          const double initial_E,
+                                          const double length_travelled) const
+{
+  //
+  if (length_travelled <= 0.) return initial_E;
+  //
+  const auto& range = table.range;
+  const double x = (initial_E - table.mass) / table.eStep;
+  const size_t i = std::min(size_t(x), range.size() - 2);
+  const double residual = range[i] + (x - i) * (range[i + 1] - range[i]) - length_travelled;
+  if (residual <= 0.) return 0.;
+  //
+  const size_t j =
+    std::min(size_t(std::upper_bound(range.begin(), range.end(), residual) - range.begin() - 1),
+             range.size() - 2);
+  return table.mass + table.eStep * (j + (residual - range[j]) / (range[j + 1] - range[j]));
+}
@@ -14,11 +14,79 @@
 #include "lardataobj/RecoBase/TrackTrajectory.h"
 #include "lardataobj/RecoBase/Trajectory.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 #include <utility>
 #include <vector>
 
 namespace trkf {
+
+  /**
+   * @brief Index of the lowest of the npoints values logL(i) on a likelihood scan grid.
+   *
+   * Returns the first index with the lowest value, as a loop over all the points would, or -1
+   * if all the values are at least std::numeric_limits<float>::max() (the particle stops).
+   *
+   * The grid is first sampled every about sqrt(npoints) points. If the samples go down to
+   * their lowest value and up after it (the values where the particle stops, at the low
+   * momentum end, excepted), only the points between the two samples around the lowest one
+   * are evaluated. Otherwise the likelihood has several minima and all the points are
+   * evaluated. Minima narrower than the sampling step, away from the lowest sample, are not
+   * seen; logL should cache its values, as the samples are asked for again.
+   */
+  template <typename LogL>
+  int likelihoodScanMinimum(int npoints, LogL&& logL)
+  {
+    constexpr float infinite = std::numeric_limits<float>::max();
+    //
+    // sample the grid, the last point included
+    //
+    const int stride = std::max(1, int(std::sqrt(npoints)));
+    std::vector<int> samples;
+    for (int i = 0; i < npoints; i += stride)
+      samples.push_back(i);
+    if (npoints > 0 && samples.back() != npoints - 1) samples.push_back(npoints - 1);
+
+    int best = -1;
+    float best_logL = infinite;
+    for (size_t k = 0; k < samples.size(); ++k) {
+      if (logL(samples[k]) < best_logL) {
+        best_logL = logL(samples[k]);
+        best = k;
+      }
+    }
+    if (best < 0) return -1;
+    //
+    // the minimum is bracketed by the samples around the lowest one only if they are unimodal
+    //
+    bool unimodal = true;
+    for (int k = 1; k <= best && unimodal; ++k) {
+      const float prev = logL(samples[k - 1]);
+      if (prev < infinite && logL(samples[k]) > prev) unimodal = false;
+    }
+    for (size_t k = best + 1; k < samples.size() && unimodal; ++k) {
+      if (logL(samples[k]) < logL(samples[k - 1])) unimodal = false;
+    }
+    int lo = 0;
+    int hi = npoints - 1;
+    if (unimodal) {
+      if (best > 0) lo = samples[best - 1] + 1;
+      if (best + 1 < int(samples.size())) hi = samples[best + 1] - 1;
+    }
+
+    int best_idx = -1;
+    best_logL = infinite;
+    for (int i = lo; i <= hi; ++i) {
+      if (logL(i) < best_logL) {
+        best_logL = logL(i);
+        best_idx = i;
+      }
+    }
+    return best_idx;
+  }
+
   /**
    * @file  larreco/RecoAlg/TrajectoryMCSFitter.h
    * @class trkf::TrajectoryMCSFitter
@@ -66,7 +134,8 @@ namespace trkf {
         2};
       fhicl::Atom<int> nElossSteps{
         Name("nElossSteps"),
-        Comment("Number of steps for computing energy loss uptream to current segment."),
+        Comment("Number of steps for computing energy loss uptream to current segment. Not used "
+                "with eLossMode 2, which looks the energy up in residual range tables."),
         10};
       fhicl::Atom<int> eLossMode{
         Name("eLossMode"),
@@ -80,7 +149,9 @@ namespace trkf {
                                7.50};
       fhicl::Atom<double> pStepCoarse{
         Name("pStepCoarse"),
-        Comment("Step in momentum value in initial coase likelihood scan."),
+        Comment("Step in momentum value in initial coase likelihood scan. The scans only evaluate "
+                "the likelihood on the points of the grid needed to find its minimum and the "
+                "uncertainty."),
         0.01};
       fhicl::Atom<double> pStep{Name("pStep"),
                                 Comment("Step in momentum value in fine grained likelihood scan."),
@@ -144,6 +215,7 @@ namespace trkf {
       hlParams_ = hlParams;
       segLenTolerance_ = segLenTolerance;
       applySCEcorr_ = applySCEcorr;
+      if (eLossMode_ == 2) buildRangeTables();
     }
     explicit TrajectoryMCSFitter(const Parameters& p)
       : TrajectoryMCSFitter(p().pIdHypothesis(),
@@ -172,6 +244,10 @@ namespace trkf {
     {
       return fitMcs(traj, pIdHyp_);
     }
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::Track>& tracks) const
+    {
+      return fitMcs(tracks, pIdHyp_);
+    }
     //
     recob::MCSFitResult fitMcs(const recob::TrackTrajectory& traj, int pid) const;
     recob::MCSFitResult fitMcs(const recob::Track& track, int pid) const
@@ -184,6 +260,9 @@ namespace trkf {
       const recob::TrackTrajectory tt(traj, std::move(flags));
       return fitMcs(tt, pid);
     }
+    /// Fit the tracks in parallel, the results are in the same order as the tracks
+    std::vector<recob::MCSFitResult> fitMcs(const std::vector<recob::Track>& tracks,
+                                            int pid) const;
     //
     void breakTrajInSegments(const recob::TrackTrajectory& traj,
                              std::vector<size_t>& breakpoints,
@@ -246,11 +325,25 @@ namespace trkf {
     //
     double GetE(const double initial_E, const double length_travelled, const double mass) const;
     //
+    /// Residual range as a function of the energy for one particle hypothesis (eLossMode 2)
+    struct RangeTable {
+      double mass;
+      double eStep;
+      std::vector<double> range; ///< range [cm] at energy mass + i * eStep [GeV]
+      double eMax() const { return mass + eStep * (range.size() - 1); }
+    };
+    //
     int minNSegs() const { return minNSegs_; }
     double segLen() const { return segLen_; }
     double segLenTolerance() const { return segLenTolerance_; }
     //
   private:
+    void buildRangeTables();
+    const RangeTable* rangeTable(const double mass) const;
+    double GetEFromRange(const RangeTable& table,
+                         const double initial_E,
+                         const double length_travelled) const;
+    //
     int pIdHyp_;
     int minNSegs_;
     double segLen_;
@@ -266,6 +359,7 @@ namespace trkf {
     std::array<double, 5> hlParams_;
     double segLenTolerance_;
     bool applySCEcorr_;
+    std::vector<RangeTable> rangeTables_;
   };
 }
 
@@ -0,0 +1,25 @@
+#ifndef RECO3D_ARRAYRANGE_H
+#define RECO3D_ARRAYRANGE_H
+
+#include <cstddef>
+
+/// A run of consecutive elements of an array owned by someone else
+template <class T>
+class ArrayRange {
+public:
+  ArrayRange() : fBegin(nullptr), fEnd(nullptr) {}
+  ArrayRange(T* begin, T* end) : fBegin(begin), fEnd(end) {}
+
+  T* begin() const { return fBegin; }
+  T* end() const { return fEnd; }
+
+  std::size_t size() const { return fEnd - fBegin; }
+  bool empty() const { return fBegin == fEnd; }
+
+  T& operator[](std::size_t i) const { return fBegin[i]; }
+
+protected:
+  T *fBegin, *fEnd;
+};
+
+#endif
@@ -3,8 +3,13 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <numeric>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tbb/parallel_for.h"
 
 template <class T>
 T sqr(T x)
@@ -41,7 +46,7 @@ void SpaceCharge::AddCharge(double dq)
 }
 
 // ---------------------------------------------------------------------------
-CollectionWireHit::CollectionWireHit(int chan, double q, const std::vector<SpaceCharge*>& cross)
+CollectionWireHit::CollectionWireHit(int chan, double q, ArrayRange<SpaceCharge*> cross)
   : fChannel(chan), fCharge(q), fCrossings(cross)
 {
   if (q < 0) {
@@ -56,16 +61,6 @@ CollectionWireHit::CollectionWireHit(int chan, double q, const std::vector<Space
     sc->AddCharge(p);
 }
 
-// ---------------------------------------------------------------------------
-CollectionWireHit::~CollectionWireHit()
-{
-  // Each SpaceCharge can only be in one collection wire, so we own them. But
-  // not SpaceCharge does not clean up its induction wires since they're
-  // shared.
-  for (SpaceCharge* sc : fCrossings)
-    delete sc;
-}
-
 // ---------------------------------------------------------------------------
 double Metric(double q, double p)
 {
@@ -257,7 +252,8 @@ double SolvePair(CollectionWireHit* cwire, SpaceCharge* sci, SpaceCharge* scj, d
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(CollectionWireHit* cwire, double alpha)
+template <class F>
+void IteratePairs(CollectionWireHit* cwire, double alpha, F&& addCharge)
 {
   // Consider all pairs of crossings
   const unsigned int N = cwire->fCrossings.size();
@@ -273,14 +269,21 @@ void Iterate(CollectionWireHit* cwire, double alpha)
       if (x == 0) continue;
 
       // Actually make the update
-      sci->AddCharge(+x);
-      scj->AddCharge(-x);
+      addCharge(sci, +x);
+      addCharge(scj, -x);
     } // end for j
   }   // end for i
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(SpaceCharge* sc, double alpha)
+void Iterate(CollectionWireHit* cwire, double alpha)
+{
+  IteratePairs(cwire, alpha, [](SpaceCharge* sc, double dq) { sc->AddCharge(dq); });
+}
+
+// ---------------------------------------------------------------------------
+/// The change in charge that minimizes the metric for a lone SpaceCharge
+double SolveSingle(const SpaceCharge* sc, double alpha)
 {
   const QuadExpr chisq = Metric(sc, alpha);
 
@@ -300,29 +303,285 @@ void Iterate(SpaceCharge* sc, double alpha)
   // the range.
   const double chisq_n = chisq.Eval(xmin);
 
-  if (chisq_n < chisq_new)
-    sc->AddCharge(xmin);
-  else
-    sc->AddCharge(x);
+  return (chisq_n < chisq_new) ? xmin : x;
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(const std::vector<CollectionWireHit*>& cwires,
-             const std::vector<SpaceCharge*>& orphanSCs,
-             double alpha)
+void Iterate(SpaceCharge* sc, double alpha)
+{
+  sc->AddCharge(SolveSingle(sc, alpha));
+}
+
+// ---------------------------------------------------------------------------
+/// The order Iterate() visits the collection wires in
+std::vector<unsigned int> SweepOrder(unsigned int N)
 {
   // Visiting in a "random" order helps prevent local artefacts that are slow
   // to break up.
+  std::vector<unsigned int> ret;
+  ret.reserve(N);
   unsigned int cwireIdx = 0;
-  if (!cwires.empty()) {
+  if (N > 0) {
     do {
-      Iterate(cwires[cwireIdx], alpha);
+      ret.push_back(cwireIdx);
 
       const unsigned int prime = 1299827;
-      cwireIdx = (cwireIdx + prime) % cwires.size();
+      cwireIdx = (cwireIdx + prime) % N;
     } while (cwireIdx != 0);
   }
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+void Iterate(const std::vector<CollectionWireHit*>& cwires,
+             const std::vector<SpaceCharge*>& orphanSCs,
+             double alpha)
+{
+  for (unsigned int cwireIdx : SweepOrder(cwires.size()))
+    Iterate(cwires[cwireIdx], alpha);
 
   for (SpaceCharge* sc : orphanSCs)
     Iterate(sc, alpha);
 }
+
+// ---------------------------------------------------------------------------
+/// Add charge to \a sc, returning the resulting change in the metric. The
+/// flags say which terms of the metric \a sc and its induction wires appear in
+double AddChargeTracked(SpaceCharge* sc,
+                        double dq,
+                        double alpha,
+                        bool inMetric,
+                        bool inMetric1,
+                        bool inMetric2)
+{
+  double ret = 0;
+
+  if (sc->fWire1 && inMetric1)
+    ret += Metric(sc->fWire1->fCharge, sc->fWire1->fPred + dq) -
+           Metric(sc->fWire1->fCharge, sc->fWire1->fPred);
+  if (sc->fWire2 && inMetric2)
+    ret += Metric(sc->fWire2->fCharge, sc->fWire2->fPred + dq) -
+           Metric(sc->fWire2->fCharge, sc->fWire2->fPred);
+
+  if (alpha != 0) {
+    if (inMetric) ret -= alpha * (sqr(sc->fPred + dq) - sqr(sc->fPred) + dq * sc->fNeiPotential);
+
+    // The neighbours' potentials change, and they only count if they're on a
+    // collection wire
+    for (const Neighbour& nei : sc->fNeighbours) {
+      if (nei.fSC->fCWire) ret -= alpha * nei.fSC->fPred * nei.fCoupling * dq;
+    }
+  }
+
+  sc->AddCharge(dq);
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+namespace {
+  /// Everything a collection wire or orphan SpaceCharge update reads or writes
+  /// is one of these: the SpaceCharges of a collection wire, a lone orphan, or
+  /// an induction wire
+  const void* Owner(const SpaceCharge* sc)
+  {
+    if (sc->fCWire) return sc->fCWire;
+    return sc;
+  }
+
+  class Resources {
+  public:
+    unsigned int Index(const void* res)
+    {
+      const auto it = fIndices.emplace(res, fParents.size());
+      if (it.second) {
+        fParents.push_back(fParents.size());
+        fColours.emplace_back();
+      }
+      return it.first->second;
+    }
+
+    unsigned int Find(unsigned int i)
+    {
+      while (fParents[i] != i) {
+        fParents[i] = fParents[fParents[i]];
+        i = fParents[i];
+      }
+      return i;
+    }
+
+    void Union(unsigned int i, unsigned int j) { fParents[Find(i)] = Find(j); }
+
+    /// Smallest colour not yet taken by any of \a res, which then take it
+    unsigned int Colour(const std::vector<unsigned int>& res)
+    {
+      std::vector<bool> taken;
+      for (unsigned int r : res) {
+        for (unsigned int c : fColours[r]) {
+          if (c >= taken.size()) taken.resize(c + 1, false);
+          taken[c] = true;
+        }
+      }
+      const unsigned int col = std::find(taken.begin(), taken.end(), false) - taken.begin();
+      for (unsigned int r : res)
+        fColours[r].push_back(col);
+      return col;
+    }
+
+    void ClearColours()
+    {
+      for (auto& c : fColours)
+        c.clear();
+    }
+
+  protected:
+    std::unordered_map<const void*, unsigned int> fIndices;
+    std::vector<unsigned int> fParents;
+    std::vector<std::vector<unsigned int>> fColours;
+  };
+
+  template <class T>
+  void AddAt(std::vector<std::vector<T>>& v, unsigned int i, const T& x)
+  {
+    if (i >= v.size()) v.resize(i + 1);
+    v[i].push_back(x);
+  }
+} // namespace
+
+// ---------------------------------------------------------------------------
+ParallelSolver::ParallelSolver(const std::vector<CollectionWireHit*>& cwires,
+                               const std::vector<SpaceCharge*>& orphanSCs)
+  : fCWires(cwires), fMetric(0), fNSweeps(0)
+{
+  Resources res;
+
+  auto footprint = [&res](const SpaceCharge* sc, std::vector<unsigned int>& ret) {
+    ret.push_back(res.Index(Owner(sc)));
+    if (sc->fWire1) ret.push_back(res.Index(sc->fWire1));
+    if (sc->fWire2) ret.push_back(res.Index(sc->fWire2));
+    for (const Neighbour& nei : sc->fNeighbours)
+      ret.push_back(res.Index(Owner(nei.fSC)));
+  };
+
+  const std::vector<unsigned int> order = SweepOrder(cwires.size());
+
+  std::vector<std::vector<unsigned int>> cwireRes(cwires.size());
+  for (unsigned int i : order) {
+    for (const SpaceCharge* sc : cwires[i]->fCrossings)
+      footprint(sc, cwireRes[i]);
+    std::sort(cwireRes[i].begin(), cwireRes[i].end());
+    cwireRes[i].erase(std::unique(cwireRes[i].begin(), cwireRes[i].end()), cwireRes[i].end());
+  }
+
+  std::vector<std::vector<unsigned int>> orphanRes(orphanSCs.size());
+  for (unsigned int i = 0; i < orphanSCs.size(); ++i) {
+    footprint(orphanSCs[i], orphanRes[i]);
+    std::sort(orphanRes[i].begin(), orphanRes[i].end());
+    orphanRes[i].erase(std::unique(orphanRes[i].begin(), orphanRes[i].end()), orphanRes[i].end());
+  }
+
+  // Connected components
+  for (const auto& r : cwireRes)
+    for (unsigned int j = 1; j < r.size(); ++j)
+      res.Union(r[0], r[j]);
+  for (const auto& r : orphanRes)
+    for (unsigned int j = 1; j < r.size(); ++j)
+      res.Union(r[0], r[j]);
+
+  std::unordered_map<unsigned int, unsigned int> compIdx;
+  auto component = [&](const std::vector<unsigned int>& r) -> Component& {
+    const auto it = compIdx.emplace(res.Find(r[0]), fComponents.size());
+    if (it.second) fComponents.emplace_back();
+    return fComponents[it.first->second];
+  };
+
+  // Greedy colouring, in the same order as the serial sweep, so that
+  // conflicting wires are still visited in roughly the serial order
+  for (unsigned int i : order)
+    AddAt(component(cwireRes[i]).cwireColours, res.Colour(cwireRes[i]), cwires[i]);
+
+  // The orphans are visited after all the wires, so have a colouring of
+  // their own
+  res.ClearColours();
+
+  // The induction wires the metric sums over
+  std::unordered_set<const InductionWireHit*> iwires;
+  for (const CollectionWireHit* cwire : cwires) {
+    for (const SpaceCharge* sc : cwire->fCrossings) {
+      if (sc->fWire1) iwires.insert(sc->fWire1);
+      if (sc->fWire2) iwires.insert(sc->fWire2);
+    }
+  }
+
+  for (unsigned int i = 0; i < orphanSCs.size(); ++i) {
+    SpaceCharge* sc = orphanSCs[i];
+    const Orphan orphan{sc, iwires.count(sc->fWire1) > 0, iwires.count(sc->fWire2) > 0};
+    AddAt(component(orphanRes[i]).orphanColours, res.Colour(orphanRes[i]), orphan);
+  }
+}
+
+// ---------------------------------------------------------------------------
+unsigned int ParallelSolver::NColours() const
+{
+  unsigned int ret = 0;
+  for (const Component& comp : fComponents) {
+    ret = std::max(ret, (unsigned int)comp.cwireColours.size());
+    ret = std::max(ret, (unsigned int)comp.orphanColours.size());
+  }
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+double ParallelSolver::Reset(double alpha)
+{
+  fMetric = Metric(fCWires, alpha);
+  fNSweeps = 0;
+  return fMetric;
+}
+
+// ---------------------------------------------------------------------------
+double ParallelSolver::Iterate(const Component& comp, double alpha)
+{
+  // The changes are summed in a fixed order so that the result does not
+  // depend on the scheduling
+  double ret = 0;
+  std::vector<double> deltas;
+
+  for (const std::vector<CollectionWireHit*>& cwires : comp.cwireColours) {
+    deltas.assign(cwires.size(), 0);
+    tbb::parallel_for(std::size_t(0), cwires.size(), [&](std::size_t i) {
+      IteratePairs(cwires[i], alpha, [&](SpaceCharge* sc, double dq) {
+        deltas[i] += AddChargeTracked(sc, dq, alpha, true, true, true);
+      });
+    });
+    ret = std::accumulate(deltas.begin(), deltas.end(), ret);
+  }
+
+  for (const std::vector<Orphan>& orphans : comp.orphanColours) {
+    deltas.assign(orphans.size(), 0);
+    tbb::parallel_for(std::size_t(0), orphans.size(), [&](std::size_t i) {
+      const Orphan& o = orphans[i];
+      deltas[i] = AddChargeTracked(
+        o.sc, SolveSingle(o.sc, alpha), alpha, false, o.inMetric1, o.inMetric2);
+    });
+    ret = std::accumulate(deltas.begin(), deltas.end(), ret);
+  }
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+double ParallelSolver::Iterate(double alpha)
+{
+  std::vector<double> deltas(fComponents.size(), 0);
+  tbb::parallel_for(std::size_t(0), fComponents.size(), [&](std::size_t i) {
+    deltas[i] = Iterate(fComponents[i], alpha);
+  });
+
+  fMetric = std::accumulate(deltas.begin(), deltas.end(), fMetric);
+
+  // Do not let the rounding errors of the tracked changes pile up
+  if (++fNSweeps >= kFullMetricInterval) return Reset(alpha);
+
+  return fMetric;
+}
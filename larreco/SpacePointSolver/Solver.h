@@ -5,6 +5,7 @@
 
 #include <vector>
 
+#include "larreco/SpacePointSolver/ArrayRange.h"
 #include "larreco/SpacePointSolver/QuadExpr.h"
 
 /// Allow InductionWireHit and CollectionWireHit to be put in the same maps
@@ -52,7 +53,7 @@ public:
   CollectionWireHit* fCWire;
   InductionWireHit *fWire1, *fWire2;
 
-  std::vector<Neighbour> fNeighbours;
+  ArrayRange<Neighbour> fNeighbours; ///< Part of SolverSystem::fNeighbours
 
   double fPred;
   double fNeiPotential; ///< Neighbour-induced potential
@@ -60,15 +61,31 @@ public:
 
 class CollectionWireHit : public WireHit {
 public:
-  CollectionWireHit(int chan, double q, const std::vector<SpaceCharge*>& cross);
-  ~CollectionWireHit();
+  CollectionWireHit(int chan, double q, ArrayRange<SpaceCharge*> cross);
 
   //protected:
   int fChannel;
 
   double fCharge;
 
+  ArrayRange<SpaceCharge*> fCrossings; ///< Part of SolverSystem::fCrossings
+};
+
+/// Owns all the objects of one system. They are stored in a handful of flat
+/// arrays, rather than being allocated one by one. The arrays are sized before
+/// they are filled, so the pointers between the objects remain valid.
+class SolverSystem {
+public:
+  //protected:
+  std::vector<InductionWireHit> fIWires;
+  /// The SpaceCharges of each collection wire are contiguous, followed by the
+  /// orphans
+  std::vector<SpaceCharge> fSpaceCharges;
+  std::vector<CollectionWireHit> fCWires;
+
+  /// Concatenated per-object lists, indexed by the ArrayRanges in the objects
   std::vector<SpaceCharge*> fCrossings;
+  std::vector<Neighbour> fNeighbours;
 };
 
 double Metric(const std::vector<SpaceCharge*>& scs, double alpha);
@@ -87,4 +104,60 @@ void Iterate(const std::vector<CollectionWireHit*>& cwires,
              const std::vector<SpaceCharge*>& orphanSCs,
              double alpha);
 
+/// Performs the same sweeps as Iterate(cwires, orphanSCs, alpha), but
+/// concurrently.
+///
+/// The system is split into its connected components. Within each component
+/// the collection wires (and then, separately, the orphan SpaceCharges) are
+/// coloured. Two members of the same colour never share an induction wire and
+/// never update the neighbour potential of the same SpaceCharge. Components,
+/// and the members of a single colour, are updated in parallel. The updates
+/// run in a different order from the serial sweep, so the two agree only to
+/// within the convergence tolerance.
+///
+/// The metric is not recomputed after each sweep. Instead it is kept up to
+/// date from the change that each update makes. The rounding errors of these
+/// changes add up, so the metric is recomputed from scratch every
+/// kFullMetricInterval sweeps, and should be with Reset() before deciding to
+/// stop on it.
+class ParallelSolver {
+public:
+  /// Number of sweeps between two recomputations of the whole metric
+  static constexpr unsigned int kFullMetricInterval = 10;
+
+  ParallelSolver(const std::vector<CollectionWireHit*>& cwires,
+                 const std::vector<SpaceCharge*>& orphanSCs);
+
+  /// Recompute the metric from scratch, same value as Metric(cwires, alpha)
+  double Reset(double alpha);
+
+  /// One sweep over the whole system. Returns the updated metric
+  double Iterate(double alpha);
+
+  double GetMetric() const { return fMetric; }
+
+  unsigned int NComponents() const { return fComponents.size(); }
+  unsigned int NColours() const;
+
+protected:
+  struct Orphan {
+    SpaceCharge* sc;
+    /// Whether the induction wires are counted in the metric
+    bool inMetric1, inMetric2;
+  };
+
+  struct Component {
+    std::vector<std::vector<CollectionWireHit*>> cwireColours;
+    std::vector<std::vector<Orphan>> orphanColours;
+  };
+
+  /// Returns the change in the metric
+  static double Iterate(const Component& comp, double alpha);
+
+  std::vector<CollectionWireHit*> fCWires;
+  std::vector<Component> fComponents;
+  double fMetric;
+  unsigned int fNSweeps; ///< Sweeps since the metric was last recomputed
+};
+
 #endif
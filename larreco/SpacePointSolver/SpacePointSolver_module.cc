@@ -4,6 +4,7 @@
 
 // C/C++ standard libraries
 #include <iostream>
+#include <memory>
 #include <string>
 
 // framework libraries
@@ -46,6 +47,90 @@ namespace reco3d {
     double xpos;
   };
 
+  /// Spatial hash of SpaceCharges into cubic cells, for the neighbour search.
+  /// The members of each cell are contiguous in a single array, and the cells
+  /// are found through an open addressing hash table.
+  class SpaceChargeGrid {
+  public:
+    struct Cell {
+      int x, y, z;
+      bool operator==(const Cell& c) const { return x == c.x && y == c.y && z == c.z; }
+    };
+
+    SpaceChargeGrid(const std::vector<SpaceCharge>& scs, double cellSize);
+
+    Cell CellOf(const SpaceCharge& sc) const
+    {
+      return {int(sc.fX / fCellSize), int(sc.fY / fCellSize), int(sc.fZ / fCellSize)};
+    }
+
+    /// Indices of the SpaceCharges in \a cell, in their original order
+    ArrayRange<const unsigned int> Find(const Cell& cell) const;
+
+  private:
+    struct Slot {
+      Cell cell;
+      unsigned int begin, end; ///< Range in fMembers, empty slot if begin == end
+    };
+
+    std::size_t SlotOf(const Cell& cell) const;
+
+    double fCellSize;
+    std::vector<Slot> fSlots; ///< Size is a power of two
+    std::vector<unsigned int> fMembers;
+  };
+
+  // ---------------------------------------------------------------------------
+  SpaceChargeGrid::SpaceChargeGrid(const std::vector<SpaceCharge>& scs, double cellSize)
+    : fCellSize(cellSize)
+  {
+    std::size_t nslots = 16;
+    while (nslots < 2 * scs.size())
+      nslots *= 2;
+    fSlots.assign(nslots, {{0, 0, 0}, 0, 0});
+
+    // Count the members of each cell, using "end" as the counter for now
+    std::vector<std::size_t> slotOf(scs.size());
+    for (std::size_t i = 0; i < scs.size(); ++i) {
+      const Cell cell = CellOf(scs[i]);
+      Slot& slot = fSlots[slotOf[i] = SlotOf(cell)];
+      slot.cell = cell;
+      ++slot.end;
+    }
+
+    unsigned int tot = 0;
+    for (Slot& slot : fSlots) {
+      slot.begin = tot;
+      tot += slot.end;
+      slot.end = slot.begin;
+    }
+
+    fMembers.resize(scs.size());
+    for (std::size_t i = 0; i < scs.size(); ++i)
+      fMembers[fSlots[slotOf[i]].end++] = i;
+  }
+
+  // ---------------------------------------------------------------------------
+  std::size_t SpaceChargeGrid::SlotOf(const Cell& cell) const
+  {
+    const std::size_t mask = fSlots.size() - 1;
+    std::size_t i = (std::size_t(cell.x) * 73856093u ^ std::size_t(cell.y) * 19349663u ^
+                     std::size_t(cell.z) * 83492791u) &
+                    mask;
+    // Linear probing. Filled slots always have begin != end once the grid is
+    // built, and a non-zero count while it is being built
+    while (fSlots[i].begin != fSlots[i].end && !(fSlots[i].cell == cell))
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  // ---------------------------------------------------------------------------
+  ArrayRange<const unsigned int> SpaceChargeGrid::Find(const Cell& cell) const
+  {
+    const Slot& slot = fSlots[SlotOf(cell)];
+    return {fMembers.data() + slot.begin, fMembers.data() + slot.end};
+  }
+
   class SpacePointSolver : public art::EDProducer {
   public:
     explicit SpacePointSolver(const fhicl::ParameterSet& pset);
@@ -54,13 +139,13 @@ namespace reco3d {
     void produce(art::Event& evt) override;
     void beginJob() override;
 
-    void AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const;
+    void AddNeighbours(SolverSystem& sys) const;
 
     typedef std::map<const WireHit*, const recob::Hit*> HitMap_t;
 
     void BuildSystem(const std::vector<HitTriplet>& triplets,
+                     SolverSystem& sys,
                      std::vector<CollectionWireHit*>& cwires,
-                     std::vector<InductionWireHit*>& iwires,
                      std::vector<SpaceCharge*>& orphanSCs,
                      bool incNei,
                      HitMap_t& hitmap) const;
@@ -70,6 +155,8 @@ namespace reco3d {
                   double alpha,
                   int maxiterations);
 
+    void Minimize(ParallelSolver& solver, double alpha, int maxiterations);
+
     /// return whether the point was inserted (only happens when it has charge)
     bool AddSpacePoint(const SpaceCharge& sc,
                        int id,
@@ -99,9 +186,12 @@ namespace reco3d {
     int fMaxIterationsNoReg;
     int fMaxIterationsReg;
 
+    bool fParallelSolver; ///< Iterate the system with a ParallelSolver
+
     double fXHitOffset;
 
     const geo::GeometryCore* geom;
+    std::unique_ptr<const ChannelWireMap> fChanMap; ///< Geometry of each channel, for TripletFinder
     std::unique_ptr<reco3d::IHitReader> fHitReader; ///<  Expt specific tool for reading hits
   };
 
@@ -119,6 +209,7 @@ namespace reco3d {
     , fDistThreshDrift(pset.get<double>("WireIntersectThresholdDriftDir"))
     , fMaxIterationsNoReg(pset.get<int>("MaxIterationsNoReg"))
     , fMaxIterationsReg(pset.get<int>("MaxIterationsReg"))
+    , fParallelSolver(pset.get<bool>("ParallelSolver", false))
     , fXHitOffset(pset.get<double>("XHitOffset"))
   {
     recob::ChargedSpacePointCollectionCreator::produces(producesCollector(), "pre");
@@ -135,109 +226,91 @@ namespace reco3d {
   void SpacePointSolver::beginJob()
   {
     geom = art::ServiceHandle<geo::Geometry const>()->provider();
+    fChanMap = std::make_unique<const ChannelWireMap>(*geom);
   }
 
   // ---------------------------------------------------------------------------
-  void SpacePointSolver::AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
+  void SpacePointSolver::AddNeighbours(SolverSystem& sys) const
   {
     static const double kCritDist = 5;
 
-    // Could use a QuadTree or VPTree etc, but seems like overkill
-    class IntCoord {
-    public:
-      IntCoord(const SpaceCharge& sc)
-        : fX(sc.fX / kCritDist), fY(sc.fY / kCritDist), fZ(sc.fZ / kCritDist)
-      {}
-
-      bool operator<(const IntCoord& i) const
-      {
-        return std::make_tuple(fX, fY, fZ) < std::make_tuple(i.fX, i.fY, i.fZ);
-      }
-
-      std::vector<IntCoord> Neighbours() const
-      {
-        std::vector<IntCoord> ret;
-        for (int dx = -1; dx <= +1; ++dx) {
-          for (int dy = -1; dy <= +1; ++dy) {
-            for (int dz = -1; dz <= +1; ++dz) {
-              ret.push_back(IntCoord(fX + dx, fY + dy, fZ + dz));
-            }
-          }
-        }
-        return ret;
-      }
+    std::vector<SpaceCharge>& spaceCharges = sys.fSpaceCharges;
 
-    protected:
-      IntCoord(int x, int y, int z) : fX(x), fY(y), fZ(z) {}
-
-      int fX, fY, fZ;
-    };
-
-    std::map<IntCoord, std::vector<SpaceCharge*>> scMap;
-    for (SpaceCharge* sc : spaceCharges) {
-      scMap[IntCoord(*sc)].push_back(sc);
-    }
+    SpaceChargeGrid grid(spaceCharges, kCritDist);
 
     std::cout << "Neighbour search..." << std::endl;
 
-    // Now that we know all the space charges, can go through and assign neighbours
+    // Now that we know all the space charges, can go through and assign
+    // neighbours. The lists are built one after another into the single array,
+    // and the ranges set once it has stopped growing
+    std::vector<std::size_t> offsets;
+    offsets.reserve(spaceCharges.size() + 1);
+    sys.fNeighbours.clear();
 
     int Ntests = 0;
-    int Nnei = 0;
-    for (SpaceCharge* sc1 : spaceCharges) {
-      IntCoord ic(*sc1);
-      for (IntCoord icn : ic.Neighbours()) {
-        for (SpaceCharge* sc2 : scMap[icn]) {
-
-          ++Ntests;
-
-          if (sc1 == sc2) continue;
-          double dist2 =
-            cet::sum_of_squares(sc1->fX - sc2->fX, sc1->fY - sc2->fY, sc1->fZ - sc2->fZ);
-
-          if (dist2 > cet::square(kCritDist)) continue;
-
-          if (dist2 == 0) {
-            std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
-            std::cout << sc1->fCWire << " " << sc1->fWire1 << " " << sc1->fWire2 << std::endl;
-            std::cout << sc2->fCWire << " " << sc2->fWire1 << " " << sc2->fWire2 << std::endl;
-            std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " "
-                      << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-            continue;
-            dist2 = cet::square(kCritDist);
-          }
-
-          ++Nnei;
-
-          // This is a pretty random guess
-          const double coupling = exp(-sqrt(dist2) / 2);
-          sc1->fNeighbours.emplace_back(sc2, coupling);
-
-          if (isnan(1 / sqrt(dist2)) || isinf(1 / sqrt(dist2))) {
-            std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " "
-                      << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-            abort();
+    for (SpaceCharge& sc1 : spaceCharges) {
+      offsets.push_back(sys.fNeighbours.size());
+
+      const SpaceChargeGrid::Cell cell = grid.CellOf(sc1);
+      for (int dx = -1; dx <= +1; ++dx) {
+        for (int dy = -1; dy <= +1; ++dy) {
+          for (int dz = -1; dz <= +1; ++dz) {
+            for (unsigned int idx2 : grid.Find({cell.x + dx, cell.y + dy, cell.z + dz})) {
+              SpaceCharge* sc2 = &spaceCharges[idx2];
+
+              ++Ntests;
+
+              if (&sc1 == sc2) continue;
+              double dist2 =
+                cet::sum_of_squares(sc1.fX - sc2->fX, sc1.fY - sc2->fY, sc1.fZ - sc2->fZ);
+
+              if (dist2 > cet::square(kCritDist)) continue;
+
+              if (dist2 == 0) {
+                std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
+                std::cout << sc1.fCWire << " " << sc1.fWire1 << " " << sc1.fWire2 << std::endl;
+                std::cout << sc2->fCWire << " " << sc2->fWire1 << " " << sc2->fWire2 << std::endl;
+                std::cout << dist2 << " " << sc1.fX << " " << sc2->fX << " " << sc1.fY << " "
+                          << sc2->fY << " " << sc1.fZ << " " << sc2->fZ << std::endl;
+                continue;
+              }
+
+              // This is a pretty random guess
+              const double coupling = exp(-sqrt(dist2) / 2);
+              sys.fNeighbours.emplace_back(sc2, coupling);
+
+              if (isnan(1 / sqrt(dist2)) || isinf(1 / sqrt(dist2))) {
+                std::cout << dist2 << " " << sc1.fX << " " << sc2->fX << " " << sc1.fY << " "
+                          << sc2->fY << " " << sc1.fZ << " " << sc2->fZ << std::endl;
+                abort();
+              }
+            } // end for sc2
           }
-        } // end for sc2
-      }   // end for icn
-
-      // The neighbours lists use the most memory, so be careful to trim
-      sc1->fNeighbours.shrink_to_fit();
-    } // end for sc1
-
-    for (SpaceCharge* sc : spaceCharges) {
-      for (Neighbour& nei : sc->fNeighbours) {
-        sc->fNeiPotential += nei.fCoupling * nei.fSC->fPred;
+        }
+      } // end for neighbouring cells
+    }   // end for sc1
+    offsets.push_back(sys.fNeighbours.size());
+
+    // The neighbours lists use the most memory, so be careful to trim
+    sys.fNeighbours.shrink_to_fit();
+
+    Neighbour* neighbours = sys.fNeighbours.data();
+    for (std::size_t i = 0; i < spaceCharges.size(); ++i) {
+      SpaceCharge& sc = spaceCharges[i];
+      sc.fNeighbours = {neighbours + offsets[i], neighbours + offsets[i + 1]};
+      for (Neighbour& nei : sc.fNeighbours) {
+        sc.fNeiPotential += nei.fCoupling * nei.fSC->fPred;
       }
     }
 
-    std::cout << Ntests << " tests to find " << Nnei << " neighbours" << std::endl;
+    std::cout << Ntests << " tests to find " << sys.fNeighbours.size() << " neighbours"
+              << std::endl;
   }
 
   // ---------------------------------------------------------------------------
   void SpacePointSolver::BuildSystem(const std::vector<HitTriplet>& triplets,
+                                     SolverSystem& sys,
                                      std::vector<CollectionWireHit*>& cwires,
-                                     std::vector<InductionWireHit*>& iwires,
                                      std::vector<SpaceCharge*>& orphanSCs,
                                      bool incNei,
                                      HitMap_t& hitmap) const
@@ -250,78 +323,93 @@ namespace reco3d {
       if (trip.v) ihits.insert(trip.v);
     }
 
+    sys.fIWires.reserve(ihits.size());
     std::map<const recob::Hit*, InductionWireHit*> inductionMap;
     for (const recob::Hit* hit : ihits) {
-      InductionWireHit* iwire = new InductionWireHit(hit->Channel(), hit->Integral());
+      InductionWireHit* iwire = &sys.fIWires.emplace_back(hit->Channel(), hit->Integral());
       inductionMap[hit] = iwire;
-      iwires.emplace_back(iwire);
       hitmap[iwire] = hit;
     }
 
-    std::map<const recob::Hit*, std::vector<SpaceCharge*>> collectionMap;
-    std::map<const recob::Hit*, std::vector<SpaceCharge*>> collectionMapBad;
+    // Indices of the triplets on each collection hit
+    std::map<const recob::Hit*, std::vector<std::size_t>> collectionMap;
+    std::map<const recob::Hit*, std::vector<std::size_t>> collectionMapBad;
 
     std::set<InductionWireHit*> satisfiedInduction;
 
-    for (const HitTriplet& trip : triplets) {
-      // Don't have a cwire object yet, set it later
-      SpaceCharge* sc = new SpaceCharge(
-        trip.pt.x, trip.pt.y, trip.pt.z, 0, inductionMap[trip.u], inductionMap[trip.v]);
-
+    for (std::size_t i = 0; i < triplets.size(); ++i) {
+      const HitTriplet& trip = triplets[i];
       if (trip.u && trip.v) {
-        collectionMap[trip.x].push_back(sc);
+        collectionMap[trip.x].push_back(i);
         if (trip.x) {
           satisfiedInduction.insert(inductionMap[trip.u]);
           satisfiedInduction.insert(inductionMap[trip.v]);
         }
       }
       else {
-        collectionMapBad[trip.x].push_back(sc);
+        collectionMapBad[trip.x].push_back(i);
       }
     }
 
-    std::vector<SpaceCharge*> spaceCharges;
-
+    // Decide which triplets become space charges before making any of them, so
+    // that the arrays are only allocated once
+    std::vector<std::pair<const recob::Hit*, const std::vector<std::size_t>*>> wireTriplets;
+    std::size_t nCrossings = 0;
     for (const recob::Hit* hit : chits) {
       // Find the space charges associated with this hit
-      std::vector<SpaceCharge*>& scs = collectionMap[hit];
-      if (scs.empty()) {
+      const std::vector<std::size_t>* trips = &collectionMap[hit];
+      if (trips->empty()) {
         // If there are no full triplets try the triplets with one bad channel
-        scs = collectionMapBad[hit];
-      }
-      else {
-        // If there were good triplets, delete the bad hit ones
-        for (SpaceCharge* sc : collectionMapBad[hit])
-          delete sc;
+        trips = &collectionMapBad[hit];
       }
       // Still no space points, don't bother making a wire
-      if (scs.empty()) continue;
+      if (trips->empty()) continue;
 
-      CollectionWireHit* cwire = new CollectionWireHit(hit->Channel(), hit->Integral(), scs);
-      hitmap[cwire] = hit;
-      cwires.push_back(cwire);
-      spaceCharges.insert(spaceCharges.end(), scs.begin(), scs.end());
-      for (SpaceCharge* sc : scs)
-        sc->fCWire = cwire;
+      wireTriplets.emplace_back(hit, trips);
+      nCrossings += trips->size();
     } // end for hit
 
     // Space charges whose collection wire is bad, which we have no other way of
     // addressing.
-    for (SpaceCharge* sc : collectionMap[0]) {
+    std::vector<std::size_t> orphanTriplets;
+    for (std::size_t i : collectionMap[0]) {
       // Only count orphans where an induction wire has no other explanation
-      if (satisfiedInduction.count(sc->fWire1) == 0 || satisfiedInduction.count(sc->fWire2) == 0) {
-        orphanSCs.push_back(sc);
-      }
-      else {
-        delete sc;
+      if (satisfiedInduction.count(inductionMap[triplets[i].u]) == 0 ||
+          satisfiedInduction.count(inductionMap[triplets[i].v]) == 0) {
+        orphanTriplets.push_back(i);
       }
     }
-    spaceCharges.insert(spaceCharges.end(), orphanSCs.begin(), orphanSCs.end());
+
+    sys.fSpaceCharges.reserve(nCrossings + orphanTriplets.size());
+    sys.fCrossings.reserve(nCrossings);
+    sys.fCWires.reserve(wireTriplets.size());
+
+    auto makeSpaceCharge = [&](const HitTriplet& trip) {
+      // Don't have a cwire object yet, set it later
+      return &sys.fSpaceCharges.emplace_back(
+        trip.pt.x, trip.pt.y, trip.pt.z, nullptr, inductionMap[trip.u], inductionMap[trip.v]);
+    };
+
+    for (const auto& [hit, trips] : wireTriplets) {
+      SpaceCharge** first = sys.fCrossings.data() + sys.fCrossings.size();
+      for (std::size_t i : *trips)
+        sys.fCrossings.push_back(makeSpaceCharge(triplets[i]));
+      const ArrayRange<SpaceCharge*> scs(first, first + trips->size());
+
+      CollectionWireHit* cwire = &sys.fCWires.emplace_back(hit->Channel(), hit->Integral(), scs);
+      hitmap[cwire] = hit;
+      cwires.push_back(cwire);
+      for (SpaceCharge* sc : scs)
+        sc->fCWire = cwire;
+    }
+
+    for (std::size_t i : orphanTriplets)
+      orphanSCs.push_back(makeSpaceCharge(triplets[i]));
 
     std::cout << cwires.size() << " collection wire objects" << std::endl;
-    std::cout << spaceCharges.size() << " potential space points" << std::endl;
+    std::cout << sys.fSpaceCharges.size() << " potential space points" << std::endl;
 
-    if (incNei) AddNeighbours(spaceCharges);
+    if (incNei) AddNeighbours(sys);
   }
 
   // ---------------------------------------------------------------------------
@@ -412,6 +500,27 @@ namespace reco3d {
     }
   }
 
+  // ---------------------------------------------------------------------------
+  void SpacePointSolver::Minimize(ParallelSolver& solver, double alpha, int maxiterations)
+  {
+    double prevMetric = solver.Reset(alpha);
+    std::cout << "Begin: " << prevMetric << std::endl;
+    for (int i = 0; i < maxiterations; ++i) {
+      double metric = solver.Iterate(alpha);
+      // The metric tracked by the solver drifts, take the exact one before
+      // stopping on it
+      if (metric > prevMetric || fabs(metric - prevMetric) < 1e-3 * fabs(prevMetric))
+        metric = solver.Reset(alpha);
+      std::cout << i << " " << metric << std::endl;
+      if (metric > prevMetric) {
+        std::cout << "Warning: metric increased" << std::endl;
+        return;
+      }
+      if (fabs(metric - prevMetric) < 1e-3 * fabs(prevMetric)) return;
+      prevMetric = metric;
+    }
+  }
+
   // ---------------------------------------------------------------------------
   void SpacePointSolver::produce(art::Event& evt)
   {
@@ -458,9 +567,9 @@ namespace reco3d {
     std::cout << xbadchans.size() << " X, " << ubadchans.size() << " U, " << vbadchans.size()
               << " V bad channels" << std::endl;
 
+    // Owns all the objects below
+    SolverSystem system;
     std::vector<CollectionWireHit*> cwires;
-    // So we can find them all to free the memory
-    std::vector<InductionWireHit*> iwires;
     // Nodes with a bad collection wire that we otherwise can't address
     std::vector<SpaceCharge*> orphanSCs;
 
@@ -471,6 +580,7 @@ namespace reco3d {
     if (is2view) {
       std::cout << "Finding 2-view coincidences..." << std::endl;
       TripletFinder tf(detProp,
+                       *fChanMap,
                        xhits,
                        uhits,
                        {},
@@ -480,11 +590,12 @@ namespace reco3d {
                        fDistThresh,
                        fDistThreshDrift,
                        fXHitOffset);
-      BuildSystem(tf.TripletsTwoView(), cwires, iwires, orphanSCs, fAlpha != 0, hitmap);
+      BuildSystem(tf.TripletsTwoView(), system, cwires, orphanSCs, fAlpha != 0, hitmap);
     }
     else {
       std::cout << "Finding XUV coincidences..." << std::endl;
       TripletFinder tf(detProp,
+                       *fChanMap,
                        xhits,
                        uhits,
                        vhits,
@@ -494,33 +605,39 @@ namespace reco3d {
                        fDistThresh,
                        fDistThreshDrift,
                        fXHitOffset);
-      BuildSystem(tf.Triplets(), cwires, iwires, orphanSCs, fAlpha != 0, hitmap);
+      BuildSystem(tf.Triplets(), system, cwires, orphanSCs, fAlpha != 0, hitmap);
     }
 
     FillSystemToSpacePoints(cwires, orphanSCs, spcol_pre);
     spcol_pre.put();
 
     if (fFit) {
+      std::unique_ptr<ParallelSolver> solver;
+      if (fParallelSolver) {
+        solver = std::make_unique<ParallelSolver>(cwires, orphanSCs);
+        std::cout << solver->NComponents() << " independent components, up to "
+                  << solver->NColours() << " colours" << std::endl;
+      }
+
       std::cout << "Iterating with no regularization..." << std::endl;
-      Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
+      if (solver)
+        Minimize(*solver, 0, fMaxIterationsNoReg);
+      else
+        Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
 
       FillSystemToSpacePoints(cwires, orphanSCs, spcol_noreg);
       spcol_noreg.put();
 
       std::cout << "Now with regularization..." << std::endl;
-      Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
+      if (solver)
+        Minimize(*solver, fAlpha, fMaxIterationsReg);
+      else
+        Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
 
       FillSystemToSpacePointsAndAssns(hitlist, cwires, orphanSCs, hitmap, spcol, *assns);
       spcol.put();
       evt.put(std::move(assns));
     } // end if fFit
-
-    for (InductionWireHit* i : iwires)
-      delete i;
-    for (CollectionWireHit* c : cwires)
-      delete c;
-    for (SpaceCharge* s : orphanSCs)
-      delete s;
   }
 
 } // end namespace reco3d
@@ -8,9 +8,48 @@
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
 
+#include "tbb/parallel_for.h"
+
+#include <iostream>
+#include <sstream>
+
 namespace reco3d {
+  // -------------------------------------------------------------------------
+  ChannelWireMap::ChannelWireMap(const geo::GeometryCore& geom)
+  {
+    const unsigned int nchan = geom.Nchannels();
+    fTPCOffsets.reserve(nchan + 1);
+    fWireOffsets.reserve(nchan + 1);
+    fCollection.reserve(nchan);
+
+    for (raw::ChannelID_t chan = 0; chan < nchan; ++chan) {
+      fTPCOffsets.push_back(fTPCs.size());
+      for (geo::TPCID tpc : geom.ROPtoTPCs(geom.ChannelToROP(chan)))
+        fTPCs.push_back(tpc);
+
+      fWireOffsets.push_back(fWires.size());
+      for (geo::WireID wire : geom.ChannelToWire(chan))
+        fWires.push_back(wire);
+
+      fCollection.push_back(geom.SignalType(chan) == geo::kCollection);
+    }
+    fTPCOffsets.push_back(fTPCs.size());
+    fWireOffsets.push_back(fWires.size());
+  }
+
+  // -------------------------------------------------------------------------
+  /// The entry of a per-TPC map, without inserting one if it is missing
+  template <class T>
+  const std::vector<T>& AtTPC(const std::map<geo::TPCID, std::vector<T>>& m, geo::TPCID tpc)
+  {
+    static const std::vector<T> empty;
+    const auto it = m.find(tpc);
+    return it == m.end() ? empty : it->second;
+  }
+
   // -------------------------------------------------------------------------
   TripletFinder::TripletFinder(const detinfo::DetectorPropertiesData& detProp,
+                               const ChannelWireMap& chanMap,
                                const std::vector<art::Ptr<recob::Hit>>& xhits,
                                const std::vector<art::Ptr<recob::Hit>>& uhits,
                                const std::vector<art::Ptr<recob::Hit>>& vhits,
@@ -21,6 +60,7 @@ namespace reco3d {
                                double distThreshDrift,
                                double xhitOffset)
     : geom(art::ServiceHandle<geo::Geometry const>()->provider())
+    , fChanMap(chanMap)
     , fDistThresh(distThresh)
     , fDistThreshDrift(distThreshDrift)
     , fXHitOffset(xhitOffset)
@@ -40,12 +80,13 @@ namespace reco3d {
                                  std::map<geo::TPCID, std::vector<HitOrChan>>& out)
   {
     for (const art::Ptr<recob::Hit>& hit : hits) {
-      for (geo::TPCID tpc : geom->ROPtoTPCs(geom->ChannelToROP(hit->Channel()))) {
+      const raw::ChannelID_t chan = hit->Channel();
+      for (geo::TPCID tpc : fChanMap.TPCs(chan)) {
         double xpos = 0;
-        for (geo::WireID wire : geom->ChannelToWire(hit->Channel())) {
+        for (geo::WireID wire : fChanMap.Wires(chan)) {
           if (geo::TPCID(wire) == tpc) {
             xpos = detProp.ConvertTicksToX(hit->PeakTime(), wire);
-            if (geom->SignalType(wire) == geo::kCollection) xpos += fXHitOffset;
+            if (fChanMap.IsCollection(chan)) xpos += fXHitOffset;
           }
         }
 
@@ -61,7 +102,7 @@ namespace reco3d {
                                  std::map<geo::TPCID, std::vector<raw::ChannelID_t>>& out)
   {
     for (raw::ChannelID_t chan : bads) {
-      for (geo::TPCID tpc : geom->ROPtoTPCs(geom->ChannelToROP(chan))) {
+      for (geo::TPCID tpc : fChanMap.TPCs(chan)) {
         out[tpc].push_back(chan);
       }
     }
@@ -70,8 +111,8 @@ namespace reco3d {
   // -------------------------------------------------------------------------
   class IntersectionCache {
   public:
-    IntersectionCache(geo::TPCID tpc)
-      : geom(art::ServiceHandle<geo::Geometry const>()->provider()), fTPC(tpc)
+    IntersectionCache(const geo::GeometryCore* g, const ChannelWireMap& chanMap, geo::TPCID tpc)
+      : geom(g), fChanMap(chanMap), fTPC(tpc)
     {}
 
     bool operator()(raw::ChannelID_t a, raw::ChannelID_t b, geo::WireIDIntersection& pt)
@@ -93,9 +134,9 @@ namespace reco3d {
   protected:
     bool ISect(raw::ChannelID_t chanA, raw::ChannelID_t chanB, geo::WireIDIntersection& pt) const
     {
-      for (geo::WireID awire : geom->ChannelToWire(chanA)) {
+      for (geo::WireID awire : fChanMap.Wires(chanA)) {
         if (geo::TPCID(awire) != fTPC) continue;
-        for (geo::WireID bwire : geom->ChannelToWire(chanB)) {
+        for (geo::WireID bwire : fChanMap.Wires(chanB)) {
           if (geo::TPCID(bwire) != fTPC) continue;
 
           if (geom->WireIDsIntersect(awire, bwire, pt)) return true;
@@ -106,6 +147,7 @@ namespace reco3d {
     }
 
     const geo::GeometryCore* geom;
+    const ChannelWireMap& fChanMap;
 
     std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, bool> fMap;
     std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, geo::WireIDIntersection> fPtMap;
@@ -143,128 +185,173 @@ namespace reco3d {
   }
 
   // -------------------------------------------------------------------------
-  std::vector<HitTriplet> TripletFinder::Triplets()
+  /// Run \a f on each TPC concurrently and concatenate the results, and
+  /// anything they print, in TPC order
+  template <class F>
+  std::vector<HitTriplet> ForEachTPC(const std::map<geo::TPCID, std::vector<HitOrChan>>& hits,
+                                     F&& f)
   {
+    std::vector<geo::TPCID> tpcs;
+    for (const auto& it : hits)
+      tpcs.push_back(it.first);
+
+    std::vector<std::vector<HitTriplet>> ret_by_tpc(tpcs.size());
+    std::vector<std::ostringstream> log_by_tpc(tpcs.size());
+    tbb::parallel_for(std::size_t(0), tpcs.size(), [&](std::size_t i) {
+      ret_by_tpc[i] = f(tpcs[i], log_by_tpc[i]);
+    });
+
+    for (const std::ostringstream& log : log_by_tpc)
+      std::cout << log.str();
+
+    std::size_t ntot = 0;
+    for (const std::vector<HitTriplet>& trips : ret_by_tpc)
+      ntot += trips.size();
+
     std::vector<HitTriplet> ret;
+    ret.reserve(ntot);
+    for (const std::vector<HitTriplet>& trips : ret_by_tpc)
+      ret.insert(ret.end(), trips.begin(), trips.end());
 
-    for (const auto& it : fX_by_tpc) {
-      const geo::TPCID& tpc = it.first;
+    return ret;
+  }
 
-      std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
-      std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::Triplets() const
+  {
+    std::vector<HitTriplet> ret =
+      ForEachTPC(fX_by_tpc, [this](geo::TPCID tpc, std::ostream& log) {
+        return TripletsInTPC(tpc, log);
+      });
 
-      // Cache to prevent repeating the same questions
-      IntersectionCache isectUV(tpc);
+    std::cout << ret.size() << " XUVs total" << std::endl;
 
-      // For the efficient looping below to work we need to sort the doublet
-      // lists so the X hits occur in the same order.
-      std::sort(xus.begin(), xus.end(), LessThanXHit);
-      std::sort(xvs.begin(), xvs.end(), LessThanXHit);
+    return ret;
+  }
 
-      auto xvit_begin = xvs.begin();
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::TripletsInTPC(geo::TPCID tpc, std::ostream& log) const
+  {
+    std::vector<HitTriplet> ret;
 
-      int nxuv = 0;
-      for (const ChannelDoublet& xu : xus) {
-        const HitOrChan& x = xu.a;
-        const HitOrChan& u = xu.b;
+    std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
+    std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
 
-        // Catch up until we're looking at the same X hit in XV
-        while (xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu))
-          ++xvit_begin;
+    // Cache to prevent repeating the same questions
+    IntersectionCache isectUV(geom, fChanMap, tpc);
 
-        // Loop through all those matching hits
-        for (auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit) {
-          const HitOrChan& v = xvit->b;
+    // For the efficient looping below to work we need to sort the doublet
+    // lists so the X hits occur in the same order.
+    std::sort(xus.begin(), xus.end(), LessThanXHit);
+    std::sort(xvs.begin(), xvs.end(), LessThanXHit);
 
-          // Only allow one bad channel per triplet
-          if (!x.hit && !u.hit) continue;
-          if (!x.hit && !v.hit) continue;
-          if (!u.hit && !v.hit) continue;
+    auto xvit_begin = xvs.begin();
 
-          if (u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
+    int nxuv = 0;
+    for (const ChannelDoublet& xu : xus) {
+      const HitOrChan& x = xu.a;
+      const HitOrChan& u = xu.b;
 
-          geo::WireIDIntersection ptUV;
-          if (!isectUV(u.chan, v.chan, ptUV)) continue;
+      // Catch up until we're looking at the same X hit in XV
+      while (xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu))
+        ++xvit_begin;
 
-          if (!CloseSpace(xu.pt, xvit->pt) || !CloseSpace(xu.pt, ptUV) ||
-              !CloseSpace(xvit->pt, ptUV))
-            continue;
+      // Loop through all those matching hits
+      for (auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit) {
+        const HitOrChan& v = xvit->b;
 
-          double xavg = 0;
-          int nx = 0;
-          if (x.hit) {
-            xavg += x.xpos;
-            ++nx;
-          }
-          if (u.hit) {
-            xavg += u.xpos;
-            ++nx;
-          }
-          if (v.hit) {
-            xavg += v.xpos;
-            ++nx;
-          }
-          xavg /= nx;
+        // Only allow one bad channel per triplet
+        if (!x.hit && !u.hit) continue;
+        if (!x.hit && !v.hit) continue;
+        if (!u.hit && !v.hit) continue;
 
-          const XYZ pt{
-            xavg, (xu.pt.y + xvit->pt.y + ptUV.y) / 3, (xu.pt.z + xvit->pt.z + ptUV.z) / 3};
+        if (u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
 
-          ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
-          ++nxuv;
-        } // end for xv
-      }   // end for xu
+        geo::WireIDIntersection ptUV;
+        if (!isectUV(u.chan, v.chan, ptUV)) continue;
 
-      std::cout << tpc << " " << xus.size() << " XUs and " << xvs.size() << " XVs -> " << nxuv
-                << " XUVs" << std::endl;
+        if (!CloseSpace(xu.pt, xvit->pt) || !CloseSpace(xu.pt, ptUV) ||
+            !CloseSpace(xvit->pt, ptUV))
+          continue;
 
-    } // end for tpc
+        double xavg = 0;
+        int nx = 0;
+        if (x.hit) {
+          xavg += x.xpos;
+          ++nx;
+        }
+        if (u.hit) {
+          xavg += u.xpos;
+          ++nx;
+        }
+        if (v.hit) {
+          xavg += v.xpos;
+          ++nx;
+        }
+        xavg /= nx;
 
-    std::cout << ret.size() << " XUVs total" << std::endl;
+        const XYZ pt{
+          xavg, (xu.pt.y + xvit->pt.y + ptUV.y) / 3, (xu.pt.z + xvit->pt.z + ptUV.z) / 3};
+
+        ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
+        ++nxuv;
+      } // end for xv
+    }   // end for xu
+
+    log << tpc << " " << xus.size() << " XUs and " << xvs.size() << " XVs -> " << nxuv << " XUVs"
+        << std::endl;
 
     return ret;
   }
 
   // -------------------------------------------------------------------------
-  std::vector<HitTriplet> TripletFinder::TripletsTwoView()
+  std::vector<HitTriplet> TripletFinder::TripletsTwoView() const
   {
-    std::vector<HitTriplet> ret;
+    std::vector<HitTriplet> ret =
+      ForEachTPC(fX_by_tpc, [this](geo::TPCID tpc, std::ostream&) {
+        return TripletsTwoViewInTPC(tpc);
+      });
 
-    for (const auto& it : fX_by_tpc) {
-      const geo::TPCID& tpc = it.first;
+    std::cout << ret.size() << " XUs total" << std::endl;
 
-      std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
+    return ret;
+  }
 
-      for (const ChannelDoublet& xu : xus) {
-        const HitOrChan& x = xu.a;
-        const HitOrChan& u = xu.b;
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::TripletsTwoViewInTPC(geo::TPCID tpc) const
+  {
+    std::vector<HitTriplet> ret;
 
-        double xavg = x.xpos;
-        int nx = 1;
-        if (u.hit) {
-          xavg += u.xpos;
-          ++nx;
-        }
-        xavg /= nx;
+    std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
 
-        const XYZ pt{xavg, xu.pt.y, xu.pt.z};
+    for (const ChannelDoublet& xu : xus) {
+      const HitOrChan& x = xu.a;
+      const HitOrChan& u = xu.b;
 
-        ret.emplace_back(HitTriplet{x.hit, u.hit, 0, pt});
-      } // end for xu
-    }   // end for tpc
+      double xavg = x.xpos;
+      int nx = 1;
+      if (u.hit) {
+        xavg += u.xpos;
+        ++nx;
+      }
+      xavg /= nx;
 
-    std::cout << ret.size() << " XUs total" << std::endl;
+      const XYZ pt{xavg, xu.pt.y, xu.pt.z};
+
+      ret.emplace_back(HitTriplet{x.hit, u.hit, 0, pt});
+    } // end for xu
 
     return ret;
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret =
-      DoubletHelper(tpc, fX_by_tpc[tpc], fU_by_tpc[tpc], fUbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = DoubletHelper(
+      tpc, AtTPC(fX_by_tpc, tpc), AtTPC(fU_by_tpc, tpc), AtTPC(fUbad_by_tpc, tpc));
 
     // Find X(bad)+U(good) doublets, have to flip them for the final result
-    for (auto it : DoubletHelper(tpc, fU_by_tpc[tpc], {}, fXbad_by_tpc[tpc])) {
+    for (auto it : DoubletHelper(tpc, AtTPC(fU_by_tpc, tpc), {}, AtTPC(fXbad_by_tpc, tpc))) {
       ret.push_back({it.b, it.a, it.pt});
     }
 
@@ -272,13 +359,13 @@ namespace reco3d {
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret =
-      DoubletHelper(tpc, fX_by_tpc[tpc], fV_by_tpc[tpc], fVbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = DoubletHelper(
+      tpc, AtTPC(fX_by_tpc, tpc), AtTPC(fV_by_tpc, tpc), AtTPC(fVbad_by_tpc, tpc));
 
     // Find X(bad)+V(good) doublets, have to flip them for the final result
-    for (auto it : DoubletHelper(tpc, fV_by_tpc[tpc], {}, fXbad_by_tpc[tpc])) {
+    for (auto it : DoubletHelper(tpc, AtTPC(fV_by_tpc, tpc), {}, AtTPC(fXbad_by_tpc, tpc))) {
       ret.push_back({it.b, it.a, it.pt});
     }
 
@@ -294,7 +381,7 @@ namespace reco3d {
   {
     std::vector<ChannelDoublet> ret;
 
-    IntersectionCache isect(tpc);
+    IntersectionCache isect(geom, fChanMap, tpc);
 
     auto b_begin = bhits.begin();
 
@@ -8,6 +8,7 @@
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "lardataobj/RecoBase/Hit.h"
+#include "larreco/SpacePointSolver/ArrayRange.h"
 namespace detinfo {
   class DetectorPropertiesData;
 }
@@ -15,6 +16,7 @@ namespace geo {
   class GeometryCore;
 }
 
+#include <iosfwd>
 #include <map>
 #include <vector>
 
@@ -48,9 +50,43 @@ namespace reco3d {
     XYZ pt;
   };
 
+  /// The answers to the geometry questions TripletFinder asks about each
+  /// channel, worked out once per job rather than for every hit of every event
+  class ChannelWireMap {
+  public:
+    explicit ChannelWireMap(const geo::GeometryCore& geom);
+
+    /// The TPCs read out by the channel's readout plane, as ROPtoTPCs()
+    ArrayRange<const geo::TPCID> TPCs(raw::ChannelID_t chan) const
+    {
+      if (chan >= fCollection.size()) return {};
+      return {fTPCs.data() + fTPCOffsets[chan], fTPCs.data() + fTPCOffsets[chan + 1]};
+    }
+
+    /// The wires read out by the channel, as ChannelToWire()
+    ArrayRange<const geo::WireID> Wires(raw::ChannelID_t chan) const
+    {
+      if (chan >= fCollection.size()) return {};
+      return {fWires.data() + fWireOffsets[chan], fWires.data() + fWireOffsets[chan + 1]};
+    }
+
+    bool IsCollection(raw::ChannelID_t chan) const
+    {
+      return chan < fCollection.size() && fCollection[chan];
+    }
+
+  protected:
+    std::vector<geo::TPCID> fTPCs;
+    std::vector<unsigned int> fTPCOffsets;
+    std::vector<geo::WireID> fWires;
+    std::vector<unsigned int> fWireOffsets;
+    std::vector<bool> fCollection;
+  };
+
   class TripletFinder {
   public:
     TripletFinder(const detinfo::DetectorPropertiesData& detProp,
+                  const ChannelWireMap& chanMap,
                   const std::vector<art::Ptr<recob::Hit>>& xhits,
                   const std::vector<art::Ptr<recob::Hit>>& uhits,
                   const std::vector<art::Ptr<recob::Hit>>& vhits,
@@ -61,12 +97,14 @@ namespace reco3d {
                   double distThreshDrift,
                   double xhitOffset);
 
-    std::vector<HitTriplet> Triplets();
+    /// The TPCs are searched concurrently. The result is in TPC order
+    std::vector<HitTriplet> Triplets() const;
     /// Only search for XU intersections
-    std::vector<HitTriplet> TripletsTwoView();
+    std::vector<HitTriplet> TripletsTwoView() const;
 
   protected:
     const geo::GeometryCore* geom;
+    const ChannelWireMap& fChanMap;
 
     /// Helper for constructor
     void FillHitMap(const detinfo::DetectorPropertiesData& clockData,
@@ -79,8 +117,11 @@ namespace reco3d {
     bool CloseDrift(double xa, double xb) const;
     bool CloseSpace(geo::WireIDIntersection ra, geo::WireIDIntersection rb) const;
 
-    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc);
-    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc);
+    std::vector<HitTriplet> TripletsInTPC(geo::TPCID tpc, std::ostream& log) const;
+    std::vector<HitTriplet> TripletsTwoViewInTPC(geo::TPCID tpc) const;
+
+    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc) const;
+    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc) const;
 
     std::vector<ChannelDoublet> DoubletHelper(geo::TPCID tpc,
                                               const std::vector<HitOrChan>& ahits,
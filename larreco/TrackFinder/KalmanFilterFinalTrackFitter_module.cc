@@ -340,12 +340,18 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
     assocVertices =
       std::make_unique<art::FindManyP<recob::Vertex>>(inputPFParticle, e, pfParticleInputTag);
 
-    for (unsigned int iPF = 0; iPF < inputPFParticle->size(); ++iPF) {
-
-      if (p_().options().trackFromPF()) {
+    // the tracks of all PFParticles are fitted in one batch, the outputs are then filled in the
+    // original order in the loop below
+    std::vector<TrackKalmanFitter::TrackSeed> seeds;
+    std::vector<char> fitok;
+    std::vector<recob::Track> fitTracks;
+    std::vector<std::vector<art::Ptr<recob::Hit>>> fitHits;
+    std::vector<trkmkr::OptionalOutputs> fitOptionals;
+    if (p_().options().trackFromPF()) {
+      auto const& tkHitsAssn =
+        *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(pfParticleInputTag);
+      for (unsigned int iPF = 0; iPF < inputPFParticle->size(); ++iPF) {
         const std::vector<art::Ptr<recob::Track>>& tracks = assocTracks->at(iPF);
-        auto const& tkHitsAssn =
-          *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(pfParticleInputTag);
         const std::vector<art::Ptr<recob::Vertex>>& vertices = assocVertices->at(iPF);
 
         if (p_().options().pFromCalo()) {
@@ -369,26 +375,41 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
               break;
           }
 
-          recob::Track outTrack;
-          std::vector<art::Ptr<recob::Hit>> outHits;
-          trkmkr::OptionalOutputs optionals;
-          if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-          bool fitok = kalmanFitter.fitTrack(detProp,
-                                             track.Trajectory(),
-                                             track.ID(),
-                                             track.VertexCovarianceLocal5D(),
-                                             track.EndCovarianceLocal5D(),
-                                             inHits,
-                                             mom,
-                                             pId,
-                                             flipDir,
-                                             outTrack,
-                                             outHits,
-                                             optionals);
-          if (!fitok) continue;
+          seeds.push_back({&track.Trajectory(),
+                           track.ID(),
+                           track.VertexCovarianceLocal5D(),
+                           track.EndCovarianceLocal5D(),
+                           std::move(inHits),
+                           mom,
+                           pId,
+                           flipDir});
+        }
+      }
+      kalmanFitter.fitTracks(detProp,
+                             seeds,
+                             p_().options().produceTrackFitHitInfo(),
+                             fitok,
+                             fitTracks,
+                             fitHits,
+                             fitOptionals);
+    }
+
+    size_t iSeed = 0;
+    for (unsigned int iPF = 0; iPF < inputPFParticle->size(); ++iPF) {
+
+      if (p_().options().trackFromPF()) {
+        const std::vector<art::Ptr<recob::Track>>& tracks = assocTracks->at(iPF);
+
+        for (unsigned int iTrack = 0; iTrack < tracks.size(); ++iTrack, ++iSeed) {
+          if (!fitok[iSeed]) continue;
+
+          recob::Track& outTrack = fitTracks[iSeed];
+          std::vector<art::Ptr<recob::Hit>>& outHits = fitHits[iSeed];
+          trkmkr::OptionalOutputs& optionals = fitOptionals[iSeed];
 
           if (p_().options().keepInputTrajectoryPoints()) {
-            restoreInputPoints(track.Trajectory().Trajectory(), inHits, outTrack, outHits);
+            restoreInputPoints(
+              tracks[iTrack]->Trajectory().Trajectory(), seeds[iSeed].hits, outTrack, outHits);
           }
 
           outputTracks->emplace_back(std::move(outTrack));
@@ -498,6 +519,8 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
       trackId = std::make_unique<art::FindManyP<anab::ParticleID>>(inputTracks, e, pidInputTag);
     }
 
+    std::vector<TrackKalmanFitter::TrackSeed> seeds;
+    seeds.reserve(inputTracks->size());
     for (unsigned int iTrack = 0; iTrack < inputTracks->size(); ++iTrack) {
 
       const recob::Track& track = inputTracks->at(iTrack);
@@ -515,26 +538,38 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
           break;
       }
 
-      recob::Track outTrack;
-      std::vector<art::Ptr<recob::Hit>> outHits;
-      trkmkr::OptionalOutputs optionals;
-      if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-      bool fitok = kalmanFitter.fitTrack(detProp,
-                                         track.Trajectory(),
-                                         track.ID(),
-                                         track.VertexCovarianceLocal5D(),
-                                         track.EndCovarianceLocal5D(),
-                                         inHits,
-                                         mom,
-                                         pId,
-                                         flipDir,
-                                         outTrack,
-                                         outHits,
-                                         optionals);
-      if (!fitok) continue;
+      seeds.push_back({&track.Trajectory(),
+                       track.ID(),
+                       track.VertexCovarianceLocal5D(),
+                       track.EndCovarianceLocal5D(),
+                       std::move(inHits),
+                       mom,
+                       pId,
+                       flipDir});
+    }
+
+    std::vector<char> fitok;
+    std::vector<recob::Track> fitTracks;
+    std::vector<std::vector<art::Ptr<recob::Hit>>> fitHits;
+    std::vector<trkmkr::OptionalOutputs> fitOptionals;
+    kalmanFitter.fitTracks(detProp,
+                           seeds,
+                           p_().options().produceTrackFitHitInfo(),
+                           fitok,
+                           fitTracks,
+                           fitHits,
+                           fitOptionals);
+
+    for (unsigned int iTrack = 0; iTrack < inputTracks->size(); ++iTrack) {
+      if (!fitok[iTrack]) continue;
+
+      recob::Track& outTrack = fitTracks[iTrack];
+      std::vector<art::Ptr<recob::Hit>>& outHits = fitHits[iTrack];
+      trkmkr::OptionalOutputs& optionals = fitOptionals[iTrack];
 
       if (p_().options().keepInputTrajectoryPoints()) {
-        restoreInputPoints(track.Trajectory().Trajectory(), inHits, outTrack, outHits);
+        restoreInputPoints(
+          inputTracks->at(iTrack).Trajectory().Trajectory(), seeds[iTrack].hits, outTrack, outHits);
       }
 
       outputTracks->emplace_back(std::move(outTrack));
@@ -87,11 +87,8 @@ void trkf::MCSFitProducer::produce(art::Event& e)
     throw cet::exception("MCSFitProducer")
       << "Cannot find input art::Handle with inputTag " << inputTag;
   const auto& inputVec = *(inputH.product());
-  for (const auto& element : inputVec) {
-    //fit
-    recob::MCSFitResult result = mcsfitter.fitMcs(element);
-    output->emplace_back(std::move(result));
-  }
+  //fit, the tracks are processed in parallel and the results kept in input order
+  *output = mcsfitter.fitMcs(inputVec);
   e.put(std::move(output));
 }
 
@@ -57,6 +57,7 @@
 #include "lardataobj/RecoBase/Track.h"
 #include "lardataobj/RecoBase/TrackHitMeta.h"
 #include "lardataobj/RecoBase/Vertex.h"
+#include "larreco/Monitoring/StageMonitorService.h"
 #include "larreco/RecoAlg/PMAlgStitching.h"
 #include "larreco/RecoAlg/PMAlgTracking.h"
 #include "larreco/RecoAlg/PMAlgVertexing.h"
@@ -158,6 +159,13 @@ namespace trkf {
 
     // histograms created only for the calibration of the ADC-based track validation mode
     std::vector<TH1F*> fAdcInPassingPoints, fAdcInRejectedPoints;
+
+    // ************ stage timing, if the service is on ***********
+    lar::StageMonitor* fStageMonitor;
+    lar::StageMonitor::StageID fEventStage{0};
+    lar::StageMonitor::StageID fInitStage{0};
+    lar::StageMonitor::StageID fBuildStage{0};
+    lar::StageMonitor::StageID fOutputStage{0};
   };
   // -------------------------------------------------------------
   const std::string PMAlgTrackMaker::kKinksName = "kink";
@@ -178,7 +186,16 @@ namespace trkf {
     , fSaveOnlyBranchingVtx(config().SaveOnlyBranchingVtx())
     , fSavePmaNodes(config().SavePmaNodes())
     , fGeom(art::ServiceHandle<geo::Geometry const>().get())
+    , fStageMonitor(lar::stageMonitorIfConfigured())
   {
+    if (fStageMonitor) {
+      const std::string label = config.get_PSet().get<std::string>("module_label");
+      fEventStage = fStageMonitor->Stage(label);
+      fInitStage = fStageMonitor->Stage(label + "/Init");
+      fBuildStage = fStageMonitor->Stage(label + "/Build");
+      fOutputStage = fStageMonitor->Stage(label + "/Output");
+    }
+
     produces<std::vector<recob::Track>>();
     produces<std::vector<recob::SpacePoint>>();
     produces<std::vector<recob::Vertex>>();           // no instance name for interaction vertices
@@ -325,6 +342,8 @@ namespace trkf {
 
   void PMAlgTrackMaker::produce(art::Event& evt)
   {
+    lar::StageTimer eventTimer(fStageMonitor, fEventStage);
+
     // ---------------- Create data products --------------------------
     auto tracks = std::make_unique<std::vector<recob::Track>>();
     auto allsp = std::make_unique<std::vector<recob::SpacePoint>>();
@@ -364,6 +383,9 @@ namespace trkf {
     art::fill_ptr_vector(allhitlist, allHitListHandle);
 
     // -------------- PMA Tracker for this event ----------------------
+    lar::StageTimer initTimer(fStageMonitor, fInitStage);
+    initTimer.AddItems(allhitlist.size());
+
     auto pmalgTracker = pma::PMAlgTracker(allhitlist,
                                           *wireHandle,
                                           fPmaConfig,
@@ -405,11 +427,16 @@ namespace trkf {
       pmalgTracker.init(hitsFromClusters);
     }
 
+    initTimer.Stop();
+
     // ------------------ Do the job here: ----------------------------
     auto const clockData = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(evt);
     auto const detProp =
       art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(evt, clockData);
+    lar::StageTimer buildTimer(fStageMonitor, fBuildStage);
     int retCode = pmalgTracker.build(clockData, detProp);
+    buildTimer.AddItems(pmalgTracker.result().size());
+    buildTimer.Stop();
     // ----------------------------------------------------------------
     switch (retCode) {
     case -2: mf::LogError("Summary") << "problem"; break;
@@ -426,6 +453,7 @@ namespace trkf {
     }
 
     // ---------- Translate output to data products: ------------------
+    lar::StageTimer outputTimer(fStageMonitor, fOutputStage);
     auto const& result = pmalgTracker.result();
     if (!result.empty()) // ok, there is something to save
     {
@@ -510,8 +538,9 @@ namespace trkf {
             // give the CosmicTag the drift coordinate assuming T0 = T_beam as it requests.
             double shift = 0.0;
             if (i == driftDir) { shift = trk->Nodes()[0]->GetDriftShift(); }
-            trkEnd0.push_back(trk->Nodes()[0]->Point3D()[i] - shift);
-            trkEnd1.push_back(trk->Nodes()[trk->Nodes().size() - 1]->Point3D()[i] - shift);
+            trkEnd0.push_back(pma::ToTVector3(trk->Nodes()[0]->Point3D())[i] - shift);
+            trkEnd1.push_back(
+              pma::ToTVector3(trk->Nodes()[trk->Nodes().size() - 1]->Point3D())[i] - shift);
           }
           // Make the tag object. For now, let's say this is very likely a cosmic (3rd argument = 1).
           // Set the type of cosmic to the value saved in pma::Track.
@@ -690,6 +719,9 @@ namespace trkf {
 
     // for (const auto & ct : *cosmicTags) { std::cout << "Cosmic tag: " << ct << std::endl; }
 
+    outputTimer.AddItems(tracks->size());
+    eventTimer.AddItems(tracks->size());
+
     evt.put(std::move(tracks));
     evt.put(std::move(allsp));
     evt.put(std::move(vtxs));
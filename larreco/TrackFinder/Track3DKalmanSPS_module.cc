@@ -10,8 +10,11 @@
 
 // C++ includes
 #include <algorithm> // std::sort()
+#include <chrono>
 #include <cmath>
 #include <iterator> // std::distance()
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -44,12 +47,14 @@
 #include "larreco/Genfit/GFConstField.h"
 #include "larreco/Genfit/GFFieldManager.h"
 #include "larreco/Genfit/GFKalman.h"
+#include "larreco/Genfit/GFMaterialMap.h"
 #include "larreco/Genfit/GFTrack.h"
 #include "larreco/Genfit/PointHit.h"
 #include "larreco/Genfit/RKTrackRep.h"
 
 // LArSoft includes
 #include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/CryostatGeo.h"
 #include "larcorealg/Geometry/PlaneGeo.h"
 #include "larcorealg/Geometry/WireGeo.h"
 #include "lardataobj/RecoBase/Cluster.h"
@@ -183,6 +188,9 @@ namespace trkf {
     int fPdg;
     double fChi2Thresh;
     int fMaxPass;
+    double fMaterialMapVoxelSize;
+
+    std::unique_ptr<genf::GFMaterialMap> fMaterialMap;
 
     genf::GFAbsTrackRep* repMC;
     genf::GFAbsTrackRep* rep;
@@ -238,6 +246,7 @@ namespace trkf {
     fChi2Thresh = pset.get<double>("Chi2HitThresh", 12.0E12); //For Re-pass.
     fSortDim = pset.get<std::string>("SortDirection", "z");   // case sensitive
     fMaxPass = pset.get<int>("MaxPass", 2);                   // mu+ Hypothesis.
+    fMaterialMapVoxelSize = pset.get<double>("MaterialMapVoxelSize", 0.); // cm; 0 disables
     bool fGenfPRINT;
     if (pset.get_if_present("GenfPRINT", fGenfPRINT)) {
       MF_LOG_WARNING("Track3DKalmanSPS_GenFit")
@@ -483,6 +492,37 @@ namespace trkf {
     //TGeoManager* geomGENFIT = new TGeoManager("Geometry", "Geane geometry");
     //TGeoManager::Import("config/genfitGeom.root");
     //  gROOT->Macro("config/Geane.C");
+
+    // Material lookups inside the volumes of the cryostats skip the TGeo navigation,
+    // which all the fits have to share
+    if (fMaterialMapVoxelSize > 0.) {
+      art::ServiceHandle<geo::Geometry const> geom;
+      double lower[3] = {std::numeric_limits<double>::max(),
+                         std::numeric_limits<double>::max(),
+                         std::numeric_limits<double>::max()};
+      double upper[3] = {std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest()};
+      for (auto const& cryostat : geom->Iterate<geo::CryostatGeo>()) {
+        geo::BoxBoundedGeo const& box = cryostat.Boundaries();
+        lower[0] = std::min(lower[0], box.MinX());
+        lower[1] = std::min(lower[1], box.MinY());
+        lower[2] = std::min(lower[2], box.MinZ());
+        upper[0] = std::max(upper[0], box.MaxX());
+        upper[1] = std::max(upper[1], box.MaxY());
+        upper[2] = std::max(upper[2], box.MaxZ());
+      }
+      auto const start = std::chrono::steady_clock::now();
+      fMaterialMap =
+        std::make_unique<genf::GFMaterialMap>(TVector3(lower[0], lower[1], lower[2]),
+                                              TVector3(upper[0], upper[1], upper[2]),
+                                              fMaterialMapVoxelSize);
+      std::chrono::duration<double> const buildTime = std::chrono::steady_clock::now() - start;
+      mf::LogInfo("Track3DKalmanSPS")
+        << "Material map: " << fMaterialMap->nMappedVoxels() << " of " << fMaterialMap->nVoxels()
+        << " voxels of " << fMaterialMap->voxelSize() << " cm are inside a single volume, built in "
+        << buildTime.count() << " s";
+    }
   }
 
   //-------------------------------------------------
@@ -775,11 +815,13 @@ namespace trkf {
         genf::GFDetPlane planeG((TVector3)(spacepointss[0]->XYZ()), momM);
 
         // Initialize with 1st spacepoint location and ...
-        rep = new genf::RKTrackRep((TVector3)(spacepointss[0]->XYZ()),
-                                   momM,
-                                   posErr,
-                                   momErrFit,
-                                   fPdg); // mu+ hypothesis
+        auto* rkRep = new genf::RKTrackRep((TVector3)(spacepointss[0]->XYZ()),
+                                           momM,
+                                           posErr,
+                                           momErrFit,
+                                           fPdg); // mu+ hypothesis
+        rkRep->setMaterialMap(fMaterialMap.get());
+        rep = rkRep;
 
         genf::GFTrack fitTrack(rep); //initialized with smeared rep
         fitTrack.setPDG(fPdg);
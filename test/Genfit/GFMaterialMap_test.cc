@@ -0,0 +1,157 @@
+/**
+ * @file   GFMaterialMap_test.cc
+ * @brief  Test of the voxel map of the geometry used by the Genfit material effects
+ * @see    GFMaterialMap.h
+ *
+ * The geometry is a world box of vacuum with two placements of a smaller box
+ * of liquid argon. A segment inside a single node must be reported in the
+ * volume of that node; one crossing a boundary or leaving the mapped box must
+ * be left to the navigation. For random segments, every volume reported must
+ * be the one TGeo finds, with no boundary before the end of the segment.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (GFMaterialMap_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/Genfit/GFMaterialMap.h"
+
+// ROOT libraries
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoVolume.h"
+#include "TVector3.h"
+
+namespace {
+
+  constexpr double kWorldHalfSize = 100.; // cm
+  constexpr double kBoxHalfSize = 20.;    // cm
+  constexpr double kMapHalfSize = 90.;    // cm
+  constexpr double kVoxelSize = 2.;       // cm
+
+  /// The geometry, built once for all the test cases
+  struct TestGeometry {
+    TGeoVolume* world = nullptr;
+    TGeoVolume* box = nullptr;
+
+    TestGeometry()
+    {
+      new TGeoManager("GFMaterialMapTest", "GFMaterialMap test geometry");
+      auto* vacuum = new TGeoMedium("Vacuum", 1, new TGeoMaterial("Vacuum", 0., 0., 0.));
+      auto* argon = new TGeoMedium("LAr", 2, new TGeoMaterial("LAr", 39.95, 18., 1.39));
+
+      world = gGeoManager->MakeBox("World", vacuum, kWorldHalfSize, kWorldHalfSize, kWorldHalfSize);
+      gGeoManager->SetTopVolume(world);
+      box = gGeoManager->MakeBox("Box", argon, kBoxHalfSize, kBoxHalfSize, kBoxHalfSize);
+      world->AddNode(box, 1);
+      world->AddNode(box, 2, new TGeoTranslation(50., 0., 0.));
+      gGeoManager->CloseGeometry();
+    }
+  };
+
+  TestGeometry const& Geometry()
+  {
+    static TestGeometry const geometry;
+    return geometry;
+  }
+
+  genf::GFMaterialMap const& Map()
+  {
+    Geometry();
+    static genf::GFMaterialMap const map(TVector3(-kMapHalfSize, -kMapHalfSize, -kMapHalfSize),
+                                         TVector3(kMapHalfSize, kMapHalfSize, kMapHalfSize),
+                                         kVoxelSize);
+    return map;
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(InsideOneNode_test)
+{
+  genf::GFMaterialMap const& map = Map();
+  BOOST_TEST(map.voxelSize() == kVoxelSize);
+  BOOST_TEST(map.nMappedVoxels() > 0u);
+  BOOST_TEST(map.nMappedVoxels() < map.nVoxels());
+
+  TGeoVolume const* box = Geometry().box;
+  TGeoVolume const* world = Geometry().world;
+
+  // within the first placement of the box, across several voxels
+  BOOST_TEST(map.uniformVolume(TVector3(-5., -3., 2.), TVector3(1., 1., 0.).Unit(), 10.) == box);
+  // within the second placement
+  BOOST_TEST(map.uniformVolume(TVector3(45., 0., 0.), TVector3(1., 0., 0.), 10.) == box);
+  // in the world, away from the boxes
+  BOOST_TEST(map.uniformVolume(TVector3(-60., -60., -60.), TVector3(0., 0., 1.), 30.) == world);
+  // within a single voxel
+  BOOST_TEST(map.uniformVolume(TVector3(0.5, 0.5, 0.5), TVector3(0., 1., 0.), 0.2) == box);
+}
+
+BOOST_AUTO_TEST_CASE(CrossingBoundary_test)
+{
+  genf::GFMaterialMap const& map = Map();
+
+  // out of the box into the world
+  BOOST_TEST(map.uniformVolume(TVector3(10., 0., 0.), TVector3(1., 0., 0.), 20.) == nullptr);
+  // from one placement of the box to the other one, through the world
+  BOOST_TEST(map.uniformVolume(TVector3(0., 0., 0.), TVector3(1., 0., 0.), 50.) == nullptr);
+  // from the world through a box and out again
+  BOOST_TEST(map.uniformVolume(TVector3(-60., 0., 0.), TVector3(1., 0., 0.), 50.) == nullptr);
+  // ending in a voxel the boundary runs through
+  BOOST_TEST(map.uniformVolume(TVector3(0., 0., 0.), TVector3(0., 0., 1.), 19.9) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(LeavingBox_test)
+{
+  genf::GFMaterialMap const& map = Map();
+
+  // starting inside the mapped box
+  BOOST_TEST(map.uniformVolume(TVector3(80., -60., -60.), TVector3(1., 0., 0.), 20.) == nullptr);
+  // starting outside of it, in the same world volume
+  BOOST_TEST(map.uniformVolume(TVector3(95., -60., -60.), TVector3(-1., 0., 0.), 2.) == nullptr);
+  // all outside of it
+  BOOST_TEST(map.uniformVolume(TVector3(-95., 0., 0.), TVector3(0., 1., 0.), 2.) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(RandomSegments_test)
+{
+  genf::GFMaterialMap const& map = Map();
+
+  std::mt19937 engine(2468);
+  std::uniform_real_distribution<double> position(-kMapHalfSize, kMapHalfSize);
+  std::uniform_real_distribution<double> component(-1., 1.);
+  std::uniform_real_distribution<double> length(0., 15.);
+
+  unsigned int nUniform = 0;
+  unsigned int const nSegments = 5000;
+  for (unsigned int i = 0; i < nSegments; ++i) {
+    TVector3 const start(position(engine), position(engine), position(engine));
+    TVector3 dir(component(engine), component(engine), component(engine));
+    if (dir.Mag() == 0.) continue;
+    dir = dir.Unit();
+    double const dist = length(engine);
+
+    TGeoVolume const* volume = map.uniformVolume(start, dir, dist);
+    if (!volume) continue;
+    ++nUniform;
+
+    double const point[3] = {start.X(), start.Y(), start.Z()};
+    double const direction[3] = {dir.X(), dir.Y(), dir.Z()};
+    gGeoManager->InitTrack(point, direction);
+    gGeoManager->FindNextBoundary(dist);
+    BOOST_TEST_CONTEXT("segment " << i)
+    {
+      BOOST_TEST(gGeoManager->GetCurrentVolume() == volume);
+      BOOST_TEST(gGeoManager->GetStep() >= dist);
+    }
+  }
+
+  // most of the volume is far from the boundaries
+  BOOST_TEST(nUniform > nSegments / 2);
+}
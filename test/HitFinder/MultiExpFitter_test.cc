@@ -0,0 +1,163 @@
+/**
+ * @file   MultiExpFitter_test.cc
+ * @brief  Test for the Levenberg-Marquardt fitter in MultiExpFitter.h
+ * @see    MultiExpFitter.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (MultiExpFitter_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/HitFinder/MultiExpFitter.h"
+
+using boost::test_tools::tolerance;
+using Fitter_t = hit::MultiExpFitter;
+
+namespace {
+
+  /// Samples the pulse at bin centers, with the formula used by DPRawHitFinder.
+  void addPulse(std::vector<float>& signal, double amplitude, double t0, double tau1, double tau2)
+  {
+    for (std::size_t bin = 0; bin < signal.size(); ++bin) {
+      double const x = bin + 0.5;
+      signal[bin] +=
+        amplitude * std::exp(0.4 * (x - t0) / tau1) / (1. + std::exp(0.4 * (x - t0) / tau2));
+    }
+  }
+
+  void setSeed(Fitter_t::FitParams& params,
+               std::size_t iPeak,
+               double amplitude,
+               double t0,
+               double tau1,
+               double tau2)
+  {
+    bool const same = params.sameShape;
+    for (std::size_t iTau : {Fitter_t::Tau1Index(iPeak, same), Fitter_t::Tau2Index(iPeak, same)}) {
+      params.lower[iTau] = 0.01;
+      params.upper[iTau] = 20.;
+    }
+    params.value[Fitter_t::Tau1Index(iPeak, same)] = tau1;
+    params.value[Fitter_t::Tau2Index(iPeak, same)] = tau2;
+
+    std::size_t const iAmp = Fitter_t::AmplitudeIndex(iPeak, same);
+    params.value[iAmp] = amplitude;
+    params.lower[iAmp] = 0.3 * amplitude;
+    params.upper[iAmp] = 2. * amplitude;
+
+    std::size_t const iT0 = Fitter_t::PeakTimeIndex(iPeak, same);
+    params.value[iT0] = t0;
+    params.lower[iT0] = t0 - 5.;
+    params.upper[iT0] = t0 + 5.;
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(MultiExpFitterSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(SinglePulseTest)
+{
+  std::vector<float> signal(60, 0.);
+  addPulse(signal, 40., 20.3, 2.5, 0.8);
+
+  Fitter_t::FitParams params;
+  params.resize(1, true);
+  setSeed(params, 0, 30., 19., 0.5, 0.5);
+
+  Fitter_t const fitter;
+  Fitter_t::Workspace workspace;
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), 5, 50, params, workspace));
+
+  BOOST_TEST(params.value[0] == 2.5, 1e-3 % tolerance());
+  BOOST_TEST(params.value[1] == 0.8, 1e-3 % tolerance());
+  BOOST_TEST(params.value[2] == 40., 1e-3 % tolerance());
+  BOOST_TEST(params.value[3] == 20.3, 1e-3 % tolerance());
+  BOOST_TEST(params.ndf == 42);
+  BOOST_TEST(params.chi2 < 1e-6);
+
+  BOOST_TEST(Fitter_t::Evaluate(params, 25.5) == signal[25], 1e-4 % tolerance());
+} // SinglePulseTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(TwoPulsesTest)
+{
+  std::vector<float> signal(80, 0.);
+  addPulse(signal, 40., 20., 2.5, 0.8);
+  addPulse(signal, 25., 29., 2.5, 0.8);
+
+  // common shape
+  Fitter_t::FitParams params;
+  params.resize(2, true);
+  setSeed(params, 0, 35., 19., 1., 0.5);
+  setSeed(params, 1, 30., 28., 1., 0.5);
+
+  Fitter_t const fitter;
+  Fitter_t::Workspace workspace;
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), 10, 70, params, workspace));
+
+  BOOST_TEST(params.value[0] == 2.5, 1e-3 % tolerance());
+  BOOST_TEST(params.value[1] == 0.8, 1e-3 % tolerance());
+  BOOST_TEST(params.value[2] == 40., 1e-3 % tolerance());
+  BOOST_TEST(params.value[3] == 20., 1e-3 % tolerance());
+  BOOST_TEST(params.value[4] == 25., 1e-3 % tolerance());
+  BOOST_TEST(params.value[5] == 29., 1e-3 % tolerance());
+
+  // independent shapes, with the same workspace
+  params.resize(2, false);
+  setSeed(params, 0, 35., 19., 1., 0.5);
+  setSeed(params, 1, 30., 28., 1., 0.5);
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), 10, 70, params, workspace));
+
+  BOOST_TEST(params.ndf == 61 - 8);
+  BOOST_TEST(params.chi2 < 1e-6);
+  for (std::size_t iPeak = 0; iPeak < 2; ++iPeak) {
+    BOOST_TEST(params.value[Fitter_t::Tau1Index(iPeak, false)] == 2.5, 1e-3 % tolerance());
+    BOOST_TEST(params.value[Fitter_t::Tau2Index(iPeak, false)] == 0.8, 1e-3 % tolerance());
+  }
+} // TwoPulsesTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(PulseMaximumTest)
+{
+  double const t0 = 20., tau1 = 2.5, tau2 = 0.8;
+  double const xMax = Fitter_t::PulseMaximumX(t0, tau1, tau2, 0., 60.);
+
+  // compare with a fine scan of the function
+  double scanMax = 0., scanX = 0.;
+  for (double x = 10.; x < 30.; x += 1e-4) {
+    double const value = Fitter_t::Pulse(x, 1., t0, tau1, tau2);
+    if (value > scanMax) {
+      scanMax = value;
+      scanX = x;
+    }
+  }
+  BOOST_TEST(xMax == scanX, 1e-3 % tolerance());
+
+  // limited by the range, or growing all the way
+  BOOST_TEST(Fitter_t::PulseMaximumX(t0, tau1, tau2, 0., 15.) == 15.);
+  BOOST_TEST(Fitter_t::PulseMaximumX(t0, 0.5, 0.5, 0., 15.) == 15.);
+} // PulseMaximumTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(TooFewSamplesTest)
+{
+  std::vector<float> signal(10, 1.);
+
+  Fitter_t::FitParams params;
+  params.resize(2, false);
+  setSeed(params, 0, 1., 3., 1., 0.5);
+  setSeed(params, 1, 1., 6., 1., 0.5);
+
+  Fitter_t const fitter;
+  Fitter_t::Workspace workspace;
+  BOOST_TEST(!fitter.Fit(signal.data(), 0, 7, params, workspace));
+} // TooFewSamplesTest
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+/**
+ * @file   MultiGausFitter_test.cc
+ * @brief  Test for the Levenberg-Marquardt fitter in MultiGausFitter.h
+ * @see    MultiGausFitter.h
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (MultiGausFitter_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/HitFinder/MultiGausFitter.h"
+
+using boost::test_tools::tolerance;
+
+namespace {
+
+  /// Samples amplitude * exp(-((x - mean)/sigma)^2/2) at bin centers, plus baseline.
+  void addGaus(std::vector<float>& signal, double amplitude, double mean, double sigma)
+  {
+    for (std::size_t bin = 0; bin < signal.size(); ++bin) {
+      double const z = (bin + 0.5 - mean) / sigma;
+      signal[bin] += amplitude * std::exp(-0.5 * z * z);
+    }
+  }
+
+  void setSeed(hit::MultiGausFitter::FitParams& params,
+               std::size_t iGaus,
+               double amplitude,
+               double mean,
+               double sigma)
+  {
+    params.value[3 * iGaus] = amplitude;
+    params.value[3 * iGaus + 1] = mean;
+    params.value[3 * iGaus + 2] = sigma;
+    params.lower[3 * iGaus] = 0.1 * amplitude;
+    params.upper[3 * iGaus] = 2. * amplitude;
+    params.lower[3 * iGaus + 1] = mean - 2. * sigma;
+    params.upper[3 * iGaus + 1] = mean + 2. * sigma;
+    params.lower[3 * iGaus + 2] = 0.5;
+    params.upper[3 * iGaus + 2] = 3. * sigma;
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(MultiGausFitterSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(SingleGaussianTest)
+{
+  std::vector<float> signal(40, 0.);
+  addGaus(signal, 25., 17.3, 2.4);
+
+  hit::MultiGausFitter::FitParams params;
+  params.nGaus = 1;
+  setSeed(params, 0, 20., 16., 3.);
+
+  hit::MultiGausFitter const fitter;
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), signal.size(), params));
+
+  BOOST_TEST(params.value[0] == 25., 1e-4 % tolerance());
+  BOOST_TEST(params.value[1] == 17.3, 1e-4 % tolerance());
+  BOOST_TEST(params.value[2] == 2.4, 1e-4 % tolerance());
+  BOOST_TEST(params.ndf == 37);
+  BOOST_TEST(params.chi2 < 1e-6);
+} // SingleGaussianTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(OverlappingGaussiansWithBaselineTest)
+{
+  std::vector<float> signal(60, 3.);
+  addGaus(signal, 30., 20., 3.);
+  addGaus(signal, 12., 28., 2.);
+
+  hit::MultiGausFitter::FitParams params;
+  params.nGaus = 2;
+  params.floatBaseline = true;
+  setSeed(params, 0, 27., 21., 2.5);
+  setSeed(params, 1, 15., 27., 2.5);
+  params.value[6] = 0.;
+  params.lower[6] = -12.;
+  params.upper[6] = 12.;
+
+  hit::MultiGausFitter const fitter;
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), signal.size(), params));
+
+  BOOST_TEST(params.value[0] == 30., 1e-3 % tolerance());
+  BOOST_TEST(params.value[1] == 20., 1e-3 % tolerance());
+  BOOST_TEST(params.value[2] == 3., 1e-3 % tolerance());
+  BOOST_TEST(params.value[3] == 12., 1e-3 % tolerance());
+  BOOST_TEST(params.value[4] == 28., 1e-3 % tolerance());
+  BOOST_TEST(params.value[5] == 2., 1e-3 % tolerance());
+  BOOST_TEST(params.value[6] == 3., 1e-3 % tolerance());
+} // OverlappingGaussiansWithBaselineTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(ParameterLimitsTest)
+{
+  // the true width is outside the allowed range: the fit must stop at the limit
+  std::vector<float> signal(40, 0.);
+  addGaus(signal, 10., 20., 6.);
+
+  hit::MultiGausFitter::FitParams params;
+  params.nGaus = 1;
+  setSeed(params, 0, 10., 20., 1.5);
+
+  hit::MultiGausFitter const fitter;
+  BOOST_TEST_REQUIRE(fitter.Fit(signal.data(), signal.size(), params));
+
+  BOOST_TEST(params.value[2] <= params.upper[2]);
+  BOOST_TEST(params.value[2] == params.upper[2], 1e-6 % tolerance());
+} // ParameterLimitsTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(TooManyGaussiansTest)
+{
+  std::vector<float> signal(400, 1.);
+
+  hit::MultiGausFitter::FitParams params;
+  params.nGaus = hit::MultiGausFitter::kMaxGaussians + 1;
+
+  hit::MultiGausFitter const fitter;
+  BOOST_TEST(!fitter.Fit(signal.data(), signal.size(), params));
+} // TooManyGaussiansTest
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,246 @@
+/// \class PeakFitterComparison
+///
+/// \brief Compares the PeakFitterGaussLM tool with PeakFitterGaussian.
+///
+/// Each event, regions of interest with one to a few overlapping Gaussian
+/// pulses plus white noise are generated, with candidate hits seeded from the
+/// true pulses smeared by a fraction of their width. Both tools fit the same
+/// regions with the same candidates: the peak time, width and amplitude of
+/// each peak and the chi2 of each fit must agree, and the time per region of
+/// interest of the two tools is printed.
+///
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Utilities/make_tool.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/DelegatedParameter.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace hit {
+
+  class PeakFitterComparison : public art::EDAnalyzer {
+  public:
+    struct Config {
+      using Name = fhicl::Name;
+      using Comment = fhicl::Comment;
+      fhicl::Atom<unsigned int> nROIs{Name("nROIs"), Comment("Regions of interest per event")};
+      fhicl::Atom<unsigned int> maxPeaks{Name("maxPeaks"), Comment("Most pulses in a region")};
+      fhicl::Atom<double> noise{Name("noise"), Comment("RMS of the noise [ADC]")};
+      fhicl::Atom<double> timeTolerance{Name("timeTolerance"),
+                                        Comment("Largest peak time difference [ticks]")};
+      fhicl::Atom<double> relTolerance{
+        Name("relTolerance"),
+        Comment("Largest relative difference of width, amplitude and chi2")};
+      fhicl::Atom<double> maxMismatchFraction{
+        Name("maxMismatchFraction"),
+        Comment("Largest fraction of regions fitted differently by the two tools")};
+      fhicl::Atom<unsigned int> seed{Name("seed"), Comment("Seed of the pulse generation")};
+      fhicl::DelegatedParameter reference{Name("reference"),
+                                          Comment("Configuration of the reference peak fitter")};
+      fhicl::DelegatedParameter candidate{Name("candidate"),
+                                          Comment("Configuration of the tested peak fitter")};
+    };
+    using Parameters = art::EDAnalyzer::Table<Config>;
+
+    explicit PeakFitterComparison(Parameters const& p);
+
+  private:
+    void analyze(art::Event const& e) override;
+
+    /// A generated region of interest with its candidate hits
+    struct GeneratedROI {
+      std::vector<float> signal;
+      reco_tool::ICandidateHitFinder::HitCandidateVec candidates;
+    };
+
+    GeneratedROI generateROI();
+
+    /// Result of the fit of one region of interest
+    struct FitResult {
+      reco_tool::IPeakFitter::PeakParamsVec peaks;
+      double chi2PerNDF = 0.;
+      int NDF = 0;
+    };
+
+    /// Fits all the regions with `fitter`, returns the time taken [s]
+    double fitAll(reco_tool::IPeakFitter const& fitter,
+                  std::vector<GeneratedROI> const& rois,
+                  std::vector<FitResult>& results) const;
+
+    bool agree(FitResult const& ref, FitResult const& cand) const;
+
+    Parameters p_;
+    std::unique_ptr<reco_tool::IPeakFitter> fReference;
+    std::unique_ptr<reco_tool::IPeakFitter> fCandidate;
+    std::mt19937 rng;
+
+    double fReferenceTime = 0.;
+    double fCandidateTime = 0.;
+  };
+
+}
+
+hit::PeakFitterComparison::PeakFitterComparison(Parameters const& p)
+  : EDAnalyzer{p}
+  , p_(p)
+  , fReference{art::make_tool<reco_tool::IPeakFitter>(
+      p_().reference.get<fhicl::ParameterSet>())}
+  , fCandidate{art::make_tool<reco_tool::IPeakFitter>(
+      p_().candidate.get<fhicl::ParameterSet>())}
+  , rng(p_().seed())
+{}
+
+hit::PeakFitterComparison::GeneratedROI hit::PeakFitterComparison::generateROI()
+{
+  std::uniform_int_distribution<unsigned int> upeaks(1, p_().maxPeaks());
+  std::uniform_real_distribution<double> uamp(15., 150.);
+  std::uniform_real_distribution<double> usigma(1.5, 5.);
+  std::uniform_real_distribution<double> ugap(1.5, 4.);
+  std::normal_distribution<double> gaus(0., 1.);
+
+  // pulses at least 1.5 sigma apart, so that they overlap but are still resolved
+  unsigned int const nPeaks = upeaks(rng);
+  std::vector<double> amp(nPeaks), mean(nPeaks), sigma(nPeaks);
+  double pos = 0.;
+  for (unsigned int i = 0; i < nPeaks; ++i) {
+    amp[i] = uamp(rng);
+    sigma[i] = usigma(rng);
+    pos += (i == 0 ? 4. : ugap(rng)) * sigma[i];
+    mean[i] = pos;
+  }
+  size_t const nTicks = std::ceil(pos + 4. * sigma.back());
+
+  GeneratedROI roi;
+  roi.signal.resize(nTicks);
+  for (size_t tick = 0; tick < nTicks; ++tick) {
+    double value = p_().noise() * gaus(rng);
+    for (unsigned int i = 0; i < nPeaks; ++i) {
+      double const z = (tick + 0.5 - mean[i]) / sigma[i];
+      value += amp[i] * std::exp(-0.5 * z * z);
+    }
+    roi.signal[tick] = value;
+  }
+
+  // the candidates are what a hit finder would see: roughly the true pulses
+  for (unsigned int i = 0; i < nPeaks; ++i) {
+    reco_tool::ICandidateHitFinder::HitCandidate candidate{};
+    double const center = mean[i] + 0.2 * sigma[i] * gaus(rng);
+    candidate.startTick = std::max(0., std::floor(mean[i] - 3. * sigma[i]));
+    candidate.stopTick = std::min(double(nTicks), std::ceil(mean[i] + 3. * sigma[i]));
+    candidate.maxTick = std::min(size_t(std::max(center, 0.)), nTicks - 1);
+    candidate.minTick = candidate.maxTick;
+    candidate.hitCenter = center;
+    candidate.hitSigma = sigma[i] * (1. + 0.15 * gaus(rng));
+    candidate.hitHeight = roi.signal[candidate.maxTick];
+    roi.candidates.push_back(candidate);
+  }
+  roi.candidates.front().startTick = 0;
+  roi.candidates.back().stopTick = nTicks;
+  return roi;
+}
+
+double hit::PeakFitterComparison::fitAll(reco_tool::IPeakFitter const& fitter,
+                                         std::vector<GeneratedROI> const& rois,
+                                         std::vector<FitResult>& results) const
+{
+  results.assign(rois.size(), {});
+  auto workspace = fitter.makeWorkspace();
+
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rois.size(); ++i) {
+    FitResult& result = results[i];
+    fitter.findPeakParameters(*workspace,
+                              rois[i].signal,
+                              rois[i].candidates,
+                              result.peaks,
+                              result.chi2PerNDF,
+                              result.NDF);
+  }
+  std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+bool hit::PeakFitterComparison::agree(FitResult const& ref, FitResult const& cand) const
+{
+  auto const close = [tol = p_().relTolerance()](double a, double b) {
+    return std::abs(a - b) <= tol * std::max(std::abs(a), std::abs(b));
+  };
+
+  if (ref.peaks.size() != cand.peaks.size()) return false;
+  if (ref.peaks.empty()) return true; // both fits failed
+  if (ref.NDF != cand.NDF || !close(ref.chi2PerNDF, cand.chi2PerNDF)) return false;
+
+  for (size_t i = 0; i < ref.peaks.size(); ++i) {
+    auto const& r = ref.peaks[i];
+    auto const& c = cand.peaks[i];
+    if (std::abs(r.peakCenter - c.peakCenter) > p_().timeTolerance()) return false;
+    if (!close(r.peakSigma, c.peakSigma)) return false;
+    if (!close(r.peakAmplitude, c.peakAmplitude)) return false;
+  }
+  return true;
+}
+
+void hit::PeakFitterComparison::analyze(art::Event const& e)
+{
+  std::vector<GeneratedROI> rois;
+  rois.reserve(p_().nROIs());
+  for (unsigned int i = 0; i < p_().nROIs(); ++i)
+    rois.push_back(generateROI());
+
+  std::vector<FitResult> refResults, candResults;
+  double const refTime = fitAll(*fReference, rois, refResults);
+  double const candTime = fitAll(*fCandidate, rois, candResults);
+  fReferenceTime += refTime;
+  fCandidateTime += candTime;
+
+  unsigned int nMismatches = 0, nFitted = 0;
+  for (size_t i = 0; i < rois.size(); ++i) {
+    if (!refResults[i].peaks.empty()) ++nFitted;
+    if (agree(refResults[i], candResults[i])) continue;
+    if (++nMismatches > 10) continue;
+
+    mf::LogVerbatim log("PeakFitterComparison");
+    log << "Region " << i << " (" << rois[i].signal.size() << " ticks, "
+        << rois[i].candidates.size() << " candidates) fitted differently:"
+        << "\n  chi2/NDF " << refResults[i].chi2PerNDF << " (" << refResults[i].NDF << ") vs "
+        << candResults[i].chi2PerNDF << " (" << candResults[i].NDF << ")";
+    for (size_t j = 0; j < std::min(refResults[i].peaks.size(), candResults[i].peaks.size());
+         ++j) {
+      auto const& r = refResults[i].peaks[j];
+      auto const& c = candResults[i].peaks[j];
+      log << "\n  peak " << j << ": time " << r.peakCenter << " vs " << c.peakCenter << ", width "
+          << r.peakSigma << " vs " << c.peakSigma << ", amplitude " << r.peakAmplitude << " vs "
+          << c.peakAmplitude;
+    }
+  }
+
+  if (nMismatches > p_().maxMismatchFraction() * rois.size() || 2 * nFitted < rois.size()) {
+    throw cet::exception("PeakFitterComparison")
+      << "Event " << e.event() << ": " << nMismatches << " of " << rois.size()
+      << " regions of interest fitted differently, " << nFitted
+      << " fitted by the reference tool\n";
+  }
+
+  mf::LogInfo("PeakFitterComparison")
+    << rois.size() << " regions of interest, " << nFitted << " fitted, " << nMismatches
+    << " different\n"
+    << "  reference: " << 1e6 * refTime / rois.size() << " us/ROI\n"
+    << "  candidate: " << 1e6 * candTime / rois.size() << " us/ROI\n"
+    << "  speedup:   " << refTime / candTime << " (cumulative " << fReferenceTime / fCandidateTime
+    << ")";
+}
+
+DEFINE_ART_MODULE(hit::PeakFitterComparison)
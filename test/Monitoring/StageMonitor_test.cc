@@ -0,0 +1,140 @@
+/**
+ * @file   StageMonitor_test.cc
+ * @brief  Test for the stage timing and counting facility
+ * @see    StageMonitor.h
+ */
+
+// C/C++ standard libraries
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (StageMonitor_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/Monitoring/StageMonitor.h"
+
+using boost::test_tools::tolerance;
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(StageMonitorSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(SummaryTest)
+{
+  lar::StageMonitor monitor;
+  auto const child = monitor.Stage("Top/Child");
+  auto const top = monitor.Stage("Top");
+  auto const other = monitor.Stage("Other");
+  BOOST_TEST(monitor.Stage("Top") == top);
+
+  // 1 ms ninety times, 100 ms ten times
+  for (int i = 0; i < 90; ++i)
+    monitor.Record(child, 1e-3, 2);
+  for (int i = 0; i < 10; ++i)
+    monitor.Record(child, 0.1, 2);
+  monitor.Record(top, 2.);
+  monitor.Count(top, 7);
+  (void)other;
+
+  auto const summary = monitor.Summary();
+  BOOST_TEST_REQUIRE(summary.size() == 3);
+
+  // each parent is followed by its children
+  BOOST_TEST(summary[0].name == "Other");
+  BOOST_TEST(summary[0].calls == 0);
+  BOOST_TEST(summary[1].name == "Top");
+  BOOST_TEST(summary[2].name == "Top/Child");
+
+  BOOST_TEST(summary[1].calls == 1);
+  BOOST_TEST(summary[1].items == 7);
+  BOOST_TEST(summary[1].maxTime == 2.);
+  BOOST_TEST(summary[1].p50Time == 2., 5. % tolerance());
+
+  auto const& stage = summary[2];
+  BOOST_TEST(stage.parent == "Top");
+  BOOST_TEST(stage.depth == 1);
+  BOOST_TEST(stage.calls == 100);
+  BOOST_TEST(stage.items == 200);
+  BOOST_TEST(stage.totalTime == 1.09, 1e-9 % tolerance());
+  BOOST_TEST(stage.meanTime == 0.0109, 1e-9 % tolerance());
+  BOOST_TEST(stage.p50Time == 1e-3, 5. % tolerance());
+  BOOST_TEST(stage.p95Time == 0.1, 5. % tolerance());
+  BOOST_TEST(stage.maxTime == 0.1);
+} // SummaryTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(ThreadsTest)
+{
+  lar::StageMonitor monitor;
+  auto const stage = monitor.Stage("Stage");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&monitor, stage, t] {
+      for (int i = 0; i < 1000; ++i)
+        monitor.Record(stage, 1e-6 * (t + 1), 1);
+      // stages may also be registered while others record
+      monitor.Record(monitor.Stage("Thread" + std::to_string(t)), 1.);
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  auto const summary = monitor.Summary();
+  BOOST_TEST_REQUIRE(summary.size() == 5);
+  BOOST_TEST(summary[0].calls == 4000);
+  BOOST_TEST(summary[0].items == 4000);
+  BOOST_TEST(summary[0].totalTime == 1e-2, 1e-9 % tolerance());
+  BOOST_TEST(summary[0].maxTime == 4e-6);
+  for (std::size_t i = 1; i < summary.size(); ++i)
+    BOOST_TEST(summary[i].calls == 1);
+} // ThreadsTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(TimerTest)
+{
+  lar::StageMonitor monitor;
+  auto const stage = monitor.Stage("Stage");
+  {
+    lar::StageTimer timer(&monitor, stage);
+    timer.AddItems(3);
+  }
+  double elapsed = 0.;
+  {
+    lar::StageTimer timer(&monitor, stage);
+    elapsed = timer.Stop();
+    BOOST_TEST(timer.Stop() == elapsed); // recorded only once
+  }
+  {
+    // without a monitor the time is still kept
+    lar::StageTimer timer(nullptr, stage);
+    BOOST_TEST(timer.Stop() >= 0.);
+  }
+
+  auto const summary = monitor.Summary();
+  BOOST_TEST(summary[0].calls == 2);
+  BOOST_TEST(summary[0].items == 3);
+  BOOST_TEST(summary[0].maxTime >= elapsed);
+} // TimerTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(OutputTest)
+{
+  lar::StageMonitor monitor;
+  monitor.Record(monitor.Stage("A \"quoted\", stage"), 0.5, 4);
+
+  std::ostringstream json;
+  monitor.WriteJSON(json);
+  BOOST_TEST(json.str().find("\"name\": \"A \\\"quoted\\\", stage\"") != std::string::npos);
+  BOOST_TEST(json.str().find("\"calls\": 1, \"items\": 4, \"total_s\": 0.5") != std::string::npos);
+
+  std::ostringstream csv;
+  monitor.WriteCSV(csv);
+  BOOST_TEST(csv.str() == "stage,parent,depth,calls,items,total_s,mean_s,p50_s,p95_s,max_s\n"
+                          "\"A \"\"quoted\"\", stage\",,0,1,4,0.5,0.5,0.5,0.5,0.5\n");
+} // OutputTest
+
+BOOST_AUTO_TEST_SUITE_END()
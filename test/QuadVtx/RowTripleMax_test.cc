@@ -0,0 +1,133 @@
+/**
+ * @file   RowTripleMax_test.cc
+ * @brief  Test and micro-benchmark of the QuadVtx row-triple maximum kernel
+ * @see    RowTripleMax.h
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (RowTripleMax_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/QuadVtx/RowTripleMax.h"
+
+namespace {
+
+  std::vector<quad::SimdLevel> SupportedLevels()
+  {
+    std::vector<quad::SimdLevel> levels{quad::SimdLevel::kScalar};
+    for (auto level :
+         {quad::SimdLevel::kSSE2, quad::SimdLevel::kAVX2, quad::SimdLevel::kAVX512}) {
+      if (level <= quad::BestSimdLevel()) levels.push_back(level);
+    }
+    return levels;
+  }
+
+  std::string Name(quad::SimdLevel level)
+  {
+    switch (level) {
+    case quad::SimdLevel::kScalar: return "scalar";
+    case quad::SimdLevel::kSSE2: return "SSE2";
+    case quad::SimdLevel::kAVX2: return "AVX2";
+    case quad::SimdLevel::kAVX512: return "AVX-512";
+    }
+    return "unknown";
+  }
+
+  // Heat map like rows: small integer counts, so that there are plenty of ties
+  std::vector<float> MakeRow(std::mt19937& engine, int size)
+  {
+    std::poisson_distribution<int> counts(2.);
+    std::vector<float> row(size);
+    for (float& bin : row)
+      bin = counts(engine);
+    return row;
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(RowTripleMaxSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(AgreementTest)
+{
+  std::mt19937 engine(12345);
+
+  for (int size : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 100, 257, 1000}) {
+    for (int trial = 0; trial < 20; ++trial) {
+      const std::vector<float> a = MakeRow(engine, size);
+      const std::vector<float> b = MakeRow(engine, size);
+      const std::vector<float> c = MakeRow(engine, size);
+
+      for (int begin : {0, 1}) {
+        const int end = std::max(begin, size - begin);
+
+        float refMax = -1;
+        const int refIndex = quad::RowTripleMax(
+          quad::SimdLevel::kScalar, a.data(), b.data(), c.data(), begin, end, refMax);
+        if (end == begin) { BOOST_TEST(refIndex == -1); }
+
+        for (auto level : SupportedLevels()) {
+          float max = -1;
+          const int index = quad::RowTripleMax(level, a.data(), b.data(), c.data(), begin, end, max);
+          BOOST_TEST_CONTEXT(Name(level) << " size " << size << " begin " << begin)
+          {
+            BOOST_TEST(index == refIndex);
+            if (refIndex >= 0) { BOOST_TEST(max == refMax); }
+          }
+        }
+      }
+    }
+  }
+} // BOOST_AUTO_TEST_CASE(AgreementTest)
+
+//******************************************************************************
+// Not a test as such: reports the time per row triple of each version
+BOOST_AUTO_TEST_CASE(BenchmarkTest)
+{
+  constexpr int kRowSize = 400; // bins of a typical full drift map
+  constexpr int kNumRows = 64;
+  constexpr int kRepeats = 2000;
+
+  std::mt19937 engine(54321);
+  std::vector<std::vector<float>> rows;
+  for (int i = 0; i < kNumRows; ++i)
+    rows.push_back(MakeRow(engine, kRowSize));
+
+  long refChecksum = -1;
+  for (auto level : SupportedLevels()) {
+    long checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < kRepeats; ++rep) {
+      for (int i = 0; i < kNumRows; ++i) {
+        float max;
+        checksum += quad::RowTripleMax(level,
+                                       rows[i].data(),
+                                       rows[(i + 1) % kNumRows].data(),
+                                       rows[(i + 7) % kNumRows].data(),
+                                       1,
+                                       kRowSize - 1,
+                                       max);
+      }
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE(Name(level) << ": " << elapsed.count() / (kRepeats * kNumRows)
+                                   << " ns per row triple of " << kRowSize << " bins (checksum "
+                                   << checksum << ")");
+
+    if (refChecksum < 0) refChecksum = checksum;
+    BOOST_TEST(checksum == refChecksum);
+  }
+} // BOOST_AUTO_TEST_CASE(BenchmarkTest)
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,396 @@
+/**
+ * @file   BlurredClusteringImage_test.cc
+ * @brief  Test and benchmark of the image processing of BlurredClusteringAlg
+ * @see    BlurredClusteringImage.h
+ *
+ * The separable blur is compared with the convolution of each hit with the
+ * full 2D kernel, and the labelling with a flood fill from every bin. The
+ * benchmark runs both on an image the size of the collection plane of a
+ * ProtoDUNE-SP APA over a full readout window.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (BlurredClusteringImage_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/BlurredClusteringImage.h"
+
+namespace {
+
+  struct BlurParameters {
+    int blurWire;
+    int blurTick;
+    int sigmaWire;
+    int sigmaTick;
+    int maxTickScale;
+  };
+
+  /// A hit image, with the width scale of each hit and the dead wires
+  struct HitImage {
+    cluster::BlurredImage image;
+    std::vector<int> tickScale; // by bin, for the bins with charge
+    std::vector<bool> deadWires;
+  };
+
+  void AddHit(HitImage& hits, std::mt19937& engine, int wire, int tick, int maxTickScale)
+  {
+    if (wire < 0 || wire >= hits.image.NWires() || tick < 0 || tick >= hits.image.NTicks())
+      return;
+    hits.image(wire, tick) = std::uniform_real_distribution<float>(50., 500.)(engine);
+    hits.tickScale[hits.image.Bin(wire, tick)] =
+      std::uniform_int_distribution<int>(1, maxTickScale)(engine);
+  }
+
+  /// Tracks, one hit per wire, and noise hits
+  HitImage MakeHitImage(std::mt19937& engine,
+                        int nWires,
+                        int nTicks,
+                        int nTracks,
+                        int nNoiseHits,
+                        int maxTickScale)
+  {
+    HitImage hits;
+    hits.image.Reset(nWires, nTicks);
+    hits.tickScale.assign(hits.image.NBins(), 0);
+    hits.deadWires.assign(nWires, false);
+
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    for (int wire = 0; wire < nWires; ++wire)
+      hits.deadWires[wire] = uniform(engine) < 0.05;
+
+    for (int track = 0; track < nTracks; ++track) {
+      int const firstWire = uniform(engine) * nWires;
+      int const length = 10 + uniform(engine) * nWires / 4;
+      double const tick0 = uniform(engine) * nTicks;
+      double const slope = 20. * (uniform(engine) - 0.5);
+      for (int wire = firstWire; wire < firstWire + length; ++wire) {
+        if (wire < nWires && hits.deadWires[wire]) continue;
+        AddHit(hits, engine, wire, tick0 + slope * (wire - firstWire), maxTickScale);
+      }
+    }
+    for (int hit = 0; hit < nNoiseHits; ++hit)
+      AddHit(hits, engine, uniform(engine) * nWires, uniform(engine) * nTicks, maxTickScale);
+
+    return hits;
+  }
+
+  cluster::BlurredImage SeparableBlur(HitImage const& hits, BlurParameters const& par)
+  {
+    std::vector<std::vector<float>> tickKernels(par.maxTickScale + 1);
+    for (int scale = 1; scale <= par.maxTickScale; ++scale)
+      tickKernels[scale] =
+        cluster::GaussianKernel(par.sigmaTick * scale, par.blurTick * scale);
+
+    cluster::BlurredImage blurred(hits.image.NWires(), hits.image.NTicks());
+    cluster::BlurImage(
+      hits.image,
+      hits.deadWires,
+      cluster::GaussianKernel(par.sigmaWire, par.blurWire),
+      [&](int wire, int tick) -> std::vector<float> const& {
+        return tickKernels[hits.tickScale[hits.image.Bin(wire, tick)]];
+      },
+      blurred);
+    return blurred;
+  }
+
+  double Gaussian(double sigma, int offset)
+  {
+    return 1. / std::sqrt(2. * sigma * sigma * M_PI) * std::exp(-offset * offset /
+                                                                 (2. * sigma * sigma));
+  }
+
+  /// Each hit convolved with the product kernel; the wire offset of a target wire does not
+  /// count the dead wires between it and the hit
+  std::vector<double> DirectBlur(HitImage const& hits, BlurParameters const& par)
+  {
+    cluster::BlurredImage const& image = hits.image;
+    std::vector<double> blurred(image.NBins(), 0.);
+    for (int wire = 0; wire < image.NWires(); ++wire) {
+      for (int tick = 0; tick < image.NTicks(); ++tick) {
+        if (image(wire, tick) == 0) continue;
+        int const scale = hits.tickScale[image.Bin(wire, tick)];
+        for (int target = 0; target < image.NWires(); ++target) {
+          int nDead = 0;
+          for (int w = std::min(wire, target) + 1; w < std::max(wire, target); ++w)
+            nDead += hits.deadWires[w];
+          int const wireOffset = std::abs(target - wire) - nDead;
+          if (wireOffset > par.blurWire) continue;
+          for (int dt = -par.blurTick * scale; dt <= par.blurTick * scale; ++dt) {
+            if (tick + dt < 0 || tick + dt >= image.NTicks()) continue;
+            blurred[image.Bin(target, tick + dt)] += image(wire, tick) *
+                                                     Gaussian(par.sigmaWire, wireOffset) *
+                                                     Gaussian(par.sigmaTick * scale, dt);
+          }
+        }
+      }
+    }
+    return blurred;
+  }
+
+  /// Flood fill from each unlabelled bin above threshold
+  std::vector<int> FloodFillLabels(cluster::BlurredImage const& image,
+                                   float threshold,
+                                   int wireDistance,
+                                   int tickDistance)
+  {
+    std::vector<int> labels(image.NBins(), -1);
+    int nLabels = 0;
+    for (int bin = 0; bin < image.NBins(); ++bin) {
+      if (labels[bin] >= 0 || !(image.Charge(bin) > threshold)) continue;
+      std::vector<int> group{bin};
+      labels[bin] = nLabels;
+      for (unsigned int i = 0; i < group.size(); ++i) {
+        int const wire = image.WireOfBin(group[i]);
+        int const tick = image.TickOfBin(group[i]);
+        for (int w = std::max(wire - wireDistance, 0);
+             w <= std::min(wire + wireDistance, image.NWires() - 1);
+             ++w) {
+          for (int t = std::max(tick - tickDistance, 0);
+               t <= std::min(tick + tickDistance, image.NTicks() - 1);
+               ++t) {
+            int const other = image.Bin(w, t);
+            if (labels[other] >= 0 || !(image.Charge(other) > threshold)) continue;
+            labels[other] = nLabels;
+            group.push_back(other);
+          }
+        }
+      }
+      ++nLabels;
+    }
+    return labels;
+  }
+
+  /// Whether two labellings make the same groups
+  bool SameGroups(std::vector<int> const& a, std::vector<int> const& b)
+  {
+    if (a.size() != b.size()) return false;
+    std::map<int, int> aToB, bToA;
+    for (std::size_t bin = 0; bin < a.size(); ++bin) {
+      if ((a[bin] < 0) != (b[bin] < 0)) return false;
+      if (a[bin] < 0) continue;
+      auto const ab = aToB.emplace(a[bin], b[bin]).first;
+      auto const ba = bToA.emplace(b[bin], a[bin]).first;
+      if (ab->second != b[bin] || ba->second != a[bin]) return false;
+    }
+    return true;
+  }
+
+  template <typename Function>
+  double Milliseconds(Function&& function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::milli> const elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(BlurredClusteringImageSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(KernelTest)
+{
+  auto const kernel = cluster::GaussianKernel(3., 12);
+  BOOST_TEST(kernel.size() == 25u);
+  for (int i = 0; i <= 12; ++i) {
+    BOOST_TEST(kernel[12 + i] == kernel[12 - i]);
+    BOOST_TEST(kernel[12 + i] == Gaussian(3., i), boost::test_tools::tolerance(1e-6));
+  }
+} // BOOST_AUTO_TEST_CASE(KernelTest)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(BlurTest)
+{
+  BlurParameters const par{4, 5, 2, 3, 3};
+
+  std::mt19937 engine(2015);
+  for (int sample = 0; sample < 5; ++sample) {
+    HitImage const hits = MakeHitImage(engine, 60, 300, 4, 40, par.maxTickScale);
+
+    auto const blurred = SeparableBlur(hits, par);
+    auto const expected = DirectBlur(hits, par);
+
+    double const maxCharge = *std::max_element(expected.begin(), expected.end());
+    BOOST_TEST(maxCharge > 0.);
+    for (int bin = 0; bin < blurred.NBins(); ++bin) {
+      BOOST_TEST_INFO("bin " << bin);
+      BOOST_TEST(std::abs(blurred.Charge(bin) - expected[bin]) < 1e-5 * maxCharge);
+    }
+  }
+} // BOOST_AUTO_TEST_CASE(BlurTest)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(DeadWireTest)
+{
+  // One hit next to two dead wires: the blur reaches as many live wires on either side
+  cluster::BlurredImage image(20, 5);
+  image(8, 2) = 1.f;
+  std::vector<bool> deadWires(20, false);
+  deadWires[9] = deadWires[10] = true;
+
+  auto const kernel = cluster::GaussianKernel(2., 3);
+  std::vector<float> const noTickBlur{1.f};
+  cluster::BlurredImage blurred(20, 5);
+  cluster::BlurImage(
+    image,
+    deadWires,
+    kernel,
+    [&](int, int) -> std::vector<float> const& { return noTickBlur; },
+    blurred);
+
+  std::vector<float> const expected{
+    0, 0, 0, 0, 0, kernel[0], kernel[1], kernel[2], kernel[3], // wires 0-8
+    kernel[4], kernel[4], kernel[4], kernel[5], kernel[6],     // wires 9-13
+    0, 0, 0, 0, 0, 0};
+  for (int wire = 0; wire < 20; ++wire) {
+    BOOST_TEST_INFO("wire " << wire);
+    BOOST_TEST(blurred(wire, 2) == expected[wire]);
+  }
+} // BOOST_AUTO_TEST_CASE(DeadWireTest)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(LabelTest)
+{
+  std::mt19937 engine(1234);
+  std::uniform_real_distribution<float> charge(0., 1.);
+  for (int const distance : {0, 1, 2, 3}) {
+    cluster::BlurredImage image(50, 70);
+    for (int bin = 0; bin < image.NBins(); ++bin)
+      image(image.WireOfBin(bin), image.TickOfBin(bin)) = charge(engine);
+
+    std::vector<int> labels;
+    int const nLabels = cluster::LabelComponents(image, 0.8, distance, distance + 1, labels);
+    auto const expected = FloodFillLabels(image, 0.8, distance, distance + 1);
+
+    BOOST_TEST(nLabels == *std::max_element(expected.begin(), expected.end()) + 1);
+    BOOST_TEST(SameGroups(labels, expected));
+  }
+} // BOOST_AUTO_TEST_CASE(LabelTest)
+
+//******************************************************************************
+// Not a test as such: reports the time taken on a full APA collection plane, and the time
+// taken the way BlurredClusteringAlg did it before: an image of nested vectors of doubles
+// blurred with the 2D kernel around each hit, and clusters grown from seeds taken from all
+// the bins in charge order
+BOOST_AUTO_TEST_CASE(BenchmarkTest)
+{
+  constexpr int kNumWires = 960;  // collection wires of a ProtoDUNE-SP APA, both faces
+  constexpr int kNumTicks = 6000; // readout window
+  constexpr float kThreshold = 0.07;
+  constexpr int kDistance = 2;
+  BlurParameters const par{4, 8, 3, 4, 3};
+
+  std::mt19937 engine(6000);
+  HitImage const hits = MakeHitImage(engine, kNumWires, kNumTicks, 150, 5000, par.maxTickScale);
+
+  cluster::BlurredImage blurred;
+  double const blurTime = Milliseconds([&] { blurred = SeparableBlur(hits, par); });
+
+  std::vector<int> labels;
+  int nLabels = 0;
+  double const labelTime = Milliseconds(
+    [&] { nLabels = cluster::LabelComponents(blurred, kThreshold, kDistance, kDistance, labels); });
+
+  // The 2D kernels, made once
+  int const kernelWidth = 2 * par.blurWire + 1;
+  std::vector<std::vector<double>> kernels(par.maxTickScale + 1);
+  for (int scale = 1; scale <= par.maxTickScale; ++scale) {
+    int const halfHeight = par.blurTick * scale;
+    for (int dt = -halfHeight; dt <= halfHeight; ++dt) {
+      for (int dw = -par.blurWire; dw <= par.blurWire; ++dw)
+        kernels[scale].push_back(Gaussian(par.sigmaWire, dw) * Gaussian(par.sigmaTick * scale, dt));
+    }
+  }
+
+  std::vector<std::vector<double>> image(kNumWires, std::vector<double>(kNumTicks));
+  for (int wire = 0; wire < kNumWires; ++wire) {
+    for (int tick = 0; tick < kNumTicks; ++tick)
+      image[wire][tick] = hits.image(wire, tick);
+  }
+
+  std::vector<std::vector<double>> nested;
+  double const nestedBlurTime = Milliseconds([&] {
+    nested.assign(kNumWires, std::vector<double>(kNumTicks, 0));
+    for (int wire = 0; wire < kNumWires; ++wire) {
+      for (int tick = 0; tick < kNumTicks; ++tick) {
+        if (image[wire][tick] == 0) continue;
+        int const scale = hits.tickScale[hits.image.Bin(wire, tick)];
+        int const halfHeight = par.blurTick * scale;
+        for (int dw = -par.blurWire; dw <= par.blurWire; ++dw) {
+          if (wire + dw < 0 || wire + dw >= kNumWires) continue;
+          for (int dt = -halfHeight; dt <= halfHeight; ++dt) {
+            if (tick + dt < 0 || tick + dt >= kNumTicks) continue;
+            nested[wire + dw][tick + dt] +=
+              kernels[scale][kernelWidth * (dt + halfHeight) + dw + par.blurWire] *
+              image[wire][tick];
+          }
+        }
+      }
+    }
+  });
+
+  // Seeds down to the threshold, so that every group is grown
+  std::vector<int> grown(blurred.NBins(), -1);
+  double const growTime = Milliseconds([&] {
+    std::vector<std::pair<double, int>> values;
+    for (int wire = 0; wire < kNumWires; ++wire) {
+      for (int tick = 0; tick < kNumTicks; ++tick)
+        values.emplace_back(blurred(wire, tick), blurred.Bin(wire, tick));
+    }
+    std::sort(values.rbegin(), values.rend());
+
+    int nGrown = 0;
+    for (auto const& [charge, seed] : values) {
+      if (!(charge > kThreshold)) break;
+      if (grown[seed] >= 0) continue;
+      std::vector<int> group{seed};
+      grown[seed] = nGrown;
+      bool added = true;
+      while (added) {
+        added = false;
+        for (unsigned int i = 0; i < group.size(); ++i) {
+          int const wire = blurred.WireOfBin(group[i]);
+          int const tick = blurred.TickOfBin(group[i]);
+          for (int w = wire - kDistance; w <= wire + kDistance; ++w) {
+            if (w < 0 || w >= kNumWires) continue;
+            for (int t = tick - kDistance; t <= tick + kDistance; ++t) {
+              if (t < 0 || t >= kNumTicks) continue;
+              int const bin = blurred.Bin(w, t);
+              if (grown[bin] >= 0 || !(blurred.Charge(bin) > kThreshold)) continue;
+              grown[bin] = nGrown;
+              group.push_back(bin);
+              added = true;
+            }
+          }
+        }
+      }
+      ++nGrown;
+    }
+  });
+  BOOST_TEST(SameGroups(labels, grown));
+
+  BOOST_TEST_MESSAGE("Image of " << kNumWires << " wires x " << kNumTicks << " ticks, "
+                                 << std::count_if(hits.tickScale.begin(),
+                                                  hits.tickScale.end(),
+                                                  [](int scale) { return scale > 0; })
+                                 << " hits, " << nLabels << " groups");
+  BOOST_TEST_MESSAGE("blur: " << blurTime << " ms separable, " << nestedBlurTime
+                              << " ms with the 2D kernel");
+  BOOST_TEST_MESSAGE("groups: " << labelTime << " ms labelled, " << growTime
+                                << " ms grown from sorted seeds");
+} // BOOST_AUTO_TEST_CASE(BenchmarkTest)
+
+BOOST_AUTO_TEST_SUITE_END()
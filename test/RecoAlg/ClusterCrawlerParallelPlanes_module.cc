@@ -0,0 +1,293 @@
+/// \class ClusterCrawlerParallelPlanes
+///
+/// \brief Checks that ClusterCrawlerAlg finds the same results with ParallelPlanes.
+///
+/// Each event, tracks are generated in pairs and triplets from common vertices
+/// in the first TPC of the detector, with one hit per wire they cross on each
+/// plane. The same hits are crawled by a ClusterCrawlerAlg crawling the planes
+/// in turn and by one crawling them concurrently: the hits, the clusters, the
+/// 2D end points and the 3D vertices must all be the same. The time taken by
+/// the two crawlers is printed.
+///
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/DelegatedParameter.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/Exceptions.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "lardata/DetectorInfoServices/DetectorClocksService.h"
+#include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "larreco/RecoAlg/ClusterCrawlerAlg.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cluster {
+
+  class ClusterCrawlerParallelPlanes : public art::EDAnalyzer {
+  public:
+    struct Config {
+      using Name = fhicl::Name;
+      using Comment = fhicl::Comment;
+      fhicl::Atom<unsigned int> nVertices{Name("nVertices"),
+                                          Comment("Vertices generated per event")};
+      fhicl::Atom<double> minLength{Name("minLength"), Comment("Minimum track length [cm]")};
+      fhicl::Atom<unsigned int> seed{Name("seed"), Comment("Seed of the track generation")};
+      fhicl::DelegatedParameter clusterCrawlerAlg{
+        Name("ClusterCrawlerAlg"),
+        Comment("Configuration of both crawlers; ParallelPlanes is set by the test")};
+    };
+    using Parameters = art::EDAnalyzer::Table<Config>;
+
+    explicit ClusterCrawlerParallelPlanes(Parameters const& p);
+
+  private:
+    void analyze(art::Event const& e) override;
+
+    /// Adds the hits of the straight track from `start` to `end`
+    void generateTrack(detinfo::DetectorPropertiesData const& detProp,
+                       geo::Point_t const& start,
+                       geo::Point_t const& end,
+                       std::vector<recob::Hit>& hits);
+
+    /// Crawls `hits` with `alg`, returns the time taken [s]
+    static double crawl(ClusterCrawlerAlg& alg,
+                        detinfo::DetectorClocksData const& clockData,
+                        detinfo::DetectorPropertiesData const& detProp,
+                        std::vector<recob::Hit> const& hits);
+
+    /// Throws unless `serial` and `parallel` have the same results
+    static void compare(ClusterCrawlerAlg& serial, ClusterCrawlerAlg& parallel);
+
+    /// Makes a crawler configured as in `pset`, with ParallelPlanes set to `parallel`
+    static ClusterCrawlerAlg makeCrawler(fhicl::ParameterSet pset, bool parallel);
+
+    Parameters p_;
+    ClusterCrawlerAlg fSerial;
+    ClusterCrawlerAlg fParallel;
+    art::ServiceHandle<geo::Geometry const> geom;
+    std::mt19937 rng;
+
+    double fSerialTime = 0.;
+    double fParallelTime = 0.;
+  };
+
+}
+
+cluster::ClusterCrawlerAlg cluster::ClusterCrawlerParallelPlanes::makeCrawler(
+  fhicl::ParameterSet pset,
+  bool parallel)
+{
+  pset.put_or_replace("ParallelPlanes", parallel);
+  pset.put_or_replace("DebugPlane", -1);
+  return ClusterCrawlerAlg{pset};
+}
+
+cluster::ClusterCrawlerParallelPlanes::ClusterCrawlerParallelPlanes(Parameters const& p)
+  : EDAnalyzer{p}
+  , p_(p)
+  , fSerial{makeCrawler(p_().clusterCrawlerAlg.get<fhicl::ParameterSet>(), false)}
+  , fParallel{makeCrawler(p_().clusterCrawlerAlg.get<fhicl::ParameterSet>(), true)}
+  , rng(p_().seed())
+{}
+
+void cluster::ClusterCrawlerParallelPlanes::generateTrack(
+  detinfo::DetectorPropertiesData const& detProp,
+  geo::Point_t const& start,
+  geo::Point_t const& end,
+  std::vector<recob::Hit>& hits)
+{
+  geo::TPCGeo const& tpc = geom->TPC(geo::TPCID{0, 0});
+
+  // walk along the track, with a hit each time a new wire is reached on a plane
+  std::normal_distribution<double> smear(0., 1.);
+  constexpr double step = 0.1;
+  geo::Vector_t const dir = (end - start).Unit();
+  size_t const nSteps = (end - start).R() / step;
+
+  std::vector<geo::WireID> lastWire(tpc.Nplanes());
+  for (size_t s = 0; s <= nSteps; ++s) {
+    geo::Point_t const pos = start + (s * step) * dir;
+    for (unsigned int ipl = 0; ipl < tpc.Nplanes(); ++ipl) {
+      geo::PlaneGeo const& plane = tpc.Plane(ipl);
+      geo::WireID wid;
+      try {
+        wid = plane.NearestWireID(pos);
+      }
+      catch (geo::InvalidWireError const&) {
+        continue;
+      }
+      if (wid == lastWire[ipl]) continue;
+      lastWire[ipl] = wid;
+
+      constexpr float rms = 3.;
+      float const tick = detProp.ConvertXToTicks(pos.X(), plane.ID()) + rms * smear(rng) / 4.;
+      hits.emplace_back(geom->PlaneWireToChannel(wid),
+                        tick - 3 * rms,
+                        tick + 3 * rms,
+                        tick,
+                        rms / 4.,
+                        rms,
+                        100.,
+                        5.,
+                        750.,
+                        750.,
+                        20.,
+                        1,
+                        0, // Multiplicity, LocalIndex
+                        1.,
+                        3, // GoodnessOfFit, DOF
+                        plane.View(),
+                        geom->SignalType(plane.ID()),
+                        wid);
+    }
+  }
+}
+
+double cluster::ClusterCrawlerParallelPlanes::crawl(ClusterCrawlerAlg& alg,
+                                                     detinfo::DetectorClocksData const& clockData,
+                                                     detinfo::DetectorPropertiesData const& detProp,
+                                                     std::vector<recob::Hit> const& hits)
+{
+  alg.ClearResults();
+  auto const start = std::chrono::steady_clock::now();
+  alg.RunCrawler(clockData, detProp, hits);
+  std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void cluster::ClusterCrawlerParallelPlanes::compare(ClusterCrawlerAlg& serial,
+                                                    ClusterCrawlerAlg& parallel)
+{
+  auto const mismatch = [](std::string const& what, size_t index) {
+    return cet::exception("ClusterCrawlerParallelPlanes")
+           << what << " " << index << " differs with ParallelPlanes\n";
+  };
+  auto const count = [](std::string const& what, size_t serialSize, size_t parallelSize) {
+    return cet::exception("ClusterCrawlerParallelPlanes")
+           << serialSize << " " << what << " crawling the planes in turn, " << parallelSize
+           << " with ParallelPlanes\n";
+  };
+
+  std::vector<recob::Hit> const serialHits = serial.GetHits();
+  std::vector<recob::Hit> const parallelHits = parallel.GetHits();
+  if (serialHits.size() != parallelHits.size())
+    throw count("hits", serialHits.size(), parallelHits.size());
+  for (size_t i = 0; i < serialHits.size(); ++i) {
+    recob::Hit const& a = serialHits[i];
+    recob::Hit const& b = parallelHits[i];
+    if (a.Channel() != b.Channel() || a.WireID() != b.WireID() ||
+        a.StartTick() != b.StartTick() || a.EndTick() != b.EndTick() ||
+        a.PeakTime() != b.PeakTime() || a.RMS() != b.RMS() ||
+        a.PeakAmplitude() != b.PeakAmplitude() || a.Integral() != b.Integral() ||
+        a.Multiplicity() != b.Multiplicity() || a.LocalIndex() != b.LocalIndex())
+      throw mismatch("Hit", i);
+  }
+  if (serial.GetinClus() != parallel.GetinClus()) throw mismatch("Cluster assignment of hits", 0);
+
+  auto const& serialClusters = serial.GetClusters();
+  auto const& parallelClusters = parallel.GetClusters();
+  if (serialClusters.size() != parallelClusters.size())
+    throw count("clusters", serialClusters.size(), parallelClusters.size());
+  for (size_t i = 0; i < serialClusters.size(); ++i) {
+    auto const& a = serialClusters[i];
+    auto const& b = parallelClusters[i];
+    if (a.ID != b.ID || a.ProcCode != b.ProcCode || a.StopCode != b.StopCode || a.CTP != b.CTP ||
+        a.BeginSlp != b.BeginSlp || a.BeginSlpErr != b.BeginSlpErr ||
+        a.BeginAng != b.BeginAng || a.BeginWir != b.BeginWir || a.BeginTim != b.BeginTim ||
+        a.BeginChg != b.BeginChg || a.BeginChgNear != b.BeginChgNear ||
+        a.BeginVtx != b.BeginVtx || a.EndSlp != b.EndSlp || a.EndAng != b.EndAng ||
+        a.EndSlpErr != b.EndSlpErr || a.EndWir != b.EndWir || a.EndTim != b.EndTim ||
+        a.EndChg != b.EndChg || a.EndChgNear != b.EndChgNear || a.EndVtx != b.EndVtx ||
+        a.tclhits != b.tclhits)
+      throw mismatch("Cluster", i);
+  }
+
+  auto const& serialEndPoints = serial.GetEndPoints();
+  auto const& parallelEndPoints = parallel.GetEndPoints();
+  if (serialEndPoints.size() != parallelEndPoints.size())
+    throw count("2D end points", serialEndPoints.size(), parallelEndPoints.size());
+  for (size_t i = 0; i < serialEndPoints.size(); ++i) {
+    auto const& a = serialEndPoints[i];
+    auto const& b = parallelEndPoints[i];
+    if (a.Wire != b.Wire || a.WireErr != b.WireErr || a.Time != b.Time ||
+        a.TimeErr != b.TimeErr || a.NClusters != b.NClusters || a.ChiDOF != b.ChiDOF ||
+        a.Topo != b.Topo || a.CTP != b.CTP || a.Fixed != b.Fixed)
+      throw mismatch("2D end point", i);
+  }
+
+  auto const& serialVertices = serial.GetVertices();
+  auto const& parallelVertices = parallel.GetVertices();
+  if (serialVertices.size() != parallelVertices.size())
+    throw count("3D vertices", serialVertices.size(), parallelVertices.size());
+  for (size_t i = 0; i < serialVertices.size(); ++i) {
+    auto const& a = serialVertices[i];
+    auto const& b = parallelVertices[i];
+    if (a.Ptr2D != b.Ptr2D || a.X != b.X || a.XErr != b.XErr || a.Y != b.Y || a.YErr != b.YErr ||
+        a.Z != b.Z || a.ZErr != b.ZErr || a.Wire != b.Wire || a.CStat != b.CStat ||
+        a.TPC != b.TPC || a.ProcCode != b.ProcCode)
+      throw mismatch("3D vertex", i);
+  }
+}
+
+void cluster::ClusterCrawlerParallelPlanes::analyze(art::Event const& e)
+{
+  auto const clockData = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(e);
+  auto const detProp =
+    art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e, clockData);
+
+  // two or three tracks from each vertex, so that there are vertices to match across planes
+  geo::BoxBoundedGeo const& box = geom->TPC(geo::TPCID{0, 0}).ActiveBoundingBox();
+  constexpr double margin = 2.;
+  std::uniform_real_distribution<double> ux(box.MinX() + margin, box.MaxX() - margin);
+  std::uniform_real_distribution<double> uy(box.MinY() + margin, box.MaxY() - margin);
+  std::uniform_real_distribution<double> uz(box.MinZ() + margin, box.MaxZ() - margin);
+  std::uniform_int_distribution<unsigned int> utracks(2, 3);
+
+  std::vector<recob::Hit> hits;
+  for (unsigned int ivx = 0; ivx < p_().nVertices(); ++ivx) {
+    geo::Point_t const vertex(ux(rng), uy(rng), uz(rng));
+    for (unsigned int itk = utracks(rng); itk > 0; --itk) {
+      geo::Point_t end;
+      do {
+        end = geo::Point_t(ux(rng), uy(rng), uz(rng));
+      } while ((end - vertex).R() < p_().minLength());
+      generateTrack(detProp, vertex, end, hits);
+    }
+  }
+
+  double const serialTime = crawl(fSerial, clockData, detProp, hits);
+  double const parallelTime = crawl(fParallel, clockData, detProp, hits);
+  fSerialTime += serialTime;
+  fParallelTime += parallelTime;
+
+  try {
+    compare(fSerial, fParallel);
+  }
+  catch (cet::exception& ex) {
+    throw ex << "Event " << e.event() << ": " << hits.size() << " hits\n";
+  }
+
+  mf::LogInfo("ClusterCrawlerParallelPlanes")
+    << hits.size() << " hits, " << fSerial.GetClusters().size() << " clusters, "
+    << fSerial.GetEndPoints().size() << " 2D end points, " << fSerial.GetVertices().size()
+    << " 3D vertices, the same with ParallelPlanes\n"
+    << "  in turn:        " << 1e3 * serialTime << " ms\n"
+    << "  ParallelPlanes: " << 1e3 * parallelTime << " ms\n"
+    << "  speedup:        " << serialTime / parallelTime << " (cumulative "
+    << fSerialTime / fParallelTime << ")";
+}
+
+DEFINE_ART_MODULE(cluster::ClusterCrawlerParallelPlanes)
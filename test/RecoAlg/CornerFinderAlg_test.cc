@@ -0,0 +1,389 @@
+/**
+ * @file   CornerFinderAlg_test.cc
+ * @brief  Test of the image processing of CornerFinderAlg against the histogram based one
+ * @see    CornerFinderAlg.h
+ *
+ * A small synthetic image (two tracks from a vertex and a crossing one, on a
+ * noisy background) is processed by CornerFinderAlg, which works on plain
+ * buffers, and by the TH2/TF2 implementation it replaced, kept here as the
+ * reference. For several conversion, derivative and corner score settings the
+ * corner score images and the feature points must be the same; the scores
+ * differ only by the rounding of the blur table of the reference (6 decimals).
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (CornerFinderAlg_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/CornerFinderAlg.h"
+
+// framework libraries
+#include "fhiclcpp/ParameterSet.h"
+
+// ROOT libraries
+#include "TF2.h"
+#include "TH2.h"
+
+namespace {
+
+  constexpr int kWires = 64;
+  constexpr int kTicks = 96;
+
+  /// The settings which are varied
+  struct Settings {
+    std::string conversion;
+    int derivativeNeighborhood;
+    std::string derivative;
+    int blurNeighborhood;
+    std::string cornerScore;
+  };
+
+  fhicl::ParameterSet makeConfig(Settings const& s)
+  {
+    fhicl::ParameterSet pset;
+
+    pset.put_or_replace<std::string>("CalDataModuleLabel", "caldata");
+    pset.put_or_replace<float>("Trimming_threshold", 10);
+    pset.put_or_replace<double>("Trimming_totalThreshold", 5e4);
+    pset.put_or_replace<std::string>("Conversion_algorithm", s.conversion);
+    pset.put_or_replace<std::string>("Conversion_function",
+                                     "TMath::Gaus(x,0,1)*TMath::Gaus(y,0,1)");
+    pset.put_or_replace<int>("Conversion_func_neighborhood", 3);
+    pset.put_or_replace<float>("Conversion_threshold", 2);
+    pset.put_or_replace<int>("Conversion_bins_per_input_x", 1);
+    pset.put_or_replace<int>("Conversion_bins_per_input_y", 1);
+    pset.put_or_replace<std::string>("Derivative_method", s.derivative);
+    pset.put_or_replace<int>("Derivative_neighborhood", s.derivativeNeighborhood);
+    pset.put_or_replace<std::string>("Derivative_BlurFunc", "NotImplemented");
+    pset.put_or_replace<int>("Derivative_BlurNeighborhood", s.blurNeighborhood);
+    pset.put_or_replace<float>("CornerScore_Noble_epsilon", 1e-5);
+    pset.put_or_replace<float>("CornerScore_Harris_kappa", 0.05);
+    pset.put_or_replace<int>("CornerScore_neighborhood", 1);
+    pset.put_or_replace<std::string>("CornerScore_algorithm", s.cornerScore);
+    pset.put_or_replace<int>("MaxSuppress_neighborhood", 3);
+    pset.put_or_replace<int>("MaxSuppress_threshold", 1);
+    pset.put_or_replace<float>("Integral_bin_threshold", 5);
+    pset.put_or_replace<float>("Integral_fraction_threshold", 0.95);
+
+    return pset;
+  }
+
+  /// Adds a track of Gaussian profile across the wires, from (w0, t0) to (w1, t1)
+  void addTrack(TH2F& image, double w0, double t0, double w1, double t1, double amplitude)
+  {
+    double const dw = w1 - w0, dt = t1 - t0;
+    double const length2 = dw * dw + dt * dt;
+    for (int ix = 1; ix <= kWires; ++ix) {
+      for (int iy = 1; iy <= kTicks; ++iy) {
+        double const f = std::clamp(((ix - w0) * dw + (iy - t0) * dt) / length2, 0., 1.);
+        double const ddw = ix - (w0 + f * dw), ddt = iy - (t0 + f * dt);
+        double const d2 = ddw * ddw + ddt * ddt / 4.;
+        image.AddBinContent(image.GetBin(ix, iy), amplitude * std::exp(-d2));
+      }
+    }
+  }
+
+  TH2F makeImage()
+  {
+    TH2F image("h_WireData_test", "", kWires, 0, kWires, kTicks, 0, kTicks);
+    image.SetDirectory(nullptr);
+
+    // the noise also breaks the ties between the maxima of the corner score
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<double> noise(0., 1.5);
+    for (int ix = 1; ix <= kWires; ++ix) {
+      for (int iy = 1; iy <= kTicks; ++iy)
+        image.SetBinContent(ix, iy, noise(rng));
+    }
+
+    addTrack(image, 20., 30., 50., 80., 40.);
+    addTrack(image, 20., 30., 8., 85., 30.);
+    addTrack(image, 5., 15., 60., 20., 25.);
+    return image;
+  }
+
+  /// The histogram based image processing of CornerFinderAlg before it moved to plain buffers
+  class ReferenceCornerFinder {
+  public:
+    explicit ReferenceCornerFinder(Settings const& s) : fSettings(s) {}
+
+    /// Fills the corner score and returns the feature points (wire, tick, score)
+    std::vector<std::array<double, 3>> findFeaturePoints(TH2F const& h_wire_data,
+                                                         TH2D& h_cornerScore) const
+    {
+      TH2F h_conversion("h_conversion_ref", "", kWires, 0, kWires, kTicks, 0, kTicks);
+      TH2F h_derivative_x("h_derivative_x_ref", "", kWires, 0, kWires, kTicks, 0, kTicks);
+      TH2F h_derivative_y("h_derivative_y_ref", "", kWires, 0, kWires, kTicks, 0, kTicks);
+      for (TH2F* h : {&h_conversion, &h_derivative_x, &h_derivative_y})
+        h->SetDirectory(nullptr);
+
+      createImage(h_wire_data, h_conversion);
+      createDerivatives(h_conversion, h_derivative_x, h_derivative_y);
+      createCornerScore(h_derivative_x, h_derivative_y, h_cornerScore);
+      return maximumSuppression(h_cornerScore);
+    }
+
+  private:
+    static constexpr float kThreshold = 2;
+    static constexpr int kConversionNeighborhood = 3;
+    static constexpr int kCornerScoreNeighborhood = 1;
+    static constexpr int kMaxSuppressNeighborhood = 3;
+
+    void createImage(TH2F const& h_wire_data, TH2F& h_conversion) const
+    {
+      const TF2 conversion_TF2(
+        "fConversion_func_ref", "TMath::Gaus(x,0,1)*TMath::Gaus(y,0,1)", -20, 20, -20, 20);
+      std::string const& algorithm = fSettings.conversion;
+
+      for (int ix = 1; ix <= h_conversion.GetNbinsX(); ix++) {
+        for (int iy = 1; iy <= h_conversion.GetNbinsY(); iy++) {
+          double temp_integral = h_wire_data.Integral(ix, ix, iy, iy);
+
+          if (temp_integral <= kThreshold) {
+            h_conversion.SetBinContent(ix, iy, kThreshold);
+            continue;
+          }
+
+          if (algorithm == "binary")
+            h_conversion.SetBinContent(ix, iy, 10 * kThreshold);
+          else if (algorithm == "function") {
+            temp_integral = 0;
+            for (int jx = ix - kConversionNeighborhood; jx <= ix + kConversionNeighborhood; jx++) {
+              for (int jy = iy - kConversionNeighborhood; jy <= iy + kConversionNeighborhood;
+                   jy++) {
+                temp_integral +=
+                  h_wire_data.GetBinContent(jx, jy) * conversion_TF2.Eval(ix - jx, iy - jy);
+              }
+            }
+            h_conversion.SetBinContent(ix, iy, temp_integral);
+          }
+          else if (algorithm == "skeleton") {
+            if ((temp_integral > h_wire_data.GetBinContent(ix - 1, iy) &&
+                 temp_integral > h_wire_data.GetBinContent(ix + 1, iy)) ||
+                (temp_integral > h_wire_data.GetBinContent(ix, iy - 1) &&
+                 temp_integral > h_wire_data.GetBinContent(ix, iy + 1)))
+              h_conversion.SetBinContent(ix, iy, temp_integral);
+            else
+              h_conversion.SetBinContent(ix, iy, kThreshold);
+          }
+          else
+            h_conversion.SetBinContent(ix, iy, temp_integral);
+        }
+      }
+    }
+
+    void createDerivatives(TH2F const& c, TH2F& h_derivative_x, TH2F& h_derivative_y) const
+    {
+      int const n = fSettings.derivativeNeighborhood;
+      bool const sobel = (fSettings.derivative == "Sobel");
+      auto I = [&c](int x, int y) { return c.GetBinContent(x, y); };
+
+      for (int iy = 1 + n; iy <= (c.GetNbinsY() - n); iy++) {
+        for (int ix = 1 + n; ix <= (c.GetNbinsX() - n); ix++) {
+          if (sobel && n == 1) {
+            h_derivative_x.SetBinContent(ix,
+                                         iy,
+                                         0.5 * (I(ix + 1, iy) - I(ix - 1, iy)) +
+                                           0.25 * (I(ix + 1, iy + 1) - I(ix - 1, iy + 1)) +
+                                           0.25 * (I(ix + 1, iy - 1) - I(ix - 1, iy - 1)));
+            h_derivative_y.SetBinContent(ix,
+                                         iy,
+                                         0.5 * (I(ix, iy + 1) - I(ix, iy - 1)) +
+                                           0.25 * (I(ix - 1, iy + 1) - I(ix - 1, iy - 1)) +
+                                           0.25 * (I(ix + 1, iy + 1) - I(ix + 1, iy - 1)));
+          }
+          else if (sobel && n == 2) {
+            h_derivative_x.SetBinContent(
+              ix,
+              iy,
+              12 * (I(ix + 1, iy) - I(ix - 1, iy)) + 8 * (I(ix + 1, iy + 1) - I(ix - 1, iy + 1)) +
+                8 * (I(ix + 1, iy - 1) - I(ix - 1, iy - 1)) +
+                2 * (I(ix + 1, iy + 2) - I(ix - 1, iy + 2)) +
+                2 * (I(ix + 1, iy - 2) - I(ix - 1, iy - 2)) + 6 * (I(ix + 2, iy) - I(ix - 2, iy)) +
+                4 * (I(ix + 2, iy + 1) - I(ix - 2, iy + 1)) +
+                4 * (I(ix + 2, iy - 1) - I(ix - 2, iy - 1)) +
+                1 * (I(ix + 2, iy + 2) - I(ix - 2, iy + 2)) +
+                1 * (I(ix + 2, iy - 2) - I(ix - 2, iy - 2)));
+            h_derivative_y.SetBinContent(
+              ix,
+              iy,
+              12 * (I(ix, iy + 1) - I(ix, iy - 1)) + 8 * (I(ix - 1, iy + 1) - I(ix - 1, iy - 1)) +
+                8 * (I(ix + 1, iy + 1) - I(ix + 1, iy - 1)) +
+                2 * (I(ix - 2, iy + 1) - I(ix - 2, iy - 1)) +
+                2 * (I(ix + 2, iy + 1) - I(ix + 2, iy - 1)) + 6 * (I(ix, iy + 2) - I(ix, iy - 2)) +
+                4 * (I(ix - 1, iy + 2) - I(ix - 1, iy - 2)) +
+                4 * (I(ix + 1, iy + 2) - I(ix + 1, iy - 2)) +
+                1 * (I(ix - 2, iy + 2) - I(ix - 2, iy - 2)) +
+                1 * (I(ix + 2, iy + 2) - I(ix + 2, iy - 2)));
+          }
+          else { // local
+            h_derivative_x.SetBinContent(ix, iy, I(ix + 1, iy) - I(ix - 1, iy));
+            h_derivative_y.SetBinContent(ix, iy, I(ix, iy + 1) - I(ix, iy - 1));
+          }
+        }
+      }
+
+      int const nBlur = fSettings.blurNeighborhood;
+      if (nBlur == 0) return;
+
+      // the double Gaussian table, rounded to 6 decimals as it was written out
+      float func_blur[11][11];
+      for (int a = 0; a < 11; a++) {
+        for (int b = 0; b < 11; b++) {
+          double const d2 = (a - 5) * (a - 5) + (b - 5) * (b - 5);
+          func_blur[a][b] = std::round(1e6 * std::exp(-0.5 * d2)) / 1e6;
+        }
+      }
+
+      TH2F h_clone_derivative_x(h_derivative_x);
+      TH2F h_clone_derivative_y(h_derivative_y);
+      h_clone_derivative_x.SetDirectory(nullptr);
+      h_clone_derivative_y.SetDirectory(nullptr);
+
+      for (int ix = 1; ix <= h_derivative_x.GetNbinsX(); ix++) {
+        for (int iy = 1; iy <= h_derivative_y.GetNbinsY(); iy++) {
+          double temp_integral_x = 0;
+          double temp_integral_y = 0;
+          for (int jx = ix - nBlur; jx <= ix + nBlur; jx++) {
+            for (int jy = iy - nBlur; jy <= iy + nBlur; jy++) {
+              temp_integral_x += h_clone_derivative_x.GetBinContent(jx, jy) *
+                                 func_blur[(ix - jx) + 5][(iy - jy) + 5];
+              temp_integral_y += h_clone_derivative_y.GetBinContent(jx, jy) *
+                                 func_blur[(ix - jx) + 5][(iy - jy) + 5];
+            }
+          }
+          h_derivative_x.SetBinContent(ix, iy, temp_integral_x);
+          h_derivative_y.SetBinContent(ix, iy, temp_integral_y);
+        }
+      }
+    }
+
+    void createCornerScore(TH2F const& dx, TH2F const& dy, TH2D& h_cornerScore) const
+    {
+      int const n = kCornerScoreNeighborhood;
+      for (int iy = 1 + n; iy <= (dx.GetNbinsY() - n); iy++) {
+        for (int ix = 1 + n; ix <= (dx.GetNbinsX() - n); ix++) {
+          double st_xx = 0., st_xy = 0., st_yy = 0.;
+          for (int jx = ix - n; jx <= ix + n; jx++) {
+            for (int jy = iy - n; jy <= iy + n; jy++) {
+              st_xx += dx.GetBinContent(jx, jy) * dx.GetBinContent(jx, jy);
+              st_yy += dy.GetBinContent(jx, jy) * dy.GetBinContent(jx, jy);
+              st_xy += dx.GetBinContent(jx, jy) * dy.GetBinContent(jx, jy);
+            }
+          }
+          if (fSettings.cornerScore == "Noble")
+            h_cornerScore.SetBinContent(
+              ix, iy, (st_xx * st_yy - st_xy * st_xy) / (st_xx + st_yy + 1e-5F));
+          else
+            h_cornerScore.SetBinContent(
+              ix, iy, (st_xx * st_yy - st_xy * st_xy) - ((st_xx + st_yy) * (st_xx + st_yy) * 0.05F));
+        }
+      }
+    }
+
+    std::vector<std::array<double, 3>> maximumSuppression(TH2D const& h_cornerScore) const
+    {
+      std::vector<std::array<double, 3>> points;
+      int const n = kMaxSuppressNeighborhood;
+      for (int iy = 1; iy <= h_cornerScore.GetNbinsY(); iy++) {
+        for (int ix = 1; ix <= h_cornerScore.GetNbinsX(); ix++) {
+          if (h_cornerScore.GetBinContent(ix, iy) < 1) continue;
+
+          double temp_max = -1000;
+          bool temp_center_bin = false;
+          for (int jx = ix - n; jx <= ix + n; jx++) {
+            for (int jy = iy - n; jy <= iy + n; jy++) {
+              if (h_cornerScore.GetBinContent(jx, jy) > temp_max) {
+                temp_max = h_cornerScore.GetBinContent(jx, jy);
+                temp_center_bin = (jx == ix && jy == iy);
+              }
+            }
+          }
+          if (temp_center_bin)
+            points.push_back({double(ix), double(iy), h_cornerScore.GetBinContent(ix, iy)});
+        }
+      }
+      return points;
+    }
+
+    Settings fSettings;
+  };
+
+  void compare(Settings const& settings)
+  {
+    BOOST_TEST_MESSAGE("Conversion " << settings.conversion << ", " << settings.derivative << " "
+                                     << settings.derivativeNeighborhood << ", blur "
+                                     << settings.blurNeighborhood << ", "
+                                     << settings.cornerScore);
+
+    TH2F const image = makeImage();
+
+    std::vector<geo::WireID> wireIDs;
+    for (int w = 0; w <= kWires; ++w)
+      wireIDs.emplace_back(0, 0, 2, w);
+
+    corner::CornerFinderAlg alg(makeConfig(settings));
+    std::vector<recob::EndPoint2D> corners;
+    alg.attach_feature_points(image, wireIDs, geo::kW, corners);
+    corner::Image<double> const& score = alg.GetCornerScoreImage();
+
+    TH2D referenceScore("h_cornerScore_ref", "", kWires, 0, kWires, kTicks, 0, kTicks);
+    referenceScore.SetDirectory(nullptr);
+    auto const reference =
+      ReferenceCornerFinder(settings).findFeaturePoints(image, referenceScore);
+
+    // the blur table of the reference is rounded, the difference scales with the largest score
+    double const scale = std::max(referenceScore.GetMaximum(), -referenceScore.GetMinimum());
+    BOOST_TEST_REQUIRE(scale > 0.);
+    BOOST_TEST_REQUIRE(score.NX() == kWires);
+    BOOST_TEST_REQUIRE(score.NY() == kTicks);
+    double const tolerance = (settings.blurNeighborhood > 0 ? 1e-3 : 1e-6) * scale;
+    for (int iy = 1; iy <= kTicks; ++iy) {
+      for (int ix = 1; ix <= kWires; ++ix) {
+        double const expected = referenceScore.GetBinContent(ix, iy);
+        BOOST_TEST(std::abs(score(ix, iy) - expected) <= tolerance,
+                   "bin (" << ix << ", " << iy << "): " << score(ix, iy) << " against "
+                           << expected);
+      }
+    }
+
+    BOOST_TEST_REQUIRE(!reference.empty());
+    BOOST_TEST_REQUIRE(corners.size() == reference.size());
+    for (std::size_t i = 0; i < corners.size(); ++i) {
+      BOOST_TEST(corners[i].WireID().Wire == reference[i][0]);
+      BOOST_TEST(corners[i].DriftTime() == reference[i][1]);
+      BOOST_TEST(std::abs(corners[i].Strength() - reference[i][2]) <= tolerance);
+      BOOST_TEST(corners[i].View() == geo::kW);
+    }
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(Conversion_test)
+{
+  for (std::string conversion : {"standard", "binary", "skeleton", "function"})
+    compare({conversion, 1, "Sobel", 5, "Noble"});
+}
+
+BOOST_AUTO_TEST_CASE(Derivative_test)
+{
+  compare({"standard", 2, "Sobel", 5, "Noble"});
+  compare({"standard", 1, "local", 5, "Noble"});
+  compare({"standard", 1, "Sobel", 0, "Noble"});
+  compare({"standard", 1, "Sobel", 2, "Noble"});
+}
+
+BOOST_AUTO_TEST_CASE(CornerScore_test)
+{
+  compare({"standard", 1, "Sobel", 5, "Harris"});
+  compare({"function", 2, "Sobel", 0, "Harris"});
+}
@@ -0,0 +1,157 @@
+/**
+ * @file   DataProviderAlgDownscale_test.cc
+ * @brief  Test of the downscale kernels of DataProviderAlg
+ * @see    DataProviderAlg.h
+ *
+ * The window reductions used by DataProviderAlg to downscale the drift
+ * direction are compared with scalar loops applying the lifetime correction
+ * sample by sample, as DataProviderAlg did before the kernels were written to
+ * be vectorized, for several window sizes and waveform lengths.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (DataProviderAlgDownscale_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/ImagePatternAlgs/DataProvider/DataProviderAlg.h"
+
+namespace {
+
+  constexpr float kUnset = -12345.;
+
+  /// A waveform with integer values, so that the windows often have ties
+  struct Waveform {
+    std::vector<float> adc;
+    std::vector<float> lifetime;
+
+    Waveform(std::size_t n, unsigned int seed) : adc(n), lifetime(n)
+    {
+      std::mt19937 rng(seed);
+      std::uniform_int_distribution<int> uadc(-20, 60);
+      std::uniform_real_distribution<float> ulifetime(1., 1.5);
+      for (std::size_t k = 0; k < n; ++k) {
+        adc[k] = uadc(rng);
+        lifetime[k] = (k % 7 == 0) ? 1. : ulifetime(rng);
+      }
+    }
+
+    std::vector<float> corrected() const
+    {
+      std::vector<float> c(adc.size());
+      for (std::size_t k = 0; k < adc.size(); ++k)
+        c[k] = adc[k] * lifetime[k];
+      return c;
+    }
+  };
+
+  std::vector<float> referenceMax(Waveform const& wf, std::size_t dst_size, std::size_t window)
+  {
+    std::vector<float> result(dst_size, kUnset);
+    for (std::size_t i = 0, k0 = 0; i < dst_size && k0 + window <= wf.adc.size();
+         ++i, k0 += window) {
+      float max_adc = wf.adc[k0] * wf.lifetime[k0];
+      for (std::size_t k = k0 + 1; k < k0 + window; ++k) {
+        float ak = wf.adc[k] * wf.lifetime[k];
+        if (ak > max_adc) max_adc = ak;
+      }
+      result[i] = max_adc;
+    }
+    return result;
+  }
+
+  std::vector<float> referenceMaxMean(Waveform const& wf, std::size_t dst_size, std::size_t window)
+  {
+    std::vector<float> result(dst_size, kUnset);
+    for (std::size_t i = 0, k0 = 0; i < dst_size && k0 + window <= wf.adc.size();
+         ++i, k0 += window) {
+      std::size_t max_idx = k0;
+      float max_adc = wf.adc[k0] * wf.lifetime[k0];
+      for (std::size_t k = k0 + 1; k < k0 + window; ++k) {
+        float ak = wf.adc[k] * wf.lifetime[k];
+        if (ak > max_adc) {
+          max_adc = ak;
+          max_idx = k;
+        }
+      }
+
+      std::size_t n = 1;
+      if (max_idx > 0) {
+        max_adc += wf.adc[max_idx - 1] * wf.lifetime[max_idx - 1];
+        n++;
+      }
+      if (max_idx + 1 < wf.adc.size()) {
+        max_adc += wf.adc[max_idx + 1] * wf.lifetime[max_idx + 1];
+        n++;
+      }
+      result[i] = max_adc / n;
+    }
+    return result;
+  }
+
+  std::vector<float> referenceMean(Waveform const& wf, std::size_t dst_size, std::size_t window)
+  {
+    std::vector<float> result(dst_size, kUnset);
+    for (std::size_t i = 0, k0 = 0; i < dst_size && k0 + window <= wf.adc.size();
+         ++i, k0 += window) {
+      float sum_adc = 0;
+      for (std::size_t k = k0; k < k0 + window; ++k)
+        sum_adc += wf.adc[k] * wf.lifetime[k];
+      result[i] = sum_adc / window;
+    }
+    return result;
+  }
+
+  using Kernel_t = std::size_t (*)(float*, std::size_t, float const*, std::size_t, std::size_t);
+  using Reference_t = std::vector<float> (*)(Waveform const&, std::size_t, std::size_t);
+
+  /// Runs the kernel over waveforms of several lengths and window sizes; the sums may differ
+  /// by rounding, as the reference products may be contracted with the sums into FMAs
+  void compareKernel(Kernel_t kernel, Reference_t reference, bool exact)
+  {
+    unsigned int seed = 0;
+    for (std::size_t n : {1, 7, 64, 100, 1003, 4492}) {
+      Waveform const wf(n, ++seed);
+      std::vector<float> const c = wf.corrected();
+      for (std::size_t window : {1, 2, 3, 4, 6, 8, 10, 13, 16}) {
+        // as many windows as fit, fewer, and more (the last ones must not be touched)
+        for (std::size_t dst_size : {n / window, n / window / 2, n / window + 3}) {
+          std::vector<float> dst(dst_size, kUnset);
+          std::size_t const written = kernel(dst.data(), dst_size, c.data(), n, window);
+          BOOST_TEST(written == std::min(dst_size, n / window));
+
+          std::vector<float> const expected = reference(wf, dst_size, window);
+          if (exact) { BOOST_TEST(dst == expected, boost::test_tools::per_element()); }
+          else {
+            for (std::size_t i = 0; i < dst_size; ++i)
+              BOOST_TEST(std::abs(dst[i] - expected[i]) <= 1e-5F * (1.F + std::abs(expected[i])),
+                         "window " << i << ": " << dst[i] << " against " << expected[i]);
+          }
+        }
+      }
+    }
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(DownscaleMax_test)
+{
+  compareKernel(img::downscaleWindowsMax, referenceMax, true);
+}
+
+BOOST_AUTO_TEST_CASE(DownscaleMaxMean_test)
+{
+  compareKernel(img::downscaleWindowsMaxMean, referenceMaxMean, false);
+}
+
+BOOST_AUTO_TEST_CASE(DownscaleMean_test)
+{
+  compareKernel(img::downscaleWindowsMean, referenceMean, false);
+}
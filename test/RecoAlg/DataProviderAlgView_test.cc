@@ -0,0 +1,140 @@
+/**
+ * @file   DataProviderAlgView_test.cc
+ * @brief  Test of the image buffer and of the patches of DataProviderAlg
+ * @see    DataProviderAlg.h
+ *
+ * The patches copied from the flat image buffer and the patch views are
+ * compared with patches filled pixel by pixel, around the centre and the
+ * edges of a small image.
+ */
+
+// C/C++ standard libraries
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (DataProviderAlgView_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/ImagePatternAlgs/DataProvider/DataProviderAlg.h"
+
+namespace {
+
+  constexpr float kZero = -0.5;
+
+  /// Image of nWires x nDrifts pixels, with the value 1000 * wire + drift
+  img::DataProviderAlgView makeView(unsigned int nWires, unsigned int nDrifts)
+  {
+    img::DataProviderAlgView view;
+    view.fNWires = nWires;
+    view.fNDrifts = nDrifts;
+    view.fNScaledDrifts = nDrifts;
+    view.fNCachedDrifts = nDrifts;
+    view.resetImage(kZero);
+    for (unsigned int w = 0; w < nWires; ++w) {
+      float* row = view.wireData(w);
+      for (unsigned int d = 0; d < nDrifts; ++d) {
+        row[d] = 1000. * w + d;
+      }
+    }
+    return view;
+  }
+
+  /// The patch filled pixel by pixel, wire after wire.
+  std::vector<float> referencePatch(img::DataProviderAlgView const& view,
+                                    int wire,
+                                    int didx,
+                                    int size_w,
+                                    int size_d)
+  {
+    std::vector<float> patch(size_w * size_d, kZero);
+    int w0 = wire - size_w / 2, w1 = wire + size_w / 2;
+    int d0 = didx - size_d / 2, d1 = didx + size_d / 2;
+    for (int w = w0; w < w1; ++w) {
+      for (int d = d0; d < d1; ++d) {
+        if ((w >= 0) && (w < (int)view.fNWires) && (d >= 0) && (d < (int)view.fNCachedDrifts)) {
+          patch[(w - w0) * size_d + (d - d0)] = 1000. * w + d;
+        }
+      }
+    }
+    return patch;
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(FlatBuffer_test)
+{
+  for (unsigned int nDrifts : {1u, 15u, 16u, 17u, 100u}) {
+    img::DataProviderAlgView view = makeView(7, nDrifts);
+
+    BOOST_TEST(view.fDriftStride % img::DataProviderAlgView::kRowAlignment == 0u);
+    BOOST_TEST(view.fDriftStride >= nDrifts);
+    BOOST_TEST(view.fDriftStride < nDrifts + img::DataProviderAlgView::kRowAlignment);
+    BOOST_TEST(view.fWireDriftData.size() == 7u * view.fDriftStride);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(view.fWireDriftData.data()) % 64 == 0u);
+
+    for (unsigned int w = 0; w < view.fNWires; ++w) {
+      float const* row = view.wireData(w);
+      BOOST_TEST(row == view.fWireDriftData.data() + w * view.fDriftStride);
+      for (unsigned int d = 0; d < nDrifts; ++d) {
+        BOOST_TEST(row[d] == 1000. * w + d);
+      }
+      // the padding keeps the value the image was reset to
+      for (unsigned int d = nDrifts; d < view.fDriftStride; ++d) {
+        BOOST_TEST(row[d] == kZero);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CopyPatch_test)
+{
+  img::DataProviderAlgView const view = makeView(12, 40);
+
+  std::vector<float> patch;
+  for (int size_w : {4, 5, 8}) {
+    for (int size_d : {6, 7, 16}) {
+      for (int wire : {0, 1, 6, 10, 11, 20}) {
+        for (int didx : {0, 3, 20, 37, 39, 60}) {
+          patch.assign(size_w * size_d, 12345.);
+          img::copyImagePatch(view, wire, didx, size_w, size_d, kZero, patch.data());
+          BOOST_TEST(patch == referencePatch(view, wire, didx, size_w, size_d),
+                     boost::test_tools::per_element());
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PatchView_test)
+{
+  img::DataProviderAlgView const view = makeView(12, 40);
+
+  int const size_w = 4, size_d = 8;
+  std::vector<float> patch(size_w * size_d);
+  for (int wire = 0; wire < 14; ++wire) {
+    for (int didx = 0; didx < 42; ++didx) {
+      std::optional<img::ImageView> patchView =
+        img::imagePatchView(view, wire, didx, size_w, size_d);
+
+      bool const inside = (wire >= size_w / 2) && (wire + size_w / 2 <= 12) &&
+                          (didx >= size_d / 2) && (didx + size_d / 2 <= 40);
+      BOOST_TEST(patchView.has_value() == inside);
+      if (!patchView) continue;
+
+      BOOST_TEST(patchView->NWires() == (std::size_t)size_w);
+      BOOST_TEST(patchView->NDrifts() == (std::size_t)size_d);
+      BOOST_TEST(patchView->Stride() == view.fDriftStride);
+
+      img::copyImagePatch(view, wire, didx, size_w, size_d, kZero, patch.data());
+      for (int w = 0; w < size_w; ++w) {
+        for (int d = 0; d < size_d; ++d) {
+          BOOST_TEST((*patchView)(w, d) == patch[w * size_d + d]);
+          BOOST_TEST(patchView->wireData(w)[d] == patch[w * size_d + d]);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,196 @@
+/**
+ * @file   EventArena_test.cc
+ * @brief  Test for the event arena and the containers built on it
+ * @see    EventArena.h
+ */
+
+// C/C++ standard libraries
+#include <iterator>
+#include <list>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (EventArena_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/EventArena.h"
+
+namespace {
+
+  struct Element {
+    int key;
+    std::vector<float> payload;
+  };
+
+  using ElementVec = reco::ChunkedVector<Element, 4>;
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(EventArenaSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(ScopeTest)
+{
+  std::pmr::memory_resource* const heap = reco::EventArena::current();
+
+  BOOST_TEST(heap == std::pmr::new_delete_resource());
+
+  reco::EventArena arena;
+  {
+    reco::EventArena::Scope scope(arena);
+
+    BOOST_TEST(reco::EventArena::current() == arena.resource());
+
+    std::list<int, reco::ArenaAllocator<int>> arenaList;
+    for (int idx = 0; idx < 10000; idx++)
+      arenaList.push_front(idx);
+
+    BOOST_TEST(arenaList.get_allocator().resource() == arena.resource());
+
+    // scopes nest, closing one restores the previous arena
+    reco::EventArena innerArena;
+    {
+      reco::EventArena::Scope innerScope(innerArena);
+
+      BOOST_TEST(reco::EventArena::current() == innerArena.resource());
+    }
+    BOOST_TEST(reco::EventArena::current() == arena.resource());
+  }
+
+  BOOST_TEST(reco::EventArena::current() == heap);
+
+  // ten thousand list nodes but only a handful of blocks from the heap
+  BOOST_TEST(arena.getNumHeapBlocks() > 0u);
+  BOOST_TEST(arena.getNumHeapBlocks() < 10u);
+} // ScopeTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(SharedScopeTest)
+{
+  using IntList = std::list<int, reco::ArenaAllocator<int>>;
+
+  constexpr int numThreads = 4;
+
+  reco::EventArena arena;
+  reco::EventArena::Scope scope(arena);
+
+  // lists made before the tasks start, each filled by one task
+  std::vector<IntList> eventLists(numThreads);
+  std::vector<IntList> taskLists(numThreads);
+  std::vector<std::pmr::memory_resource*> taskResources(numThreads);
+  {
+    reco::EventArena::SharedScope sharedScope(arena);
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < numThreads; thread++) {
+      threads.emplace_back([&, thread]() {
+        reco::EventArena::Scope taskScope(sharedScope.taskArena());
+
+        IntList taskList;
+        for (int idx = 0; idx < 5000; idx++) {
+          eventLists[thread].push_back(idx);
+          taskList.push_back(idx);
+          if (idx % 2) eventLists[thread].pop_front();
+        }
+        taskResources[thread] = taskList.get_allocator().resource();
+        taskLists[thread] = std::move(taskList);
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  for (int thread = 0; thread < numThreads; thread++) {
+    BOOST_TEST(eventLists[thread].size() == 2500u);
+    BOOST_TEST(eventLists[thread].get_allocator().resource() == arena.resource());
+    BOOST_TEST(taskLists[thread].size() == 5000u);
+    BOOST_TEST(taskResources[thread] != arena.resource());
+  }
+
+  // the task arenas are counted with the one they belong to
+  reco::EventArena alone;
+  {
+    reco::EventArena::Scope aloneScope(alone);
+    IntList aloneList(5000, 1);
+  }
+  BOOST_TEST(arena.getNumHeapBlocks() > alone.getNumHeapBlocks());
+} // SharedScopeTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(StableAddressTest)
+{
+  ElementVec elementVec;
+
+  elementVec.emplace_back(Element{0, {1., 2.}});
+
+  const Element* first = &elementVec.front();
+
+  for (int idx = 1; idx < 1000; idx++)
+    elementVec.emplace_back(Element{idx, {}});
+
+  BOOST_TEST(elementVec.size() == 1000u);
+  BOOST_TEST(first == &elementVec[0]);
+  BOOST_TEST(first->payload.size() == 2u);
+  BOOST_TEST(elementVec.back().key == 999);
+
+  int expected = 0;
+  for (const auto& element : elementVec)
+    BOOST_TEST(element.key == expected++);
+
+  BOOST_TEST(std::distance(elementVec.begin(), elementVec.end()) == 1000);
+} // StableAddressTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(SortTest)
+{
+  ElementVec elementVec;
+
+  // keys repeat so the sort must be stable to keep the payload order
+  for (int idx = 0; idx < 200; idx++)
+    elementVec.emplace_back(Element{(idx * 37) % 50, {float(idx)}});
+
+  elementVec.sort([](const auto& left, const auto& right) { return left.key < right.key; });
+
+  for (std::size_t idx = 1; idx < elementVec.size(); idx++) {
+    const Element& previous = elementVec[idx - 1];
+    const Element& current = elementVec[idx];
+
+    BOOST_TEST(previous.key <= current.key);
+    if (previous.key == current.key) BOOST_TEST(previous.payload[0] < current.payload[0]);
+  }
+} // SortTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(MoveTest)
+{
+  reco::EventArena arena;
+  reco::EventArena::Scope scope(arena);
+
+  ElementVec elementVec;
+  for (int idx = 0; idx < 100; idx++)
+    elementVec.emplace_back(Element{idx, {}});
+
+  const Element* first = &elementVec.front();
+
+  ElementVec movedVec(std::move(elementVec));
+
+  BOOST_TEST(elementVec.empty());
+  BOOST_TEST(movedVec.size() == 100u);
+  BOOST_TEST(first == &movedVec.front());
+
+  elementVec = std::move(movedVec);
+
+  BOOST_TEST(movedVec.empty());
+  BOOST_TEST(elementVec.size() == 100u);
+  BOOST_TEST(elementVec[99].key == 99);
+
+  elementVec.clear();
+
+  BOOST_TEST(elementVec.empty());
+} // MoveTest
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,214 @@
+/**
+ * @file   FlatKdTree_test.cc
+ * @brief  Test for the array backed kd tree used by the 3D clustering
+ * @see    FlatKdTree.h
+ *
+ * The neighborhood search is compared against the node based kdTree, the radius
+ * and k nearest neighbor searches against a brute force loop.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (FlatKdTree_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/FlatKdTree.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+
+// framework libraries
+#include "fhiclcpp/ParameterSet.h"
+
+using boost::test_tools::tolerance;
+
+namespace {
+
+  /// Hits on a wire grid with 0.3 cm pitch; some share a coordinate to exercise the median logic.
+  reco::HitPairList makeHits(std::size_t nHits, unsigned int seed)
+  {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<unsigned int> wireDist(0, 60);
+    std::uniform_real_distribution<float> timeDist(0., 40.);
+    std::uniform_int_distribution<unsigned int> tpcDist(0, 1);
+
+    reco::HitPairList hitPairList;
+
+    for (std::size_t idx = 0; idx < nHits; idx++) {
+      unsigned int const tpc = tpcDist(engine);
+      unsigned int const uWire = wireDist(engine);
+      unsigned int const wWire = wireDist(engine);
+      unsigned int const vWire = uWire + wWire / 2;
+      float const time = timeDist(engine);
+
+      Eigen::Vector3f const position(0.1 * std::round(time), 0.3 * uWire, 0.3 * wWire);
+      std::vector<geo::WireID> const wireIDs{geo::WireID(0, tpc, 0, uWire),
+                                             geo::WireID(0, tpc, 1, vWire),
+                                             geo::WireID(0, tpc, 2, wWire)};
+
+      hitPairList.emplace_back(idx,
+                               0,
+                               position,
+                               1.,
+                               time,
+                               0.,
+                               1.,
+                               1.,
+                               1.,
+                               0.,
+                               0.,
+                               0.,
+                               reco::ClusterHit2DVec(3, nullptr),
+                               std::vector<float>(3, 0.),
+                               wireIDs);
+    }
+
+    return hitPairList;
+  }
+
+  fhicl::ParameterSet makeConfig(unsigned int leafBucketSize)
+  {
+    fhicl::ParameterSet pset;
+
+    pset.put_or_replace<bool>("EnableMonitoring", false);
+    pset.put_or_replace<float>("PairSigmaPeakTime", 3.);
+    pset.put_or_replace<float>("RefLeafBestDist", 0.59);
+    pset.put_or_replace<unsigned int>("LeafBucketSize", leafBucketSize);
+
+    return pset;
+  }
+
+  float distance(const Eigen::Vector3f& position, const reco::ClusterHit3D& hit)
+  {
+    return (hit.getPosition() - position).norm();
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(FlatKdTreeSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(NeighborhoodMatchesKdTreeTest)
+{
+  reco::HitPairList hitPairList = makeHits(2000, 12345);
+
+  lar_cluster3d::kdTree nodeTree(makeConfig(1));
+  lar_cluster3d::kdTree::KdTreeNodeList nodeContainer;
+  lar_cluster3d::kdTree::KdTreeNode topNode = nodeTree.BuildKdTree(hitPairList, nodeContainer);
+
+  lar_cluster3d::FlatKdTree flatTree(makeConfig(1));
+  flatTree.BuildKdTree(hitPairList);
+
+  BOOST_TEST(flatTree.size() == hitPairList.size());
+
+  lar_cluster3d::FlatKdTree::CandPairVec candPairVec;
+
+  for (const auto& hit : hitPairList) {
+    lar_cluster3d::kdTree::CandPairList candPairList;
+    float nodeBestDist(std::numeric_limits<float>::max());
+
+    nodeTree.FindNearestNeighbors(&hit, topNode, candPairList, nodeBestDist);
+
+    float flatBestDist(std::numeric_limits<float>::max());
+
+    candPairVec.clear();
+    flatTree.FindNearestNeighbors(&hit, candPairVec, flatBestDist);
+
+    // same neighbors, in the same order
+    BOOST_TEST_REQUIRE(candPairVec.size() == candPairList.size());
+    BOOST_TEST(std::equal(candPairVec.begin(), candPairVec.end(), candPairList.begin()));
+    BOOST_TEST(flatBestDist == nodeBestDist);
+  }
+} // NeighborhoodMatchesKdTreeTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(RadiusSearchTest)
+{
+  reco::HitPairList hitPairList = makeHits(1500, 54321);
+
+  for (unsigned int leafBucketSize : {1u, 8u, 32u}) {
+    lar_cluster3d::FlatKdTree flatTree(makeConfig(leafBucketSize));
+    flatTree.BuildKdTree(hitPairList);
+
+    lar_cluster3d::FlatKdTree::CandPairVec candPairVec;
+
+    for (const auto& hit : hitPairList) {
+      if (hit.getID() % 10) continue;
+
+      Eigen::Vector3f const position = hit.getPosition();
+      float const radius = 1.2;
+
+      std::vector<const reco::ClusterHit3D*> expected;
+      for (const auto& other : hitPairList)
+        if (distance(position, other) <= radius) expected.push_back(&other);
+
+      candPairVec.clear();
+      flatTree.FindWithinRadius(position, radius, candPairVec);
+
+      std::vector<const reco::ClusterHit3D*> found;
+      for (const auto& candPair : candPairVec) {
+        BOOST_TEST(candPair.first <= radius);
+        found.push_back(candPair.second);
+      }
+
+      std::sort(expected.begin(), expected.end());
+      std::sort(found.begin(), found.end());
+
+      BOOST_TEST(found == expected);
+    }
+  }
+} // RadiusSearchTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(KNearestSearchTest)
+{
+  reco::HitPairList hitPairList = makeHits(1500, 2468);
+
+  for (unsigned int leafBucketSize : {1u, 16u}) {
+    lar_cluster3d::FlatKdTree flatTree(makeConfig(leafBucketSize));
+    flatTree.BuildKdTree(hitPairList);
+
+    lar_cluster3d::FlatKdTree::CandPairVec candPairVec;
+
+    for (const auto& hit : hitPairList) {
+      if (hit.getID() % 10) continue;
+
+      Eigen::Vector3f const position = hit.getPosition() + Eigen::Vector3f(0.05, 0.05, 0.05);
+      std::size_t const k = 7;
+
+      std::vector<float> expected;
+      for (const auto& other : hitPairList)
+        expected.push_back(distance(position, other));
+
+      std::sort(expected.begin(), expected.end());
+      expected.resize(k);
+
+      BOOST_TEST_REQUIRE(flatTree.FindKNearest(position, k, candPairVec) == k);
+
+      for (std::size_t idx = 0; idx < k; idx++)
+        BOOST_TEST(candPairVec[idx].first == expected[idx], 1e-3 % tolerance());
+    }
+  }
+} // KNearestSearchTest
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(EmptyTreeTest)
+{
+  lar_cluster3d::FlatKdTree flatTree(makeConfig(4));
+  flatTree.BuildKdTree(reco::HitPairList());
+
+  lar_cluster3d::FlatKdTree::CandPairVec candPairVec;
+
+  BOOST_TEST(flatTree.empty());
+  BOOST_TEST(flatTree.FindWithinRadius(Eigen::Vector3f::Zero(), 10., candPairVec) == 0u);
+  BOOST_TEST(flatTree.FindKNearest(Eigen::Vector3f::Zero(), 3, candPairVec) == 0u);
+} // EmptyTreeTest
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,220 @@
+/// \class PMAlgBenchmark
+///
+/// \brief Measures the tracks per second of ProjectionMatchingAlg::buildTrack.
+///
+/// Each event, many straight tracks are generated in the first TPC of the
+/// detector, as in a high-multiplicity event, with one hit per wire they cross
+/// on each plane. Each track is built from its hits with buildTrack, which
+/// adds the nodes and optimizes them; the built tracks must follow the
+/// generated lines, and the rate in tracks and hits per second is printed.
+///
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Table.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/Exceptions.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "lardata/DetectorInfoServices/DetectorClocksService.h"
+#include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "larreco/RecoAlg/PMAlg/PmaNode3D.h"
+#include "larreco/RecoAlg/PMAlg/PmaTrack3D.h"
+#include "larreco/RecoAlg/ProjectionMatchingAlg.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace pma {
+
+  class PMAlgBenchmark : public art::EDAnalyzer {
+  public:
+    struct Config {
+      using Name = fhicl::Name;
+      using Comment = fhicl::Comment;
+      fhicl::Atom<unsigned int> nTracks{Name("nTracks"), Comment("Tracks generated per event")};
+      fhicl::Atom<double> minLength{Name("minLength"), Comment("Minimum track length [cm]")};
+      fhicl::Atom<double> maxNodeDistance{
+        Name("maxNodeDistance"),
+        Comment("Largest distance of a node from the generated line [cm]")};
+      fhicl::Atom<unsigned int> seed{Name("seed"), Comment("Seed of the track generation")};
+      fhicl::Table<ProjectionMatchingAlg::Config> projectionMatchingAlg{
+        Name("ProjectionMatchingAlg")};
+    };
+    using Parameters = art::EDAnalyzer::Table<Config>;
+
+    explicit PMAlgBenchmark(Parameters const& p);
+
+  private:
+    void analyze(art::Event const& e) override;
+
+    /// Ends and hits of one generated track
+    struct GeneratedTrack {
+      geo::Point_t start, end;
+      std::vector<size_t> hits; ///< Index of the hits of the track
+    };
+
+    GeneratedTrack generateTrack(detinfo::DetectorPropertiesData const& detProp,
+                                 std::vector<recob::Hit>& hits);
+
+    /// Largest distance of the nodes of `trk` from the generated line
+    static double maxDistance(pma::Track3D const& trk, GeneratedTrack const& track);
+
+    Parameters p_;
+    ProjectionMatchingAlg projectionMatchingAlg;
+    art::ServiceHandle<geo::Geometry const> geom;
+    std::mt19937 rng;
+
+    double fTotalTime = 0.;
+    size_t fTotalTracks = 0;
+    size_t fTotalHits = 0;
+  };
+
+}
+
+pma::PMAlgBenchmark::PMAlgBenchmark(Parameters const& p)
+  : EDAnalyzer{p}, p_(p), projectionMatchingAlg{p_().projectionMatchingAlg()}, rng(p_().seed())
+{}
+
+pma::PMAlgBenchmark::GeneratedTrack pma::PMAlgBenchmark::generateTrack(
+  detinfo::DetectorPropertiesData const& detProp,
+  std::vector<recob::Hit>& hits)
+{
+  geo::TPCGeo const& tpc = geom->TPC(geo::TPCID{0, 0});
+  geo::BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+  constexpr double margin = 2.;
+  std::uniform_real_distribution<double> ux(box.MinX() + margin, box.MaxX() - margin);
+  std::uniform_real_distribution<double> uy(box.MinY() + margin, box.MaxY() - margin);
+  std::uniform_real_distribution<double> uz(box.MinZ() + margin, box.MaxZ() - margin);
+
+  GeneratedTrack track;
+  do {
+    track.start = geo::Point_t(ux(rng), uy(rng), uz(rng));
+    track.end = geo::Point_t(ux(rng), uy(rng), uz(rng));
+  } while ((track.end - track.start).R() < p_().minLength());
+
+  // walk along the track, with a hit each time a new wire is reached on a plane
+  std::normal_distribution<double> smear(0., 1.);
+  constexpr double step = 0.1;
+  geo::Vector_t const dir = (track.end - track.start).Unit();
+  size_t const nSteps = (track.end - track.start).R() / step;
+
+  std::vector<geo::WireID> lastWire(tpc.Nplanes());
+  for (size_t s = 0; s <= nSteps; ++s) {
+    geo::Point_t const pos = track.start + (s * step) * dir;
+    for (unsigned int ipl = 0; ipl < tpc.Nplanes(); ++ipl) {
+      geo::PlaneGeo const& plane = tpc.Plane(ipl);
+      geo::WireID wid;
+      try {
+        wid = plane.NearestWireID(pos);
+      }
+      catch (geo::InvalidWireError const&) {
+        continue;
+      }
+      if (wid == lastWire[ipl]) continue;
+      lastWire[ipl] = wid;
+
+      constexpr float rms = 3.;
+      float const tick = detProp.ConvertXToTicks(pos.X(), plane.ID()) + rms * smear(rng) / 4.;
+      track.hits.push_back(hits.size());
+      hits.emplace_back(geom->PlaneWireToChannel(wid),
+                        tick - 3 * rms,
+                        tick + 3 * rms,
+                        tick,
+                        rms / 4.,
+                        rms,
+                        100.,
+                        5.,
+                        750.,
+                        750.,
+                        20.,
+                        1,
+                        0, // Multiplicity, LocalIndex
+                        1.,
+                        3, // GoodnessOfFit, DOF
+                        plane.View(),
+                        geom->SignalType(plane.ID()),
+                        wid);
+    }
+  }
+  return track;
+}
+
+double pma::PMAlgBenchmark::maxDistance(pma::Track3D const& trk, GeneratedTrack const& track)
+{
+  geo::Vector_t const dir = (track.end - track.start).Unit();
+  double dist = 0.;
+  for (pma::Node3D const* node : trk.Nodes()) {
+    auto const& p = node->Point3D();
+    geo::Vector_t const d = geo::Point_t(p.X(), p.Y(), p.Z()) - track.start;
+    dist = std::max(dist, d.Cross(dir).R());
+  }
+  return dist;
+}
+
+void pma::PMAlgBenchmark::analyze(art::Event const& e)
+{
+  auto const clockData = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(e);
+  auto const detProp =
+    art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e, clockData);
+
+  // generate the tracks; the hits are all made before the Ptrs to them are taken
+  unsigned int const nTracks = p_().nTracks();
+  std::vector<recob::Hit> hits;
+  std::vector<GeneratedTrack> generated;
+  for (unsigned int i = 0; i < nTracks; ++i)
+    generated.push_back(generateTrack(detProp, hits));
+
+  std::vector<std::vector<art::Ptr<recob::Hit>>> trackHits(nTracks);
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    for (size_t h : generated[i].hits)
+      trackHits[i].emplace_back(art::ProductID{}, &hits[h], h);
+  }
+
+  std::vector<std::unique_ptr<pma::Track3D>> built(nTracks);
+  auto const start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < nTracks; ++i)
+    built[i].reset(projectionMatchingAlg.buildTrack(detProp, trackHits[i]));
+  std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+  unsigned int nBuilt = 0, nNodes = 0;
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    if (!built[i]) continue;
+    ++nBuilt;
+    nNodes += built[i]->Nodes().size();
+    double const dist = maxDistance(*built[i], generated[i]);
+    if (dist > p_().maxNodeDistance()) {
+      throw cet::exception("PMAlgBenchmark")
+        << "Track " << i << " built " << dist << " cm away from the generated line\n";
+    }
+  }
+  if (2 * nBuilt < nTracks) {
+    throw cet::exception("PMAlgBenchmark")
+      << "Only " << nBuilt << " of " << nTracks << " tracks built\n";
+  }
+
+  fTotalTime += elapsed.count();
+  fTotalTracks += nTracks;
+  fTotalHits += hits.size();
+
+  mf::LogInfo("PMAlgBenchmark") << nTracks << " tracks, " << hits.size() << " hits, " << nBuilt
+                                << " built with " << nNodes << " nodes\n"
+                                << "  buildTrack: " << nTracks / elapsed.count() << " tracks/s, "
+                                << hits.size() / elapsed.count() << " hits/s\n"
+                                << "  cumulative: " << fTotalTracks / fTotalTime << " tracks/s, "
+                                << fTotalHits / fTotalTime << " hits/s";
+}
+
+DEFINE_ART_MODULE(pma::PMAlgBenchmark)
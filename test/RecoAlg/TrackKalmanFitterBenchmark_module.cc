@@ -0,0 +1,246 @@
+/// \class TrackKalmanFitterBenchmark
+///
+/// \brief Measures the tracks per second of TrackKalmanFitter::fitTracks.
+///
+/// Each event, straight muon tracks are generated in the first TPC of the
+/// detector, with one hit per wire they cross on each plane and one trajectory
+/// point per hit. They are fitted in one batch with fitTracks and one by one
+/// with fitTrack; the fit results must be the same, and the two rates are
+/// printed.
+///
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Table.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/Exceptions.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "lardata/DetectorInfoServices/DetectorClocksService.h"
+#include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
+#include "lardata/RecoObjects/TrackStatePropagator.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/RecoBase/Track.h"
+#include "lardataobj/RecoBase/TrackTrajectory.h"
+#include "larreco/RecoAlg/TrackKalmanFitter.h"
+#include "larreco/TrackFinder/TrackMaker.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace trkf {
+
+  class TrackKalmanFitterBenchmark : public art::EDAnalyzer {
+  public:
+    struct Config {
+      using Name = fhicl::Name;
+      using Comment = fhicl::Comment;
+      fhicl::Atom<unsigned int> nTracks{Name("nTracks"), Comment("Tracks generated per event")};
+      fhicl::Atom<double> minLength{Name("minLength"), Comment("Minimum track length [cm]")};
+      fhicl::Atom<double> momentum{Name("momentum"), Comment("Momentum of the muons [GeV]")};
+      fhicl::Atom<unsigned int> seed{Name("seed"), Comment("Seed of the track generation")};
+      fhicl::Table<TrackStatePropagator::Config> propagator{Name("propagator")};
+      fhicl::Table<TrackKalmanFitter::Config> fitter{Name("fitter")};
+    };
+    using Parameters = art::EDAnalyzer::Table<Config>;
+
+    explicit TrackKalmanFitterBenchmark(Parameters const& p);
+
+  private:
+    void analyze(art::Event const& e) override;
+
+    /// Track points and hits of one generated track
+    struct GeneratedTrack {
+      std::vector<Point_t> positions;
+      std::vector<size_t> hits; ///< Index of the hit of each position
+    };
+
+    GeneratedTrack generateTrack(detinfo::DetectorPropertiesData const& detProp,
+                                 std::vector<recob::Hit>& hits);
+
+    Parameters p_;
+    TrackStatePropagator prop;
+    TrackKalmanFitter kalmanFitter;
+    art::ServiceHandle<geo::Geometry const> geom;
+    std::mt19937 rng;
+  };
+
+}
+
+trkf::TrackKalmanFitterBenchmark::TrackKalmanFitterBenchmark(Parameters const& p)
+  : EDAnalyzer{p}
+  , p_(p)
+  , prop{p_().propagator}
+  , kalmanFitter{&prop, p_().fitter}
+  , rng(p_().seed())
+{}
+
+trkf::TrackKalmanFitterBenchmark::GeneratedTrack trkf::TrackKalmanFitterBenchmark::generateTrack(
+  detinfo::DetectorPropertiesData const& detProp,
+  std::vector<recob::Hit>& hits)
+{
+  geo::TPCGeo const& tpc = geom->TPC(geo::TPCID{0, 0});
+  geo::BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+  constexpr double margin = 2.;
+  std::uniform_real_distribution<double> ux(box.MinX() + margin, box.MaxX() - margin);
+  std::uniform_real_distribution<double> uy(box.MinY() + margin, box.MaxY() - margin);
+  std::uniform_real_distribution<double> uz(box.MinZ() + margin, box.MaxZ() - margin);
+
+  Point_t start, end;
+  do {
+    start = Point_t(ux(rng), uy(rng), uz(rng));
+    end = Point_t(ux(rng), uy(rng), uz(rng));
+  } while ((end - start).R() < p_().minLength());
+
+  // walk along the track, with a hit each time a new wire is reached on a plane
+  std::normal_distribution<double> smear(0., 1.);
+  constexpr double step = 0.1;
+  Vector_t const dir = (end - start).Unit();
+  size_t const nSteps = (end - start).R() / step;
+
+  GeneratedTrack track;
+  std::vector<geo::WireID> lastWire(tpc.Nplanes());
+  for (size_t s = 0; s <= nSteps; ++s) {
+    Point_t const pos = start + (s * step) * dir;
+    for (unsigned int ipl = 0; ipl < tpc.Nplanes(); ++ipl) {
+      geo::PlaneGeo const& plane = tpc.Plane(ipl);
+      geo::WireID wid;
+      try {
+        wid = plane.NearestWireID(pos);
+      }
+      catch (geo::InvalidWireError const&) {
+        continue;
+      }
+      if (wid == lastWire[ipl]) continue;
+      lastWire[ipl] = wid;
+
+      constexpr float rms = 3.;
+      float const tick = detProp.ConvertXToTicks(pos.X(), plane.ID()) + rms * smear(rng) / 4.;
+      track.hits.push_back(hits.size());
+      track.positions.push_back(pos);
+      hits.emplace_back(geom->PlaneWireToChannel(wid),
+                        tick - 3 * rms,
+                        tick + 3 * rms,
+                        tick,
+                        rms / 4.,
+                        rms,
+                        100.,
+                        5.,
+                        750.,
+                        750.,
+                        20.,
+                        1,
+                        0, // Multiplicity, LocalIndex
+                        1.,
+                        3, // GoodnessOfFit, DOF
+                        plane.View(),
+                        geom->SignalType(plane.ID()),
+                        wid);
+    }
+  }
+  return track;
+}
+
+void trkf::TrackKalmanFitterBenchmark::analyze(art::Event const& e)
+{
+  auto const clockData = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(e);
+  auto const detProp =
+    art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e, clockData);
+
+  // generate the tracks; the hits are all made before the Ptrs to them are taken
+  unsigned int const nTracks = p_().nTracks();
+  std::vector<recob::Hit> hits;
+  std::vector<GeneratedTrack> generated;
+  for (unsigned int i = 0; i < nTracks; ++i)
+    generated.push_back(generateTrack(detProp, hits));
+
+  std::vector<recob::TrackTrajectory> trajectories;
+  std::vector<TrackKalmanFitter::TrackSeed> seeds;
+  trajectories.reserve(nTracks);
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    GeneratedTrack const& track = generated[i];
+    Vector_t const mom =
+      (track.positions.back() - track.positions.front()).Unit() * p_().momentum();
+    trajectories.emplace_back(
+      recob::TrackTrajectory::Positions_t(track.positions),
+      recob::TrackTrajectory::Momenta_t(track.positions.size(), mom),
+      recob::TrackTrajectory::Flags_t(track.positions.size()),
+      true);
+
+    std::vector<art::Ptr<recob::Hit>> trackHits;
+    for (size_t h : track.hits)
+      trackHits.emplace_back(art::ProductID{}, &hits[h], h);
+    seeds.push_back({&trajectories.back(),
+                     int(i),
+                     SMatrixSym55(),
+                     SMatrixSym55(),
+                     std::move(trackHits),
+                     p_().momentum(),
+                     13,
+                     false});
+  }
+
+  // batch fit
+  std::vector<char> fitok;
+  std::vector<recob::Track> outTracks;
+  std::vector<std::vector<art::Ptr<recob::Hit>>> outHits;
+  std::vector<trkmkr::OptionalOutputs> optionals;
+  auto const batchStart = std::chrono::steady_clock::now();
+  kalmanFitter.fitTracks(detProp, seeds, false, fitok, outTracks, outHits, optionals);
+  std::chrono::duration<double> const batchTime = std::chrono::steady_clock::now() - batchStart;
+
+  // the same tracks one by one
+  std::vector<char> serialok(nTracks);
+  std::vector<recob::Track> serialTracks(nTracks);
+  auto const serialStart = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    auto const& seed = seeds[i];
+    std::vector<art::Ptr<recob::Hit>> serialHits;
+    trkmkr::OptionalOutputs serialOptionals;
+    serialok[i] = kalmanFitter.fitTrack(detProp,
+                                        *seed.traj,
+                                        seed.tkID,
+                                        seed.covVtx,
+                                        seed.covEnd,
+                                        seed.hits,
+                                        seed.pval,
+                                        seed.pdgid,
+                                        seed.flipDirection,
+                                        serialTracks[i],
+                                        serialHits,
+                                        serialOptionals);
+  }
+  std::chrono::duration<double> const serialTime = std::chrono::steady_clock::now() - serialStart;
+
+  unsigned int nFitted = 0;
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    if (fitok[i] != serialok[i] ||
+        (fitok[i] && (outTracks[i].CountValidPoints() != serialTracks[i].CountValidPoints() ||
+                      outTracks[i].Chi2() != serialTracks[i].Chi2()))) {
+      throw cet::exception("TrackKalmanFitterBenchmark")
+        << "Track " << i << " fitted differently by fitTracks and fitTrack\n";
+    }
+    if (fitok[i]) ++nFitted;
+  }
+  if (2 * nFitted < nTracks) {
+    throw cet::exception("TrackKalmanFitterBenchmark")
+      << "Only " << nFitted << " of " << nTracks << " tracks fitted\n";
+  }
+
+  mf::LogInfo("TrackKalmanFitterBenchmark")
+    << nTracks << " tracks, " << hits.size() << " hits, " << nFitted << " fitted\n"
+    << "  fitTracks: " << nTracks / batchTime.count() << " tracks/s\n"
+    << "  fitTrack:  " << nTracks / serialTime.count() << " tracks/s\n"
+    << "  speedup:   " << serialTime.count() / batchTime.count();
+}
+
+DEFINE_ART_MODULE(trkf::TrackKalmanFitterBenchmark)
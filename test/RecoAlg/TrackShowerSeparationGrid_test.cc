@@ -0,0 +1,213 @@
+/**
+ * @file   TrackShowerSeparationGrid_test.cc
+ * @brief  Test for the point grid used by TrackShowerSeparationAlg
+ * @see    TrackShowerSeparationGrid.h
+ *
+ * The candidates of each query must include every point passing the exact
+ * test, done here with the same arithmetic as TVector3. With 100k points the
+ * line and cone queries must also be much faster than that exact test.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (TrackShowerSeparationGrid_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/TrackShowerSeparationGrid.h"
+
+namespace {
+
+  using Point = shower::PointGrid::Point;
+
+  Point Sub(const Point& a, const Point& b) { return {{a[0] - b[0], a[1] - b[1], a[2] - b[2]}}; }
+  double Dot(const Point& a, const Point& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+  double Mag(const Point& a) { return std::sqrt(Dot(a, a)); }
+
+  /// As TVector3::Angle
+  double Angle(const Point& a, const Point& b)
+  {
+    double const ptot2 = Dot(a, a) * Dot(b, b);
+    if (ptot2 <= 0) return 0.;
+    double const arg = std::clamp(Dot(a, b) / std::sqrt(ptot2), -1., 1.);
+    return std::acos(arg);
+  }
+
+  Point Unit(const Point& a)
+  {
+    double const mag = Mag(a);
+    return {{a[0] / mag, a[1] / mag, a[2] / mag}};
+  }
+
+  /// Space points along a few lines in a box, plus a uniform background
+  std::vector<Point> MakePoints(std::size_t n, unsigned int seed)
+  {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<double> box(-300., 300.);
+    std::uniform_real_distribution<double> along(0., 200.);
+    std::normal_distribution<double> spread(0., 1.);
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i % 4 == 0) {
+        points.push_back({{box(engine), box(engine), box(engine)}});
+        continue;
+      }
+      Point const start{{-50. + 10. * (i % 7), 20. * (i % 3), -100.}};
+      Point const dir = Unit({{1., 0.3 * (i % 5), 2.}});
+      double const t = along(engine);
+      points.push_back({{start[0] + t * dir[0] + spread(engine),
+                         start[1] + t * dir[1] + spread(engine),
+                         start[2] + t * dir[2] + spread(engine)}});
+    }
+    return points;
+  }
+
+  template <typename Exact>
+  void CheckCandidates(const std::vector<Point>& points,
+                       const std::vector<std::size_t>& candidates,
+                       Exact exact)
+  {
+    BOOST_TEST(std::is_sorted(candidates.begin(), candidates.end()));
+    BOOST_TEST((std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end()));
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      if (!exact(points[i])) continue;
+      BOOST_TEST_CONTEXT("point " << i)
+      {
+        BOOST_TEST(std::binary_search(candidates.begin(), candidates.end(), i));
+      }
+    }
+  }
+
+} // local namespace
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE(TrackShowerSeparationGridSuite)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(QueryTest)
+{
+  std::vector<Point> const points = MakePoints(20000, 4321);
+  shower::PointGrid const grid(points, 20.);
+  BOOST_TEST(grid.NumPoints() == points.size());
+
+  std::mt19937 engine(1234);
+  std::uniform_real_distribution<double> box(-250., 250.);
+  std::uniform_real_distribution<double> component(-1., 1.);
+
+  double const coneAngle = 15. * std::acos(-1.) / 180.;
+  std::size_t nPointCandidates = 0;
+  for (int q = 0; q < 50; ++q) {
+    // queries both from random places and from the points themselves
+    Point const origin = q % 2 ? points[q * 101] : Point{{box(engine), box(engine), box(engine)}};
+    Point const direction = Unit({{component(engine), component(engine), component(engine)}});
+
+    auto const nearPoint = grid.NearPoint(origin, 5.);
+    nPointCandidates += nearPoint.size();
+    CheckCandidates(points, nearPoint, [&](const Point& p) { return Mag(Sub(p, origin)) < 5.; });
+
+    CheckCandidates(points, grid.NearLine(origin, direction, 20.), [&](const Point& p) {
+      Point const w = Sub(p, origin);
+      double const t = Dot(w, direction);
+      Point const proj{{t * direction[0], t * direction[1], t * direction[2]}};
+      return Mag(Sub(w, proj)) < 20.;
+    });
+
+    Point const backwards{{-direction[0], -direction[1], -direction[2]}};
+    CheckCandidates(
+      points, grid.NearCone(origin, direction, coneAngle, false), [&](const Point& p) {
+        return Angle(Sub(p, origin), direction) < coneAngle;
+      });
+    CheckCandidates(
+      points, grid.NearCone(origin, direction, coneAngle, true), [&](const Point& p) {
+        return Angle(Sub(p, origin), direction) < coneAngle ||
+               Angle(Sub(p, origin), backwards) < coneAngle;
+      });
+  }
+
+  // the small spheres should only have looked at a few cells each
+  BOOST_TEST(nPointCandidates < 50 * points.size() / 20);
+} // BOOST_AUTO_TEST_CASE(QueryTest)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(ScalingTest)
+{
+  std::vector<Point> const points = MakePoints(100000, 8765);
+  shower::PointGrid const grid(points, 5.);
+
+  std::mt19937 engine(5678);
+  std::uniform_real_distribution<double> box(-250., 250.);
+  std::uniform_real_distribution<double> component(-1., 1.);
+  std::vector<Point> origins, directions;
+  for (int q = 0; q < 200; ++q) {
+    origins.push_back(q % 2 ? points[q * 401] : Point{{box(engine), box(engine), box(engine)}});
+    directions.push_back(Unit({{component(engine), component(engine), component(engine)}}));
+  }
+
+  double const coneAngle = 5. * std::acos(-1.) / 180.;
+  auto nearLine = [&](const Point& p, std::size_t q) {
+    Point const w = Sub(p, origins[q]);
+    double const t = Dot(w, directions[q]);
+    Point const proj{{t * directions[q][0], t * directions[q][1], t * directions[q][2]}};
+    return Mag(Sub(w, proj)) < 3.;
+  };
+  auto nearCone = [&](const Point& p, std::size_t q) {
+    return Angle(Sub(p, origins[q]), directions[q]) < coneAngle;
+  };
+
+  // the exact test on every point, as the callers did before the grid
+  auto const loopStart = std::chrono::steady_clock::now();
+  std::size_t nExact = 0;
+  for (std::size_t q = 0; q < origins.size(); ++q)
+    for (const Point& p : points)
+      nExact += nearLine(p, q) + nearCone(p, q);
+  std::chrono::duration<double> const loopTime = std::chrono::steady_clock::now() - loopStart;
+
+  auto const gridStart = std::chrono::steady_clock::now();
+  std::vector<std::vector<std::size_t>> lineCandidates, coneCandidates;
+  for (std::size_t q = 0; q < origins.size(); ++q) {
+    lineCandidates.push_back(grid.NearLine(origins[q], directions[q], 3.));
+    coneCandidates.push_back(grid.NearCone(origins[q], directions[q], coneAngle, false));
+  }
+  std::chrono::duration<double> const gridTime = std::chrono::steady_clock::now() - gridStart;
+
+  std::size_t nCandidates = 0;
+  for (std::size_t q = 0; q < origins.size(); ++q) {
+    CheckCandidates(points, lineCandidates[q], [&](const Point& p) { return nearLine(p, q); });
+    CheckCandidates(points, coneCandidates[q], [&](const Point& p) { return nearCone(p, q); });
+    nCandidates += lineCandidates[q].size() + coneCandidates[q].size();
+  }
+  BOOST_TEST_MESSAGE(nExact << " points passing, " << nCandidates << " candidates; "
+                            << origins.size() << " line and cone queries in "
+                            << 1e3 * gridTime.count() << " ms, exact test on all points in "
+                            << 1e3 * loopTime.count() << " ms");
+
+  BOOST_TEST(nCandidates < 2 * origins.size() * points.size() / 20);
+  BOOST_TEST(gridTime.count() < loopTime.count() / 4);
+} // BOOST_AUTO_TEST_CASE(ScalingTest)
+
+//******************************************************************************
+BOOST_AUTO_TEST_CASE(NonFiniteTest)
+{
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<Point> const points{{{0., 0., 0.}}, {{nan, 1., 1.}}, {{10., 10., 10.}}};
+  shower::PointGrid const grid(points, 1.);
+
+  // a non-finite query leaves everything to the exact test, which non-finite points never pass
+  BOOST_TEST((grid.NearPoint({{nan, 0., 0.}}, 1.) == std::vector<std::size_t>{0, 2}));
+  BOOST_TEST(
+    (grid.NearLine({{0., 0., 0.}}, {{nan, 0., 0.}}, 1.) == std::vector<std::size_t>{0, 2}));
+  BOOST_TEST((grid.NearPoint({{0., 0., 0.}}, 1.) == std::vector<std::size_t>{0}));
+  BOOST_TEST(grid.NearPoint({{50., 0., 0.}}, 1.).empty());
+
+  shower::PointGrid const empty(std::vector<Point>{}, 1.);
+  BOOST_TEST(empty.NearCone({{0., 0., 0.}}, {{1., 0., 0.}}, 0.1, true).empty());
+} // BOOST_AUTO_TEST_CASE(NonFiniteTest)
+
+BOOST_AUTO_TEST_SUITE_END()
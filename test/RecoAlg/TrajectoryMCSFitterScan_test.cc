@@ -0,0 +1,120 @@
+/**
+ * @file   TrajectoryMCSFitterScan_test.cc
+ * @brief  Test of the minimum search of the likelihood scan of TrajectoryMCSFitter
+ * @see    TrajectoryMCSFitter.h
+ *
+ * The minimum found by trkf::likelihoodScanMinimum is compared with the one
+ * of a loop over all the points of the grid, on likelihood shapes with one
+ * and with several minima, with and without a low momentum region where the
+ * particle stops.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (TrajectoryMCSFitterScan_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/TrajectoryMCSFitter.h"
+
+namespace {
+
+  constexpr float kStops = std::numeric_limits<float>::max();
+
+  /// Result of a scan: the index of the minimum and the number of evaluated points
+  struct Scan {
+    int index;
+    int nEvaluated;
+  };
+
+  /// The minimum search of TrajectoryMCSFitter, evaluating each point at most once
+  Scan fastScan(int npoints, std::function<float(int)> const& f)
+  {
+    std::vector<float> values(npoints);
+    std::vector<bool> evaluated(npoints, false);
+    int nEvaluated = 0;
+    auto logL = [&](int i) {
+      if (!evaluated[i]) {
+        values[i] = f(i);
+        evaluated[i] = true;
+        ++nEvaluated;
+      }
+      return values[i];
+    };
+    int const index = trkf::likelihoodScanMinimum(npoints, logL);
+    return {index, nEvaluated};
+  }
+
+  /// The first lowest point of a loop over the whole grid
+  int fullScan(int npoints, std::function<float(int)> const& f)
+  {
+    int best_idx = -1;
+    float best_logL = kStops;
+    for (int i = 0; i < npoints; ++i) {
+      float const logL = f(i);
+      if (logL < best_logL) {
+        best_logL = logL;
+        best_idx = i;
+      }
+    }
+    return best_idx;
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(SingleMinimum_test)
+{
+  for (int npoints : {1, 2, 5, 10, 100, 750}) {
+    for (int stopBelow : {0, 3, npoints / 2}) {
+      for (double c = -5.; c < npoints + 5.; c += 0.7) {
+        auto const f = [=](int i) -> float {
+          if (i < stopBelow) return kStops;
+          return 0.01 * (i - c) * (i - c) + 3.;
+        };
+        Scan const scan = fastScan(npoints, f);
+        BOOST_TEST(scan.index == fullScan(npoints, f));
+        if (npoints >= 100) { BOOST_TEST(scan.nEvaluated < npoints / 2); }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SeveralMinima_test)
+{
+  int const npoints = 750;
+  for (int stopBelow : {0, 40}) {
+    // oscillations on top of a parabola, with periods of a few sampling steps
+    for (double period : {70., 95., 130., 200.}) {
+      for (double c = 0.; c < npoints; c += 37.) {
+        auto const f = [=](int i) -> float {
+          if (i < stopBelow) return kStops;
+          return 1e-4 * (i - c) * (i - c) + std::cos(2. * M_PI * i / period);
+        };
+        BOOST_TEST(fastScan(npoints, f).index == fullScan(npoints, f));
+      }
+    }
+    // two wells, the deepest one on either side
+    for (double depth : {-1., 1.}) {
+      for (double c = 100.; c < npoints - 100.; c += 53.) {
+        auto const f = [=](int i) -> float {
+          if (i < stopBelow) return kStops;
+          double const w1 = (i - c) / 60., w2 = (i - c - 250.) / 60.;
+          return 10. - (5. + depth) * std::exp(-w1 * w1) - (5. - depth) * std::exp(-w2 * w2);
+        };
+        BOOST_TEST(fastScan(npoints, f).index == fullScan(npoints, f));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParticleStops_test)
+{
+  auto const f = [](int) { return kStops; };
+  BOOST_TEST(fastScan(100, f).index == -1);
+  BOOST_TEST(fastScan(0, f).index == -1);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file   ParallelSolver_test.cc
+ * @brief  Test of the parallel solver of SpacePointSolver against the serial one
+ * @see    Solver.h
+ *
+ * Two copies of the same small system, with space points shared between
+ * wires and a few orphans, are minimized with the serial sweeps and with a
+ * ParallelSolver. Both must reach the same metric and the same charges.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (ParallelSolver_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/SpacePointSolver/Solver.h"
+
+namespace {
+
+  constexpr int kNCWires = 12;
+
+  /// A system with the lists the solvers work on
+  struct TestSystem {
+    SolverSystem sys;
+    std::vector<CollectionWireHit*> cwires;
+    std::vector<SpaceCharge*> orphanSCs;
+  };
+
+  /// Collection wire c crosses the space points (u = c, v = c) and
+  /// (u = c + 1, v = c + 3); the wire charges are those of fixed true charges
+  void BuildSystem(TestSystem& ts, bool withNeighbours)
+  {
+    SolverSystem& sys = ts.sys;
+
+    auto trueCharge = [](int c, int k) { return 10. + 7. * ((3 * c + 5 * k) % 4); };
+
+    std::vector<double> uq(kNCWires + 1, 0), vq(kNCWires + 3, 0);
+    for (int c = 0; c < kNCWires; ++c) {
+      uq[c] += trueCharge(c, 0);
+      vq[c] += trueCharge(c, 0);
+      uq[c + 1] += trueCharge(c, 1);
+      vq[c + 3] += trueCharge(c, 1);
+    }
+    // the orphans only see the induction wires
+    uq[2] += 5.;
+    vq[7] += 5.;
+    uq[9] += 8.;
+    vq[4] += 8.;
+
+    sys.fIWires.reserve(uq.size() + vq.size());
+    for (unsigned int u = 0; u < uq.size(); ++u)
+      sys.fIWires.emplace_back(u, uq[u]);
+    for (unsigned int v = 0; v < vq.size(); ++v)
+      sys.fIWires.emplace_back(100 + v, vq[v]);
+    auto uWire = [&](int u) { return &sys.fIWires[u]; };
+    auto vWire = [&](int v) { return &sys.fIWires[uq.size() + v]; };
+
+    sys.fSpaceCharges.reserve(2 * kNCWires + 2);
+    sys.fCrossings.reserve(2 * kNCWires);
+    sys.fCWires.reserve(kNCWires);
+    for (int c = 0; c < kNCWires; ++c) {
+      SpaceCharge** first = sys.fCrossings.data() + sys.fCrossings.size();
+      sys.fCrossings.push_back(
+        &sys.fSpaceCharges.emplace_back(0, 0, 3. * c, nullptr, uWire(c), vWire(c)));
+      sys.fCrossings.push_back(
+        &sys.fSpaceCharges.emplace_back(0, -2, 3. * c + 1, nullptr, uWire(c + 1), vWire(c + 3)));
+      const ArrayRange<SpaceCharge*> scs(first, first + 2);
+      CollectionWireHit* cwire =
+        &sys.fCWires.emplace_back(c, trueCharge(c, 0) + trueCharge(c, 1), scs);
+      for (SpaceCharge* sc : scs)
+        sc->fCWire = cwire;
+      ts.cwires.push_back(cwire);
+    }
+    ts.orphanSCs.push_back(&sys.fSpaceCharges.emplace_back(0, -5, 7, nullptr, uWire(2), vWire(7)));
+    ts.orphanSCs.push_back(&sys.fSpaceCharges.emplace_back(0, 5, 25, nullptr, uWire(9), vWire(4)));
+
+    if (!withNeighbours) return;
+
+    std::vector<std::size_t> offsets;
+    for (SpaceCharge& sc1 : sys.fSpaceCharges) {
+      offsets.push_back(sys.fNeighbours.size());
+      for (SpaceCharge& sc2 : sys.fSpaceCharges) {
+        if (&sc1 == &sc2) continue;
+        const double dist = std::hypot(sc1.fY - sc2.fY, sc1.fZ - sc2.fZ);
+        if (dist < 5) sys.fNeighbours.emplace_back(&sc2, std::exp(-dist / 2));
+      }
+    }
+    offsets.push_back(sys.fNeighbours.size());
+    for (std::size_t i = 0; i < sys.fSpaceCharges.size(); ++i) {
+      SpaceCharge& sc = sys.fSpaceCharges[i];
+      sc.fNeighbours = ArrayRange<Neighbour>(sys.fNeighbours.data() + offsets[i],
+                                             sys.fNeighbours.data() + offsets[i + 1]);
+      // the charges were added before the neighbours were known
+      for (const Neighbour& nei : sc.fNeighbours)
+        nei.fSC->fNeiPotential += sc.fPred * nei.fCoupling;
+    }
+  }
+
+  constexpr int kMaxIterations = 5000;
+  constexpr double kTolerance = 1e-10;
+
+  void MinimizeSerial(TestSystem& ts, double alpha)
+  {
+    double prevMetric = Metric(ts.cwires, alpha);
+    for (int i = 0; i < kMaxIterations; ++i) {
+      Iterate(ts.cwires, ts.orphanSCs, alpha);
+      const double metric = Metric(ts.cwires, alpha);
+      if (std::abs(metric - prevMetric) < kTolerance * std::abs(prevMetric)) return;
+      prevMetric = metric;
+    }
+  }
+
+  void MinimizeParallel(TestSystem& ts, double alpha)
+  {
+    ParallelSolver solver(ts.cwires, ts.orphanSCs);
+    double prevMetric = solver.Reset(alpha);
+    for (int i = 0; i < kMaxIterations; ++i) {
+      double metric = solver.Iterate(alpha);
+      if (std::abs(metric - prevMetric) < kTolerance * std::abs(prevMetric))
+        metric = solver.Reset(alpha);
+      if (std::abs(metric - prevMetric) < kTolerance * std::abs(prevMetric)) return;
+      prevMetric = metric;
+    }
+  }
+
+  void CompareSolvers(double alpha)
+  {
+    TestSystem serial, parallel;
+    BuildSystem(serial, alpha != 0);
+    BuildSystem(parallel, alpha != 0);
+
+    MinimizeSerial(serial, alpha);
+    MinimizeParallel(parallel, alpha);
+
+    const double serialMetric = Metric(serial.cwires, alpha);
+    const double parallelMetric = Metric(parallel.cwires, alpha);
+    // without regularization the minimum is 0, the charges being those of a solution
+    BOOST_TEST(std::abs(parallelMetric - serialMetric) < 1e-6 * (1 + std::abs(serialMetric)));
+
+    for (std::size_t i = 0; i < serial.sys.fSpaceCharges.size(); ++i) {
+      const double qSerial = serial.sys.fSpaceCharges[i].fPred;
+      const double qParallel = parallel.sys.fSpaceCharges[i].fPred;
+      BOOST_TEST(std::abs(qParallel - qSerial) < 1e-3, "space point " << i << " has charge "
+                                                     << qParallel << " against " << qSerial);
+    }
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(NoRegularization_test)
+{
+  CompareSolvers(0);
+}
+
+BOOST_AUTO_TEST_CASE(Regularization_test)
+{
+  CompareSolvers(0.05);
+}
+
+BOOST_AUTO_TEST_CASE(TrackedMetric_test)
+{
+  TestSystem ts;
+  BuildSystem(ts, true);
+  const double alpha = 0.05;
+
+  ParallelSolver solver(ts.cwires, ts.orphanSCs);
+  solver.Reset(alpha);
+  for (unsigned int i = 1; i <= 3 * ParallelSolver::kFullMetricInterval; ++i) {
+    const double metric = solver.Iterate(alpha);
+    const double exact = Metric(ts.cwires, alpha);
+    if (i % ParallelSolver::kFullMetricInterval == 0)
+      BOOST_TEST(metric == exact);
+    else
+      BOOST_TEST(metric == exact, boost::test_tools::tolerance(1e-9));
+  }
+}